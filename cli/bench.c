@@ -0,0 +1,966 @@
+/*************************************************************************************************/
+/*  Benchmark: replay of batch dumps and synthetic scenes through a board renderer               */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "bench.h"
+#include "../src/resources_utils.h"
+#include "_time.h"
+#include "codec.h"
+#include "common.h"
+#include "host.h"
+#include "renderer.h"
+#include "request.h"
+#include "scene/axis.h"
+#include "scene/graphics.h"
+#include "scene/mvp.h"
+#include "scene/ticks.h"
+#include "scene/viewport.h"
+#include "scene/visual.h"
+#include "shm.h"
+#include "soft.h"
+#include "vklite.h"
+
+
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+typedef struct
+{
+    const char* dump;   // batch dump to replay, or NULL for a synthetic scene
+    const char* save;   // batch dump where to save the synthetic scene
+    const char* output; // JSON file, or NULL for the standard output
+    const char* micro;  // micro-benchmark to run instead of a replay, or NULL
+
+    uint32_t frames; // number of frames, or of rounds of a micro-benchmark
+    uint32_t width, height;
+    uint32_t threads; // software renderer only, 0 for the number of CPU cores
+    bool software;
+
+    // Synthetic scene.
+    uint32_t markers;
+    uint32_t paths, path_length;
+    uint32_t panels;
+} BenchOptions;
+
+
+
+// Buffers of the synthetic scene, uploaded without copy so that the uploads can be replayed.
+typedef struct
+{
+    DvzGraphicsPointVertex* markers;
+    DvzVertex* paths;
+    DvzViewport* viewports;
+    DvzMVP mvp;
+} BenchScene;
+
+
+
+typedef struct
+{
+    uint32_t setup_count; // number of requests processed once to create the objects
+    DvzRequest* setup;
+    uint32_t frame_count; // number of requests replayed at every frame
+    DvzRequest* frame;
+} BenchReplay;
+
+
+
+typedef struct
+{
+    double setup_time;
+    uint64_t requests;
+    DvzSize upload_bytes;
+    double upload_time;
+    double recorder_time;
+    double render_time;
+    double* frame_times;
+} BenchStats;
+
+
+
+/*************************************************************************************************/
+/*  Options                                                                                      */
+/*************************************************************************************************/
+
+static void _usage(void)
+{
+    log_error(
+        "usage: datoviz bench [<dump.dvz>] [--frames N] [--width W] [--height H] [--software] "
+        "[--threads N] [--markers N] [--paths N] [--path-length N] [--panels N] "
+        "[--save <scene.dvz>] [--output <metrics.json>] "
+        "[--micro ticks|visual_updates|shm_upload|axis_pan|codec]");
+}
+
+
+
+static int _parse(int argc, char** argv, BenchOptions* opts)
+{
+    ANN(argv);
+    ANN(opts);
+
+    // NOTE: argv[0] is the command name.
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--software") == 0)
+        {
+            opts->software = true;
+            continue;
+        }
+        if (strncmp(arg, "--", 2) != 0)
+        {
+            opts->dump = arg;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            log_error("missing value for option `%s`", arg);
+            return 1;
+        }
+        const char* value = argv[++i];
+
+        if (strcmp(arg, "--frames") == 0)
+            opts->frames = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--width") == 0)
+            opts->width = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--height") == 0)
+            opts->height = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--threads") == 0)
+            opts->threads = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--markers") == 0)
+            opts->markers = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--paths") == 0)
+            opts->paths = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--path-length") == 0)
+            opts->path_length = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--panels") == 0)
+            opts->panels = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--save") == 0)
+            opts->save = value;
+        else if (strcmp(arg, "--output") == 0)
+            opts->output = value;
+        else if (strcmp(arg, "--micro") == 0)
+            opts->micro = value;
+        else
+        {
+            log_error("unknown option `%s`", arg);
+            return 1;
+        }
+    }
+
+    if (opts->frames == 0 || opts->width == 0 || opts->height == 0 || opts->panels == 0 ||
+        (opts->paths > 0 && opts->path_length < 2))
+    {
+        log_error("invalid benchmark options");
+        return 1;
+    }
+    return 0;
+}
+
+
+
+/*************************************************************************************************/
+/*  Synthetic scene                                                                              */
+/*************************************************************************************************/
+
+static DvzId _graphics(DvzBatch* batch, DvzGraphicsType type, DvzId vertex, DvzId mvp, DvzId vp)
+{
+    ANN(batch);
+
+    DvzRequest req = dvz_create_graphics(batch, type, DVZ_REQUEST_FLAGS_OFFSCREEN);
+    DvzId graphics_id = req.id;
+    if (type == DVZ_GRAPHICS_TRIANGLE)
+        dvz_set_primitive(batch, graphics_id, DVZ_PRIMITIVE_TOPOLOGY_LINE_STRIP);
+    dvz_bind_vertex(batch, graphics_id, 0, vertex, 0);
+    dvz_bind_dat(batch, graphics_id, 0, mvp, 0);
+    dvz_bind_dat(batch, graphics_id, 1, vp, 0);
+    return graphics_id;
+}
+
+
+
+// Deterministic scene with markers and paths split across a grid of panels.
+static DvzBatch* _synthetic(BenchOptions* opts, BenchScene* scene)
+{
+    ANN(opts);
+    ANN(scene);
+
+    DvzBatch* batch = dvz_batch();
+    DvzRequest req = {0};
+
+    const uint32_t n = opts->markers;
+    const uint32_t m = opts->paths;
+    const uint32_t l = opts->path_length;
+    const uint32_t k = opts->panels;
+    const uint32_t cols = (uint32_t)ceil(sqrt((double)k));
+    const uint32_t rows = (k + cols - 1) / cols;
+    const uint32_t pw = opts->width / cols;
+    const uint32_t ph = opts->height / rows;
+
+    req = dvz_create_board(batch, opts->width, opts->height, DVZ_DEFAULT_CLEAR_COLOR, 0);
+    DvzId board_id = req.id;
+
+    // Markers on a spiral.
+    DvzId markers_id = 0;
+    if (n > 0)
+    {
+        scene->markers = (DvzGraphicsPointVertex*)calloc(n, sizeof(DvzGraphicsPointVertex));
+        ANN(scene->markers);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            float r = sqrtf((i + .5f) / n);
+            float t = 2.39996323f * i;
+            scene->markers[i].pos[0] = r * cosf(t);
+            scene->markers[i].pos[1] = r * sinf(t);
+            scene->markers[i].color[0] = (uint8_t)(255 * r);
+            scene->markers[i].color[1] = (uint8_t)(i % 256);
+            scene->markers[i].color[2] = 128;
+            scene->markers[i].color[3] = 192;
+            scene->markers[i].size = 2 + 8 * r;
+        }
+        DvzSize size = n * sizeof(DvzGraphicsPointVertex);
+        markers_id = dvz_create_dat(batch, DVZ_BUFFER_TYPE_VERTEX, size, 0).id;
+        dvz_upload_dat(batch, markers_id, 0, size, scene->markers, DVZ_UPLOAD_FLAGS_NOCOPY);
+    }
+
+    // Sine waves stacked vertically.
+    DvzId paths_id = 0;
+    if (m > 0)
+    {
+        scene->paths = (DvzVertex*)calloc(m * l, sizeof(DvzVertex));
+        ANN(scene->paths);
+        for (uint32_t p = 0; p < m; p++)
+        {
+            float y = -1 + 2 * (p + .5f) / m;
+            for (uint32_t i = 0; i < l; i++)
+            {
+                float x = -1 + 2.0f * i / (l - 1);
+                DvzVertex* v = &scene->paths[p * l + i];
+                v->pos[0] = x;
+                v->pos[1] = y + sinf(8 * x + p) / m;
+                v->color[0] = (uint8_t)(255 * p / m);
+                v->color[1] = 255;
+                v->color[2] = (uint8_t)(255 * i / l);
+                v->color[3] = 255;
+            }
+        }
+        DvzSize size = m * l * sizeof(DvzVertex);
+        paths_id = dvz_create_dat(batch, DVZ_BUFFER_TYPE_VERTEX, size, 0).id;
+        dvz_upload_dat(batch, paths_id, 0, size, scene->paths, DVZ_UPLOAD_FLAGS_NOCOPY);
+    }
+
+    // Shared MVP.
+    scene->mvp = dvz_mvp_default();
+    DvzId mvp_id = dvz_create_dat(batch, DVZ_BUFFER_TYPE_UNIFORM, sizeof(DvzMVP), 0).id;
+    dvz_upload_dat(batch, mvp_id, 0, sizeof(DvzMVP), &scene->mvp, DVZ_UPLOAD_FLAGS_NOCOPY);
+
+    // One viewport, and one graphics of each kind, per panel.
+    scene->viewports = (DvzViewport*)calloc(k, sizeof(DvzViewport));
+    ANN(scene->viewports);
+    DvzId* graphics = (DvzId*)calloc(2 * k, sizeof(DvzId));
+    ANN(graphics);
+    for (uint32_t j = 0; j < k; j++)
+    {
+        scene->viewports[j] = dvz_viewport_default(pw, ph);
+        DvzId vp_id = dvz_create_dat(batch, DVZ_BUFFER_TYPE_UNIFORM, sizeof(DvzViewport), 0).id;
+        dvz_upload_dat(
+            batch, vp_id, 0, sizeof(DvzViewport), &scene->viewports[j], DVZ_UPLOAD_FLAGS_NOCOPY);
+
+        if (n > 0)
+            graphics[2 * j + 0] = _graphics(batch, DVZ_GRAPHICS_POINT, markers_id, mvp_id, vp_id);
+        if (m > 0)
+            graphics[2 * j + 1] = _graphics(batch, DVZ_GRAPHICS_TRIANGLE, paths_id, mvp_id, vp_id);
+    }
+
+    // Commands: each panel draws its share of the markers, and one draw call per path.
+    dvz_record_begin(batch, board_id);
+    for (uint32_t j = 0; j < k; j++)
+    {
+        dvz_record_viewport(
+            batch, board_id, (vec2){(j % cols) * pw, (j / cols) * ph}, (vec2){pw, ph});
+
+        uint32_t first = j * n / k, last = (j + 1) * n / k;
+        if (last > first)
+            dvz_record_draw(batch, board_id, graphics[2 * j + 0], first, last - first, 0, 1);
+
+        for (uint32_t p = j * m / k; p < (j + 1) * m / k; p++)
+            dvz_record_draw(batch, board_id, graphics[2 * j + 1], p * l, l, 0, 1);
+    }
+    dvz_record_end(batch, board_id);
+    dvz_update_board(batch, board_id);
+
+    FREE(graphics);
+    return batch;
+}
+
+
+
+static void _scene_destroy(BenchScene* scene)
+{
+    ANN(scene);
+    FREE(scene->markers);
+    FREE(scene->paths);
+    FREE(scene->viewports);
+}
+
+
+
+/*************************************************************************************************/
+/*  Replay                                                                                       */
+/*************************************************************************************************/
+
+static inline bool _is_frame_request(DvzRequest* req)
+{
+    ANN(req);
+    return req->action == DVZ_REQUEST_ACTION_UPLOAD || req->action == DVZ_REQUEST_ACTION_RECORD ||
+           (req->action == DVZ_REQUEST_ACTION_UPDATE && req->type == DVZ_REQUEST_OBJECT_BOARD);
+}
+
+
+
+// Convert the canvas requests into board requests, the canvas resizes are dropped.
+static bool _offscreen(DvzRequest* req)
+{
+    ANN(req);
+
+    if (req->action == DVZ_REQUEST_ACTION_CREATE && req->type == DVZ_REQUEST_OBJECT_GRAPHICS)
+        req->flags |= DVZ_REQUEST_FLAGS_OFFSCREEN;
+    if (req->type != DVZ_REQUEST_OBJECT_CANVAS)
+        return true;
+    if (req->action == DVZ_REQUEST_ACTION_RESIZE)
+        return false;
+
+    if (req->action == DVZ_REQUEST_ACTION_CREATE)
+    {
+        uint32_t width = req->content.canvas.framebuffer_width;
+        uint32_t height = req->content.canvas.framebuffer_height;
+        if (width == 0 || height == 0)
+        {
+            width = req->content.canvas.screen_width;
+            height = req->content.canvas.screen_height;
+        }
+        cvec4 background = {0};
+        memcpy(background, req->content.canvas.background, sizeof(cvec4));
+
+        memset(&req->content, 0, sizeof(req->content));
+        req->content.board.width = width;
+        req->content.board.height = height;
+        memcpy(req->content.board.background, background, sizeof(cvec4));
+    }
+    req->type = DVZ_REQUEST_OBJECT_BOARD;
+    return true;
+}
+
+
+
+static BenchReplay _replay(DvzBatch* batch)
+{
+    ANN(batch);
+
+    // Make sure every board is rendered at every frame.
+    uint32_t count = dvz_batch_size(batch);
+    DvzRequest* reqs = dvz_batch_requests(batch);
+    bool has_update = false;
+    for (uint32_t i = 0; i < count; i++)
+        has_update |= reqs[i].action == DVZ_REQUEST_ACTION_UPDATE &&
+                      (reqs[i].type == DVZ_REQUEST_OBJECT_BOARD ||
+                       reqs[i].type == DVZ_REQUEST_OBJECT_CANVAS);
+    for (uint32_t i = 0; i < count && !has_update; i++)
+    {
+        // NOTE: the batch may be reallocated when adding requests.
+        DvzRequest req = dvz_batch_requests(batch)[i];
+        if (req.action == DVZ_REQUEST_ACTION_CREATE &&
+            (req.type == DVZ_REQUEST_OBJECT_BOARD || req.type == DVZ_REQUEST_OBJECT_CANVAS))
+            dvz_update_board(batch, req.id);
+    }
+
+    count = dvz_batch_size(batch);
+    reqs = dvz_batch_requests(batch);
+
+    BenchReplay replay = {0};
+    replay.setup = (DvzRequest*)calloc(count, sizeof(DvzRequest));
+    replay.frame = (DvzRequest*)calloc(count, sizeof(DvzRequest));
+    ANN(replay.setup);
+    ANN(replay.frame);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        DvzRequest req = reqs[i];
+        if (!_offscreen(&req))
+            continue;
+        replay.setup[replay.setup_count++] = req;
+        if (_is_frame_request(&req))
+            replay.frame[replay.frame_count++] = req;
+    }
+    return replay;
+}
+
+
+
+static double _process(DvzRenderer* rd, uint32_t count, DvzRequest* reqs, BenchStats* stats)
+{
+    ANN(rd);
+    ANN(reqs);
+    ANN(stats);
+
+    DvzClock clock = dvz_clock();
+    DvzRequest* req = NULL;
+    double start = 0, elapsed = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        req = &reqs[i];
+        start = dvz_clock_get(&clock);
+        dvz_renderer_request(rd, *req);
+        elapsed = dvz_clock_get(&clock) - start;
+
+        switch (req->action)
+        {
+        case DVZ_REQUEST_ACTION_UPLOAD:
+            stats->upload_time += elapsed;
+            stats->upload_bytes += req->type == DVZ_REQUEST_OBJECT_TEX
+                                       ? req->content.tex_upload.size
+                                       : req->content.dat_upload.size;
+            break;
+        case DVZ_REQUEST_ACTION_RECORD:
+            stats->recorder_time += elapsed;
+            break;
+        case DVZ_REQUEST_ACTION_UPDATE:
+            stats->render_time += elapsed;
+            break;
+        default:
+            break;
+        }
+    }
+    stats->requests += count;
+    return dvz_clock_get(&clock);
+}
+
+
+
+/*************************************************************************************************/
+/*  Micro-benchmarks                                                                             */
+/*************************************************************************************************/
+
+// Tick computation: random ranges never hit the cache, panning ranges use warm starts and hits.
+static void _micro_ticks(FILE* f, uint32_t rounds)
+{
+    ANN(f);
+
+    DvzTicks* ticks = dvz_ticks(0);
+    dvz_ticks_size(ticks, 800, 12);
+
+    uint32_t n = rounds * DVZ_BENCH_TICKS_RANGES;
+    double* ranges = (double*)calloc(2 * n, sizeof(double));
+    ANN(ranges);
+    srand(0);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        double center = (dvz_rand_double() - .5) * pow(10, (int)(dvz_rand_double() * 12) - 4);
+        double width = pow(10, dvz_rand_double() * 10 - 4);
+        ranges[2 * i + 0] = center - width / 2;
+        ranges[2 * i + 1] = center + width / 2;
+    }
+
+    DvzClock clock = dvz_clock();
+    for (uint32_t i = 0; i < n; i++)
+        dvz_ticks_compute(ticks, ranges[2 * i + 0], ranges[2 * i + 1], 8);
+    double random = dvz_clock_get(&clock);
+    DvzTicksStats stats = dvz_ticks_stats(ticks);
+
+    dvz_clock_reset(&clock);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        double x = .05 * (i % 40 < 20 ? i % 20 : 20 - i % 20);
+        dvz_ticks_compute(ticks, x, x + 10, 8);
+    }
+    double pan = dvz_clock_get(&clock);
+    DvzTicksStats pan_stats = dvz_ticks_stats(ticks);
+
+    fprintf(f, "{\n  \"benchmark\": \"ticks\",\n");
+    fprintf(f, "  \"ranges\": %u,\n", n);
+    fprintf(f, "  \"random_us\": %.3f,\n", 1e6 * random / n);
+    fprintf(f, "  \"random_candidates\": %" PRIu64 ",\n", stats.candidates);
+    fprintf(f, "  \"pan_us\": %.3f,\n", 1e6 * pan / n);
+    fprintf(f, "  \"pan_cache_hits\": %" PRIu64 ",\n", pan_stats.cache_hits - stats.cache_hits);
+    fprintf(
+        f, "  \"pan_warm_starts\": %" PRIu64 "\n}\n", pan_stats.warm_starts - stats.warm_starts);
+
+    FREE(ranges);
+    dvz_ticks_destroy(ticks);
+}
+
+
+
+// Release the upload sources of the requests emitted by a round, which no renderer consumes.
+static void _micro_clear(DvzBatch* batch)
+{
+    ANN(batch);
+    uint32_t count = dvz_batch_size(batch);
+    DvzRequest* reqs = dvz_batch_requests(batch);
+    for (uint32_t i = 0; i < count; i++)
+        if (reqs[i].action == DVZ_REQUEST_ACTION_UPLOAD)
+            dvz_upload_consume(&reqs[i]);
+    dvz_batch_clear(batch);
+}
+
+
+
+// Visual data updates: one call per attribute and visual, or a single dvz_visual_updates() call.
+static void _micro_visual_updates(FILE* f, uint32_t rounds)
+{
+    ANN(f);
+
+    const uint32_t visual_count = DVZ_BENCH_VISUALS;
+    const uint32_t n = DVZ_BENCH_VISUAL_SIZE;
+    DvzBatch* batch = dvz_batch();
+    DvzVisual** visuals = (DvzVisual**)calloc(visual_count, sizeof(DvzVisual*));
+    ANN(visuals);
+    for (uint32_t i = 0; i < visual_count; i++)
+    {
+        visuals[i] = dvz_visual(batch, DVZ_PRIMITIVE_TOPOLOGY_POINT_LIST, 0);
+        dvz_visual_shader(visuals[i], "graphics_basic");
+        dvz_visual_attr(visuals[i], 0, 0, sizeof(vec3), DVZ_FORMAT_R32G32B32_SFLOAT, 0);
+        dvz_visual_attr(
+            visuals[i], 1, sizeof(vec3), sizeof(cvec4), DVZ_FORMAT_R8G8B8A8_UNORM, 0);
+        dvz_visual_alloc(visuals[i], n, n, 0);
+    }
+
+    vec3* pos = (vec3*)calloc(n, sizeof(vec3));
+    cvec4* color = (cvec4*)calloc(n, sizeof(cvec4));
+    ANN(pos);
+    ANN(color);
+    uint32_t update_count = 2 * visual_count;
+    DvzVisualUpdate* updates = (DvzVisualUpdate*)calloc(update_count, sizeof(DvzVisualUpdate));
+    ANN(updates);
+    for (uint32_t i = 0; i < visual_count; i++)
+    {
+        updates[2 * i + 0] = (DvzVisualUpdate){visuals[i], 0, 0, n, pos};
+        updates[2 * i + 1] = (DvzVisualUpdate){visuals[i], 1, 0, n, color};
+    }
+    _micro_clear(batch);
+
+    DvzClock clock = dvz_clock();
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        for (uint32_t i = 0; i < update_count; i++)
+            dvz_visual_data(
+                updates[i].visual, updates[i].attr_idx, updates[i].first, updates[i].count,
+                updates[i].data);
+        for (uint32_t i = 0; i < visual_count; i++)
+            dvz_visual_update(visuals[i]);
+        _micro_clear(batch);
+    }
+    double individual = dvz_clock_get(&clock);
+
+    dvz_clock_reset(&clock);
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        dvz_visual_updates(update_count, updates);
+        _micro_clear(batch);
+    }
+    double batched = dvz_clock_get(&clock);
+
+    double total = (double)rounds * update_count;
+    fprintf(f, "{\n  \"benchmark\": \"visual_updates\",\n");
+    fprintf(f, "  \"visuals\": %u,\n", visual_count);
+    fprintf(f, "  \"updates\": %.0f,\n", total);
+    fprintf(f, "  \"individual_per_second\": %.1f,\n", individual > 0 ? total / individual : 0);
+    fprintf(f, "  \"batched_per_second\": %.1f\n}\n", batched > 0 ? total / batched : 0);
+
+    for (uint32_t i = 0; i < visual_count; i++)
+        dvz_visual_destroy(visuals[i]);
+    dvz_batch_destroy(batch);
+    FREE(visuals);
+    FREE(updates);
+    FREE(pos);
+    FREE(color);
+}
+
+
+
+// Axis updates while panning continuously over a range with a tick at each integer.
+static void _micro_axis_pan(FILE* f, uint32_t rounds)
+{
+    ANN(f);
+
+    DvzBatch* batch = dvz_batch();
+    DvzAxis* axis = dvz_axis(batch, 0);
+    dvz_axis_size(axis, 24);
+    _micro_clear(batch);
+
+    vec3 p0 = {-1, -1, 0};
+    vec3 p1 = {+1, -1, 0};
+    vec3 vector = {0, 1, 0};
+    double width = 10;
+    double values[16] = {0};
+    uint32_t index[16] = {0};
+    uint32_t length[16] = {0};
+    char glyphs[16 * 8] = {0};
+
+    uint32_t n = rounds * DVZ_BENCH_AXIS_STEPS;
+    DvzClock clock = dvz_clock();
+    for (uint32_t step = 0; step < n; step++)
+    {
+        double dmin = -100 + .05 * step;
+        double dmax = dmin + width;
+
+        uint32_t tick_count = 0;
+        uint32_t glyph_count = 0;
+        for (int32_t k = (int32_t)ceil(dmin); k <= (int32_t)floor(dmax); k++)
+        {
+            values[tick_count] = k;
+            index[tick_count] = glyph_count;
+            length[tick_count] = (uint32_t)snprintf(&glyphs[glyph_count], 8, "%d", k);
+            glyph_count += length[tick_count] + 1;
+            tick_count++;
+        }
+
+        DvzTickSpec spec = dvz_tick_spec(
+            p0, p1, vector, dmin, dmax, tick_count, values, glyph_count, glyphs, index, length);
+        dvz_axis_ticks(axis, &spec);
+        _micro_clear(batch);
+    }
+    double elapsed = dvz_clock_get(&clock);
+    DvzAxisStats stats = dvz_axis_stats(axis);
+
+    fprintf(f, "{\n  \"benchmark\": \"axis_pan\",\n");
+    fprintf(f, "  \"updates\": %u,\n", n);
+    fprintf(f, "  \"update_us\": %.3f,\n", 1e6 * elapsed / n);
+    fprintf(f, "  \"labels_reused\": %" PRIu64 ",\n", stats.labels_reused);
+    fprintf(f, "  \"labels_created\": %" PRIu64 ",\n", stats.labels_created);
+    fprintf(f, "  \"reallocs\": %" PRIu64 "\n}\n", stats.reallocs);
+
+    dvz_axis_destroy(axis);
+    dvz_batch_destroy(batch);
+}
+
+
+
+// Dat uploads to the software renderer: copied by the requester, or from a shared-memory block.
+static void _micro_shm_upload(FILE* f, uint32_t rounds)
+{
+    ANN(f);
+
+    const DvzSize size = DVZ_BENCH_UPLOAD_SIZE;
+    DvzSoft* soft = dvz_soft(0);
+    DvzBatch* batch = dvz_batch();
+    DvzRequest req = dvz_create_dat(batch, DVZ_BUFFER_TYPE_STORAGE, size, 0);
+    DvzId dat_id = req.id;
+    dvz_soft_request(soft, req);
+
+    DvzShm* shm = dvz_shm(size);
+    ANN(shm);
+    DvzSize shm_offset = 0;
+    uint8_t* data = (uint8_t*)dvz_shm_alloc(shm, size, &shm_offset);
+    ANN(data);
+    for (uint32_t i = 0; i < size; i++)
+        data[i] = (uint8_t)(i % 251);
+
+    DvzClock clock = dvz_clock();
+    for (uint32_t i = 0; i < rounds; i++)
+        dvz_soft_request(soft, dvz_upload_dat(batch, dat_id, 0, size, data, 0));
+    double direct = dvz_clock_get(&clock);
+
+    dvz_clock_reset(&clock);
+    for (uint32_t i = 0; i < rounds; i++)
+        dvz_soft_request(soft, dvz_upload_dat_shm(batch, dat_id, 0, shm, shm_offset, size));
+    double shared = dvz_clock_get(&clock);
+
+    double total = (double)rounds * size;
+    fprintf(f, "{\n  \"benchmark\": \"shm_upload\",\n");
+    fprintf(f, "  \"upload_bytes\": %" PRIu64 ",\n", size);
+    fprintf(f, "  \"uploads\": %u,\n", rounds);
+    fprintf(f, "  \"direct_gbps\": %.3f,\n", direct > 0 ? total / direct / 1e9 : 0);
+    fprintf(f, "  \"shm_gbps\": %.3f\n}\n", shared > 0 ? total / shared / 1e9 : 0);
+
+    dvz_shm_unref(shm, shm_offset);
+    dvz_shm_destroy(shm);
+    dvz_batch_destroy(batch);
+    dvz_soft_destroy(soft);
+}
+
+
+
+// Compression of sorted timestamps, with and without the filters, and on worker threads.
+static void _micro_codec(FILE* f, uint32_t rounds)
+{
+    ANN(f);
+
+    const uint32_t n = DVZ_BENCH_CODEC_ITEMS;
+    const DvzSize size = n * sizeof(double);
+    const int filter = DVZ_CODEC_FILTER_SHUFFLE | DVZ_CODEC_FILTER_DELTA;
+    double* times = (double*)malloc(size);
+    ANN(times);
+    for (uint32_t i = 0; i < n; i++)
+        times[i] = 1e9 + i * 0.001;
+    void* compressed = malloc(dvz_codec_bound(size));
+    ANN(compressed);
+
+    DvzSize raw = dvz_codec_compress(times, size, 0, DVZ_CODEC_FILTER_NONE, compressed);
+    DvzSize filtered = 0;
+    DvzClock clock = dvz_clock();
+    for (uint32_t i = 0; i < rounds; i++)
+        filtered = dvz_codec_compress(times, size, sizeof(double), filter, compressed);
+    double serial = dvz_clock_get(&clock);
+
+    // The same payload split into jobs compressed in parallel.
+    DvzCodecJob jobs[DVZ_BENCH_CODEC_JOBS] = {0};
+    dvz_clock_reset(&clock);
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        for (uint32_t j = 0; j < DVZ_BENCH_CODEC_JOBS; j++)
+        {
+            jobs[j].src = (uint8_t*)times + j * (size / DVZ_BENCH_CODEC_JOBS);
+            jobs[j].size = size / DVZ_BENCH_CODEC_JOBS;
+            jobs[j].item_size = sizeof(double);
+            jobs[j].filter = filter;
+        }
+        dvz_codec_jobs(DVZ_BENCH_CODEC_JOBS, jobs, 0);
+        for (uint32_t j = 0; j < DVZ_BENCH_CODEC_JOBS; j++)
+            FREE(jobs[j].dst);
+    }
+    double parallel = dvz_clock_get(&clock);
+
+    // NOTE: incompressible payloads have a compressed size of 0 and are sent as they are.
+    double total = (double)rounds * size;
+    fprintf(f, "{\n  \"benchmark\": \"codec\",\n");
+    fprintf(f, "  \"payload_bytes\": %" PRIu64 ",\n", size);
+    fprintf(f, "  \"rounds\": %u,\n", rounds);
+    fprintf(f, "  \"ratio_raw\": %.4f,\n", (double)(raw > 0 ? raw : size) / size);
+    fprintf(f, "  \"ratio_filtered\": %.4f,\n", (double)(filtered > 0 ? filtered : size) / size);
+    fprintf(f, "  \"serial_gbps\": %.3f,\n", serial > 0 ? total / serial / 1e9 : 0);
+    fprintf(f, "  \"jobs_gbps\": %.3f\n}\n", parallel > 0 ? total / parallel / 1e9 : 0);
+
+    FREE(compressed);
+    FREE(times);
+}
+
+
+
+static int _micro(BenchOptions* opts)
+{
+    ANN(opts);
+    ANN(opts->micro);
+
+    FILE* f = opts->output != NULL ? fopen(opts->output, "w") : stdout;
+    if (f == NULL)
+    {
+        log_error("unable to write `%s`", opts->output);
+        return 1;
+    }
+
+    int res = 0;
+    if (strcmp(opts->micro, "ticks") == 0)
+        _micro_ticks(f, opts->frames);
+    else if (strcmp(opts->micro, "visual_updates") == 0)
+        _micro_visual_updates(f, opts->frames);
+    else if (strcmp(opts->micro, "shm_upload") == 0)
+        _micro_shm_upload(f, opts->frames);
+    else if (strcmp(opts->micro, "axis_pan") == 0)
+        _micro_axis_pan(f, opts->frames);
+    else if (strcmp(opts->micro, "codec") == 0)
+        _micro_codec(f, opts->frames);
+    else
+    {
+        log_error("unknown micro-benchmark `%s`", opts->micro);
+        res = 1;
+    }
+
+    if (f != stdout)
+        fclose(f);
+    return res;
+}
+
+
+
+/*************************************************************************************************/
+/*  Output                                                                                       */
+/*************************************************************************************************/
+
+static int _compare(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+
+
+// Nearest-rank percentile of sorted values.
+static inline double _percentile(uint32_t count, double* sorted, double p)
+{
+    ASSERT(count > 0);
+    uint32_t rank = (uint32_t)ceil(p / 100.0 * count);
+    return sorted[CLIP(rank, 1u, count) - 1];
+}
+
+
+
+static void _json_string(FILE* f, const char* s)
+{
+    ANN(f);
+    fputc('"', f);
+    for (; s != NULL && *s != 0; s++)
+    {
+        if (*s == '"' || *s == '\\')
+            fputc('\\', f);
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+
+
+static void _json(FILE* f, BenchOptions* opts, BenchReplay* replay, BenchStats* stats)
+{
+    ANN(f);
+    ANN(opts);
+    ANN(replay);
+    ANN(stats);
+
+    const uint32_t n = opts->frames;
+    const DvzSize frame_upload = stats->upload_bytes / n;
+    double total = 0;
+    for (uint32_t i = 0; i < n; i++)
+        total += stats->frame_times[i];
+    qsort(stats->frame_times, n, sizeof(double), _compare);
+
+    fprintf(f, "{\n  \"source\": ");
+    _json_string(f, opts->dump != NULL ? opts->dump : "synthetic");
+    fprintf(f, ",\n  \"renderer\": \"%s\",\n", opts->software ? "software" : "vulkan");
+    if (opts->dump == NULL)
+        fprintf(
+            f,
+            "  \"scene\": {\"markers\": %u, \"paths\": %u, \"path_length\": %u, "
+            "\"panels\": %u, \"width\": %u, \"height\": %u},\n",
+            opts->markers, opts->paths, opts->path_length, opts->panels, opts->width,
+            opts->height);
+    fprintf(f, "  \"frames\": %u,\n", n);
+    fprintf(f, "  \"requests_per_frame\": %u,\n", replay->frame_count);
+    fprintf(f, "  \"setup_ms\": %.3f,\n", 1000 * stats->setup_time);
+    fprintf(f, "  \"requests_per_second\": %.1f,\n", total > 0 ? stats->requests / total : 0);
+    fprintf(f, "  \"upload_bytes_per_frame\": %" PRIu64 ",\n", frame_upload);
+    fprintf(
+        f, "  \"upload_gbps\": %.3f,\n",
+        stats->upload_time > 0 ? stats->upload_bytes / stats->upload_time / 1e9 : 0);
+    fprintf(f, "  \"recorder_ms\": %.3f,\n", 1000 * stats->recorder_time / n);
+    fprintf(f, "  \"render_ms\": %.3f,\n", 1000 * stats->render_time / n);
+    fprintf(
+        f,
+        "  \"frame_ms\": {\"mean\": %.3f, \"min\": %.3f, \"p50\": %.3f, \"p90\": %.3f, "
+        "\"p99\": %.3f, \"max\": %.3f}\n}\n",
+        1000 * total / n, 1000 * stats->frame_times[0],
+        1000 * _percentile(n, stats->frame_times, 50),
+        1000 * _percentile(n, stats->frame_times, 90),
+        1000 * _percentile(n, stats->frame_times, 99), 1000 * stats->frame_times[n - 1]);
+}
+
+
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+int dvz_bench(int argc, char** argv)
+{
+    BenchOptions opts = {
+        .frames = DVZ_BENCH_FRAMES,
+        .width = DVZ_BENCH_WIDTH,
+        .height = DVZ_BENCH_HEIGHT,
+        .markers = DVZ_BENCH_MARKERS,
+        .paths = DVZ_BENCH_PATHS,
+        .path_length = DVZ_BENCH_PATH_LENGTH,
+        .panels = DVZ_BENCH_PANELS,
+    };
+    if (_parse(argc, argv, &opts) != 0)
+    {
+        _usage();
+        return 1;
+    }
+    if (opts.micro != NULL)
+        return _micro(&opts);
+
+    // Requests.
+    BenchScene scene = {0};
+    DvzBatch* batch = NULL;
+    if (opts.dump != NULL)
+    {
+        batch = dvz_batch();
+        dvz_batch_load(batch, opts.dump);
+        if (dvz_batch_size(batch) == 0)
+        {
+            log_error("no request to replay in `%s`", opts.dump);
+            dvz_batch_destroy(batch);
+            return 1;
+        }
+    }
+    else
+    {
+        batch = _synthetic(&opts, &scene);
+        if (opts.save != NULL && dvz_batch_dump(batch, opts.save) != 0)
+            log_error("unable to save the synthetic scene to `%s`", opts.save);
+    }
+    BenchReplay replay = _replay(batch);
+
+    // Renderer.
+    DvzHost* host = NULL;
+    DvzGpu* gpu = NULL;
+    DvzRenderer* rd = NULL;
+    if (opts.software)
+    {
+        rd = dvz_renderer(NULL, DVZ_RENDERER_FLAGS_SOFTWARE);
+        if (opts.threads > 0)
+            dvz_soft_threads(rd->soft, opts.threads);
+    }
+    else
+    {
+        host = dvz_host(DVZ_BACKEND_OFFSCREEN);
+        gpu = dvz_gpu_best(host);
+        _default_queues(gpu, false);
+        dvz_gpu_create(gpu, 0);
+        rd = dvz_renderer(gpu, 0);
+    }
+    ANN(rd);
+
+    // Replay.
+    BenchStats stats = {0};
+    stats.setup_time = _process(rd, replay.setup_count, replay.setup, &stats);
+    stats = (BenchStats){.setup_time = stats.setup_time};
+    stats.frame_times = (double*)calloc(opts.frames, sizeof(double));
+    ANN(stats.frame_times);
+    for (uint32_t i = 0; i < opts.frames; i++)
+        stats.frame_times[i] = _process(rd, replay.frame_count, replay.frame, &stats);
+
+    // Metrics.
+    int res = 0;
+    FILE* f = opts.output != NULL ? fopen(opts.output, "w") : stdout;
+    if (f != NULL)
+    {
+        _json(f, &opts, &replay, &stats);
+        if (f != stdout)
+            fclose(f);
+    }
+    else
+    {
+        log_error("unable to write `%s`", opts.output);
+        res = 1;
+    }
+
+    FREE(stats.frame_times);
+    FREE(replay.setup);
+    FREE(replay.frame);
+    dvz_renderer_destroy(rd);
+    if (gpu != NULL)
+        dvz_gpu_destroy(gpu);
+    if (host != NULL)
+        dvz_host_destroy(host);
+    dvz_batch_destroy(batch);
+    _scene_destroy(&scene);
+    return res;
+}
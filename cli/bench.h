@@ -0,0 +1,64 @@
+/*************************************************************************************************/
+/*  Benchmark: replay of batch dumps and synthetic scenes through a board renderer               */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_BENCH
+#define DVZ_HEADER_BENCH
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "_macros.h"
+
+
+
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+#define DVZ_BENCH_FRAMES      100
+#define DVZ_BENCH_WIDTH       1024
+#define DVZ_BENCH_HEIGHT      768
+#define DVZ_BENCH_MARKERS     100000
+#define DVZ_BENCH_PATHS       100
+#define DVZ_BENCH_PATH_LENGTH 1000
+#define DVZ_BENCH_PANELS      4
+
+#define DVZ_BENCH_TICKS_RANGES 100 // tick ranges per round of the ticks micro-benchmark
+#define DVZ_BENCH_VISUALS      64  // visuals updated by the visual_updates micro-benchmark
+#define DVZ_BENCH_VISUAL_SIZE  256 // number of items of each of these visuals
+#define DVZ_BENCH_UPLOAD_SIZE  (16 * 1024 * 1024) // size of the shm_upload uploads
+#define DVZ_BENCH_AXIS_STEPS   10 // axis updates per round of the axis_pan micro-benchmark
+#define DVZ_BENCH_CODEC_ITEMS  (1024 * 1024) // timestamps compressed by the codec micro-benchmark
+#define DVZ_BENCH_CODEC_JOBS   4             // jobs the codec payload is split into
+
+
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+/**
+ * Replay a batch dump or a synthetic scene for a fixed number of frames, and print the metrics as
+ * JSON.
+ *
+ * The batch is processed once to create the objects, then its upload, record and board update
+ * requests are replayed at every frame. Canvases are replayed as offscreen boards.
+ *
+ * With `--micro <name>`, a micro-benchmark of a single library component is run instead, for
+ * `--frames` rounds: `ticks` for the tick computation, `visual_updates` for the visual data
+ * updates, `shm_upload` for the shared-memory uploads, `axis_pan` for the axis updates, `codec`
+ * for the payload compression.
+ *
+ * @param argc the number of arguments, the first one being the command name
+ * @param argv the arguments
+ * @returns 0 on success
+ */
+int dvz_bench(int argc, char** argv);
+
+
+
+#endif
@@ -10,7 +10,11 @@
 
 #include "main.h"
 #include "_macros.h"
+#include "bench.h"
 #include "common.h"
+#include "fileio.h"
+#include "scene/atlas.h"
+#include "scene/meshobj.h"
 #include "test.h"
 
 
@@ -38,6 +42,56 @@ static int test(int argc, char** argv)
 
 
 
+// Generate a precompiled font atlas bundle: datoviz atlas <font.ttf> <output.dvza>
+static int atlas(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        log_error("usage: datoviz atlas <font.ttf> <output%s>", DVZ_ATLAS_BUNDLE_EXTENSION);
+        return 1;
+    }
+
+    DvzSize ttf_size = 0;
+    unsigned char* ttf_bytes = (unsigned char*)dvz_read_file(argv[1], &ttf_size);
+    if (ttf_bytes == NULL)
+        return 1;
+
+    DvzAtlas* font_atlas = dvz_atlas(ttf_size, ttf_bytes);
+    dvz_atlas_generate(font_atlas);
+    int res = dvz_atlas_bundle_export(font_atlas, argv[2]);
+
+    dvz_atlas_destroy(font_atlas);
+    FREE(ttf_bytes);
+    return res;
+}
+
+
+
+// Convert an OBJ file to a binary mesh file: datoviz mesh <mesh.obj> <output.dvzm>
+static int mesh(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        log_error("usage: datoviz mesh <mesh.obj> <output%s>", DVZ_MESH_EXTENSION);
+        return 1;
+    }
+
+    DvzShape shape = dvz_shape_obj(argv[1]);
+    if (shape.vertex_count == 0)
+        return 1;
+
+    int res = dvz_shape_export(&shape, argv[2]);
+    dvz_shape_destroy(&shape);
+    return res;
+}
+
+
+
+// Replay a batch dump or a synthetic scene and print JSON metrics: datoviz bench [<dump.dvz>]
+static int bench(int argc, char** argv) { return dvz_bench(argc, argv); }
+
+
+
 static int info(int argc, char** argv)
 {
     // TODO
@@ -51,7 +105,7 @@ int main(int argc, char** argv)
     log_set_level_env();
     if (argc <= 1)
     {
-        log_error("specify a command: info, demo, test");
+        log_error("specify a command: info, demo, test, atlas, mesh, bench");
         return 1;
     }
     ASSERT(argc >= 2);
@@ -59,6 +113,9 @@ int main(int argc, char** argv)
 
     SWITCH_CLI_ARG(info)
     SWITCH_CLI_ARG(test)
+    SWITCH_CLI_ARG(atlas)
+    SWITCH_CLI_ARG(mesh)
+    SWITCH_CLI_ARG(bench)
     // SWITCH_CLI_ARG(demo)
 
     return res;
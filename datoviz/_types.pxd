@@ -215,6 +215,7 @@ cdef extern from "<datoviz/common.h>":
     ctypedef enum DvzRendererFlags:
         DVZ_RENDERER_FLAGS_NONE = 0
         DVZ_RENDERER_FLAGS_WHITE_BACKGROUND = 1
+        DVZ_RENDERER_FLAGS_SOFTWARE = 2
 
     ctypedef enum DvzSlotType:
         DVZ_SLOT_DAT = 0
@@ -424,5 +425,9 @@ cdef extern from "<datoviz/common.h>":
         DVZ_PROP_CONSTANT = 0x01
         DVZ_PROP_DYNAMIC = 0x02
 
+    ctypedef enum DvzUploadType:
+        DVZ_UPLOAD_TYPE_DIRECT = 0
+        DVZ_UPLOAD_TYPE_SHM = 1
+
 
     # ENUM END
@@ -3,7 +3,7 @@
 from ._types cimport *
 
 
-cdef extern from "<datoviz/scene/app.h>":
+cdef extern from "<datoviz/scene/app.h>" nogil:
     ctypedef struct DvzApp:
         pass
 
@@ -19,6 +19,9 @@ cdef extern from "<datoviz/scene/app.h>":
     ctypedef struct DvzRequest:
         pass
 
+    ctypedef struct DvzBatch:
+        pass
+
     # ctypedef struct DvzVisual:
     #     pass
 
@@ -167,6 +170,10 @@ cdef extern from "<datoviz/scene/app.h>":
 
     DvzRequester* dvz_app_requester(DvzApp* app)
 
+    DvzBatch* dvz_app_batch(DvzApp* app)
+
+    void dvz_app_submit(DvzApp* app)
+
     void dvz_app_frame(DvzApp* app)
 
     void dvz_app_onframe(DvzApp* app, DvzClientCallback on_frame, void* user_data)
@@ -14,7 +14,8 @@ from . cimport scene as sc
 from . cimport request as rq
 from . cimport fileio
 from libc.stdlib cimport free
-from cpython.ref cimport Py_INCREF
+from cpython.buffer cimport PyObject_GetBuffer, PyBuffer_Release, PyBUF_RECORDS_RO
+from cpython.ref cimport Py_INCREF, Py_DECREF
 from cython.view cimport array
 
 import traceback
@@ -35,12 +36,108 @@ logger = logging.getLogger('datoviz')
 WIDTH = 800
 HEIGHT = 600
 
+# NOTE: mirrors the DvzVisualUpdate C struct, so that an array of updates can be passed as is.
+UPDATE_DTYPE = np.dtype([
+    ('visual', np.uintp),
+    ('attr_idx', np.uint32),
+    ('first', np.uint32),
+    ('count', np.uint32),
+    ('data', np.uintp),
+], align=True)
+
 
 # -------------------------------------------------------------------------------------------------
 # Util functions
 # -------------------------------------------------------------------------------------------------
 
 
+# -------------------------------------------------------------------------------------------------
+# Zero-copy uploads
+# -------------------------------------------------------------------------------------------------
+
+cdef class _PinnedBuffer:
+    """Keep an object exporting the buffer protocol alive until the renderer has consumed it."""
+
+    cdef Py_buffer view
+    cdef bint acquired
+
+    def __cinit__(self, obj):
+        PyObject_GetBuffer(obj, &self.view, PyBUF_RECORDS_RO)
+        self.acquired = True
+
+    def __dealloc__(self):
+        if self.acquired:
+            PyBuffer_Release(&self.view)
+            self.acquired = False
+
+
+cdef void _release_pinned(void* user_data) with gil:
+    """Called by the renderer, possibly in another thread, once the upload has been done."""
+    Py_DECREF(<object>user_data)
+
+
+cdef _pin(obj):
+    """Pin a buffer, and return its layout as a list of items that may be strided.
+
+    The first dimension may have any positive stride, but the items (the other dimensions) must be
+    contiguous. Otherwise, the buffer is first copied into a C-contiguous array.
+
+    """
+    cdef _PinnedBuffer pinned = _PinnedBuffer(obj)
+    cdef Py_buffer* view = &pinned.view
+    cdef Py_ssize_t count = 1
+    cdef Py_ssize_t item_size = view.len
+    cdef Py_ssize_t stride = view.len
+    cdef Py_ssize_t expected = view.itemsize
+    cdef int k
+
+    if view.ndim > 0 and view.strides != NULL:
+        count = view.shape[0]
+        item_size = view.itemsize
+        for k in range(view.ndim - 1, 0, -1):
+            if view.shape[k] > 1 and view.strides[k] != expected:
+                # Non-contiguous items: gather them with NumPy, the copy is then pinned.
+                return _pin(np.ascontiguousarray(obj))
+            expected *= view.shape[k]
+            item_size *= view.shape[k]
+        stride = view.strides[0] if count > 1 else item_size
+        if stride < item_size:
+            # Negative or overlapping strides.
+            return _pin(np.ascontiguousarray(obj))
+    elif view.ndim > 0:
+        # C-contiguous buffer.
+        count = view.shape[0]
+        item_size = view.len // count if count > 0 else 0
+        stride = item_size
+
+    return pinned, count, item_size, stride
+
+
+# -------------------------------------------------------------------------------------------------
+# Batched updates
+# -------------------------------------------------------------------------------------------------
+
+def visual_updates(items):
+    """Describe many visual attribute updates in a single structured array.
+
+    Each item is a tuple `(visual, attr_idx, data)` or `(visual, attr_idx, data, first)`, where
+    `data` is an array with one row per item. Return the UPDATE_DTYPE records to be passed to
+    `App.apply_updates()`, and the list of contiguous arrays they point to, which must be kept
+    alive until then.
+
+    """
+    items = list(items)
+    records = np.zeros(len(items), dtype=UPDATE_DTYPE)
+    arrays = []
+    for i, item in enumerate(items):
+        visual, attr_idx, data = item[:3]
+        first = item[3] if len(item) > 3 else 0
+        data = np.ascontiguousarray(data)
+        arrays.append(data)
+        records[i] = (visual.handle, attr_idx, first, data.shape[0], data.ctypes.data)
+    return records, arrays
+
+
 # -------------------------------------------------------------------------------------------------
 # Visual
 # -------------------------------------------------------------------------------------------------
@@ -69,20 +166,28 @@ cdef class Visual:
         self._c_visual = sg.dvz_segment(self._c_rqr, 0)
         sg.dvz_segment_alloc(self._c_visual, count)
 
+    @property
+    def handle(self):
+        """Address of the C visual, used in the `visual` field of UPDATE_DTYPE records."""
+        return <size_t>self._c_visual
+
     def initial(self, np.ndarray[dtype=float, ndim=2] arr):
         # self._arr_pos[:] = arr
         cdef vec3 * data = <vec3*> & arr.data[0]
-        sg.dvz_segment_initial(self._c_visual, 0, self._c_count, data, 0)
+        with nogil:
+            sg.dvz_segment_initial(self._c_visual, 0, self._c_count, data, 0)
 
     def terminal(self, np.ndarray[dtype=float, ndim=2] arr):
         # self._arr_pos[:] = arr
         cdef vec3 * data = <vec3*> & arr.data[0]
-        sg.dvz_segment_terminal(self._c_visual, 0, self._c_count, data, 0)
+        with nogil:
+            sg.dvz_segment_terminal(self._c_visual, 0, self._c_count, data, 0)
 
     def linewidth(self, np.ndarray[dtype=float, ndim=1] arr):
         # self._arr_pos[:] = arr
         cdef float * data = <float*> & arr.data[0]
-        sg.dvz_segment_linewidth(self._c_visual, 0, self._c_count, data, 0)
+        with nogil:
+            sg.dvz_segment_linewidth(self._c_visual, 0, self._c_count, data, 0)
 
     # def position(self, np.ndarray[dtype=float, ndim=2] arr):
     #     self._arr_pos[:] = arr
@@ -93,14 +198,16 @@ cdef class Visual:
         # self._arr_color[:] = arr
         cdef cvec4 * data = <cvec4*> & arr.data[0]
         # px.dvz_pixel_color(self._c_visual, 0, self._c_count, data, 0)
-        sg.dvz_segment_color(self._c_visual, 0, self._c_count, data, 0)
+        with nogil:
+            sg.dvz_segment_color(self._c_visual, 0, self._c_count, data, 0)
 
     def update(self):
         # NOTE: important: wrap the requests between begin and end, otherwise they won't be sent to
         # the renderer.
-        rq.dvz_requester_begin(self._c_rqr)
-        sc.dvz_visual_update(self._c_visual)
-        rq.dvz_requester_end(self._c_rqr, NULL)
+        with nogil:
+            rq.dvz_requester_begin(self._c_rqr)
+            sc.dvz_visual_update(self._c_visual)
+            rq.dvz_requester_end(self._c_rqr, NULL)
 
 
 # -------------------------------------------------------------------------------------------------
@@ -211,12 +318,15 @@ cdef class Scene:
     def run(self, int n=0, unicode screenshot=None):
         cdef char* _c_path = screenshot
 
+        # NOTE: the GIL is released during the event loop, the Python callbacks acquire it.
         # Make screenshot at the first frame.
         if screenshot:
-            sc.dvz_scene_run(self._c_scene, self._c_app, 10)
-            pt.dvz_app_screenshot(self._c_app, 0, _c_path)
+            with nogil:
+                sc.dvz_scene_run(self._c_scene, self._c_app, 10)
+                pt.dvz_app_screenshot(self._c_app, 0, _c_path)
 
-        sc.dvz_scene_run(self._c_scene, self._c_app, n)
+        with nogil:
+            sc.dvz_scene_run(self._c_scene, self._c_app, n)
 
 
 # -------------------------------------------------------------------------------------------------
@@ -301,11 +411,11 @@ cdef class Scene:
 
 
 
-cdef _wrapped_callback(pt.DvzClient* c_client, pt.DvzClientEvent c_ev):
+cdef void _wrapped_callback(pt.DvzClient* c_client, pt.DvzClientEvent c_ev) with gil:
     """C callback function that wraps a Python callback function."""
 
-    # NOTE: this function may run in a background thread if using async callbacks
-    # It should not acquire the GIL.
+    # NOTE: this function may run in a background thread if using async callbacks, and the event
+    # loop runs without the GIL, so the GIL is acquired here.
 
     cdef object tup
     if c_ev.user_data != NULL:
@@ -389,15 +499,94 @@ cdef class App:
     def visual(self, count):
         return Visual(self, count)
 
+    def upload_dat(self, DvzId dat, data, DvzSize offset=0):
+        """Upload any object exporting the buffer protocol to a dat, without copy.
+
+        The buffer is kept alive until the renderer has gathered it into the GPU memory, so it
+        must not be modified until then. Strided arrays (e.g. `arr[::2]` or a field of a
+        structured array) are gathered in a single pass, and written contiguously in the dat.
+
+        """
+        pinned, count, item_size, stride = _pin(data)
+        if count == 0 or item_size == 0:
+            return
+        cdef _PinnedBuffer c_pinned = pinned
+
+        # NOTE: the reference is released by _release_pinned(), called by the renderer.
+        Py_INCREF(c_pinned)
+        rq.dvz_upload_dat_strided(
+            <rq.DvzBatch*>pt.dvz_app_batch(self._c_app), dat, offset, count, item_size, stride,
+            c_pinned.view.buf, _release_pinned, <void*>c_pinned)
+
+    def apply_updates(self, np.ndarray records):
+        """Apply many visual attribute updates, described by UPDATE_DTYPE records, in one C call.
+
+        The GIL is released while the updates are applied. The arrays pointed to by the `data`
+        fields must remain alive during the call (see `visual_updates()`).
+
+        """
+        if records.dtype != UPDATE_DTYPE:
+            raise ValueError("the updates must be an array with dtype UPDATE_DTYPE")
+        if records.ndim != 1 or not records.flags.c_contiguous:
+            raise ValueError("the updates must be a contiguous 1D array")
+        cdef tp.uint32_t count = records.shape[0]
+        cdef sc.DvzVisualUpdate* c_updates = <sc.DvzVisualUpdate*>records.data
+        if count == 0:
+            return
+        with nogil:
+            rq.dvz_requester_begin(self._c_rqr)
+            sc.dvz_visual_updates(count, c_updates)
+            rq.dvz_requester_end(self._c_rqr, NULL)
+
+    def pending_requests(self):
+        """Return and clear the requests pending in the app batch, used by the tests.
+
+        Each request is a tuple `(action, type, id, data)`, where `data` is a copy of the bytes
+        of a direct dat upload (gathered if strided), and None for the other requests.
+
+        """
+        cdef rq.DvzBatch* batch = <rq.DvzBatch*>pt.dvz_app_batch(self._c_app)
+        cdef tp.uint32_t count = rq.dvz_batch_size(batch)
+        cdef rq.DvzRequest* reqs = rq.dvz_batch_requests(batch)
+        cdef rq.DvzRequest* req = NULL
+        cdef const char* src = NULL
+        cdef tp.uint32_t item_size = 0
+        cdef tp.uint32_t stride = 0
+        out = []
+        for i in range(count):
+            req = &reqs[i]
+            data = None
+            if (req.action == tp.DVZ_REQUEST_ACTION_UPLOAD and
+                    req.type == tp.DVZ_REQUEST_OBJECT_DAT and
+                    req.content.dat_upload.upload_type == tp.DVZ_UPLOAD_TYPE_DIRECT):
+                src = <const char*>req.content.dat_upload.data
+                item_size = req.content.dat_upload.item_size
+                stride = req.content.dat_upload.stride
+                if stride == 0:
+                    data = src[:req.content.dat_upload.size]
+                else:
+                    data = b''.join(
+                        src[k * stride:k * stride + item_size]
+                        for k in range(req.content.dat_upload.size // item_size))
+            out.append((req.action, req.type, req.id, data))
+        rq.dvz_batch_clear(batch)
+        return out
+
+    def submit(self):
+        with nogil:
+            pt.dvz_app_submit(self._c_app)
+
     def run(self, unicode screenshot=None):
         cdef char* _c_path = screenshot
 
         # Make screenshot at the first frame.
         if screenshot:
-            pt.dvz_app_run(self._c_app, 1)
-            pt.dvz_app_screenshot(self._c_app, 0, _c_path)
+            with nogil:
+                pt.dvz_app_run(self._c_app, 1)
+                pt.dvz_app_screenshot(self._c_app, 0, _c_path)
 
-        pt.dvz_app_run(self._c_app, 0)
+        with nogil:
+            pt.dvz_app_run(self._c_app, 0)
 
     def destroy(self):
         pt.dvz_app_destroy(self._c_app)
@@ -3,13 +3,25 @@
 from ._types cimport *
 
 
-cdef extern from "<datoviz/request.h>":
+cdef extern from "<datoviz/request.h>" nogil:
     # Semi-opaque structs:
 
+    ctypedef struct DvzRequestDatUpload:
+        int upload_type
+        DvzSize offset
+        DvzSize size
+        void* data
+        uint32_t item_size
+        uint32_t stride
+
+    ctypedef union DvzRequestContent:
+        DvzRequestDatUpload dat_upload
+
     ctypedef struct DvzRequest:
         DvzId id
         DvzRequestAction action
         DvzRequestObject type
+        DvzRequestContent content
         int flags
 
     ctypedef struct DvzRequester:
@@ -20,6 +32,11 @@ cdef extern from "<datoviz/request.h>":
     ctypedef struct DvzRecorder:
         pass
 
+    ctypedef struct DvzBatch:
+        pass
+
+    ctypedef void (*DvzUploadReleaseCallback)(void* user_data)
+
     # ---------------------------------------------------------------------------------------------
     # ---------------------------------------------------------------------------------------------
     # ---------------------------------------------------------------------------------------------
@@ -61,6 +78,12 @@ cdef extern from "<datoviz/request.h>":
 
     void dvz_requester_print(DvzRequester* rqr)
 
+    void dvz_batch_clear(DvzBatch* batch)
+
+    DvzRequest* dvz_batch_requests(DvzBatch* batch)
+
+    uint32_t dvz_batch_size(DvzBatch* batch)
+
     DvzRequest dvz_create_board(DvzRequester* rqr, uint32_t width, uint32_t height, cvec4 background, int flags)
 
     DvzRequest dvz_set_background(DvzRequester* rqr, DvzId id, cvec4 background)
@@ -77,6 +100,8 @@ cdef extern from "<datoviz/request.h>":
 
     DvzRequest dvz_upload_dat(DvzRequester* rqr, DvzId dat, DvzSize offset, DvzSize size, void* data)
 
+    DvzRequest dvz_upload_dat_strided(DvzBatch* batch, DvzId dat, DvzSize offset, uint32_t count, DvzSize item_size, DvzSize stride, void* data, DvzUploadReleaseCallback release, void* user_data)
+
     DvzRequest dvz_create_tex(DvzRequester* rqr, DvzTexDims dims, DvzFormat format, uvec3 shape, int flags)
 
     DvzRequest dvz_upload_tex(DvzRequester* rqr, DvzId tex, uvec3 offset, uvec3 shape, DvzSize size, void* data)
@@ -3,7 +3,7 @@
 from ._types cimport *
 
 
-cdef extern from "<datoviz/scene/scene.h>":
+cdef extern from "<datoviz/scene/scene.h>" nogil:
     ctypedef struct DvzScene:
         pass
 
@@ -88,6 +88,13 @@ cdef extern from "<datoviz/scene/scene.h>":
     # ---------------------------------------------------------------------------------------------
 
     # STRUCT START
+    ctypedef struct DvzVisualUpdate:
+        DvzVisual* visual
+        uint32_t attr_idx
+        uint32_t first
+        uint32_t count
+        void* data
+
 
     # STRUCT END
 
@@ -179,6 +186,8 @@ cdef extern from "<datoviz/scene/scene.h>":
 
     void dvz_visual_index(DvzVisual* visual, uint32_t first, uint32_t count, DvzIndex* data)
 
+    void dvz_visual_updates(uint32_t count, DvzVisualUpdate* updates)
+
     void dvz_visual_instance(DvzVisual* visual, DvzId canvas, uint32_t first, uint32_t vertex_offset, uint32_t count, uint32_t first_instance, uint32_t instance_count)
 
     void dvz_visual_indirect(DvzVisual* visual, DvzId canvas, uint32_t draw_count)
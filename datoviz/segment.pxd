@@ -4,7 +4,7 @@ from ._types cimport *
 from .viewset cimport *
 
 
-cdef extern from "<datoviz/scene/visuals/segment.h>":
+cdef extern from "<datoviz/scene/visuals/segment.h>" nogil:
 
     # ---------------------------------------------------------------------------------------------
     # ---------------------------------------------------------------------------------------------
@@ -8,7 +8,7 @@ from pathlib import Path
 
 import numpy as np
 
-from datoviz.app import App
+from datoviz.app import App, visual_updates
 from datoviz.tests.utils import ROOT_PATH
 
 
@@ -82,5 +82,40 @@ def test_app_1():
     scene.run(screenshot="lines.png")
 
 
+def test_app_updates():
+    app = App()
+
+    n = 1000
+    n_visuals = 10
+    rng = np.random.default_rng(123)
+    visuals = [app.visual(n) for _ in range(n_visuals)]
+    pos = rng.random((n, 3)).astype(np.float32)
+    color = rng.integers(low=0, high=255, size=(n, 4)).astype(np.uint8)
+
+    # Discard the requests emitted when creating the visuals.
+    app.pending_requests()
+
+    # Attributes #0 and #3 of the segment visual: initial position and color.
+    def per_call():
+        for visual in visuals:
+            visual.initial(pos)
+            visual.color(color)
+            visual.update()
+        return app.pending_requests()
+
+    # Discard the requests emitted by the first update of each visual.
+    per_call()
+
+    # One call per attribute and visual.
+    expected = per_call()
+    assert any(r[3] for r in expected)
+
+    # All updates in a single call: same requests, same data.
+    items = [(v, 0, pos) for v in visuals] + [(v, 3, color) for v in visuals]
+    records, arrays = visual_updates(items)
+    app.apply_updates(records)
+    assert app.pending_requests() == expected
+
+
 if __name__ == '__main__':
     test_app_1()
@@ -3,7 +3,7 @@
 from ._types cimport *
 
 
-cdef extern from "<datoviz/scene/viewset.h>":
+cdef extern from "<datoviz/scene/viewset.h>" nogil:
     ctypedef struct DvzViewset:
         pass
 
@@ -137,6 +137,7 @@ typedef enum
     DVZ_REQUEST_OBJECT_BACKGROUND,
 
     DVZ_REQUEST_OBJECT_RECORD, // use recorder.h
+    DVZ_REQUEST_OBJECT_PUSH,
 } DvzRequestObject;
 
 
@@ -185,6 +186,12 @@ typedef enum
     DVZ_CANVAS_FLAGS_MONITOR = 0x0005, // NOTE: 1 bit for ImGUI, 1 bit for Monitor
     DVZ_CANVAS_FLAGS_VSYNC = 0x0010,
     DVZ_CANVAS_FLAGS_PICK = 0x0020,
+
+    // Presentation policy (latency vs throughput).
+    DVZ_CANVAS_FLAGS_MAILBOX = 0x0040,  // MAILBOX present mode (overrides VSYNC)
+    DVZ_CANVAS_FLAGS_FRAMES_1 = 0x0100, // 1 frame in flight instead of 2
+    DVZ_CANVAS_FLAGS_FRAMES_3 = 0x0200, // 3 frames in flight instead of 2
+    DVZ_CANVAS_FLAGS_JIT = 0x0400,      // just-in-time wait before input and request processing
 } DvzCanvasFlags;
 
 
@@ -418,6 +425,15 @@ typedef enum
 
 
 
+// Upload source.
+typedef enum
+{
+    DVZ_UPLOAD_TYPE_DIRECT, // data pointer
+    DVZ_UPLOAD_TYPE_SHM,    // block of a shared-memory arena, see shm.h
+} DvzUploadType;
+
+
+
 // Tex dims.
 typedef enum
 {
@@ -471,6 +487,7 @@ typedef enum
 {
     DVZ_RENDERER_FLAGS_NONE = 0x000000,
     DVZ_RENDERER_FLAGS_WHITE_BACKGROUND = 0x100000,
+    DVZ_RENDERER_FLAGS_SOFTWARE = 0x200000, // CPU rasterization, no GPU needed
 } DvzRendererFlags;
 
 
@@ -531,6 +531,40 @@ static inline uint8_t* dvz_normalize_bytes(uint32_t count, float* values)
 
 
 
+/**
+ * Gather strided items into a contiguous array, in a single pass.
+ *
+ * @param dst the destination, with room for `count * item_size` bytes
+ * @param src the first item of the source
+ * @param count the number of items
+ * @param item_size the size of each item, in bytes
+ * @param stride the distance between two consecutive items in the source, in bytes
+ */
+static inline void
+dvz_gather(void* dst, const void* src, uint32_t count, DvzSize item_size, DvzSize stride)
+{
+    ANN(dst);
+    ANN(src);
+    ASSERT(item_size > 0);
+
+    if (stride == item_size)
+    {
+        memcpy(dst, src, count * item_size);
+        return;
+    }
+
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        memcpy(d, s, item_size);
+        d += item_size;
+        s += stride;
+    }
+}
+
+
+
 /**
  * Compute the range of an array of double values.
  *
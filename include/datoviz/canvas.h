@@ -31,7 +31,7 @@
 #define DVZ_FENCES_FLIGHT             1
 #define DVZ_DEFAULT_COMMANDS_TRANSFER 0
 #define DVZ_DEFAULT_COMMANDS_RENDER   1
-#define DVZ_MAX_FRAMES_IN_FLIGHT      2
+#define DVZ_FRAMES_IN_FLIGHT          2 // default number of frames in flight
 
 
 
@@ -48,6 +48,7 @@
 typedef struct DvzCanvas DvzCanvas;
 typedef struct DvzRender DvzRender;
 typedef struct DvzSync DvzSync;
+typedef struct DvzPresentPolicy DvzPresentPolicy;
 
 typedef void (*DvzCanvasRefill)(
     DvzCanvas* canvas, DvzCommands* cmds, uint32_t idx, void* user_data);
@@ -93,6 +94,20 @@ struct DvzSync
 
 
 
+// Trade-off between latency and throughput when presenting frames, set by the canvas flags.
+struct DvzPresentPolicy
+{
+    uint32_t frames_in_flight; // between 1 and DVZ_MAX_FRAMES_IN_FLIGHT
+    VkPresentModeKHR present_mode;
+
+    // Wait for the next frame slot at the end of a frame, *before* the next input events and
+    // requests are processed, rather than at the beginning of the next frame. The rendered data
+    // is fresher at the cost of a lower CPU/GPU overlap.
+    bool jit;
+};
+
+
+
 /*************************************************************************************************/
 /*  Canvas struct                                                                                */
 /*************************************************************************************************/
@@ -118,6 +133,7 @@ struct DvzCanvas
 
     DvzRender render;
     DvzSync sync;
+    DvzPresentPolicy policy;
 
     // Frames.
     uint32_t cur_frame; // current frame within the images in flight
@@ -126,6 +142,18 @@ struct DvzCanvas
 
     DvzRecorder* recorder; // used to record command buffer when using the presenter
     void* user_data;
+
+    // GPU timestamps around the render pass, two queries per swapchain image.
+    struct
+    {
+        DvzQueries queries;
+        bool recorded[DVZ_MAX_SWAPCHAIN_IMAGES]; // whether the cmd buf writes the timestamps
+
+        // Frame record and swapchain image of the last submission of each frame in flight.
+        bool submitted[DVZ_MAX_FRAMES_IN_FLIGHT];
+        uint64_t seq[DVZ_MAX_FRAMES_IN_FLIGHT];
+        uint32_t img[DVZ_MAX_FRAMES_IN_FLIGHT];
+    } timing;
 };
 
 
@@ -146,6 +174,16 @@ dvz_canvas(DvzGpu* gpu, DvzRenderpass* renderpass, uint32_t width, uint32_t heig
 
 
 
+/**
+ * Return the presentation policy corresponding to canvas flags.
+ *
+ * @param flags the canvas flags (DVZ_CANVAS_FLAGS_VSYNC, MAILBOX, FRAMES_1, FRAMES_3, JIT)
+ * @returns the presentation policy
+ */
+DVZ_EXPORT DvzPresentPolicy dvz_canvas_policy(int flags);
+
+
+
 /**
  * Create a canvas.
  *
@@ -221,6 +259,20 @@ DVZ_EXPORT void dvz_canvas_end(DvzCanvas* canvas, DvzCommands* cmds, uint32_t id
 
 
 
+/**
+ * Return the duration of the render pass last submitted for a swapchain image.
+ *
+ * The timestamp queries are written by dvz_canvas_begin() and dvz_canvas_end(). This function
+ * does not wait, it should be called once the submission fence has been signaled.
+ *
+ * @param canvas the canvas
+ * @param img_idx the swapchain image index
+ * @returns the duration on the GPU, in seconds, or a negative value if unavailable
+ */
+DVZ_EXPORT double dvz_canvas_gpu_time(DvzCanvas* canvas, uint32_t img_idx);
+
+
+
 /**
  */
 DVZ_EXPORT uint8_t* dvz_canvas_download(DvzCanvas* canvas);
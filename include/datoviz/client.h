@@ -26,6 +26,8 @@
 /*************************************************************************************************/
 
 #define DVZ_CLIENT_MAX_CALLBACKS 16
+#define DVZ_CLIENT_MAX_WORKERS   8
+#define DVZ_CLIENT_WORKER_COUNT  2 // number of threads running the asynchronous callbacks
 
 
 
@@ -76,6 +78,7 @@ typedef struct DvzClientRequestsEvent DvzClientRequestsEvent;
 // Forward declarations.
 typedef uint64_t DvzId;
 typedef struct DvzDeq DvzDeq;
+typedef struct DvzFifo DvzFifo;
 typedef struct DvzBatch DvzBatch;
 typedef struct DvzTimerItem DvzTimerItem;
 
@@ -161,6 +164,13 @@ struct DvzClientPayload
     DvzClientCallback callback;
     DvzClientCallbackMode mode;
     void* user_data;
+
+    // Asynchronous callbacks: events waiting for a worker thread, processed in order. The payload
+    // is scheduled on at most one worker at a time, so that a callback never runs concurrently
+    // with itself.
+    DvzClientEvent* queue;
+    uint32_t queue_first, queue_count, queue_capacity;
+    bool scheduled;
 };
 
 
@@ -185,6 +195,15 @@ struct DvzClient
     void* user_data;
     DvzThread* thread;
     DvzAtomic to_stop;
+
+    // Worker pool for the asynchronous callbacks, started with the first asynchronous callback.
+    uint32_t worker_count;
+    DvzThread* workers[DVZ_CLIENT_MAX_WORKERS];
+    DvzFifo* jobs;            // payloads scheduled on the workers, NULL is the stop signal
+    DvzMutex async_lock;      // protects the payload queues and the counters below
+    DvzCond async_cond;       // signaled when there are no more pending asynchronous events
+    uint64_t async_pending;   // number of events queued or running on the workers
+    uint64_t async_coalesced; // number of events replaced by a more recent one
 };
 
 
@@ -208,12 +227,36 @@ DVZ_EXPORT void dvz_client_event(DvzClient* client, DvzClientEvent ev);
 
 
 
+/**
+ * Register a client callback.
+ *
+ * Asynchronous callbacks run on a pool of worker threads, so that they never block the event
+ * loop. The events of a given callback are processed in order, but consecutive mouse move,
+ * window resize, and frame events that have not been processed yet are coalesced: only the most
+ * recent one is kept. Asynchronous callbacks should submit their results as batches (see
+ * `dvz_app_submit_batch()`).
+ *
+ * @param client the client
+ * @param type the event type
+ * @param mode whether the callback is called in the event loop or in a worker thread
+ * @param callback the callback
+ * @param user_data the user data passed to the callback
+ */
 DVZ_EXPORT void dvz_client_callback(
     DvzClient* client, DvzClientEventType type, DvzClientCallbackMode mode,
     DvzClientCallback callback, void* user_data);
 
 
 
+/**
+ * Wait until all pending asynchronous callbacks have returned.
+ *
+ * @param client the client
+ */
+DVZ_EXPORT void dvz_client_wait(DvzClient* client);
+
+
+
 DVZ_EXPORT void dvz_client_process(DvzClient* client);
 
 
@@ -0,0 +1,162 @@
+/*************************************************************************************************/
+/*  Codec: compression of upload payloads                                                        */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_CODEC
+#define DVZ_HEADER_CODEC
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "_enums.h"
+#include "_log.h"
+#include "_math.h"
+
+
+
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+#define DVZ_CODEC_MAGIC     0x435A5644  // "DVZC"
+#define DVZ_CODEC_THRESHOLD (64 * 1024) // default minimum size of the compressed payloads
+#define DVZ_CODEC_ITEM_SIZE 4           // default item size of the filters (float, int32, RGBA8)
+
+
+
+/*************************************************************************************************/
+/*  Enums                                                                                        */
+/*************************************************************************************************/
+
+typedef enum
+{
+    DVZ_CODEC_NONE,
+    DVZ_CODEC_LZ4, // LZ4 block format
+} DvzCodecType;
+
+
+
+// Reversible filters applied before compression, to expose the redundancy of numeric columns.
+typedef enum
+{
+    DVZ_CODEC_FILTER_NONE = 0x00,
+    DVZ_CODEC_FILTER_SHUFFLE = 0x01, // group the i-th bytes of all items together
+    DVZ_CODEC_FILTER_DELTA = 0x02,   // difference between consecutive (shuffled) bytes
+} DvzCodecFilter;
+
+
+
+/*************************************************************************************************/
+/*  Typedefs                                                                                     */
+/*************************************************************************************************/
+
+typedef struct DvzCodecHeader DvzCodecHeader;
+typedef struct DvzCodecJob DvzCodecJob;
+
+
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+// Header of a compressed payload, followed by the compressed bytes.
+struct DvzCodecHeader
+{
+    uint32_t magic;
+    uint8_t codec;  // DvzCodecType
+    uint8_t filter; // DvzCodecFilter flags
+    uint16_t item_size;
+    uint64_t size;            // size of the original payload
+    uint64_t compressed_size; // size of the compressed bytes, header excluded
+};
+
+
+
+struct DvzCodecJob
+{
+    const void* src;
+    DvzSize size;
+    uint32_t item_size;
+    int filter;
+
+    void* dst;        // allocated by dvz_codec_jobs(), to free by the caller
+    DvzSize dst_size; // compressed size, header included, or 0 if the payload is incompressible
+};
+
+
+
+EXTERN_C_ON
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+/**
+ * Return the maximum size of a compressed payload.
+ *
+ * @param size the size of the payload
+ * @returns the size of the buffer to pass to `dvz_codec_compress()`
+ */
+DVZ_EXPORT DvzSize dvz_codec_bound(DvzSize size);
+
+
+
+/**
+ * Compress a payload.
+ *
+ * @param src the payload
+ * @param size the size of the payload
+ * @param item_size the size of the items seen by the filters
+ * @param filter the DvzCodecFilter flags
+ * @param dst the destination buffer, of size at least `dvz_codec_bound(size)`
+ * @returns the compressed size, header included, or 0 if the payload could not be made smaller
+ */
+DVZ_EXPORT DvzSize
+dvz_codec_compress(const void* src, DvzSize size, uint32_t item_size, int filter, void* dst);
+
+
+
+/**
+ * Compress several payloads in parallel.
+ *
+ * @param count the number of jobs
+ * @param jobs the jobs, with their destination to free by the caller
+ * @param thread_count the number of worker threads, 0 to use the number of CPU cores
+ */
+DVZ_EXPORT void dvz_codec_jobs(uint32_t count, DvzCodecJob* jobs, uint32_t thread_count);
+
+
+
+/**
+ * Return the original size of a compressed payload.
+ *
+ * @param buf the buffer
+ * @param size the size of the buffer
+ * @returns the original size, or 0 if the buffer is not a compressed payload
+ */
+DVZ_EXPORT DvzSize dvz_codec_size(const void* buf, DvzSize size);
+
+
+
+/**
+ * Decompress a payload.
+ *
+ * Unfiltered payloads are decompressed directly into the destination, which can be mapped or
+ * staging memory.
+ *
+ * @param src the compressed payload, header included
+ * @param size the size of the compressed payload
+ * @param dst the destination buffer
+ * @param dst_size the size of the destination, which must be the original size of the payload
+ * @returns 0 on success, 1 if the payload is invalid
+ */
+DVZ_EXPORT int dvz_codec_decompress(const void* src, DvzSize size, void* dst, DvzSize dst_size);
+
+
+
+EXTERN_C_OFF
+
+#endif
@@ -61,6 +61,30 @@ dvz_write_bytes(const char* filename, const char* mode, DvzSize size, const uint
 
 
 
+/**
+ * Map a file in memory (read-only), without reading it.
+ *
+ * The pages are loaded by the operating system on access, which allows files larger than the
+ * available memory to be used.
+ *
+ * @param filename path of the file to map
+ * @param[out] size of the file
+ * @returns pointer to the mapped file contents, or NULL if the mapping failed
+ */
+DVZ_EXPORT void* dvz_map_file(const char* filename, DvzSize* size);
+
+
+
+/**
+ * Unmap a file mapped with dvz_map_file().
+ *
+ * @param data pointer returned by dvz_map_file()
+ * @param size size of the file
+ */
+DVZ_EXPORT void dvz_unmap_file(void* data, DvzSize size);
+
+
+
 /*************************************************************************************************/
 /*  Image file I/O utils                                                                         */
 /*************************************************************************************************/
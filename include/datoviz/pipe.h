@@ -156,6 +156,19 @@ DVZ_EXPORT void dvz_pipe_dat(DvzPipe* pipe, uint32_t idx, DvzDat* dat);
 
 
 
+/**
+ * Set up a uniform dat, bound from a given offset.
+ *
+ * @param pipe the pipe
+ * @param idx the slot index
+ * @param dat the dat with the uniform data
+ * @param offset the offset of the uniform in the dat, in bytes, aligned on the GPU
+ *      minUniformBufferOffsetAlignment
+ */
+DVZ_EXPORT void dvz_pipe_dat_offset(DvzPipe* pipe, uint32_t idx, DvzDat* dat, DvzSize offset);
+
+
+
 /**
  * Set up a uniform tex.
  *
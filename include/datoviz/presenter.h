@@ -16,6 +16,7 @@
 #include "fps.h"
 #include "gui.h"
 #include "renderer.h"
+#include "timing.h"
 
 
 
@@ -86,6 +87,7 @@ struct DvzPresenter
     DvzList* callbacks;
 
     DvzFps fps;
+    DvzTiming timing; // per-frame CPU and GPU timings
 
     // Mappings.
     struct
@@ -115,6 +117,20 @@ dvz_presenter_gui(DvzPresenter* prt, DvzId window_id, DvzGuiCallback callback, v
 
 
 
+/**
+ * Return the frame timing ring buffer of the presenter.
+ *
+ * The returned records contain, for every frame, the CPU time spent in request processing,
+ * fence wait, swapchain acquisition, transfers, command buffer recording, submission and present,
+ * as well as the render pass duration measured on the GPU.
+ *
+ * @param prt the presenter
+ * @returns the timing instance, use dvz_timing_export() to save a Chrome trace JSON file
+ */
+DVZ_EXPORT DvzTiming* dvz_presenter_timing(DvzPresenter* prt);
+
+
+
 DVZ_EXPORT void dvz_presenter_submit(DvzPresenter* prt, DvzBatch* batch);
 
 
@@ -21,6 +21,7 @@
 
 #define DVZ_RECORDER_COMMAND_COUNT 16
 #define DVZ_MAX_SWAPCHAIN_IMAGES   4
+#define DVZ_RECORDER_PUSH_SIZE     16 // maximum size of push constants recorded inline
 
 
 
@@ -38,6 +39,7 @@ typedef enum
     DVZ_RECORDER_DRAW_INDEXED_INDIRECT,
     DVZ_RECORDER_VIEWPORT,
     DVZ_RECORDER_END,
+    DVZ_RECORDER_PUSH,
 } DvzRecorderCommandType;
 
 
@@ -115,6 +117,15 @@ struct DvzRecorderCommand
             DvzId dat_indirect_id;
             uint32_t draw_count;
         } draw_indexed_indirect;
+
+        // Push constants, stored inline so that the command size does not change.
+        struct
+        {
+            DvzId pipe_id;
+            int shader_stages; // DvzShaderType flags
+            uint16_t offset, size;
+            uint8_t data[DVZ_RECORDER_PUSH_SIZE];
+        } push;
     } contents;
 };
 
@@ -45,6 +45,7 @@ typedef struct DvzWorkspace DvzWorkspace;
 typedef struct DvzCanvas DvzCanvas;
 typedef struct DvzBoard DvzBoard;
 typedef struct DvzMap DvzMap;
+typedef struct DvzSoft DvzSoft;
 
 
 
@@ -78,6 +79,8 @@ struct DvzRenderer
     DvzContainer shaders;
     DvzMap* map;       // mapping between uuid and <type, objects>
     DvzRouter* router; // mapping between pairs (action, obj_type) and functions
+
+    DvzSoft* soft; // software backend, used instead of the GPU with DVZ_RENDERER_FLAGS_SOFTWARE
 };
 
 
@@ -91,6 +94,9 @@ EXTERN_C_ON
 /**
  * Create a renderer.
  *
+ * With DVZ_RENDERER_FLAGS_SOFTWARE, the requests are processed by a CPU rasterizer (see soft.h)
+ * and the GPU may be NULL.
+ *
  * @param gpu the GPU
  * @param flags renderer creation flags
  * @returns the renderer
@@ -54,8 +54,13 @@ typedef struct DvzBatch DvzBatch;
 typedef struct DvzPipe DvzPipe;
 typedef struct DvzFifo DvzFifo;
 typedef struct DvzList DvzList;
+typedef struct DvzArena DvzArena;
+typedef struct DvzShm DvzShm;
 typedef uint64_t DvzId;
 
+// Called by the renderer when the source of a zero-copy upload is no longer needed.
+typedef void (*DvzUploadReleaseCallback)(void* user_data);
+
 
 
 /*************************************************************************************************/
@@ -116,18 +121,34 @@ union DvzRequestContent
     // Dat upload.
     struct
     {
-        int upload_type; // 0=direct (data pointer), otherwise custom transfer method
+        int upload_type; // DvzUploadType
         DvzSize offset, size;
-        void* data;
+        union
+        {
+            void* data;         // DVZ_UPLOAD_TYPE_DIRECT
+            DvzSize shm_offset; // DVZ_UPLOAD_TYPE_SHM: offset of the block in the arena
+        };
+        uint32_t item_size, stride;       // strided source (zero-copy uploads), 0 if contiguous
+        DvzUploadReleaseCallback release; // zero-copy uploads: release the source once consumed
+        union
+        {
+            void* user_data;
+            DvzId shm; // DVZ_UPLOAD_TYPE_SHM: id of the arena
+        };
     } dat_upload;
 
     // Tex upload.
     struct
     {
-        int upload_type; // 0=direct (data pointer), otherwise custom transfer method
+        int upload_type; // DvzUploadType
         uvec3 offset, shape;
         DvzSize size;
-        void* data;
+        union
+        {
+            void* data;         // DVZ_UPLOAD_TYPE_DIRECT
+            DvzSize shm_offset; // DVZ_UPLOAD_TYPE_SHM: offset of the block in the arena
+        };
+        DvzId shm; // DVZ_UPLOAD_TYPE_SHM: id of the arena
     } tex_upload;
 
 
@@ -213,6 +234,14 @@ union DvzRequestContent
         void* value;
     } set_specialization;
 
+    // Declare a push constant range.
+    struct
+    {
+        int shader_stages; // DvzShaderType flags
+        DvzSize offset;
+        DvzSize size;
+    } set_push;
+
     // Bind a dat to a vertex binding.
     struct
     {
@@ -277,6 +306,7 @@ struct DvzBatch
     DvzRequest* requests;
 
     DvzList* pointers_to_free; // HACK: list of pointers created when loading requests dumps
+    DvzArena* arena;           // uniform arena registered by the scene, see dvz_arena_batch()
 };
 
 
@@ -368,6 +398,21 @@ DVZ_EXPORT int dvz_batch_dump(DvzBatch* batch, const char* filename);
 
 
 
+/**
+ * Dump a batch, compressing the large upload payloads.
+ *
+ * The payloads are compressed on worker threads, after a byte-shuffle and delta filter for numeric
+ * columns. `dvz_batch_load()` decompresses them transparently.
+ *
+ * @param batch the batch
+ * @param filename the path of the main dump file
+ * @param threshold the minimum size of the compressed payloads, for example DVZ_CODEC_THRESHOLD
+ * @returns 0 on success
+ */
+DVZ_EXPORT int dvz_batch_dump_compressed(DvzBatch* batch, const char* filename, DvzSize threshold);
+
+
+
 /**
  */
 DVZ_EXPORT void dvz_batch_load(DvzBatch* batch, const char* filename);
@@ -386,6 +431,29 @@ DVZ_EXPORT void dvz_batch_destroy(DvzBatch* batch);
 
 
 
+/**
+ * Return the source of a dat or tex upload request.
+ *
+ * @param req the upload request
+ * @returns a pointer to the data, in the mapped shared-memory arena for shared-memory uploads, or
+ * NULL if the arena could not be mapped
+ */
+DVZ_EXPORT void* dvz_upload_source(DvzRequest* req);
+
+
+
+/**
+ * Release the source of a dat or tex upload request once it has been uploaded.
+ *
+ * The copy made by the requester is freed, the release callback of zero-copy uploads is called,
+ * and the reference on the block of shared-memory uploads is released.
+ *
+ * @param req the upload request
+ */
+DVZ_EXPORT void dvz_upload_consume(DvzRequest* req);
+
+
+
 /*************************************************************************************************/
 /*  Requester functions */
 /*************************************************************************************************/
@@ -574,6 +642,50 @@ dvz_upload_dat(DvzBatch* batch, DvzId dat, DvzSize offset, DvzSize size, void* d
 
 
 
+/**
+ * Create a request for a zero-copy dat upload, from a contiguous or strided source.
+ *
+ * The data is NOT copied: the source must remain valid until the renderer calls the release
+ * callback, once the items have been gathered in a single pass into the staging or mapped memory
+ * of the dat. The items are written contiguously in the dat.
+ *
+ * @param batch the batch
+ * @param dat the id of the dat to upload to
+ * @param offset the byte offset of the upload transfer
+ * @param count the number of items
+ * @param item_size the size of each item, in bytes
+ * @param stride the distance between two consecutive items in the source, in bytes
+ * @param data a pointer to the first item
+ * @param release the callback releasing the source, may be NULL
+ * @param user_data the pointer passed to the release callback
+ * @returns the request
+ */
+DVZ_EXPORT DvzRequest dvz_upload_dat_strided(
+    DvzBatch* batch, DvzId dat, DvzSize offset, uint32_t count, DvzSize item_size, DvzSize stride,
+    void* data, DvzUploadReleaseCallback release, void* user_data);
+
+
+
+/**
+ * Create a request for a dat upload from a block of a shared-memory arena.
+ *
+ * The data is NOT copied: the renderer, possibly in another process, maps the arena and uploads
+ * the block in place. The request holds a reference on the block, released by the renderer once
+ * the upload is done.
+ *
+ * @param batch the batch
+ * @param dat the id of the dat to upload to
+ * @param offset the byte offset of the upload transfer
+ * @param shm the shared-memory arena
+ * @param shm_offset the offset of the block, as returned by `dvz_shm_alloc()`
+ * @param size the number of bytes to upload
+ * @returns the request
+ */
+DVZ_EXPORT DvzRequest dvz_upload_dat_shm(
+    DvzBatch* batch, DvzId dat, DvzSize offset, DvzShm* shm, DvzSize shm_offset, DvzSize size);
+
+
+
 /**
  * Create a request for dat deletion.
  *
@@ -635,6 +747,26 @@ DVZ_EXPORT DvzRequest dvz_upload_tex(
 
 
 
+/**
+ * Create a request for a tex upload from a block of a shared-memory arena.
+ *
+ * Like `dvz_upload_dat_shm()`, the block is uploaded in place and released by the renderer.
+ *
+ * @param batch the batch
+ * @param tex the id of the tex to upload to
+ * @param offset the offset
+ * @param shape the shape
+ * @param shm the shared-memory arena
+ * @param shm_offset the offset of the block, as returned by `dvz_shm_alloc()`
+ * @param size the number of bytes to transfer
+ * @returns the request
+ */
+DVZ_EXPORT DvzRequest dvz_upload_tex_shm(
+    DvzBatch* batch, DvzId tex, uvec3 offset, uvec3 shape, DvzShm* shm, DvzSize shm_offset,
+    DvzSize size);
+
+
+
 /**
  * Create a request for tex deletion.
  *
@@ -758,6 +890,24 @@ DVZ_EXPORT DvzRequest dvz_set_specialization(
 
 
 
+/**
+ * Create a request for declaring a push constant range of a graphics pipe.
+ *
+ * This request must be emitted before the first draw of the graphics, when the pipeline layout
+ * is created. The push constant values are then set with `dvz_record_push()`.
+ *
+ * @param batch the batch
+ * @param graphics the graphics id
+ * @param shader_stages the shader stages reading the push constants (DvzShaderType flags)
+ * @param offset the offset of the range, in bytes
+ * @param size the size of the range, in bytes
+ * @returns the request
+ */
+DVZ_EXPORT DvzRequest dvz_set_push(
+    DvzBatch* batch, DvzId graphics, int shader_stages, DvzSize offset, DvzSize size);
+
+
+
 /**
  * Create a request for graphics deletion.
  *
@@ -931,6 +1081,27 @@ DVZ_EXPORT DvzRequest dvz_record_draw_indexed_indirect(
 
 
 
+/**
+ * Create a request for setting push constants during command buffer recording.
+ *
+ * The values are recorded inline in the command buffer and apply to the subsequent draws of the
+ * graphics. Changing them only requires a new recording, without any buffer upload.
+ *
+ * @param batch the batch
+ * @param canvas_or_board_id the id of the canvas or board
+ * @param graphics the id of the graphics pipe
+ * @param shader_stages the shader stages reading the push constants (DvzShaderType flags)
+ * @param offset the offset of the values in the push constant range, in bytes
+ * @param size the size of the values, in bytes, at most DVZ_RECORDER_PUSH_SIZE
+ * @param data the values, copied in the request
+ * @returns the request
+ */
+DVZ_EXPORT DvzRequest dvz_record_push(
+    DvzBatch* batch, DvzId canvas_or_board_id, DvzId graphics, int shader_stages, DvzSize offset,
+    DvzSize size, const void* data);
+
+
+
 /**
  * Create a request for ending recording of command buffer.
  *
@@ -235,6 +235,10 @@ DVZ_EXPORT void dvz_dat_resize(DvzDat* dat, DvzSize new_size);
  * This function handles all types of uploads: with or without a staging buffer, normal or dup
  * transfers, etc.
  *
+ * Asynchronous uploads through a staging buffer go through the staging ring of the transfers: the
+ * data is copied before the function returns, so that the caller may free it immediately. If the
+ * data does not fit in the ring, the upload falls back to a synchronous upload.
+ *
  * @param dat the Dat
  * @param offset the offset within the Dat
  * @param size the size of the data to upload to the Dat
@@ -244,6 +248,27 @@ DVZ_EXPORT void dvz_dat_upload(DvzDat* dat, DvzSize offset, DvzSize size, void*
 
 
 
+/**
+ * Upload strided items to a Dat, in a contiguous region.
+ *
+ * The items are gathered in a single pass directly into the staging ring (asynchronous uploads)
+ * or into the mapped buffer (mappable Dats). In all cases, the source may be released as soon as
+ * the function returns.
+ *
+ * @param dat the Dat
+ * @param offset the offset within the Dat
+ * @param count the number of items
+ * @param item_size the size of each item, in bytes
+ * @param stride the distance between two consecutive items in the source, in bytes
+ * @param data the first item of the source
+ * @param wait whether this function should wait until the upload is complete or not
+ */
+DVZ_EXPORT void dvz_dat_upload_strided(
+    DvzDat* dat, DvzSize offset, uint32_t count, DvzSize item_size, DvzSize stride, void* data,
+    bool wait);
+
+
+
 /**
  * Download data from a Dat.
  *
@@ -309,6 +334,9 @@ DVZ_EXPORT void dvz_tex_resize(DvzTex* tex, uvec3 new_shape);
 /**
  * Upload data to a Tex.
  *
+ * Asynchronous uploads (wait=false) go through the staging ring of the transfers, see
+ * `dvz_dat_upload()`.
+ *
  * @param tex the Tex
  * @param offset the offset within the image
  * @param shape the width, height, depth of the data to upload
@@ -148,6 +148,23 @@ DVZ_EXPORT void dvz_app_ontimer(DvzApp* app, DvzClientCallback on_timer, void* u
 
 
 
+/**
+ * Register a callback called in a worker thread, so that it never blocks the event loop.
+ *
+ * The callback should build its requests in its own batch and submit them with
+ * `dvz_app_submit_batch()`, as the application batch is not thread-safe. Consecutive mouse move,
+ * resize, and frame events are coalesced while the callback is busy.
+ *
+ * @param app the app
+ * @param type the event type
+ * @param callback the callback
+ * @param user_data the user data
+ */
+DVZ_EXPORT void dvz_app_async(
+    DvzApp* app, DvzClientEventType type, DvzClientCallback callback, void* user_data);
+
+
+
 /**
  *
  */
@@ -169,6 +186,18 @@ DVZ_EXPORT void dvz_app_submit(DvzApp* app);
 
 
 
+/**
+ * Submit the requests of a batch to the event loop, and clear the batch.
+ *
+ * This function may be called from any thread, typically from an asynchronous callback.
+ *
+ * @param app the app
+ * @param batch the batch
+ */
+DVZ_EXPORT void dvz_app_submit_batch(DvzApp* app, DvzBatch* batch);
+
+
+
 /**
  *
  */
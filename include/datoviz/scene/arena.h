@@ -0,0 +1,175 @@
+/*************************************************************************************************/
+/* Arena                                                                                         */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_ARENA
+#define DVZ_HEADER_ARENA
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "../_enums.h"
+#include "../_log.h"
+#include "../_math.h"
+#include "dual.h"
+
+
+
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+// NOTE: 256 is the largest minUniformBufferOffsetAlignment allowed by the Vulkan spec, and
+// 16384 the smallest maxUniformBufferRange, so that any suballocation can be bound on any GPU.
+#define DVZ_ARENA_ALIGNMENT  256
+#define DVZ_ARENA_PAGE_SIZE  16384
+#define DVZ_ARENA_MAX_PAGES  1024
+#define DVZ_ARENA_MAX_BLOCKS (DVZ_ARENA_PAGE_SIZE / DVZ_ARENA_ALIGNMENT)
+
+
+
+/*************************************************************************************************/
+/*  Typedefs                                                                                     */
+/*************************************************************************************************/
+
+typedef struct DvzArena DvzArena;
+typedef struct DvzArenaPage DvzArenaPage;
+typedef struct DvzArenaBlock DvzArenaBlock;
+
+// Forward declarations.
+typedef struct DvzBatch DvzBatch;
+
+
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+struct DvzArenaBlock
+{
+    DvzSize offset;
+    DvzSize size;
+};
+
+
+
+struct DvzArenaPage
+{
+    DvzId dat;     // mappable uniform dat of DVZ_ARENA_PAGE_SIZE bytes
+    uint8_t* data; // CPU copy of the dat
+    DvzSize used;  // end of the allocated region, blocks below may have been freed
+    DvzSize dirty_first, dirty_last; // dirty byte range, uploaded at the next flush
+
+    // Freed blocks below `used`, reused in first-fit order.
+    uint32_t free_count;
+    DvzArenaBlock free[DVZ_ARENA_MAX_BLOCKS];
+};
+
+
+
+struct DvzArena
+{
+    DvzBatch* batch;
+    uint32_t page_count;
+    DvzArenaPage* pages[DVZ_ARENA_MAX_PAGES];
+    uint64_t allocations; // number of live suballocations
+    bool to_destroy;      // destroyed by its owner, freed with its last suballocation
+};
+
+
+
+EXTERN_C_ON
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+/**
+ * Create a uniform arena, suballocating small uniform structs in a few large mappable dats.
+ *
+ * Once registered to a batch with `dvz_arena_batch()`, the uniform duals created with
+ * `dvz_dual_dat()` (visual params, MVP and viewport structs) are suballocated in the arena. Their
+ * updates are written in place in the CPU copy of the arena, and uploaded with a single request
+ * per modified page when calling `dvz_arena_flush()`.
+ *
+ * @param batch the batch
+ * @returns the arena
+ */
+DVZ_EXPORT DvzArena* dvz_arena(DvzBatch* batch);
+
+
+
+/**
+ * Register an arena to a batch, so that the uniform duals of the batch are suballocated in it.
+ *
+ * @param arena the arena, or NULL to unregister the current arena
+ * @param batch the batch
+ */
+DVZ_EXPORT void dvz_arena_batch(DvzArena* arena, DvzBatch* batch);
+
+
+
+/**
+ * Create a uniform dual suballocated in the arena.
+ *
+ * @param arena the arena
+ * @param item_size the size of the uniform struct, at most DVZ_ARENA_PAGE_SIZE
+ * @returns the dual, bound with its offset in its dat
+ */
+DVZ_EXPORT DvzDual dvz_arena_dual(DvzArena* arena, DvzSize item_size);
+
+
+
+/**
+ * Mark a byte range of a page as dirty.
+ *
+ * @param arena the arena
+ * @param dat the page dat
+ * @param offset the offset of the range in the dat, in bytes
+ * @param size the size of the range, in bytes
+ */
+DVZ_EXPORT void dvz_arena_dirty(DvzArena* arena, DvzId dat, DvzSize offset, DvzSize size);
+
+
+
+/**
+ * Upload the dirty ranges of the arena, with one request per modified page.
+ *
+ * @param arena the arena
+ * @returns the number of upload requests emitted
+ */
+DVZ_EXPORT uint32_t dvz_arena_flush(DvzArena* arena);
+
+
+
+/**
+ * Release a suballocation.
+ *
+ * @param arena the arena
+ * @param dat the page dat
+ * @param offset the offset of the suballocation in the dat, in bytes
+ * @param size the size of the suballocation, in bytes
+ */
+DVZ_EXPORT void dvz_arena_free(DvzArena* arena, DvzId dat, DvzSize offset, DvzSize size);
+
+
+
+/**
+ * Destroy an arena.
+ *
+ * If some duals are still suballocated in the arena, it is only freed when the last one is
+ * destroyed. If its batch outlives it and is used to create new uniform duals, the arena must
+ * first be unregistered with `dvz_arena_batch(NULL, batch)`.
+ *
+ * @param arena the arena
+ */
+DVZ_EXPORT void dvz_arena_destroy(DvzArena* arena);
+
+
+
+EXTERN_C_OFF
+
+#endif
@@ -21,6 +21,10 @@
 /*  Constants                                                                                    */
 /*************************************************************************************************/
 
+#define DVZ_ATLAS_BUNDLE_MAGIC     0x415A5644 // "DVZA"
+#define DVZ_ATLAS_BUNDLE_VERSION   1
+#define DVZ_ATLAS_BUNDLE_EXTENSION ".dvza"
+
 
 
 /*************************************************************************************************/
@@ -29,6 +33,8 @@
 
 typedef struct DvzAtlas DvzAtlas;
 typedef struct DvzAtlasFont DvzAtlasFont;
+typedef struct DvzAtlasBundleHeader DvzAtlasBundleHeader;
+typedef struct DvzAtlasBundleGlyph DvzAtlasBundleGlyph;
 
 // Forward declarations.
 typedef struct DvzFont DvzFont;
@@ -56,6 +62,32 @@ struct DvzAtlasFont
 
 
 
+// Precompiled atlas bundle, meant to be used in place (mapped or embedded): the header is followed
+// by the glyph table sorted by codepoint, and by the RGB bitmap stored row by row from the top,
+// as in the texture.
+struct DvzAtlasBundleHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t glyph_count;
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved;
+    double scale;           // glyph scale, in pixels per em
+    uint64_t glyphs_offset; // offset of the glyph table, in bytes from the start of the bundle
+    uint64_t rgb_offset;    // offset of the bitmap, in bytes from the start of the bundle
+};
+
+
+
+struct DvzAtlasBundleGlyph
+{
+    uint32_t codepoint;
+    uint32_t x, y, w, h; // glyph box in the bitmap, in pixels, from the top of the bitmap
+};
+
+
+
 EXTERN_C_ON
 
 /*************************************************************************************************/
@@ -74,6 +106,16 @@ DVZ_EXPORT void dvz_atlas_clear(DvzAtlas* atlas);
 
 
 
+/**
+ * Set the number of threads generating the glyphs (by default, the number of CPU cores).
+ *
+ * @param atlas the atlas
+ * @param thread_count the number of threads
+ */
+DVZ_EXPORT void dvz_atlas_threads(DvzAtlas* atlas, uint32_t thread_count);
+
+
+
 /**
  */
 DVZ_EXPORT void dvz_atlas_codepoints(DvzAtlas* atlas, uint32_t count, uint32_t* codepoints);
@@ -109,6 +151,23 @@ DVZ_EXPORT void dvz_atlas_load(DvzAtlas* atlas);
 DVZ_EXPORT int dvz_atlas_generate(DvzAtlas* atlas);
 
 
+
+/**
+ * Add glyphs to the atlas without regenerating the existing ones.
+ *
+ * The new glyphs are placed in the free space of the bitmap, whose height is doubled when full.
+ * The existing glyphs keep their position from the top of the bitmap, so that their coordinates
+ * in pixels remain valid.
+ *
+ * @param atlas the atlas
+ * @param count the number of codepoints
+ * @param codepoints the codepoints, those already in the atlas are ignored
+ * @returns the number of glyphs added
+ */
+DVZ_EXPORT int dvz_atlas_insert(DvzAtlas* atlas, uint32_t count, uint32_t* codepoints);
+
+
+
 /**
  */
 DVZ_EXPORT void dvz_atlas_shape(DvzAtlas* atlas, uvec3 shape);
@@ -145,12 +204,70 @@ DVZ_EXPORT DvzId dvz_atlas_texture(DvzAtlas* atlas, DvzBatch* batch);
 
 
 
+/**
+ * Upload the region of the atlas modified since the last upload to the atlas texture.
+ *
+ * The texture must have been created with `dvz_atlas_texture()`. It is resized if the atlas has
+ * grown, in which case the renderer rebinds it to the pipes sampling it.
+ *
+ * @param atlas the atlas
+ * @param batch the batch
+ * @returns 0 if the upload succeeded or if there was nothing to upload
+ */
+DVZ_EXPORT int dvz_atlas_upload(DvzAtlas* atlas, DvzBatch* batch);
+
+
+
 /**
  */
 DVZ_EXPORT void dvz_atlas_destroy(DvzAtlas* atlas);
 
 
 
+/*************************************************************************************************/
+/*  Bundle functions                                                                             */
+/*************************************************************************************************/
+
+/**
+ * Create an atlas from a precompiled bundle in memory, without copying nor parsing it.
+ *
+ * The bundle is used in place until new glyphs are inserted, which makes a copy of the bitmap.
+ *
+ * @param ttf_size the size of the TTF font, used to insert glyphs missing from the bundle
+ * @param ttf_bytes the TTF font bytes
+ * @param size the size of the bundle, in bytes
+ * @param bundle the bundle bytes, must remain valid during the lifetime of the atlas
+ * @returns the atlas, or NULL if the bundle is invalid
+ */
+DVZ_EXPORT DvzAtlas*
+dvz_atlas_bundle(unsigned long ttf_size, unsigned char* ttf_bytes, DvzSize size, void* bundle);
+
+
+
+/**
+ * Create an atlas from a precompiled bundle file, mapped in memory.
+ *
+ * @param ttf_size the size of the TTF font, used to insert glyphs missing from the bundle
+ * @param ttf_bytes the TTF font bytes
+ * @param path the path to the bundle file
+ * @returns the atlas, or NULL if the file could not be mapped or is invalid
+ */
+DVZ_EXPORT DvzAtlas*
+dvz_atlas_bundle_file(unsigned long ttf_size, unsigned char* ttf_bytes, const char* path);
+
+
+
+/**
+ * Write an atlas as a precompiled bundle file.
+ *
+ * @param atlas the atlas
+ * @param path the path to the bundle file
+ * @returns 0 if the file was written
+ */
+DVZ_EXPORT int dvz_atlas_bundle_export(DvzAtlas* atlas, const char* path);
+
+
+
 /*************************************************************************************************/
 /*  File util functions                                                                          */
 /*************************************************************************************************/
@@ -33,6 +33,7 @@ typedef struct DvzPanel DvzPanel;
 typedef struct DvzTicks DvzTicks;
 typedef struct DvzAxis DvzAxis;
 typedef struct DvzLabels DvzLabels;
+typedef struct DvzList DvzList;
 
 
 
@@ -58,6 +59,14 @@ struct DvzAxes
 
     dvec2 xref, yref;
 
+    // Linked axes: the ticks of a linked dimension are computed by the source axes, whose panel
+    // pan and zoom are kept in sync with this panel along that dimension.
+    DvzAxes* xsource;
+    DvzAxes* ysource;
+    DvzList* followers; // axes linked to these axes
+    vec2 xlinked;       // x range last synchronized with the followers
+    vec2 ylinked;       // y range last synchronized with the followers
+
     int flags;
     void* user_data;
 };
@@ -82,6 +91,28 @@ DVZ_EXPORT DvzAxes* dvz_axes(DvzPanel* panel, int flags);
 
 
 
+/**
+ * Create axes sharing one or both dimensions with the axes of other panels.
+ *
+ * The ticks and labels of a linked dimension are computed once, by the source axes, and the axis
+ * visuals reuse the GPU buffers of the source axis. The pan and zoom of the panels are kept in
+ * sync along the linked dimensions by `dvz_axes_update()`, which may be called on either the
+ * source or the linked axes: the panel whose pan and zoom changed since the last call is followed
+ * by the others. The linked panels are assumed to have about the same size along the linked
+ * dimensions. The source axes must not be linked themselves, and must be destroyed after the
+ * linked axes.
+ *
+ * @param panel the panel
+ * @param xsource the axes sharing the x axis, or NULL for an independent x axis
+ * @param ysource the axes sharing the y axis, or NULL for an independent y axis
+ * @param flags the axes flags
+ * @returns the axes, or NULL if a source is linked itself
+ */
+DVZ_EXPORT DvzAxes*
+dvz_axes_linked(DvzPanel* panel, DvzAxes* xsource, DvzAxes* ysource, int flags);
+
+
+
 /**
  *
  */
@@ -20,6 +20,9 @@
 /*  Constants                                                                                    */
 /*************************************************************************************************/
 
+#define DVZ_AXIS_LABEL_LENGTH  24 // maximum number of glyphs in a tick label
+#define DVZ_AXIS_TICK_CAPACITY 16 // initial number of tick slots
+
 
 
 /*************************************************************************************************/
@@ -27,6 +30,7 @@
 /*************************************************************************************************/
 
 typedef struct DvzAxis DvzAxis;
+typedef struct DvzAxisStats DvzAxisStats;
 typedef struct DvzTickSpec DvzTickSpec;
 
 // Forward declarations.
@@ -66,6 +70,16 @@ struct DvzTickSpec
 
 
 
+struct DvzAxisStats
+{
+    uint64_t updates;        // total number of calls to dvz_axis_ticks()
+    uint64_t reallocs;       // total number of reallocations of the visuals
+    uint64_t labels_reused;  // total number of tick labels kept from the previous update
+    uint64_t labels_created; // total number of tick labels written in a slot
+};
+
+
+
 struct DvzAxis
 {
     int flags;
@@ -90,12 +104,24 @@ struct DvzAxis
     vec4 tick_length; // lim, grid, major, minor
 
     // Glyphs
-    // uint32_t tick_count; // = glyph->group_count
-    // uint32_t glyph_count; // = glyph->item_count
-    // uint32_t* group_size; // = glyph->group_sizes
     vec2 anchor;
     vec2 offset;
 
+    // Tick slots: each slot holds the glyphs of one tick label, the labels that remain visible
+    // from one update to the next keep their slot and are not uploaded again.
+    uint32_t slot_count;
+    double* slot_value;        // tick value of each slot
+    uint32_t* slot_length;     // number of glyphs of each slot, 0 if the slot is free
+    uint32_t* slot_codepoints; // DVZ_AXIS_LABEL_LENGTH codepoints per slot
+    uint32_t* tick_slot;       // slot of each visible tick
+    uint32_t tick_count;       // number of visible ticks
+    bool style_dirty;          // whether the style changed since the last update
+    bool resized;              // whether the last update reallocated the visuals
+    DvzAxisStats stats;
+
+    // Shared axis: the visuals draw the vertex and index buffers of the source axis.
+    DvzAxis* source;
+
     void* user_data;
 };
 
@@ -119,6 +145,21 @@ DVZ_EXPORT DvzAxis* dvz_axis(DvzBatch* batch, int flags);
 
 
 
+/**
+ * Create an axis displaying the ticks and labels of another axis, in another panel.
+ *
+ * The shared axis has its own visuals, but these reuse the vertex and index buffers, the glyph
+ * parameters, and the font atlas texture of the source axis, so that the ticks are computed and
+ * uploaded only once. The source axis must have been updated at least once, and must be
+ * destroyed after the shared axis.
+ *
+ * @param source the source axis
+ * @returns the shared axis
+ */
+DVZ_EXPORT DvzAxis* dvz_axis_shared(DvzAxis* source);
+
+
+
 /**
  *
  */
@@ -238,12 +279,29 @@ DVZ_EXPORT DvzTickSpec dvz_tick_spec(
 
 
 /**
+ * Set the ticks and their labels.
  *
+ * The visuals are only reallocated when there are more ticks than tick slots. The labels that
+ * were already visible in the previous call keep their glyphs, and only their positions are
+ * updated, so that continuous panning only uploads the tick positions and the new labels.
+ *
+ * @param axis the axis
+ * @param tick_spec the tick specification
  */
 DVZ_EXPORT void dvz_axis_ticks(DvzAxis* axis, DvzTickSpec* tick_spec);
 
 
 
+/**
+ * Return the tick update statistics.
+ *
+ * @param axis the axis
+ * @returns the statistics
+ */
+DVZ_EXPORT DvzAxisStats dvz_axis_stats(DvzAxis* axis);
+
+
+
 EXTERN_C_OFF
 
 #endif
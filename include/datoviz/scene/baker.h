@@ -221,9 +221,16 @@ DVZ_EXPORT void dvz_baker_indirect(DvzBaker* baker);
 /*************************************************************************************************/
 
 /**
+ * Use the dual of another baker for a vertex binding.
  *
+ * The binding is neither created, updated, resized nor destroyed by this baker. This may be
+ * called before the vertex bindings are declared.
+ *
+ * @param baker the baker
+ * @param binding_idx the vertex binding index
+ * @param dual the dual owned by another baker
  */
-DVZ_EXPORT void dvz_baker_share_vertex(DvzBaker* baker, uint32_t binding_idx);
+DVZ_EXPORT void dvz_baker_share_vertex(DvzBaker* baker, uint32_t binding_idx, DvzDual* dual);
 
 
 
@@ -235,9 +242,12 @@ DVZ_EXPORT void dvz_baker_share_vertex(DvzBaker* baker, uint32_t binding_idx);
 
 
 /**
+ * Use the index dual of another baker.
  *
+ * @param baker the baker
+ * @param dual the index dual owned by another baker
  */
-DVZ_EXPORT void dvz_baker_share_index(DvzBaker* baker);
+DVZ_EXPORT void dvz_baker_share_index(DvzBaker* baker, DvzDual* dual);
 
 
 
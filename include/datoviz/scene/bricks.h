@@ -0,0 +1,191 @@
+/*************************************************************************************************/
+/* Bricks                                                                                        */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_BRICKS
+#define DVZ_HEADER_BRICKS
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "_enums.h"
+#include "_math.h"
+
+
+
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+// NOTE: must correspond to the values in utils_volume.glsl
+#define DVZ_BRICK_SIZE    32 // size of a brick in the atlas, in voxels, including the border
+#define DVZ_BRICK_BORDER  1  // duplicated voxels on each side of a brick, for linear filtering
+#define DVZ_BRICK_PAYLOAD (DVZ_BRICK_SIZE - 2 * DVZ_BRICK_BORDER)
+
+#define DVZ_BRICKS_MAX_LEVELS   12
+#define DVZ_BRICKS_UPLOAD_LIMIT 16 // maximum number of brick uploads per update
+#define DVZ_BRICKS_LOD_BIAS     1  // projected voxel size, in pixels, before switching level
+
+
+
+/*************************************************************************************************/
+/*  Typedefs                                                                                     */
+/*************************************************************************************************/
+
+typedef struct DvzBricks DvzBricks;
+typedef struct DvzBricksStats DvzBricksStats;
+
+// Forward declarations.
+typedef struct DvzBatch DvzBatch;
+typedef struct DvzCamera DvzCamera;
+
+
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+struct DvzBricksStats
+{
+    uint32_t resident;   // number of bricks currently in the atlas
+    uint32_t requested;  // number of bricks requested by the last update
+    uint32_t missing;    // requested bricks not resident after the last update
+    uint64_t loads;      // total number of brick uploads
+    uint64_t evictions;  // total number of bricks evicted from the atlas
+    uint64_t hits;       // total number of requested bricks already resident
+    uint64_t skipped;    // total number of empty bricks that were not uploaded
+    uint64_t table_uploads;
+};
+
+
+
+struct DvzBricks
+{
+    DvzBatch* batch;
+    DvzFormat format;
+    DvzSize voxel_size;
+    uvec3 shape; // volume shape at the finest level (width, height, depth)
+
+    // Source volume, either mapped from a file or provided by the caller.
+    uint8_t* data;
+    DvzSize data_size;
+    void* mapped;
+    DvzSize mapped_size;
+
+    // Multi-resolution pyramid: level l has a shape ceil(shape / 2^l), the bricks of level l are
+    // identified by a global index starting at level_offset[l].
+    uint32_t level_count;
+    uvec3 grid[DVZ_BRICKS_MAX_LEVELS];
+    uint32_t level_offset[DVZ_BRICKS_MAX_LEVELS];
+    uint32_t brick_count;
+
+    // Brick cache in a 3D atlas texture, with a LRU replacement policy.
+    uvec3 atlas_shape; // number of brick slots in each dimension
+    uint32_t slot_count;
+    int32_t* slot_brick;  // brick index in each slot, -1 if empty
+    int32_t* brick_slot;  // slot of each brick, -1 if not resident
+    uint64_t* slot_used;  // last update in which each slot was used
+    uint8_t* brick_empty; // 0: unknown, 1: empty (all zero), 2: non-empty
+    uint64_t update;      // update counter
+
+    // Indirection table: for each brick of the finest level, the atlas slot and level of the
+    // finest resident brick covering it, encoded as (slot x, slot y, slot z, level + 1).
+    uint8_t* table;
+    bool table_dirty;
+
+    DvzId atlas;
+    DvzId indirection;
+    uint8_t* brick_data; // staging buffer for one brick
+    uint32_t* requests;  // bricks requested by the last update
+
+    uint32_t upload_limit;
+    float lod_bias;
+    DvzBricksStats stats;
+};
+
+
+
+EXTERN_C_ON
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+/**
+ * Create a bricked volume, streamed in a brick cache in the GPU.
+ *
+ * @param batch the batch
+ * @param format the voxel format
+ * @param shape the volume shape (width, height, depth), with the width as the fastest axis
+ * @param atlas_shape the number of brick slots in the atlas texture along each axis
+ * @returns the bricked volume
+ */
+DVZ_EXPORT DvzBricks*
+dvz_bricks(DvzBatch* batch, DvzFormat format, uvec3 shape, uvec3 atlas_shape);
+
+
+
+/**
+ * Use an in-memory volume as the source of the bricks (the data is not copied).
+ *
+ * @param bricks the bricked volume
+ * @param data the volume data, must remain valid during the lifetime of the bricked volume
+ */
+DVZ_EXPORT void dvz_bricks_data(DvzBricks* bricks, void* data);
+
+
+
+/**
+ * Use a raw volume file as the source of the bricks, mapped in memory.
+ *
+ * @param bricks the bricked volume
+ * @param path the path to the raw file
+ * @param offset the offset of the voxels in the file, in bytes (header size)
+ * @returns 0 if the file could be mapped
+ */
+DVZ_EXPORT int dvz_bricks_file(DvzBricks* bricks, const char* path, DvzSize offset);
+
+
+
+/**
+ * Select and upload the bricks needed for the current camera.
+ *
+ * The level of detail of each region is chosen so that a voxel projects to about one pixel.
+ * The coarsest level is always kept resident so that every region can be rendered.
+ *
+ * @param bricks the bricked volume
+ * @param camera the panel camera (see `dvz_panel_camera()`)
+ * @param model the model matrix of the volume
+ * @param box_size the size of the volume box, in model coordinates (see `dvz_volume_size()`)
+ * @returns the number of bricks uploaded
+ */
+DVZ_EXPORT uint32_t
+dvz_bricks_update(DvzBricks* bricks, DvzCamera* camera, mat4 model, vec3 box_size);
+
+
+
+/**
+ * Return the brick cache statistics.
+ *
+ * @param bricks the bricked volume
+ * @returns the statistics
+ */
+DVZ_EXPORT DvzBricksStats dvz_bricks_stats(DvzBricks* bricks);
+
+
+
+/**
+ * Destroy a bricked volume.
+ *
+ * @param bricks the bricked volume
+ */
+DVZ_EXPORT void dvz_bricks_destroy(DvzBricks* bricks);
+
+
+
+EXTERN_C_OFF
+
+#endif
@@ -29,6 +29,7 @@ typedef struct DvzDrawIndexedIndirectCommand DvzDrawIndexedIndirectCommand;
 // Forward declarations.
 typedef struct DvzBatch DvzBatch;
 typedef struct DvzArray DvzArray;
+typedef struct DvzArena DvzArena;
 
 
 
@@ -53,6 +54,11 @@ struct DvzDual
 
     bool need_destroy; // whether the library is responsible for creating and thus destroying the
                        // dual
+
+    // Uniform duals suballocated in an arena: the dual is bound at an offset in the dat, and its
+    // updates are uploaded when the arena is flushed.
+    DvzArena* arena;
+    DvzSize offset;
 };
 
 
@@ -23,6 +23,10 @@
 
 #define DVZ_DEFAULT_FONT_SIZE 24
 
+// String layout cache: number of sets and number of entries per set.
+#define DVZ_FONT_LAYOUT_SETS 256
+#define DVZ_FONT_LAYOUT_WAYS 4
+
 
 
 /*************************************************************************************************/
@@ -30,6 +34,7 @@
 /*************************************************************************************************/
 
 typedef struct DvzFont DvzFont;
+typedef struct DvzFontStats DvzFontStats;
 
 
 
@@ -43,6 +48,14 @@ typedef struct DvzFont DvzFont;
 /*  Structs                                                                                      */
 /*************************************************************************************************/
 
+struct DvzFontStats
+{
+    uint32_t cached_glyphs; // number of glyph metrics in the cache, for all sizes
+    uint64_t glyph_loads;   // total number of glyphs loaded by FreeType
+    uint64_t layout_hits;   // total number of string layouts found in the cache
+    uint64_t layout_misses; // total number of string layouts computed
+};
+
 
 
 EXTERN_C_ON
@@ -63,6 +76,16 @@ DVZ_EXPORT void dvz_font_size(DvzFont* font, double size);
 
 
 
+/**
+ * Enable or disable kerning in the layout (enabled by default, if the font has a kerning table).
+ *
+ * @param font the font
+ * @param kerning whether to apply kerning
+ */
+DVZ_EXPORT void dvz_font_kerning(DvzFont* font, bool kerning);
+
+
+
 /**
  */
 DVZ_EXPORT vec4* dvz_font_layout(
@@ -70,6 +93,24 @@ DVZ_EXPORT vec4* dvz_font_layout(
 
 
 
+/**
+ * Compute the layout of many strings in one call.
+ *
+ * Each string is laid out independently, starting at x=0, and the layouts are returned
+ * contiguously. The layouts are cached, so that repeated strings (for example tick labels) are
+ * only laid out once.
+ *
+ * @param font the font
+ * @param count the number of strings
+ * @param lengths the number of codepoints of each string
+ * @param codepoints the codepoints of all strings, concatenated
+ * @returns an array of (x, y, w, h) for each codepoint, to be freed by the caller
+ */
+DVZ_EXPORT vec4* dvz_font_layouts(
+    DvzFont* font, uint32_t count, const uint32_t* lengths, const uint32_t* codepoints);
+
+
+
 /**
  */
 DVZ_EXPORT vec4* dvz_font_ascii(DvzFont* font, const char* string); // return an array of (x,y,w,h)
@@ -84,6 +125,16 @@ DVZ_EXPORT uint8_t* dvz_font_draw(
 
 
 
+/**
+ * Return the glyph metrics and layout cache statistics.
+ *
+ * @param font the font
+ * @returns the statistics
+ */
+DVZ_EXPORT DvzFontStats dvz_font_stats(DvzFont* font);
+
+
+
 /**
  */
 DVZ_EXPORT void dvz_font_destroy(DvzFont* font);
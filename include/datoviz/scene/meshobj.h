@@ -17,10 +17,25 @@
 
 
 
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+#define DVZ_MESH_MAGIC     0x4D5A5644 // "DVZM"
+#define DVZ_MESH_VERSION   1
+#define DVZ_MESH_EXTENSION ".dvzm"
+#define DVZ_MESH_ALIGNMENT 16
+
+#define DVZ_OBJ_CHUNK_SIZE (1 << 20) // minimum number of bytes parsed by each thread
+
+
+
 /*************************************************************************************************/
 /*  Typedefs                                                                                     */
 /*************************************************************************************************/
 
+typedef struct DvzMeshHeader DvzMeshHeader;
+
 
 
 /*************************************************************************************************/
@@ -32,6 +47,24 @@
 /*  Structs                                                                                      */
 /*************************************************************************************************/
 
+// Binary mesh file, meant to be mapped in memory: the header is followed by the arrays of the
+// shape, each one aligned to DVZ_MESH_ALIGNMENT bytes, with the same layout as in DvzShape.
+struct DvzMeshHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t type; // DvzShapeType
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t reserved;
+    // Offsets of the arrays, in bytes from the start of the file, 0 if the array is absent.
+    uint64_t pos_offset;
+    uint64_t normal_offset;
+    uint64_t color_offset;
+    uint64_t texcoords_offset;
+    uint64_t index_offset;
+};
+
 
 
 EXTERN_C_ON
@@ -40,12 +73,72 @@ EXTERN_C_ON
 /*  MeshObj functions                                                                            */
 /*************************************************************************************************/
 
+/**
+ * Center a shape and scale it so that it fits in the [-1, +1] cube.
+ *
+ * The arrays of a mapped binary mesh are copied first.
+ *
+ * @param shape the shape, whose vertex positions are modified in place
+ */
 DVZ_EXPORT void dvz_shape_normalize(DvzShape* shape);
 
+
+
+/**
+ * Load and normalize a mesh from an OBJ file.
+ *
+ * The file is mapped in memory and parsed by several threads, each one parsing a range of lines.
+ * Polygonal faces are triangulated as fans, and the face corners sharing the same position,
+ * texture coordinates, and normal share the same vertex. The normals are computed if the file
+ * has none.
+ *
+ * @param file_path the path to the OBJ file
+ * @returns the shape, empty if the file could not be loaded
+ */
 DVZ_EXPORT DvzShape dvz_shape_obj(const char* file_path);
 
 
 
+/**
+ * Merge the vertices of a shape that have the same attributes.
+ *
+ * The positions are compared on a grid with a cell size of `epsilon`, or exactly if `epsilon` is
+ * 0. The other attributes are compared exactly. A non-indexed shape becomes indexed. The arrays
+ * of a mapped binary mesh are copied first.
+ *
+ * @param shape the shape, modified in place
+ * @param epsilon the tolerance on the positions
+ * @returns the new number of vertices
+ */
+DVZ_EXPORT uint32_t dvz_shape_weld(DvzShape* shape, float epsilon);
+
+
+
+/**
+ * Write a shape as a binary mesh file.
+ *
+ * @param shape the shape
+ * @param path the path to the binary mesh file
+ * @returns 0 if the file was written
+ */
+DVZ_EXPORT int dvz_shape_export(DvzShape* shape, const char* path);
+
+
+
+/**
+ * Load a shape from a binary mesh file, mapped in memory without copying nor parsing it.
+ *
+ * The arrays of the returned shape point to the read-only mapping, which is released by
+ * `dvz_shape_destroy()`, or when the shape is modified by `dvz_shape_normalize()` or
+ * `dvz_shape_weld()`, which copy the arrays first.
+ *
+ * @param path the path to the binary mesh file
+ * @returns the shape, empty if the file is invalid
+ */
+DVZ_EXPORT DvzShape dvz_shape_mesh(const char* path);
+
+
+
 EXTERN_C_OFF
 
 #endif
@@ -30,6 +30,7 @@ typedef struct DvzPanel DvzPanel;
 // Forward declarations.
 typedef struct DvzApp DvzApp;
 typedef struct DvzArcball DvzArcball;
+typedef struct DvzArena DvzArena;
 typedef struct DvzCamera DvzCamera;
 typedef struct DvzList DvzList;
 typedef struct DvzPanzoom DvzPanzoom;
@@ -66,6 +67,12 @@ struct DvzScene
     DvzApp* app;
     DvzBatch* batch;
     DvzList* figures;
+
+    // Interaction-driven transform updates are coalesced and flushed once per frame.
+    uint64_t uploads_saved;
+
+    // The uniforms of the scene (MVP, viewports, visual params) are suballocated in an arena.
+    DvzArena* arena;
 };
 
 
@@ -109,6 +116,30 @@ EXTERN_C_ON
 DVZ_EXPORT DvzScene* dvz_scene(DvzBatch* batch);
 
 
+/**
+ * Emit the upload requests of all dirty transforms and visual params of the scene.
+ *
+ * This is called automatically once per frame by dvz_scene_run(), so that the mouse events
+ * received within a frame result in at most one MVP upload per transform. The uniforms
+ * suballocated in the scene arena are uploaded with a single request per arena page.
+ *
+ * @param scene the scene
+ * @returns the number of upload requests emitted
+ */
+DVZ_EXPORT uint32_t dvz_scene_flush(DvzScene* scene);
+
+
+
+/**
+ * Return the number of transform uploads saved by the per-frame coalescing.
+ *
+ * @param scene the scene
+ * @returns the number of uploads saved since the scene creation
+ */
+DVZ_EXPORT uint64_t dvz_scene_uploads_saved(DvzScene* scene);
+
+
+
 /**
  *
  */
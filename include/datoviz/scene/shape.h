@@ -57,6 +57,11 @@ struct DvzShape
     cvec4* color;
     vec4* texcoords; // u, v, *, a
     DvzIndex* index;
+
+    // Binary mesh file mapped in memory, the arrays then point to the mapping (see
+    // dvz_shape_mesh()).
+    void* mapped;
+    DvzSize mapped_size;
 };
 
 
@@ -25,6 +25,9 @@
 #define MAX_GLYPHS_PER_LABEL 24
 #define MAX_LABELS           256
 
+#define DVZ_TICKS_CACHE_SIZE 64 // number of cached solutions, must be a power of two
+#define DVZ_TICKS_CACHE_BITS 20 // quantization of the cached ranges, relative to the range size
+
 
 
 /*************************************************************************************************/
@@ -32,6 +35,8 @@
 /*************************************************************************************************/
 
 typedef struct DvzTicks DvzTicks;
+typedef struct DvzTicksEntry DvzTicksEntry;
+typedef struct DvzTicksStats DvzTicksStats;
 
 
 
@@ -69,6 +74,27 @@ typedef enum
 /*  Structs                                                                                      */
 /*************************************************************************************************/
 
+struct DvzTicksStats
+{
+    uint64_t computes;    // total number of calls to dvz_ticks_compute()
+    uint64_t cache_hits;  // computations answered by the solution cache
+    uint64_t warm_starts; // searches seeded with the previous solution
+    uint64_t candidates;  // total number of candidates whose legibility was evaluated
+};
+
+
+
+struct DvzTicksEntry
+{
+    int64_t key[5]; // quantized dmin, dmax, range size, glyph size, and requested count
+    bool valid;
+    double lmin, lmax, lstep;
+    DvzTicksFormat format;
+    int32_t q, j, k, z; // parameters of the solution
+};
+
+
+
 struct DvzTicks
 {
     int flags;
@@ -79,6 +105,13 @@ struct DvzTicks
     double lmin, lmax, lstep; // computed min and max of the ticks
     DvzTicksFormat format;    // computed tick format
     // uint32_t precision;       // computed tick precision
+
+    // Parameters of the computed solution (index of the nice number, skip, number of labels,
+    // exponent of the step), used to warm-start the next search. k is 0 if there is none.
+    int32_t q, j, k, z;
+
+    DvzTicksEntry cache[DVZ_TICKS_CACHE_SIZE];
+    DvzTicksStats stats;
 };
 
 
@@ -133,6 +166,10 @@ DVZ_EXPORT void dvz_ticks_print(DvzTicks* ticks);
 
 
 
+DVZ_EXPORT DvzTicksStats dvz_ticks_stats(DvzTicks* ticks);
+
+
+
 DVZ_EXPORT void dvz_ticks_destroy(DvzTicks* ticks);
 
 
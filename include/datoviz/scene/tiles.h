@@ -0,0 +1,247 @@
+/*************************************************************************************************/
+/* Tiles                                                                                         */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_TILES
+#define DVZ_HEADER_TILES
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "_enums.h"
+#include "_math.h"
+
+
+
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+#define DVZ_TILE_SIZE          256 // size of a tile in the atlas, in pixels
+#define DVZ_TILES_MAX_LEVELS   16
+#define DVZ_TILES_MAX_THREADS  16
+#define DVZ_TILES_MAX_PENDING  32 // maximum number of tiles being loaded in the background
+#define DVZ_TILES_UPLOAD_LIMIT 16 // maximum number of tile uploads per update
+
+
+
+/*************************************************************************************************/
+/*  Typedefs                                                                                     */
+/*************************************************************************************************/
+
+typedef struct DvzTiles DvzTiles;
+typedef struct DvzTilesStats DvzTilesStats;
+typedef struct DvzTileJob DvzTileJob;
+
+// Forward declarations.
+typedef struct DvzBatch DvzBatch;
+typedef struct DvzFifo DvzFifo;
+typedef struct DvzPanzoom DvzPanzoom;
+typedef struct DvzThread DvzThread;
+typedef struct DvzVisual DvzVisual;
+
+
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+struct DvzTilesStats
+{
+    uint32_t level;     // pyramid level selected by the last update
+    uint32_t resident;  // number of tiles currently in the atlas
+    uint32_t requested; // number of tiles requested by the last update
+    uint32_t missing;   // requested tiles not resident after the last update
+    uint32_t pending;   // tiles being loaded in the background
+    uint64_t loads;     // total number of tile uploads
+    uint64_t evictions; // total number of tiles evicted from the atlas
+    uint64_t hits;      // total number of requested tiles already resident
+};
+
+
+
+struct DvzTileJob
+{
+    DvzTiles* tiles;
+    uint32_t tile;
+    uint8_t* data; // tile pixels, filled by a worker thread
+};
+
+
+
+struct DvzTiles
+{
+    DvzBatch* batch;
+    DvzFormat format;
+    DvzSize pixel_size;
+    uint32_t width, height; // image size at the finest level
+    vec4 ul_lr;             // upper left and lower right corners, in data coordinates
+
+    // Source image, either mapped from a file or provided by the caller.
+    uint8_t* data;
+    DvzSize data_size;
+    void* mapped;
+    DvzSize mapped_size;
+
+    // Multi-resolution pyramid: level l has a shape ceil(shape / 2^l), the tiles of level l are
+    // identified by a global index starting at level_offset[l].
+    uint32_t level_count;
+    uvec2 grid[DVZ_TILES_MAX_LEVELS];
+    uint32_t level_offset[DVZ_TILES_MAX_LEVELS];
+    uint32_t tile_count;
+
+    // Tile cache in a 2D atlas texture, with a LRU replacement policy.
+    uvec2 atlas_shape; // number of tile slots in each dimension
+    uint32_t slot_count;
+    int32_t* slot_tile;   // tile index in each slot, -1 if empty
+    int32_t* tile_slot;   // slot of each tile, -1 if not resident
+    uint64_t* slot_used;  // last update in which each slot was used
+    bool* tile_pending;   // whether each tile is being loaded
+    uint32_t* requests;   // tiles requested by the last update
+    uint64_t update;      // update counter
+    uint32_t level;       // level selected by the last update
+    bool quads_dirty;     // whether the quads of the visual need to be rebuilt
+
+    // Background loading: the jobs are extracted by the worker threads, and uploaded by the
+    // thread calling dvz_tiles_update().
+    uint32_t thread_count;
+    DvzThread* threads[DVZ_TILES_MAX_THREADS];
+    DvzFifo* jobs; // jobs to be processed by the workers
+    DvzFifo* done; // jobs ready to be uploaded
+    DvzTileJob job_pool[DVZ_TILES_MAX_PENDING];
+    DvzTileJob* job_free[DVZ_TILES_MAX_PENDING];
+    uint32_t job_free_count;
+
+    DvzId atlas;
+    DvzVisual* visual; // image visual with one quad per slot, drawn from coarse to fine
+    vec4* quad_pos;
+    vec4* quad_uv;
+
+    DvzTilesStats stats;
+};
+
+
+
+EXTERN_C_ON
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+/**
+ * Create a tiled image pyramid, streamed in a tile cache in the GPU.
+ *
+ * The tiles are drawn by an image visual owned by the returned object, to be added to a panel
+ * with `dvz_panel_visual()`.
+ *
+ * @param batch the batch
+ * @param format the pixel format
+ * @param width the image width, at the finest level
+ * @param height the image height, at the finest level
+ * @param atlas_shape the number of tile slots in the atlas texture along each axis
+ * @param thread_count the number of threads loading the tiles (0 to load them synchronously)
+ * @returns the tiled image
+ */
+DVZ_EXPORT DvzTiles* dvz_tiles(
+    DvzBatch* batch, DvzFormat format, uint32_t width, uint32_t height, uvec2 atlas_shape,
+    uint32_t thread_count);
+
+
+
+/**
+ * Use an in-memory image as the source of the tiles (the data is not copied).
+ *
+ * @param tiles the tiled image
+ * @param data the pixels, row by row from the top, must remain valid during the lifetime of the
+ *      tiled image
+ */
+DVZ_EXPORT void dvz_tiles_data(DvzTiles* tiles, void* data);
+
+
+
+/**
+ * Use a raw image file as the source of the tiles, mapped in memory.
+ *
+ * @param tiles the tiled image
+ * @param path the path to the raw file
+ * @param offset the offset of the pixels in the file, in bytes (header size)
+ * @returns 0 if the file could be mapped
+ */
+DVZ_EXPORT int dvz_tiles_file(DvzTiles* tiles, const char* path, DvzSize offset);
+
+
+
+/**
+ * Use a NumPy .npy file as the source of the tiles, mapped in memory.
+ *
+ * The array must be C-contiguous with a shape (height, width) or (height, width, channels)
+ * matching the image size and pixel format.
+ *
+ * @param tiles the tiled image
+ * @param path the path to the .npy file
+ * @returns 0 if the file could be mapped
+ */
+DVZ_EXPORT int dvz_tiles_npy(DvzTiles* tiles, const char* path);
+
+
+
+/**
+ * Set the position of the image.
+ *
+ * @param tiles the tiled image
+ * @param ul_lr the upper left and lower right corners, in data coordinates
+ */
+DVZ_EXPORT void dvz_tiles_position(DvzTiles* tiles, vec4 ul_lr);
+
+
+
+/**
+ * Return the image visual displaying the tiles.
+ *
+ * @param tiles the tiled image
+ * @returns the visual
+ */
+DVZ_EXPORT DvzVisual* dvz_tiles_visual(DvzTiles* tiles);
+
+
+
+/**
+ * Load the tiles visible with the current pan and zoom, and upload the tiles that are ready.
+ *
+ * The pyramid level is chosen so that an image pixel is about one screen pixel. The coarsest
+ * level is always kept resident, and coarser tiles are drawn below finer tiles as a fallback
+ * while the latter are loading.
+ *
+ * @param tiles the tiled image
+ * @param pz the panel panzoom (see `dvz_panel_panzoom()`)
+ * @returns the number of tiles uploaded
+ */
+DVZ_EXPORT uint32_t dvz_tiles_update(DvzTiles* tiles, DvzPanzoom* pz);
+
+
+
+/**
+ * Return the tile cache statistics.
+ *
+ * @param tiles the tiled image
+ * @returns the statistics
+ */
+DVZ_EXPORT DvzTilesStats dvz_tiles_stats(DvzTiles* tiles);
+
+
+
+/**
+ * Destroy a tiled image and its visual.
+ *
+ * @param tiles the tiled image
+ */
+DVZ_EXPORT void dvz_tiles_destroy(DvzTiles* tiles);
+
+
+
+EXTERN_C_OFF
+
+#endif
@@ -80,6 +80,29 @@ DVZ_EXPORT void dvz_transform_update(DvzTransform* tr);
 
 
 
+/**
+ * Mark the transform as dirty without emitting an upload request.
+ *
+ * The MVP will be uploaded by the next call to dvz_transform_flush(), so that several changes
+ * within the same frame result in a single upload.
+ *
+ * @param tr the transform
+ * @returns whether an upload was already pending (in which case one upload is saved)
+ */
+DVZ_EXPORT bool dvz_transform_dirty(DvzTransform* tr);
+
+
+
+/**
+ * Emit an upload request for the MVP if the transform is dirty.
+ *
+ * @param tr the transform
+ * @returns whether an upload request was emitted
+ */
+DVZ_EXPORT bool dvz_transform_flush(DvzTransform* tr);
+
+
+
 /**
  *
  */
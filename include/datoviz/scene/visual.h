@@ -13,6 +13,7 @@
 
 #include "../_enums.h"
 #include "../_obj.h"
+#include "../recorder.h"
 #include "mvp.h"
 #include "params.h"
 #include "viewport.h"
@@ -33,6 +34,7 @@
 
 typedef struct DvzVisual DvzVisual;
 typedef struct DvzVisualAttr DvzVisualAttr;
+typedef struct DvzVisualUpdate DvzVisualUpdate;
 
 // Forward declarations.
 typedef struct DvzBatch DvzBatch;
@@ -107,6 +109,18 @@ struct DvzVisualAttr
 
 
 
+// NOTE: the layout of this struct is mirrored by a NumPy structured dtype in the Python bindings.
+struct DvzVisualUpdate
+{
+    DvzVisual* visual;
+    uint32_t attr_idx;
+    uint32_t first;
+    uint32_t count;
+    void* data;
+};
+
+
+
 struct DvzVisual
 {
     DvzObject obj;
@@ -139,6 +153,11 @@ struct DvzVisual
     uint32_t instance_count;
     bool is_visible;
 
+    // Push constants, recorded before the draw command.
+    int push_stages; // DvzShaderType flags, 0 if the visual has no push constants
+    DvzSize push_size;
+    uint8_t push_data[DVZ_RECORDER_PUSH_SIZE];
+
     // Visual draw callback.
     DvzVisualCallback callback;
 };
@@ -225,6 +244,33 @@ DVZ_EXPORT void dvz_visual_specialization(
 
 
 
+/**
+ * Declare the push constants of a visual, to be called before the visual is first drawn.
+ *
+ * @param visual the visual
+ * @param shader_stages the shader stages reading the push constants (DvzShaderType flags)
+ * @param size the size of the push constant block, at most DVZ_RECORDER_PUSH_SIZE bytes
+ */
+DVZ_EXPORT void dvz_visual_push(DvzVisual* visual, int shader_stages, DvzSize size);
+
+
+
+/**
+ * Set a push constant field of a visual.
+ *
+ * The value is recorded in the command buffer with the draw command, so that it is applied
+ * without any uniform upload, at the cost of a new recording of the command buffer.
+ *
+ * @param visual the visual
+ * @param offset the offset of the field in the push constant block, in bytes
+ * @param size the size of the field, in bytes
+ * @param data the field value
+ */
+DVZ_EXPORT void
+dvz_visual_push_data(DvzVisual* visual, DvzSize offset, DvzSize size, const void* data);
+
+
+
 /**
  *
  */
@@ -329,6 +375,20 @@ DVZ_EXPORT void dvz_visual_alloc(
 
 
 
+/**
+ * Draw a visual with the vertex and index buffers of another visual of the same type.
+ *
+ * The visual keeps its own pipeline and descriptors (MVP, viewport, params, textures), but it has
+ * no vertex or index data of its own: the data is set, uploaded, and resized via the source
+ * visual. This function must be called again after the source visual has been resized.
+ *
+ * @param visual the visual
+ * @param source the source visual, already allocated, to be destroyed after the visual
+ */
+DVZ_EXPORT void dvz_visual_share(DvzVisual* visual, DvzVisual* source);
+
+
+
 /**
  *
  */
@@ -390,6 +450,19 @@ dvz_visual_param(DvzVisual* visual, uint32_t slot_idx, uint32_t attr_idx, void*
 
 
 
+/**
+ * Apply many attribute updates, possibly to different visuals, in a single call.
+ *
+ * Each update is equivalent to `dvz_visual_data()`, and each modified visual is then updated once
+ * with `dvz_visual_update()`.
+ *
+ * @param count the number of updates
+ * @param updates the updates
+ */
+DVZ_EXPORT void dvz_visual_updates(uint32_t count, DvzVisualUpdate* updates);
+
+
+
 /*************************************************************************************************/
 /*  Visual drawing internal functions                                                            */
 /*************************************************************************************************/
@@ -125,7 +125,13 @@ dvz_glyph_shift(DvzVisual* visual, uint32_t first, uint32_t count, vec2* values,
 
 
 /**
+ * Set the glyph texture coordinates.
  *
+ * @param visual the visual
+ * @param first the index of the first glyph to update
+ * @param count the number of glyphs to update
+ * @param coords the x, y, w, h box of each glyph in the atlas texture, in pixels, from the top
+ * @param flags the data update flags
  */
 DVZ_EXPORT void
 dvz_glyph_texcoords(DvzVisual* visual, uint32_t first, uint32_t count, vec4* coords, int flags);
@@ -184,6 +190,20 @@ DVZ_EXPORT void dvz_glyph_unicode(DvzVisual* visual, uint32_t count, uint32_t* c
 
 
 
+/**
+ * Set the texture coordinates of a range of glyphs from their Unicode codepoints.
+ *
+ * @param visual the visual
+ * @param first the index of the first glyph to update
+ * @param count the number of glyphs to update
+ * @param codepoints the codepoints
+ * @param flags the data update flags
+ */
+DVZ_EXPORT void dvz_glyph_codepoints(
+    DvzVisual* visual, uint32_t first, uint32_t count, uint32_t* codepoints, int flags);
+
+
+
 /**
  *
  */
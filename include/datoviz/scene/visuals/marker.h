@@ -138,6 +138,17 @@ DVZ_EXPORT void dvz_marker_edge_width(DvzVisual* visual, float value);
 
 
 
+/**
+ * Set a size multiplier applied to all markers, as a push constant that is applied without any
+ * upload.
+ *
+ * @param visual the visual
+ * @param value the size multiplier (1 by default)
+ */
+DVZ_EXPORT void dvz_marker_scale(DvzVisual* visual, float value);
+
+
+
 /**
  *
  */
@@ -53,7 +53,7 @@ struct DvzPathVertex
 
 struct DvzPathParams
 {
-    float linewidth;    /* line width in pixels */
+    float linewidth;    /* unused, the line width is a push constant */
     float miter_limit;  /* miter limit for joins */
     int32_t cap_type;   /* type of the ends of the path */
     int32_t round_join; /* whether to use round joins */
@@ -92,7 +92,10 @@ dvz_path_color(DvzVisual* visual, uint32_t first, uint32_t count, cvec4* values,
 
 
 /**
+ * Set the line width, as a push constant that is applied without any uniform upload.
  *
+ * @param visual the visual
+ * @param value the line width, in pixels
  */
 DVZ_EXPORT void dvz_path_linewidth(DvzVisual* visual, float value);
 
@@ -26,6 +26,7 @@ typedef struct DvzVolumeParams DvzVolumeParams;
 
 // Forward declarations.
 typedef struct DvzBatch DvzBatch;
+typedef struct DvzBricks DvzBricks;
 typedef struct DvzVisual DvzVisual;
 typedef struct DvzShape DvzShape;
 
@@ -57,6 +58,7 @@ typedef enum
     DVZ_VOLUME_FLAGS_RGBA = 0x0001,
     DVZ_VOLUME_FLAGS_COLORMAP = 0x0002,
     DVZ_VOLUME_FLAGS_BACK_FRONT = 0x0004,
+    DVZ_VOLUME_FLAGS_BRICKED = 0x0008,
 } DvzVolumeFlags;
 
 
@@ -76,6 +78,8 @@ struct DvzVolumeParams
     vec4 uvw0;     /* texture coordinates of the 2 corner points */
     vec4 uvw1;     /* texture coordinates of the 2 corner points */
     vec4 transfer;
+    vec4 shape; /* bricked volume: shape of the volume at the finest level */
+    vec4 atlas; /* bricked volume: number of brick slots in the atlas */
 };
 
 
@@ -104,9 +108,12 @@ static void volume_specialization(DvzVisual* visual)
     if ((flags & DVZ_VOLUME_FLAGS_BACK_FRONT) != 0)
         volume_dir = VOLUME_DIR_BACK_FRONT;
 
+    int volume_bricked = (flags & DVZ_VOLUME_FLAGS_BRICKED) != 0 ? 1 : 0;
+
     dvz_visual_specialization(visual, DVZ_SHADER_FRAGMENT, 0, sizeof(int), &volume_type);
     dvz_visual_specialization(visual, DVZ_SHADER_FRAGMENT, 1, sizeof(int), &volume_color);
     dvz_visual_specialization(visual, DVZ_SHADER_FRAGMENT, 2, sizeof(int), &volume_dir);
+    dvz_visual_specialization(visual, DVZ_SHADER_FRAGMENT, 3, sizeof(int), &volume_bricked);
 }
 
 
@@ -137,6 +144,19 @@ DVZ_EXPORT void dvz_volume_texture(
 
 
 
+/**
+ * Bind a bricked volume to a volume visual created with DVZ_VOLUME_FLAGS_BRICKED.
+ *
+ * The brick cache must be updated with `dvz_bricks_update()` when the camera changes.
+ *
+ * @param visual the volume visual
+ * @param bricks the bricked volume
+ * @param filter the filter used to sample the brick atlas
+ */
+DVZ_EXPORT void dvz_volume_bricks(DvzVisual* visual, DvzBricks* bricks, DvzFilter filter);
+
+
+
 /**
  *
  */
@@ -0,0 +1,166 @@
+/*************************************************************************************************/
+/*  Shm: named shared-memory arenas for upload payloads                                          */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_SHM
+#define DVZ_HEADER_SHM
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "_enums.h"
+#include "_log.h"
+#include "_math.h"
+
+
+
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+#define DVZ_SHM_MAGIC     0x4D485344 // "DSHM"
+#define DVZ_SHM_ALIGNMENT 64         // alignment of the blocks, and size of the block headers
+
+
+
+/*************************************************************************************************/
+/*  Typedefs                                                                                     */
+/*************************************************************************************************/
+
+typedef struct DvzShm DvzShm;
+
+// Forward declarations.
+typedef struct DvzShmHeader DvzShmHeader;
+
+
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+struct DvzShm
+{
+    DvzId id; // the segment is named after its id, so that any process can map it
+    bool is_owner;
+    char name[32];
+    DvzSize size; // size of the mapping, header included
+    uint8_t* map;
+    DvzShmHeader* header;
+};
+
+
+
+EXTERN_C_ON
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+/**
+ * Create a named shared-memory arena.
+ *
+ * The arena is split into blocks, each one with an atomic reference count stored in the segment
+ * itself, so that blocks can be released by the process that consumed them. Only the creator of
+ * the arena allocates blocks, and blocks whose count dropped to zero are reused.
+ *
+ * @param size the capacity of the arena, in bytes
+ * @returns the arena, or NULL if the segment could not be created
+ */
+DVZ_EXPORT DvzShm* dvz_shm(DvzSize size);
+
+
+
+/**
+ * Return the arena with a given id, mapping the segment the first time it is requested.
+ *
+ * The arenas created in this process are returned directly, the arenas created by other processes
+ * are mapped lazily and kept until they have been destroyed by their owner and all of their
+ * blocks have been released. The caller must hold a reference on a block of the arena for the
+ * returned arena to remain mapped.
+ *
+ * @param id the arena id
+ * @returns the arena, or NULL if the segment does not exist
+ */
+DVZ_EXPORT DvzShm* dvz_shm_get(DvzId id);
+
+
+
+/**
+ * Allocate a block in an arena, with a reference count of 1.
+ *
+ * @param shm the arena, which must have been created by this process
+ * @param size the size of the block, in bytes
+ * @param offset a pointer to the offset of the block in the arena, to pass to the other processes
+ * @returns a pointer to the block, or NULL if the arena is full
+ */
+DVZ_EXPORT void* dvz_shm_alloc(DvzShm* shm, DvzSize size, DvzSize* offset);
+
+
+
+/**
+ * Return a pointer to a block of an arena.
+ *
+ * The offset and the size are checked against the mapping and the block header, as they may
+ * come from another process.
+ *
+ * @param shm the arena
+ * @param offset the offset of the block, as returned by `dvz_shm_alloc()`
+ * @param size the number of bytes to access from the start of the block
+ * @returns a pointer to the block, or NULL if the offset does not point to a live block holding
+ *     at least `size` bytes
+ */
+DVZ_EXPORT void* dvz_shm_pointer(DvzShm* shm, DvzSize offset, DvzSize size);
+
+
+
+/**
+ * Increment the reference count of a block.
+ *
+ * @param shm the arena
+ * @param offset the offset of the block
+ */
+DVZ_EXPORT void dvz_shm_ref(DvzShm* shm, DvzSize offset);
+
+
+
+/**
+ * Decrement the reference count of a block, which can be reused once the count drops to zero.
+ *
+ * The arena of another process is unmapped when its last block is released after its owner
+ * destroyed it, `shm` must not be used afterwards in that case.
+ *
+ * @param shm the arena
+ * @param offset the offset of the block
+ */
+DVZ_EXPORT void dvz_shm_unref(DvzShm* shm, DvzSize offset);
+
+
+
+/**
+ * Return the total number of references held on the blocks of an arena.
+ *
+ * @param shm the arena
+ * @returns the number of references
+ */
+DVZ_EXPORT uint64_t dvz_shm_refs(DvzShm* shm);
+
+
+
+/**
+ * Destroy an arena.
+ *
+ * The owner removes the segment name: processes that have already mapped it can still release
+ * their blocks, but it can no longer be mapped.
+ *
+ * @param shm the arena
+ */
+DVZ_EXPORT void dvz_shm_destroy(DvzShm* shm);
+
+
+
+EXTERN_C_OFF
+
+#endif
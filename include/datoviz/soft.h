@@ -0,0 +1,244 @@
+/*************************************************************************************************/
+/*  Soft: CPU-only software renderer                                                             */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_SOFT
+#define DVZ_HEADER_SOFT
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "_enums.h"
+#include "_log.h"
+#include "_math.h"
+#include "_obj.h"
+#include "request.h"
+
+
+
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+#define DVZ_SOFT_TILE_SIZE   64 // size of the rasterization tiles, in pixels
+#define DVZ_SOFT_MAX_THREADS 16
+
+
+
+/*************************************************************************************************/
+/*  Enums                                                                                        */
+/*************************************************************************************************/
+
+// Builtin visuals the software renderer knows how to draw, recognized from their vertex layout.
+typedef enum
+{
+    DVZ_SOFT_KIND_GENERIC, // position at location 0, first RGBA8 attribute as color
+    DVZ_SOFT_KIND_POINT,
+    DVZ_SOFT_KIND_MARKER,
+    DVZ_SOFT_KIND_SEGMENT,
+    DVZ_SOFT_KIND_PATH,
+    DVZ_SOFT_KIND_IMAGE,
+    DVZ_SOFT_KIND_MESH,
+} DvzSoftKind;
+
+
+
+/*************************************************************************************************/
+/*  Typedefs                                                                                     */
+/*************************************************************************************************/
+
+typedef struct DvzSoft DvzSoft;
+typedef struct DvzSoftBoard DvzSoftBoard;
+typedef struct DvzSoftDat DvzSoftDat;
+typedef struct DvzSoftTex DvzSoftTex;
+typedef struct DvzSoftAttr DvzSoftAttr;
+typedef struct DvzSoftGraphics DvzSoftGraphics;
+typedef struct DvzSoftStats DvzSoftStats;
+
+// Forward declarations.
+typedef struct DvzMap DvzMap;
+typedef struct DvzRecorder DvzRecorder;
+typedef struct DvzSoftFrame DvzSoftFrame;
+
+
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+struct DvzSoftBoard
+{
+    DvzObject obj;
+    uint32_t width, height;
+    cvec4 background;
+
+    DvzSize size;  // width*height*3
+    uint8_t* rgb;  // resolved image
+    uint8_t* rgba; // color buffer
+    float* depth;  // depth buffer
+
+    DvzRecorder* recorder;
+};
+
+
+
+struct DvzSoftDat
+{
+    DvzObject obj;
+    DvzBufferType type;
+    DvzSize size;
+    uint8_t* data;
+};
+
+
+
+struct DvzSoftTex
+{
+    DvzObject obj;
+    DvzTexDims dims;
+    uvec3 shape;
+    DvzFormat format;
+    DvzSize item_size;
+    uint8_t* data;
+};
+
+
+
+struct DvzSoftAttr
+{
+    uint32_t binding_idx;
+    DvzFormat format;
+    DvzSize offset;
+};
+
+
+
+struct DvzSoftGraphics
+{
+    DvzObject obj;
+    DvzGraphicsType type;
+    DvzPrimitiveTopology primitive;
+    DvzDepthTest depth_test;
+    DvzBlendType blend;
+
+    uint32_t attr_count;
+    DvzSoftAttr attrs[DVZ_MAX_VERTEX_ATTRS];
+
+    DvzSize strides[DVZ_MAX_VERTEX_BINDINGS];
+    DvzVertexInputRate rates[DVZ_MAX_VERTEX_BINDINGS];
+    DvzId vertex_dats[DVZ_MAX_VERTEX_BINDINGS];
+    DvzSize vertex_offsets[DVZ_MAX_VERTEX_BINDINGS];
+    DvzId index_dat;
+    DvzSize index_offset;
+
+    DvzId slot_dats[DVZ_MAX_BINDINGS];
+    DvzSize slot_offsets[DVZ_MAX_BINDINGS];
+    DvzId slot_texs[DVZ_MAX_BINDINGS];
+
+    uint8_t push[DVZ_RECORDER_PUSH_SIZE];
+    DvzSize push_size; // number of push constant bytes set by the recorded commands
+};
+
+
+
+struct DvzSoftStats
+{
+    uint64_t frames;     // number of rendered boards
+    uint64_t primitives; // number of rasterized primitives
+    uint64_t fragments;  // number of shaded pixels
+};
+
+
+
+struct DvzSoft
+{
+    DvzObject obj;
+    int flags;
+    uint32_t thread_count;
+    DvzMap* map; // mapping between ids and objects, with the request object type
+    DvzSoftFrame* frame; // scratch buffers reused from one render to the next
+    DvzSoftStats stats;
+};
+
+
+
+EXTERN_C_ON
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+/**
+ * Create a software renderer, consuming the same requests as the Vulkan renderer.
+ *
+ * Boards (and canvases, which are rendered offscreen like boards) are rasterized on the CPU by a
+ * pool of threads, each one processing screen tiles, so that the output does not depend on the
+ * number of threads. The builtin visuals (point, marker, segment, path, image, mesh) are drawn
+ * with a reduced fidelity: the SPIR-V shaders are ignored, markers are discs, lines have round
+ * caps, and there is no antialiasing nor lighting.
+ *
+ * @param flags the renderer flags
+ * @returns the software renderer
+ */
+DVZ_EXPORT DvzSoft* dvz_soft(int flags);
+
+
+
+/**
+ * Set the number of rasterization threads.
+ *
+ * @param soft the software renderer
+ * @param thread_count the number of threads, 0 to use the number of CPU cores
+ */
+DVZ_EXPORT void dvz_soft_threads(DvzSoft* soft, uint32_t thread_count);
+
+
+
+/**
+ * Process a request.
+ *
+ * @param soft the software renderer
+ * @param req the request
+ */
+DVZ_EXPORT void dvz_soft_request(DvzSoft* soft, DvzRequest req);
+
+
+
+/**
+ * Retrieve the image rendered by the last update of a board.
+ *
+ * @param soft the software renderer
+ * @param board_id the id of the board or canvas
+ * @param size a pointer to a variable that will store the size, in bytes, of the image
+ * @param rgb a pointer to the image, or NULL if this array should be handled by datoviz
+ * @returns a pointer to the RGB image
+ */
+DVZ_EXPORT uint8_t* dvz_soft_image(DvzSoft* soft, DvzId board_id, DvzSize* size, uint8_t* rgb);
+
+
+
+/**
+ * Return the rendering statistics.
+ *
+ * @param soft the software renderer
+ * @returns the statistics
+ */
+DVZ_EXPORT DvzSoftStats dvz_soft_stats(DvzSoft* soft);
+
+
+
+/**
+ * Destroy a software renderer.
+ *
+ * @param soft the software renderer
+ */
+DVZ_EXPORT void dvz_soft_destroy(DvzSoft* soft);
+
+
+
+EXTERN_C_OFF
+
+#endif
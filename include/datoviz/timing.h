@@ -0,0 +1,236 @@
+/*************************************************************************************************/
+/*  Frame timing                                                                                 */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_TIMING
+#define DVZ_HEADER_TIMING
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "_time.h"
+#include "common.h"
+
+
+
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+#define DVZ_TIMING_CAPACITY 256
+
+
+
+/*************************************************************************************************/
+/*  Enums                                                                                        */
+/*************************************************************************************************/
+
+// Frame stages measured on the CPU, in the order in which they occur within a frame.
+typedef enum
+{
+    DVZ_TIMING_JIT,       // just-in-time wait for the frame slot, before input and requests
+    DVZ_TIMING_REQUESTS,  // processing of the requests received since the last frame
+    DVZ_TIMING_FENCE,     // wait on the frame-in-flight fence
+    DVZ_TIMING_ACQUIRE,   // swapchain image acquisition
+    DVZ_TIMING_TRANSFERS, // transfer batch recording and submission
+    DVZ_TIMING_RECORD,    // command buffer recording (only when the recorder is dirty)
+    DVZ_TIMING_SUBMIT,    // render submission
+    DVZ_TIMING_PRESENT,   // swapchain present
+    DVZ_TIMING_STAGE_COUNT,
+} DvzTimingStage;
+
+
+
+/*************************************************************************************************/
+/*  Typedefs                                                                                     */
+/*************************************************************************************************/
+
+typedef struct DvzFrameTiming DvzFrameTiming;
+typedef struct DvzTiming DvzTiming;
+
+
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+// All CPU times are in seconds, relative to the creation of the DvzTiming instance. A stage that
+// did not occur during a frame has a negative begin time.
+struct DvzFrameTiming
+{
+    uint64_t seq;       // sequence number of the record, incremented at every frame
+    uint64_t frame_idx; // client frame index
+    DvzId window_id;
+
+    // Presentation policy used for this frame.
+    uint32_t frames_in_flight;
+    uint32_t present_mode; // VkPresentModeKHR
+    bool jit;
+
+    double frame_begin, frame_end;
+    double begin[DVZ_TIMING_STAGE_COUNT];
+    double end[DVZ_TIMING_STAGE_COUNT];
+
+    // Duration of the render pass measured on the GPU with timestamp queries, negative if
+    // unavailable. It is only known once the frame fence has been waited on, a few frames later.
+    double gpu;
+};
+
+
+
+struct DvzTiming
+{
+    DvzClock clock;
+    uint32_t capacity;
+    uint64_t count; // total number of frames recorded so far
+    DvzFrameTiming* records;
+
+    // Stages measured between two frames (request processing), moved to the next frame record.
+    DvzFrameTiming pending;
+    DvzFrameTiming* current;
+};
+
+
+
+EXTERN_C_ON
+
+/*************************************************************************************************/
+/*  Timing functions                                                                             */
+/*************************************************************************************************/
+
+/**
+ * Create a frame timing ring buffer.
+ *
+ * @param capacity the maximum number of frame records kept (the oldest are overwritten)
+ * @returns the timing instance
+ */
+DVZ_EXPORT DvzTiming dvz_timing(uint32_t capacity);
+
+
+
+/**
+ * Start a new frame record.
+ *
+ * @param timing the timing instance
+ * @param frame_idx the client frame index
+ * @param window_id the id of the window being rendered
+ * @returns the sequence number of the new record
+ */
+DVZ_EXPORT uint64_t dvz_timing_frame(DvzTiming* timing, uint64_t frame_idx, DvzId window_id);
+
+
+
+/**
+ * Record the presentation policy used by the current frame.
+ *
+ * @param timing the timing instance
+ * @param frames_in_flight the number of frames in flight
+ * @param present_mode the swapchain present mode (VkPresentModeKHR)
+ * @param jit whether the just-in-time wait is enabled
+ */
+DVZ_EXPORT void
+dvz_timing_policy(DvzTiming* timing, uint32_t frames_in_flight, uint32_t present_mode, bool jit);
+
+
+
+/**
+ * Mark the beginning of a stage.
+ *
+ * Stages marked outside of a frame (between dvz_timing_frame_end() and the next
+ * dvz_timing_frame()) are attributed to the next frame.
+ *
+ * @param timing the timing instance
+ * @param stage the stage
+ */
+DVZ_EXPORT void dvz_timing_begin(DvzTiming* timing, DvzTimingStage stage);
+
+
+
+/**
+ * Mark the end of a stage.
+ *
+ * @param timing the timing instance
+ * @param stage the stage
+ */
+DVZ_EXPORT void dvz_timing_end(DvzTiming* timing, DvzTimingStage stage);
+
+
+
+/**
+ * Close the current frame record.
+ *
+ * @param timing the timing instance
+ */
+DVZ_EXPORT void dvz_timing_frame_end(DvzTiming* timing);
+
+
+
+/**
+ * Set the GPU duration of a frame, once its timestamp queries are available.
+ *
+ * @param timing the timing instance
+ * @param seq the sequence number of the frame record
+ * @param duration the render pass duration on the GPU, in seconds
+ */
+DVZ_EXPORT void dvz_timing_gpu(DvzTiming* timing, uint64_t seq, double duration);
+
+
+
+/**
+ * Return the number of frame records currently available in the ring buffer.
+ *
+ * @param timing the timing instance
+ * @returns the number of records
+ */
+DVZ_EXPORT uint32_t dvz_timing_count(DvzTiming* timing);
+
+
+
+/**
+ * Return a frame record, from the oldest (0) to the most recent (count - 1).
+ *
+ * @param timing the timing instance
+ * @param idx the index of the record
+ * @returns a pointer to the record
+ */
+DVZ_EXPORT DvzFrameTiming* dvz_timing_get(DvzTiming* timing, uint32_t idx);
+
+
+
+/**
+ * Return a frame record from its sequence number.
+ *
+ * @param timing the timing instance
+ * @param seq the sequence number
+ * @returns a pointer to the record, or NULL if it has already been overwritten
+ */
+DVZ_EXPORT DvzFrameTiming* dvz_timing_record(DvzTiming* timing, uint64_t seq);
+
+
+
+/**
+ * Export the frame records as a Chrome trace JSON file (chrome://tracing, Perfetto).
+ *
+ * @param timing the timing instance
+ * @param path the path to the JSON file
+ * @returns 0 if the export succeeded
+ */
+DVZ_EXPORT int dvz_timing_export(DvzTiming* timing, const char* path);
+
+
+
+/**
+ * Destroy a timing instance.
+ *
+ * @param timing the timing instance
+ */
+DVZ_EXPORT void dvz_timing_destroy(DvzTiming* timing);
+
+
+
+EXTERN_C_OFF
+
+#endif
@@ -11,6 +11,7 @@
 /*  Includes                                                                                     */
 /*************************************************************************************************/
 
+#include "_list.h"
 #include "vklite.h"
 
 
@@ -34,6 +35,19 @@
 // Maximum number of pending dup transfers.
 #define DVZ_DUPS_MAX 16
 
+// Number of per-frame transfer batches that may be in flight at the same time.
+#define DVZ_TRANSFER_BATCH_COUNT DVZ_MAX_FRAMES_IN_FLIGHT
+
+// Number of binary semaphores the render submissions (one per canvas) may signal between two
+// transfer batches.
+#define DVZ_TRANSFER_RENDER_SEMAPHORES DVZ_MAX_SEMAPHORES_PER_SET
+
+// Default size of the persistently-mapped staging ring used by the non-blocking uploads.
+#define DVZ_STAGING_RING_SIZE (32 * 1024 * 1024)
+
+// Alignment of the allocations in the staging ring, in bytes.
+#define DVZ_STAGING_RING_ALIGNMENT 256
+
 
 
 /*************************************************************************************************/
@@ -85,6 +99,13 @@ typedef struct DvzTransferDup DvzTransferDup;
 typedef struct DvzTransfers DvzTransfers;
 typedef struct DvzTransferDupItem DvzTransferDupItem;
 typedef struct DvzTransferDups DvzTransferDups;
+typedef struct DvzTransferBatch DvzTransferBatch;
+typedef struct DvzTransferRelease DvzTransferRelease;
+typedef struct DvzStagingRing DvzStagingRing;
+typedef struct DvzStagingRingStats DvzStagingRingStats;
+typedef struct DvzQueueScheduler DvzQueueScheduler;
+
+typedef void (*DvzTransferReleaseCallback)(void* user_data);
 
 
 
@@ -184,6 +205,114 @@ struct DvzTransferDups
 
 
 
+/*************************************************************************************************/
+/*  Transfer batch                                                                               */
+/*************************************************************************************************/
+
+// Resource release callback, deferred until the batch that uses the resource has completed.
+struct DvzTransferRelease
+{
+    DvzTransferReleaseCallback callback;
+    void* user_data;
+};
+
+
+
+// All GPU copies dequeued during one frame are recorded into a single command buffer submitted
+// to the transfer queue. There is one batch slot per frame in flight.
+struct DvzTransferBatch
+{
+    DvzCommands cmds;       // one command buffer per batch slot, on the transfer queue
+    DvzFences fences;       // signaled when a batch has been executed by the GPU
+    DvzSemaphores sem_done; // signaled when a batch has been executed, waited upon by the renderer
+    DvzSemaphores sem_render; // signaled by the render submissions, waited upon by the next batch
+
+    uint32_t slot;                            // current batch slot
+    uint32_t count;                           // number of copies recorded in the current batch
+    bool recording;                           // whether the copies are recorded or submitted
+    bool submitted[DVZ_TRANSFER_BATCH_COUNT]; // whether a batch slot is in flight
+    DvzList* releases[DVZ_TRANSFER_BATCH_COUNT]; // pending releases for each batch slot
+
+    // Semaphore synchronization with the renderer (only when async is true).
+    bool async;            // if false, the CPU waits for the batch fence at the end of the frame
+    bool done_pending;     // whether sem_done[done_slot] needs to be waited upon by the renderer
+    uint32_t done_slot;    // slot of the last batch with copies
+    uint32_t render_first; // first semaphore of sem_render signaled since the last batch
+    uint32_t render_count; // number of semaphores of sem_render to be waited upon by a batch
+    bool render_missed;    // whether a render submission could not signal a semaphore
+
+    // Statistics.
+    uint64_t batch_count; // number of submitted non-empty batches
+    uint64_t copy_count;  // number of recorded copies
+    DvzSize copy_size;    // total size of the recorded copies, in bytes
+};
+
+
+
+/*************************************************************************************************/
+/*  Staging ring                                                                                 */
+/*************************************************************************************************/
+
+struct DvzStagingRingStats
+{
+    DvzSize size;            // size of the ring, in bytes
+    DvzSize used;            // number of bytes not yet consumed by the GPU
+    DvzSize peak;            // maximum number of bytes used at the same time
+    uint64_t alloc_count;    // number of allocations in the ring
+    DvzSize alloc_size;      // total size of the allocations, in bytes
+    uint64_t wrap_count;     // number of times the ring wrapped around
+    uint64_t stall_count;    // number of allocations that had to wait for an in-flight batch
+    uint64_t overflow_count; // number of allocations that did not fit in the ring
+};
+
+
+
+// Persistently-mapped staging buffer. Uploads are written linearly into it, and the ring wraps
+// around once the transfer batches that read the older regions have completed.
+struct DvzStagingRing
+{
+    DvzBuffer buffer;  // staging buffer, created on first use
+    DvzSize size;      // size of the ring, in bytes
+    DvzSize alignment; // alignment of each allocation
+
+    // Monotonic byte counters: the ring offset is the counter modulo the ring size.
+    DvzSize head; // end of the last allocation
+    DvzSize tail; // end of the last region consumed by the GPU
+
+    // Value of head when each batch slot was submitted: once the batch has completed, the tail
+    // can move up to there.
+    DvzSize slot_head[DVZ_TRANSFER_BATCH_COUNT];
+
+    DvzStagingRingStats stats;
+};
+
+
+
+/*************************************************************************************************/
+/*  Queue scheduler                                                                              */
+/*************************************************************************************************/
+
+// Route the transfers to the GPU queues, and track the dependencies between the transfer batches
+// and the render submissions.
+struct DvzQueueScheduler
+{
+    uint32_t transfer; // queue used for the uploads, downloads and copies
+    uint32_t compute;  // queue used for the compute requests
+    uint32_t render;   // queue used for the rendering
+
+    bool dedicated_transfer; // whether the transfer queue family does not support graphics
+    bool dedicated_compute;  // whether the compute queue family does not support graphics
+    bool shared;             // whether the transfer and render queues are the same VkQueue
+
+    // Timeline semaphores, if supported by the GPU. Otherwise, the binary semaphores of the
+    // transfer batch are used.
+    bool timeline;
+    DvzTimeline transfer_timeline; // signaled by each transfer batch
+    DvzTimeline render_timeline;   // signaled by each render submission
+};
+
+
+
 /*************************************************************************************************/
 /*  Transfers struct                                                                             */
 /*************************************************************************************************/
@@ -197,6 +326,9 @@ struct DvzTransfers
     DvzThread* thread; // transfer thread
 
     DvzTransferDups dups;
+    DvzQueueScheduler scheduler;
+    DvzTransferBatch batch;
+    DvzStagingRing ring;
 };
 
 
@@ -244,12 +376,171 @@ DVZ_EXPORT void dvz_transfers(DvzGpu* gpu, DvzTransfers* transfers);
  * processes the transfers and, since it knows which swapchain image is about to be rendered, it
  * can safely access to the corresponding GPU buffer regions.
  *
+ * All GPU copies processed during the call are recorded into a single command buffer, submitted
+ * once to the transfer queue. See `dvz_transfers_async()` for the synchronization with the
+ * renderer.
+ *
  * @param transfers the DvzTransfers pointer
  */
 DVZ_EXPORT void dvz_transfers_frame(DvzTransfers* transfers, uint32_t img_idx);
 
 
 
+/**
+ * Return the queue index used for a given type of GPU work.
+ *
+ * Transfers go to a dedicated transfer queue family when the GPU has one, and compute requests
+ * to the compute queue. On devices with a single queue, all types of work share the render queue.
+ *
+ * @param transfers the DvzTransfers pointer
+ * @param type the queue type, either DVZ_QUEUE_TRANSFER, DVZ_QUEUE_COMPUTE, or DVZ_QUEUE_RENDER
+ * @returns the queue index
+ */
+DVZ_EXPORT uint32_t dvz_transfers_queue(DvzTransfers* transfers, DvzQueueType type);
+
+
+
+/**
+ * Enable or disable semaphore synchronization between the transfer batches and the renderer.
+ *
+ * By default, `dvz_transfers_frame()` submits the batch of copies recorded during the frame and
+ * waits for its completion on the CPU. In async mode, the batch is not waited upon: instead, the
+ * renderer must call `dvz_transfers_sync_render()` on each of its submissions, so that the render
+ * waits for the copies, and the next batch does not overwrite data still used by the GPU.
+ *
+ * @param transfers the DvzTransfers pointer
+ * @param async whether to use semaphore synchronization
+ */
+DVZ_EXPORT void dvz_transfers_async(DvzTransfers* transfers, bool async);
+
+
+
+/**
+ * Add the dependencies with the transfer batches to a render submission.
+ *
+ * The submission waits for the last transfer batch, and signals a semaphore the next transfer
+ * batch will wait upon. Timeline semaphores are used when the GPU supports them, the binary
+ * semaphores returned by `dvz_transfers_wait_semaphore()` and `dvz_transfers_signal_semaphore()`
+ * otherwise. The submission *must* be sent afterwards. This function does nothing if async mode
+ * is disabled.
+ *
+ * Several render submissions (e.g. one per canvas) may be synchronized with the same batch. A
+ * binary semaphore can only be waited upon once, so with binary semaphores, the submissions after
+ * the first one wait for the batch on the CPU instead.
+ *
+ * @param transfers the DvzTransfers pointer
+ * @param submit the render submission
+ */
+DVZ_EXPORT void dvz_transfers_sync_render(DvzTransfers* transfers, DvzSubmit* submit);
+
+
+
+/**
+ * Return the binary semaphore the next render submission should wait upon, if any.
+ *
+ * Calling this function marks the semaphore as consumed: the caller *must* add it to its next
+ * submission.
+ *
+ * @param transfers the DvzTransfers pointer
+ * @param[out] idx the semaphore index within the returned set
+ * @returns the semaphores, or NULL if no batch was submitted since the last call
+ */
+DVZ_EXPORT DvzSemaphores* dvz_transfers_wait_semaphore(DvzTransfers* transfers, uint32_t* idx);
+
+
+
+/**
+ * Return the binary semaphore the next render submission should signal.
+ *
+ * Calling this function marks the semaphore as pending: the caller *must* add it to its next
+ * submission, and the next transfer batch will wait upon it.
+ *
+ * @param transfers the DvzTransfers pointer
+ * @param[out] idx the semaphore index within the returned set
+ * @returns the semaphores, or NULL if async mode is disabled, timeline semaphores are used, or
+ *      too many render submissions were made since the last batch
+ */
+DVZ_EXPORT DvzSemaphores* dvz_transfers_signal_semaphore(DvzTransfers* transfers, uint32_t* idx);
+
+
+
+/**
+ * Defer a resource release until the GPU has finished executing the current transfer batch.
+ *
+ * If no batch is in flight, the callback is called immediately.
+ *
+ * @param transfers the DvzTransfers pointer
+ * @param callback the release callback
+ * @param user_data the pointer passed to the callback
+ */
+DVZ_EXPORT void dvz_transfers_release(
+    DvzTransfers* transfers, DvzTransferReleaseCallback callback, void* user_data);
+
+
+
+/**
+ * Set the size of the staging ring.
+ *
+ * Must be called before the first non-blocking upload, the ring is created on first use with a
+ * size of `DVZ_STAGING_RING_SIZE` by default.
+ *
+ * @param transfers the DvzTransfers pointer
+ * @param size the size of the ring, in bytes
+ */
+DVZ_EXPORT void dvz_transfers_ring_size(DvzTransfers* transfers, DvzSize size);
+
+
+
+/**
+ * Copy data into the staging ring.
+ *
+ * The data is copied immediately, so the caller may free it as soon as the function returns. The
+ * staged region remains valid until the transfer batch of the next `dvz_transfers_frame()` has
+ * completed. If the ring is full, the function first waits for the oldest in-flight batches.
+ *
+ * @param transfers the DvzTransfers pointer
+ * @param size the size of the data, in bytes
+ * @param data the data to copy
+ * @param[out] br the buffer regions of the ring
+ * @param[out] offset the offset of the staged data within the ring
+ * @returns whether the data could be staged, false if it does not fit in the ring
+ */
+DVZ_EXPORT bool dvz_transfers_stage(
+    DvzTransfers* transfers, DvzSize size, void* data, DvzBufferRegions* br, DvzSize* offset);
+
+
+
+/**
+ * Gather strided items into the staging ring, in a single pass.
+ *
+ * Like `dvz_transfers_stage()`, the items are copied immediately, so that the caller may release
+ * the source as soon as the function returns.
+ *
+ * @param transfers the DvzTransfers pointer
+ * @param count the number of items
+ * @param item_size the size of each item, in bytes
+ * @param stride the distance between two consecutive items in the source, in bytes
+ * @param data the first item of the source
+ * @param[out] br the buffer regions of the ring
+ * @param[out] offset the offset of the staged data within the ring
+ * @returns whether the data could be staged, false if it does not fit in the ring
+ */
+DVZ_EXPORT bool dvz_transfers_stage_strided(
+    DvzTransfers* transfers, uint32_t count, DvzSize item_size, DvzSize stride, void* data,
+    DvzBufferRegions* br, DvzSize* offset);
+
+
+
+/**
+ * Return statistics about the staging ring occupancy and stalls.
+ *
+ * @param transfers the DvzTransfers pointer
+ * @returns the staging ring statistics
+ */
+DVZ_EXPORT DvzStagingRingStats dvz_transfers_ring_stats(DvzTransfers* transfers);
+
+
+
 /**
  * Destroy a transfers object.
  *
@@ -0,0 +1,232 @@
+/*************************************************************************************************/
+/*  Transport: request batches over a Unix domain socket                                         */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_TRANSPORT
+#define DVZ_HEADER_TRANSPORT
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "_enums.h"
+#include "_log.h"
+#include "_math.h"
+#include "request.h"
+
+
+
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+#define DVZ_TRANSPORT_MAGIC     0x545A5644 // "DVZT"
+#define DVZ_TRANSPORT_VERSION   1
+#define DVZ_TRANSPORT_MAX_PEERS 64
+
+// Larger frames are rejected by the server, and not sent by the producers.
+#define DVZ_TRANSPORT_MAX_FRAME_SIZE (1024 * 1024 * 1024)
+
+// Payloads at least this large go through the shared-memory ring of the producer.
+#define DVZ_TRANSPORT_SHM_THRESHOLD (64 * 1024)
+#define DVZ_TRANSPORT_RING_SIZE     (64 * 1024 * 1024)
+#define DVZ_TRANSPORT_ALIGNMENT     64
+
+
+
+/*************************************************************************************************/
+/*  Enums                                                                                        */
+/*************************************************************************************************/
+
+typedef enum
+{
+    DVZ_TRANSPORT_FRAME_NONE,
+    DVZ_TRANSPORT_FRAME_HELLO, // ring size, the ring file descriptor is passed as ancillary data
+    DVZ_TRANSPORT_FRAME_BATCH, // requests, payload descriptors, inline payloads
+} DvzTransportFrameType;
+
+
+
+typedef enum
+{
+    DVZ_TRANSPORT_PAYLOAD_INLINE,     // bytes following the payload descriptors in the frame
+    DVZ_TRANSPORT_PAYLOAD_SHM,        // region of the shared-memory ring of the producer
+    DVZ_TRANSPORT_PAYLOAD_COMPRESSED, // inline bytes compressed with dvz_codec_compress()
+} DvzTransportPayloadLocation;
+
+
+
+/*************************************************************************************************/
+/*  Typedefs                                                                                     */
+/*************************************************************************************************/
+
+typedef struct DvzTransport DvzTransport;
+typedef struct DvzTransportFrame DvzTransportFrame;
+typedef struct DvzTransportPayload DvzTransportPayload;
+typedef struct DvzTransportStats DvzTransportStats;
+
+// Forward declarations.
+typedef struct DvzTransportPeer DvzTransportPeer;
+typedef struct DvzTransportRing DvzTransportRing;
+
+
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+// Header of each frame sent on the socket, followed by `size` bytes.
+struct DvzTransportFrame
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t type; // DvzTransportFrameType
+    uint32_t count; // number of requests
+    uint32_t payload_count;
+    uint64_t size; // size of the frame body, in bytes
+};
+
+
+
+// Location of the pointer payload of a request (upload data, shader code, specialization value).
+struct DvzTransportPayload
+{
+    uint32_t request_idx;
+    uint16_t field;    // 1 for the SPIR-V buffer of a shader, 0 for the other pointers
+    uint16_t location; // DvzTransportPayloadLocation
+    uint64_t offset;   // offset in the inline bytes of the frame, or position in the ring
+    uint64_t size;
+};
+
+
+
+struct DvzTransportStats
+{
+    uint64_t frames;
+    uint64_t requests;
+    uint64_t inline_bytes;     // payload bytes copied through the socket
+    uint64_t shm_bytes;        // payload bytes passed through the shared-memory ring
+    uint64_t compressed_bytes; // size before compression of the compressed inline payloads
+};
+
+
+
+struct DvzTransport
+{
+    bool is_server;
+    char path[256];
+    int fd; // listening socket (server) or connected socket (client)
+
+    // Client: shared-memory ring, read in place by the server.
+    DvzTransportRing* ring;
+    DvzSize compression; // minimum size of the compressed inline payloads, 0 if disabled
+
+    // Server: connected producers.
+    uint32_t peer_count;
+    DvzTransportPeer* peers[DVZ_TRANSPORT_MAX_PEERS];
+
+    DvzTransportStats stats;
+};
+
+
+
+EXTERN_C_ON
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+/**
+ * Create a render server listening on a Unix domain socket.
+ *
+ * @param path the path of the socket file, removed first if it exists
+ * @returns the transport, or NULL if the socket could not be created
+ */
+DVZ_EXPORT DvzTransport* dvz_transport_listen(const char* path);
+
+
+
+/**
+ * Connect a producer to a render server.
+ *
+ * The producer creates an anonymous shared-memory ring and passes it to the server, large
+ * payloads are then written to the ring and read in place by the server instead of being copied
+ * through the socket.
+ *
+ * @param path the path of the socket file
+ * @returns the transport, or NULL if the connection failed
+ */
+DVZ_EXPORT DvzTransport* dvz_transport_connect(const char* path);
+
+
+
+/**
+ * Send a batch of requests to the render server.
+ *
+ * Like `dvz_renderer_requests()`, this function consumes the payloads of the upload requests: the
+ * payloads are freed unless the request has the `DVZ_UPLOAD_FLAGS_NOCOPY` flag, and their release
+ * callback is called once they have been copied. Uploads from a shared-memory arena (see shm.h)
+ * are sent as references, the server maps the arena and releases the blocks once uploaded.
+ *
+ * @param tr the producer transport
+ * @param batch the batch
+ * @returns 0 on success, 1 if the connection was lost
+ */
+DVZ_EXPORT int dvz_transport_send(DvzTransport* tr, DvzBatch* batch);
+
+
+
+/**
+ * Compress the large payloads sent through the socket.
+ *
+ * The payloads that are not passed through the shared-memory ring are compressed on worker
+ * threads, after a byte-shuffle and delta filter for numeric columns, and decompressed by the
+ * server on receive. This is mostly useful when the ring is full or unavailable.
+ *
+ * @param tr the producer transport
+ * @param threshold the minimum size of the compressed payloads, 0 to disable the compression
+ */
+DVZ_EXPORT void dvz_transport_compression(DvzTransport* tr, DvzSize threshold);
+
+
+
+/**
+ * Receive the next batch sent by any producer.
+ *
+ * New producers are accepted while waiting. The returned batch can be passed to
+ * `dvz_renderer_requests()` directly. Inline payloads are owned by the batch requests and freed by
+ * the renderer, payloads in a shared-memory ring are passed with `DVZ_UPLOAD_FLAGS_NOCOPY` and
+ * released to the producer when the renderer has uploaded them.
+ *
+ * @param tr the server transport
+ * @param timeout the maximum waiting time, in milliseconds, or -1 to wait indefinitely
+ * @returns a new batch to destroy with `dvz_batch_destroy()`, or NULL after the timeout
+ */
+DVZ_EXPORT DvzBatch* dvz_transport_recv(DvzTransport* tr, int timeout);
+
+
+
+/**
+ * Return the transport statistics.
+ *
+ * @param tr the transport
+ * @returns the statistics
+ */
+DVZ_EXPORT DvzTransportStats dvz_transport_stats(DvzTransport* tr);
+
+
+
+/**
+ * Close a transport.
+ *
+ * @param tr the transport
+ */
+DVZ_EXPORT void dvz_transport_destroy(DvzTransport* tr);
+
+
+
+EXTERN_C_OFF
+
+#endif
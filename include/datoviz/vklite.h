@@ -46,7 +46,7 @@ MUTE_OFF
 #define DVZ_MAX_ATTACHMENTS_PER_RENDERPASS  8
 #define DVZ_MAX_SUBPASSES_PER_RENDERPASS    8
 #define DVZ_MAX_DEPENDENCIES_PER_RENDERPASS 8
-#define DVZ_MAX_FRAMES_IN_FLIGHT            2
+#define DVZ_MAX_FRAMES_IN_FLIGHT            3
 #define DVZ_MAX_SPECIALIZATION_CONSTANTS    8
 
 
@@ -74,7 +74,9 @@ typedef struct DvzBarrierBuffer DvzBarrierBuffer;
 typedef struct DvzBarrierImage DvzBarrierImage;
 typedef struct DvzBarrier DvzBarrier;
 typedef struct DvzSemaphores DvzSemaphores;
+typedef struct DvzTimeline DvzTimeline;
 typedef struct DvzFences DvzFences;
+typedef struct DvzQueries DvzQueries;
 typedef struct DvzRenderpass DvzRenderpass;
 typedef struct DvzRenderpassAttachment DvzRenderpassAttachment;
 typedef struct DvzRenderpassSubpass DvzRenderpassSubpass;
@@ -274,6 +276,7 @@ struct DvzGpu
     VkDescriptorPool dset_pool;
 
     VkPhysicalDeviceFeatures requested_features;
+    bool support_timeline; // whether timeline semaphores are supported and enabled
     VkDevice device;
 
     VmaAllocator allocator;
@@ -588,6 +591,28 @@ struct DvzSemaphores
 
 
 
+struct DvzTimeline
+{
+    DvzObject obj;
+    DvzGpu* gpu;
+
+    VkSemaphore semaphore;
+    uint64_t value; // last value signaled by a sent submission
+};
+
+
+
+struct DvzQueries
+{
+    DvzObject obj;
+    DvzGpu* gpu;
+
+    VkQueryPool pool;
+    uint32_t count;
+};
+
+
+
 struct DvzFramebuffers
 {
     DvzObject obj;
@@ -620,6 +645,15 @@ struct DvzSubmit
     uint32_t signal_semaphores_count;
     uint32_t signal_semaphores_idx[DVZ_MAX_SEMAPHORES_PER_SUBMIT];
     DvzSemaphores* signal_semaphores[DVZ_MAX_SEMAPHORES_PER_SUBMIT];
+
+    uint32_t wait_timelines_count;
+    DvzTimeline* wait_timelines[DVZ_MAX_SEMAPHORES_PER_SUBMIT];
+    uint64_t wait_timelines_values[DVZ_MAX_SEMAPHORES_PER_SUBMIT];
+    VkPipelineStageFlags wait_timelines_stages[DVZ_MAX_SEMAPHORES_PER_SUBMIT];
+
+    uint32_t signal_timelines_count;
+    DvzTimeline* signal_timelines[DVZ_MAX_SEMAPHORES_PER_SUBMIT];
+    uint64_t signal_timelines_values[DVZ_MAX_SEMAPHORES_PER_SUBMIT];
 };
 
 
@@ -1821,6 +1855,56 @@ DVZ_EXPORT void dvz_semaphores_destroy(DvzSemaphores* semaphores);
 
 
 
+/*************************************************************************************************/
+/*  Timeline semaphores                                                                          */
+/*************************************************************************************************/
+
+/**
+ * Create a timeline semaphore (GPU-GPU and GPU-CPU synchronization with a 64-bit counter).
+ *
+ * Timeline semaphores are only available if `gpu->support_timeline` is true.
+ *
+ * @param gpu the GPU
+ * @returns the timeline semaphore
+ */
+DVZ_EXPORT DvzTimeline dvz_timeline(DvzGpu* gpu);
+
+/**
+ * Return the next value to signal.
+ *
+ * The value is only recorded as the last scheduled value once a submission signaling it has been
+ * sent with `dvz_submit_send()`, so that no wait is made on a value that will never be signaled.
+ *
+ * @param timeline the timeline semaphore
+ * @returns the next value
+ */
+DVZ_EXPORT uint64_t dvz_timeline_next(DvzTimeline* timeline);
+
+/**
+ * Return the current value of the timeline semaphore counter, as signaled by the GPU.
+ *
+ * @param timeline the timeline semaphore
+ * @returns the current counter value
+ */
+DVZ_EXPORT uint64_t dvz_timeline_value(DvzTimeline* timeline);
+
+/**
+ * Wait on the CPU until the timeline semaphore counter reaches a given value.
+ *
+ * @param timeline the timeline semaphore
+ * @param value the value to wait for
+ */
+DVZ_EXPORT void dvz_timeline_wait(DvzTimeline* timeline, uint64_t value);
+
+/**
+ * Destroy a timeline semaphore.
+ *
+ * @param timeline the timeline semaphore
+ */
+DVZ_EXPORT void dvz_timeline_destroy(DvzTimeline* timeline);
+
+
+
 /*************************************************************************************************/
 /*  Fences                                                                                       */
 /*************************************************************************************************/
@@ -1879,6 +1963,41 @@ DVZ_EXPORT void dvz_fences_destroy(DvzFences* fences);
 
 
 
+/*************************************************************************************************/
+/*  Queries                                                                                      */
+/*************************************************************************************************/
+
+/**
+ * Create a query pool (for example, GPU timestamps).
+ *
+ * @param gpu the GPU
+ * @param type the query type
+ * @param count the number of queries in the pool
+ * @returns the queries
+ */
+DVZ_EXPORT DvzQueries dvz_queries(DvzGpu* gpu, VkQueryType type, uint32_t count);
+
+/**
+ * Retrieve the results of consecutive queries, without waiting.
+ *
+ * @param queries the queries
+ * @param first the index of the first query
+ * @param count the number of queries
+ * @param values the array of 64-bit results, with `count` elements
+ * @returns whether all results were available
+ */
+DVZ_EXPORT bool
+dvz_queries_get(DvzQueries* queries, uint32_t first, uint32_t count, uint64_t* values);
+
+/**
+ * Destroy a query pool.
+ *
+ * @param queries the queries
+ */
+DVZ_EXPORT void dvz_queries_destroy(DvzQueries* queries);
+
+
+
 /*************************************************************************************************/
 /*  Renderpass                                                                                   */
 /*************************************************************************************************/
@@ -2078,6 +2197,29 @@ DVZ_EXPORT void dvz_submit_wait_semaphores(
 DVZ_EXPORT void
 dvz_submit_signal_semaphores(DvzSubmit* submit, DvzSemaphores* semaphores, uint32_t idx);
 
+/**
+ * Wait on a timeline semaphore value before executing the submitted commands.
+ *
+ * @param submit the submit object
+ * @param stage the pipeline stage
+ * @param timeline the timeline semaphore
+ * @param value the value to wait for
+ */
+DVZ_EXPORT void dvz_submit_wait_timeline(
+    DvzSubmit* submit, VkPipelineStageFlags stage, DvzTimeline* timeline, uint64_t value);
+
+/**
+ * Signal a timeline semaphore value once the submitted commands have completed.
+ *
+ * The value becomes the last scheduled value of the timeline when the submission is sent.
+ *
+ * @param submit the submit object
+ * @param timeline the timeline semaphore
+ * @param value the value to signal
+ */
+DVZ_EXPORT void
+dvz_submit_signal_timeline(DvzSubmit* submit, DvzTimeline* timeline, uint64_t value);
+
 /**
  * Submit the command buffers to their queue.
  *
@@ -2329,6 +2471,31 @@ DVZ_EXPORT void dvz_cmd_push(
     DvzCommands* cmds, uint32_t idx, DvzSlots* slots, VkShaderStageFlagBits shaders, //
     VkDeviceSize offset, VkDeviceSize size, const void* data);
 
+/**
+ * Reset queries, must be recorded before the queries are written again.
+ *
+ * @param cmds the set of command buffers to record
+ * @param idx the index of the command buffer to record
+ * @param queries the queries
+ * @param first the index of the first query to reset
+ * @param count the number of queries to reset
+ */
+DVZ_EXPORT void dvz_cmd_reset_queries(
+    DvzCommands* cmds, uint32_t idx, DvzQueries* queries, uint32_t first, uint32_t count);
+
+/**
+ * Write a GPU timestamp once all previous commands have reached a given pipeline stage.
+ *
+ * @param cmds the set of command buffers to record
+ * @param idx the index of the command buffer to record
+ * @param queries the timestamp queries
+ * @param query the index of the query to write
+ * @param stage the pipeline stage
+ */
+DVZ_EXPORT void dvz_cmd_timestamp(
+    DvzCommands* cmds, uint32_t idx, DvzQueries* queries, uint32_t query,
+    VkPipelineStageFlagBits stage);
+
 
 
 EXTERN_C_OFF
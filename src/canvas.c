@@ -24,6 +24,32 @@ static void _blank_refill(DvzCanvas* canvas, DvzCommands* cmds, uint32_t idx, vo
         &canvas->render.depth, cmds, idx, user_data);
 }
 
+DvzPresentPolicy dvz_canvas_policy(int flags)
+{
+    DvzPresentPolicy policy = {0};
+
+    policy.frames_in_flight = DVZ_FRAMES_IN_FLIGHT;
+    if ((flags & DVZ_CANVAS_FLAGS_FRAMES_1) != 0)
+        policy.frames_in_flight = 1;
+    else if ((flags & DVZ_CANVAS_FLAGS_FRAMES_3) != 0)
+        policy.frames_in_flight = 3;
+    ASSERT(policy.frames_in_flight <= DVZ_MAX_FRAMES_IN_FLIGHT);
+
+    // NOTE: the swapchain falls back to FIFO if the requested present mode is not supported.
+    if ((flags & DVZ_CANVAS_FLAGS_MAILBOX) != 0)
+        policy.present_mode = VK_PRESENT_MODE_MAILBOX_KHR;
+    else if ((flags & DVZ_CANVAS_FLAGS_VSYNC) != 0)
+        policy.present_mode = VK_PRESENT_MODE_FIFO_KHR;
+    else
+        policy.present_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+
+    policy.jit = (flags & DVZ_CANVAS_FLAGS_JIT) != 0;
+
+    return policy;
+}
+
+
+
 DvzCanvas
 dvz_canvas(DvzGpu* gpu, DvzRenderpass* renderpass, uint32_t width, uint32_t height, int flags)
 {
@@ -42,6 +68,7 @@ dvz_canvas(DvzGpu* gpu, DvzRenderpass* renderpass, uint32_t width, uint32_t heig
     canvas.obj.type = DVZ_OBJECT_TYPE_CANVAS;
     canvas.gpu = gpu;
     canvas.flags = flags;
+    canvas.policy = dvz_canvas_policy(flags);
     canvas.format = DVZ_DEFAULT_FORMAT;
     canvas.refill = _blank_refill;
 
@@ -75,11 +102,15 @@ void dvz_canvas_create(DvzCanvas* canvas, DvzSurface surface)
     ASSERT(surface.surface != VK_NULL_HANDLE);
     canvas->surface = surface;
 
-    bool vsync = (canvas->flags & DVZ_CANVAS_FLAGS_VSYNC) != 0;
+    DvzPresentPolicy* policy = &canvas->policy;
+    log_debug(
+        "canvas present policy: %d frame(s) in flight, present mode %d%s",
+        policy->frames_in_flight, policy->present_mode, policy->jit ? ", just-in-time wait" : "");
 
     // Make the swapchain.
     make_swapchain(
-        gpu, canvas->surface, &canvas->render.swapchain, DVZ_MIN_SWAPCHAIN_IMAGE_COUNT, vsync);
+        gpu, canvas->surface, &canvas->render.swapchain, DVZ_MIN_SWAPCHAIN_IMAGE_COUNT,
+        policy->present_mode);
 
     // Number of swapchain images.
     uint32_t img_count = canvas->render.swapchain.img_count;
@@ -101,7 +132,7 @@ void dvz_canvas_create(DvzCanvas* canvas, DvzSurface surface)
         canvas->render.swapchain.images, &canvas->render.depth);
 
     // Make synchronization objects.
-    make_sync(gpu, &canvas->sync, img_count);
+    make_sync(gpu, &canvas->sync, policy->frames_in_flight, img_count);
 
     // Command buffer.
     canvas->cmds = dvz_commands(canvas->gpu, DVZ_DEFAULT_QUEUE_RENDER, img_count);
@@ -111,6 +142,12 @@ void dvz_canvas_create(DvzCanvas* canvas, DvzSurface surface)
     // Default submit object.
     canvas->render.submit = dvz_submit(canvas->gpu);
 
+    // GPU timestamp queries around the render pass, if supported by the graphics queue.
+    if (gpu->device_properties.limits.timestampComputeAndGraphics)
+    {
+        canvas->timing.queries = dvz_queries(gpu, VK_QUERY_TYPE_TIMESTAMP, 2 * img_count);
+    }
+
     dvz_obj_created(&canvas->obj);
     log_trace("canvas created with size %dx%d)", width, height);
 }
@@ -204,6 +241,20 @@ void dvz_canvas_begin(DvzCanvas* canvas, DvzCommands* cmds, uint32_t idx)
     DvzGpu* gpu = canvas->gpu;
     ANN(gpu);
     dvz_cmd_begin(cmds, idx);
+
+    // Timestamp before the render pass, only in the canvas command buffers.
+    if (cmds == &canvas->cmds)
+    {
+        ASSERT(idx < DVZ_MAX_SWAPCHAIN_IMAGES);
+        DvzQueries* queries = &canvas->timing.queries;
+        canvas->timing.recorded[idx] = dvz_obj_is_created(&queries->obj);
+        if (canvas->timing.recorded[idx])
+        {
+            dvz_cmd_reset_queries(cmds, idx, queries, 2 * idx, 2);
+            dvz_cmd_timestamp(cmds, idx, queries, 2 * idx, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+        }
+    }
+
     dvz_cmd_begin_renderpass(cmds, idx, canvas->render.renderpass, &canvas->render.framebuffers);
 }
 
@@ -241,11 +292,41 @@ void dvz_canvas_end(DvzCanvas* canvas, DvzCommands* cmds, uint32_t idx)
     ANN(canvas);
     ANN(cmds);
     dvz_cmd_end_renderpass(cmds, idx);
+
+    // Timestamp after the render pass.
+    if (cmds == &canvas->cmds && canvas->timing.recorded[idx])
+    {
+        dvz_cmd_timestamp(
+            cmds, idx, &canvas->timing.queries, 2 * idx + 1,
+            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    }
+
     dvz_cmd_end(cmds, idx);
 }
 
 
 
+double dvz_canvas_gpu_time(DvzCanvas* canvas, uint32_t img_idx)
+{
+    ANN(canvas);
+    ANN(canvas->gpu);
+
+    if (img_idx >= DVZ_MAX_SWAPCHAIN_IMAGES || !canvas->timing.recorded[img_idx])
+        return -1;
+
+    uint64_t values[2] = {0};
+    if (!dvz_queries_get(&canvas->timing.queries, 2 * img_idx, 2, values))
+        return -1;
+    if (values[1] < values[0])
+        return -1;
+
+    // The timestamp period is the number of nanoseconds per timestamp increment.
+    double period = (double)canvas->gpu->device_properties.limits.timestampPeriod;
+    return (double)(values[1] - values[0]) * period * 1e-9;
+}
+
+
+
 uint8_t* dvz_canvas_download(DvzCanvas* canvas)
 {
     // NOTE: the caller should NOT free the returned pointer, the canvas will do it upon
@@ -346,6 +427,9 @@ void dvz_canvas_destroy(DvzCanvas* canvas)
     log_trace("canvas destroy fences");
     dvz_fences_destroy(&canvas->sync.fences_render_finished);
 
+    // Destroy the timestamp queries.
+    dvz_queries_destroy(&canvas->timing.queries);
+
     FREE(canvas->render.swapchain.images);
 
     dvz_obj_destroyed(&canvas->obj);
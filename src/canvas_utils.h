@@ -21,13 +21,13 @@
 /*  Utils                                                                                        */
 /*************************************************************************************************/
 
-static void make_sync(DvzGpu* gpu, DvzSync* sync, uint32_t img_count)
+static void make_sync(DvzGpu* gpu, DvzSync* sync, uint32_t frames_in_flight, uint32_t img_count)
 {
     ANN(gpu);
     ANN(sync);
     log_trace("making sync objects");
 
-    uint32_t frames_in_flight = DVZ_MAX_FRAMES_IN_FLIGHT;
+    ASSERT(0 < frames_in_flight && frames_in_flight <= DVZ_MAX_FRAMES_IN_FLIGHT);
 
     sync->sem_img_available = dvz_semaphores(gpu, frames_in_flight);
     sync->sem_render_finished = dvz_semaphores(gpu, frames_in_flight);
@@ -34,6 +34,170 @@
 
 
 
+static bool _coalesce(DvzClientEvent* queued, DvzClientEvent* ev)
+{
+    ANN(queued);
+    ANN(ev);
+
+    // Only consecutive events of the same kind, for the same window, are coalesced.
+    if (queued->type != ev->type || queued->window_id != ev->window_id)
+        return false;
+
+    switch (ev->type)
+    {
+    case DVZ_CLIENT_EVENT_WINDOW_RESIZE:
+    case DVZ_CLIENT_EVENT_FRAME:
+        return true;
+    case DVZ_CLIENT_EVENT_MOUSE:
+        return ev->content.m.type == DVZ_MOUSE_EVENT_MOVE &&
+               queued->content.m.type == DVZ_MOUSE_EVENT_MOVE;
+    default:
+        return false;
+    }
+}
+
+
+
+static void _async_enqueue(DvzClientPayload* payload, DvzClientEvent* ev)
+{
+    ANN(payload);
+    ANN(ev);
+
+    DvzClient* client = payload->client;
+    ANN(client);
+    ANN(client->jobs);
+
+    dvz_mutex_lock(&client->async_lock);
+
+    // Latest wins: replace the last queued event if it is of the same kind.
+    if (payload->queue_count > 0 &&
+        _coalesce(&payload->queue[payload->queue_first + payload->queue_count - 1], ev))
+    {
+        payload->queue[payload->queue_first + payload->queue_count - 1] = *ev;
+        client->async_coalesced++;
+        dvz_mutex_unlock(&client->async_lock);
+        return;
+    }
+
+    // Make room at the end of the queue.
+    if (payload->queue_first + payload->queue_count >= payload->queue_capacity)
+    {
+        if (payload->queue_first > 0)
+        {
+            memmove(
+                payload->queue, &payload->queue[payload->queue_first],
+                payload->queue_count * sizeof(DvzClientEvent));
+        }
+        else
+        {
+            payload->queue_capacity = MAX(2 * payload->queue_capacity, 4);
+            REALLOC(payload->queue, payload->queue_capacity * sizeof(DvzClientEvent));
+        }
+        payload->queue_first = 0;
+    }
+    payload->queue[payload->queue_first + payload->queue_count++] = *ev;
+    client->async_pending++;
+
+    // Schedule the payload on the workers if it is not already.
+    bool schedule = !payload->scheduled;
+    payload->scheduled = true;
+    dvz_mutex_unlock(&client->async_lock);
+
+    if (schedule)
+        dvz_fifo_enqueue(client->jobs, payload);
+}
+
+
+
+static void* _async_worker(void* user_data)
+{
+    DvzClient* client = (DvzClient*)user_data;
+    ANN(client);
+
+    DvzClientPayload* payload = NULL;
+    DvzClientEvent ev = {0};
+    while (true)
+    {
+        // NULL is the stop signal.
+        payload = (DvzClientPayload*)dvz_fifo_dequeue(client->jobs, true);
+        if (payload == NULL)
+            break;
+
+        // Process the queued events of the payload, until its queue is empty.
+        while (true)
+        {
+            dvz_mutex_lock(&client->async_lock);
+            if (payload->queue_count == 0)
+            {
+                payload->queue_first = 0;
+                payload->scheduled = false;
+                dvz_mutex_unlock(&client->async_lock);
+                break;
+            }
+            ev = payload->queue[payload->queue_first++];
+            payload->queue_count--;
+            dvz_mutex_unlock(&client->async_lock);
+
+            ev.user_data = payload->user_data;
+            payload->callback(client, ev);
+
+            dvz_mutex_lock(&client->async_lock);
+            ASSERT(client->async_pending > 0);
+            client->async_pending--;
+            if (client->async_pending == 0)
+                dvz_cond_signal(&client->async_cond);
+            dvz_mutex_unlock(&client->async_lock);
+        }
+    }
+    return NULL;
+}
+
+
+
+static void _async_start(DvzClient* client)
+{
+    ANN(client);
+    if (client->worker_count > 0)
+        return;
+
+    client->jobs = dvz_fifo(DVZ_CLIENT_MAX_CALLBACKS + DVZ_CLIENT_MAX_WORKERS + 1);
+    dvz_mutex_init(&client->async_lock);
+    dvz_cond_init(&client->async_cond);
+
+    client->worker_count = MIN(DVZ_CLIENT_WORKER_COUNT, DVZ_CLIENT_MAX_WORKERS);
+    log_trace("start %d worker threads for the asynchronous callbacks", client->worker_count);
+    for (uint32_t i = 0; i < client->worker_count; i++)
+        client->workers[i] = dvz_thread(_async_worker, client);
+}
+
+
+
+static void _async_stop(DvzClient* client)
+{
+    ANN(client);
+    if (client->worker_count == 0)
+        return;
+
+    // The stop signals are enqueued after the scheduled payloads, so that the pending events are
+    // processed before the workers exit.
+    log_trace("stop the worker threads for the asynchronous callbacks");
+    for (uint32_t i = 0; i < client->worker_count; i++)
+        dvz_fifo_enqueue(client->jobs, NULL);
+    for (uint32_t i = 0; i < client->worker_count; i++)
+        dvz_thread_join(client->workers[i]);
+    client->worker_count = 0;
+
+    for (uint32_t i = 0; i < client->callback_count; i++)
+        FREE(client->callbacks[i].queue);
+
+    dvz_fifo_destroy(client->jobs);
+    client->jobs = NULL;
+    dvz_mutex_destroy(&client->async_lock);
+    dvz_cond_destroy(&client->async_cond);
+}
+
+
+
 static void _deq_callback(DvzDeq* deq, void* item, void* user_data)
 {
     ANN(deq);
@@ -54,7 +218,7 @@ static void _deq_callback(DvzDeq* deq, void* item, void* user_data)
     }
     else if (payload->mode == DVZ_CLIENT_CALLBACK_ASYNC)
     {
-        // TODO: enqueue callback to async queue
+        _async_enqueue(payload, ev);
     }
 
     return;
@@ -111,9 +275,6 @@ DvzClient* dvz_client(DvzBackend backend)
     //     client->deq, 0, (int)DVZ_CLIENT_EVENT_WINDOW_REQUEST_DELETE,
     //     _callback_window_request_delete, client);
 
-    // TODO: create async queue
-    // start background thread
-
     return client;
 }
 
@@ -133,13 +294,16 @@ void dvz_client_callback(
 {
     ANN(client);
 
-    // TODO: async callbacks
-    if (mode == DVZ_CLIENT_CALLBACK_ASYNC)
+    if (client->callback_count >= DVZ_CLIENT_MAX_CALLBACKS)
     {
-        log_error("async callbacks are not yet implemented, falling back to sync callbacks");
-        mode = DVZ_CLIENT_CALLBACK_SYNC;
+        log_error("maximum number of client callbacks reached (%d)", DVZ_CLIENT_MAX_CALLBACKS);
+        return;
     }
 
+    // The worker threads are started with the first asynchronous callback.
+    if (mode == DVZ_CLIENT_CALLBACK_ASYNC)
+        _async_start(client);
+
     DvzClientPayload* payload = &client->callbacks[client->callback_count++];
     payload->client = client;
     payload->callback = callback;
@@ -150,6 +314,20 @@ void dvz_client_callback(
 
 
 
+void dvz_client_wait(DvzClient* client)
+{
+    ANN(client);
+    if (client->worker_count == 0)
+        return;
+
+    dvz_mutex_lock(&client->async_lock);
+    while (client->async_pending > 0)
+        dvz_cond_wait(&client->async_cond, &client->async_lock);
+    dvz_mutex_unlock(&client->async_lock);
+}
+
+
+
 void dvz_client_process(DvzClient* client)
 {
     ANN(client);
@@ -322,6 +500,10 @@ void dvz_client_destroy(DvzClient* client)
     ANN(client);
     log_trace("destroy the client");
 
+    // Stop the worker threads first, so that the requests submitted by the pending asynchronous
+    // callbacks are processed below.
+    _async_stop(client);
+
     // Delete all remaining windows.
     DvzContainerIterator iter = dvz_container_iterator(&client->windows);
     DvzWindow* window = NULL;
@@ -362,8 +544,6 @@ void dvz_client_destroy(DvzClient* client)
 
     dvz_map_destroy(client->map);
 
-    // TODO: stop background thread for async callbacks
-
     // NOTE: the host is responsible for terminating the backend.
     // backend_terminate(client->backend);
 
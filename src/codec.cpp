@@ -0,0 +1,373 @@
+/*************************************************************************************************/
+/*  Codec: compression of upload payloads                                                        */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "codec.h"
+
+
+
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+// LZ4 block format: https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+#define LZ4_MIN_MATCH     4
+#define LZ4_LAST_LITERALS 5  // the last bytes are always literals
+#define LZ4_MF_LIMIT      12 // the last match starts at least this far from the end
+#define LZ4_MAX_OFFSET    65535
+#define LZ4_HASH_LOG      16
+
+
+
+/*************************************************************************************************/
+/*  Filters                                                                                      */
+/*************************************************************************************************/
+
+static void _filter(const uint8_t* src, DvzSize size, uint32_t item_size, int filter, uint8_t* dst)
+{
+    ANN(src);
+    ANN(dst);
+
+    DvzSize n = item_size > 1 ? size / item_size : 0;
+    if ((filter & DVZ_CODEC_FILTER_SHUFFLE) != 0 && n > 0)
+    {
+        for (uint32_t j = 0; j < item_size; j++)
+            for (DvzSize i = 0; i < n; i++)
+                dst[j * n + i] = src[i * item_size + j];
+        memcpy(&dst[n * item_size], &src[n * item_size], size - n * item_size);
+    }
+    else
+    {
+        memcpy(dst, src, size);
+    }
+
+    if ((filter & DVZ_CODEC_FILTER_DELTA) != 0)
+        for (DvzSize i = size - 1; i > 0; i--)
+            dst[i] = (uint8_t)(dst[i] - dst[i - 1]);
+}
+
+
+
+static void _unfilter(uint8_t* src, DvzSize size, uint32_t item_size, int filter, uint8_t* dst)
+{
+    ANN(src);
+    ANN(dst);
+
+    if ((filter & DVZ_CODEC_FILTER_DELTA) != 0)
+        for (DvzSize i = 1; i < size; i++)
+            src[i] = (uint8_t)(src[i] + src[i - 1]);
+
+    DvzSize n = item_size > 1 ? size / item_size : 0;
+    if ((filter & DVZ_CODEC_FILTER_SHUFFLE) != 0 && n > 0)
+    {
+        for (uint32_t j = 0; j < item_size; j++)
+            for (DvzSize i = 0; i < n; i++)
+                dst[i * item_size + j] = src[j * n + i];
+        memcpy(&dst[n * item_size], &src[n * item_size], size - n * item_size);
+    }
+    else if (dst != src)
+    {
+        memcpy(dst, src, size);
+    }
+}
+
+
+
+/*************************************************************************************************/
+/*  LZ4                                                                                          */
+/*************************************************************************************************/
+
+static inline uint32_t _read32(const uint8_t* p)
+{
+    uint32_t x = 0;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+
+
+static inline uint32_t _hash(uint32_t x) { return (x * 2654435761u) >> (32 - LZ4_HASH_LOG); }
+
+
+
+static inline uint8_t* _write_length(uint8_t* op, DvzSize length)
+{
+    for (; length >= 255; length -= 255)
+        *op++ = 255;
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+
+
+static uint8_t* _write_sequence(
+    uint8_t* op, const uint8_t* literals, DvzSize literal_count, uint32_t offset,
+    DvzSize match_length)
+{
+    uint8_t* token = op++;
+    *token = (uint8_t)(MIN(literal_count, 15) << 4);
+    if (literal_count >= 15)
+        op = _write_length(op, literal_count - 15);
+    memcpy(op, literals, literal_count);
+    op += literal_count;
+
+    // The last sequence only has literals.
+    if (match_length == 0)
+        return op;
+
+    *op++ = (uint8_t)(offset & 0xFF);
+    *op++ = (uint8_t)(offset >> 8);
+    match_length -= LZ4_MIN_MATCH;
+    *token |= (uint8_t)MIN(match_length, 15);
+    if (match_length >= 15)
+        op = _write_length(op, match_length - 15);
+    return op;
+}
+
+
+
+static DvzSize _lz4_compress(const uint8_t* src, DvzSize size, uint8_t* dst)
+{
+    ANN(src);
+    ANN(dst);
+
+    uint8_t* op = dst;
+    DvzSize anchor = 0;
+    if (size > LZ4_MF_LIMIT)
+    {
+        // Positions + 1 of the last occurrence of each hashed 4-byte sequence.
+        std::vector<uint32_t> table(1 << LZ4_HASH_LOG, 0);
+        const DvzSize limit = size - LZ4_MF_LIMIT;
+        const DvzSize match_limit = size - LZ4_LAST_LITERALS;
+        DvzSize ip = 0;
+        while (ip < limit)
+        {
+            uint32_t seq = _read32(&src[ip]);
+            uint32_t h = _hash(seq);
+            DvzSize ref = table[h];
+            table[h] = (uint32_t)(ip + 1);
+            if (ref == 0 || ip - (ref - 1) > LZ4_MAX_OFFSET || _read32(&src[ref - 1]) != seq)
+            {
+                // Skip faster through incompressible data.
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+            ref--;
+
+            DvzSize length = LZ4_MIN_MATCH;
+            while (ip + length < match_limit && src[ref + length] == src[ip + length])
+                length++;
+
+            op = _write_sequence(op, &src[anchor], ip - anchor, (uint32_t)(ip - ref), length);
+            ip += length;
+            anchor = ip;
+        }
+    }
+    op = _write_sequence(op, &src[anchor], size - anchor, 0, 0);
+    return (DvzSize)(op - dst);
+}
+
+
+
+static int _lz4_decompress(const uint8_t* src, DvzSize size, uint8_t* dst, DvzSize dst_size)
+{
+    ANN(src);
+    ANN(dst);
+
+    DvzSize ip = 0, op = 0;
+    while (ip < size)
+    {
+        uint8_t token = src[ip++];
+
+        DvzSize length = token >> 4;
+        if (length == 15)
+        {
+            uint8_t b = 255;
+            while (b == 255 && ip < size)
+                length += (b = src[ip++]);
+        }
+        if (length > size - ip || length > dst_size - op)
+            return 1;
+        memcpy(&dst[op], &src[ip], length);
+        ip += length;
+        op += length;
+
+        // The last sequence only has literals.
+        if (ip == size)
+            break;
+
+        if (ip + 2 > size)
+            return 1;
+        DvzSize offset = (DvzSize)src[ip] | ((DvzSize)src[ip + 1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op)
+            return 1;
+
+        length = token & 15;
+        if (length == 15)
+        {
+            uint8_t b = 255;
+            while (b == 255 && ip < size)
+                length += (b = src[ip++]);
+        }
+        length += LZ4_MIN_MATCH;
+        if (length > dst_size - op)
+            return 1;
+
+        // NOTE: the match may overlap with the bytes it produces.
+        if (offset >= length)
+        {
+            memcpy(&dst[op], &dst[op - offset], length);
+        }
+        else
+        {
+            for (DvzSize i = 0; i < length; i++)
+                dst[op + i] = dst[op - offset + i];
+        }
+        op += length;
+    }
+    return op == dst_size ? 0 : 1;
+}
+
+
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+DvzSize dvz_codec_bound(DvzSize size)
+{
+    return sizeof(DvzCodecHeader) + size + size / 255 + 16;
+}
+
+
+
+DvzSize
+dvz_codec_compress(const void* src, DvzSize size, uint32_t item_size, int filter, void* dst)
+{
+    ANN(src);
+    ANN(dst);
+    if (size == 0)
+        return 0;
+
+    item_size = MAX(item_size, 1u);
+    ASSERT(item_size <= UINT16_MAX);
+
+    const uint8_t* input = (const uint8_t*)src;
+    std::vector<uint8_t> filtered;
+    if (filter != DVZ_CODEC_FILTER_NONE)
+    {
+        filtered.resize(size);
+        _filter(input, size, item_size, filter, filtered.data());
+        input = filtered.data();
+    }
+
+    uint8_t* out = (uint8_t*)dst;
+    DvzSize compressed_size = _lz4_compress(input, size, out + sizeof(DvzCodecHeader));
+    if (sizeof(DvzCodecHeader) + compressed_size >= size)
+        return 0;
+
+    DvzCodecHeader header = {};
+    header.magic = DVZ_CODEC_MAGIC;
+    header.codec = DVZ_CODEC_LZ4;
+    header.filter = (uint8_t)filter;
+    header.item_size = (uint16_t)item_size;
+    header.size = size;
+    header.compressed_size = compressed_size;
+    memcpy(out, &header, sizeof(header));
+    return sizeof(DvzCodecHeader) + compressed_size;
+}
+
+
+
+void dvz_codec_jobs(uint32_t count, DvzCodecJob* jobs, uint32_t thread_count)
+{
+    if (count == 0)
+        return;
+    ANN(jobs);
+
+    if (thread_count == 0)
+        thread_count = std::thread::hardware_concurrency();
+    thread_count = CLIP(thread_count, 1u, count);
+
+    // The workers pick the next job until there is none left.
+    std::atomic<uint32_t> next(0);
+    auto worker = [&]() {
+        for (uint32_t i = next++; i < count; i = next++)
+        {
+            DvzCodecJob* job = &jobs[i];
+            job->dst = malloc(dvz_codec_bound(job->size));
+            ANN(job->dst);
+            job->dst_size = dvz_codec_compress(
+                job->src, job->size, job->item_size, job->filter, job->dst);
+            if (job->dst_size == 0)
+                FREE(job->dst);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 1; t < thread_count; t++)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+
+
+DvzSize dvz_codec_size(const void* buf, DvzSize size)
+{
+    ANN(buf);
+    if (size < sizeof(DvzCodecHeader))
+        return 0;
+
+    DvzCodecHeader header = {};
+    memcpy(&header, buf, sizeof(header));
+    if (header.magic != DVZ_CODEC_MAGIC || header.codec != DVZ_CODEC_LZ4 ||
+        header.compressed_size != size - sizeof(DvzCodecHeader))
+        return 0;
+    return header.size;
+}
+
+
+
+int dvz_codec_decompress(const void* src, DvzSize size, void* dst, DvzSize dst_size)
+{
+    ANN(src);
+    ANN(dst);
+
+    if (dvz_codec_size(src, size) != dst_size || dst_size == 0)
+    {
+        log_error("invalid compressed payload");
+        return 1;
+    }
+    DvzCodecHeader header = {};
+    memcpy(&header, src, sizeof(header));
+    const uint8_t* input = (const uint8_t*)src + sizeof(DvzCodecHeader);
+
+    int res = 0;
+    if (header.filter == DVZ_CODEC_FILTER_NONE)
+    {
+        res = _lz4_decompress(input, header.compressed_size, (uint8_t*)dst, dst_size);
+    }
+    else
+    {
+        std::vector<uint8_t> filtered(dst_size);
+        res = _lz4_decompress(input, header.compressed_size, filtered.data(), dst_size);
+        if (res == 0)
+            _unfilter(filtered.data(), dst_size, header.item_size, header.filter, (uint8_t*)dst);
+    }
+    if (res != 0)
+        log_error("corrupted compressed payload");
+    return res;
+}
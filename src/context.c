@@ -19,19 +19,34 @@
 /*  Utils                                                                                        */
 /*************************************************************************************************/
 
+static void _destroy_staging(void* user_data)
+{
+    DvzDat* dat = (DvzDat*)user_data;
+    ANN(dat);
+
+    // Only for staging buffers.
+    ANN(dat->br.buffer);
+    ASSERT(dat->br.buffer->type == DVZ_BUFFER_TYPE_STAGING);
+    log_info("deallocate temporary staging dat with size %s", pretty_size(dat->br.size));
+    dvz_dat_destroy(dat);
+}
+
+
+
 static void _buffer_upload_done(DvzDeq* deq, void* item, void* user_data)
 {
+    DvzTransfers* transfers = (DvzTransfers*)user_data;
+    ANN(transfers);
+
     DvzTransferUploadDone* up = (DvzTransferUploadDone*)item;
     ANN(up);
     DvzDat* dat = (DvzDat*)up->user_data;
     if (dat == NULL)
         return;
 
-    // Only for staging buffers.
-    ANN(dat->br.buffer);
-    ASSERT(dat->br.buffer->type == DVZ_BUFFER_TYPE_STAGING);
-    log_info("deallocate temporary staging dat with size %s", pretty_size(dat->br.size));
-    dvz_dat_destroy(dat);
+    // The copy from the staging dat may be part of a transfer batch still in flight, in which
+    // case the deallocation is deferred until the batch has completed.
+    dvz_transfers_release(transfers, _destroy_staging, dat);
 }
 
 
@@ -57,7 +72,7 @@ DvzContext* dvz_context(DvzGpu* gpu)
     // deallocated.
     dvz_deq_callback(
         ctx->transfers.deq, DVZ_TRANSFER_DEQ_EV, //
-        DVZ_TRANSFER_UPLOAD_DONE, _buffer_upload_done, NULL);
+        DVZ_TRANSFER_UPLOAD_DONE, _buffer_upload_done, &ctx->transfers);
 
 
     // Create the resources.
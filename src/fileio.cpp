@@ -6,6 +6,15 @@
 #include "common.h"
 #include "fpng.h"
 
+#if OS_WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 
 /*************************************************************************************************/
@@ -120,6 +129,76 @@ int dvz_write_bytes(const char* filename, const char* mode, DvzSize size, const
 
 
 
+void* dvz_map_file(const char* filename, DvzSize* size)
+{
+    ANN(filename);
+    void* data = NULL;
+    DvzSize length = 0;
+
+#if OS_WIN32
+    HANDLE file = CreateFileA(
+        filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        log_error("could not open %s", filename);
+        return NULL;
+    }
+    LARGE_INTEGER file_size = {0};
+    GetFileSizeEx(file, &file_size);
+    length = (DvzSize)file_size.QuadPart;
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping != NULL)
+    {
+        data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        // NOTE: the view keeps a reference to the mapping.
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        log_error("could not open %s", filename);
+        return NULL;
+    }
+    struct stat st = {};
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        length = (DvzSize)st.st_size;
+        data = mmap(NULL, (size_t)length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+            data = NULL;
+    }
+    // NOTE: the mapping remains valid after the file descriptor is closed.
+    close(fd);
+#endif
+
+    if (data == NULL)
+    {
+        log_error("could not map %s in memory", filename);
+        return NULL;
+    }
+    if (size != NULL)
+        *size = length;
+    log_debug("mapped %s (%s)", filename, pretty_size(length));
+    return data;
+}
+
+
+
+void dvz_unmap_file(void* data, DvzSize size)
+{
+    if (data == NULL)
+        return;
+#if OS_WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(data, (size_t)size);
+#endif
+}
+
+
+
 /*************************************************************************************************/
 /*  Image file I/O utils                                                                         */
 /*************************************************************************************************/
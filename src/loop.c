@@ -206,7 +206,7 @@ int dvz_loop_frame(DvzLoop* loop)
         dvz_swapchain_present(
             swapchain, DVZ_DEFAULT_QUEUE_PRESENT, sem_render_finished, canvas->cur_frame);
 
-        canvas->cur_frame = (canvas->cur_frame + 1) % DVZ_MAX_FRAMES_IN_FLIGHT;
+        canvas->cur_frame = (canvas->cur_frame + 1) % canvas->policy.frames_in_flight;
     }
 
     // IMPORTANT: we need to wait for the present queue to be idle, otherwise the GPU hangs
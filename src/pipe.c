@@ -124,6 +124,13 @@ void dvz_pipe_index(DvzPipe* pipe, DvzDat* dat_index, DvzSize offset)
 
 
 void dvz_pipe_dat(DvzPipe* pipe, uint32_t idx, DvzDat* dat)
+{
+    dvz_pipe_dat_offset(pipe, idx, dat, 0);
+}
+
+
+
+void dvz_pipe_dat_offset(DvzPipe* pipe, uint32_t idx, DvzDat* dat, DvzSize offset)
 {
     ANN(pipe);
     ASSERT(idx < DVZ_MAX_BINDINGS);
@@ -131,6 +138,7 @@ void dvz_pipe_dat(DvzPipe* pipe, uint32_t idx, DvzDat* dat)
     ANN(dat);
     ANN(dat->br.buffer);
     ASSERT(dat->br.size > 0);
+    ASSERT(offset < dat->br.size);
 
     pipe->descriptors_set[idx] = true;
     // pipe->dats[idx] = dat;
@@ -138,7 +146,13 @@ void dvz_pipe_dat(DvzPipe* pipe, uint32_t idx, DvzDat* dat)
     // Create the descriptors if needed.
     _ensure_descriptors_created(pipe, dat->br.count);
 
-    dvz_descriptors_buffer(&pipe->descriptors, idx, dat->br);
+    // Bind the dat from the offset to its end (suballocated uniforms).
+    DvzBufferRegions br = dat->br;
+    for (uint32_t i = 0; i < br.count; i++)
+        br.offsets[i] += offset;
+    br.size -= offset;
+
+    dvz_descriptors_buffer(&pipe->descriptors, idx, br);
 }
 
 
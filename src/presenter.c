@@ -14,6 +14,7 @@
 #include "input.h"
 #include "request.h"
 #include "surface.h"
+#include "timing.h"
 #include "vklite.h"
 #include "vklite_utils.h"
 #include "widgets.h"
@@ -250,6 +251,11 @@ static void _record_command(DvzRenderer* rd, DvzCanvas* canvas, uint32_t img_idx
     ANN(rd);
     ANN(canvas);
     ANN(canvas->recorder);
+
+    // The GPU timestamps are only written if the recorder goes through dvz_canvas_begin().
+    ASSERT(img_idx < DVZ_MAX_SWAPCHAIN_IMAGES);
+    canvas->timing.recorded[img_idx] = false;
+
     if (canvas->recorder->count > 0)
     {
         dvz_cmd_reset(&canvas->cmds, img_idx);
@@ -321,6 +327,10 @@ static void _requester_callback(DvzClient* client, DvzClientEvent ev)
 
     // bool has_record_request = false;
 
+    // NOTE: the requests are processed between two frames, the measure is attributed to the next
+    // frame record.
+    dvz_timing_begin(&prt->timing, DVZ_TIMING_REQUESTS);
+
     // Go through all pending requests.
     for (uint32_t i = 0; i < count; i++)
     {
@@ -347,6 +357,8 @@ static void _requester_callback(DvzClient* client, DvzClientEvent ev)
     // if (has_record_request)
     //     prt->awaiting_submit = false;
 
+    dvz_timing_end(&prt->timing, DVZ_TIMING_REQUESTS);
+
     // Finally, we destroy the batch.
     dvz_batch_destroy(batch);
 }
@@ -445,6 +457,12 @@ DvzPresenter* dvz_presenter(DvzRenderer* rd, DvzClient* client, int flags)
 
     prt->fps = dvz_fps();
 
+    // Frame timing ring buffer.
+    prt->timing = dvz_timing(DVZ_TIMING_CAPACITY);
+
+    // The transfer batches are synchronized with the canvas submissions with semaphores.
+    dvz_transfers_async(&rd->ctx->transfers, true);
+
     return prt;
 }
 
@@ -517,8 +535,28 @@ void dvz_presenter_frame(DvzPresenter* prt, DvzId window_id)
     ANN(cmds);
     ANN(submit);
 
+    DvzTiming* timing = &prt->timing;
+    uint32_t cur_frame = canvas->cur_frame;
+    uint64_t seq = dvz_timing_frame(timing, frame_idx, window_id);
+    DvzPresentPolicy* policy = &canvas->policy;
+    dvz_timing_policy(
+        timing, policy->frames_in_flight, (uint32_t)policy->present_mode, policy->jit);
+
     // Wait for fence.
-    dvz_fences_wait(fences, canvas->cur_frame);
+    dvz_timing_begin(timing, DVZ_TIMING_FENCE);
+    dvz_fences_wait(fences, cur_frame);
+    dvz_timing_end(timing, DVZ_TIMING_FENCE);
+
+    // The previous submission in this frame slot has completed: its GPU timestamps are available.
+    // NOTE: if the same swapchain image was submitted again in the meantime by another frame in
+    // flight, the queries may not be available yet and the GPU time of that frame is skipped.
+    if (canvas->timing.submitted[cur_frame])
+    {
+        dvz_timing_gpu(
+            timing, canvas->timing.seq[cur_frame],
+            dvz_canvas_gpu_time(canvas, canvas->timing.img[cur_frame]));
+        canvas->timing.submitted[cur_frame] = false;
+    }
 
     // We acquire the next swapchain image.
 
@@ -527,7 +565,9 @@ void dvz_presenter_frame(DvzPresenter* prt, DvzId window_id)
     // is forbidden according to the Vulkan spec.
     // if (!prt->awaiting_submit)
     // {
+    dvz_timing_begin(timing, DVZ_TIMING_ACQUIRE);
     dvz_swapchain_acquire(swapchain, sem_img_available, canvas->cur_frame, NULL, 0);
+    dvz_timing_end(timing, DVZ_TIMING_ACQUIRE);
     //     prt->awaiting_submit = true;
     // }
     // else
@@ -540,10 +580,19 @@ void dvz_presenter_frame(DvzPresenter* prt, DvzId window_id)
     if (swapchain->obj.status == DVZ_OBJECT_STATUS_INVALID)
     {
         dvz_gpu_wait(gpu);
+        dvz_timing_frame_end(timing);
         return;
     }
+
+    // Transfers: the pending copies are recorded and submitted in a single batch, synchronized
+    // with the render submission below with semaphores. This happens before the render so that
+    // the data uploaded (without waiting) by the requests of this frame is used right away.
+    dvz_timing_begin(timing, DVZ_TIMING_TRANSFERS);
+    dvz_transfers_frame(&ctx->transfers, swapchain->img_idx);
+    dvz_timing_end(timing, DVZ_TIMING_TRANSFERS);
+
     // Handle resizing.
-    else if (swapchain->obj.status == DVZ_OBJECT_STATUS_NEED_RECREATE)
+    if (swapchain->obj.status == DVZ_OBJECT_STATUS_NEED_RECREATE)
     {
         log_trace("recreating the swapchain");
 
@@ -587,10 +636,12 @@ void dvz_presenter_frame(DvzPresenter* prt, DvzId window_id)
         // Need to refill the command buffers.
         // Ensure we reset the refill flag to force reloading.
         dvz_recorder_set_dirty(recorder);
+        dvz_timing_begin(timing, DVZ_TIMING_RECORD);
         for (uint32_t i = 0; i < cmds->count; i++)
         {
             _record_command(rd, canvas, i);
         }
+        dvz_timing_end(timing, DVZ_TIMING_RECORD);
         // prt->awaiting_submit = false;
     }
 
@@ -603,10 +654,14 @@ void dvz_presenter_frame(DvzPresenter* prt, DvzId window_id)
         // previously (caching system built into the recorder).
         if (dvz_recorder_is_dirty(recorder, swapchain->img_idx))
         {
+            dvz_timing_begin(timing, DVZ_TIMING_RECORD);
             _record_command(rd, canvas, swapchain->img_idx);
+            dvz_timing_end(timing, DVZ_TIMING_RECORD);
         }
 
         // Reset the Submit instance before adding the command buffers.
+        // NOTE: the submit stage includes the GUI command buffer recording.
+        dvz_timing_begin(timing, DVZ_TIMING_SUBMIT);
         dvz_submit_reset(submit);
 
         // First, we submit the cmds on that image
@@ -624,15 +679,28 @@ void dvz_presenter_frame(DvzPresenter* prt, DvzId window_id)
             canvas->cur_frame);
         // Once the render is finished, we signal another semaphore.
         dvz_submit_signal_semaphores(submit, sem_render_finished, canvas->cur_frame);
+
+        // Transfer batch synchronization: the render waits for the copies submitted in the last
+        // transfer batch, and the next batch waits for the render to finish, so that no CPU wait
+        // is needed between the copies and the rendering.
+        dvz_transfers_sync_render(&ctx->transfers, submit);
         dvz_submit_send(submit, swapchain->img_idx, fences, canvas->cur_frame);
+        dvz_timing_end(timing, DVZ_TIMING_SUBMIT);
+
+        // Keep track of the frame record to retrieve its GPU time once the fence is signaled.
+        canvas->timing.submitted[cur_frame] = true;
+        canvas->timing.seq[cur_frame] = seq;
+        canvas->timing.img[cur_frame] = swapchain->img_idx;
 
         // Once the image is rendered, we present the swapchain image.
+        dvz_timing_begin(timing, DVZ_TIMING_PRESENT);
         dvz_swapchain_present(swapchain, 1, sem_render_finished, canvas->cur_frame);
+        dvz_timing_end(timing, DVZ_TIMING_PRESENT);
 
         // Mark the fact that the submission has been done.
         // prt->awaiting_submit = false;
 
-        canvas->cur_frame = (canvas->cur_frame + 1) % DVZ_MAX_FRAMES_IN_FLIGHT;
+        canvas->cur_frame = (canvas->cur_frame + 1) % policy->frames_in_flight;
     }
 
     // IMPORTANT: we need to wait for the present queue to be idle, otherwise the GPU hangs
@@ -640,11 +708,29 @@ void dvz_presenter_frame(DvzPresenter* prt, DvzId window_id)
     // queues for command buffer submission and swapchain present.
     // dvz_queue_wait(gpu, DVZ_DEFAULT_QUEUE_PRESENT);
 
-    // Transfers.
-    dvz_transfers_frame(&ctx->transfers, swapchain->img_idx);
-
     // UPFILL: when there is a command refill + data uploads in the same batch, register
     // the cmd buf at the moment when the GPU-blocking upload really occurs
+
+    dvz_timing_frame_end(timing);
+
+    // Just-in-time wait: we wait for the next frame slot now, so that the input events and
+    // requests processed by the client before the next FRAME event are as recent as possible
+    // when the frame is recorded. The fence wait at the beginning of the next frame then returns
+    // immediately. This wait is attributed to the next frame record.
+    if (policy->jit)
+    {
+        dvz_timing_begin(timing, DVZ_TIMING_JIT);
+        dvz_fences_wait(fences, canvas->cur_frame);
+        dvz_timing_end(timing, DVZ_TIMING_JIT);
+    }
+}
+
+
+
+DvzTiming* dvz_presenter_timing(DvzPresenter* prt)
+{
+    ANN(prt);
+    return &prt->timing;
 }
 
 
@@ -729,6 +815,8 @@ void dvz_presenter_destroy(DvzPresenter* prt)
 
     dvz_fps_destroy(&prt->fps);
 
+    dvz_timing_destroy(&prt->timing);
+
     FREE(prt);
     log_trace("presenter destroyed");
 }
@@ -181,6 +181,31 @@ _process_command(DvzRecorderCommand* record, DvzRenderer* rd, DvzCommands* cmds,
         break;
     }
 
+    case DVZ_RECORDER_PUSH:
+    {
+        uint32_t offset = record->contents.push.offset;
+        uint32_t size = record->contents.push.size;
+        ASSERT(size <= DVZ_RECORDER_PUSH_SIZE);
+
+        log_debug(
+            "recorder: push constants at offset %d with size %d (#%d)", offset, size, img_idx);
+
+        pipe = dvz_renderer_pipe(rd, record->contents.push.pipe_id);
+        ANN(pipe);
+        if (pipe->type != DVZ_PIPE_GRAPHICS)
+        {
+            log_error("push constants are only supported for graphics pipes");
+            break;
+        }
+
+        // NOTE: we assume DvzShaderType and VkShaderStageFlagBits match.
+        dvz_cmd_push(
+            cmds, img_idx, &pipe->u.graphics.slots,
+            (VkShaderStageFlagBits)record->contents.push.shader_stages, offset, size,
+            record->contents.push.data);
+        break;
+    }
+
     case DVZ_RECORDER_END:
     {
         log_debug("recorder: end (#%d)", img_idx);
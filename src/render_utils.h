@@ -164,15 +164,15 @@ static DvzRenderpass desktop_renderpass(DvzGpu* gpu)
 
 
 static void make_swapchain(
-    DvzGpu* gpu, DvzSurface surface, DvzSwapchain* swapchain, uint32_t min_img_count, bool vsync)
+    DvzGpu* gpu, DvzSurface surface, DvzSwapchain* swapchain, uint32_t min_img_count,
+    VkPresentModeKHR present_mode)
 {
     ANN(swapchain);
     log_trace("making swapchain");
 
     *swapchain = dvz_swapchain(gpu, surface.surface, min_img_count);
     dvz_swapchain_format(swapchain, (VkFormat)DVZ_DEFAULT_FORMAT);
-    dvz_swapchain_present_mode(
-        swapchain, vsync ? VK_PRESENT_MODE_FIFO_KHR : VK_PRESENT_MODE_IMMEDIATE_KHR);
+    dvz_swapchain_present_mode(swapchain, present_mode);
     dvz_swapchain_create(swapchain);
 
     ANN(swapchain->images);
@@ -14,6 +14,7 @@
 #include "recorder.h"
 #include "renderer.h"
 #include "scene/graphics.h"
+#include "soft.h"
 #include "workspace.h"
 
 
@@ -452,6 +453,21 @@ static void* _graphics_specialization(DvzRenderer* rd, DvzRequest req)
 
 
 
+static void* _graphics_push(DvzRenderer* rd, DvzRequest req)
+{
+    DvzGraphics* graphics = _get_graphics(rd, req);
+    ASSERT(req.type == DVZ_REQUEST_OBJECT_PUSH);
+
+    // NOTE: we assume DvzShaderType and VkShaderStageFlags match.
+    dvz_graphics_push(
+        graphics, req.content.set_push.offset, req.content.set_push.size,
+        (VkShaderStageFlags)req.content.set_push.shader_stages);
+
+    return NULL;
+}
+
+
+
 static void* _graphics_delete(DvzRenderer* rd, DvzRequest req)
 {
     ANN(rd);
@@ -529,7 +545,7 @@ static void* _graphics_bind_dat(DvzRenderer* rd, DvzRequest req)
     // Link the dat.
     // pipe->dats[req.content.bind_dat.slot_idx] = dat;
 
-    dvz_pipe_dat(pipe, req.content.bind_dat.slot_idx, dat);
+    dvz_pipe_dat_offset(pipe, req.content.bind_dat.slot_idx, dat, req.content.bind_dat.offset);
     if (dvz_pipe_complete(pipe))
         dvz_descriptors_update(&pipe->descriptors);
 
@@ -591,9 +607,17 @@ static void* _dat_upload(DvzRenderer* rd, DvzRequest req)
     GET_ID(DvzDat, dat, req.id)
     ANN(dat->br.buffer);
     ASSERT(dat->br.size > 0);
-    ANN(req.content.dat_upload.data);
     ASSERT(req.content.dat_upload.size > 0);
 
+    // NOTE: shared-memory uploads are read in place in the arena of the producer.
+    void* data = dvz_upload_source(&req);
+    if (data == NULL)
+    {
+        log_error("unable to access the data to upload to dat 0x%" PRIx64, req.id);
+        dvz_upload_consume(&req);
+        return NULL;
+    }
+
     // Make sure the target dat is large enough to hold the uploaded data.
     if (req.content.dat_upload.size > dat->br.aligned_size)
     {
@@ -608,31 +632,40 @@ static void* _dat_upload(DvzRenderer* rd, DvzRequest req)
         "uploading %s to dat (buffer type %d region offset %d)",
         pretty_size(req.content.dat_upload.size), dat->br.buffer->type, dat->br.offsets[0]);
 
-    if ((dat->flags & DVZ_DAT_FLAGS_MAPPABLE) != 0)
+    uint32_t item_size = req.content.dat_upload.item_size;
+    uint32_t stride = req.content.dat_upload.stride;
+    if (item_size > 0 && stride != item_size)
+    {
+        // Strided source: the items are gathered directly into the staging or mapped memory.
+        uint32_t count = (uint32_t)(req.content.dat_upload.size / item_size);
+        dvz_dat_upload_strided(
+            dat, req.content.dat_upload.offset, count, item_size, stride,
+            data, !rd->ctx->transfers.batch.async);
+    }
+    else if ((dat->flags & DVZ_DAT_FLAGS_MAPPABLE) != 0)
     {
         dvz_buffer_regions_upload(
             &dat->br, 0,
             req.content.dat_upload.offset, //
             req.content.dat_upload.size,   //
-            req.content.dat_upload.data    //
+            data                           //
         );
     }
     else
     {
+        // When the transfers are synchronized with the presenter, the upload does not wait: the
+        // data is copied into the staging ring and the GPU copy is recorded in the frame batch.
         dvz_dat_upload(
             dat,                           //
             req.content.dat_upload.offset, //
             req.content.dat_upload.size,   //
-            req.content.dat_upload.data,   //
-            true);                         // TODO: do not wait? try false
+            data,                          //
+            !rd->ctx->transfers.batch.async);
     }
 
-    // We free the copy of the data that had been done by the requester in dvz_upload_dat().
-    if ((req.flags & DVZ_UPLOAD_FLAGS_NOCOPY) == 0)
-    {
-        FREE(req.content.dat_upload.data);
-    }
-    // TODO: if we do not wait, the freeing must wait until the transfer is done.
+    // Free the copy made by the requester, or release the zero-copy or shared-memory source.
+    // NOTE: non-blocking uploads have already copied the data into the staging ring.
+    dvz_upload_consume(&req);
 
     return NULL;
 }
@@ -702,6 +735,15 @@ static void* _tex_upload(DvzRenderer* rd, DvzRequest req)
         (req.content.tex_upload.offset[2] + req.content.tex_upload.shape[2] > tex->shape[2]))
     {
         log_error("tex to upload is larger than the tex shape");
+        dvz_upload_consume(&req);
+        return NULL;
+    }
+
+    void* data = dvz_upload_source(&req);
+    if (data == NULL)
+    {
+        log_error("unable to access the data to upload to tex 0x%" PRIx64, req.id);
+        dvz_upload_consume(&req);
         return NULL;
     }
 
@@ -712,18 +754,51 @@ static void* _tex_upload(DvzRenderer* rd, DvzRequest req)
         req.content.tex_upload.offset, //
         req.content.tex_upload.shape,  //
         req.content.tex_upload.size,   //
-        req.content.tex_upload.data,   //
-        true);                         // TODO: do not wait? try false
+        data,                          //
+        !rd->ctx->transfers.batch.async);
 
-    // We free the copy of the data that had been done by the requester in dvz_upload_dat().
-    FREE(req.content.tex_upload.data);
-    // TODO: if we do not wait, the freeing must wait until the transfer is done.
+    // Free the copy made by the requester, or release the shared-memory source.
+    // NOTE: non-blocking uploads have already copied the data into the staging ring.
+    dvz_upload_consume(&req);
 
     return NULL;
 }
 
 
 
+// Update the descriptors of the pipes bound to a texture whose image views have been recreated.
+static void _tex_rebind(DvzRenderer* rd, DvzTex* tex)
+{
+    ANN(rd);
+    ANN(rd->pipelib);
+    ANN(tex);
+
+    DvzContainer* containers[] = {&rd->pipelib->graphics, &rd->pipelib->computes};
+    DvzPipe* pipe = NULL;
+    for (uint32_t c = 0; c < 2; c++)
+    {
+        DvzContainerIterator iter = dvz_container_iterator(containers[c]);
+        while (iter.item != NULL)
+        {
+            pipe = (DvzPipe*)iter.item;
+            dvz_container_iter(&iter);
+            if (!dvz_pipe_complete(pipe))
+                continue;
+            for (uint32_t i = 0; i < pipe->descriptors.slots->slot_count; i++)
+            {
+                if (pipe->descriptors.images[i] == tex->img)
+                {
+                    log_trace("rebind resized tex to pipe");
+                    dvz_descriptors_update(&pipe->descriptors);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+
+
 static void* _tex_resize(DvzRenderer* rd, DvzRequest req)
 {
     ANN(rd);
@@ -734,6 +809,9 @@ static void* _tex_resize(DvzRenderer* rd, DvzRequest req)
 
     dvz_tex_resize(tex, req.content.tex.shape);
 
+    // The image views have been recreated: every pipe sampling the texture must be rebound.
+    _tex_rebind(rd, tex);
+
     return NULL;
 }
 
@@ -955,6 +1033,7 @@ static void _setup_router(DvzRenderer* rd)
     ROUTE(SET, VERTEX_ATTR, _graphics_vertex_attr)
     ROUTE(SET, SLOT, _graphics_slot)
     ROUTE(SET, SPECIALIZATION, _graphics_specialization)
+    ROUTE(SET, PUSH, _graphics_push)
     ROUTE(DELETE, GRAPHICS, _graphics_delete)
 
     // Shaders.
@@ -1046,11 +1125,21 @@ static void _update_mapping(DvzRenderer* rd, DvzRequest req, void* obj)
 
 DvzRenderer* dvz_renderer(DvzGpu* gpu, int flags)
 {
-    ANN(gpu);
     DvzRenderer* rd = (DvzRenderer*)calloc(1, sizeof(DvzRenderer));
     ANN(rd);
     rd->gpu = gpu;
     rd->flags = flags;
+
+    // Headless CPU rendering: all requests are forwarded to the software backend.
+    if ((flags & DVZ_RENDERER_FLAGS_SOFTWARE) != 0)
+    {
+        log_debug("create a software renderer");
+        rd->soft = dvz_soft(flags);
+        dvz_obj_created(&rd->obj);
+        return rd;
+    }
+
+    ANN(gpu);
     _init_renderer(rd);
     _setup_router(rd);
     return rd;
@@ -1062,6 +1151,12 @@ void dvz_renderer_request(DvzRenderer* rd, DvzRequest req)
 {
     ANN(rd);
 
+    if (rd->soft != NULL)
+    {
+        dvz_soft_request(rd->soft, req);
+        return;
+    }
+
     DvzRouterCallback cb = rd->router->router[std::make_pair(req.action, req.type)];
     if (cb == NULL)
     {
@@ -1168,6 +1263,9 @@ uint8_t* dvz_renderer_image(DvzRenderer* rd, DvzId bc_id, DvzSize* size, uint8_t
 {
     ANN(rd);
 
+    if (rd->soft != NULL)
+        return dvz_soft_image(rd->soft, bc_id, size, rgb);
+
     int bctype = dvz_map_type(rd->map, bc_id);
 
     if (bctype == DVZ_REQUEST_OBJECT_BOARD)
@@ -1234,6 +1332,14 @@ void dvz_renderer_destroy(DvzRenderer* rd)
     ANN(rd);
     log_trace("destroy the renderer");
 
+    if (rd->soft != NULL)
+    {
+        dvz_soft_destroy(rd->soft);
+        dvz_obj_destroyed(&rd->obj);
+        FREE(rd);
+        return;
+    }
+
     // This call destroys all canvases etc.
     dvz_workspace_destroy(rd->workspace);
 
@@ -6,8 +6,10 @@
 #include "_debug.h"
 #include "_list.h"
 #include "_pointer.h"
+#include "codec.h"
 #include "fifo.h"
 #include "fileio.h"
+#include "shm.h"
 
 
 
@@ -76,7 +78,8 @@ static uint32_t* _cpy_uint32(DvzSize size, const void* data)
 
 
 
-static int write_file(const char* filename, DvzSize block_size, uint32_t block_count, void* data)
+static int
+write_file(const char* filename, DvzSize block_size, uint32_t block_count, const void* data)
 {
     ANN(filename);
     ASSERT(block_size > 0);
@@ -96,6 +99,88 @@ static int write_file(const char* filename, DvzSize block_size, uint32_t block_c
 }
 
 
+// Whether a request carries a payload, saved in a secondary file when dumping the batch.
+static bool _has_payload(DvzRequest* req)
+{
+    ANN(req);
+    return req->action == DVZ_REQUEST_ACTION_UPLOAD ||
+           (req->action == DVZ_REQUEST_ACTION_CREATE && req->type == DVZ_REQUEST_OBJECT_SHADER) ||
+           (req->action == DVZ_REQUEST_ACTION_SET &&
+            req->type == DVZ_REQUEST_OBJECT_SPECIALIZATION);
+}
+
+
+
+// Return the contiguous payload of a request, gathering strided upload sources in a copy.
+static void* _request_payload(DvzRequest* req, DvzSize* size, bool* is_copy)
+{
+    ANN(req);
+    ANN(size);
+    ANN(is_copy);
+    DvzRequestContent* c = &req->content;
+    *is_copy = false;
+
+    if (req->type == DVZ_REQUEST_OBJECT_SHADER)
+    {
+        *size = c->shader.size;
+        return c->shader.code != NULL ? (void*)c->shader.code : (void*)c->shader.buffer;
+    }
+    if (req->type == DVZ_REQUEST_OBJECT_SPECIALIZATION)
+    {
+        *size = c->set_specialization.size;
+        return c->set_specialization.value;
+    }
+
+    void* data = dvz_upload_source(req);
+    if (req->type == DVZ_REQUEST_OBJECT_TEX)
+    {
+        *size = c->tex_upload.size;
+        return data;
+    }
+
+    *size = c->dat_upload.size;
+    uint32_t item_size = c->dat_upload.item_size;
+    uint32_t stride = c->dat_upload.stride;
+    if (data == NULL || item_size == 0 || stride == item_size)
+        return data;
+
+    uint32_t count = (uint32_t)(c->dat_upload.size / item_size);
+    void* contiguous = malloc(c->dat_upload.size);
+    ANN(contiguous);
+    dvz_gather(contiguous, data, count, item_size, stride);
+    *is_copy = true;
+    return contiguous;
+}
+
+
+
+// Read a secondary dump file, decompressing it if needed.
+static void* _read_payload(const char* filename, DvzSize* size)
+{
+    ANN(filename);
+    ANN(size);
+
+    void* buf = dvz_read_file(filename, size);
+    if (buf == NULL)
+        return NULL;
+    DvzSize original_size = dvz_codec_size(buf, *size);
+    if (original_size == 0)
+        return buf;
+
+    void* data = malloc(original_size);
+    ANN(data);
+    if (dvz_codec_decompress(buf, *size, data, original_size) != 0)
+    {
+        log_error("unable to decompress `%s`", filename);
+        FREE(data);
+    }
+    FREE(buf);
+    *size = data != NULL ? original_size : 0;
+    return data;
+}
+
+
+
 static char* show_data(const unsigned char* src, size_t len)
 {
     if (len > 1024)
@@ -270,7 +355,7 @@ static void _print_upload_dat(DvzRequest* req)
     DvzId dat = req->id;
     DvzSize size = req->content.dat_upload.size;
     DvzSize offset = req->content.dat_upload.offset;
-    void* data = req->content.dat_upload.data;
+    void* data = dvz_upload_source(req);
 
     char* encoded = NULL;
     // NOTE: avoid computing the base64 of large arrays.
@@ -349,7 +434,7 @@ static void _print_upload_tex(DvzRequest* req)
     uint32_t* offset = req->content.tex_upload.offset;
     uint32_t* shape = req->content.tex_upload.shape;
 
-    void* data = req->content.tex_upload.data;
+    void* data = dvz_upload_source(req);
 
     char* encoded = NULL;
     // NOTE: avoid computing the base64 of large arrays.
@@ -785,6 +870,23 @@ static void _print_record_viewport(DvzRequest* req)
         req->content.record.command.contents.v.shape[1]);
 }
 
+static void _print_set_push(DvzRequest* req)
+{
+    log_trace("print_set_push");
+    ANN(req);
+
+    printf(
+        "- action: set\n"
+        "  type: push\n"
+        "  id: 0x%" PRIx64 "\n"
+        "  content:\n"
+        "    shader_stages: %d\n"
+        "    offset: %" PRId64 "\n"
+        "    size: %" PRId64 "\n",
+        req->id, req->content.set_push.shader_stages, req->content.set_push.offset,
+        req->content.set_push.size);
+}
+
 static void _print_record_draw(DvzRequest* req)
 {
     log_trace("print_record_draw");
@@ -870,6 +972,35 @@ static void _print_record_draw_indexed_indirect(DvzRequest* req)
         req->content.record.command.contents.draw_indirect.draw_count);
 }
 
+static void _print_record_push(DvzRequest* req)
+{
+    log_trace("print_record_push");
+    ANN(req);
+
+    uint32_t size = req->content.record.command.contents.push.size;
+    char* encoded = show_data(req->content.record.command.contents.push.data, size);
+
+    printf(
+        "- action: record\n"
+        "  type: push\n"
+        "  id: 0x%" PRIx64 "\n"
+        "  content:\n"
+        "    graphics: 0x%" PRIx64 "\n"
+        "    shader_stages: %d\n"
+        "    offset: %u\n"
+        "    size: %u\n"
+        "    data:\n"
+        "      mode: %s\n"
+        "      buffer: %s\n",
+        req->id, //
+        req->content.record.command.contents.push.pipe_id,
+        req->content.record.command.contents.push.shader_stages,
+        req->content.record.command.contents.push.offset, size,
+        encoded[2] == ' ' ? "hex" : "base64", encoded);
+
+    free(encoded);
+}
+
 
 
 static void _print_record_end(DvzRequest* req)
@@ -925,6 +1056,7 @@ void dvz_request_print(DvzRequest* req)
     IF_REQ(SET, VERTEX_ATTR) _print_set_attr(req);
     IF_REQ(SET, SLOT) _print_set_slot(req);
     IF_REQ(SET, SPECIALIZATION) _print_set_specialization(req);
+    IF_REQ(SET, PUSH) _print_set_push(req);
 
     IF_REQ(BIND, DAT) _print_bind_dat(req);
     IF_REQ(BIND, TEX) _print_bind_tex(req);
@@ -943,6 +1075,8 @@ void dvz_request_print(DvzRequest* req)
             _print_record_draw_indirect(req);
         if (req->content.record.command.type == DVZ_RECORDER_DRAW_INDEXED_INDIRECT)
             _print_record_draw_indexed_indirect(req);
+        if (req->content.record.command.type == DVZ_RECORDER_PUSH)
+            _print_record_push(req);
         if (req->content.record.command.type == DVZ_RECORDER_END)
             _print_record_end(req);
     }
@@ -1122,7 +1256,7 @@ void dvz_batch_print(DvzBatch* batch)
 
 
 
-int dvz_batch_dump(DvzBatch* batch, const char* filename)
+static int _batch_dump(DvzBatch* batch, const char* filename, DvzSize threshold)
 {
     ANN(batch);
     ANN(batch->requests);
@@ -1144,38 +1278,92 @@ int dvz_batch_dump(DvzBatch* batch, const char* filename)
     if (res != 0)
         return res;
 
-    // Write additional files for uploaded data.
+    // Collect the uploaded data, the shader code and the specialization constants.
     DvzRequest* req = NULL;
-    DvzRequestContent* c = NULL;
-    char filename_bin[32] = {0};
-    uint32_t k = 1;
-    for (uint32_t i = 0; i < batch->count; i++)
+    uint32_t upload_count = 0;
+    for (uint32_t i = 0; i < count; i++)
+        if (_has_payload(&batch->requests[i]))
+            upload_count++;
+    if (upload_count == 0)
+        return 0;
+
+    DvzCodecJob* jobs = (DvzCodecJob*)calloc(upload_count, sizeof(DvzCodecJob));
+    bool* is_copy = (bool*)calloc(upload_count, sizeof(bool));
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < count; i++)
     {
         req = &batch->requests[i];
-        c = &req->content;
-        ANN(req);
-
-        if (req->action == DVZ_REQUEST_ACTION_UPLOAD)
-        {
-            // Increment the filename.
-            snprintf(filename_bin, 30, "%s.%03d", filename, k++);
-            log_trace("saving secondary dump file `%s`", filename_bin);
+        if (!_has_payload(req))
+            continue;
+        jobs[k].src = _request_payload(req, &jobs[k].size, &is_copy[k]);
+        jobs[k].item_size = DVZ_CODEC_ITEM_SIZE;
+        if (req->type == DVZ_REQUEST_OBJECT_DAT && req->content.dat_upload.item_size > 0)
+            jobs[k].item_size = req->content.dat_upload.item_size;
+        jobs[k].filter = DVZ_CODEC_FILTER_SHUFFLE | DVZ_CODEC_FILTER_DELTA;
+        k++;
+    }
+    ASSERT(k == upload_count);
 
-            ANN(c);
-            if (req->type == DVZ_REQUEST_OBJECT_DAT)
-            {
-                if (write_file(filename_bin, c->dat_upload.size, 1, c->dat_upload.data) != 0)
-                    return 1;
-            }
-            else if (req->type == DVZ_REQUEST_OBJECT_TEX)
+    // Compress the large payloads on worker threads, the others are left as they are.
+    if (threshold > 0)
+    {
+        DvzCodecJob** large = (DvzCodecJob**)calloc(upload_count, sizeof(DvzCodecJob*));
+        DvzCodecJob* pending = (DvzCodecJob*)calloc(upload_count, sizeof(DvzCodecJob));
+        uint32_t n = 0;
+        for (k = 0; k < upload_count; k++)
+            if (jobs[k].src != NULL && jobs[k].size >= threshold)
             {
-                if (write_file(filename_bin, c->tex_upload.size, 1, c->tex_upload.data) != 0)
-                    return 1;
+                large[n] = &jobs[k];
+                pending[n++] = jobs[k];
             }
-        }
+        dvz_codec_jobs(n, pending, 0);
+        for (k = 0; k < n; k++)
+            *large[k] = pending[k];
+        FREE(large);
+        FREE(pending);
     }
 
-    return 0;
+    // Write additional files for the payloads.
+    char filename_bin[1024] = {0};
+    for (k = 0; k < upload_count; k++)
+    {
+        // Increment the filename.
+        snprintf(filename_bin, sizeof(filename_bin), "%s.%03d", filename, k + 1);
+        log_trace("saving secondary dump file `%s`", filename_bin);
+
+        if (jobs[k].src == NULL)
+            res = 1;
+        else if (jobs[k].dst != NULL)
+            res = write_file(filename_bin, jobs[k].dst_size, 1, jobs[k].dst);
+        else
+            res = write_file(filename_bin, jobs[k].size, 1, jobs[k].src);
+        if (res != 0)
+            break;
+    }
+
+    for (k = 0; k < upload_count; k++)
+    {
+        if (is_copy[k])
+            free((void*)jobs[k].src);
+        FREE(jobs[k].dst);
+    }
+    FREE(jobs);
+    FREE(is_copy);
+    return res;
+}
+
+
+
+int dvz_batch_dump(DvzBatch* batch, const char* filename)
+{
+    return _batch_dump(batch, filename, 0);
+}
+
+
+
+int dvz_batch_dump_compressed(DvzBatch* batch, const char* filename, DvzSize threshold)
+{
+    return _batch_dump(batch, filename, MAX(threshold, 1));
 }
 
 
@@ -1205,11 +1393,12 @@ void dvz_batch_load(DvzBatch* batch, const char* filename)
     // Number of requests.
     uint32_t count = size / sizeof(DvzRequest);
 
-    // Write additional files for uploaded data.
+    // Read the additional files for the payloads.
     DvzRequest* req = NULL;
     DvzRequestContent* c = NULL;
-    char filename_bin[32] = {0};
+    char filename_bin[1024] = {0};
     uint32_t k = 1;
+    void* payload = NULL;
 
     for (uint32_t i = 0; i < count; i++)
     {
@@ -1217,27 +1406,76 @@ void dvz_batch_load(DvzBatch* batch, const char* filename)
         c = &req->content;
         ANN(req);
 
-        if (req->action == DVZ_REQUEST_ACTION_UPLOAD)
+        // The description string is not valid outside of the process that created the request.
+        req->desc = NULL;
+        if (!_has_payload(req))
         {
-            // Increment the filename.
-            snprintf(filename_bin, 30, "%s.%03d", filename, k++);
-            log_trace("saving secondary dump file `%s`", filename_bin);
+            dvz_batch_add(batch, *req);
+            continue;
+        }
+
+        // Increment the filename.
+        snprintf(filename_bin, sizeof(filename_bin), "%s.%03d", filename, k++);
+        log_trace("loading secondary dump file `%s`", filename_bin);
 
+        // NOTE: the shader code and the specialization constants are freed by the renderer, like
+        // the copies made by dvz_create_spirv() and dvz_set_specialization().
+        if (req->type == DVZ_REQUEST_OBJECT_SHADER)
+        {
+            payload = _read_payload(filename_bin, &c->shader.size);
+            if (payload == NULL)
+            {
+                log_error("unable to load the code of shader 0x%" PRIx64 ", skipping", req->id);
+                continue;
+            }
+            if (c->shader.code != NULL)
+                c->shader.code = (char*)payload;
+            else
+                c->shader.buffer = (uint32_t*)payload;
+        }
+        else if (req->type == DVZ_REQUEST_OBJECT_SPECIALIZATION)
+        {
+            payload = _read_payload(filename_bin, &c->set_specialization.size);
+            if (payload == NULL)
+            {
+                log_error(
+                    "unable to load a specialization constant of graphics 0x%" PRIx64
+                    ", skipping",
+                    req->id);
+                continue;
+            }
+            c->set_specialization.value = payload;
+        }
+        else
+        {
+            // NOTE: the payloads are owned by the batch, so that the requests can be replayed.
             ANN(c);
+            req->flags |= DVZ_UPLOAD_FLAGS_NOCOPY;
             if (req->type == DVZ_REQUEST_OBJECT_DAT)
             {
-                c->dat_upload.data = (void*)dvz_read_file(filename_bin, &c->dat_upload.size);
+                c->dat_upload.upload_type = DVZ_UPLOAD_TYPE_DIRECT;
+                c->dat_upload.data = _read_payload(filename_bin, &c->dat_upload.size);
                 dvz_list_append(batch->pointers_to_free, (DvzListItem){.p = c->dat_upload.data});
+
+                // Strided and shared-memory sources are saved contiguously, and the release
+                // callback is not valid outside of the process that created the request.
+                c->dat_upload.item_size = 0;
+                c->dat_upload.stride = 0;
+                c->dat_upload.release = NULL;
+                c->dat_upload.user_data = NULL;
             }
             else if (req->type == DVZ_REQUEST_OBJECT_TEX)
             {
-                c->tex_upload.data = (void*)dvz_read_file(filename_bin, &c->tex_upload.size);
+                c->tex_upload.upload_type = DVZ_UPLOAD_TYPE_DIRECT;
+                c->tex_upload.shm = 0;
+                c->tex_upload.data = _read_payload(filename_bin, &c->tex_upload.size);
                 dvz_list_append(batch->pointers_to_free, (DvzListItem){.p = c->tex_upload.data});
             }
         }
 
         dvz_batch_add(batch, *req);
     }
+    FREE(requests);
 }
 
 
@@ -1273,6 +1511,83 @@ void dvz_batch_destroy(DvzBatch* batch)
 
 
 
+void* dvz_upload_source(DvzRequest* req)
+{
+    ANN(req);
+    ASSERT(req->action == DVZ_REQUEST_ACTION_UPLOAD);
+    DvzRequestContent* c = &req->content;
+
+    if (req->type == DVZ_REQUEST_OBJECT_DAT)
+    {
+        if (c->dat_upload.upload_type != DVZ_UPLOAD_TYPE_SHM)
+            return c->dat_upload.data;
+        DvzShm* shm = dvz_shm_get(c->dat_upload.shm);
+        return shm != NULL
+                   ? dvz_shm_pointer(shm, c->dat_upload.shm_offset, c->dat_upload.size)
+                   : NULL;
+    }
+    else if (req->type == DVZ_REQUEST_OBJECT_TEX)
+    {
+        if (c->tex_upload.upload_type != DVZ_UPLOAD_TYPE_SHM)
+            return c->tex_upload.data;
+        DvzShm* shm = dvz_shm_get(c->tex_upload.shm);
+        return shm != NULL
+                   ? dvz_shm_pointer(shm, c->tex_upload.shm_offset, c->tex_upload.size)
+                   : NULL;
+    }
+    return NULL;
+}
+
+
+
+void dvz_upload_consume(DvzRequest* req)
+{
+    ANN(req);
+    ASSERT(req->action == DVZ_REQUEST_ACTION_UPLOAD);
+    DvzRequestContent* c = &req->content;
+
+    if (req->type == DVZ_REQUEST_OBJECT_DAT)
+    {
+        if (c->dat_upload.upload_type == DVZ_UPLOAD_TYPE_SHM)
+        {
+            DvzShm* shm = dvz_shm_get(c->dat_upload.shm);
+            if (shm != NULL)
+                dvz_shm_unref(shm, c->dat_upload.shm_offset);
+            return;
+        }
+
+        // We free the copy of the data that had been done by the requester in dvz_upload_dat().
+        if ((req->flags & DVZ_UPLOAD_FLAGS_NOCOPY) == 0)
+        {
+            FREE(c->dat_upload.data);
+        }
+
+        // Zero-copy uploads: the source has been consumed by the upload, it can be released.
+        if (c->dat_upload.release != NULL)
+        {
+            c->dat_upload.release(c->dat_upload.user_data);
+        }
+    }
+    else if (req->type == DVZ_REQUEST_OBJECT_TEX)
+    {
+        if (c->tex_upload.upload_type == DVZ_UPLOAD_TYPE_SHM)
+        {
+            DvzShm* shm = dvz_shm_get(c->tex_upload.shm);
+            if (shm != NULL)
+                dvz_shm_unref(shm, c->tex_upload.shm_offset);
+            return;
+        }
+
+        // We free the copy of the data that had been done by the requester in dvz_upload_tex().
+        if ((req->flags & DVZ_UPLOAD_FLAGS_NOCOPY) == 0)
+        {
+            FREE(c->tex_upload.data);
+        }
+    }
+}
+
+
+
 /*************************************************************************************************/
 /*  Requester functions                                                                          */
 /*************************************************************************************************/
@@ -1490,6 +1805,61 @@ dvz_upload_dat(DvzBatch* batch, DvzId dat, DvzSize offset, DvzSize size, void* d
 
 
 
+DvzRequest dvz_upload_dat_strided(
+    DvzBatch* batch, DvzId dat, DvzSize offset, uint32_t count, DvzSize item_size, DvzSize stride,
+    void* data, DvzUploadReleaseCallback release, void* user_data)
+{
+    ASSERT(count > 0);
+    ASSERT(item_size > 0);
+    ASSERT(stride >= item_size);
+    ASSERT(stride <= UINT32_MAX);
+    ANN(data);
+
+    CREATE_REQUEST(UPLOAD, DAT);
+    req.id = dat;
+    req.flags = DVZ_UPLOAD_FLAGS_NOCOPY;
+    req.content.dat_upload.offset = offset;
+    req.content.dat_upload.size = count * item_size;
+    req.content.dat_upload.data = data;
+    req.content.dat_upload.item_size = (uint32_t)item_size;
+    req.content.dat_upload.stride = (uint32_t)stride;
+    req.content.dat_upload.release = release;
+    req.content.dat_upload.user_data = user_data;
+
+    IF_VERBOSE
+    _print_upload_dat(&req);
+
+    RETURN_REQUEST
+}
+
+
+
+DvzRequest dvz_upload_dat_shm(
+    DvzBatch* batch, DvzId dat, DvzSize offset, DvzShm* shm, DvzSize shm_offset, DvzSize size)
+{
+    ANN(shm);
+    ASSERT(size > 0);
+    ASSERT(shm_offset + size <= shm->size);
+
+    CREATE_REQUEST(UPLOAD, DAT);
+    req.id = dat;
+    req.content.dat_upload.upload_type = DVZ_UPLOAD_TYPE_SHM;
+    req.content.dat_upload.offset = offset;
+    req.content.dat_upload.size = size;
+    req.content.dat_upload.shm = shm->id;
+    req.content.dat_upload.shm_offset = shm_offset;
+
+    // NOTE: the reference is released by the renderer in dvz_upload_consume().
+    dvz_shm_ref(shm, shm_offset);
+
+    IF_VERBOSE
+    _print_upload_dat(&req);
+
+    RETURN_REQUEST
+}
+
+
+
 DvzRequest dvz_delete_dat(DvzBatch* batch, DvzId id)
 {
     CREATE_REQUEST(DELETE, DAT);
@@ -1552,7 +1922,40 @@ DvzRequest dvz_upload_tex(
 
     // NOTE: we make a copy of the data to ensure it lives until the renderer has done processing
     // it.
-    req.content.tex_upload.data = _cpy(size, data);
+    if ((flags & DVZ_UPLOAD_FLAGS_NOCOPY) == 0)
+    {
+        data = _cpy(size, data);
+    }
+    req.content.tex_upload.data = data;
+
+    IF_VERBOSE
+    _print_upload_tex(&req);
+
+    RETURN_REQUEST
+}
+
+
+
+DvzRequest dvz_upload_tex_shm(
+    DvzBatch* batch, DvzId tex, uvec3 offset, uvec3 shape, DvzShm* shm, DvzSize shm_offset,
+    DvzSize size)
+{
+    ANN(shm);
+    ASSERT(size > 0);
+    ASSERT(shm_offset + size <= shm->size);
+
+    CREATE_REQUEST(UPLOAD, TEX);
+    req.id = tex;
+    req.content.tex_upload.upload_type = DVZ_UPLOAD_TYPE_SHM;
+
+    memcpy(req.content.tex_upload.offset, offset, sizeof(uvec3));
+    memcpy(req.content.tex_upload.shape, shape, sizeof(uvec3));
+    req.content.tex_upload.size = size;
+    req.content.tex_upload.shm = shm->id;
+    req.content.tex_upload.shm_offset = shm_offset;
+
+    // NOTE: the reference is released by the renderer in dvz_upload_consume().
+    dvz_shm_ref(shm, shm_offset);
 
     IF_VERBOSE
     _print_upload_tex(&req);
@@ -1840,6 +2243,25 @@ DvzRequest dvz_set_specialization(
 
 
 
+DvzRequest
+dvz_set_push(DvzBatch* batch, DvzId graphics, int shader_stages, DvzSize offset, DvzSize size)
+{
+    ASSERT(size > 0);
+
+    CREATE_REQUEST(SET, PUSH);
+    req.id = graphics;
+    req.content.set_push.shader_stages = shader_stages;
+    req.content.set_push.offset = offset;
+    req.content.set_push.size = size;
+
+    IF_VERBOSE
+    _print_set_push(&req);
+
+    RETURN_REQUEST
+}
+
+
+
 DvzRequest dvz_delete_graphics(DvzBatch* batch, DvzId id)
 {
     CREATE_REQUEST(DELETE, GRAPHICS);
@@ -2038,6 +2460,32 @@ DvzRequest dvz_record_draw_indexed_indirect(
 
 
 
+DvzRequest dvz_record_push(
+    DvzBatch* batch, DvzId canvas_or_board_id, DvzId graphics, int shader_stages, DvzSize offset,
+    DvzSize size, const void* data)
+{
+    ASSERT(size > 0);
+    ASSERT(size <= DVZ_RECORDER_PUSH_SIZE);
+    ASSERT(offset + size <= UINT16_MAX);
+    ANN(data);
+
+    CREATE_REQUEST(RECORD, RECORD);
+    req.id = canvas_or_board_id;
+    req.content.record.command.type = DVZ_RECORDER_PUSH;
+    req.content.record.command.contents.push.pipe_id = graphics;
+    req.content.record.command.contents.push.shader_stages = shader_stages;
+    req.content.record.command.contents.push.offset = (uint16_t)offset;
+    req.content.record.command.contents.push.size = (uint16_t)size;
+    memcpy(req.content.record.command.contents.push.data, data, size);
+
+    IF_VERBOSE
+    _print_record_push(&req);
+
+    RETURN_REQUEST
+}
+
+
+
 DvzRequest dvz_record_end(DvzBatch* batch, DvzId canvas_or_board_id)
 {
     CREATE_REQUEST(RECORD, RECORD);
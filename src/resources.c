@@ -21,24 +21,63 @@
 /*  Wait utils                                                                                   */
 /*************************************************************************************************/
 
-static void _wait_dat_upload(DvzTransfers* transfers, bool staging, bool need_dealloc_stg)
+// Process the tasks of a deq proc until a given task has been processed. Other tasks may be queued
+// before it, for instance the asynchronous copies from the staging ring, so a single dequeue does
+// not guarantee that this task has completed.
+static void _wait_task(DvzTransfers* transfers, uint32_t proc_idx, void* task)
 {
     ANN(transfers);
+    ANN(task);
 
-    if (staging)
-        dvz_deq_dequeue(transfers->deq, DVZ_TRANSFER_PROC_CPY, true);
-    else
+    DvzDeqItem item = {0};
+    bool done = false;
+    while (!done)
     {
-        // WARNING: for mappable buffers, the transfer is done on the main thread (using
-        // the COPY queue, not the UD queue), not in the background thread, so we need to
-        // dequeue the COPY queue manually!
-        dvz_deq_dequeue(transfers->deq, DVZ_TRANSFER_PROC_CPY, true);
-        dvz_queue_wait(transfers->gpu, DVZ_DEFAULT_QUEUE_TRANSFER);
+        item = dvz_deq_dequeue_return(transfers->deq, proc_idx, true);
+        done = item.item == task;
+        FREE(item.item);
     }
+}
+
+
+
+static void
+_wait_dat_upload(DvzTransfers* transfers, bool staging, void* task, void* done_task)
+{
+    ANN(transfers);
+
+    // WARNING: for mappable buffers, the transfer is done on the main thread (using the COPY
+    // queue, not the UD queue), not in the background thread, so we need to dequeue the COPY
+    // queue manually!
+    _wait_task(transfers, DVZ_TRANSFER_PROC_CPY, task);
+    if (!staging)
+        dvz_queue_wait(transfers->gpu, DVZ_DEFAULT_QUEUE_TRANSFER);
 
     // Dequeue the upload_done event if needed.
-    if (need_dealloc_stg)
-        dvz_deq_dequeue(transfers->deq, DVZ_TRANSFER_PROC_EV, true);
+    if (done_task != NULL)
+        _wait_task(transfers, DVZ_TRANSFER_PROC_EV, done_task);
+}
+
+
+
+// Copy the data into the staging ring, the GPU copy will be recorded in the next transfer batch.
+static bool _stage_dat_upload(
+    DvzTransfers* transfers, DvzDat* dat, DvzSize offset, uint32_t count, DvzSize item_size,
+    DvzSize stride, void* data)
+{
+    ANN(transfers);
+    ANN(dat);
+
+    DvzBufferRegions ring_br = {0};
+    DvzSize ring_offset = 0;
+    if (!dvz_transfers_stage_strided(
+            transfers, count, item_size, stride, data, &ring_br, &ring_offset))
+        return false;
+
+    DvzSize size = count * item_size;
+    DvzDeqItem* item = _create_buffer_copy(ring_br, ring_offset, dat->br, offset, size);
+    dvz_deq_enqueue_submit(transfers->deq, item, false);
+    return true;
 }
 
 
@@ -252,6 +291,20 @@ void dvz_dat_upload(DvzDat* dat, DvzSize offset, DvzSize size, void* data, bool
     DvzGpu* gpu = res->gpu;
     ANN(gpu);
 
+    bool dup = _dat_is_dup(dat);
+
+    // Asynchronous uploads that require a staging buffer go through the staging ring, so that
+    // no staging buffer needs to be allocated or mapped here.
+    if (!dup && !wait && _dat_has_staging(dat))
+    {
+        if (_stage_dat_upload(transfers, dat, offset, 1, size, size, data))
+            return;
+
+        // The caller may free the data as soon as this function returns, so we fall back to a
+        // synchronous upload.
+        wait = true;
+    }
+
     // Do we need a staging buffer?
     DvzDat* stg = dat->stg;
     bool need_dealloc_stg = false;
@@ -266,7 +319,6 @@ void dvz_dat_upload(DvzDat* dat, DvzSize offset, DvzSize size, void* data, bool
     }
 
     // Enqueue the transfer task corresponding to the flags.
-    bool dup = _dat_is_dup(dat);
     bool staging = stg != NULL;
     DvzBufferRegions stg_br = staging ? stg->br : (DvzBufferRegions){0};
 
@@ -276,9 +328,11 @@ void dvz_dat_upload(DvzDat* dat, DvzSize offset, DvzSize size, void* data, bool
     {
         // Enqueue a standard upload task, with or without staging buffer.
         DvzDeqItem* done = need_dealloc_stg ? _create_upload_done(stg) : NULL;
-        _enqueue_buffer_upload(transfers->deq, dat->br, offset, stg_br, 0, size, data, done);
+        void* done_task = done != NULL ? done->item : NULL;
+        void* task =
+            _enqueue_buffer_upload(transfers->deq, dat->br, offset, stg_br, 0, size, data, done);
         if (wait)
-            _wait_dat_upload(transfers, staging, need_dealloc_stg);
+            _wait_dat_upload(transfers, staging, task, done_task);
     }
 
     else
@@ -292,6 +346,53 @@ void dvz_dat_upload(DvzDat* dat, DvzSize offset, DvzSize size, void* data, bool
 
 
 
+void dvz_dat_upload_strided(
+    DvzDat* dat, DvzSize offset, uint32_t count, DvzSize item_size, DvzSize stride, void* data,
+    bool wait)
+{
+    ANN(dat);
+    ANN(data);
+    ASSERT(count > 0);
+    ASSERT(item_size > 0);
+
+    DvzSize size = count * item_size;
+    if (stride == item_size)
+    {
+        dvz_dat_upload(dat, offset, size, data, wait);
+        return;
+    }
+
+    bool dup = _dat_is_dup(dat);
+
+    // Asynchronous uploads: the items are gathered directly in the staging ring.
+    if (!dup && !wait && _dat_has_staging(dat))
+    {
+        if (_stage_dat_upload(dat->transfers, dat, offset, count, item_size, stride, data))
+            return;
+    }
+
+    // Mappable dats: the items are gathered directly in the mapped buffer.
+    if (!dup && !_dat_has_staging(dat))
+    {
+        void* mapped = dvz_buffer_regions_map(&dat->br, 0, offset, size);
+        ANN(mapped);
+        dvz_gather(mapped, data, count, item_size, stride);
+        dvz_buffer_regions_unmap(&dat->br);
+        return;
+    }
+
+    // Otherwise, the items are gathered in a temporary buffer, uploaded synchronously so that it
+    // can be freed immediately.
+    log_debug("gather %s of strided data before upload", pretty_size(size));
+    void* contiguous = malloc(size);
+    ANN(contiguous);
+    dvz_gather(contiguous, data, count, item_size, stride);
+    dvz_dat_upload(dat, offset, size, contiguous, true);
+    FREE(contiguous);
+}
+
+
+
 void dvz_dat_download(DvzDat* dat, DvzSize offset, DvzSize size, void* data, bool wait)
 {
     ANN(dat);
@@ -409,18 +510,39 @@ void dvz_tex_upload(DvzTex* tex, uvec3 offset, uvec3 shape, DvzSize size, void*
     DvzTransfers* transfers = &ctx->transfers;
     ANN(transfers);
 
+    // May use shape[i] = 0 to indicate the full shape along that axis.
+    for (uint32_t i = 0; i < 3; i++)
+        if (shape[i] == 0)
+            shape[i] = tex->shape[i];
+
+    // Asynchronous uploads go through the staging ring, see dvz_dat_upload().
+    if (!wait)
+    {
+        DvzBufferRegions ring_br = {0};
+        DvzSize ring_offset = 0;
+        if (dvz_transfers_stage(transfers, size, data, &ring_br, &ring_offset))
+        {
+            dvz_deq_enqueue_submit(
+                transfers->deq,
+                _create_buffer_image_copy(
+                    DVZ_TRANSFER_BUFFER_IMAGE, ring_br, ring_offset, size, tex->img, offset,
+                    shape),
+                false);
+            return;
+        }
+        wait = true;
+    }
+
     // Get the associated staging buffer.
     DvzDat* stg = _tex_staging(ctx, tex, size);
     ANN(stg);
 
-    // May use shape[i] = 0 to indicate the full shape along that axis.
-    for (uint32_t i = 0; i < 3; i++)
-        shape[i] = shape[i] | tex->shape[i];
-    _enqueue_image_upload(transfers->deq, tex->img, offset, shape, stg->br, 0, size, data);
+    void* task =
+        _enqueue_image_upload(transfers->deq, tex->img, offset, shape, stg->br, 0, size, data);
 
     if (wait)
     {
-        dvz_deq_dequeue(transfers->deq, DVZ_TRANSFER_PROC_CPY, true);
+        _wait_task(transfers, DVZ_TRANSFER_PROC_CPY, task);
     }
 }
 
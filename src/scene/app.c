@@ -193,12 +193,29 @@ void dvz_app_ontimer(DvzApp* app, DvzClientCallback on_timer, void* user_data)
 
 
 
+void dvz_app_async(
+    DvzApp* app, DvzClientEventType type, DvzClientCallback callback, void* user_data)
+{
+    ANN(app);
+    ANN(app->client);
+
+    dvz_client_callback(app->client, type, DVZ_CLIENT_CALLBACK_ASYNC, callback, user_data);
+}
+
+
+
 void dvz_app_submit(DvzApp* app)
 {
     ANN(app);
-    ANN(app->prt);
+    dvz_app_submit_batch(app, app->batch);
+}
+
+
 
-    DvzBatch* batch = app->batch;
+void dvz_app_submit_batch(DvzApp* app, DvzBatch* batch)
+{
+    ANN(app);
+    ANN(app->prt);
     ANN(batch);
 
     // NOTE: this fixes a memory leak because we make a copy of the batch, expecting it
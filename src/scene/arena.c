@@ -0,0 +1,301 @@
+/*************************************************************************************************/
+/*  Arena                                                                                        */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "scene/arena.h"
+#include "_map.h"
+#include "request.h"
+#include "scene/array.h"
+#include "scene/dual.h"
+
+
+
+/*************************************************************************************************/
+/*  Utils                                                                                        */
+/*************************************************************************************************/
+
+static inline DvzSize _block_size(DvzSize size)
+{
+    return DVZ_ARENA_ALIGNMENT * ((size + DVZ_ARENA_ALIGNMENT - 1) / DVZ_ARENA_ALIGNMENT);
+}
+
+
+
+static DvzArenaPage* _page(DvzArena* arena, DvzId dat)
+{
+    ANN(arena);
+    for (uint32_t i = 0; i < arena->page_count; i++)
+    {
+        if (arena->pages[i]->dat == dat)
+            return arena->pages[i];
+    }
+    log_error("dat 0x%" PRIx64 " does not belong to the arena", dat);
+    return NULL;
+}
+
+
+
+static DvzArenaPage* _page_create(DvzArena* arena)
+{
+    ANN(arena);
+    ANN(arena->batch);
+
+    if (arena->page_count >= DVZ_ARENA_MAX_PAGES)
+    {
+        log_error("maximum number of arena pages reached (%d)", DVZ_ARENA_MAX_PAGES);
+        return NULL;
+    }
+
+    DvzArenaPage* page = (DvzArenaPage*)calloc(1, sizeof(DvzArenaPage));
+    page->data = (uint8_t*)calloc(DVZ_ARENA_PAGE_SIZE, 1);
+    page->dirty_first = DVZ_ARENA_PAGE_SIZE;
+    page->dirty_last = 0;
+
+    DvzRequest req = dvz_create_dat(
+        arena->batch, DVZ_BUFFER_TYPE_UNIFORM, DVZ_ARENA_PAGE_SIZE, DVZ_DAT_FLAGS_MAPPABLE);
+    dvz_batch_desc(arena->batch, "arena");
+    page->dat = req.id;
+
+    arena->pages[arena->page_count++] = page;
+    log_trace("create arena page #%d", arena->page_count - 1);
+    return page;
+}
+
+
+
+// Find a free region of a given size (multiple of the alignment) in a page.
+static bool _page_alloc(DvzArenaPage* page, DvzSize size, DvzSize* offset)
+{
+    ANN(page);
+    ANN(offset);
+
+    // First fit in the freed blocks.
+    DvzArenaBlock* block = NULL;
+    for (uint32_t i = 0; i < page->free_count; i++)
+    {
+        block = &page->free[i];
+        if (block->size < size)
+            continue;
+        *offset = block->offset;
+        block->offset += size;
+        block->size -= size;
+        if (block->size == 0)
+            page->free[i] = page->free[--page->free_count];
+        return true;
+    }
+
+    // Otherwise, at the end of the allocated region.
+    if (page->used + size <= DVZ_ARENA_PAGE_SIZE)
+    {
+        *offset = page->used;
+        page->used += size;
+        return true;
+    }
+    return false;
+}
+
+
+
+static void _page_free(DvzArenaPage* page, DvzSize offset, DvzSize size)
+{
+    ANN(page);
+    ASSERT(offset + size <= page->used);
+
+    // Merge the block with its free neighbors.
+    DvzArenaBlock* block = NULL;
+    for (uint32_t i = 0; i < page->free_count;)
+    {
+        block = &page->free[i];
+        if (block->offset + block->size == offset || offset + size == block->offset)
+        {
+            offset = MIN(offset, block->offset);
+            size += block->size;
+            page->free[i] = page->free[--page->free_count];
+            i = 0; // the merged block may now touch a block that was already checked
+            continue;
+        }
+        i++;
+    }
+
+    // Shrink the allocated region if the block is at its end.
+    if (offset + size == page->used)
+    {
+        page->used = offset;
+        return;
+    }
+
+    ASSERT(page->free_count < DVZ_ARENA_MAX_BLOCKS);
+    page->free[page->free_count++] = (DvzArenaBlock){.offset = offset, .size = size};
+}
+
+
+
+static void _arena_destroy(DvzArena* arena)
+{
+    ANN(arena);
+    log_trace("destroy arena with %d pages", arena->page_count);
+
+    // NOTE: the page dats are deleted with the other GPU objects when the renderer is destroyed.
+    for (uint32_t i = 0; i < arena->page_count; i++)
+    {
+        FREE(arena->pages[i]->data);
+        FREE(arena->pages[i]);
+    }
+    FREE(arena);
+}
+
+
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+DvzArena* dvz_arena(DvzBatch* batch)
+{
+    ANN(batch);
+
+    DvzArena* arena = (DvzArena*)calloc(1, sizeof(DvzArena));
+    arena->batch = batch;
+    return arena;
+}
+
+
+
+void dvz_arena_batch(DvzArena* arena, DvzBatch* batch)
+{
+    ANN(batch);
+    ASSERT(arena == NULL || arena->batch == batch);
+    batch->arena = arena;
+}
+
+
+
+DvzDual dvz_arena_dual(DvzArena* arena, DvzSize item_size)
+{
+    ANN(arena);
+    ASSERT(item_size > 0);
+
+    DvzDual dual = {0};
+    if (item_size > DVZ_ARENA_PAGE_SIZE)
+    {
+        log_error("uniform struct too large for the arena (%s)", pretty_size(item_size));
+        return dual;
+    }
+    DvzSize size = _block_size(item_size);
+
+    // Find a page with enough room, or create a new one.
+    DvzArenaPage* page = NULL;
+    DvzSize offset = 0;
+    bool found = false;
+    for (uint32_t i = 0; i < arena->page_count && !found; i++)
+    {
+        page = arena->pages[i];
+        found = _page_alloc(page, size, &offset);
+    }
+    if (!found)
+    {
+        page = _page_create(arena);
+        if (page == NULL)
+            return dual;
+        found = _page_alloc(page, size, &offset);
+    }
+    ANN(page);
+    ASSERT(found);
+    ASSERT(offset % DVZ_ARENA_ALIGNMENT == 0);
+
+    // The dual array points to the CPU copy of the page, so that the updates are written in place.
+    memset(&page->data[offset], 0, size);
+    DvzArray* array = dvz_array_struct(1, item_size);
+    FREE(array->data);
+    array->data = &page->data[offset];
+
+    dual = dvz_dual(arena->batch, array, page->dat);
+    dual.arena = arena;
+    dual.offset = offset;
+
+    arena->allocations++;
+    return dual;
+}
+
+
+
+void dvz_arena_dirty(DvzArena* arena, DvzId dat, DvzSize offset, DvzSize size)
+{
+    ANN(arena);
+    ASSERT(size > 0);
+
+    DvzArenaPage* page = _page(arena, dat);
+    if (page == NULL)
+        return;
+    ASSERT(offset + size <= DVZ_ARENA_PAGE_SIZE);
+
+    page->dirty_first = MIN(page->dirty_first, offset);
+    page->dirty_last = MAX(page->dirty_last, offset + size);
+}
+
+
+
+uint32_t dvz_arena_flush(DvzArena* arena)
+{
+    ANN(arena);
+    ANN(arena->batch);
+
+    uint32_t count = 0;
+    DvzArenaPage* page = NULL;
+    for (uint32_t i = 0; i < arena->page_count; i++)
+    {
+        page = arena->pages[i];
+        if (page->dirty_first >= page->dirty_last)
+            continue;
+
+        // A single upload request covering all modified uniforms of the page.
+        dvz_upload_dat(
+            arena->batch, page->dat, page->dirty_first, page->dirty_last - page->dirty_first,
+            &page->data[page->dirty_first], 0);
+        page->dirty_first = DVZ_ARENA_PAGE_SIZE;
+        page->dirty_last = 0;
+        count++;
+    }
+    return count;
+}
+
+
+
+void dvz_arena_free(DvzArena* arena, DvzId dat, DvzSize offset, DvzSize size)
+{
+    ANN(arena);
+
+    DvzArenaPage* page = _page(arena, dat);
+    if (page == NULL)
+        return;
+
+    _page_free(page, offset, _block_size(size));
+    ASSERT(arena->allocations > 0);
+    arena->allocations--;
+
+    if (arena->to_destroy && arena->allocations == 0)
+        _arena_destroy(arena);
+}
+
+
+
+void dvz_arena_destroy(DvzArena* arena)
+{
+    ANN(arena);
+
+    // NOTE: visuals are often destroyed after the scene, so the arena is only freed when its last
+    // suballocation is released.
+    if (arena->allocations > 0)
+    {
+        log_trace("defer arena destruction, %d live suballocations", arena->allocations);
+        arena->to_destroy = true;
+        return;
+    }
+    _arena_destroy(arena);
+}
@@ -15,7 +15,12 @@
 #include "scene/font.h"
 #include "scene/sdf.h"
 
+#include <algorithm>
 #include <fstream>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #pragma GCC diagnostic push
@@ -35,12 +40,185 @@ using namespace msdf_atlas;
 /*  Constants                                                                                    */
 /*************************************************************************************************/
 
+#define DVZ_ATLAS_SCALE        48.0 // minimum glyph scale, in pixels per em
+#define DVZ_ATLAS_PIXEL_RANGE  4.0
+#define DVZ_ATLAS_MITER_LIMIT  1.0
+#define DVZ_ATLAS_CORNER_ANGLE 3.0
+#define DVZ_ATLAS_INITIAL_SIZE 512 // size of an atlas created by dvz_atlas_insert()
+
 
 
 /*************************************************************************************************/
 /*  Utility functions                                                                            */
 /*************************************************************************************************/
 
+static void _dirty_union(DvzAtlas* atlas, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+    ANN(atlas);
+    if (atlas->dirty[2] <= atlas->dirty[0] || atlas->dirty[3] <= atlas->dirty[1])
+    {
+        atlas->dirty[0] = x0;
+        atlas->dirty[1] = y0;
+        atlas->dirty[2] = x1;
+        atlas->dirty[3] = y1;
+        return;
+    }
+    atlas->dirty[0] = MIN(atlas->dirty[0], x0);
+    atlas->dirty[1] = MIN(atlas->dirty[1], y0);
+    atlas->dirty[2] = MAX(atlas->dirty[2], x1);
+    atlas->dirty[3] = MAX(atlas->dirty[3], y1);
+}
+
+
+
+static void _dirty_clear(DvzAtlas* atlas)
+{
+    ANN(atlas);
+    memset(atlas->dirty, 0, sizeof(atlas->dirty));
+    atlas->resized = false;
+}
+
+
+
+// Rebuild the codepoint index and the skyline from the glyph boxes, after a full generation or
+// an import.
+static void _atlas_layout(DvzAtlas* atlas)
+{
+    ANN(atlas);
+
+    atlas->index.clear();
+    atlas->skyline.assign(atlas->width, 0);
+
+    // The bundle glyph boxes are expressed from the top of the bitmap.
+    for (uint32_t i = 0; i < atlas->bundle_count; i++)
+    {
+        const DvzAtlasBundleGlyph* glyph = &atlas->bundle_glyphs[i];
+        for (uint32_t col = glyph->x; col < glyph->x + glyph->w && col < atlas->width; col++)
+            atlas->skyline[col] = MAX(atlas->skyline[col], glyph->y + glyph->h);
+    }
+
+    int x = 0, y = 0, w = 0, h = 0;
+    for (uint32_t i = 0; i < atlas->glyphs.size(); i++)
+    {
+        const GlyphGeometry& glyph = atlas->glyphs[i];
+        atlas->index[(uint32_t)glyph.getCodepoint()] = i;
+
+        glyph.getBoxRect(x, y, w, h);
+        if (w <= 0 || h <= 0)
+            continue;
+        if (atlas->scale == 0)
+            atlas->scale = glyph.getBoxScale();
+
+        // The glyph boxes are expressed from the bottom of the bitmap.
+        uint32_t bottom = atlas->height - (uint32_t)y;
+        for (uint32_t col = (uint32_t)x; col < (uint32_t)(x + w) && col < atlas->width; col++)
+            atlas->skyline[col] = MAX(atlas->skyline[col], bottom);
+    }
+}
+
+
+
+// Make a copy of the bitmap if it is shared with a bundle, before modifying it.
+static void _atlas_own(DvzAtlas* atlas)
+{
+    ANN(atlas);
+    if (!atlas->rgb_shared)
+        return;
+    atlas->rgb = (uint8_t*)_cpy(atlas->width * atlas->height * 3, atlas->rgb);
+    atlas->rgb_shared = false;
+}
+
+
+
+static const DvzAtlasBundleGlyph* _bundle_glyph(DvzAtlas* atlas, uint32_t codepoint)
+{
+    ANN(atlas);
+    const DvzAtlasBundleGlyph* begin = atlas->bundle_glyphs;
+    const DvzAtlasBundleGlyph* end = begin + atlas->bundle_count;
+    const DvzAtlasBundleGlyph* it = std::lower_bound(
+        begin, end, codepoint,
+        [](const DvzAtlasBundleGlyph& g, uint32_t c) { return g.codepoint < c; });
+    return (it != end && it->codepoint == codepoint) ? it : NULL;
+}
+
+
+
+// The FreeType font used by msdfgen is only loaded when glyphs need to be generated.
+static FontHandle* _atlas_font(DvzAtlas* atlas)
+{
+    ANN(atlas);
+    if (atlas->font == NULL && atlas->ttf_bytes != NULL)
+    {
+        if (atlas->ft == NULL)
+            atlas->ft = initializeFreetype();
+        atlas->font = loadFontData(atlas->ft, atlas->ttf_bytes, (long)atlas->ttf_size);
+    }
+    return atlas->font;
+}
+
+
+
+// Find the lowest position of a box in the skyline, from the top of the bitmap. Return false if
+// the box is wider than the bitmap.
+static bool _skyline_fit(DvzAtlas* atlas, uint32_t w, uint32_t* out_x, uint32_t* out_y)
+{
+    ANN(atlas);
+    ANN(out_x);
+    ANN(out_y);
+
+    if (w > atlas->width)
+        return false;
+
+    uint32_t best_y = UINT32_MAX;
+    uint32_t best_x = 0;
+    for (uint32_t x = 0; x + w <= atlas->width; x++)
+    {
+        uint32_t y = *std::max_element(
+            atlas->skyline.begin() + (long)x, atlas->skyline.begin() + (long)(x + w));
+        if (y < best_y)
+        {
+            best_y = y;
+            best_x = x;
+        }
+    }
+    *out_x = best_x;
+    *out_y = best_y;
+    return true;
+}
+
+
+
+// Grow the bitmap height. The existing pixels keep their position from the top of the bitmap,
+// so the glyph boxes, expressed from the bottom, are shifted.
+static void _atlas_grow(DvzAtlas* atlas, uint32_t height)
+{
+    ANN(atlas);
+    ASSERT(height > atlas->height);
+
+    uint32_t dh = height - atlas->height;
+    log_debug("growing font atlas from %dx%d to %dx%d", //
+        atlas->width, atlas->height, atlas->width, height);
+
+    uint8_t* rgb = (uint8_t*)calloc(atlas->width * height, 3);
+    ANN(rgb);
+    if (atlas->rgb != NULL)
+    {
+        memcpy(rgb, atlas->rgb, atlas->width * atlas->height * 3);
+        FREE(atlas->rgb);
+    }
+    atlas->rgb = rgb;
+    atlas->height = height;
+
+    int x = 0, y = 0, w = 0, h = 0;
+    for (GlyphGeometry& glyph : atlas->glyphs)
+    {
+        glyph.getBoxRect(x, y, w, h);
+        if (w > 0 && h > 0)
+            glyph.placeBox(x, y + (int)dh);
+    }
+    atlas->resized = true;
+}
+
 
 
 /*************************************************************************************************/
@@ -67,6 +245,26 @@ extern "C" struct DvzAtlas
     uint32_t width;
     uint32_t height;
     uint8_t* rgb;
+
+    // Precompiled bundle, used in place: the bitmap is shared with the bundle until the first
+    // insertion.
+    const DvzAtlasBundleGlyph* bundle_glyphs;
+    uint32_t bundle_count;
+    bool rgb_shared;
+    void* mapped;
+    DvzSize mapped_size;
+
+    // Incremental insertion.
+    std::unordered_map<uint32_t, uint32_t> index; // glyph index of each codepoint
+    std::unordered_set<uint32_t> missing;         // codepoints absent from the font
+    std::vector<uint32_t> skyline; // filled height of each column, from the top of the bitmap
+    double scale;                  // glyph scale, fixed after the first generation
+    uint32_t thread_count;
+
+    // Region of the bitmap not uploaded to the texture yet, from the top of the bitmap.
+    uint32_t dirty[4]; // x0, y0, x1, y1
+    bool resized;
+    DvzId tex;
 };
 
 
@@ -77,9 +275,11 @@ extern "C" struct DvzAtlas
 
 DvzAtlas* dvz_atlas(unsigned long ttf_size, unsigned char* ttf_bytes)
 {
-    DvzAtlas* atlas = (DvzAtlas*)calloc(1, sizeof(DvzAtlas));
+    // NOTE: the struct contains C++ containers so it cannot be allocated with calloc.
+    DvzAtlas* atlas = new DvzAtlas();
     ANN(atlas);
 
+    atlas->thread_count = MAX(1u, std::thread::hardware_concurrency());
     atlas->ttf_size = ttf_size;
     atlas->ttf_bytes = ttf_bytes;
 
@@ -97,8 +297,19 @@ DvzAtlas* dvz_atlas(unsigned long ttf_size, unsigned char* ttf_bytes)
 void dvz_atlas_clear(DvzAtlas* atlas)
 {
     ANN(atlas);
-    auto glyphs = atlas->glyphs;
-    glyphs.clear();
+    atlas->glyphs.clear();
+    atlas->bundle_count = 0;
+    atlas->index.clear();
+    atlas->missing.clear();
+    atlas->skyline.assign(atlas->width, 0);
+}
+
+
+
+void dvz_atlas_threads(DvzAtlas* atlas, uint32_t thread_count)
+{
+    ANN(atlas);
+    atlas->thread_count = MAX(1u, thread_count);
 }
 
 
@@ -137,20 +348,23 @@ void dvz_atlas_string(DvzAtlas* atlas, const char* string)
 int dvz_atlas_glyph(DvzAtlas* atlas, uint32_t codepoint, vec4 out_coords)
 {
     ANN(atlas);
-    int x, y, w, h;
-    bool found = false;
-    for (const GlyphGeometry& glyph : atlas->glyphs)
+    const DvzAtlasBundleGlyph* bglyph = _bundle_glyph(atlas, codepoint);
+    if (bglyph != NULL)
     {
-        if ((uint32_t)glyph.getCodepoint() == codepoint)
-        {
-            glyph.getBoxRect(x, y, w, h);
-            found = true;
-            break;
-        }
+        out_coords[0] = (float)bglyph->x;
+        out_coords[1] = (float)bglyph->y;
+        out_coords[2] = (float)bglyph->w;
+        out_coords[3] = (float)bglyph->h;
+        return 0;
     }
-    if (!found)
+
+    auto it = atlas->index.find(codepoint);
+    if (it == atlas->index.end())
         return 1;
 
+    int x, y, w, h;
+    atlas->glyphs[it->second].getBoxRect(x, y, w, h);
+
     out_coords[0] = (float)x;
     out_coords[1] = (float)((int)atlas->height - h - y);
     out_coords[2] = (float)w;
@@ -210,7 +424,7 @@ void dvz_atlas_load(DvzAtlas* atlas)
     // The second argument can be ignored unless you mix different font sizes in one atlas.
     // In the last argument, you can specify a charset other than ASCII.
     // To load specific glyph indices, use loadGlyphs instead.
-    fontGeometry.loadCharset(atlas->font, 1.0, charset);
+    fontGeometry.loadCharset(_atlas_font(atlas), 1.0, charset);
 }
 
 
@@ -223,9 +437,8 @@ int dvz_atlas_generate(DvzAtlas* atlas)
     dvz_atlas_load(atlas);
 
     // Apply MSDF edge coloring. See edge-coloring.h for other coloring strategies.
-    const double maxCornerAngle = 3.0;
     for (GlyphGeometry& glyph : atlas->glyphs)
-        glyph.edgeColoring(&edgeColoringInkTrap, maxCornerAngle, 0);
+        glyph.edgeColoring(&edgeColoringInkTrap, DVZ_ATLAS_CORNER_ANGLE, 0);
 
     // TightAtlasPacker class computes the layout of the atlas.
     TightAtlasPacker packer;
@@ -235,11 +448,11 @@ int dvz_atlas_generate(DvzAtlas* atlas)
     packer.setDimensionsConstraint(DimensionsConstraint::SQUARE);
 
     // setScale for a fixed size or setMinimumScale to use the largest that fits
-    packer.setMinimumScale(48.0);
+    packer.setMinimumScale(DVZ_ATLAS_SCALE);
 
     // packer.setPadding(5.0);
-    packer.setPixelRange(4.0);
-    packer.setMiterLimit(1.0);
+    packer.setPixelRange(DVZ_ATLAS_PIXEL_RANGE);
+    packer.setMiterLimit(DVZ_ATLAS_MITER_LIMIT);
 
     // Compute atlas layout - pack glyphs
     packer.pack(atlas->glyphs.data(), atlas->glyphs.size());
@@ -263,7 +476,7 @@ int dvz_atlas_generate(DvzAtlas* atlas)
     // GeneratorAttributes can be modified to change the generator's default settings.
     GeneratorAttributes attributes;
     generator.setAttributes(attributes);
-    generator.setThreadCount(4);
+    generator.setThreadCount((int)atlas->thread_count);
 
     // Generate atlas bitmap
     generator.generate(atlas->glyphs.data(), atlas->glyphs.size());
@@ -282,28 +495,177 @@ int dvz_atlas_generate(DvzAtlas* atlas)
     ASSERT(size > 0);
 
     // Make a copy of the buffer in the DvzAtlas structure.
-    if (atlas->rgb != NULL)
+    if (atlas->rgb != NULL && !atlas->rgb_shared)
     {
         FREE(atlas->rgb);
     }
+    atlas->rgb_shared = false;
     atlas->rgb = (uint8_t*)malloc(size);
     ANN(atlas->rgb);
 
-    uint32_t x, y, u, i, j;
-    for (y = 0; y < h; y++)
+    // The msdfgen bitmap starts from the bottom: flip it row by row.
+    for (uint32_t y = 0; y < h; y++)
+        memcpy(&atlas->rgb[3 * (h - 1 - y) * w], &bitmap.pixels[3 * y * w], 3 * w);
+
+    // Keep the scale so that glyphs inserted later have the same size.
+    atlas->scale = packer.getScale();
+    _atlas_layout(atlas);
+    _dirty_union(atlas, 0, 0, w, h);
+    atlas->resized = true;
+
+    return 0;
+}
+
+
+
+int dvz_atlas_insert(DvzAtlas* atlas, uint32_t count, uint32_t* codepoints)
+{
+    ANN(atlas);
+    ANN(codepoints);
+
+    // Only keep the codepoints that are not in the atlas yet.
+    Charset charset;
+    std::unordered_set<uint32_t> requested;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t c = codepoints[i];
+        if (atlas->index.count(c) == 0 && atlas->missing.count(c) == 0 &&
+            _bundle_glyph(atlas, c) == NULL)
+        {
+            charset.add(c);
+            requested.insert(c);
+        }
+    }
+    if (requested.empty())
+        return 0;
+    if (_atlas_font(atlas) == NULL)
+    {
+        log_error("unable to insert glyphs in the font atlas, no font was specified");
+        return 0;
+    }
+
+    // The bitmap and the skyline of a bundle are only set up on the first insertion.
+    _atlas_own(atlas);
+    if (atlas->skyline.size() != atlas->width)
+        _atlas_layout(atlas);
+
+    // Start from an empty bitmap if the atlas has not been generated.
+    if (atlas->rgb == NULL)
+    {
+        atlas->width = DVZ_ATLAS_INITIAL_SIZE;
+        atlas->skyline.assign(atlas->width, 0);
+        atlas->height = 0;
+        _atlas_grow(atlas, DVZ_ATLAS_INITIAL_SIZE);
+    }
+    if (atlas->scale == 0)
+        atlas->scale = DVZ_ATLAS_SCALE;
+
+    // Load the new glyphs only.
+    std::vector<GlyphGeometry> glyphs;
+    FontGeometry fontGeometry(&glyphs);
+    fontGeometry.loadCharset(atlas->font, 1.0, charset);
+    for (GlyphGeometry& glyph : glyphs)
+    {
+        requested.erase((uint32_t)glyph.getCodepoint());
+        glyph.edgeColoring(&edgeColoringInkTrap, DVZ_ATLAS_CORNER_ANGLE, 0);
+    }
+    for (uint32_t c : requested)
     {
-        for (x = 0; x < w; x++)
+        log_warn("code point %d not found in the font", c);
+        atlas->missing.insert(c);
+    }
+    if (glyphs.empty())
+        return 0;
+
+    // Compute the glyph box sizes at the atlas scale. The packer positions are discarded.
+    TightAtlasPacker packer;
+    packer.setDimensionsConstraint(DimensionsConstraint::SQUARE);
+    packer.setScale(atlas->scale);
+    packer.setPixelRange(DVZ_ATLAS_PIXEL_RANGE);
+    packer.setMiterLimit(DVZ_ATLAS_MITER_LIMIT);
+    packer.pack(glyphs.data(), (int)glyphs.size());
+
+    // Place the glyphs in the free space above the skyline, growing the bitmap if needed.
+    uint32_t n = (uint32_t)glyphs.size();
+    std::vector<uint32_t> pos(2 * n, 0); // x, y of each glyph, from the top of the bitmap
+    uint32_t x0 = UINT32_MAX, y0 = UINT32_MAX, x1 = 0, y1 = 0;
+    int w = 0, h = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        glyphs[i].getBoxSize(w, h);
+        if (w <= 0 || h <= 0)
+            continue;
+
+        uint32_t x = 0, y = 0;
+        if (!_skyline_fit(atlas, (uint32_t)w, &x, &y))
         {
-            i = 3 * (y * w + x);
-            j = 3 * ((h - 1 - y) * w + (x));
+            log_error("glyph %d is too large for the font atlas", glyphs[i].getCodepoint());
+            continue;
+        }
+        if (y + (uint32_t)h > atlas->height)
+            _atlas_grow(atlas, MAX(2 * atlas->height, y + (uint32_t)h));
+        for (uint32_t col = x; col < x + (uint32_t)w; col++)
+            atlas->skyline[col] = y + (uint32_t)h;
+
+        pos[2 * i + 0] = x;
+        pos[2 * i + 1] = y;
+        x0 = MIN(x0, x);
+        y0 = MIN(y0, y);
+        x1 = MAX(x1, x + (uint32_t)w);
+        y1 = MAX(y1, y + (uint32_t)h);
+    }
 
-            for (u = 0; u < 3; u++)
+    if (x1 > x0 && y1 > y0)
+    {
+        // Generate the new glyphs in a bitmap covering their region only, in parallel.
+        uint32_t rw = x1 - x0;
+        uint32_t rh = y1 - y0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            glyphs[i].getBoxSize(w, h);
+            if (w > 0 && h > 0)
+                glyphs[i].placeBox(
+                    (int)(pos[2 * i] - x0), (int)rh - (int)(pos[2 * i + 1] - y0) - h);
+        }
+
+        ImmediateAtlasGenerator<float, 3, &msdfGenerator, BitmapAtlasStorage<byte, 3>> generator(
+            (int)rw, (int)rh);
+        GeneratorAttributes attributes;
+        generator.setAttributes(attributes);
+        generator.setThreadCount((int)atlas->thread_count);
+        generator.generate(glyphs.data(), (int)n);
+        BitmapConstRef<unsigned char, 3> bitmap = generator.atlasStorage();
+
+        // Copy each glyph box in the atlas bitmap, flipped, and move the box to its final place.
+        uint32_t aw = atlas->width;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            glyphs[i].getBoxSize(w, h);
+            if (w <= 0 || h <= 0)
+                continue;
+            uint32_t x = pos[2 * i + 0];
+            uint32_t y = pos[2 * i + 1];
+            for (uint32_t row = 0; row < (uint32_t)h; row++)
             {
-                atlas->rgb[j + u] = bitmap.pixels[i + u];
+                uint32_t src_row = rh - 1 - (y - y0 + row);
+                memcpy(
+                    &atlas->rgb[3 * ((y + row) * aw + x)],
+                    &bitmap.pixels[3 * (src_row * rw + (x - x0))], 3 * (uint32_t)w);
             }
+            glyphs[i].placeBox((int)x, (int)(atlas->height - y) - h);
         }
+        _dirty_union(atlas, x0, y0, x1, y1);
     }
-    return 0;
+
+    // Register the new glyphs.
+    for (GlyphGeometry& glyph : glyphs)
+    {
+        atlas->index[(uint32_t)glyph.getCodepoint()] = (uint32_t)atlas->glyphs.size();
+        atlas->glyphs.push_back(glyph);
+    }
+
+    log_debug("inserted %d glyphs in the font atlas", n);
+    return (int)n;
 }
 
 
@@ -382,11 +744,67 @@ DvzId dvz_atlas_texture(DvzAtlas* atlas, DvzBatch* batch)
     dvz_upload_tex(batch, tex, DVZ_ZERO_OFFSET, shape, size, rgba, 0);
     FREE(rgba);
 
+    atlas->tex = tex;
+    _dirty_clear(atlas);
+
     return tex;
 }
 
 
 
+int dvz_atlas_upload(DvzAtlas* atlas, DvzBatch* batch)
+{
+    ANN(atlas);
+    ANN(batch);
+
+    if (atlas->tex == DVZ_ID_NONE)
+    {
+        log_error("unable to upload the atlas, call dvz_atlas_texture() first");
+        return 1;
+    }
+
+    // The texture is resized and uploaded entirely when the bitmap has grown.
+    uint32_t aw = atlas->width;
+    if (atlas->resized)
+    {
+        uvec3 shape = {aw, atlas->height, 1};
+        dvz_resize_tex(batch, atlas->tex, shape);
+        _dirty_union(atlas, 0, 0, aw, atlas->height);
+    }
+
+    uint32_t x0 = atlas->dirty[0], y0 = atlas->dirty[1];
+    uint32_t x1 = atlas->dirty[2], y1 = atlas->dirty[3];
+    if (x1 <= x0 || y1 <= y0)
+        return 0;
+
+    // Only upload the dirty region, converted to RGBA.
+    uint32_t w = x1 - x0;
+    uint32_t h = y1 - y0;
+    uint8_t* rgba = (uint8_t*)malloc(w * h * 4);
+    ANN(rgba);
+    for (uint32_t y = 0; y < h; y++)
+    {
+        const uint8_t* src = &atlas->rgb[3 * ((y0 + y) * aw + x0)];
+        uint8_t* dst = &rgba[4 * y * w];
+        for (uint32_t x = 0; x < w; x++)
+        {
+            dst[4 * x + 0] = src[3 * x + 0];
+            dst[4 * x + 1] = src[3 * x + 1];
+            dst[4 * x + 2] = src[3 * x + 2];
+            dst[4 * x + 3] = 255;
+        }
+    }
+    uvec3 offset = {x0, y0, 0};
+    uvec3 shape = {w, h, 1};
+    dvz_upload_tex(batch, atlas->tex, offset, shape, w * h * 4, rgba, 0);
+    FREE(rgba);
+
+    _dirty_clear(atlas);
+    return 0;
+}
+
+
+
 void dvz_atlas_destroy(DvzAtlas* atlas)
 {
     ANN(atlas);
@@ -395,14 +813,159 @@ void dvz_atlas_destroy(DvzAtlas* atlas)
     {
         FREE(atlas->codepoints);
     }
-    if (atlas->rgb != NULL)
+    if (atlas->rgb != NULL && !atlas->rgb_shared)
     {
         FREE(atlas->rgb);
     }
+    if (atlas->mapped != NULL)
+    {
+        dvz_unmap_file(atlas->mapped, atlas->mapped_size);
+    }
 
-    destroyFont(atlas->font);
-    deinitializeFreetype(atlas->ft);
-    FREE(atlas);
+    if (atlas->font != NULL)
+        destroyFont(atlas->font);
+    if (atlas->ft != NULL)
+        deinitializeFreetype(atlas->ft);
+    delete atlas;
+}
+
+
+
+/*************************************************************************************************/
+/*  Bundle functions                                                                             */
+/*************************************************************************************************/
+
+DvzAtlas*
+dvz_atlas_bundle(unsigned long ttf_size, unsigned char* ttf_bytes, DvzSize size, void* bundle)
+{
+    ANN(bundle);
+
+    // Check the header and the extent of the sections, nothing else is read.
+    const uint8_t* bytes = (const uint8_t*)bundle;
+    const DvzAtlasBundleHeader* header = (const DvzAtlasBundleHeader*)bytes;
+    if (size < sizeof(DvzAtlasBundleHeader) || header->magic != DVZ_ATLAS_BUNDLE_MAGIC)
+    {
+        log_error("invalid font atlas bundle");
+        return NULL;
+    }
+    if (header->version != DVZ_ATLAS_BUNDLE_VERSION)
+    {
+        log_error(
+            "unsupported font atlas bundle version %d (expected %d)", header->version,
+            DVZ_ATLAS_BUNDLE_VERSION);
+        return NULL;
+    }
+    DvzSize rgb_size = (DvzSize)header->width * header->height * 3;
+    if (header->glyphs_offset + header->glyph_count * sizeof(DvzAtlasBundleGlyph) > size ||
+        header->rgb_offset + rgb_size > size || rgb_size == 0)
+    {
+        log_error("truncated font atlas bundle");
+        return NULL;
+    }
+
+    DvzAtlas* atlas = new DvzAtlas();
+    ANN(atlas);
+    atlas->thread_count = MAX(1u, std::thread::hardware_concurrency());
+    atlas->ttf_size = ttf_size;
+    atlas->ttf_bytes = ttf_bytes;
+
+    atlas->width = header->width;
+    atlas->height = header->height;
+    atlas->scale = header->scale;
+    atlas->bundle_glyphs = (const DvzAtlasBundleGlyph*)(bytes + header->glyphs_offset);
+    atlas->bundle_count = header->glyph_count;
+    atlas->rgb = (uint8_t*)(bytes + header->rgb_offset);
+    atlas->rgb_shared = true;
+
+    return atlas;
+}
+
+
+
+DvzAtlas*
+dvz_atlas_bundle_file(unsigned long ttf_size, unsigned char* ttf_bytes, const char* path)
+{
+    ANN(path);
+
+    DvzSize size = 0;
+    void* mapped = dvz_map_file(path, &size);
+    if (mapped == NULL)
+        return NULL;
+
+    DvzAtlas* atlas = dvz_atlas_bundle(ttf_size, ttf_bytes, size, mapped);
+    if (atlas == NULL)
+    {
+        dvz_unmap_file(mapped, size);
+        return NULL;
+    }
+    atlas->mapped = mapped;
+    atlas->mapped_size = size;
+    log_debug("mapped font atlas bundle %s (%s)", path, pretty_size(size));
+    return atlas;
+}
+
+
+
+int dvz_atlas_bundle_export(DvzAtlas* atlas, const char* path)
+{
+    ANN(atlas);
+    ANN(path);
+
+    if (!dvz_atlas_valid(atlas))
+    {
+        log_error("unable to export the atlas bundle, the atlas has not been created yet");
+        return 1;
+    }
+
+    // Glyph table, sorted by codepoint for lookups by binary search.
+    std::vector<DvzAtlasBundleGlyph> table;
+    table.reserve(atlas->bundle_count + atlas->glyphs.size());
+    for (uint32_t i = 0; i < atlas->bundle_count; i++)
+        table.push_back(atlas->bundle_glyphs[i]);
+    vec4 coords = {0};
+    for (const GlyphGeometry& glyph : atlas->glyphs)
+    {
+        uint32_t codepoint = (uint32_t)glyph.getCodepoint();
+        if (dvz_atlas_glyph(atlas, codepoint, coords) != 0)
+            continue;
+        DvzAtlasBundleGlyph entry = {};
+        entry.codepoint = codepoint;
+        entry.x = (uint32_t)coords[0];
+        entry.y = (uint32_t)coords[1];
+        entry.w = (uint32_t)coords[2];
+        entry.h = (uint32_t)coords[3];
+        table.push_back(entry);
+    }
+    auto by_codepoint = [](const DvzAtlasBundleGlyph& a, const DvzAtlasBundleGlyph& b) {
+        return a.codepoint < b.codepoint;
+    };
+    std::sort(table.begin(), table.end(), by_codepoint);
+
+    DvzAtlasBundleHeader header = {};
+    header.magic = DVZ_ATLAS_BUNDLE_MAGIC;
+    header.version = DVZ_ATLAS_BUNDLE_VERSION;
+    header.glyph_count = (uint32_t)table.size();
+    header.width = atlas->width;
+    header.height = atlas->height;
+    header.scale = atlas->scale;
+    header.glyphs_offset = sizeof(DvzAtlasBundleHeader);
+    header.rgb_offset = header.glyphs_offset + table.size() * sizeof(DvzAtlasBundleGlyph);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        log_error("unable to open %s for writing", path);
+        return 1;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(
+        reinterpret_cast<const char*>(table.data()),
+        (std::streamsize)(table.size() * sizeof(DvzAtlasBundleGlyph)));
+    file.write(reinterpret_cast<const char*>(atlas->rgb), (std::streamsize)dvz_atlas_size(atlas));
+    file.close();
+
+    log_debug("wrote font atlas bundle %s with %d glyphs", path, header.glyph_count);
+    return file.good() ? 0 : 1;
 }
 
 
@@ -504,7 +1067,7 @@ deserializeDvzAtlas(DvzAtlas& atlas, unsigned long atlas_size, unsigned char* at
     if (atlas.codepoints_count > 0)
     {
         log_trace("reading %d code points", atlas.codepoints_count);
-        atlas.codepoints = new uint32_t[atlas.codepoints_count];
+        atlas.codepoints = (uint32_t*)calloc(atlas.codepoints_count, sizeof(uint32_t));
         for (uint32_t i = 0; i < atlas.codepoints_count; ++i)
         {
             readBytes(&atlas.codepoints[i], sizeof(uint32_t));
@@ -517,6 +1080,11 @@ deserializeDvzAtlas(DvzAtlas& atlas, unsigned long atlas_size, unsigned char* at
     for (uint32_t i = 0; i < glyphs_count; ++i)
     {
         readBytes(&atlas.glyphs[i], sizeof(GlyphGeometry));
+
+        // The serialized contours point to the memory of the exporting process: reset them
+        // without destroying them, so that the glyphs can be copied and destroyed safely.
+        Shape& shape = const_cast<Shape&>(atlas.glyphs[i].getShape());
+        new (&shape.contours) std::vector<Contour>();
     }
 
     // Deserialize the atlas bitmap dimensions.
@@ -532,9 +1100,14 @@ deserializeDvzAtlas(DvzAtlas& atlas, unsigned long atlas_size, unsigned char* at
         throw std::runtime_error("Buffer overflow detected");
     }
     log_trace("reading %d pixels", bitmap_size);
-    atlas.rgb = new uint8_t[bitmap_size];
+    atlas.rgb = (uint8_t*)malloc(bitmap_size);
+    ANN(atlas.rgb);
     readBytes(atlas.rgb, bitmap_size);
 
+    // NOTE: the glyph shapes are lost, but the boxes are enough to insert new glyphs at the same
+    // scale.
+    _atlas_layout(&atlas);
+
     log_debug("done deserialization of font atlas");
 }
 
@@ -586,7 +1159,30 @@ DvzAtlasFont dvz_atlas_import(const char* font_name, const char* atlas_name)
     // Create the font.
     DvzFont* font = dvz_font(ttf_size, ttf_bytes);
 
-    // Create the atlas.
+    DvzAtlasFont af = {};
+    af.ttf_size = ttf_size;
+    af.ttf_bytes = ttf_bytes;
+    af.font = font;
+
+    // Use the precompiled bundle generated at build time if there is one, as it is mapped
+    // without parsing.
+    char path[1024] = {0};
+    const char* bundle_dir = getenv("DVZ_ATLAS_DIR");
+#ifdef ATLAS_DIR
+    if (bundle_dir == NULL)
+        bundle_dir = ATLAS_DIR;
+#endif
+    if (bundle_dir != NULL)
+    {
+        snprintf(
+            path, sizeof(path), "%s/%s%s", bundle_dir, font_name, DVZ_ATLAS_BUNDLE_EXTENSION);
+        if (std::ifstream(path).good())
+            af.atlas = dvz_atlas_bundle_file(ttf_size, ttf_bytes, path);
+        if (af.atlas != NULL)
+            return af;
+    }
+
+    // Otherwise, deserialize the atlas embedded in the library.
     DvzAtlas* atlas = dvz_atlas(ttf_size, ttf_bytes);
 
     // Load the atlas image bytes.
@@ -598,10 +1194,6 @@ DvzAtlasFont dvz_atlas_import(const char* font_name, const char* atlas_name)
 
     deserializeDvzAtlas(*atlas, atlas_size, atlas_bytes);
 
-    DvzAtlasFont af = {};
-    af.ttf_size = ttf_size;
-    af.ttf_bytes = ttf_bytes;
     af.atlas = atlas;
-    af.font = font;
     return af;
 }
@@ -8,7 +8,9 @@
 /*************************************************************************************************/
 
 #include "scene/axes.h"
+#include "_list.h"
 #include "_macros.h"
+#include "scene/panzoom.h"
 #include "scene/axis.h"
 #include "scene/labels.h"
 #include "scene/scene.h"
@@ -27,6 +29,7 @@
 // TODO: customizable parameters
 #define DVZ_AXES_FONT_SIZE          24
 #define DVZ_AXES_DEFAULT_TICK_COUNT 8
+#define DVZ_AXES_LINK_EPS           1e-5 // relative tolerance on the range of linked panels
 
 
 
@@ -114,30 +117,6 @@ static void axis_vertical_pos(DvzAxis* axis, float y0, float y1, vec3 p0, vec3 p
     glm_vec3_copy((vec3){1, 0, 0}, vector);
 }
 
-// NOTE: the caller must FREE the output.
-static char* concatenate_strings(
-    uint32_t glyph_count, uint32_t tick_count, char* string_labels, uint32_t* index)
-{
-    // Replace the concatenation of null-terminated strings by space-terminated strings,
-    // to call freetype only once.
-    uint32_t buffer_size = glyph_count + tick_count; // all glyphs + 1 space per glyph
-    char* glyphs = (char*)calloc(buffer_size, sizeof(char));
-    memcpy(glyphs, string_labels, buffer_size);
-    // Replace the null termination by a space, except for the last group.
-    uint32_t idx = 0;
-    for (uint32_t i = 1; i < tick_count; i++)
-    {
-        idx = index[i];
-        ASSERT(idx >= 1);
-        idx--;
-        // This character should be a null termination.
-        ASSERT(glyphs[idx] == 0);
-        // We replace it by a space.
-        glyphs[idx] = ' ';
-    }
-    return glyphs;
-}
-
 static bool
 compute_ticks(DvzAxes* axes, DvzTicksFlags which, double dmin, double dmax, float vmin, float vmax)
 {
@@ -145,7 +124,7 @@ compute_ticks(DvzAxes* axes, DvzTicksFlags which, double dmin, double dmax, floa
 
     bool horizontal = which == DVZ_TICKS_HORIZONTAL;
 
-    log_error("compute axis %d: %f %f, %f %f", !horizontal, dmin, dmax, vmin, vmax);
+    log_trace("compute axis %d: %f %f, %f %f", !horizontal, dmin, dmax, vmin, vmax);
 
     DvzAxis* axis = horizontal ? axes->xaxis : axes->yaxis;
     DvzTicks* ticks = horizontal ? axes->xticks : axes->yticks;
@@ -174,7 +153,7 @@ compute_ticks(DvzAxes* axes, DvzTicksFlags which, double dmin, double dmax, floa
     if (!has_changed)
         return false;
 
-    log_info("ticks have changed, updating tick visual");
+    log_trace("ticks have changed, updating tick visual");
 
     // Get the calculated number of ticks and lmin, lmax, lstep.
     uint32_t tick_count = dvz_ticks_range(ticks, &lmin, &lmax, &lstep);
@@ -197,10 +176,8 @@ compute_ticks(DvzAxes* axes, DvzTicksFlags which, double dmin, double dmax, floa
     uint32_t* length = dvz_labels_length(labels);
     double* values = dvz_labels_values(labels);
 
-    // Replace the concatenation of null-terminated strings by space-terminated strings,
-    // to call freetype only once.
-    char* glyphs = concatenate_strings(glyph_count, tick_count, string_labels, index);
-
+    // NOTE: the labels are laid out by the axis from the index and length arrays, the null
+    // terminations between the labels are skipped.
     {
         // char* exponent = dvz_labels_exponent(labels); // NOTE: unused for now
         // char* offset = dvz_labels_offset(labels); // NOTE: unused for now
@@ -208,9 +185,9 @@ compute_ticks(DvzAxes* axes, DvzTicksFlags which, double dmin, double dmax, floa
         // // DEBUG.
         // dvz_labels_print(labels);
         // printf("glyphs:\n");
-        // for (uint32_t i = 0; i < buffer_size; i++)
+        // for (uint32_t i = 0; i < glyph_count + tick_count; i++)
         // {
-        //     printf("%d %c | ", glyphs[i], glyphs[i]);
+        //     printf("%d %c | ", string_labels[i], string_labels[i]);
         // }
         // printf("\nindex:\n");
         // for (uint32_t i = 0; i < tick_count; i++)
@@ -230,21 +207,168 @@ compute_ticks(DvzAxes* axes, DvzTicksFlags which, double dmin, double dmax, floa
     }
 
     DvzTickSpec spec = dvz_tick_spec(
-        p0, p1, vector, dmin, dmax, tick_count, values, glyph_count, glyphs, index, length);
+        p0, p1, vector, dmin, dmax, tick_count, values, glyph_count, string_labels, index,
+        length);
     dvz_axis_ticks(axis, &spec);
 
-    FREE(glyphs);
+    return true;
+}
 
+
+
+// Get (if range is zero) or set the pan and zoom range of a panel along one dimension.
+static bool panel_range(DvzPanel* panel, bool xdim, vec2 range)
+{
+    ANN(panel);
+    if (panel->panzoom == NULL)
+        return false;
+    if (xdim)
+        dvz_panzoom_xrange(panel->panzoom, range);
+    else
+        dvz_panzoom_yrange(panel->panzoom, range);
     return true;
 }
 
 
 
+static bool range_changed(DvzPanel* panel, bool xdim, vec2 last)
+{
+    ANN(panel);
+    vec2 range = {0};
+    if (!panel_range(panel, xdim, range))
+        return false;
+    // NOTE: a range set on a panel is not read back exactly, it is stored as a pan and zoom.
+    float eps = DVZ_AXES_LINK_EPS * (fabsf(last[0]) + fabsf(last[1]));
+    return fabsf(range[0] - last[0]) > eps || fabsf(range[1] - last[1]) > eps;
+}
+
+
+
+static inline bool is_linked(DvzAxes* follower, DvzAxes* source, bool xdim)
+{
+    ANN(follower);
+    return (xdim ? follower->xsource : follower->ysource) == source;
+}
+
+
+
+// Synchronize the pan and zoom of the panels linked along one dimension, in a single pass. The
+// range to propagate is the one of the panel that changed since the last synchronization, which
+// is looked for in the caller panel first, then in the source panel and its followers, so that
+// the result does not depend on the order in which the axes are updated.
+static void sync_range(DvzAxes* source, DvzAxes* caller, bool xdim)
+{
+    ANN(source);
+    ANN(caller);
+
+    float* last = xdim ? source->xlinked : source->ylinked;
+    uint32_t n = (uint32_t)dvz_list_count(source->followers);
+    DvzAxes* follower = NULL;
+
+    DvzPanel* leader = NULL;
+    if (range_changed(caller->panel, xdim, last))
+        leader = caller->panel;
+    else if (range_changed(source->panel, xdim, last))
+        leader = source->panel;
+    for (uint32_t i = 0; i < n && leader == NULL; i++)
+    {
+        follower = (DvzAxes*)dvz_list_get(source->followers, i).p;
+        if (is_linked(follower, source, xdim) && range_changed(follower->panel, xdim, last))
+            leader = follower->panel;
+    }
+    if (leader == NULL)
+        return;
+
+    vec2 range = {0};
+    panel_range(leader, xdim, range);
+    last[0] = range[0];
+    last[1] = range[1];
+
+    if (source->panel != leader && panel_range(source->panel, xdim, range))
+        dvz_panel_update(source->panel);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        follower = (DvzAxes*)dvz_list_get(source->followers, i).p;
+        if (!is_linked(follower, source, xdim) || follower->panel == leader)
+            continue;
+        if (panel_range(follower->panel, xdim, range))
+            dvz_panel_update(follower->panel);
+    }
+}
+
+
+
+static void build_dirty(DvzPanel* panel)
+{
+    ANN(panel);
+    ANN(panel->figure);
+    log_debug("axes reallocated, rebuilding the command buffers");
+    dvz_atomic_set(panel->figure->viewset->status, (int)DVZ_BUILD_DIRTY);
+}
+
+
+
+// The shared axes only need to follow the item counts of the source visuals.
+static void sync_followers(DvzAxes* axes)
+{
+    ANN(axes);
+
+    uint32_t n = (uint32_t)dvz_list_count(axes->followers);
+    DvzAxes* follower = NULL;
+    bool resized = false;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        follower = (DvzAxes*)dvz_list_get(axes->followers, i).p;
+        ANN(follower);
+
+        resized = false;
+        if (follower->xsource == axes)
+        {
+            dvz_axis_update(follower->xaxis);
+            resized |= follower->xaxis->resized;
+        }
+        if (follower->ysource == axes)
+        {
+            dvz_axis_update(follower->yaxis);
+            resized |= follower->yaxis->resized;
+        }
+        if (resized)
+            build_dirty(follower->panel);
+    }
+}
+
+
+
+// Start the synchronization of a new follower from the pan and zoom of its source.
+static void link_range(DvzAxes* source, DvzAxes* follower, bool xdim)
+{
+    ANN(source);
+    ANN(follower);
+
+    float* last = xdim ? source->xlinked : source->ylinked;
+    vec2 range = {0};
+    if (!panel_range(source->panel, xdim, range))
+        return;
+    last[0] = range[0];
+    last[1] = range[1];
+    if (panel_range(follower->panel, xdim, range))
+        dvz_panel_update(follower->panel);
+}
+
+
+
 /*************************************************************************************************/
 /*  Axes functions                                                                               */
 /*************************************************************************************************/
 
 DvzAxes* dvz_axes(DvzPanel* panel, int flags)
+{
+    return dvz_axes_linked(panel, NULL, NULL, flags);
+}
+
+
+
+DvzAxes* dvz_axes_linked(DvzPanel* panel, DvzAxes* xsource, DvzAxes* ysource, int flags)
 {
     ANN(panel);
     ANN(panel->figure);
@@ -253,36 +377,71 @@ DvzAxes* dvz_axes(DvzPanel* panel, int flags)
     DvzBatch* batch = panel->figure->scene->batch;
     ANN(batch);
 
+    // NOTE: the sources cannot be linked themselves, so that the ticks of a dimension are always
+    // computed by a single axes object, and that the links cannot form cycles.
+    if ((xsource != NULL && (xsource->xsource != NULL || xsource->ysource != NULL)) ||
+        (ysource != NULL && (ysource->xsource != NULL || ysource->ysource != NULL)))
+    {
+        log_error("unable to link axes to axes that are linked themselves");
+        return NULL;
+    }
+
     DvzAxes* axes = (DvzAxes*)calloc(1, sizeof(DvzAxes));
     axes->panel = panel;
     axes->flags = flags;
+    axes->followers = dvz_list();
+
+    axes->xsource = xsource;
+    axes->ysource = ysource;
+    if (xsource != NULL)
+        dvz_list_append(xsource->followers, (DvzListItem){.p = axes});
+    if (ysource != NULL && ysource != xsource)
+        dvz_list_append(ysource->followers, (DvzListItem){.p = axes});
+
+    // Axis visuals, ticks and labels. The linked dimensions have no ticks and labels of their own.
+    // NOTE: axes flags passed to axis visual flags
+    if (xsource != NULL)
+    {
+        axes->xaxis = dvz_axis_shared(xsource->xaxis);
+    }
+    else
+    {
+        axes->xaxis = dvz_axis(batch, flags);
+        axes->xticks = dvz_ticks(0);
+        axes->xlabels = dvz_labels();
+        axis_common_params(axes->xaxis);
+    }
 
-    // Axis visuals.
-    axes->xaxis = dvz_axis(batch, flags); // NOTE: axes flags passed to axis visual flags
-    axes->yaxis = dvz_axis(batch, flags);
-
-    // Ticks.
-    axes->xticks = dvz_ticks(0);
-    axes->yticks = dvz_ticks(0);
-
-    // Labels.
-    axes->xlabels = dvz_labels();
-    axes->ylabels = dvz_labels();
+    if (ysource != NULL)
+    {
+        axes->yaxis = dvz_axis_shared(ysource->yaxis);
+    }
+    else
+    {
+        axes->yaxis = dvz_axis(batch, flags);
+        axes->yticks = dvz_ticks(0);
+        axes->ylabels = dvz_labels();
+        axis_common_params(axes->yaxis);
+    }
 
     // Set the viewport size.
     dvz_axes_resize(axes);
 
-    // Common parameters.
-    axis_common_params(axes->xaxis);
-    axis_common_params(axes->yaxis);
-
     // Axis-specific parameters.
     axis_horizontal_params(axes->xaxis);
     axis_vertical_params(axes->yaxis);
 
     // Initial.
-    compute_ticks(axes, DVZ_TICKS_HORIZONTAL, -1, 1, -1, 1);
-    compute_ticks(axes, DVZ_TICKS_VERTICAL, -1, 1, -1, 1);
+    if (xsource == NULL)
+        compute_ticks(axes, DVZ_TICKS_HORIZONTAL, -1, 1, -1, 1);
+    if (ysource == NULL)
+        compute_ticks(axes, DVZ_TICKS_VERTICAL, -1, 1, -1, 1);
+
+    // Start from the pan and zoom of the sources.
+    if (xsource != NULL)
+        link_range(xsource, axes, true);
+    if (ysource != NULL)
+        link_range(ysource, axes, false);
 
     // TODO: margins.
     dvz_panel_margins(panel, 20, 20, 120, 120);
@@ -317,6 +476,12 @@ void dvz_axes_xget(DvzAxes* axes, dvec2 range_data, vec2 range_ndc)
     ANN(axes);
     ANN(axes->panel);
 
+    if (axes->xsource != NULL)
+    {
+        dvz_axes_xget(axes->xsource, range_data, range_ndc);
+        return;
+    }
+
     DvzMVP* mvp = dvz_transform_mvp(axes->panel->transform);
     dvz_axis_mvp(axes->xaxis, mvp, range_data, range_ndc);
 }
@@ -328,6 +493,12 @@ void dvz_axes_yget(DvzAxes* axes, dvec2 range_data, vec2 range_ndc)
     ANN(axes);
     ANN(axes->panel);
 
+    if (axes->ysource != NULL)
+    {
+        dvz_axes_yget(axes->ysource, range_data, range_ndc);
+        return;
+    }
+
     DvzMVP* mvp = dvz_transform_mvp(axes->panel->transform);
     dvz_axis_mvp(axes->yaxis, mvp, range_data, range_ndc);
 }
@@ -338,6 +509,11 @@ bool dvz_axes_xset(DvzAxes* axes, dvec2 range_data, vec2 range_ndc)
 {
     // TODO: set the MVP so that the visible range is the one specified, given the ref
     ANN(axes);
+    if (axes->xsource != NULL)
+    {
+        log_error("the x axis is linked, its ticks must be set on the source axes");
+        return false;
+    }
     return compute_ticks(
         axes, DVZ_TICKS_HORIZONTAL, //
         range_data[0], range_data[1], range_ndc[0], range_ndc[1]);
@@ -349,6 +525,11 @@ bool dvz_axes_yset(DvzAxes* axes, dvec2 range_data, vec2 range_ndc)
 {
     // TODO: set the MVP so that the visible range is the one specified, given the ref
     ANN(axes);
+    if (axes->ysource != NULL)
+    {
+        log_error("the y axis is linked, its ticks must be set on the source axes");
+        return false;
+    }
     return compute_ticks(
         axes, DVZ_TICKS_VERTICAL, //
         range_data[0], range_data[1], range_ndc[0], range_ndc[1]);
@@ -368,8 +549,10 @@ void dvz_axes_resize(DvzAxes* axes)
     DvzView* view = panel->view;
     ANN(view);
 
-    dvz_ticks_size(axes->xticks, view->shape[0], DVZ_AXES_FONT_SIZE);
-    dvz_ticks_size(axes->yticks, view->shape[1], DVZ_AXES_FONT_SIZE);
+    if (axes->xticks != NULL)
+        dvz_ticks_size(axes->xticks, view->shape[0], DVZ_AXES_FONT_SIZE);
+    if (axes->yticks != NULL)
+        dvz_ticks_size(axes->yticks, view->shape[1], DVZ_AXES_FONT_SIZE);
 }
 
 
@@ -377,7 +560,35 @@ void dvz_axes_resize(DvzAxes* axes)
 void dvz_axes_update(DvzAxes* axes)
 {
     ANN(axes);
-    log_error("calling axes update()");
+    log_trace("calling axes update()");
+
+    // Linked dimensions: the pan and zoom of the linked panels are synchronized, and the source
+    // axes compute the ticks once. The sources are not linked themselves, so this does not recurse
+    // more than once.
+    DvzAxes* xsource = axes->xsource;
+    DvzAxes* ysource = axes->ysource;
+    if (xsource != NULL)
+    {
+        sync_range(xsource, axes, true);
+        dvz_axes_update(xsource);
+    }
+    if (ysource != NULL)
+    {
+        sync_range(ysource, axes, false);
+        if (ysource != xsource)
+            dvz_axes_update(ysource);
+    }
+    if (xsource != NULL && ysource != NULL)
+        return;
+
+    // Source axes: synchronize the linked panels along the shared dimensions.
+    if (dvz_list_count(axes->followers) > 0)
+    {
+        if (xsource == NULL)
+            sync_range(axes, axes, true);
+        if (ysource == NULL)
+            sync_range(axes, axes, false);
+    }
 
     // Compute the currently visible range.
     dvec2 xrange = {0};
@@ -386,23 +597,32 @@ void dvz_axes_update(DvzAxes* axes)
     vec2 xrange_ndc = {0};
     vec2 yrange_ndc = {0};
 
-    dvz_axes_xget(axes, xrange, xrange_ndc);
-    dvz_axes_yget(axes, yrange, yrange_ndc);
-
     // Use the current viewport size in the axes before the computation of the ticks.
     dvz_axes_resize(axes);
 
     // Compute the ticks and update the visuals if the ticks have changed.
-    bool xupdate = dvz_axes_xset(axes, xrange, xrange_ndc);
-    bool yupdate = dvz_axes_xset(axes, yrange, yrange_ndc);
+    bool xupdate = false, yupdate = false;
+    if (xsource == NULL)
+    {
+        dvz_axes_xget(axes, xrange, xrange_ndc);
+        xupdate = dvz_axes_xset(axes, xrange, xrange_ndc);
+    }
+    if (ysource == NULL)
+    {
+        dvz_axes_yget(axes, yrange, yrange_ndc);
+        yupdate = dvz_axes_yset(axes, yrange, yrange_ndc);
+    }
+
+    // NOTE: the shared axis visuals follow the source visuals even if the ticks have not changed.
+    sync_followers(axes);
     if (!xupdate && !yupdate)
         return;
 
-    log_error("axes update required!");
-    dvz_axis_update(axes->xaxis);
-    dvz_axis_update(axes->yaxis);
-
-    dvz_atomic_set(axes->panel->figure->viewset->status, (int)DVZ_BUILD_DIRTY);
+    // NOTE: dvz_axis_ticks() only uploads the dirty ranges of the visuals, the command buffers
+    // only need to be rebuilt when the visuals were reallocated (the draw counts changed).
+    bool resized = (xupdate && axes->xaxis->resized) || (yupdate && axes->yaxis->resized);
+    if (resized)
+        build_dirty(axes->panel);
 }
 
 
@@ -411,6 +631,15 @@ void dvz_axes_destroy(DvzAxes* axes)
 {
     ANN(axes);
 
+    // NOTE: the linked axes must be destroyed before their sources.
+    if (dvz_list_count(axes->followers) > 0)
+        log_error("destroying axes that are still linked to other axes");
+    dvz_list_destroy(axes->followers);
+    if (axes->xsource != NULL)
+        dvz_list_remove_pointer(axes->xsource->followers, axes);
+    if (axes->ysource != NULL && axes->ysource != axes->xsource)
+        dvz_list_remove_pointer(axes->ysource->followers, axes);
+
     if (axes->xaxis)
         dvz_axis_destroy(axes->xaxis);
     if (axes->yaxis)
@@ -12,7 +12,9 @@
 #include "scene/atlas.h"
 #include "scene/colormaps.h"
 #include "scene/font.h"
+#include "scene/params.h"
 #include "scene/scene.h"
+#include "scene/visual.h"
 #include "scene/visuals/glyph.h"
 #include "scene/visuals/segment.h"
 
@@ -27,56 +29,172 @@
 
 
 /*************************************************************************************************/
-/*  Allocation functions                                                                         */
+/*  Slot functions                                                                               */
 /*************************************************************************************************/
 
-static inline uint32_t _tick_count(DvzAxis* axis)
+// The glyph and segment visuals are allocated with a capacity of `slot_count` ticks, and are only
+// reallocated when a tick spec has more ticks than that. Tick slot s owns the glyphs
+// [s * DVZ_AXIS_LABEL_LENGTH, (s + 1) * DVZ_AXIS_LABEL_LENGTH) of the label it holds, whereas the
+// segments follow the tick order: the major tick i is segment i, whatever its slot, and the minor
+// ticks of the interval following the tick i are stored after all `slot_count` major ticks.
+// Unused glyphs have a zero size, unused segments have a transparent color.
+
+static inline uint32_t _minor_tick_count(uint32_t tick_count)
+{
+    return tick_count > 0 ? (tick_count - 1) * MINOR_TICKS_PER_INTERVAL : 0;
+}
+
+
+
+static inline uint32_t _segment_count(uint32_t slot_count)
+{
+    return slot_count + _minor_tick_count(slot_count);
+}
+
+
+
+static inline void _hide_glyphs(DvzAxis* axis, uint32_t slot, uint32_t slot_count)
 {
     ANN(axis);
-    ANN(axis->segment);
-    return axis->segment->item_count;
+    if (slot_count == 0)
+        return;
+
+    uint32_t count = slot_count * DVZ_AXIS_LABEL_LENGTH;
+    vec2* size = (vec2*)calloc(count, sizeof(vec2));
+    dvz_glyph_size(axis->glyph, slot * DVZ_AXIS_LABEL_LENGTH, count, size, 0);
+    FREE(size);
+
+    for (uint32_t s = slot; s < slot + slot_count; s++)
+        axis->slot_length[s] = 0;
 }
 
 
 
-static inline uint32_t _glyph_count(DvzAxis* axis)
+static inline void set_segment_color(DvzAxis* axis, uint32_t tick_count)
 {
     ANN(axis);
-    ANN(axis->glyph);
-    return axis->glyph->item_count;
+
+    DvzVisual* segment = axis->segment;
+    ANN(segment);
+
+    uint32_t n_major = axis->slot_count;
+    uint32_t n_total = _segment_count(n_major);
+    uint32_t n_minor = _minor_tick_count(tick_count);
+
+    // Colors of the visible major and minor ticks, the other segments are transparent.
+    cvec4* colors = (cvec4*)calloc(n_total, sizeof(cvec4));
+    for (uint32_t i = 0; i < tick_count; i++)
+    {
+        memcpy(colors[i], axis->color_major, sizeof(cvec4));
+    }
+    for (uint32_t i = 0; i < n_minor; i++)
+    {
+        memcpy(colors[n_major + i], axis->color_minor, sizeof(cvec4));
+    }
+
+    dvz_segment_color(segment, 0, n_total, colors, 0);
+    FREE(colors);
 }
 
 
 
-static inline uint32_t _minor_tick_count(uint32_t tick_count)
+static inline void set_segment_width(DvzAxis* axis)
 {
-    return (tick_count - 1) * MINOR_TICKS_PER_INTERVAL;
+    ANN(axis);
+
+    DvzVisual* segment = axis->segment;
+    ANN(segment);
+
+    uint32_t n_major = axis->slot_count;
+    uint32_t n_total = _segment_count(n_major);
+
+    // Widths of the major and minor ticks.
+    float* width = (float*)calloc(n_total, sizeof(float));
+    for (uint32_t i = 0; i < n_total; i++)
+    {
+        width[i] = axis->tick_width[i < n_major ? 2 : 3]; // major or minor
+    }
+
+    dvz_segment_linewidth(segment, 0, n_total, width, 0);
+    FREE(width);
 }
 
 
 
-static inline void
-set_groups(DvzAxis* axis, uint32_t glyph_count, uint32_t tick_count, uint32_t* group_size)
+static inline void set_glyph_style(DvzAxis* axis)
 {
     ANN(axis);
-    ANN(group_size);
-    ANN(axis->glyph);
-    ANN(axis->segment);
 
+    DvzVisual* glyph = axis->glyph;
+    ANN(glyph);
+
+    uint32_t glyph_count = axis->slot_count * DVZ_AXIS_LABEL_LENGTH;
     ASSERT(glyph_count > 0);
-    ASSERT(tick_count > 0);
-    ASSERT(glyph_count >= tick_count);
 
-    _check_groups(glyph_count, tick_count, group_size);
+    // NOTE: the axis currently only supports a uniform vec2 anchor.
+    vec2* anchors = (vec2*)_repeat(glyph_count, sizeof(vec2), (void*)axis->anchor);
+    dvz_glyph_anchor(glyph, 0, glyph_count, anchors, 0);
+    FREE(anchors);
+
+    cvec4* colors = (cvec4*)_repeat(glyph_count, sizeof(cvec4), (void*)axis->color_glyph);
+    dvz_glyph_color(glyph, 0, glyph_count, colors, 0);
+    FREE(colors);
+}
+
+
+
+static void set_style(DvzAxis* axis)
+{
+    ANN(axis);
+
+    set_glyph_style(axis);
+    set_segment_width(axis);
+    set_segment_color(axis, axis->tick_count);
 
-    dvz_visual_groups(axis->glyph, tick_count, group_size);
+    // The font size or the offset may have changed: all labels need to be laid out again.
+    _hide_glyphs(axis, 0, axis->slot_count);
+
+    axis->style_dirty = false;
+}
 
-    uint32_t n_major = axis->glyph->group_count;
-    uint32_t n_minor = _minor_tick_count(n_major);
-    uint32_t n_total = n_major + n_minor;
 
-    dvz_segment_alloc(axis->segment, n_total);
+
+static void set_slots(DvzAxis* axis, uint32_t slot_count)
+{
+    ANN(axis);
+    ANN(axis->glyph);
+    ANN(axis->segment);
+    ASSERT(slot_count > 0);
+
+    log_debug("allocate %d axis tick slots", slot_count);
+
+    FREE(axis->slot_value);
+    FREE(axis->slot_length);
+    FREE(axis->slot_codepoints);
+    FREE(axis->tick_slot);
+
+    uint32_t glyph_count = slot_count * DVZ_AXIS_LABEL_LENGTH;
+    axis->slot_count = slot_count;
+    axis->slot_value = (double*)calloc(slot_count, sizeof(double));
+    axis->slot_length = (uint32_t*)calloc(slot_count, sizeof(uint32_t));
+    axis->slot_codepoints = (uint32_t*)calloc(glyph_count, sizeof(uint32_t));
+    axis->tick_slot = (uint32_t*)calloc(slot_count, sizeof(uint32_t));
+    axis->tick_count = 0;
+
+    // One glyph group per slot, the width of each label is passed with the groupsize attribute.
+    uint32_t label_length = DVZ_AXIS_LABEL_LENGTH;
+    uint32_t* group_size =
+        (uint32_t*)_repeat(slot_count, sizeof(uint32_t), (void*)&label_length);
+    dvz_visual_groups(axis->glyph, slot_count, group_size);
+    FREE(group_size);
+
+    dvz_segment_alloc(axis->segment, _segment_count(slot_count));
     dvz_glyph_alloc(axis->glyph, glyph_count);
+
+    set_style(axis);
+
+    axis->resized = true;
+    axis->stats.reallocs++;
 }
 
 
@@ -85,16 +203,12 @@ set_groups(DvzAxis* axis, uint32_t glyph_count, uint32_t tick_count, uint32_t* g
 /*  Tick computation                                                                             */
 /*************************************************************************************************/
 
-static inline vec3*
-make_tick_positions(DvzAxis* axis, double dmin, double dmax, double* values, vec3 p0, vec3 p1)
+static inline vec3* make_tick_positions(
+    uint32_t tick_count, double dmin, double dmax, double* values, vec3 p0, vec3 p1)
 {
-    ANN(axis);
     ANN(values);
-    ANN(axis->glyph);
     ASSERT(dmin < dmax);
 
-    uint32_t tick_count = axis->glyph->group_count;
-
     // axis->p0 corresponds to axis->dmin
     // axis->p1 corresponds to axis->dmax
     double denom = 1. / (dmax - dmin);
@@ -126,26 +240,26 @@ make_tick_positions(DvzAxis* axis, double dmin, double dmax, double* values, vec
 /*  Tick functions                                                                               */
 /*************************************************************************************************/
 
-static inline void set_segment_pos(DvzAxis* axis, vec3* positions)
+static inline void set_segment_pos(DvzAxis* axis, uint32_t tick_count, vec3* positions)
 {
     ANN(axis);
-    ANN(axis->glyph);
 
     DvzVisual* segment = axis->segment;
     ANN(segment);
 
-    uint32_t n_major = axis->glyph->group_count;
-    uint32_t n_minor = _minor_tick_count(n_major);
-    uint32_t n_total = n_major + n_minor;
+    uint32_t n_major = tick_count;
+    uint32_t n_minor = _minor_tick_count(tick_count);
+    if (n_major == 0)
+        return;
 
-    // Concatenation of major and minor ticks.
-    vec3* pos = (vec3*)calloc(n_total, sizeof(vec3));
-    memcpy(pos, positions, n_major * sizeof(vec3));
+    dvz_segment_position(segment, 0, n_major, positions, positions, 0);
+    if (n_minor == 0)
+        return;
 
-    // Generate the minor ticks.
+    // Generate the minor ticks, stored after all major tick slots.
     uint32_t major = 0;
     uint32_t minor = 0;
-    vec3* target = &pos[n_major];
+    vec3* pos = (vec3*)calloc(n_minor, sizeof(vec3));
     float dx = (positions[1][0] - positions[0][0]) / (MINOR_TICKS_PER_INTERVAL + 1);
     float dy = (positions[1][1] - positions[0][1]) / (MINOR_TICKS_PER_INTERVAL + 1);
     float dz = (positions[1][2] - positions[0][2]) / (MINOR_TICKS_PER_INTERVAL + 1);
@@ -153,57 +267,28 @@ static inline void set_segment_pos(DvzAxis* axis, vec3* positions)
     {
         major = i / MINOR_TICKS_PER_INTERVAL;
         minor = i % MINOR_TICKS_PER_INTERVAL;
-        target[i][0] = positions[major][0] + (minor + 1) * dx;
-        target[i][1] = positions[major][1] + (minor + 1) * dy;
-        target[i][2] = positions[major][2] + (minor + 1) * dz;
+        pos[i][0] = positions[major][0] + (minor + 1) * dx;
+        pos[i][1] = positions[major][1] + (minor + 1) * dy;
+        pos[i][2] = positions[major][2] + (minor + 1) * dz;
     }
 
-    dvz_segment_position(segment, 0, n_total, pos, pos, 0);
+    dvz_segment_position(segment, axis->slot_count, n_minor, pos, pos, 0);
     FREE(pos);
 }
 
 
 
-static inline void set_segment_color(DvzAxis* axis)
+static inline void set_segment_shift(DvzAxis* axis, uint32_t tick_count)
 {
     ANN(axis);
-    ANN(axis->glyph);
 
     DvzVisual* segment = axis->segment;
     ANN(segment);
 
-    uint32_t n_major = axis->glyph->group_count;
-    uint32_t n_minor = _minor_tick_count(n_major);
-    uint32_t n_total = n_major + n_minor;
-
-    // Colors of the major and minor ticks.
-    cvec4* colors = (cvec4*)calloc(n_total, sizeof(cvec4));
-    for (uint32_t i = 0; i < n_major; i++)
-    {
-        memcpy(colors[i], axis->color_major, sizeof(cvec4));
-    }
-    for (uint32_t i = 0; i < n_minor; i++)
-    {
-        memcpy(colors[n_major + i], axis->color_minor, sizeof(cvec4));
-    }
-
-    dvz_segment_color(segment, 0, n_total, colors, 0);
-    FREE(colors);
-}
-
-
-
-static inline void set_segment_shift(DvzAxis* axis)
-{
-    ANN(axis);
-    ANN(axis->glyph);
-
-    DvzVisual* segment = axis->segment;
-    ANN(segment);
-
-    uint32_t n_major = axis->glyph->group_count;
-    uint32_t n_minor = _minor_tick_count(n_major);
-    uint32_t n_total = n_major + n_minor;
+    uint32_t n_major = tick_count;
+    uint32_t n_minor = _minor_tick_count(tick_count);
+    if (n_major == 0)
+        return;
 
     // Vector pointing from p0 to p1.
     vec3 u = {0};
@@ -233,49 +318,25 @@ static inline void set_segment_shift(DvzAxis* axis)
     float minor_length = axis->tick_length[3];
 
     // Major and minor ticks.
-    vec4* shift = (vec4*)calloc(n_total, sizeof(vec4));
+    vec4* shift = (vec4*)calloc(MAX(n_major, n_minor), sizeof(vec4));
     for (uint32_t i = 0; i < n_major; i++)
     {
         shift[i][2] = a * major_length;
         shift[i][3] = b * major_length;
     }
-    for (uint32_t i = 0; i < n_minor; i++)
-    {
-        shift[n_major + i][2] = a * minor_length;
-        shift[n_major + i][3] = b * minor_length;
-    }
     // NOTE: this only works in 2D. In 3D, need to use end positions and shift=0.
-    dvz_segment_shift(segment, 0, n_total, shift, 0);
-    FREE(shift);
-}
-
-
-
-static inline void set_segment_width(DvzAxis* axis)
-{
-    ANN(axis);
-    ANN(axis->glyph);
+    dvz_segment_shift(segment, 0, n_major, shift, 0);
 
-    DvzVisual* segment = axis->segment;
-    ANN(segment);
-
-    uint32_t n_major = axis->glyph->group_count;
-    uint32_t n_minor = _minor_tick_count(n_major);
-    uint32_t n_total = n_major + n_minor;
-
-    // Widths of the major and minor ticks.
-    float* width = (float*)calloc(n_total, sizeof(float));
-    for (uint32_t i = 0; i < n_major; i++)
+    if (n_minor > 0)
     {
-        width[i] = axis->tick_width[2]; // major
-    }
-    for (uint32_t i = 0; i < n_minor; i++)
-    {
-        width[n_major + i] = axis->tick_width[3]; // minor
+        for (uint32_t i = 0; i < n_minor; i++)
+        {
+            shift[i][2] = a * minor_length;
+            shift[i][3] = b * minor_length;
+        }
+        dvz_segment_shift(segment, axis->slot_count, n_minor, shift, 0);
     }
-
-    dvz_segment_linewidth(segment, 0, n_total, width, 0);
-    FREE(width);
+    FREE(shift);
 }
 
 
@@ -284,114 +345,209 @@ static inline void set_segment_width(DvzAxis* axis)
 /*  Glyph functions                                                                              */
 /*************************************************************************************************/
 
-// NOTE: size of positions array is group_count=tick_count
-static inline void set_glyph_pos(DvzAxis* axis, vec3* positions)
+static inline bool _slot_match(
+    DvzAxis* axis, uint32_t slot, double value, double tol, uint32_t length, uint32_t* codepoints)
 {
     ANN(axis);
+    return axis->slot_length[slot] == length && fabs(axis->slot_value[slot] - value) <= tol &&
+           memcmp(
+               &axis->slot_codepoints[slot * DVZ_AXIS_LABEL_LENGTH], codepoints,
+               length * sizeof(uint32_t)) == 0;
+}
 
-    DvzVisual* glyph = axis->glyph;
-    ANN(glyph);
 
-    uint32_t glyph_count = glyph->item_count;
-    uint32_t group_count = glyph->group_count;
-    uint32_t* group_size = glyph->group_sizes;
 
-    ASSERT(glyph_count > 0);
-    ASSERT(group_count > 0);
-    ANN(group_size);
-    ANN(positions);
+static inline void set_slot_label(
+    DvzAxis* axis, uint32_t slot, double value, uint32_t length, uint32_t* codepoints,
+    vec4* xywh)
+{
+    ANN(axis);
+    ASSERT(slot < axis->slot_count);
+    ASSERT(length <= DVZ_AXIS_LABEL_LENGTH);
+
+    uint32_t first = slot * DVZ_AXIS_LABEL_LENGTH;
+    axis->slot_value[slot] = value;
+    axis->slot_length[slot] = length;
+    memcpy(&axis->slot_codepoints[first], codepoints, length * sizeof(uint32_t));
+
+    // Size and shift of the glyphs, the remaining glyphs of the slot are hidden.
+    vec2 size[DVZ_AXIS_LABEL_LENGTH] = {0};
+    vec2 shift[DVZ_AXIS_LABEL_LENGTH] = {0};
+    float width = 0;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        size[i][0] = xywh[i][2];
+        size[i][1] = xywh[i][3];
+        shift[i][0] = xywh[i][0] + axis->offset[0];
+        shift[i][1] = xywh[i][1] + axis->offset[1];
+        width += size[i][0];
+    }
+    dvz_glyph_size(axis->glyph, first, DVZ_AXIS_LABEL_LENGTH, size, 0);
+    dvz_glyph_shift(axis->glyph, first, DVZ_AXIS_LABEL_LENGTH, shift, 0);
 
-    vec3* pos =
-        _repeat_group(sizeof(vec3), glyph_count, group_count, group_size, (void*)positions, false);
-    dvz_glyph_position(glyph, 0, glyph_count, pos, 0);
-    FREE(pos);
+    // We need to pass the label width to each glyph, so that the vertex shader can compute the
+    // displacement in pixels, relative to the label width (the coefficient is the anchor).
+    float* groupsize = (float*)_repeat(DVZ_AXIS_LABEL_LENGTH, sizeof(float), (void*)&width);
+    dvz_glyph_groupsize(axis->glyph, first, DVZ_AXIS_LABEL_LENGTH, groupsize, 0);
+    FREE(groupsize);
+
+    if (length > 0)
+        dvz_glyph_codepoints(axis->glyph, first, length, codepoints, 0);
 }
 
 
 
-static inline void set_glyph_anchor(DvzAxis* axis)
+static void set_labels(DvzAxis* axis)
 {
+    // NOTE: the spec glyphs are the concatenation of all tick labels, without trailing zeros.
     ANN(axis);
 
-    DvzVisual* glyph = axis->glyph;
-    ANN(glyph);
-
-    uint32_t glyph_count = glyph->item_count;
-    ASSERT(glyph_count > 0);
+    DvzTickSpec* spec = &axis->tick_spec;
+    uint32_t n = spec->tick_count;
+    uint32_t slot_count = axis->slot_count;
+    ASSERT(n <= slot_count);
+    ANN(spec->glyphs);
+    ANN(spec->index);
+    ANN(spec->length);
+
+    // Tolerance when comparing the tick values, relative to the visible range.
+    double tol = 1e-9 * fabs(spec->dmax - spec->dmin);
+
+    // Truncated codepoints of each tick label.
+    uint32_t* lengths = (uint32_t*)calloc(n, sizeof(uint32_t));
+    uint32_t* codepoints = (uint32_t*)calloc(n * DVZ_AXIS_LABEL_LENGTH, sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; i++)
+    {
+        lengths[i] = MIN(spec->length[i], DVZ_AXIS_LABEL_LENGTH);
+        if (spec->length[i] > DVZ_AXIS_LABEL_LENGTH)
+            log_warn(
+                "axis tick label truncated from %d to %d glyphs", spec->length[i],
+                DVZ_AXIS_LABEL_LENGTH);
+        for (uint32_t j = 0; j < lengths[i]; j++)
+            codepoints[i * DVZ_AXIS_LABEL_LENGTH + j] =
+                (uint32_t)(unsigned char)spec->glyphs[spec->index[i] + j];
+    }
 
-    // NOTE: the axis currently only supports a uniform vec2 anchor.
-    vec2* anchors = (vec2*)_repeat(glyph_count, sizeof(vec2), (void*)axis->anchor);
-    dvz_glyph_anchor(glyph, 0, glyph_count, anchors, 0);
-    FREE(anchors);
-}
+    // Reuse the slots whose label is still visible: their glyphs are left untouched.
+    bool* used = (bool*)calloc(slot_count, sizeof(bool));
+    uint32_t missing = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        axis->tick_slot[i] = UINT32_MAX;
+        for (uint32_t s = 0; s < slot_count && lengths[i] > 0; s++)
+        {
+            if (!used[s] && _slot_match(
+                                axis, s, spec->values[i], tol, lengths[i],
+                                &codepoints[i * DVZ_AXIS_LABEL_LENGTH]))
+            {
+                axis->tick_slot[i] = s;
+                used[s] = true;
+                axis->stats.labels_reused++;
+                break;
+            }
+        }
+        if (axis->tick_slot[i] == UINT32_MAX)
+            missing++;
+    }
 
+    // Lay out the new labels in one call, and write them in the free slots, preferring the
+    // empty ones over the slots of the labels that just scrolled out.
+    if (missing > 0)
+    {
+        uint32_t* new_lengths = (uint32_t*)calloc(missing, sizeof(uint32_t));
+        uint32_t* new_codepoints =
+            (uint32_t*)calloc(missing * DVZ_AXIS_LABEL_LENGTH, sizeof(uint32_t));
+        uint32_t glyph_count = 0;
+        uint32_t k = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            if (axis->tick_slot[i] != UINT32_MAX)
+                continue;
+            new_lengths[k++] = lengths[i];
+            memcpy(
+                &new_codepoints[glyph_count], &codepoints[i * DVZ_AXIS_LABEL_LENGTH],
+                lengths[i] * sizeof(uint32_t));
+            glyph_count += lengths[i];
+        }
+        vec4* xywh = glyph_count > 0
+                         ? dvz_font_layouts(axis->font, missing, new_lengths, new_codepoints)
+                         : NULL;
 
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            if (axis->tick_slot[i] != UINT32_MAX)
+                continue;
+
+            uint32_t slot = UINT32_MAX;
+            for (uint32_t s = 0; s < slot_count; s++)
+            {
+                if (used[s])
+                    continue;
+                if (slot == UINT32_MAX || axis->slot_length[s] == 0)
+                    slot = s;
+                if (axis->slot_length[s] == 0)
+                    break;
+            }
+            ASSERT(slot < slot_count);
+
+            set_slot_label(
+                axis, slot, spec->values[i], lengths[i], &codepoints[i * DVZ_AXIS_LABEL_LENGTH],
+                xywh != NULL ? &xywh[offset] : NULL);
+            offset += lengths[i];
+            axis->tick_slot[i] = slot;
+            used[slot] = true;
+            axis->stats.labels_created++;
+        }
+        ASSERT(offset == glyph_count);
 
-static inline void set_glyph_color(DvzAxis* axis)
-{
-    ANN(axis);
+        FREE(xywh);
+        FREE(new_lengths);
+        FREE(new_codepoints);
+    }
 
-    uint32_t glyph_count = axis->glyph->item_count;
-    ASSERT(glyph_count > 0);
-    DvzVisual* glyph = axis->glyph;
+    // Hide the labels that are no longer visible.
+    for (uint32_t s = 0; s < slot_count; s++)
+    {
+        if (!used[s] && axis->slot_length[s] > 0)
+            _hide_glyphs(axis, s, 1);
+    }
 
-    // NOTE: the axis currently only supports a uniform vec2 anchor.
-    cvec4* colors = (cvec4*)_repeat(glyph_count, sizeof(cvec4), (void*)axis->color_glyph);
-    dvz_glyph_color(glyph, 0, glyph_count, colors, 0);
-    FREE(colors);
+    FREE(used);
+    FREE(lengths);
+    FREE(codepoints);
 }
 
 
 
-static inline void set_glyphs(DvzAxis* axis, const char* glyphs, uint32_t* index)
+// NOTE: size of positions array is tick_count
+static inline void set_glyph_pos(DvzAxis* axis, uint32_t tick_count, vec3* positions)
 {
-    // NOTE: glyphs is the concatenation of all group strings, without trailing zeros
     ANN(axis);
-    ANN(glyphs);
-    ANN(index);
-
-    // Set the size and shift properties of the glyph vsual by using the font to compute the
-    // layout.
-    vec4* xywh = dvz_font_ascii(axis->font, glyphs);
+    ANN(positions);
+    if (tick_count == 0)
+        return;
 
-    uint32_t glyph_count = axis->glyph->item_count;
-    uint32_t group_count = axis->glyph->group_count;
-    uint32_t* group_size = axis->glyph->group_sizes;
-    ASSERT(glyph_count > 0);
-    ASSERT(group_count > 0);
-    ANN(group_size);
-
-    // Prepare a copy of the string with all glyphs concatenated, but without the spaces
-    // between the groups.
-    vec4* xywh_trimmed = (vec4*)calloc(glyph_count, sizeof(vec4));
-    char* glyphs_trimmed = (char*)calloc(glyph_count, sizeof(char));
-
-    float x0 = 0.0;
-    uint32_t idx = 0;
-    uint32_t k = 0;
-    for (uint32_t i = 0; i < group_count; i++)
+    // Only upload the span of the slots used by the visible ticks.
+    uint32_t smin = UINT32_MAX, smax = 0;
+    for (uint32_t i = 0; i < tick_count; i++)
     {
-        idx = index[i];
-        x0 = xywh[idx][0];
-        for (uint32_t j = 0; j < group_size[i]; j++)
-        {
-            // NOTE: remove the x0 offset for each group.
-            xywh_trimmed[k][0] = xywh[idx + j][0] - x0;
-            xywh_trimmed[k][1] = xywh[idx + j][1];
-            xywh_trimmed[k][2] = xywh[idx + j][2];
-            xywh_trimmed[k][3] = xywh[idx + j][3];
-
-            glyphs_trimmed[k] = glyphs[idx + j];
-            k++;
-        }
+        smin = MIN(smin, axis->tick_slot[i]);
+        smax = MAX(smax, axis->tick_slot[i]);
     }
-    ASSERT(k == glyph_count);
-
-    dvz_glyph_xywh(axis->glyph, 0, glyph_count, xywh_trimmed, axis->offset, 0);
-    FREE(xywh);
+    ASSERT(smin <= smax);
+    ASSERT(smax < axis->slot_count);
 
-    dvz_glyph_ascii(axis->glyph, glyphs_trimmed);
-    FREE(glyphs_trimmed);
+    uint32_t count = (smax - smin + 1) * DVZ_AXIS_LABEL_LENGTH;
+    vec3* pos = (vec3*)calloc(count, sizeof(vec3));
+    for (uint32_t i = 0; i < tick_count; i++)
+    {
+        uint32_t first = (axis->tick_slot[i] - smin) * DVZ_AXIS_LABEL_LENGTH;
+        for (uint32_t j = 0; j < DVZ_AXIS_LABEL_LENGTH; j++)
+            glm_vec3_copy(positions[i], pos[first + j]);
+    }
+    dvz_glyph_position(axis->glyph, smin * DVZ_AXIS_LABEL_LENGTH, count, pos, 0);
+    FREE(pos);
 }
 
 
@@ -425,6 +581,38 @@ DvzAxis* dvz_axis(DvzBatch* batch, int flags)
 
 
 
+DvzAxis* dvz_axis_shared(DvzAxis* source)
+{
+    ANN(source);
+    ANN(source->glyph);
+    ANN(source->segment);
+    ASSERT(source->source == NULL);
+
+    DvzBatch* batch = source->glyph->batch;
+    ANN(batch);
+
+    DvzAxis* axis = (DvzAxis*)calloc(1, sizeof(DvzAxis));
+    axis->flags = source->flags;
+    axis->source = source;
+
+    axis->segment = dvz_segment(batch, 0);
+    axis->glyph = dvz_glyph(batch, 0);
+
+    // No atlas and font: the glyphs are laid out by the source axis, the glyph visual only needs
+    // its atlas texture and parameters.
+    ASSERT(source->glyph->texs[3] != DVZ_ID_NONE);
+    ANN(source->glyph->params[2]);
+    dvz_glyph_texture(axis->glyph, source->glyph->texs[3]);
+    dvz_params_bind(source->glyph->params[2], axis->glyph->graphics_id, 2);
+
+    // Bind the vertex and index buffers of the source visuals.
+    dvz_axis_update(axis);
+
+    return axis;
+}
+
+
+
 DvzVisual* dvz_axis_segment(DvzAxis* axis)
 {
     ANN(axis);
@@ -467,6 +655,18 @@ void dvz_axis_update(DvzAxis* axis)
 {
     ANN(axis);
 
+    // A shared axis has no data of its own, it only follows the item counts of its source.
+    DvzAxis* source = axis->source;
+    if (source != NULL)
+    {
+        axis->resized = (axis->segment->item_count != source->segment->item_count) ||
+                        (axis->glyph->item_count != source->glyph->item_count);
+        dvz_visual_share(axis->segment, source->segment);
+        dvz_visual_share(axis->glyph, source->glyph);
+        axis->tick_count = source->tick_count;
+        return;
+    }
+
     dvz_visual_update(axis->segment);
     dvz_visual_update(axis->glyph);
 }
@@ -480,8 +680,16 @@ void dvz_axis_destroy(DvzAxis* axis)
     dvz_visual_destroy(axis->segment);
     dvz_visual_destroy(axis->glyph);
 
-    dvz_atlas_destroy(axis->atlas);
-    dvz_font_destroy(axis->font);
+    // NOTE: shared axes have no atlas and font.
+    if (axis->atlas != NULL)
+        dvz_atlas_destroy(axis->atlas);
+    if (axis->font != NULL)
+        dvz_font_destroy(axis->font);
+
+    FREE(axis->slot_value);
+    FREE(axis->slot_length);
+    FREE(axis->slot_codepoints);
+    FREE(axis->tick_slot);
 
     FREE(axis);
 }
@@ -497,8 +705,10 @@ void dvz_axis_size(DvzAxis* axis, float font_size)
     ANN(axis);
     DvzVisual* glyph = axis->glyph;
     ANN(glyph);
+    ANN(axis->font);
 
     dvz_font_size(axis->font, font_size);
+    axis->style_dirty = true;
 }
 
 
@@ -510,6 +720,7 @@ void dvz_axis_width(DvzAxis* axis, float lim, float grid, float major, float min
     axis->tick_width[1] = grid;
     axis->tick_width[2] = major;
     axis->tick_width[3] = minor;
+    axis->style_dirty = true;
 }
 
 
@@ -521,6 +732,7 @@ void dvz_axis_length(DvzAxis* axis, float lim, float grid, float major, float mi
     axis->tick_length[1] = grid;
     axis->tick_length[2] = major;
     axis->tick_length[3] = minor;
+    axis->style_dirty = true;
 }
 
 
@@ -533,6 +745,7 @@ void dvz_axis_color(DvzAxis* axis, cvec4 glyph, cvec4 lim, cvec4 grid, cvec4 maj
     memcpy(axis->color_grid, grid, sizeof(cvec4));
     memcpy(axis->color_major, major, sizeof(cvec4));
     memcpy(axis->color_minor, minor, sizeof(cvec4));
+    axis->style_dirty = true;
 }
 
 
@@ -541,6 +754,7 @@ void dvz_axis_anchor(DvzAxis* axis, vec2 anchor)
 {
     ANN(axis);
     glm_vec2_copy(anchor, axis->anchor);
+    axis->style_dirty = true;
 }
 
 
@@ -549,6 +763,7 @@ void dvz_axis_offset(DvzAxis* axis, vec2 offset)
 {
     ANN(axis);
     glm_vec2_copy(offset, axis->offset);
+    axis->style_dirty = true;
 }
 
 
@@ -638,6 +853,11 @@ DvzTickSpec dvz_tick_spec(
 void dvz_axis_ticks(DvzAxis* axis, DvzTickSpec* tick_spec)
 {
     ANN(axis);
+    if (axis->source != NULL)
+    {
+        log_error("the ticks of a shared axis must be set on its source axis");
+        return;
+    }
     memcpy(&axis->tick_spec, tick_spec, sizeof(DvzTickSpec));
 
     // HACK: copy p0, p1 to reference values if they have not been set before.
@@ -646,32 +866,39 @@ void dvz_axis_ticks(DvzAxis* axis, DvzTickSpec* tick_spec)
     if (glm_vec3_norm(axis->p1_ref) == 0)
         glm_vec3_copy(tick_spec->p1, axis->p1_ref);
 
-    // Allocation.
-    set_groups(axis, tick_spec->glyph_count, tick_spec->tick_count, tick_spec->length);
+    // Allocation, only when there are more ticks than slots.
+    uint32_t tick_count = tick_spec->tick_count;
+    axis->resized = false;
+    if (tick_count > axis->slot_count)
+        set_slots(axis, MAX(MAX(DVZ_AXIS_TICK_CAPACITY, tick_count), 2 * axis->slot_count));
+    else if (axis->style_dirty && axis->slot_count > 0)
+        set_style(axis);
 
-    // Segment.
-    set_segment_width(axis);
+    // Tick labels: only the labels that were not visible in the previous update are written.
+    set_labels(axis);
 
     // Tick positions.
     vec3* tick_positions = make_tick_positions(
-        axis, tick_spec->dmin, tick_spec->dmax, tick_spec->values, tick_spec->p0, tick_spec->p1);
-    set_glyph_pos(axis, tick_positions);
-    set_glyph_anchor(axis);
-    set_segment_pos(axis, tick_positions);
+        tick_count, tick_spec->dmin, tick_spec->dmax, tick_spec->values, tick_spec->p0,
+        tick_spec->p1);
+    set_glyph_pos(axis, tick_count, tick_positions);
+    set_segment_pos(axis, tick_count, tick_positions);
+    set_segment_shift(axis, tick_count);
     FREE(tick_positions);
 
-    // Tick width and length.
-    set_segment_width(axis);
-    set_segment_shift(axis);
+    // Hide the segments of the ticks that are no longer visible.
+    if (tick_count != axis->tick_count)
+        set_segment_color(axis, tick_count);
+    axis->tick_count = tick_count;
 
-    // Colors.
-    set_segment_color(axis);
-    set_glyph_color(axis);
+    axis->stats.updates++;
+    dvz_axis_update(axis);
+}
 
-    // NOTE: set_groups() needs to be called BEFORE this function, which calls dvz_glyph_xywh().
-    // The latter uses the group information to compute the width of each group, necessary
-    // to compute the anchor relative to each group's size in the vertex shader.
-    set_glyphs(axis, tick_spec->glyphs, tick_spec->index);
 
-    dvz_axis_update(axis);
+
+DvzAxisStats dvz_axis_stats(DvzAxis* axis)
+{
+    ANN(axis);
+    return axis->stats;
 }
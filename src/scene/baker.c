@@ -174,7 +174,7 @@ void dvz_baker_update(DvzBaker* baker)
     }
 
     // Update the index dual.
-    if (baker->index.array != NULL)
+    if (baker->index.array != NULL && !baker->index_shared)
         dvz_dual_update(&baker->index);
 
     // // Update the descriptor duals.
@@ -198,6 +198,9 @@ void dvz_baker_destroy(DvzBaker* baker)
     for (uint32_t binding_idx = 0; binding_idx < baker->binding_count; binding_idx++)
     {
         bv = &baker->vertex_bindings[binding_idx];
+        // NOTE: shared duals are destroyed by the baker that owns them.
+        if (bv->shared)
+            continue;
         // NOTE: this will destroy the dual's array only if dual.need_destroy=true (which only
         // occurs if the dual was created with one of the helper functions in dual.c).
         dvz_dual_destroy(&bv->dual);
@@ -273,29 +276,29 @@ void dvz_baker_indirect(DvzBaker* baker)
 /*  Baker sharing                                                                                */
 /*************************************************************************************************/
 
-void dvz_baker_share_vertex(DvzBaker* baker, uint32_t binding_idx)
+void dvz_baker_share_vertex(DvzBaker* baker, uint32_t binding_idx, DvzDual* dual)
 {
     ANN(baker);
-    // ANN(dual);
-    ASSERT(binding_idx < baker->binding_count);
+    ANN(dual);
+    ASSERT(binding_idx < DVZ_MAX_VERTEX_BINDINGS);
 
     DvzBakerVertex* bv = &baker->vertex_bindings[binding_idx];
     ANN(bv);
 
     log_trace("set shared dual for vertex binding #%d", binding_idx);
-    // bv->dual = *dual;
+    bv->dual = *dual;
     bv->shared = true;
 }
 
 
 
-void dvz_baker_share_index(DvzBaker* baker)
+void dvz_baker_share_index(DvzBaker* baker, DvzDual* dual)
 {
     ANN(baker);
-    // ANN(dual);
+    ANN(dual);
 
     log_trace("set shared dual for index buffer");
-    // baker->index = *dual;
+    baker->index = *dual;
     baker->index_shared = true;
 }
 
@@ -320,6 +323,10 @@ void dvz_baker_resize(DvzBaker* baker, uint32_t vertex_count, uint32_t index_cou
     // Resize the vertex bindings.
     for (uint32_t binding_idx = 0; binding_idx < baker->binding_count; binding_idx++)
     {
+        // NOTE: shared duals are resized by the baker that owns them.
+        if (baker->vertex_bindings[binding_idx].shared)
+            continue;
+
         // Resize the underlying dual array.
         dvz_array_resize(baker->vertex_bindings[binding_idx].dual.array, vertex_count);
 
@@ -328,6 +335,8 @@ void dvz_baker_resize(DvzBaker* baker, uint32_t vertex_count, uint32_t index_cou
     }
 
     // Resizing the index buffer.
+    if (baker->index_shared)
+        return;
 
     // Resize the underlying dual array.
     dvz_array_resize(baker->index.array, index_count);
@@ -357,6 +366,11 @@ void dvz_baker_repeat(
     ASSERT(binding_idx < baker->binding_count);
 
     DvzBakerVertex* vertex = &baker->vertex_bindings[binding_idx];
+    if (vertex->shared)
+    {
+        log_error("cannot write in the shared vertex binding #%d", binding_idx);
+        return;
+    }
 
     DvzDual* dual = &vertex->dual;
     if (dual == NULL)
@@ -0,0 +1,583 @@
+/*************************************************************************************************/
+/*  Bricks                                                                                       */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "scene/bricks.h"
+#include "_map.h"
+#include "fileio.h"
+#include "request.h"
+#include "scene/camera.h"
+
+
+
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+#define BRICK_UNKNOWN   0
+#define BRICK_EMPTY     1
+#define BRICK_NON_EMPTY 2
+
+// Level value in the indirection table for empty bricks.
+#define TABLE_EMPTY 255
+
+
+
+/*************************************************************************************************/
+/*  Utils                                                                                        */
+/*************************************************************************************************/
+
+static inline uint32_t _ceil_shift(uint32_t n, uint32_t level)
+{
+    return (n + (1u << level) - 1) >> level;
+}
+
+
+
+static inline uint32_t _ceil_div(uint32_t n, uint32_t d)
+{
+    ASSERT(d > 0);
+    return (n + d - 1) / d;
+}
+
+
+
+// Return the level of a brick and its coordinates within the brick grid of that level.
+static uint32_t _brick_coords(DvzBricks* bricks, uint32_t brick, uvec3 coords)
+{
+    ANN(bricks);
+    ASSERT(brick < bricks->brick_count);
+
+    // NOTE: the finest level starts at 0, the coarsest level comes last.
+    uint32_t level = 0;
+    for (level = 0; level < bricks->level_count - 1; level++)
+        if (brick < bricks->level_offset[level + 1])
+            break;
+
+    uint32_t* g = bricks->grid[level];
+    uint32_t i = brick - bricks->level_offset[level];
+    coords[0] = i % g[0];
+    coords[1] = (i / g[0]) % g[1];
+    coords[2] = i / (g[0] * g[1]);
+    return level;
+}
+
+
+
+static inline uint32_t _brick_index(DvzBricks* bricks, uint32_t level, uvec3 coords)
+{
+    ANN(bricks);
+    uint32_t* g = bricks->grid[level];
+    ASSERT(coords[0] < g[0] && coords[1] < g[1] && coords[2] < g[2]);
+    return bricks->level_offset[level] + (coords[2] * g[1] + coords[1]) * g[0] + coords[0];
+}
+
+
+
+static inline void _slot_coords(DvzBricks* bricks, uint32_t slot, uvec3 coords)
+{
+    ANN(bricks);
+    uint32_t* a = bricks->atlas_shape;
+    coords[0] = slot % a[0];
+    coords[1] = (slot / a[0]) % a[1];
+    coords[2] = slot / (a[0] * a[1]);
+}
+
+
+
+// Copy a brick from the source volume into the staging buffer, and return whether it is empty.
+// NOTE: the coarser levels are obtained by point sampling the finest level (voxel i of level l is
+// voxel i * 2^l of level 0), so that bricks can be extracted from the mapped file directly,
+// without precomputing the pyramid.
+static bool _brick_extract(DvzBricks* bricks, uint32_t brick)
+{
+    ANN(bricks);
+    ANN(bricks->data);
+    ANN(bricks->brick_data);
+
+    uvec3 coords = {0};
+    uint32_t level = _brick_coords(bricks, brick, coords);
+
+    uint32_t w = bricks->shape[0], h = bricks->shape[1], d = bricks->shape[2];
+    uint32_t lw = _ceil_shift(w, level), lh = _ceil_shift(h, level), ld = _ceil_shift(d, level);
+    DvzSize vs = bricks->voxel_size;
+
+    const int64_t B = DVZ_BRICK_SIZE;
+    const int64_t P = DVZ_BRICK_PAYLOAD;
+    const int64_t border = DVZ_BRICK_BORDER;
+
+    int64_t x0 = coords[0] * P - border;
+    int64_t y0 = coords[1] * P - border;
+    int64_t z0 = coords[2] * P - border;
+
+    bool empty = true;
+    int64_t x = 0, y = 0, z = 0;
+    DvzSize src = 0, dst = 0;
+    uint8_t* out = bricks->brick_data;
+    for (int64_t k = 0; k < B; k++)
+    {
+        // The border voxels are clamped at the volume edges.
+        z = CLIP(z0 + k, 0, (int64_t)ld - 1) << level;
+        for (int64_t j = 0; j < B; j++)
+        {
+            y = CLIP(y0 + j, 0, (int64_t)lh - 1) << level;
+            for (int64_t i = 0; i < B; i++)
+            {
+                x = CLIP(x0 + i, 0, (int64_t)lw - 1) << level;
+                src = (((DvzSize)z * h + (DvzSize)y) * w + (DvzSize)x) * vs;
+                ASSERT(src + vs <= bricks->data_size);
+                memcpy(&out[dst], &bricks->data[src], vs);
+                for (DvzSize l = 0; l < vs && empty; l++)
+                    empty = out[dst + l] == 0;
+                dst += vs;
+            }
+        }
+    }
+    return empty;
+}
+
+
+
+// Find a slot for a new brick: a free slot, or the least recently used slot that was not
+// requested in the current update.
+static int32_t _slot_find(DvzBricks* bricks)
+{
+    ANN(bricks);
+    int32_t best = -1;
+    uint64_t oldest = UINT64_MAX;
+    for (uint32_t s = 0; s < bricks->slot_count; s++)
+    {
+        if (bricks->slot_brick[s] < 0)
+            return (int32_t)s;
+        if (bricks->slot_used[s] < bricks->update && bricks->slot_used[s] < oldest)
+        {
+            oldest = bricks->slot_used[s];
+            best = (int32_t)s;
+        }
+    }
+    return best;
+}
+
+
+
+static void _brick_upload(DvzBricks* bricks, uint32_t brick, uint32_t slot)
+{
+    ANN(bricks);
+
+    // Evict the previous brick.
+    int32_t old = bricks->slot_brick[slot];
+    if (old >= 0)
+    {
+        bricks->brick_slot[old] = -1;
+        bricks->stats.evictions++;
+        bricks->stats.resident--;
+    }
+
+    uvec3 coords = {0};
+    _slot_coords(bricks, slot, coords);
+    uvec3 offset = {
+        coords[0] * DVZ_BRICK_SIZE, coords[1] * DVZ_BRICK_SIZE, coords[2] * DVZ_BRICK_SIZE};
+    uvec3 shape = {DVZ_BRICK_SIZE, DVZ_BRICK_SIZE, DVZ_BRICK_SIZE};
+    DvzSize size = DVZ_BRICK_SIZE * DVZ_BRICK_SIZE * DVZ_BRICK_SIZE * bricks->voxel_size;
+    dvz_upload_tex(bricks->batch, bricks->atlas, offset, shape, size, bricks->brick_data, 0);
+
+    bricks->slot_brick[slot] = (int32_t)brick;
+    bricks->brick_slot[brick] = (int32_t)slot;
+    bricks->slot_used[slot] = bricks->update;
+    bricks->stats.loads++;
+    bricks->stats.resident++;
+}
+
+
+
+// Projected size of a voxel of a given brick, in pixels.
+static float _brick_pixels(
+    DvzBricks* bricks, uint32_t level, uvec3 coords, vec3 eye, vec3 box_size, float focal)
+{
+    ANN(bricks);
+
+    // Extent of the brick in model coordinates, the volume box being centered at the origin.
+    float scale = (float)(1u << level);
+    vec3 bmin = {0}, bmax = {0}, nearest = {0};
+    float voxel = 0;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        float n = (float)bricks->shape[i];
+        float v0 = coords[i] * DVZ_BRICK_PAYLOAD * scale;
+        float v1 = MIN(v0 + DVZ_BRICK_PAYLOAD * scale, n);
+        bmin[i] = (v0 / n - .5f) * box_size[i];
+        bmax[i] = (v1 / n - .5f) * box_size[i];
+        nearest[i] = CLIP(eye[i], bmin[i], bmax[i]);
+        voxel = MAX(voxel, scale * box_size[i] / n);
+    }
+    float dist = MAX(glm_vec3_distance(eye, nearest), 1e-6f);
+    return voxel / dist * focal;
+}
+
+
+
+// Select the bricks needed for the current view, from the coarsest to the finest level.
+static uint32_t _select(DvzBricks* bricks, vec3 eye, vec3 box_size, float focal)
+{
+    ANN(bricks);
+
+    uint32_t* req = bricks->requests;
+    uint32_t n = 0; // number of requested bricks
+    uint32_t head = 0;
+
+    // The work list starts with all bricks of the coarsest level, which are always requested.
+    uint32_t top = bricks->level_count - 1;
+    uint32_t count = bricks->grid[top][0] * bricks->grid[top][1] * bricks->grid[top][2];
+    for (uint32_t i = 0; i < count; i++)
+        req[n++] = bricks->level_offset[top] + i;
+
+    // Breadth-first refinement: a brick is replaced by its children at the next finer level if
+    // its voxels are larger than a pixel on the screen, and if there are enough slots left.
+    uvec3 coords = {0}, child = {0};
+    uint32_t level = 0, brick = 0, children = 0;
+    while (head < n)
+    {
+        brick = req[head];
+        level = _brick_coords(bricks, brick, coords);
+        if (level == 0 ||
+            _brick_pixels(bricks, level, coords, eye, box_size, focal) <= bricks->lod_bias)
+        {
+            head++;
+            continue;
+        }
+
+        // Children at the next finer level.
+        uint32_t* g = bricks->grid[level - 1];
+        children = 0;
+        for (uint32_t k = 0; k < 2; k++)
+            for (uint32_t j = 0; j < 2; j++)
+                for (uint32_t i = 0; i < 2; i++)
+                    if (2 * coords[0] + i < g[0] && 2 * coords[1] + j < g[1] &&
+                        2 * coords[2] + k < g[2])
+                        children++;
+        if (n + children > bricks->slot_count)
+        {
+            head++;
+            continue;
+        }
+
+        // NOTE: the refined brick is kept in the list (as a fallback while its children are
+        // streamed), the children are appended at the end.
+        for (uint32_t k = 0; k < 2; k++)
+            for (uint32_t j = 0; j < 2; j++)
+                for (uint32_t i = 0; i < 2; i++)
+                {
+                    child[0] = 2 * coords[0] + i;
+                    child[1] = 2 * coords[1] + j;
+                    child[2] = 2 * coords[2] + k;
+                    if (child[0] < g[0] && child[1] < g[1] && child[2] < g[2])
+                        req[n++] = _brick_index(bricks, level - 1, child);
+                }
+        head++;
+    }
+    return n;
+}
+
+
+
+// Rebuild the indirection table: every cell of the finest brick grid points to the finest
+// resident (or empty) brick covering it.
+static void _table_update(DvzBricks* bricks)
+{
+    ANN(bricks);
+    ANN(bricks->table);
+
+    uint32_t* g = bricks->grid[0];
+    uvec3 cell = {0}, coords = {0}, slot = {0};
+    uint32_t brick = 0;
+    uint8_t* entry = NULL;
+    for (cell[2] = 0; cell[2] < g[2]; cell[2]++)
+    {
+        for (cell[1] = 0; cell[1] < g[1]; cell[1]++)
+        {
+            for (cell[0] = 0; cell[0] < g[0]; cell[0]++)
+            {
+                entry = &bricks->table[4 * ((cell[2] * g[1] + cell[1]) * g[0] + cell[0])];
+                memset(entry, 0, 4);
+                for (uint32_t l = 0; l < bricks->level_count; l++)
+                {
+                    coords[0] = cell[0] >> l;
+                    coords[1] = cell[1] >> l;
+                    coords[2] = cell[2] >> l;
+                    brick = _brick_index(bricks, l, coords);
+                    if (bricks->brick_empty[brick] == BRICK_EMPTY)
+                    {
+                        entry[3] = TABLE_EMPTY;
+                        break;
+                    }
+                    if (bricks->brick_slot[brick] >= 0)
+                    {
+                        _slot_coords(bricks, (uint32_t)bricks->brick_slot[brick], slot);
+                        entry[0] = (uint8_t)slot[0];
+                        entry[1] = (uint8_t)slot[1];
+                        entry[2] = (uint8_t)slot[2];
+                        entry[3] = (uint8_t)(l + 1);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    DvzSize size = 4 * g[0] * g[1] * g[2];
+    dvz_upload_tex(bricks->batch, bricks->indirection, DVZ_ZERO_OFFSET, g, size, bricks->table, 0);
+    bricks->table_dirty = false;
+    bricks->stats.table_uploads++;
+}
+
+
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+DvzBricks* dvz_bricks(DvzBatch* batch, DvzFormat format, uvec3 shape, uvec3 atlas_shape)
+{
+    ANN(batch);
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        ASSERT(shape[i] > 0);
+        // NOTE: the slot coordinates are encoded on 8 bits in the indirection table.
+        ASSERT(0 < atlas_shape[i] && atlas_shape[i] < 256);
+    }
+
+    DvzBricks* bricks = (DvzBricks*)calloc(1, sizeof(DvzBricks));
+    ANN(bricks);
+    bricks->batch = batch;
+    bricks->format = format;
+    bricks->voxel_size = _format_size(format);
+    ASSERT(bricks->voxel_size > 0);
+    memcpy(bricks->shape, shape, sizeof(uvec3));
+    memcpy(bricks->atlas_shape, atlas_shape, sizeof(uvec3));
+    bricks->upload_limit = DVZ_BRICKS_UPLOAD_LIMIT;
+    bricks->lod_bias = DVZ_BRICKS_LOD_BIAS;
+
+    // Multi-resolution pyramid, until a single brick covers the whole level.
+    uint32_t offset = 0;
+    uint32_t level = 0;
+    for (level = 0; level < DVZ_BRICKS_MAX_LEVELS; level++)
+    {
+        for (uint32_t i = 0; i < 3; i++)
+            bricks->grid[level][i] = _ceil_div(_ceil_shift(shape[i], level), DVZ_BRICK_PAYLOAD);
+        bricks->level_offset[level] = offset;
+        offset += bricks->grid[level][0] * bricks->grid[level][1] * bricks->grid[level][2];
+        if (bricks->grid[level][0] == 1 && bricks->grid[level][1] == 1 &&
+            bricks->grid[level][2] == 1)
+        {
+            level++;
+            break;
+        }
+    }
+    bricks->level_count = level;
+    bricks->brick_count = offset;
+
+    // Brick cache.
+    bricks->slot_count = atlas_shape[0] * atlas_shape[1] * atlas_shape[2];
+    uint32_t top = level - 1;
+    uint32_t top_count = bricks->grid[top][0] * bricks->grid[top][1] * bricks->grid[top][2];
+    if (bricks->slot_count < top_count)
+    {
+        log_error(
+            "the brick atlas (%d slots) cannot hold the coarsest level (%d bricks)",
+            bricks->slot_count, top_count);
+    }
+    bricks->slot_brick = (int32_t*)malloc(bricks->slot_count * sizeof(int32_t));
+    bricks->slot_used = (uint64_t*)calloc(bricks->slot_count, sizeof(uint64_t));
+    bricks->brick_slot = (int32_t*)malloc(bricks->brick_count * sizeof(int32_t));
+    bricks->brick_empty = (uint8_t*)calloc(bricks->brick_count, sizeof(uint8_t));
+    bricks->requests = (uint32_t*)calloc(MAX(bricks->slot_count, top_count), sizeof(uint32_t));
+    for (uint32_t s = 0; s < bricks->slot_count; s++)
+        bricks->slot_brick[s] = -1;
+    for (uint32_t b = 0; b < bricks->brick_count; b++)
+        bricks->brick_slot[b] = -1;
+
+    bricks->brick_data = (uint8_t*)malloc(
+        DVZ_BRICK_SIZE * DVZ_BRICK_SIZE * DVZ_BRICK_SIZE * bricks->voxel_size);
+
+    // Atlas texture.
+    uvec3 atlas_size = {
+        atlas_shape[0] * DVZ_BRICK_SIZE, atlas_shape[1] * DVZ_BRICK_SIZE,
+        atlas_shape[2] * DVZ_BRICK_SIZE};
+    bricks->atlas = dvz_create_tex(batch, DVZ_TEX_3D, format, atlas_size, 0).id;
+
+    // Indirection texture.
+    uint32_t* g = bricks->grid[0];
+    bricks->table = (uint8_t*)calloc(4 * g[0] * g[1] * g[2], sizeof(uint8_t));
+    bricks->indirection =
+        dvz_create_tex(batch, DVZ_TEX_3D, DVZ_FORMAT_R8G8B8A8_UNORM, g, 0).id;
+    bricks->table_dirty = true;
+
+    log_debug(
+        "create bricked volume %dx%dx%d with %d levels, %d bricks, atlas with %d slots", //
+        shape[0], shape[1], shape[2], bricks->level_count, bricks->brick_count,
+        bricks->slot_count);
+    return bricks;
+}
+
+
+
+void dvz_bricks_data(DvzBricks* bricks, void* data)
+{
+    ANN(bricks);
+    ANN(data);
+    bricks->data = (uint8_t*)data;
+    bricks->data_size =
+        (DvzSize)bricks->shape[0] * bricks->shape[1] * bricks->shape[2] * bricks->voxel_size;
+}
+
+
+
+int dvz_bricks_file(DvzBricks* bricks, const char* path, DvzSize offset)
+{
+    ANN(bricks);
+    ANN(path);
+
+    DvzSize size = 0;
+    void* mapped = dvz_map_file(path, &size);
+    if (mapped == NULL)
+        return 1;
+
+    DvzSize expected =
+        (DvzSize)bricks->shape[0] * bricks->shape[1] * bricks->shape[2] * bricks->voxel_size;
+    if (offset + expected > size)
+    {
+        log_error(
+            "volume file %s is too small (%s) for a %dx%dx%d volume", path, pretty_size(size),
+            bricks->shape[0], bricks->shape[1], bricks->shape[2]);
+        dvz_unmap_file(mapped, size);
+        return 1;
+    }
+
+    if (bricks->mapped != NULL)
+        dvz_unmap_file(bricks->mapped, bricks->mapped_size);
+    bricks->mapped = mapped;
+    bricks->mapped_size = size;
+    bricks->data = (uint8_t*)mapped + offset;
+    bricks->data_size = expected;
+    return 0;
+}
+
+
+
+uint32_t dvz_bricks_update(DvzBricks* bricks, DvzCamera* camera, mat4 model, vec3 box_size)
+{
+    ANN(bricks);
+    ANN(camera);
+
+    if (bricks->data == NULL)
+    {
+        log_error("the bricked volume has no source data");
+        return 0;
+    }
+    bricks->update++;
+
+    // Camera position in the model coordinates of the volume.
+    mat4 inv = GLM_MAT4_IDENTITY_INIT;
+    glm_mat4_inv(model, inv);
+    vec4 eye = {camera->pos[0], camera->pos[1], camera->pos[2], 1};
+    vec4 eye_model = {0};
+    glm_mat4_mulv(inv, eye, eye_model);
+    glm_vec3_divs(eye_model, eye_model[3], eye_model);
+
+    // Focal length in pixels, so that (size / distance * focal) is a projected size in pixels.
+    float focal = .5f * camera->viewport_size[1] / tanf(.5f * camera->fov);
+
+    uint32_t n = _select(bricks, eye_model, box_size, focal);
+    bricks->stats.requested = n;
+    bricks->stats.missing = 0;
+
+    // Mark the resident bricks as used, so that they are not evicted by this update.
+    uint32_t brick = 0;
+    int32_t slot = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        slot = bricks->brick_slot[bricks->requests[i]];
+        if (slot >= 0)
+        {
+            bricks->slot_used[slot] = bricks->update;
+            bricks->stats.hits++;
+        }
+    }
+
+    // Stream the missing bricks, from the coarsest to the finest.
+    uint32_t uploads = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        brick = bricks->requests[i];
+        if (bricks->brick_empty[brick] == BRICK_EMPTY || bricks->brick_slot[brick] >= 0)
+            continue;
+        if (uploads >= bricks->upload_limit)
+        {
+            bricks->stats.missing++;
+            continue;
+        }
+
+        // Empty bricks are not uploaded, they are marked as such in the indirection table.
+        if (_brick_extract(bricks, brick))
+        {
+            bricks->brick_empty[brick] = BRICK_EMPTY;
+            bricks->stats.skipped++;
+            bricks->table_dirty = true;
+            continue;
+        }
+        bricks->brick_empty[brick] = BRICK_NON_EMPTY;
+
+        slot = _slot_find(bricks);
+        if (slot < 0)
+        {
+            bricks->stats.missing++;
+            continue;
+        }
+        _brick_upload(bricks, brick, (uint32_t)slot);
+        bricks->table_dirty = true;
+        uploads++;
+    }
+
+    if (bricks->table_dirty)
+        _table_update(bricks);
+
+    if (uploads > 0)
+        log_trace("uploaded %d bricks, %d missing", uploads, bricks->stats.missing);
+    return uploads;
+}
+
+
+
+DvzBricksStats dvz_bricks_stats(DvzBricks* bricks)
+{
+    ANN(bricks);
+    return bricks->stats;
+}
+
+
+
+void dvz_bricks_destroy(DvzBricks* bricks)
+{
+    ANN(bricks);
+    log_debug(
+        "destroy bricked volume: %" PRIu64 " loads, %" PRIu64 " evictions, %" PRIu64 " hits",
+        bricks->stats.loads, bricks->stats.evictions, bricks->stats.hits);
+
+    if (bricks->mapped != NULL)
+        dvz_unmap_file(bricks->mapped, bricks->mapped_size);
+
+    FREE(bricks->slot_brick);
+    FREE(bricks->slot_used);
+    FREE(bricks->brick_slot);
+    FREE(bricks->brick_empty);
+    FREE(bricks->requests);
+    FREE(bricks->brick_data);
+    FREE(bricks->table);
+    FREE(bricks);
+}
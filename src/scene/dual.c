@@ -11,6 +11,7 @@
 #include "scene/dual.h"
 #include "_map.h"
 #include "request.h"
+#include "scene/arena.h"
 #include "scene/array.h"
 
 
@@ -110,6 +111,12 @@ void dvz_dual_resize(DvzDual* dual, uint32_t count)
     ANN(dual->array);
     ASSERT(count > 0);
 
+    if (dual->arena != NULL)
+    {
+        log_error("uniform duals suballocated in an arena cannot be resized");
+        return;
+    }
+
     // NOTE: for now, we do not make use of count
     dvz_dual_clear(dual);
 
@@ -131,11 +138,20 @@ void dvz_dual_update(DvzDual* dual)
         return;
     }
 
-    // Emit a dat_update command.
     DvzArray* array = dual->array;
     DvzSize item_size = array->item_size;
-    DvzSize offset = dual->dirty_first * item_size;
+    DvzSize offset = dual->offset + dual->dirty_first * item_size;
     DvzSize size = (DvzSize)((int64_t)dual->dirty_last - (int64_t)dual->dirty_first) * item_size;
+
+    // The data is already in the CPU copy of the arena, it will be uploaded at the next flush.
+    if (dual->arena != NULL)
+    {
+        dvz_arena_dirty(dual->arena, dual->dat, offset, size);
+        dvz_dual_clear(dual);
+        return;
+    }
+
+    // Emit a dat_update command.
     void* data = dvz_array_item(array, dual->dirty_first);
     dvz_upload_dat(dual->batch, dual->dat, offset, size, data, 0);
 
@@ -147,6 +163,19 @@ void dvz_dual_update(DvzDual* dual)
 void dvz_dual_destroy(DvzDual* dual)
 {
     ANN(dual);
+    if (dual->arena != NULL)
+    {
+        // Release the suballocation, the array does not own its data.
+        ANN(dual->array);
+        dvz_arena_free(
+            dual->arena, dual->dat, dual->offset,
+            dual->array->item_count * dual->array->item_size);
+        dual->array->data = NULL;
+        dvz_array_destroy(dual->array);
+        dual->array = NULL;
+        dual->arena = NULL;
+        return;
+    }
     if (dual->need_destroy)
     {
         log_trace("automatically destroying dual's array");
@@ -221,6 +250,15 @@ DvzDual dvz_dual_dat(DvzBatch* batch, DvzSize vertex_size, int flags)
     ANN(batch);
     ASSERT(vertex_size > 0);
 
+    // Suballocate the uniform in the arena registered by the scene, if any.
+    if (batch->arena != NULL)
+    {
+        DvzDual dual = dvz_arena_dual(batch->arena, vertex_size);
+        if (dual.dat != DVZ_ID_NONE)
+            return dual;
+        log_warn("falling back to a standalone uniform dat");
+    }
+
     // NOTE: typically, we create a dat for a uniform buffer with just a single item of a given
     // struct.
     const uint32_t n_items = 1;
@@ -25,11 +25,11 @@
 /*  Constants                                                                                    */
 /*************************************************************************************************/
 
+#define GLYPH_CACHE_INITIAL 256
 
-
-/*************************************************************************************************/
-/*  Utility functions                                                                            */
-/*************************************************************************************************/
+// 26.6 fixed point rounding.
+#define FT_FLOOR(x) ((x) & ~63)
+#define FT_CEIL(x)  (((x) + 63) & ~63)
 
 
 
@@ -37,15 +37,240 @@
 /*  Structs                                                                                      */
 /*************************************************************************************************/
 
+typedef struct DvzFontGlyph DvzFontGlyph;
+typedef struct DvzFontLayout DvzFontLayout;
+
+
+
+// Glyph metrics for a given pixel size, in pixels.
+struct DvzFontGlyph
+{
+    uint64_t key; // (pixel size << 32) | codepoint, 0 if the entry is empty
+    uint32_t index;
+    int32_t left, top, w, h;
+    int32_t advance;
+};
+
+
+
+// Cached layout of a string.
+struct DvzFontLayout
+{
+    uint64_t hash;
+    uint32_t length;
+    uint32_t* codepoints;
+    vec4* xywh;
+    uint64_t used; // last lookup of this entry, for the LRU replacement
+};
+
+
+
 struct DvzFont
 {
     FT_Library library;
     FT_Face face;
     double size;
+    uint32_t size_px;
+    bool kerning;
+
+    // Glyph metrics cache, an open addressing hash table for all pixel sizes.
+    DvzFontGlyph* glyphs;
+    uint32_t glyph_capacity; // power of two
+    uint32_t glyph_count;
+
+    // Layout cache, set associative with a LRU replacement policy in each set.
+    DvzFontLayout layouts[DVZ_FONT_LAYOUT_SETS * DVZ_FONT_LAYOUT_WAYS];
+    uint64_t lookups;
+
+    DvzFontStats stats;
 };
 
 
 
+/*************************************************************************************************/
+/*  Utility functions                                                                            */
+/*************************************************************************************************/
+
+static inline uint64_t _mix64(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+
+
+// FNV-1a hash of a string with the layout parameters.
+static uint64_t _layout_hash(DvzFont* font, uint32_t length, const uint32_t* codepoints)
+{
+    ANN(font);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = (hash ^ font->size_px) * 0x100000001b3ULL;
+    hash = (hash ^ (uint64_t)font->kerning) * 0x100000001b3ULL;
+    for (uint32_t i = 0; i < length; i++)
+        hash = (hash ^ codepoints[i]) * 0x100000001b3ULL;
+    return hash;
+}
+
+
+
+static void _glyph_cache_grow(DvzFont* font)
+{
+    ANN(font);
+
+    uint32_t old_capacity = font->glyph_capacity;
+    DvzFontGlyph* old = font->glyphs;
+
+    font->glyph_capacity = old_capacity > 0 ? 2 * old_capacity : GLYPH_CACHE_INITIAL;
+    font->glyphs = (DvzFontGlyph*)calloc(font->glyph_capacity, sizeof(DvzFontGlyph));
+    ANN(font->glyphs);
+
+    uint32_t mask = font->glyph_capacity - 1;
+    for (uint32_t i = 0; i < old_capacity; i++)
+    {
+        if (old[i].key == 0)
+            continue;
+        uint32_t j = (uint32_t)_mix64(old[i].key) & mask;
+        while (font->glyphs[j].key != 0)
+            j = (j + 1) & mask;
+        font->glyphs[j] = old[i];
+    }
+    FREE(old);
+}
+
+
+
+// Return the metrics of a glyph at the current size, loading them without rendering the glyph
+// the first time. The returned pointer is only valid until the next call.
+static const DvzFontGlyph* _font_glyph(DvzFont* font, uint32_t codepoint)
+{
+    ANN(font);
+    ANN(font->face);
+
+    if (2 * (font->glyph_count + 1) > font->glyph_capacity)
+        _glyph_cache_grow(font);
+
+    uint64_t key = ((uint64_t)font->size_px << 32) | codepoint;
+    uint32_t mask = font->glyph_capacity - 1;
+    uint32_t j = (uint32_t)_mix64(key) & mask;
+    while (font->glyphs[j].key != 0)
+    {
+        if (font->glyphs[j].key == key)
+            return &font->glyphs[j];
+        j = (j + 1) & mask;
+    }
+
+    // Cache miss: load the glyph outline metrics, hinted to the pixel grid. A glyph that cannot
+    // be loaded is cached with empty metrics.
+    DvzFontGlyph* glyph = &font->glyphs[j];
+    glyph->key = key;
+    font->glyph_count++;
+    font->stats.glyph_loads++;
+
+    FT_Face face = font->face;
+    if (FT_Load_Char(face, codepoint, FT_LOAD_DEFAULT))
+        return glyph;
+
+    FT_Glyph_Metrics* m = &face->glyph->metrics;
+    int32_t left = (int32_t)(FT_FLOOR(m->horiBearingX) >> 6);
+    int32_t right = (int32_t)(FT_CEIL(m->horiBearingX + m->width) >> 6);
+    int32_t top = (int32_t)(FT_CEIL(m->horiBearingY) >> 6);
+    int32_t bottom = (int32_t)(FT_FLOOR(m->horiBearingY - m->height) >> 6);
+
+    glyph->index = face->glyph->glyph_index;
+    glyph->left = left;
+    glyph->top = top;
+    glyph->w = right - left;
+    glyph->h = top - bottom;
+    glyph->advance = (int32_t)(face->glyph->advance.x >> 6); // 1/64 pixel units
+    return glyph;
+}
+
+
+
+static void _font_layout(DvzFont* font, uint32_t length, const uint32_t* codepoints, vec4* xywh)
+{
+    ANN(font);
+    ANN(codepoints);
+    ANN(xywh);
+
+    FT_Face face = font->face;
+    bool kerning = font->kerning && FT_HAS_KERNING(face);
+    uint32_t previous = 0;
+    int pen_x = 0;
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        const DvzFontGlyph* glyph = _font_glyph(font, codepoints[i]);
+
+        if (kerning && previous != 0 && glyph->index != 0)
+        {
+            FT_Vector delta = {0};
+            FT_Get_Kerning(face, previous, glyph->index, FT_KERNING_DEFAULT, &delta);
+            pen_x += (int)(delta.x >> 6);
+        }
+
+        // HACK: ensure the x position is 0 for the first glyph.
+        if (i == 0)
+            pen_x = -glyph->left;
+
+        xywh[i][0] = (float)(pen_x + glyph->left);
+        xywh[i][1] = (float)(glyph->top - glyph->h);
+        xywh[i][2] = (float)glyph->w;
+        xywh[i][3] = (float)glyph->h;
+
+        // Update the pen position based on the glyph's advance width
+        pen_x += glyph->advance;
+        previous = glyph->index;
+    }
+}
+
+
+
+// Return the layout of a string, owned by the layout cache and valid until the next call.
+static const vec4* _font_cached_layout(DvzFont* font, uint32_t length, const uint32_t* codepoints)
+{
+    ANN(font);
+
+    uint64_t hash = _layout_hash(font, length, codepoints);
+    DvzFontLayout* set = &font->layouts[(hash % DVZ_FONT_LAYOUT_SETS) * DVZ_FONT_LAYOUT_WAYS];
+    font->lookups++;
+
+    DvzFontLayout* victim = &set[0];
+    for (uint32_t k = 0; k < DVZ_FONT_LAYOUT_WAYS; k++)
+    {
+        DvzFontLayout* entry = &set[k];
+        if (entry->xywh != NULL && entry->hash == hash && entry->length == length &&
+            memcmp(entry->codepoints, codepoints, length * sizeof(uint32_t)) == 0)
+        {
+            entry->used = font->lookups;
+            font->stats.layout_hits++;
+            return (const vec4*)entry->xywh;
+        }
+        if (entry->used < victim->used)
+            victim = entry;
+    }
+
+    // Cache miss: replace the least recently used entry of the set.
+    font->stats.layout_misses++;
+    FREE(victim->codepoints);
+    FREE(victim->xywh);
+    victim->hash = hash;
+    victim->length = length;
+    victim->used = font->lookups;
+    victim->codepoints = (uint32_t*)_cpy(length * sizeof(uint32_t), (void*)codepoints);
+    victim->xywh = (vec4*)calloc(length, sizeof(vec4));
+    ANN(victim->xywh);
+    _font_layout(font, length, codepoints, victim->xywh);
+
+    return (const vec4*)victim->xywh;
+}
+
+
+
 /*************************************************************************************************/
 /*  Font functions                                                                               */
 /*************************************************************************************************/
@@ -65,6 +290,7 @@ DvzFont* dvz_font(unsigned long ttf_size, unsigned char* ttf_bytes)
         // FT_Done_FreeType(&font->library);
     }
 
+    font->kerning = true;
     dvz_font_size(font, DVZ_DEFAULT_FONT_SIZE);
 
     return font;
@@ -89,7 +315,16 @@ void dvz_font_size(DvzFont* font, double size)
         return;
     }
 
-    FT_Set_Pixel_Sizes(font->face, 0, (uint32_t)size);
+    font->size_px = (uint32_t)size;
+    FT_Set_Pixel_Sizes(font->face, 0, font->size_px);
+}
+
+
+
+void dvz_font_kerning(DvzFont* font, bool kerning)
+{
+    ANN(font);
+    font->kerning = kerning;
 }
 
 
@@ -101,50 +336,51 @@ vec4* dvz_font_layout(DvzFont* font, uint32_t length, const uint32_t* codepoints
     ANN(codepoints);
     ASSERT(length > 0);
 
-    FT_Face face = font->face;
-    if (!face)
+    if (!font->face)
     {
         log_error("font was not initialized");
         return NULL;
     }
 
-    int pen_x = 0;
-    int x = 0;
-    int y = 0;
-    uint32_t w = 0;
-    uint32_t h = 0;
+    const vec4* cached = _font_cached_layout(font, length, codepoints);
+    return (vec4*)_cpy(length * sizeof(vec4), (void*)cached);
+}
 
-    vec4* xywh = (vec4*)calloc(length, sizeof(vec4));
 
-    for (int i = 0; i < (int)length; i++)
-    {
-        // Load the glyph for the current character
-        if (FT_Load_Char(face, codepoints[i], FT_LOAD_RENDER))
-        {
-            // Handle glyph loading error
-            continue;
-        }
 
-        // Glyph size.
-        w = face->glyph->bitmap.width;
-        h = face->glyph->bitmap.rows;
+// The caller must FREE the returned pointer.
+vec4* dvz_font_layouts(
+    DvzFont* font, uint32_t count, const uint32_t* lengths, const uint32_t* codepoints)
+{
+    ANN(font);
+    ANN(lengths);
+    ANN(codepoints);
+    ASSERT(count > 0);
 
-        // HACK: ensure the x position is 0 for the first glyph.
-        if (i == 0)
-        {
-            pen_x = -face->glyph->bitmap_left;
-        }
+    if (!font->face)
+    {
+        log_error("font was not initialized");
+        return NULL;
+    }
 
-        x = pen_x + face->glyph->bitmap_left;
-        y = face->glyph->bitmap_top - (int)h;
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < count; i++)
+        total += lengths[i];
+    if (total == 0)
+        return NULL;
 
-        xywh[i][0] = (float)x;
-        xywh[i][1] = (float)y;
-        xywh[i][2] = (float)w;
-        xywh[i][3] = (float)h;
+    vec4* xywh = (vec4*)calloc(total, sizeof(vec4));
+    ANN(xywh);
 
-        // Update the pen position based on the glyph's advance width
-        pen_x += (face->glyph->advance.x >> 6); // 1/64 pixel units
+    // Each string is laid out independently, from x=0.
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (lengths[i] == 0)
+            continue;
+        const vec4* cached = _font_cached_layout(font, lengths[i], &codepoints[offset]);
+        memcpy(&xywh[offset], cached, lengths[i] * sizeof(vec4));
+        offset += lengths[i];
     }
 
     return xywh;
@@ -160,7 +396,18 @@ vec4* dvz_font_ascii(DvzFont* font, const char* string)
     uint32_t count = 0;
     uint32_t* codepoints = _ascii_to_utf32(string, &count);
 
-    return dvz_font_layout(font, count, codepoints);
+    vec4* xywh = dvz_font_layout(font, count, codepoints);
+    FREE(codepoints);
+    return xywh;
+}
+
+
+
+DvzFontStats dvz_font_stats(DvzFont* font)
+{
+    ANN(font);
+    font->stats.cached_glyphs = font->glyph_count;
+    return font->stats;
 }
 
 
@@ -237,30 +484,24 @@ uint8_t* dvz_font_draw(
             continue;
         }
 
-        // Determine the upper-left corner of the glyph.
-        x = round(xywh[i][0]);
-        y = round(xywh[i][1]);
-        w = round(xywh[i][2]);
-        h = round(xywh[i][3]);
-
-        // Convert to the coordinate space of the final image.
-        x += margin;
-        ASSERT(x >= margin);
-        ASSERT(x + w <= width - margin);
-
-        y = baseline - y - h;
-        ASSERT(y >= margin);
-        ASSERT(y + h <= height - margin);
+        // Determine the upper-left corner of the glyph. The layout is computed from the glyph
+        // metrics, the rendered bitmap may differ by a pixel so it is clipped to the image.
+        FT_Bitmap* glyph_bitmap = &face->glyph->bitmap;
+        w = (int)glyph_bitmap->width;
+        h = (int)glyph_bitmap->rows;
+        x = (int)round(xywh[i][0]) + margin;
+        y = baseline - face->glyph->bitmap_top;
 
         // Copy the glyph's bitmap into the final bitmap.
         for (int u = 0; u < w; u++)
         {
             for (int v = 0; v < h; v++)
             {
+                if (x + u < 0 || x + u >= width || y + v < 0 || y + v >= height)
+                    continue;
                 uint32_t idx = (uint32_t)((y + v) * width + x + u);
-                ASSERT((int)idx < width * height * 1);
                 for (uint32_t k = 0; k < 3; k++)
-                    bitmap[3 * idx + k] = face->glyph->bitmap.buffer[w * v + u];
+                    bitmap[3 * idx + k] = glyph_bitmap->buffer[glyph_bitmap->pitch * v + u];
                 // bitmap[3 * idx + 1] += 64; // DEBUG
             }
         }
@@ -281,5 +522,12 @@ void dvz_font_destroy(DvzFont* font)
     if (font->library)
         FT_Done_FreeType(font->library);
 
+    for (uint32_t i = 0; i < DVZ_FONT_LAYOUT_SETS * DVZ_FONT_LAYOUT_WAYS; i++)
+    {
+        FREE(font->layouts[i].codepoints);
+        FREE(font->layouts[i].xywh);
+    }
+    FREE(font->glyphs);
+
     FREE(font);
 }
@@ -23,7 +23,8 @@ void main()
     // out_color = vec4(in_uv, 1, 1);
 
     // from https://github.com/Chlumsky/msdfgen#using-a-multi-channel-distance-field
-    vec3 msd = texture(tex, in_uv).rgb;
+    // NOTE: the texcoords are in pixels, so that they do not depend on the atlas texture size.
+    vec3 msd = texture(tex, in_uv / vec2(textureSize(tex, 0))).rgb;
     float sd = median(msd.r, msd.g, msd.b);
     if (sd < .05)
         discard;
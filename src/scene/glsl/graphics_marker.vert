@@ -2,6 +2,13 @@
 #include "common.glsl"
 #include "constants.glsl"
 
+// Global marker size multiplier, a push constant so that it can be animated without upload.
+layout(push_constant) uniform Push
+{
+    float scale;
+}
+push;
+
 layout(location = 0) in vec3 pos;
 layout(location = 1) in float size;
 layout(location = 2) in float angle;
@@ -15,9 +22,11 @@ void main()
 {
     gl_Position = transform(pos);
 
+    float scaled = size * push.scale;
+
     out_color = color;
-    out_size = size;
+    out_size = scaled;
     out_angle = angle;
 
-    gl_PointSize = size * (abs(cos(angle)) + abs(sin(angle)));
+    gl_PointSize = scaled * (abs(cos(angle)) + abs(sin(angle)));
 }
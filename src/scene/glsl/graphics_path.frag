@@ -15,6 +15,13 @@ layout(std140, binding = USER_BINDING) uniform Params
 }
 params;
 
+// NOTE: the linewidth is a push constant, see graphics_path.vert.
+layout(push_constant) uniform Push
+{
+    float linewidth;
+}
+push;
+
 layout(location = 0) in vec4 in_color;
 layout(location = 1) in vec2 in_caps;
 layout(location = 2) in float in_length;
@@ -40,7 +47,7 @@ void main()
 
     float distance = in_texcoord.y;
     vec4 color = in_color;
-    float linewidth = params.linewidth;
+    float linewidth = push.linewidth;
     float miter_limit = params.miter_limit;
 
     if (in_caps.x < 0.0)
@@ -14,6 +14,14 @@ layout(std140, binding = USER_BINDING) uniform Params
 }
 params;
 
+// NOTE: the linewidth is a push constant so that it can be animated without uniform upload, the
+// linewidth field of the params is unused.
+layout(push_constant) uniform Push
+{
+    float linewidth;
+}
+push;
+
 const float antialias = 1.0;
 
 layout(location = 0) in vec3 p0_ndc;
@@ -78,7 +86,7 @@ void main()
 
     out_color = color;
 
-    float linewidth = params.linewidth;
+    float linewidth = push.linewidth;
     float miter_limit = params.miter_limit;
 
     // Determine the direction of each of the 3 segments (previous, current, next)
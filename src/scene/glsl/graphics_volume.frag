@@ -16,6 +16,9 @@ layout(constant_id = 1) const int VOLUME_COLOR = VOLUME_COLOR_DIRECT;
 // Volume front to back or back to front.
 layout(constant_id = 2) const int VOLUME_DIR = VOLUME_DIR_FRONT_BACK;
 
+// Bricked volume, sampled through an indirection table.
+layout(constant_id = 3) const int VOLUME_BRICKED = 0;
+
 // Uniform variables.
 layout(std140, binding = USER_BINDING) uniform Params
 {
@@ -23,11 +26,14 @@ layout(std140, binding = USER_BINDING) uniform Params
     vec4 uvw0;     /* texture coordinates of the 2 corner points */
     vec4 uvw1;     /* texture coordinates of the 2 corner points */
     vec4 transfer;
+    vec4 shape;  /* bricked volume: shape of the volume at the finest level */
+    vec4 atlas;  /* bricked volume: number of brick slots in the atlas */
 }
 params;
 
 // Texture.
 layout(binding = (USER_BINDING + 1)) uniform sampler3D tex_density; // 3D vol with vox R density
+layout(binding = (USER_BINDING + 2)) uniform sampler3D tex_indirection; // bricked volume
 
 // Varying variables.
 layout(location = 0) in vec3 in_pos;
@@ -102,6 +108,11 @@ void main()
         // Now, normalize between uvw0 and uvw1.
         uvw = params.uvw0.xyz + uvw * (params.uvw1 - params.uvw0).xyz;
 
+        // Bricked volume: texture coordinates in the brick atlas, skip empty or missing bricks.
+        if (VOLUME_BRICKED > 0 &&
+            !brick_uvw(tex_indirection, uvw, params.shape.xyz, params.atlas.xyz, uvw))
+            continue;
+
         // Fetch the color from the 3D texture.
         fetched = fetch_color(modes, tex_density, uvw, params.transfer.x);
 
@@ -38,3 +38,30 @@ vec4 fetch_color(ivec2 modes, sampler3D tex_density, vec3 uvw, float transfer)
 
     return color;
 }
+
+
+// NOTE: must correspond to the values in bricks.h
+#define BRICK_SIZE    32
+#define BRICK_BORDER  1
+#define BRICK_PAYLOAD 30
+#define BRICK_EMPTY   255
+
+
+// Texture coordinates in the brick atlas of a point of a bricked volume. The indirection table
+// holds, for each brick of the finest level, the atlas slot and the level (+1) of the finest
+// resident brick covering it. Returns false if the point is empty or not resident.
+bool brick_uvw(sampler3D indirection, vec3 uvw, vec3 shape, vec3 atlas, out vec3 atlas_uvw)
+{
+    atlas_uvw = vec3(0);
+    vec3 p = clamp(uvw, 0, 1) * shape; // voxel coordinates at the finest level
+    ivec3 cell = min(ivec3(p / BRICK_PAYLOAD), textureSize(indirection, 0) - 1);
+    vec4 entry = round(texelFetch(indirection, cell, 0) * 255.0);
+    if (entry.a < 0.5 || entry.a > BRICK_EMPTY - 0.5)
+        return false;
+
+    // Voxel coordinates at the level of the resident brick, and within that brick.
+    p /= exp2(entry.a - 1.0);
+    vec3 local = p - floor(p / BRICK_PAYLOAD) * BRICK_PAYLOAD;
+    atlas_uvw = (entry.xyz * BRICK_SIZE + BRICK_BORDER + local) / (atlas * BRICK_SIZE);
+    return true;
+}
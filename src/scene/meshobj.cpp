@@ -8,48 +8,597 @@
 /*************************************************************************************************/
 
 #include "scene/meshobj.h"
+#include "../_pointer.h"
 #include "_macros.h"
+#include "fileio.h"
 #include "scene/colormaps.h"
 #include "scene/shape.h"
 
-// #define MUTE_MISSING_PROTOTYPES _Pragma("GCC diagnostic ignored \"-Wmissing-prototypes\"")
+#include <fstream>
+#include <thread>
+#include <vector>
 
-MUTE_ON
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
-MUTE_OFF
+
+
+/*************************************************************************************************/
+/*  Constants                                                                                    */
+/*************************************************************************************************/
+
+#define OBJ_NONE     -1 // absent texture coordinates or normal
+#define OBJ_FAR      INT32_MIN
+#define OBJ_FAR_MAX  (1 << 24)
+
+
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+// Face corner: OBJ indices of the position, texture coordinates, and normal. While parsing, the
+// indices are 1-based, 0 if absent, and negative for the relative indices resolved within the
+// chunk, or OBJ_FAR + i for the i-th relative index referring to a previous chunk. Once resolved,
+// they are 0-based global indices, OBJ_NONE if absent.
+struct ObjCorner
+{
+    int32_t v, t, n;
+};
+
+static inline bool operator==(const ObjCorner& a, const ObjCorner& b)
+{
+    return a.v == b.v && a.t == b.t && a.n == b.n;
+}
+
+
+
+// Range of lines of an OBJ file, parsed by a single thread.
+struct ObjChunk
+{
+    const char* begin;
+    const char* end;
+
+    std::vector<float> pos;       // 3 floats per position
+    std::vector<float> color;     // 3 floats per position, empty if no position has a color
+    std::vector<float> texcoords; // 2 floats per texture coordinates
+    std::vector<float> normal;    // 3 floats per normal
+    std::vector<ObjCorner> corners; // 3 corners per triangle
+    std::vector<int64_t> far; // relative indices referring to a previous chunk, from its start
+
+    bool aligned; // whether all corners use the same index for all attributes
+};
+
+
+
+// Open addressing hash table of vertex indices, the vertices are hashed and compared through
+// callbacks so that the table only stores 4 bytes per vertex.
+struct VertexTable
+{
+    std::vector<uint32_t> slots; // vertex index + 1, 0 for an empty slot
+    uint64_t mask;
+    uint64_t count;
+};
+
+
+
+/*************************************************************************************************/
+/*  Parallel utils                                                                               */
+/*************************************************************************************************/
+
+static uint32_t _thread_count(uint64_t work, uint64_t min_work)
+{
+    uint64_t n = MAX(1u, std::thread::hardware_concurrency());
+    uint64_t m = MAX((uint64_t)1, work / MAX((uint64_t)1, min_work));
+    return (uint32_t)MIN(n, m);
+}
+
+
+
+// Call f(begin, end, thread_idx) on contiguous ranges of [0, count), one per thread.
+template <typename F> static void _parallel_for(uint64_t count, uint32_t thread_count, F f)
+{
+    if (thread_count <= 1 || count < thread_count)
+    {
+        f((uint64_t)0, count, (uint32_t)0);
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    for (uint32_t t = 0; t < thread_count; t++)
+    {
+        threads.emplace_back(
+            f, count * t / thread_count, count * (t + 1) / thread_count, (uint32_t)t);
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+}
 
 
 
 /*************************************************************************************************/
-/*  Constants */
+/*  Hash utils                                                                                   */
 /*************************************************************************************************/
 
+static inline uint64_t _mix(uint64_t h)
+{
+    // splitmix64 finalizer.
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+
+
+static inline uint64_t _mix_bytes(uint64_t h, const void* data, DvzSize size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t word = 0;
+    for (DvzSize i = 0; i < size; i += 4)
+    {
+        memcpy(&word, bytes + i, MIN((DvzSize)4, size - i));
+        h = _mix(h ^ word);
+    }
+    return h;
+}
+
+
+
+static void _table_init(VertexTable& table, uint64_t capacity)
+{
+    uint64_t size = 16;
+    while (size < 2 * capacity)
+        size <<= 1;
+    table.slots.assign(size, 0);
+    table.mask = size - 1;
+    table.count = 0;
+}
+
+
+
+// Return the vertex equal to `vertex` if there is one in the table, otherwise insert `vertex`
+// and return it.
+template <typename Hash, typename Equal>
+static uint32_t _table_insert(VertexTable& table, uint32_t vertex, Hash hash, Equal equal)
+{
+    // Grow the table when it is half full.
+    if (2 * (table.count + 1) > table.slots.size())
+    {
+        std::vector<uint32_t> old;
+        old.swap(table.slots);
+        uint64_t count = table.count;
+        _table_init(table, old.size());
+        for (uint32_t slot : old)
+        {
+            if (slot == 0)
+                continue;
+            uint64_t i = hash(slot - 1) & table.mask;
+            while (table.slots[i] != 0)
+                i = (i + 1) & table.mask;
+            table.slots[i] = slot;
+        }
+        table.count = count;
+    }
+
+    uint64_t i = hash(vertex) & table.mask;
+    while (table.slots[i] != 0)
+    {
+        uint32_t other = table.slots[i] - 1;
+        if (equal(other, vertex))
+            return other;
+        i = (i + 1) & table.mask;
+    }
+    table.slots[i] = vertex + 1;
+    table.count++;
+    return vertex;
+}
+
+
+
+/*************************************************************************************************/
+/*  OBJ parsing                                                                                  */
+/*************************************************************************************************/
+
+static inline const char* _skip_space(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    return p;
+}
+
+
+
+static inline const char* _next_line(const char* p, const char* end)
+{
+    p = (const char*)memchr(p, '\n', (size_t)(end - p));
+    return p != NULL ? p + 1 : end;
+}
+
+
+
+// Parse a decimal number, return NULL if there is none.
+static const char* _parse_float(const char* p, const char* end, float* out)
+{
+    static const double POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                   1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                   1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    p = _skip_space(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    // NOTE: the digits beyond the 19th are ignored, they are not representable in a float.
+    uint64_t mantissa = 0;
+    int32_t exponent = 0;
+    uint32_t digits = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits++)
+    {
+        if (digits < 19)
+            mantissa = 10 * mantissa + (uint64_t)(*p - '0');
+        else
+            exponent++;
+    }
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++)
+        {
+            if (digits < 19)
+            {
+                mantissa = 10 * mantissa + (uint64_t)(*p - '0');
+                exponent--;
+            }
+        }
+    }
+    if (digits == 0)
+        return NULL;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char* q = p + 1;
+        bool exp_negative = false;
+        if (q < end && (*q == '-' || *q == '+'))
+            exp_negative = *q++ == '-';
+        int32_t e = 0;
+        const char* start = q;
+        for (; q < end && *q >= '0' && *q <= '9'; q++)
+            e = MIN(10 * e + (*q - '0'), 9999);
+        if (q > start)
+        {
+            exponent += exp_negative ? -e : e;
+            p = q;
+        }
+    }
+
+    double value = (double)mantissa;
+    if (exponent < 0)
+        value = -exponent <= 22 ? value / POW10[-exponent] : value * pow(10.0, exponent);
+    else if (exponent > 0)
+        value = exponent <= 22 ? value * POW10[exponent] : value * pow(10.0, exponent);
+    *out = (float)(negative ? -value : value);
+    return p;
+}
+
+
+
+static const char* _parse_int(const char* p, const char* end, int64_t* out)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    const char* start = p;
+    int64_t value = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++)
+        value = 10 * value + (*p - '0');
+    if (p == start)
+        return NULL;
+    *out = negative ? -value : value;
+    return p;
+}
+
+
+
+// Convert an OBJ index to the chunk representation (see ObjCorner).
+static inline int32_t _corner_index(ObjChunk* chunk, int64_t index, uint64_t local_count)
+{
+    if (index >= 0)
+        return (int32_t)index;
+
+    // Relative index: resolved within the chunk if possible.
+    int64_t local = (int64_t)local_count + index;
+    if (local >= 0)
+        return (int32_t)(-local - 1);
+
+    if (chunk->far.size() >= OBJ_FAR_MAX)
+        return 0;
+    chunk->far.push_back(local);
+    return OBJ_FAR + (int32_t)(chunk->far.size() - 1);
+}
+
+
+
+static const char* _parse_corner(ObjChunk* chunk, const char* p, const char* end, ObjCorner* c)
+{
+    int64_t index[3] = {0, 0, 0};
+
+    p = _parse_int(p, end, &index[0]);
+    if (p == NULL)
+        return NULL;
+    if (p < end && *p == '/')
+    {
+        p++;
+        if (p < end && *p != '/')
+            p = _parse_int(p, end, &index[1]);
+        if (p != NULL && p < end && *p == '/')
+            p = _parse_int(p + 1, end, &index[2]);
+        if (p == NULL)
+            return NULL;
+    }
+
+    c->v = _corner_index(chunk, index[0], chunk->pos.size() / 3);
+    c->t = _corner_index(chunk, index[1], chunk->texcoords.size() / 2);
+    c->n = _corner_index(chunk, index[2], chunk->normal.size() / 3);
+    return p;
+}
+
+
+
+static void _parse_face(ObjChunk* chunk, const char* p, const char* end)
+{
+    ObjCorner first = {}, prev = {}, c = {};
+    uint32_t k = 0;
+    while (true)
+    {
+        p = _skip_space(p, end);
+        if (p >= end || *p == '\n' || *p == '#')
+            break;
+
+        const char* q = _parse_corner(chunk, p, end, &c);
+        if (q == NULL)
+        {
+            log_warn("invalid OBJ face corner, skipping the end of the face");
+            break;
+        }
+        p = q;
+
+        if (k == 0)
+            first = c;
+        else if (k >= 2)
+        {
+            // Fan triangulation of polygonal faces.
+            chunk->corners.push_back(first);
+            chunk->corners.push_back(prev);
+            chunk->corners.push_back(c);
+        }
+        prev = c;
+        k++;
+    }
+}
+
+
+
+static void _parse_chunk(ObjChunk* chunk)
+{
+    ANN(chunk);
+    const char* end = chunk->end;
+    float x[3] = {0};
+    for (const char* line = chunk->begin; line < end; line = _next_line(line, end))
+    {
+        const char* p = _skip_space(line, end);
+        if (p + 1 >= end || p[0] == '#')
+            continue;
+
+        // Position, with an optional color.
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            p += 2;
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                const char* q = _parse_float(p, end, &x[i]);
+                x[i] = q != NULL ? x[i] : 0;
+                p = q != NULL ? q : p;
+            }
+            chunk->pos.insert(chunk->pos.end(), x, x + 3);
+
+            bool has_color = true;
+            for (uint32_t i = 0; i < 3 && has_color; i++)
+            {
+                const char* q = _parse_float(p, end, &x[i]);
+                has_color = q != NULL;
+                p = q != NULL ? q : p;
+            }
+            if (has_color && chunk->color.empty())
+                chunk->color.resize(chunk->pos.size() - 3, 1.0f);
+            if (has_color)
+                chunk->color.insert(chunk->color.end(), x, x + 3);
+            else if (!chunk->color.empty())
+                chunk->color.insert(chunk->color.end(), 3, 1.0f);
+        }
+
+        // Texture coordinates.
+        else if (p[0] == 'v' && p[1] == 't')
+        {
+            p += 2;
+            for (uint32_t i = 0; i < 2; i++)
+            {
+                const char* q = _parse_float(p, end, &x[i]);
+                x[i] = q != NULL ? x[i] : 0;
+                p = q != NULL ? q : p;
+            }
+            chunk->texcoords.insert(chunk->texcoords.end(), x, x + 2);
+        }
+
+        // Normal.
+        else if (p[0] == 'v' && p[1] == 'n')
+        {
+            p += 2;
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                const char* q = _parse_float(p, end, &x[i]);
+                x[i] = q != NULL ? x[i] : 0;
+                p = q != NULL ? q : p;
+            }
+            chunk->normal.insert(chunk->normal.end(), x, x + 3);
+        }
+
+        // Face.
+        else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            _parse_face(chunk, p + 2, end);
+        }
+
+        // NOTE: other statements (groups, materials, lines...) are ignored.
+    }
+}
+
+
+
+// Convert the corners of a chunk to global indices, given the number of elements before the chunk.
+static uint64_t _resolve_chunk(ObjChunk* chunk, const int64_t offset[3], const int64_t total[3])
+{
+    ANN(chunk);
+
+    uint64_t invalid = 0;
+    bool aligned = true;
+    int32_t* fields[3] = {NULL, NULL, NULL};
+    for (ObjCorner& c : chunk->corners)
+    {
+        fields[0] = &c.v;
+        fields[1] = &c.t;
+        fields[2] = &c.n;
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            int64_t index = *fields[k];
+            if (index > 0)
+                index = index - 1;
+            else if (index == 0)
+                index = OBJ_NONE;
+            else if (index < OBJ_FAR + OBJ_FAR_MAX)
+                index = offset[k] + chunk->far[(uint64_t)(index - OBJ_FAR)];
+            else
+                index = offset[k] + (-index - 1);
+            if (index >= total[k] || (index < 0 && index != OBJ_NONE))
+            {
+                invalid++;
+                index = k == 0 ? 0 : OBJ_NONE;
+            }
+            *fields[k] = (int32_t)index;
+        }
+    }
+
+    for (const ObjCorner& c : chunk->corners)
+    {
+        if ((c.t != OBJ_NONE && c.t != c.v) || (c.n != OBJ_NONE && c.n != c.v))
+        {
+            aligned = false;
+            break;
+        }
+    }
+    chunk->aligned = aligned;
+    return invalid;
+}
+
+
+
+// Accumulate the area-weighted face normals in the vertices that have no normal.
+static void _compute_normals(DvzShape* shape, const std::vector<bool>& missing)
+{
+    ANN(shape);
+
+    vec3 u = {0}, v = {0}, n = {0};
+    for (uint32_t i = 0; i + 2 < shape->index_count; i += 3)
+    {
+        DvzIndex a = shape->index[i + 0];
+        DvzIndex b = shape->index[i + 1];
+        DvzIndex c = shape->index[i + 2];
+        glm_vec3_sub(shape->pos[b], shape->pos[a], u);
+        glm_vec3_sub(shape->pos[c], shape->pos[a], v);
+        glm_vec3_cross(u, v, n);
+        if (missing[a])
+            glm_vec3_add(shape->normal[a], n, shape->normal[a]);
+        if (missing[b])
+            glm_vec3_add(shape->normal[b], n, shape->normal[b]);
+        if (missing[c])
+            glm_vec3_add(shape->normal[c], n, shape->normal[c]);
+    }
+    for (uint32_t i = 0; i < shape->vertex_count; i++)
+    {
+        if (missing[i])
+            glm_vec3_normalize(shape->normal[i]);
+    }
+}
+
 
 
 /*************************************************************************************************/
 /*  MeshObj functions                                                                            */
 /*************************************************************************************************/
 
+// Copy the arrays of a mapped binary mesh before modifying them, as the mapping is read-only.
+static void _shape_own(DvzShape* shape)
+{
+    ANN(shape);
+    if (shape->mapped == NULL)
+        return;
+
+    uint32_t nv = shape->vertex_count;
+    uint32_t ni = shape->index_count;
+    shape->pos = (vec3*)_cpy(nv * sizeof(vec3), shape->pos);
+    if (shape->normal != NULL)
+        shape->normal = (vec3*)_cpy(nv * sizeof(vec3), shape->normal);
+    if (shape->color != NULL)
+        shape->color = (cvec4*)_cpy(nv * sizeof(cvec4), shape->color);
+    if (shape->texcoords != NULL)
+        shape->texcoords = (vec4*)_cpy(nv * sizeof(vec4), shape->texcoords);
+    if (shape->index != NULL)
+        shape->index = (DvzIndex*)_cpy(ni * sizeof(DvzIndex), shape->index);
+
+    dvz_unmap_file(shape->mapped, shape->mapped_size);
+    shape->mapped = NULL;
+    shape->mapped_size = 0;
+}
+
+
+
 void dvz_shape_normalize(DvzShape* shape)
 {
     ANN(shape);
 
+    uint32_t nv = shape->vertex_count;
+    if (nv == 0)
+        return;
+    _shape_own(shape);
+
+    // Bounding box and center, reduced over the threads.
     const float INF = 1000000;
+    uint32_t thread_count = _thread_count(nv, 1 << 18);
+    std::vector<vec3> mins(thread_count), maxs(thread_count);
+    std::vector<double> sums(3 * thread_count, 0.0);
+    _parallel_for(nv, thread_count, [&](uint64_t begin, uint64_t end, uint32_t t) {
+        vec3 min = {+INF, +INF, +INF}, max = {-INF, -INF, -INF};
+        double sum[3] = {0};
+        for (uint64_t i = begin; i < end; i++)
+        {
+            glm_vec3_minv(min, shape->pos[i], min);
+            glm_vec3_maxv(max, shape->pos[i], max);
+            for (uint32_t k = 0; k < 3; k++)
+                sum[k] += shape->pos[i][k];
+        }
+        _vec3_copy(min, mins[t]);
+        _vec3_copy(max, maxs[t]);
+        for (uint32_t k = 0; k < 3; k++)
+            sums[3 * t + k] = sum[k];
+    });
+
     vec3 min = {+INF, +INF, +INF}, max = {-INF, -INF, -INF};
     vec3 center = {0};
-    vec3 pos = {0};
-
-    uint32_t nv = shape->vertex_count;
-    for (uint32_t i = 0; i < nv; i++)
+    for (uint32_t t = 0; t < thread_count; t++)
     {
-        _vec3_copy(shape->pos[i], pos);
-        glm_vec3_minv(min, pos, min);
-        glm_vec3_maxv(max, pos, max);
-
-        glm_vec3_add(center, pos, center);
+        glm_vec3_minv(min, mins[t], min);
+        glm_vec3_maxv(max, maxs[t], max);
+        for (uint32_t k = 0; k < 3; k++)
+            center[k] += (float)(sums[3 * t + k] / nv);
     }
-    glm_vec3_scale(center, 1. / nv, center);
 
     // a * (pos - center) \in (-1, 1)
     // a * (min - center)
@@ -60,19 +609,16 @@ void dvz_shape_normalize(DvzShape* shape)
     glm_vec3_sub(center, min, v);
     glm_vec3_div(ones, u, u);
     glm_vec3_div(ones, v, v);
-    // for (uint32_t k = 0; k < 3; k++)
-    // {
-    //     u[k] = 1 / u[k];
-    //     v[k] = 1 / v[k];
-    // }
     float a = fmin(glm_vec3_min(u), glm_vec3_min(v));
     ASSERT(a > 0);
 
-    for (uint32_t i = 0; i < nv; i++)
-    {
-        glm_vec3_sub(shape->pos[i], center, shape->pos[i]);
-        glm_vec3_scale(shape->pos[i], a, shape->pos[i]);
-    }
+    _parallel_for(nv, thread_count, [&](uint64_t begin, uint64_t end, uint32_t t) {
+        for (uint64_t i = begin; i < end; i++)
+        {
+            glm_vec3_sub(shape->pos[i], center, shape->pos[i]);
+            glm_vec3_scale(shape->pos[i], a, shape->pos[i]);
+        }
+    });
 }
 
 
@@ -84,139 +630,441 @@ DvzShape dvz_shape_obj(const char* file_path)
     DvzShape shape = {};
     shape.type = DVZ_SHAPE_OBJ;
 
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-
-    std::string warn;
-    std::string err;
-
-    // Load the file.
-    bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, file_path);
-    if (!warn.empty())
-        log_warn(warn.c_str());
-    if (!err.empty())
-        log_warn(err.c_str());
-    if (!ret)
+    DvzSize size = 0;
+    const char* data = (const char*)dvz_map_file(file_path, &size);
+    if (data == NULL)
     {
         log_error("error loading obj file %s", file_path);
         return shape;
     }
 
-    // Number of vertices.
-    uint32_t nv = attrib.vertices.size() / 3; // 3 floats per vertex
-    ASSERT(nv > 0);
+    // Split the file in ranges of lines, parsed in parallel.
+    uint32_t chunk_count = _thread_count(size, DVZ_OBJ_CHUNK_SIZE);
+    std::vector<ObjChunk> chunks(chunk_count);
+    const char* end = data + size;
+    const char* begin = data;
+    for (uint32_t c = 0; c < chunk_count; c++)
+    {
+        const char* split = c + 1 < chunk_count ? data + size * (c + 1) / chunk_count : end;
+        split = split > begin ? _next_line(split - 1, end) : begin;
+        chunks[c].begin = begin;
+        chunks[c].end = split;
+        begin = split;
+    }
+    _parallel_for(chunk_count, chunk_count, [&](uint64_t first, uint64_t last, uint32_t t) {
+        for (uint64_t c = first; c < last; c++)
+            _parse_chunk(&chunks[c]);
+    });
 
-    // Number of indices.
-    uint32_t ni = 0;
+    // Number of elements before each chunk, to resolve the indices.
+    std::vector<int64_t> offsets(3 * chunk_count, 0);
+    int64_t total[3] = {0};
+    bool has_color = false;
+    uint64_t corner_count = 0;
+    for (uint32_t c = 0; c < chunk_count; c++)
+    {
+        offsets[3 * c + 0] = total[0];
+        offsets[3 * c + 1] = total[1];
+        offsets[3 * c + 2] = total[2];
+        total[0] += (int64_t)(chunks[c].pos.size() / 3);
+        total[1] += (int64_t)(chunks[c].texcoords.size() / 2);
+        total[2] += (int64_t)(chunks[c].normal.size() / 3);
+        has_color |= !chunks[c].color.empty();
+        corner_count += chunks[c].corners.size();
+    }
+    if (total[0] == 0 || corner_count == 0 || total[0] > INT32_MAX || corner_count > UINT32_MAX)
+    {
+        log_error("unable to load obj file %s, no faces or too many vertices", file_path);
+        dvz_unmap_file((void*)data, size);
+        return shape;
+    }
+
+    std::vector<uint64_t> invalid(chunk_count, 0);
+    _parallel_for(chunk_count, chunk_count, [&](uint64_t first, uint64_t last, uint32_t t) {
+        for (uint64_t c = first; c < last; c++)
+            invalid[c] = _resolve_chunk(&chunks[c], &offsets[3 * c], total);
+    });
+    bool aligned = true;
+    for (uint32_t c = 0; c < chunk_count; c++)
+    {
+        aligned &= chunks[c].aligned;
+        if (invalid[c] > 0)
+            log_warn("%" PRIu64 " invalid indices in obj file %s", invalid[c], file_path);
+    }
 
-    // Number of shapes in the OBJ file.
-    uint32_t ns = shapes.size();
+    // Concatenate the attributes of all chunks.
+    std::vector<float> pos, color, texcoords, normal;
+    pos.reserve(3 * (uint64_t)total[0]);
+    texcoords.reserve(2 * (uint64_t)total[1]);
+    normal.reserve(3 * (uint64_t)total[2]);
+    for (ObjChunk& chunk : chunks)
+    {
+        pos.insert(pos.end(), chunk.pos.begin(), chunk.pos.end());
+        texcoords.insert(texcoords.end(), chunk.texcoords.begin(), chunk.texcoords.end());
+        normal.insert(normal.end(), chunk.normal.begin(), chunk.normal.end());
+        if (has_color && chunk.color.empty())
+            color.insert(color.end(), chunk.pos.size(), 1.0f);
+        else
+            color.insert(color.end(), chunk.color.begin(), chunk.color.end());
+        std::vector<float>().swap(chunk.pos);
+        std::vector<float>().swap(chunk.texcoords);
+        std::vector<float>().swap(chunk.normal);
+        std::vector<float>().swap(chunk.color);
+    }
+    dvz_unmap_file((void*)data, size);
 
-    // Count the number of indices.
-    // TODO: do not count in a first pass, use C++ resizable containers directly.
-    uint32_t s, f, fv, v;
-    for (s = 0; s < ns; s++) // loop over shapes
+    // Vertices: when all corners use the same index for all attributes (the common case), the
+    // vertices are the OBJ positions. Otherwise, the corners sharing the same indices share the
+    // same vertex.
+    std::vector<ObjCorner> vertices;
+    shape.index_count = (uint32_t)corner_count;
+    shape.index = (DvzIndex*)calloc(corner_count, sizeof(DvzIndex));
+    if (aligned)
+    {
+        vertices.resize((uint64_t)total[0]);
+        for (int32_t i = 0; i < (int32_t)total[0]; i++)
+        {
+            vertices[(uint64_t)i].v = i;
+            vertices[(uint64_t)i].t = i < total[1] ? i : OBJ_NONE;
+            vertices[(uint64_t)i].n = i < total[2] ? i : OBJ_NONE;
+        }
+        uint64_t k = 0;
+        for (const ObjChunk& chunk : chunks)
+            for (const ObjCorner& c : chunk.corners)
+                shape.index[k++] = (DvzIndex)c.v;
+    }
+    else
     {
-        for (f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) // loop over faces
+        vertices.reserve((uint64_t)total[0]);
+        VertexTable table = {};
+        _table_init(table, (uint64_t)total[0]);
+        auto hash = [&](uint32_t i) {
+            const ObjCorner& c = vertices[i];
+            uint64_t tn = ((uint64_t)(uint32_t)c.t << 32) | (uint32_t)c.n;
+            return _mix((uint64_t)(uint32_t)c.v ^ _mix(tn));
+        };
+        auto equal = [&](uint32_t i, uint32_t j) { return vertices[i] == vertices[j]; };
+        uint64_t k = 0;
+        for (const ObjChunk& chunk : chunks)
         {
-            fv = shapes[s].mesh.num_face_vertices[f]; // number of indices per face
-            // NOTE: Only triangle faces for now.
-            if (fv != 3)
+            for (const ObjCorner& c : chunk.corners)
             {
-                log_error("non-triangular OBJ faces (%d vertices) not yet implemented", fv);
-                continue;
+                vertices.push_back(c);
+                uint32_t i = (uint32_t)(vertices.size() - 1);
+                uint32_t j = _table_insert(table, i, hash, equal);
+                if (j != i)
+                    vertices.pop_back();
+                shape.index[k++] = (DvzIndex)j;
             }
-            ni += fv;
         }
     }
-    ASSERT(ni > 0);
-    log_debug("loading shape %d: %d shape(s), %d vertices, %d indices", s, ns, nv, ni);
+    ASSERT(vertices.size() > 0);
+    std::vector<ObjChunk>().swap(chunks);
+
+    uint32_t nv = (uint32_t)vertices.size();
+    log_debug(
+        "loaded obj file %s with %d thread(s): %d vertices, %d indices", //
+        file_path, chunk_count, nv, shape.index_count);
 
     // Create the DvzShape structure.
+    shape.vertex_count = nv;
+    shape.pos = (vec3*)calloc(nv, sizeof(vec3));
+    shape.normal = (vec3*)calloc(nv, sizeof(vec3));
+    shape.color = (cvec4*)calloc(nv, sizeof(cvec4));
+    shape.texcoords = (vec4*)calloc(nv, sizeof(vec4));
 
-    uint32_t vertex_count = nv;
-    uint32_t index_count = ni;
+    std::vector<bool> missing(nv, false);
+    bool has_missing = false;
+    for (uint32_t i = 0; i < nv; i++)
+    {
+        if (vertices[i].n == OBJ_NONE)
+        {
+            missing[i] = true;
+            has_missing = true;
+        }
+    }
 
-    shape.vertex_count = vertex_count;
-    shape.index_count = index_count;
+    uint32_t thread_count = _thread_count(nv, 1 << 18);
+    _parallel_for(nv, thread_count, [&](uint64_t first, uint64_t last, uint32_t t) {
+        for (uint64_t i = first; i < last; i++)
+        {
+            const ObjCorner& c = vertices[i];
+            uint64_t v = (uint64_t)c.v;
 
-    shape.pos = (vec3*)calloc(vertex_count, sizeof(vec3));
-    shape.normal = (vec3*)calloc(vertex_count, sizeof(vec3));
-    shape.color = (cvec4*)calloc(vertex_count, sizeof(cvec4));
-    shape.texcoords = (vec4*)calloc(vertex_count, sizeof(vec4));
-    shape.index = (DvzIndex*)calloc(index_count, sizeof(DvzIndex));
+            shape.pos[i][0] = pos[3 * v + 0];
+            shape.pos[i][1] = pos[3 * v + 1];
+            shape.pos[i][2] = pos[3 * v + 2];
 
-    // Loop over shapes
-    uint32_t i, index_offset, nf;
-    tinyobj::index_t idx;
+            if (c.n != OBJ_NONE)
+            {
+                uint64_t n = (uint64_t)c.n;
+                shape.normal[i][0] = normal[3 * n + 0];
+                shape.normal[i][1] = normal[3 * n + 1];
+                shape.normal[i][2] = normal[3 * n + 2];
+            }
 
-    // Vertices
-    log_debug("loading %d vertices", nv);
-    size_t nv_obj = attrib.vertices.size();
-    size_t nn_obj = attrib.normals.size();
-    size_t nt_obj = attrib.texcoords.size();
-    size_t nc_obj = attrib.colors.size();
+            if (c.t != OBJ_NONE)
+            {
+                uint64_t tc = (uint64_t)c.t;
+                shape.texcoords[i][0] = texcoords[2 * tc + 0];
+                shape.texcoords[i][1] = texcoords[2 * tc + 1];
+            }
 
-    for (i = 0; i < nv; i++)
-    {
-        // Vertex position.
-        ASSERT(3 * i + 2 < nv_obj);
-        shape.pos[i][0] = attrib.vertices[3 * i + 0];
-        shape.pos[i][1] = attrib.vertices[3 * i + 1];
-        shape.pos[i][2] = attrib.vertices[3 * i + 2];
+            shape.color[i][0] = has_color ? TO_BYTE(color[3 * v + 0]) : 255;
+            shape.color[i][1] = has_color ? TO_BYTE(color[3 * v + 1]) : 255;
+            shape.color[i][2] = has_color ? TO_BYTE(color[3 * v + 2]) : 255;
+            shape.color[i][3] = 255;
+        }
+    });
 
-        // Vertex normal.
-        ASSERT(3 * i + 2 < nn_obj);
-        shape.normal[i][0] = attrib.normals[3 * i + 0];
-        shape.normal[i][1] = attrib.normals[3 * i + 1];
-        shape.normal[i][2] = attrib.normals[3 * i + 2];
+    if (has_missing)
+        _compute_normals(&shape, missing);
+
+    dvz_shape_normalize(&shape);
+
+    return shape;
+}
 
-        // Vertex tex coords.
-        if (nt_obj > 0)
+
+
+uint32_t dvz_shape_weld(DvzShape* shape, float epsilon)
+{
+    ANN(shape);
+    ASSERT(epsilon >= 0);
+
+    uint32_t nv = shape->vertex_count;
+    if (nv == 0)
+        return 0;
+    _shape_own(shape);
+
+    // Position of a vertex on the welding grid.
+    auto cell = [&](uint32_t i, uint32_t k) -> int64_t {
+        float x = shape->pos[i][k] + 0.0f; // NOTE: -0 becomes +0
+        if (epsilon > 0)
+            return (int64_t)floor((double)x / epsilon + .5);
+        int32_t bits = 0;
+        memcpy(&bits, &x, sizeof(float));
+        return bits;
+    };
+    auto hash = [&](uint32_t i) {
+        uint64_t h = 0;
+        for (uint32_t k = 0; k < 3; k++)
+            h = _mix(h ^ (uint64_t)cell(i, k));
+        if (shape->normal != NULL)
+            h = _mix_bytes(h, shape->normal[i], sizeof(vec3));
+        if (shape->color != NULL)
+            h = _mix_bytes(h, shape->color[i], sizeof(cvec4));
+        if (shape->texcoords != NULL)
+            h = _mix_bytes(h, shape->texcoords[i], sizeof(vec4));
+        return h;
+    };
+    auto equal = [&](uint32_t i, uint32_t j) {
+        for (uint32_t k = 0; k < 3; k++)
+            if (cell(i, k) != cell(j, k))
+                return false;
+        if (shape->normal != NULL && memcmp(shape->normal[i], shape->normal[j], sizeof(vec3)))
+            return false;
+        if (shape->color != NULL && memcmp(shape->color[i], shape->color[j], sizeof(cvec4)))
+            return false;
+        if (shape->texcoords != NULL &&
+            memcmp(shape->texcoords[i], shape->texcoords[j], sizeof(vec4)))
+            return false;
+        return true;
+    };
+
+    // New index of each vertex, the first vertex of each group of equal vertices is kept.
+    VertexTable table = {};
+    _table_init(table, nv);
+    std::vector<uint32_t> remap(nv);
+    std::vector<uint32_t> kept;
+    kept.reserve(nv);
+    for (uint32_t i = 0; i < nv; i++)
+    {
+        uint32_t j = _table_insert(table, i, hash, equal);
+        if (j == i)
         {
-            ASSERT(2 * i + 1 < nt_obj);
-            shape.texcoords[i][0] = attrib.texcoords[2 * i + 0];
-            shape.texcoords[i][1] = attrib.texcoords[2 * i + 1];
+            remap[i] = (uint32_t)kept.size();
+            kept.push_back(i);
         }
-        else if (nc_obj > 0)
+        else
         {
-            shape.color[i][0] = TO_BYTE(attrib.colors[3 * i + 0]);
-            shape.color[i][1] = TO_BYTE(attrib.colors[3 * i + 1]);
-            shape.color[i][2] = TO_BYTE(attrib.colors[3 * i + 2]);
-            shape.color[i][3] = 255;
+            remap[i] = remap[j];
         }
     }
 
-    // Shapes.
-    i = 0;
-    for (s = 0; s < ns; s++)
-    {
-        // Faces.
-        index_offset = 0;
-        nf = shapes[s].mesh.num_face_vertices.size(); // number of faces in the current shape
-        log_debug("shape #%d: loading %d indices", s, nf);
+    uint32_t count = (uint32_t)kept.size();
+    log_debug("welded %d vertices into %d vertices", nv, count);
 
-        for (f = 0; f < nf; f++) // loop over faces
+    // Indices.
+    if (shape->index == NULL || shape->index_count == 0)
+    {
+        FREE(shape->index);
+        shape->index_count = nv;
+        shape->index = (DvzIndex*)calloc(nv, sizeof(DvzIndex));
+        for (uint32_t i = 0; i < nv; i++)
+            shape->index[i] = (DvzIndex)remap[i];
+    }
+    else
+    {
+        for (uint32_t i = 0; i < shape->index_count; i++)
         {
-            fv = shapes[s].mesh.num_face_vertices[f]; // number of vertices in the face
+            ASSERT(shape->index[i] < nv);
+            shape->index[i] = (DvzIndex)remap[shape->index[i]];
+        }
+    }
 
-            // HACK: skip non-triangular faces for now (need to be triangulated)
-            if (fv != 3)
-                continue;
+    // Vertices: the kept vertices are compacted in place, in order.
+    for (uint32_t k = 0; k < count; k++)
+    {
+        uint32_t i = kept[k];
+        if (i == k)
+            continue;
+        _vec3_copy(shape->pos[i], shape->pos[k]);
+        if (shape->normal != NULL)
+            _vec3_copy(shape->normal[i], shape->normal[k]);
+        if (shape->color != NULL)
+            memcpy(shape->color[k], shape->color[i], sizeof(cvec4));
+        if (shape->texcoords != NULL)
+            glm_vec4_copy(shape->texcoords[i], shape->texcoords[k]);
+    }
+    shape->vertex_count = count;
 
-            // Indices in each face.
-            for (v = 0; v < fv; v++)
-            {
-                idx = shapes[s].mesh.indices[index_offset + v];
-                shape.index[i++] = (DvzIndex)idx.vertex_index;
-            }
-            index_offset += fv;
-        }
+    return count;
+}
+
+
+
+/*************************************************************************************************/
+/*  Binary mesh functions                                                                        */
+/*************************************************************************************************/
+
+static inline uint64_t _aligned(uint64_t offset)
+{
+    return (offset + DVZ_MESH_ALIGNMENT - 1) / DVZ_MESH_ALIGNMENT * DVZ_MESH_ALIGNMENT;
+}
+
+
+
+int dvz_shape_export(DvzShape* shape, const char* path)
+{
+    ANN(shape);
+    ANN(path);
+
+    if (shape->vertex_count == 0 || shape->pos == NULL)
+    {
+        log_error("unable to export an empty shape");
+        return 1;
     }
-    ASSERT(i == ni);
 
-    dvz_shape_normalize(&shape);
+    uint64_t nv = shape->vertex_count;
+    uint64_t ni = shape->index != NULL ? shape->index_count : 0;
+
+    DvzMeshHeader header = {};
+    header.magic = DVZ_MESH_MAGIC;
+    header.version = DVZ_MESH_VERSION;
+    header.type = (uint32_t)shape->type;
+    header.vertex_count = (uint32_t)nv;
+    header.index_count = (uint32_t)ni;
+
+    // Layout of the arrays.
+    const void* arrays[5] = {
+        shape->pos, shape->normal, shape->color, shape->texcoords, ni > 0 ? shape->index : NULL};
+    const uint64_t sizes[5] = {
+        nv * sizeof(vec3), nv * sizeof(vec3), nv * sizeof(cvec4), nv * sizeof(vec4),
+        ni * sizeof(DvzIndex)};
+    uint64_t* offsets[5] = {
+        &header.pos_offset, &header.normal_offset, &header.color_offset, &header.texcoords_offset,
+        &header.index_offset};
+    uint64_t offset = sizeof(DvzMeshHeader);
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        if (arrays[i] == NULL)
+            continue;
+        offset = _aligned(offset);
+        *offsets[i] = offset;
+        offset += sizes[i];
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        log_error("unable to open %s for writing", path);
+        return 1;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    const char padding[DVZ_MESH_ALIGNMENT] = {0};
+    offset = sizeof(DvzMeshHeader);
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        if (arrays[i] == NULL)
+            continue;
+        file.write(padding, (std::streamsize)(*offsets[i] - offset));
+        file.write(reinterpret_cast<const char*>(arrays[i]), (std::streamsize)sizes[i]);
+        offset = *offsets[i] + sizes[i];
+    }
+    file.close();
+
+    log_debug("wrote binary mesh %s with %d vertices, %d indices", path, (int)nv, (int)ni);
+    return file.good() ? 0 : 1;
+}
+
+
+
+DvzShape dvz_shape_mesh(const char* path)
+{
+    ANN(path);
+
+    DvzShape shape = {};
+
+    DvzSize size = 0;
+    uint8_t* data = (uint8_t*)dvz_map_file(path, &size);
+    if (data == NULL)
+        return shape;
+
+    DvzMeshHeader header = {};
+    if (size >= sizeof(DvzMeshHeader))
+        memcpy(&header, data, sizeof(DvzMeshHeader));
+    if (header.magic != DVZ_MESH_MAGIC || header.version != DVZ_MESH_VERSION)
+    {
+        log_error("invalid binary mesh file %s", path);
+        dvz_unmap_file(data, size);
+        return shape;
+    }
+
+    // Check that the arrays are within the file.
+    uint64_t nv = header.vertex_count, ni = header.index_count;
+    const uint64_t offsets[5] = {
+        header.pos_offset, header.normal_offset, header.color_offset, header.texcoords_offset,
+        header.index_offset};
+    const uint64_t sizes[5] = {
+        nv * sizeof(vec3), nv * sizeof(vec3), nv * sizeof(cvec4), nv * sizeof(vec4),
+        ni * sizeof(DvzIndex)};
+    bool valid = nv > 0 && header.pos_offset > 0;
+    for (uint32_t i = 0; i < 5 && valid; i++)
+    {
+        valid = offsets[i] == 0 || (offsets[i] % DVZ_MESH_ALIGNMENT == 0 &&
+                                    offsets[i] >= sizeof(DvzMeshHeader) &&
+                                    offsets[i] + sizes[i] <= size);
+    }
+    if (!valid)
+    {
+        log_error("truncated or corrupted binary mesh file %s", path);
+        dvz_unmap_file(data, size);
+        return shape;
+    }
+
+    shape.type = (DvzShapeType)header.type;
+    shape.vertex_count = (uint32_t)nv;
+    shape.index_count = (uint32_t)ni;
+    shape.pos = (vec3*)(data + header.pos_offset);
+    shape.normal = header.normal_offset > 0 ? (vec3*)(data + header.normal_offset) : NULL;
+    shape.color = header.color_offset > 0 ? (cvec4*)(data + header.color_offset) : NULL;
+    shape.texcoords =
+        header.texcoords_offset > 0 ? (vec4*)(data + header.texcoords_offset) : NULL;
+    shape.index = header.index_offset > 0 ? (DvzIndex*)(data + header.index_offset) : NULL;
+    shape.mapped = data;
+    shape.mapped_size = size;
 
+    log_debug("mapped binary mesh %s (%s)", path, pretty_size(size));
     return shape;
 }
@@ -36,7 +36,7 @@
 /*  Utility functions                                                                            */
 /*************************************************************************************************/
 
-static inline bool _is_vec2_null(vec2 v) { return memcmp(v, (vec2){0, 0}, sizeof(vec2)); }
+static inline bool _is_vec2_null(vec2 v) { return memcmp(v, (vec2){0, 0}, sizeof(vec2)) == 0; }
 
 
 
@@ -298,13 +298,18 @@ void dvz_panzoom_xrange(DvzPanzoom* pz, vec2 xrange)
 {
     // if (0, 0), gets the xrange, otherwise sets it
     ANN(pz);
+    ASSERT(pz->zoom[0] != 0);
     if (_is_vec2_null(xrange))
     {
-        // TODO: compute xrange from pan and zoom
+        // The view is centered on -pan, and the orthographic projection covers [-1/zoom, 1/zoom].
+        xrange[0] = -pz->pan[0] - 1.0f / pz->zoom[0];
+        xrange[1] = -pz->pan[0] + 1.0f / pz->zoom[0];
     }
     else
     {
-        // TODO: compute from pan and zoom from xrange
+        ASSERT(xrange[1] > xrange[0]);
+        pz->pan[0] = -.5f * (xrange[0] + xrange[1]);
+        pz->zoom[0] = 2.0f / (xrange[1] - xrange[0]);
     }
 }
 
@@ -312,16 +317,19 @@ void dvz_panzoom_xrange(DvzPanzoom* pz, vec2 xrange)
 
 void dvz_panzoom_yrange(DvzPanzoom* pz, vec2 yrange)
 {
-    ANN(pz);
     // if (0, 0), gets the yrange, otherwise sets it
     ANN(pz);
+    ASSERT(pz->zoom[1] != 0);
     if (_is_vec2_null(yrange))
     {
-        // TODO: compute yrange from pan and zoom
+        yrange[0] = -pz->pan[1] - 1.0f / pz->zoom[1];
+        yrange[1] = -pz->pan[1] + 1.0f / pz->zoom[1];
     }
     else
     {
-        // TODO: compute from pan and zoom from yrange
+        ASSERT(yrange[1] > yrange[0]);
+        pz->pan[1] = -.5f * (yrange[0] + yrange[1]);
+        pz->zoom[1] = 2.0f / (yrange[1] - yrange[0]);
     }
 }
 
@@ -94,7 +94,7 @@ void dvz_params_bind(DvzParams* params, DvzId graphics_id, uint32_t slot_idx)
     ANN(params);
     ASSERT(params->dual.dat != DVZ_ID_NONE);
 
-    dvz_bind_dat(params->batch, graphics_id, slot_idx, params->dual.dat, 0);
+    dvz_bind_dat(params->batch, graphics_id, slot_idx, params->dual.dat, params->dual.offset);
 }
 
 
@@ -116,6 +116,8 @@ void dvz_params_update(DvzParams* params)
 void dvz_params_destroy(DvzParams* params)
 {
     ANN(params);
+    // NOTE: this releases the suballocation of the params if they are in the scene arena.
     // TODO: destroy the dat
+    dvz_dual_destroy(&params->dual);
     FREE(params);
 }
@@ -13,12 +13,15 @@
 #include "request.h"
 #include "scene/app.h"
 #include "scene/arcball.h"
+#include "scene/arena.h"
 #include "scene/baker.h"
 #include "scene/camera.h"
 #include "scene/graphics.h"
 #include "scene/panzoom.h"
+#include "scene/params.h"
 #include "scene/transform.h"
 #include "scene/viewset.h"
+#include "scene/visual.h"
 #include "scene/visuals/pixel.h"
 
 
@@ -59,6 +62,10 @@ DvzScene* dvz_scene(DvzBatch* batch)
     scene->batch = batch;
     scene->figures = dvz_list();
 
+    // The uniform duals created with this batch from now on are suballocated in the arena.
+    scene->arena = dvz_arena(batch);
+    dvz_arena_batch(scene->arena, batch);
+
     // HACK: even if we don't use textures, we have to bind an empty texture.
     // So we create a mock empty texture.
     dvz_create_tex(batch, DVZ_TEX_2D, DVZ_FORMAT_R8_UNORM, (uvec3){1, 1, 1}, 0);
@@ -74,10 +81,84 @@ DvzScene* dvz_scene(DvzBatch* batch)
 
 
 
+static uint32_t _panel_flush(DvzPanel* panel)
+{
+    ANN(panel);
+    uint32_t count = 0;
+
+    // NOTE: transforms may be shared between panels, a shared transform is only uploaded once as
+    // it is clean after the first flush. The uniforms in the arena are only marked as dirty here,
+    // and counted when the arena is flushed.
+    if (panel->transform != NULL && dvz_transform_flush(panel->transform) &&
+        panel->transform->dual.arena == NULL)
+        count++;
+
+    // Visual params modified with dvz_params_set() since the last frame.
+    if (panel->view == NULL || panel->view->visuals == NULL)
+        return count;
+    uint32_t n = dvz_list_count(panel->view->visuals);
+    DvzVisual* visual = NULL;
+    DvzParams* params = NULL;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        visual = (DvzVisual*)dvz_list_get(panel->view->visuals, i).p;
+        ANN(visual);
+        for (uint32_t j = 0; j < DVZ_MAX_BINDINGS; j++)
+        {
+            params = visual->params[j];
+            if (params != NULL && params->dual.dirty_first != UINT32_MAX)
+            {
+                dvz_params_update(params);
+                count += params->dual.arena == NULL ? 1 : 0;
+            }
+        }
+    }
+    return count;
+}
+
+
+
+uint32_t dvz_scene_flush(DvzScene* scene)
+{
+    ANN(scene);
+
+    uint32_t count = 0;
+    uint32_t n = dvz_list_count(scene->figures);
+    uint32_t m = 0;
+    DvzFigure* fig = NULL;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        fig = (DvzFigure*)dvz_list_get(scene->figures, i).p;
+        ANN(fig);
+        m = dvz_list_count(fig->panels);
+        for (uint32_t j = 0; j < m; j++)
+            count += _panel_flush((DvzPanel*)dvz_list_get(fig->panels, j).p);
+    }
+
+    // One upload per modified arena page, including the viewports updated on resize.
+    if (scene->arena != NULL)
+        count += dvz_arena_flush(scene->arena);
+    if (count > 0)
+        log_trace("scene flush emitted %d upload request(s)", count);
+    return count;
+}
+
+
+
+uint64_t dvz_scene_uploads_saved(DvzScene* scene)
+{
+    ANN(scene);
+    return scene->uploads_saved;
+}
+
+
+
 void dvz_scene_destroy(DvzScene* scene)
 {
     ANN(scene);
     dvz_list_destroy(scene->figures);
+    // NOTE: the batch may have been destroyed already, so the arena is not unregistered here.
+    dvz_arena_destroy(scene->arena);
     FREE(scene);
 }
 
@@ -633,6 +714,17 @@ static void _scene_build(DvzScene* scene)
 
 
 
+// Mark a transform as dirty, it will be uploaded once at the next frame.
+static void _scene_dirty(DvzScene* scene, DvzTransform* tr)
+{
+    ANN(scene);
+    ANN(tr);
+    if (dvz_transform_dirty(tr))
+        scene->uploads_saved++;
+}
+
+
+
 static void _scene_onmouse(DvzClient* client, DvzClientEvent ev)
 {
     ANN(client);
@@ -670,7 +762,7 @@ static void _scene_onmouse(DvzClient* client, DvzClientEvent ev)
         if (dvz_panzoom_mouse(pz, mev))
         {
             _update_panzoom(panel);
-            dvz_transform_update(tr);
+            _scene_dirty(scene, tr);
         }
     }
 
@@ -684,10 +776,13 @@ static void _scene_onmouse(DvzClient* client, DvzClientEvent ev)
             log_warn("no transform set in panel");
             return;
         }
+        bool changed = false;
+
         // Pass the mouse event to the arcball object.
         if (dvz_arcball_mouse(arcball, mev))
         {
             _update_arcball(panel);
+            changed = true;
         }
 
         // Camera zoom.
@@ -695,6 +790,7 @@ static void _scene_onmouse(DvzClient* client, DvzClientEvent ev)
         {
             _camera_zoom(panel->camera, ev.content.m.content.w.dir[1]);
             _update_camera(panel);
+            changed = true;
         }
 
         // Reset the camera after a double-click.
@@ -703,9 +799,11 @@ static void _scene_onmouse(DvzClient* client, DvzClientEvent ev)
             dvz_camera_reset(panel->camera);
             dvz_arcball_reset(panel->arcball);
             _update_camera(panel);
+            changed = true;
         }
 
-        dvz_transform_update(tr);
+        if (changed)
+            _scene_dirty(scene, tr);
     }
 }
 
@@ -753,6 +851,9 @@ static void _scene_onframe(DvzClient* client, DvzClientEvent ev)
 
     _scene_build(scene);
 
+    // Upload the transforms and params modified since the last frame, once.
+    dvz_scene_flush(scene);
+
     dvz_app_submit(scene->app);
 }
 
@@ -771,8 +872,9 @@ void dvz_scene_run(DvzScene* scene, DvzApp* app, uint64_t n_frames)
     dvz_app_onresize(app, _scene_onresize, scene);
     dvz_app_onframe(app, _scene_onframe, scene);
 
-    // Initial build of the scene.
+    // Initial build of the scene, and upload of the uniforms set before running the scene.
     _scene_build(scene);
+    dvz_scene_flush(scene);
 
     // Run the app.
     dvz_app_run(app, n_frames);
@@ -8,6 +8,7 @@
 /*************************************************************************************************/
 
 #include "scene/shape.h"
+#include "fileio.h"
 
 
 
@@ -34,6 +35,15 @@ void dvz_shape_print(DvzShape* shape)
 void dvz_shape_destroy(DvzShape* shape)
 {
     ANN(shape);
+
+    // The arrays of a mapped binary mesh belong to the mapping.
+    if (shape->mapped != NULL)
+    {
+        dvz_unmap_file(shape->mapped, shape->mapped_size);
+        memset(shape, 0, sizeof(DvzShape));
+        return;
+    }
+
     FREE(shape->pos);
     FREE(shape->index);
     FREE(shape->color);
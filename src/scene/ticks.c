@@ -207,7 +207,7 @@ DVZ_INLINE double estimate_label_length(DvzTicksFormat format, double x)
 
 
 
-DVZ_INLINE double min_distance_labels(DvzTicks* ticks)
+DVZ_INLINE double min_distance_labels(DvzTicks* ticks, uint32_t n, double label_length)
 {
     ANN(ticks);
     double size = ticks->range_size;
@@ -222,16 +222,7 @@ DVZ_INLINE double min_distance_labels(DvzTicks* ticks)
     if (lmin >= lmax)
         return 0;
     ASSERT(lmax - lmin > 0);
-
-    uint32_t n = tick_count(lmin, lmax, lstep); // number of labels
     ASSERT(n > 0);
-    double label_length = 0, x = 0;
-    for (uint32_t i = 0; i < n; i++)
-    {
-        x = lmin + i * lstep;
-        label_length += estimate_label_length(ticks->format, x); // number of glyphs per label
-    }
-    label_length /= n;
 
     // minimum distance between two labels under the simplifying assumption that all labels have
     // the same size.
@@ -241,44 +232,102 @@ DVZ_INLINE double min_distance_labels(DvzTicks* ticks)
 
 
 
-static inline double legibility(DvzTicks* ticks)
+// Optimize format for legibility, and return the legibility of the best format.
+// The ticks are only scanned once for all formats: the format part of the legibility only
+// depends on the number of ticks in a few magnitude ranges, and the label length estimates only
+// depend on the values for the decimal format.
+static inline double opt_format(DvzTicks* ticks)
 {
+    ANN(ticks);
+
     double lmin = ticks->lmin;
     double lmax = ticks->lmax;
     double lstep = ticks->lstep;
     uint32_t n = tick_count(lmin, lmax, lstep);
+    ticks->stats.candidates++;
     if (n == 0)
+    {
+        ticks->format = (DvzTicksFormat)(DVZ_TICKS_FORMAT_COUNT - 1);
         return -INF;
+    }
 
     ASSERT(n > 0);
     ASSERT(lmin < lmax);
     ASSERT(lstep > 0);
 
-    double f = 0;
-
-    // Format part.
-    double x = 0;
+    // Single pass over the ticks.
+    uint32_t n_nonzero = 0, n_decimal = 0, n_thousands = 0, n_millions = 0;
+    double decimal_length = 0; // sum of the label lengths in the decimal format
+    double x = 0, ax = 0;
     for (uint32_t i = 0; i < n; i++)
     {
         x = lmin + i * lstep;
         ASSERT(x <= lmax + .5 * lstep);
-        f += leg(ticks->format, x);
+        ax = fabs(x);
+
+        n_decimal += BETWEEN(1e-4, 1e+6);
+        n_thousands += BETWEEN(1e+3, 1e+6);
+        n_millions += BETWEEN(1e+6, 1e+9);
+        if (x != 0)
+        {
+            n_nonzero++;
+            decimal_length += estimate_label_length(DVZ_TICKS_FORMAT_DECIMAL, x);
+        }
     }
-    f = .9 * f / MAX(1, n);
-    f += .1;
-    // NOTE: need to add 0.1 if all ticks are extended with 0 such that all
-    // have the same number of decimals.
 
-    // Overlap part.
-    double o = overlap(min_distance_labels(ticks));
+    double f = 0, o = 0, l = 0, length = 0, best_l = -INF;
+    DvzTicksFormat format = DVZ_TICKS_FORMAT_UNDEFINED;
+    DvzTicksFormat best_format = DVZ_TICKS_FORMAT_UNDEFINED;
+    for (uint32_t i = 1; i < DVZ_TICKS_FORMAT_COUNT; i++)
+    {
+        format = (DvzTicksFormat)i;
+
+        // Format part.
+        switch (format)
+        {
+        case DVZ_TICKS_FORMAT_DECIMAL:
+            f = n_decimal;
+            length = decimal_length;
+            break;
+        case DVZ_TICKS_FORMAT_THOUSANDS:
+        case DVZ_TICKS_FORMAT_THOUSANDS_FACTORED:
+            f = leg(format, 1e+4) * n_thousands;
+            length = estimate_label_length(format, 1) * n_nonzero;
+            break;
+        case DVZ_TICKS_FORMAT_MILLIONS:
+        case DVZ_TICKS_FORMAT_MILLIONS_FACTORED:
+            f = leg(format, 1e+7) * n_millions;
+            length = estimate_label_length(format, 1) * n_nonzero;
+            break;
+        default:
+            f = leg(format, 1) * n;
+            length = estimate_label_length(format, 1) * n_nonzero;
+            break;
+        }
+        f = .9 * f / MAX(1, n);
+        f += .1;
+        // NOTE: need to add 0.1 if all ticks are extended with 0 such that all
+        // have the same number of decimals.
 
-    ASSERT(f <= 1.0 + EPS);
-    ASSERT(o <= 1.0 + EPS);
+        // Overlap part.
+        o = overlap(min_distance_labels(ticks, n, length / n));
 
-    double out = (f + o) / 2.0;
-    if (out < -INF / 10)
-        out = -INF;
-    return out;
+        ASSERT(f <= 1.0 + EPS);
+        ASSERT(o <= 1.0 + EPS);
+
+        l = (f + o) / 2.0;
+        if (l < -INF / 10)
+            l = -INF;
+        if (l > best_l)
+        {
+            best_format = format;
+            best_l = l;
+        }
+    }
+
+    // NOTE: if no format is legible, keep the last one.
+    ticks->format = best_format != DVZ_TICKS_FORMAT_UNDEFINED ? best_format : format;
+    return best_l;
 }
 
 
@@ -303,25 +352,109 @@ score(dvec4 weights, double simplicity, double coverage, double density, double
 /*  Algorithm                                                                                    */
 /*************************************************************************************************/
 
-// Optimize format for legibility.
-static inline void opt_format(DvzTicks* ticks)
+static const double DEFAULT_Q[] = {1, 5, 2, 2.5, 4, 3};
+#define Q_COUNT ((int32_t)(sizeof(DEFAULT_Q) / sizeof(DEFAULT_Q[0])))
+
+
+
+static inline Q nice_number(int32_t i)
 {
-    double l = -INF, best_l = -INF;
-    DvzTicksFormat best_format = DVZ_TICKS_FORMAT_UNDEFINED;
-    for (uint32_t f = 1; f < DVZ_TICKS_FORMAT_COUNT; f++)
+    ASSERT(0 <= i && i < Q_COUNT);
+    Q q = {0};
+    q.i = i;
+    q.len = Q_COUNT;
+    q.value = DEFAULT_Q[i];
+    return q;
+}
+
+
+
+// Score all tick sequences with a given nice number, skip, label count, and step exponent, and
+// update the best solution. The coverage is a quadratic function of the first tick, maximal when
+// the ticks are centered on the data range: the first ticks are restricted to the interval where
+// the coverage bound may still beat the best score.
+static double search_starts(
+    DvzTicks* ticks, int32_t m, Q q, int32_t j, int32_t k, double z, double min_start,
+    double max_start, double best_score, DvzTicksEntry* best)
+{
+    ANN(ticks);
+    ANN(best);
+
+    double dmin = ticks->dmin;
+    double dmax = ticks->dmax;
+    dvec4 W = SCORE_WEIGHTS; // score weights
+
+    double step = j * q.value * pow(10., z);
+    ASSERT(step > 0);
+    double span = step * (k - 1.0);
+    double center = .5 * (dmin + dmax - span); // lmin with the maximal coverage
+
+    // Minimal coverage to beat the best score, and the corresponding interval of lmin, with
+    // coverage = 1 - ((lmin - center)^2 + (dmax - dmin - span)^2 / 4) / (0.1 * (dmax - dmin))^2
+    double sm = simplicity_max(q, j);
+    double dm = density_max(k, m);
+    if (best_score > -INF)
     {
-        ticks->format = (DvzTicksFormat)f;
-        l = legibility(ticks);
-        if (l > best_l)
-        {
-            best_format = ticks->format;
-            best_l = l;
-        }
+        double cmin = (best_score - W[0] * sm - W[2] * dm - W[3]) / W[1];
+        double r = pow(0.1 * (dmax - dmin), 2) * (1 - cmin) - .25 * pow(dmax - dmin - span, 2);
+        if (r < 0)
+            return best_score;
+        r = sqrt(r) * (1 + EPS) + EPS * step;
+        // NOTE: adding 0 turns a -0 start into 0.
+        min_start = fmax(min_start, ceil((center - r) / (step / j)) + 0.);
+        max_start = fmin(max_start, floor((center + r) / (step / j)) + 0.);
     }
-    if (best_format != DVZ_TICKS_FORMAT_UNDEFINED)
+
+    double lmin, lmax, lstep, start, s, c, d, l, scr;
+    for (start = min_start; start <= max_start; start++)
     {
-        ticks->format = best_format;
+        lmin = start * (step / j);
+        lmax = lmin + span;
+        lstep = step;
+
+        ticks->lmin = lmin;
+        ticks->lmax = lmax;
+        ticks->lstep = lstep;
+
+        s = simplicity(q, j, lmin, lmax, lstep);
+        c = coverage(dmin, dmax, lmin, lmax);
+        d = density(k, m, dmin, dmax, lmin, lmax);
+
+        if (score(W, s, c, d, 1) <= best_score)
+            continue;
+
+        // The following optimizes format in-place.
+        l = opt_format(ticks);
+
+        scr = score(W, s, c, d, l);
+        if (scr > best_score)
+        {
+            best_score = scr;
+            // Keep track of the best result so far.
+            best->lmin = lmin;
+            best->lmax = lmax;
+            best->lstep = lstep;
+
+            // Best format is stored in the ticks struct.
+            best->format = ticks->format;
+
+            best->q = q.i;
+            best->j = j;
+            best->k = k;
+            best->z = (int32_t)z;
+        }
     }
+    return best_score;
+}
+
+
+
+static inline void start_range(
+    double dmin, double dmax, double step, int32_t j, int32_t k, double* min_start,
+    double* max_start)
+{
+    *min_start = floor(dmax / step) * j - (k - 1.) * j;
+    *max_start = ceil(dmin / step) * j;
 }
 
 
@@ -332,8 +465,12 @@ m : requested number of labels
 q : nice number
 j : skip, amount among a sequence of nice numbers
 z : 10-exponent of the step size
+
+If warm is true, the previous solution is scored first on the new range. Its score is a lower
+bound of the best score, which prunes most of the search tree when the range moved by less than
+one step. Returns false if no solution was found, in which case the ticks are left unchanged.
 */
-static void wilk_ext(DvzTicks* ticks, int32_t m)
+static bool wilk_ext(DvzTicks* ticks, int32_t m, bool warm)
 {
     ANN(ticks);
 
@@ -342,7 +479,7 @@ static void wilk_ext(DvzTicks* ticks, int32_t m)
     double range_size = ticks->range_size;
     double glyph_size = ticks->glyph_size;
 
-    log_debug(
+    log_trace(
         "starting extended Wilkinson algorithm for tick positioning: [%.3f, %.3f]", dmin, dmax);
 
     ASSERT(dmin <= dmax);
@@ -352,34 +489,40 @@ static void wilk_ext(DvzTicks* ticks, int32_t m)
     if (range_size < 10 * glyph_size)
     {
         log_debug("degenerate axes context, return a trivial tick range");
-        return;
+        return false;
     }
 
-    double DEFAULT_Q[] = {1, 5, 2, 2.5, 4, 3};
     dvec4 W = SCORE_WEIGHTS; // score weights
 
-    double n = (double)sizeof(DEFAULT_Q) / sizeof(DEFAULT_Q[0]);
     double best_score = -INF;
     Q q = {0};
-    q.i = 0;
-    q.len = n;
-    q.value = DEFAULT_Q[0];
-    // q.values = DEFAULT_Q;
 
-    DvzTicks best_ticks = {0};
-    best_ticks = *ticks;
+    DvzTicksEntry best = {0};
+    best.lmin = ticks->lmin;
+    best.lmax = ticks->lmax;
+    best.lstep = ticks->lstep;
+    best.format = ticks->format;
+
     int32_t j = 1;
     int32_t u, k;
-    double sm, dm, delta, z, step, cm, min_start, max_start, l, lmin, lmax, lstep, start, s, c, d,
-        scr;
+    double sm, dm, delta, z, step, cm, min_start, max_start;
+
+    // Warm start with the previous solution.
+    if (warm && ticks->k > 0)
+    {
+        q = nice_number(ticks->q);
+        step = ticks->j * q.value * pow(10., ticks->z);
+        start_range(dmin, dmax, step, ticks->j, ticks->k, &min_start, &max_start);
+        best_score = search_starts(
+            ticks, m, q, ticks->j, ticks->k, ticks->z, min_start, max_start, best_score, &best);
+        ticks->stats.warm_starts++;
+    }
+
     while (j < J_MAX)
     {
-        // printf("j %d\n", j);
-        for (u = 0; u < n; u++)
+        for (u = 0; u < Q_COUNT; u++)
         {
-            // printf("u %d\n", u);
-            q.i = u;
-            q.value = DEFAULT_Q[q.i];
+            q = nice_number(u);
             sm = simplicity_max(q, j);
 
             if (score(W, sm, 1, 1, 1) <= best_score)
@@ -391,7 +534,6 @@ static void wilk_ext(DvzTicks* ticks, int32_t m)
             k = 2;
             while (k < K_MAX)
             {
-                // printf("k %d\n", k);
                 dm = density_max(k, m);
 
                 if (score(W, sm, 1, dm, 1) <= best_score)
@@ -402,7 +544,6 @@ static void wilk_ext(DvzTicks* ticks, int32_t m)
 
                 while (z < Z_MAX)
                 {
-                    // printf("z %f\n", z);
                     ASSERT(j > 0);
                     ASSERT(q.value > 0);
                     step = j * q.value * pow(10., z);
@@ -412,8 +553,7 @@ static void wilk_ext(DvzTicks* ticks, int32_t m)
                     if (score(W, sm, cm, dm, 1) <= best_score)
                         break;
 
-                    min_start = floor(dmax / step) * j - (k - 1.) * j;
-                    max_start = ceil(dmin / step) * j;
+                    start_range(dmin, dmax, step, j, k, &min_start, &max_start);
 
                     if (min_start > max_start)
                     {
@@ -421,40 +561,8 @@ static void wilk_ext(DvzTicks* ticks, int32_t m)
                         break;
                     }
 
-                    for (start = min_start; start <= max_start; start++)
-                    {
-                        lmin = start * (step / j);
-                        lmax = lmin + step * (k - 1.0);
-                        lstep = step;
-
-                        ticks->lmin = lmin;
-                        ticks->lmax = lmax;
-                        ticks->lstep = lstep;
-
-                        s = simplicity(q, j, lmin, lmax, lstep);
-                        c = coverage(dmin, dmax, lmin, lmax);
-                        d = density(k, m, dmin, dmax, lmin, lmax);
-
-                        if (score(W, s, c, d, 1) <= best_score)
-                            continue;
-
-                        // The following optimizes format in-place.
-                        opt_format(ticks);
-                        l = legibility(ticks);
-
-                        scr = score(W, s, c, d, l);
-                        if (scr > best_score)
-                        {
-                            best_score = scr;
-                            // Keep track of the best result so far.
-                            best_ticks.lmin = lmin;
-                            best_ticks.lmax = lmax;
-                            best_ticks.lstep = lstep;
-
-                            // Best format is stored in the ticks struct.
-                            best_ticks.format = ticks->format;
-                        }
-                    }
+                    best_score = search_starts(
+                        ticks, m, q, j, k, z, min_start, max_start, best_score, &best);
                     z++;
                 }
                 k++;
@@ -463,10 +571,68 @@ static void wilk_ext(DvzTicks* ticks, int32_t m)
         j++;
     }
 
-    ticks->lmin = best_ticks.lmin;
-    ticks->lmax = best_ticks.lmax;
-    ticks->lstep = best_ticks.lstep;
-    ticks->format = best_ticks.format;
+    ticks->lmin = best.lmin;
+    ticks->lmax = best.lmax;
+    ticks->lstep = best.lstep;
+    ticks->format = best.format;
+    ticks->q = best.q;
+    ticks->j = best.j;
+    ticks->k = best.k;
+    ticks->z = best.z;
+
+    return best.k > 0;
+}
+
+
+
+/*************************************************************************************************/
+/*  Solution cache                                                                               */
+/*************************************************************************************************/
+
+// The key is the range quantized with a resolution relative to the range size, so that
+// panning back and forth over the same ranges hits the cache.
+static bool cache_key(DvzTicks* ticks, int32_t m, int64_t* key)
+{
+    ANN(ticks);
+    ANN(key);
+
+    double span = ticks->dmax - ticks->dmin;
+    if (!(span > 0))
+        return false;
+
+    int e = 0;
+    frexp(span, &e);
+    double ulp = ldexp(1., e - DVZ_TICKS_CACHE_BITS);
+    double a = ticks->dmin / ulp;
+    double b = ticks->dmax / ulp;
+    if (fabs(a) > 1e18 || fabs(b) > 1e18)
+        return false;
+
+    key[0] = llround(a);
+    key[1] = llround(b);
+    key[2] = llround(ticks->range_size);
+    key[3] = llround(ticks->glyph_size * 256);
+    key[4] = (int64_t)e * (1LL << 32) + m;
+    return true;
+}
+
+
+
+static inline uint32_t cache_slot(int64_t* key)
+{
+    ANN(key);
+
+    // Combine the key words with the splitmix64 finalizer, so that the low bits depend on all
+    // bits of the key.
+    uint64_t h = 0;
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        h ^= (uint64_t)key[i] + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+    }
+    return (uint32_t)(h & (DVZ_TICKS_CACHE_SIZE - 1));
 }
 
 
@@ -498,8 +664,6 @@ void dvz_ticks_size(DvzTicks* ticks, double range_size, double glyph_size)
 bool dvz_ticks_compute(DvzTicks* ticks, double dmin, double dmax, uint32_t requested_count)
 {
     ANN(ticks);
-    ticks->dmin = dmin;
-    ticks->dmax = dmax;
 
     // Keep track of the initial parameters.
     double lmin = ticks->lmin;
@@ -507,9 +671,45 @@ bool dvz_ticks_compute(DvzTicks* ticks, double dmin, double dmax, uint32_t reque
     double lstep = ticks->lstep;
     DvzTicksFormat format = ticks->format;
 
-    // Run the algorithm.
+    // Warm-start the search if the range moved by less than one step.
+    bool warm = lstep > 0 && fabs(dmin - ticks->dmin) < lstep && fabs(dmax - ticks->dmax) < lstep;
+
+    ticks->dmin = dmin;
+    ticks->dmax = dmax;
+    ticks->stats.computes++;
+
+    // Look up the solution cache.
     int32_t m = (int32_t)requested_count;
-    wilk_ext(ticks, m);
+    int64_t key[5] = {0};
+    bool cacheable = cache_key(ticks, m, key);
+    DvzTicksEntry* entry = cacheable ? &ticks->cache[cache_slot(key)] : NULL;
+    if (entry != NULL && entry->valid && memcmp(entry->key, key, sizeof(key)) == 0)
+    {
+        ticks->lmin = entry->lmin;
+        ticks->lmax = entry->lmax;
+        ticks->lstep = entry->lstep;
+        ticks->format = entry->format;
+        ticks->q = entry->q;
+        ticks->j = entry->j;
+        ticks->k = entry->k;
+        ticks->z = entry->z;
+        ticks->stats.cache_hits++;
+    }
+
+    // Run the algorithm.
+    else if (wilk_ext(ticks, m, warm) && entry != NULL)
+    {
+        memcpy(entry->key, key, sizeof(key));
+        entry->valid = true;
+        entry->lmin = ticks->lmin;
+        entry->lmax = ticks->lmax;
+        entry->lstep = ticks->lstep;
+        entry->format = ticks->format;
+        entry->q = ticks->q;
+        entry->j = ticks->j;
+        entry->k = ticks->k;
+        entry->z = ticks->z;
+    }
 
     // Determine whether the parameters are different.
     bool has_changed =
@@ -519,10 +719,10 @@ bool dvz_ticks_compute(DvzTicks* ticks, double dmin, double dmax, uint32_t reque
          (format != ticks->format)      //
         );
 
-    log_info(
+    log_trace(
         "extended Wilkinson algorithm finished (changed %d): "
         "lmin=%.3f, lmax=%.3f, lstep=%.3f",
-        has_changed, lmin, lmax, lstep);
+        has_changed, ticks->lmin, ticks->lmax, ticks->lstep);
 
     return has_changed;
 }
@@ -596,6 +796,14 @@ void dvz_ticks_print(DvzTicks* ticks)
 
 
 
+DvzTicksStats dvz_ticks_stats(DvzTicks* ticks)
+{
+    ANN(ticks);
+    return ticks->stats;
+}
+
+
+
 void dvz_ticks_destroy(DvzTicks* ticks)
 {
     ANN(ticks);
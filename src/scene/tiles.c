@@ -0,0 +1,738 @@
+/*************************************************************************************************/
+/*  Tiles                                                                                        */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "scene/tiles.h"
+#include "_thread.h"
+#include "fifo.h"
+#include "fileio.h"
+#include "request.h"
+#include "scene/panzoom.h"
+#include "scene/visual.h"
+#include "scene/visuals/image.h"
+
+
+
+/*************************************************************************************************/
+/*  Utils                                                                                        */
+/*************************************************************************************************/
+
+static inline uint32_t _ceil_shift(uint32_t n, uint32_t level)
+{
+    return (uint32_t)(((uint64_t)n + (1ull << level) - 1) >> level);
+}
+
+
+
+// Return the level of a tile and its coordinates within the tile grid of that level.
+static uint32_t _tile_coords(DvzTiles* tiles, uint32_t tile, uvec2 coords)
+{
+    ANN(tiles);
+    ASSERT(tile < tiles->tile_count);
+
+    // NOTE: the finest level starts at 0, the coarsest level comes last.
+    uint32_t level = 0;
+    for (level = 0; level < tiles->level_count - 1; level++)
+        if (tile < tiles->level_offset[level + 1])
+            break;
+
+    uint32_t i = tile - tiles->level_offset[level];
+    coords[0] = i % tiles->grid[level][0];
+    coords[1] = i / tiles->grid[level][0];
+    return level;
+}
+
+
+
+static inline uint32_t _tile_index(DvzTiles* tiles, uint32_t level, uint32_t x, uint32_t y)
+{
+    ANN(tiles);
+    ASSERT(x < tiles->grid[level][0] && y < tiles->grid[level][1]);
+    return tiles->level_offset[level] + y * tiles->grid[level][0] + x;
+}
+
+
+
+// Size of a tile in pixels of its level, smaller than the tile size on the right and bottom edges.
+static void _tile_size(DvzTiles* tiles, uint32_t level, uvec2 coords, uvec2 size)
+{
+    ANN(tiles);
+    uint32_t lw = _ceil_shift(tiles->width, level);
+    uint32_t lh = _ceil_shift(tiles->height, level);
+    size[0] = MIN(DVZ_TILE_SIZE, lw - coords[0] * DVZ_TILE_SIZE);
+    size[1] = MIN(DVZ_TILE_SIZE, lh - coords[1] * DVZ_TILE_SIZE);
+}
+
+
+
+// Copy a tile from the source image. The pixels beyond the image edges repeat the edge pixels.
+// NOTE: the coarser levels are obtained by point sampling the finest level (pixel i of level l is
+// pixel i * 2^l of level 0), so that a tile only reads DVZ_TILE_SIZE^2 pixels from the source.
+static void _tile_extract(DvzTiles* tiles, uint32_t tile, uint8_t* out)
+{
+    ANN(tiles);
+    ANN(tiles->data);
+    ANN(out);
+
+    uvec2 coords = {0}, size = {0};
+    uint32_t level = _tile_coords(tiles, tile, coords);
+    _tile_size(tiles, level, coords, size);
+
+    const uint32_t T = DVZ_TILE_SIZE;
+    DvzSize ps = tiles->pixel_size;
+    DvzSize w = tiles->width;
+    uint32_t x0 = coords[0] * T, y0 = coords[1] * T;
+    uint32_t x = 0, y = 0;
+    uint8_t* row = NULL;
+
+    for (uint32_t j = 0; j < T; j++)
+    {
+        y = (y0 + MIN(j, size[1] - 1)) << level;
+        row = &out[j * T * ps];
+
+        if (level == 0)
+        {
+            // Finest level: contiguous rows.
+            memcpy(row, &tiles->data[(y * w + x0) * ps], size[0] * ps);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < size[0]; i++)
+            {
+                x = (x0 + i) << level;
+                memcpy(&row[i * ps], &tiles->data[(y * w + x) * ps], ps);
+            }
+        }
+
+        // Repeat the last pixel up to the tile size, for linear filtering at the image edges.
+        for (uint32_t i = size[0]; i < T; i++)
+            memcpy(&row[i * ps], &row[(size[0] - 1) * ps], ps);
+    }
+}
+
+
+
+static void* _worker(void* user_data)
+{
+    DvzTiles* tiles = (DvzTiles*)user_data;
+    ANN(tiles);
+
+    DvzTileJob* job = NULL;
+    while (true)
+    {
+        // NULL is the stop signal.
+        job = (DvzTileJob*)dvz_fifo_dequeue(tiles->jobs, true);
+        if (job == NULL)
+            break;
+        _tile_extract(tiles, job->tile, job->data);
+        dvz_fifo_enqueue(tiles->done, job);
+    }
+    return NULL;
+}
+
+
+
+static void _job_submit(DvzTiles* tiles, uint32_t tile)
+{
+    ANN(tiles);
+    ASSERT(tiles->job_free_count > 0);
+    ASSERT(!tiles->tile_pending[tile]);
+
+    DvzTileJob* job = tiles->job_free[--tiles->job_free_count];
+    ANN(job);
+    job->tile = tile;
+    tiles->tile_pending[tile] = true;
+
+    if (tiles->thread_count == 0)
+    {
+        _tile_extract(tiles, tile, job->data);
+        dvz_fifo_enqueue(tiles->done, job);
+    }
+    else
+    {
+        dvz_fifo_enqueue(tiles->jobs, job);
+    }
+}
+
+
+
+// Find a slot for a new tile: a free slot, or the least recently used slot that was not requested
+// in the current update.
+static int32_t _slot_find(DvzTiles* tiles)
+{
+    ANN(tiles);
+    int32_t best = -1;
+    uint64_t oldest = UINT64_MAX;
+    for (uint32_t s = 0; s < tiles->slot_count; s++)
+    {
+        if (tiles->slot_tile[s] < 0)
+            return (int32_t)s;
+        if (tiles->slot_used[s] < tiles->update && tiles->slot_used[s] < oldest)
+        {
+            oldest = tiles->slot_used[s];
+            best = (int32_t)s;
+        }
+    }
+    return best;
+}
+
+
+
+// Upload a loaded tile to the atlas, and release its job. Return whether it was uploaded.
+static bool _job_upload(DvzTiles* tiles, DvzTileJob* job)
+{
+    ANN(tiles);
+    ANN(job);
+
+    uint32_t tile = job->tile;
+    tiles->tile_pending[tile] = false;
+    tiles->job_free[tiles->job_free_count++] = job;
+
+    int32_t slot = _slot_find(tiles);
+    if (slot < 0)
+        return false;
+
+    // Evict the previous tile.
+    int32_t old = tiles->slot_tile[slot];
+    if (old >= 0)
+    {
+        tiles->tile_slot[old] = -1;
+        tiles->stats.evictions++;
+        tiles->stats.resident--;
+    }
+
+    const uint32_t T = DVZ_TILE_SIZE;
+    uint32_t ax = tiles->atlas_shape[0];
+    uvec3 offset = {((uint32_t)slot % ax) * T, ((uint32_t)slot / ax) * T, 0};
+    uvec3 shape = {T, T, 1};
+    DvzSize size = T * T * tiles->pixel_size;
+    // NOTE: the data is copied in the request, so the job buffer can be reused right away.
+    dvz_upload_tex(tiles->batch, tiles->atlas, offset, shape, size, job->data, 0);
+
+    tiles->slot_tile[slot] = (int32_t)tile;
+    tiles->tile_slot[tile] = slot;
+    tiles->slot_used[slot] = tiles->update;
+    tiles->stats.loads++;
+    tiles->stats.resident++;
+    return true;
+}
+
+
+
+// Visible tile range [x0, x1[ x [y0, y1[ at a given level, from the visible image fractions.
+static uint32_t _visible(DvzTiles* tiles, uint32_t level, vec4 frac, uint32_t* range)
+{
+    ANN(tiles);
+    ANN(range);
+    float lw = (float)_ceil_shift(tiles->width, level) / DVZ_TILE_SIZE;
+    float lh = (float)_ceil_shift(tiles->height, level) / DVZ_TILE_SIZE;
+    range[0] = (uint32_t)floorf(frac[0] * lw);
+    range[1] = (uint32_t)floorf(frac[1] * lh);
+    range[2] = MIN((uint32_t)ceilf(frac[2] * lw), tiles->grid[level][0]);
+    range[3] = MIN((uint32_t)ceilf(frac[3] * lh), tiles->grid[level][1]);
+    if (range[2] <= range[0] || range[3] <= range[1])
+        return 0;
+    return (range[2] - range[0]) * (range[3] - range[1]);
+}
+
+
+
+// Select the tiles needed for the current view: the coarsest level, and the visible tiles at the
+// level where an image pixel is about one screen pixel.
+static uint32_t _select(DvzTiles* tiles, DvzPanzoom* pz)
+{
+    ANN(tiles);
+    ANN(pz);
+
+    uint32_t* req = tiles->requests;
+    uint32_t n = 0;
+
+    // The coarsest level is always requested.
+    uint32_t top = tiles->level_count - 1;
+    uint32_t top_count = tiles->grid[top][0] * tiles->grid[top][1];
+    for (uint32_t i = 0; i < top_count; i++)
+        req[n++] = tiles->level_offset[top] + i;
+
+    // Visible range in data coordinates.
+    vec2 xrange = {0}, yrange = {0};
+    dvz_panzoom_xrange(pz, xrange);
+    dvz_panzoom_yrange(pz, yrange);
+
+    // Visible fractions of the image, with (0, 0) at the upper left corner.
+    float* p = tiles->ul_lr;
+    float fx0 = (xrange[0] - p[0]) / (p[2] - p[0]), fx1 = (xrange[1] - p[0]) / (p[2] - p[0]);
+    float fy0 = (yrange[0] - p[1]) / (p[3] - p[1]), fy1 = (yrange[1] - p[1]) / (p[3] - p[1]);
+    vec4 frac = {
+        CLIP(MIN(fx0, fx1), 0, 1), CLIP(MIN(fy0, fy1), 0, 1), //
+        CLIP(MAX(fx0, fx1), 0, 1), CLIP(MAX(fy0, fy1), 0, 1)};
+
+    // Number of image pixels per screen pixel at the finest level.
+    float rx = fabsf(fx1 - fx0) * tiles->width / MAX(pz->viewport_size[0], 1);
+    float ry = fabsf(fy1 - fy0) * tiles->height / MAX(pz->viewport_size[1], 1);
+    float ratio = MAX(rx, ry);
+    uint32_t level = ratio > 1 ? (uint32_t)floorf(log2f(ratio)) : 0;
+    level = MIN(level, top);
+
+    // Go to a coarser level if the visible tiles do not fit in the atlas.
+    uint32_t range[4] = {0};
+    uint32_t count = _visible(tiles, level, frac, range);
+    while (level < top && count + top_count > tiles->slot_count)
+        count = _visible(tiles, ++level, frac, range);
+    tiles->level = level;
+
+    if (level < top)
+        for (uint32_t y = range[1]; y < range[3]; y++)
+            for (uint32_t x = range[0]; x < range[2]; x++)
+                req[n++] = _tile_index(tiles, level, x, y);
+
+    ASSERT(n <= MAX(tiles->slot_count, top_count));
+    return n;
+}
+
+
+
+// Rebuild the quads of the visual: the resident tiles from the coarsest level down to the current
+// level, so that the finer tiles are drawn on top of the coarser ones.
+static void _quads_update(DvzTiles* tiles)
+{
+    ANN(tiles);
+    ANN(tiles->visual);
+
+    const float T = DVZ_TILE_SIZE;
+    float aw = tiles->atlas_shape[0] * T;
+    float ah = tiles->atlas_shape[1] * T;
+    float* p = tiles->ul_lr;
+
+    memset(tiles->quad_pos, 0, tiles->slot_count * sizeof(vec4));
+    memset(tiles->quad_uv, 0, tiles->slot_count * sizeof(vec4));
+
+    uint32_t n = 0;
+    int32_t tile = 0;
+    uvec2 coords = {0}, size = {0};
+    float scale = 0, fx0 = 0, fy0 = 0, fx1 = 0, fy1 = 0, u = 0, v = 0;
+    for (int32_t level = (int32_t)tiles->level_count - 1; level >= (int32_t)tiles->level; level--)
+    {
+        for (uint32_t s = 0; s < tiles->slot_count; s++)
+        {
+            tile = tiles->slot_tile[s];
+            if (tile < 0 || _tile_coords(tiles, (uint32_t)tile, coords) != (uint32_t)level)
+                continue;
+            _tile_size(tiles, (uint32_t)level, coords, size);
+
+            // Tile position, as fractions of the image.
+            scale = (float)(1u << level);
+            fx0 = coords[0] * T * scale / tiles->width;
+            fy0 = coords[1] * T * scale / tiles->height;
+            fx1 = MIN((coords[0] * T + size[0]) * scale / tiles->width, 1);
+            fy1 = MIN((coords[1] * T + size[1]) * scale / tiles->height, 1);
+            tiles->quad_pos[n][0] = p[0] + fx0 * (p[2] - p[0]);
+            tiles->quad_pos[n][1] = p[1] + fy0 * (p[3] - p[1]);
+            tiles->quad_pos[n][2] = p[0] + fx1 * (p[2] - p[0]);
+            tiles->quad_pos[n][3] = p[1] + fy1 * (p[3] - p[1]);
+
+            // Texture coordinates in the atlas, inset by half a texel to avoid sampling the
+            // neighboring slots.
+            u = (s % tiles->atlas_shape[0]) * T;
+            v = (s / tiles->atlas_shape[0]) * T;
+            tiles->quad_uv[n][0] = (u + .5f) / aw;
+            tiles->quad_uv[n][1] = (v + .5f) / ah;
+            tiles->quad_uv[n][2] = (u + size[0] - .5f) / aw;
+            tiles->quad_uv[n][3] = (v + size[1] - .5f) / ah;
+            n++;
+        }
+    }
+
+    // NOTE: the unused quads are degenerate.
+    dvz_image_position(tiles->visual, 0, tiles->slot_count, tiles->quad_pos, 0);
+    dvz_image_texcoords(tiles->visual, 0, tiles->slot_count, tiles->quad_uv, 0);
+    dvz_visual_update(tiles->visual);
+    tiles->quads_dirty = false;
+}
+
+
+
+static int
+_map_source(DvzTiles* tiles, const char* path, void* mapped, DvzSize size, DvzSize offset)
+{
+    ANN(tiles);
+    ANN(mapped);
+
+    DvzSize expected = (DvzSize)tiles->width * tiles->height * tiles->pixel_size;
+    if (offset + expected > size)
+    {
+        log_error(
+            "image file %s is too small (%s) for a %dx%d image", path, pretty_size(size),
+            tiles->width, tiles->height);
+        dvz_unmap_file(mapped, size);
+        return 1;
+    }
+
+    if (tiles->mapped != NULL)
+        dvz_unmap_file(tiles->mapped, tiles->mapped_size);
+    tiles->mapped = mapped;
+    tiles->mapped_size = size;
+    tiles->data = (uint8_t*)mapped + offset;
+    tiles->data_size = expected;
+    return 0;
+}
+
+
+
+// Parse the header of a .npy file, and return the offset of the array data (0 if invalid).
+static DvzSize _npy_header(DvzTiles* tiles, const char* path, const uint8_t* buf, DvzSize size)
+{
+    ANN(tiles);
+    ANN(buf);
+
+    if (size < 12 || memcmp(buf, "\x93NUMPY", 6) != 0)
+    {
+        log_error("%s is not a .npy file", path);
+        return 0;
+    }
+
+    // Version 1 has a 2-byte header length, versions 2 and 3 a 4-byte header length.
+    DvzSize start = buf[6] == 1 ? 10 : 12;
+    DvzSize len = buf[6] == 1 ? (DvzSize)(buf[8] | buf[9] << 8)
+                              : (DvzSize)buf[8] | (DvzSize)buf[9] << 8 |
+                                    (DvzSize)buf[10] << 16 | (DvzSize)buf[11] << 24;
+    if (start + len > size)
+    {
+        log_error("invalid .npy header in %s", path);
+        return 0;
+    }
+    char* header = (char*)calloc(len + 1, 1);
+    memcpy(header, &buf[start], len);
+
+    DvzSize offset = 0;
+    const char* descr = strstr(header, "'descr': '");
+    const char* shape = strstr(header, "'shape': (");
+    if (descr == NULL || shape == NULL)
+    {
+        log_error("invalid .npy header in %s", path);
+    }
+    else if (strstr(header, "'fortran_order': True") != NULL)
+    {
+        log_error("Fortran-ordered arrays are not supported (%s)", path);
+    }
+    else
+    {
+        // Item size, the descr being a string like '<f4' or '|u1'.
+        DvzSize item_size = (DvzSize)strtoul(descr + strlen("'descr': '") + 2, NULL, 10);
+
+        // Shape: (height, width) or (height, width, channels).
+        uint64_t dims[3] = {0, 0, 1};
+        uint32_t ndim = 0;
+        char* s = (char*)shape + strlen("'shape': (");
+        char* end = NULL;
+        while (ndim < 3)
+        {
+            dims[ndim] = strtoull(s, &end, 10);
+            if (end == s)
+                break;
+            ndim++;
+            s = end;
+            while (*s == ',' || *s == ' ')
+                s++;
+        }
+
+        if (ndim < 2 || dims[0] != tiles->height || dims[1] != tiles->width ||
+            dims[2] * item_size != tiles->pixel_size)
+        {
+            log_error(
+                "the array in %s does not match a %dx%d image with %d bytes per pixel", path,
+                tiles->width, tiles->height, (int)tiles->pixel_size);
+        }
+        else
+        {
+            offset = start + len;
+        }
+    }
+
+    FREE(header);
+    return offset;
+}
+
+
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+DvzTiles* dvz_tiles(
+    DvzBatch* batch, DvzFormat format, uint32_t width, uint32_t height, uvec2 atlas_shape,
+    uint32_t thread_count)
+{
+    ANN(batch);
+    ASSERT(width > 0);
+    ASSERT(height > 0);
+    ASSERT(atlas_shape[0] > 0 && atlas_shape[1] > 0);
+
+    DvzTiles* tiles = (DvzTiles*)calloc(1, sizeof(DvzTiles));
+    ANN(tiles);
+    tiles->batch = batch;
+    tiles->format = format;
+    tiles->pixel_size = _format_size(format);
+    ASSERT(tiles->pixel_size > 0);
+    tiles->width = width;
+    tiles->height = height;
+    tiles->atlas_shape[0] = atlas_shape[0];
+    tiles->atlas_shape[1] = atlas_shape[1];
+    memcpy(tiles->ul_lr, (vec4){-1, +1, +1, -1}, sizeof(vec4));
+
+    // Multi-resolution pyramid, until a single tile covers the whole level.
+    uint32_t offset = 0;
+    uint32_t level = 0;
+    for (level = 0; level < DVZ_TILES_MAX_LEVELS; level++)
+    {
+        tiles->grid[level][0] = (_ceil_shift(width, level) + DVZ_TILE_SIZE - 1) / DVZ_TILE_SIZE;
+        tiles->grid[level][1] = (_ceil_shift(height, level) + DVZ_TILE_SIZE - 1) / DVZ_TILE_SIZE;
+        tiles->level_offset[level] = offset;
+        offset += tiles->grid[level][0] * tiles->grid[level][1];
+        if (tiles->grid[level][0] == 1 && tiles->grid[level][1] == 1)
+        {
+            level++;
+            break;
+        }
+    }
+    tiles->level_count = level;
+    tiles->tile_count = offset;
+
+    // Tile cache.
+    tiles->slot_count = atlas_shape[0] * atlas_shape[1];
+    uint32_t top = level - 1;
+    uint32_t top_count = tiles->grid[top][0] * tiles->grid[top][1];
+    if (tiles->slot_count < top_count)
+    {
+        log_error(
+            "the tile atlas (%d slots) cannot hold the coarsest level (%d tiles)",
+            tiles->slot_count, top_count);
+    }
+    tiles->slot_tile = (int32_t*)malloc(tiles->slot_count * sizeof(int32_t));
+    tiles->slot_used = (uint64_t*)calloc(tiles->slot_count, sizeof(uint64_t));
+    tiles->tile_slot = (int32_t*)malloc(tiles->tile_count * sizeof(int32_t));
+    tiles->tile_pending = (bool*)calloc(tiles->tile_count, sizeof(bool));
+    tiles->requests = (uint32_t*)calloc(MAX(tiles->slot_count, top_count), sizeof(uint32_t));
+    for (uint32_t s = 0; s < tiles->slot_count; s++)
+        tiles->slot_tile[s] = -1;
+    for (uint32_t t = 0; t < tiles->tile_count; t++)
+        tiles->tile_slot[t] = -1;
+
+    // Loading jobs, with one tile buffer each.
+    DvzSize tile_size = DVZ_TILE_SIZE * DVZ_TILE_SIZE * tiles->pixel_size;
+    for (uint32_t i = 0; i < DVZ_TILES_MAX_PENDING; i++)
+    {
+        tiles->job_pool[i].tiles = tiles;
+        tiles->job_pool[i].data = (uint8_t*)malloc(tile_size);
+        tiles->job_free[i] = &tiles->job_pool[i];
+    }
+    tiles->job_free_count = DVZ_TILES_MAX_PENDING;
+    tiles->jobs = dvz_fifo(DVZ_TILES_MAX_PENDING + DVZ_TILES_MAX_THREADS + 1);
+    tiles->done = dvz_fifo(DVZ_TILES_MAX_PENDING + 1);
+
+    tiles->thread_count = MIN(thread_count, DVZ_TILES_MAX_THREADS);
+    for (uint32_t i = 0; i < tiles->thread_count; i++)
+        tiles->threads[i] = dvz_thread(_worker, tiles);
+
+    // Atlas texture.
+    uvec3 atlas_size = {atlas_shape[0] * DVZ_TILE_SIZE, atlas_shape[1] * DVZ_TILE_SIZE, 1};
+    tiles->atlas = dvz_create_tex(batch, DVZ_TEX_2D, format, atlas_size, 0).id;
+
+    // Image visual, with one quad per slot.
+    tiles->quad_pos = (vec4*)calloc(tiles->slot_count, sizeof(vec4));
+    tiles->quad_uv = (vec4*)calloc(tiles->slot_count, sizeof(vec4));
+    tiles->visual = dvz_image(batch, 0);
+    dvz_image_alloc(tiles->visual, tiles->slot_count);
+    dvz_image_texture(
+        tiles->visual, tiles->atlas, DVZ_FILTER_LINEAR, DVZ_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE);
+    tiles->quads_dirty = true;
+
+    log_debug(
+        "create tiled image %dx%d with %d levels, %d tiles, atlas with %d slots, %d threads",
+        width, height, tiles->level_count, tiles->tile_count, tiles->slot_count,
+        tiles->thread_count);
+    return tiles;
+}
+
+
+
+void dvz_tiles_data(DvzTiles* tiles, void* data)
+{
+    ANN(tiles);
+    ANN(data);
+    ASSERT(tiles->job_free_count == DVZ_TILES_MAX_PENDING);
+    tiles->data = (uint8_t*)data;
+    tiles->data_size = (DvzSize)tiles->width * tiles->height * tiles->pixel_size;
+}
+
+
+
+int dvz_tiles_file(DvzTiles* tiles, const char* path, DvzSize offset)
+{
+    ANN(tiles);
+    ANN(path);
+    ASSERT(tiles->job_free_count == DVZ_TILES_MAX_PENDING);
+
+    DvzSize size = 0;
+    void* mapped = dvz_map_file(path, &size);
+    if (mapped == NULL)
+        return 1;
+    return _map_source(tiles, path, mapped, size, offset);
+}
+
+
+
+int dvz_tiles_npy(DvzTiles* tiles, const char* path)
+{
+    ANN(tiles);
+    ANN(path);
+    ASSERT(tiles->job_free_count == DVZ_TILES_MAX_PENDING);
+
+    DvzSize size = 0;
+    void* mapped = dvz_map_file(path, &size);
+    if (mapped == NULL)
+        return 1;
+
+    DvzSize offset = _npy_header(tiles, path, (const uint8_t*)mapped, size);
+    if (offset == 0)
+    {
+        dvz_unmap_file(mapped, size);
+        return 1;
+    }
+    return _map_source(tiles, path, mapped, size, offset);
+}
+
+
+
+void dvz_tiles_position(DvzTiles* tiles, vec4 ul_lr)
+{
+    ANN(tiles);
+    memcpy(tiles->ul_lr, ul_lr, sizeof(vec4));
+    tiles->quads_dirty = true;
+}
+
+
+
+DvzVisual* dvz_tiles_visual(DvzTiles* tiles)
+{
+    ANN(tiles);
+    return tiles->visual;
+}
+
+
+
+uint32_t dvz_tiles_update(DvzTiles* tiles, DvzPanzoom* pz)
+{
+    ANN(tiles);
+    ANN(pz);
+
+    if (tiles->data == NULL)
+    {
+        log_error("the tiled image has no source data");
+        return 0;
+    }
+    tiles->update++;
+
+    uint32_t level = tiles->level;
+    uint32_t n = _select(tiles, pz);
+    if (tiles->level != level)
+        tiles->quads_dirty = true;
+
+    // Mark the resident tiles as used, so that they are not evicted by this update.
+    uint32_t tile = 0;
+    int32_t slot = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        slot = tiles->tile_slot[tiles->requests[i]];
+        if (slot >= 0)
+        {
+            tiles->slot_used[slot] = tiles->update;
+            tiles->stats.hits++;
+        }
+    }
+
+    // Start loading the missing tiles, the coarsest level first.
+    for (uint32_t i = 0; i < n && tiles->job_free_count > 0; i++)
+    {
+        tile = tiles->requests[i];
+        if (tiles->tile_slot[tile] < 0 && !tiles->tile_pending[tile])
+            _job_submit(tiles, tile);
+    }
+
+    // Upload the tiles that have been loaded since the last update.
+    uint32_t uploads = 0;
+    DvzTileJob* job = NULL;
+    while (uploads < DVZ_TILES_UPLOAD_LIMIT)
+    {
+        job = (DvzTileJob*)dvz_fifo_dequeue(tiles->done, false);
+        if (job == NULL)
+            break;
+        if (_job_upload(tiles, job))
+            uploads++;
+    }
+    if (uploads > 0)
+        tiles->quads_dirty = true;
+
+    tiles->stats.level = tiles->level;
+    tiles->stats.requested = n;
+    tiles->stats.missing = 0;
+    for (uint32_t i = 0; i < n; i++)
+        if (tiles->tile_slot[tiles->requests[i]] < 0)
+            tiles->stats.missing++;
+    tiles->stats.pending = DVZ_TILES_MAX_PENDING - tiles->job_free_count;
+
+    if (tiles->quads_dirty)
+        _quads_update(tiles);
+
+    if (uploads > 0)
+        log_trace("uploaded %d tiles, %d missing", uploads, tiles->stats.missing);
+    return uploads;
+}
+
+
+
+DvzTilesStats dvz_tiles_stats(DvzTiles* tiles)
+{
+    ANN(tiles);
+    return tiles->stats;
+}
+
+
+
+void dvz_tiles_destroy(DvzTiles* tiles)
+{
+    ANN(tiles);
+    log_debug(
+        "destroy tiled image: %" PRIu64 " loads, %" PRIu64 " evictions, %" PRIu64 " hits",
+        tiles->stats.loads, tiles->stats.evictions, tiles->stats.hits);
+
+    // Stop the workers.
+    for (uint32_t i = 0; i < tiles->thread_count; i++)
+        dvz_fifo_enqueue(tiles->jobs, NULL);
+    for (uint32_t i = 0; i < tiles->thread_count; i++)
+        dvz_thread_join(tiles->threads[i]);
+    dvz_fifo_destroy(tiles->jobs);
+    dvz_fifo_destroy(tiles->done);
+
+    for (uint32_t i = 0; i < DVZ_TILES_MAX_PENDING; i++)
+        FREE(tiles->job_pool[i].data);
+
+    if (tiles->mapped != NULL)
+        dvz_unmap_file(tiles->mapped, tiles->mapped_size);
+
+    dvz_visual_destroy(tiles->visual);
+
+    FREE(tiles->slot_tile);
+    FREE(tiles->slot_used);
+    FREE(tiles->tile_slot);
+    FREE(tiles->tile_pending);
+    FREE(tiles->requests);
+    FREE(tiles->quad_pos);
+    FREE(tiles->quad_uv);
+    FREE(tiles);
+}
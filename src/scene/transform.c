@@ -71,6 +71,27 @@ void dvz_transform_update(DvzTransform* tr)
 
 
 
+bool dvz_transform_dirty(DvzTransform* tr)
+{
+    ANN(tr);
+    bool pending = tr->dual.dirty_first != UINT32_MAX;
+    dvz_dual_dirty(&tr->dual, 0, 1);
+    return pending;
+}
+
+
+
+bool dvz_transform_flush(DvzTransform* tr)
+{
+    ANN(tr);
+    if (tr->dual.dirty_first == UINT32_MAX)
+        return false;
+    dvz_dual_update(&tr->dual);
+    return true;
+}
+
+
+
 void dvz_transform_next(DvzTransform* tr, DvzTransform* next)
 {
     ANN(tr);
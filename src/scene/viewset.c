@@ -262,12 +262,13 @@ void dvz_view_add(
     // ANN(transform);
     // TODO: use a #define macro instead of hard-coded value 0 here.
     // NOTE: bind the transform's dual to slot idx 0 (=MVP)
-    dvz_bind_dat(visual->batch, visual->graphics_id, 0, transform->dual.dat, 0);
+    dvz_bind_dat(
+        visual->batch, visual->graphics_id, 0, transform->dual.dat, transform->dual.offset);
 
     // // Viewport.
     // DvzViewport viewport = dvz_viewport_default(view->shape[0], view->shape[1]);
     // dvz_visual_viewport(visual, viewport);
-    dvz_bind_dat(visual->batch, visual->graphics_id, 1, view->dual.dat, 0);
+    dvz_bind_dat(visual->batch, visual->graphics_id, 1, view->dual.dat, view->dual.offset);
 }
 
 
@@ -346,5 +347,6 @@ void dvz_view_destroy(DvzView* view)
 
     dvz_list_destroy(view->visuals);
     dvz_list_remove_pointer(view->viewset->views, view);
+    dvz_dual_destroy(&view->dual);
     FREE(view);
 }
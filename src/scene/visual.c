@@ -16,6 +16,7 @@
 #include "scene/dual.h"
 #include "scene/graphics.h"
 #include "scene/params.h"
+#include "scene/viewset.h"
 
 
 
@@ -180,6 +181,47 @@ void dvz_visual_specialization(
 
 
 
+void dvz_visual_push(DvzVisual* visual, int shader_stages, DvzSize size)
+{
+    ANN(visual);
+    ASSERT(shader_stages != 0);
+    ASSERT(size > 0);
+
+    if (size > DVZ_RECORDER_PUSH_SIZE)
+    {
+        log_error(
+            "push constants too large (%s > %d bytes)", pretty_size(size), DVZ_RECORDER_PUSH_SIZE);
+        return;
+    }
+
+    visual->push_stages = shader_stages;
+    visual->push_size = size;
+    dvz_set_push(visual->batch, visual->graphics_id, shader_stages, 0, size);
+}
+
+
+
+void dvz_visual_push_data(DvzVisual* visual, DvzSize offset, DvzSize size, const void* data)
+{
+    ANN(visual);
+    ANN(data);
+
+    if (offset + size > visual->push_size)
+    {
+        log_error("push constant field outside of the declared push constants");
+        return;
+    }
+    if (memcmp(&visual->push_data[offset], data, size) == 0)
+        return;
+    memcpy(&visual->push_data[offset], data, size);
+
+    // The values are only applied when the command buffers are recorded again.
+    if (visual->view != NULL && visual->view->viewset != NULL)
+        dvz_atomic_set(visual->view->viewset->status, (int)DVZ_BUILD_DIRTY);
+}
+
+
+
 void dvz_visual_fixed(DvzVisual* visual, bool fixed_x, bool fixed_y, bool fixed_z)
 {
     ANN(visual);
@@ -389,6 +431,9 @@ void dvz_visual_tex(DvzVisual* visual, uint32_t slot_idx, DvzId tex, DvzId sampl
     ANN(visual);
     ANN(visual->baker);
 
+    ASSERT(slot_idx < DVZ_MAX_BINDINGS);
+    visual->texs[slot_idx] = tex;
+
     // Bind the texture to the graphics.
     dvz_bind_tex(visual->batch, visual->graphics_id, slot_idx, tex, sampler, offset);
 }
@@ -559,7 +604,7 @@ void dvz_visual_alloc(
     for (binding_idx = 0; binding_idx < binding_count; binding_idx++)
     {
         bv = &baker->vertex_bindings[binding_idx];
-        if (bv->shared)
+        if (bv->shared && bv->dual.dat == DVZ_ID_NONE)
         {
             log_trace(
                 "skip binding of shared vertex binding #%d, it will be handled externally",
@@ -598,6 +643,47 @@ void dvz_visual_alloc(
 
 
 
+void dvz_visual_share(DvzVisual* visual, DvzVisual* source)
+{
+    ANN(visual);
+    ANN(source);
+    ASSERT(visual != source);
+    ASSERT(dvz_obj_is_created(&source->obj));
+
+    DvzBaker* baker = visual->baker;
+    ANN(baker);
+
+    DvzBaker* src = source->baker;
+    ANN(src);
+
+    // NOTE: the duals are copied again at every call as the source may have resized them.
+    for (uint32_t binding_idx = 0; binding_idx < src->binding_count; binding_idx++)
+    {
+        dvz_baker_share_vertex(baker, binding_idx, &src->vertex_bindings[binding_idx].dual);
+    }
+    if (src->index.dat != DVZ_ID_NONE)
+    {
+        dvz_baker_share_index(baker, &src->index);
+    }
+
+    // The first time, declare the vertex bindings and bind the source dats.
+    if (!dvz_obj_is_created(&visual->obj))
+    {
+        dvz_visual_alloc(visual, source->item_count, source->vertex_count, source->index_count);
+        return;
+    }
+
+    // Afterwards, the dats are resized by the source, we just need to follow its counts.
+    visual->item_count = source->item_count;
+    visual->vertex_count = source->vertex_count;
+    visual->index_count = source->index_count;
+    dvz_visual_drawspec(
+        visual, source->draw_first, source->draw_count, //
+        source->first_instance, source->instance_count);
+}
+
+
+
 void dvz_visual_transform(DvzVisual* visual, DvzTransform* tr, uint32_t vertex_attr)
 {
     ANN(visual);
@@ -737,6 +823,41 @@ void dvz_visual_param(DvzVisual* visual, uint32_t slot_idx, uint32_t attr_idx, v
 
 
 
+void dvz_visual_updates(uint32_t count, DvzVisualUpdate* updates)
+{
+    ASSERT(count == 0 || updates != NULL);
+    log_trace("apply %d visual updates", count);
+
+    // NOTE: the updates of a given visual are usually contiguous, so that the visuals to update
+    // are collected in a small array of distinct pointers.
+    uint32_t visual_count = 0;
+    DvzVisual** visuals = (DvzVisual**)calloc(MAX(count, 1), sizeof(DvzVisual*));
+
+    DvzVisualUpdate* up = NULL;
+    bool found = false;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        up = &updates[i];
+        ANN(up->visual);
+        if (up->count == 0)
+            continue;
+        dvz_visual_data(up->visual, up->attr_idx, up->first, up->count, up->data);
+
+        found = visual_count > 0 && visuals[visual_count - 1] == up->visual;
+        for (uint32_t j = 0; j < visual_count && !found; j++)
+            found = visuals[j] == up->visual;
+        if (!found)
+            visuals[visual_count++] = up->visual;
+    }
+
+    for (uint32_t i = 0; i < visual_count; i++)
+        dvz_visual_update(visuals[i]);
+
+    FREE(visuals);
+}
+
+
+
 /*************************************************************************************************/
 /*  Visual drawing internal functions                                                            */
 /*************************************************************************************************/
@@ -811,6 +932,14 @@ void dvz_visual_record(DvzVisual* visual, DvzId canvas)
     ANN(visual);
     ASSERT(visual->draw_count > 0);
 
+    // Record the push constants before the draw commands.
+    if (visual->push_size > 0)
+    {
+        dvz_record_push(
+            visual->batch, canvas, visual->graphics_id, visual->push_stages, 0, visual->push_size,
+            visual->push_data);
+    }
+
     // Call the draw callback if there is one.
     if (visual->callback != NULL)
     {
@@ -279,7 +279,14 @@ void dvz_glyph_atlas(DvzVisual* visual, DvzAtlas* atlas)
 
 void dvz_glyph_unicode(DvzVisual* visual, uint32_t count, uint32_t* codepoints)
 {
+    dvz_glyph_codepoints(visual, 0, count, codepoints, 0);
+}
+
 
+
+void dvz_glyph_codepoints(
+    DvzVisual* visual, uint32_t first, uint32_t count, uint32_t* codepoints, int flags)
+{
     ANN(visual);
     ANN(codepoints);
     ASSERT(count > 0);
@@ -292,10 +299,9 @@ void dvz_glyph_unicode(DvzVisual* visual, uint32_t count, uint32_t* codepoints)
     }
     ANN(atlas);
 
-    uvec3 shape = {0};
-    dvz_atlas_shape(atlas, shape);
-    float w = shape[0];
-    float h = shape[1];
+    // Generate the glyphs missing from the atlas, and upload the modified region only.
+    if (dvz_atlas_insert(atlas, count, codepoints) > 0)
+        dvz_atlas_upload(atlas, visual->batch);
 
     vec4* texcoords = dvz_atlas_glyphs(atlas, count, codepoints); // to free
 
@@ -305,17 +311,17 @@ void dvz_glyph_unicode(DvzVisual* visual, uint32_t count, uint32_t* codepoints)
     float padw = 1.25;
     float padh = 1.5;
 
+    // NOTE: the texcoords are kept in pixels and normalized by the fragment shader, so that they
+    // remain valid when the atlas grows (the glyphs keep their position from the top).
     for (uint32_t i = 0; i < count; i++)
     {
-        // Now, we need to divide the texcoords (in pixels) by the atlas shape, to get uv
-        // normalized coordinates.
-        texcoords[i][0] = (texcoords[i][0] + padw) / w;
-        texcoords[i][1] = (texcoords[i][1] + padh) / h;
-        texcoords[i][2] = (texcoords[i][2] - 2 * padw) / w;
-        texcoords[i][3] = (texcoords[i][3] - 2 * padh) / h;
+        texcoords[i][0] += padw;
+        texcoords[i][1] += padh;
+        texcoords[i][2] -= 2 * padw;
+        texcoords[i][3] -= 2 * padh;
     }
 
-    dvz_glyph_texcoords(visual, 0, count, texcoords, 0);
+    dvz_glyph_texcoords(visual, first, count, texcoords, 0);
 
     FREE(texcoords);
 }
@@ -65,6 +65,10 @@ DvzVisual* dvz_marker(DvzBatch* batch, int flags)
     dvz_params_attr(params, 1, FIELD(DvzMarkerParams, edge_width));
     dvz_params_attr(params, 2, FIELD(DvzMarkerParams, tex_scale));
 
+    // Push constants: global size multiplier.
+    dvz_visual_push(visual, DVZ_SHADER_VERTEX, sizeof(float));
+    dvz_marker_scale(visual, 1.0);
+
     // Default texture to avoid Vulkan warning with unbound texture slot.
     dvz_visual_tex(
         visual, 3, DVZ_SCENE_DEFAULT_TEX_ID, DVZ_SCENE_DEFAULT_SAMPLER_ID, DVZ_ZERO_OFFSET);
@@ -175,6 +179,13 @@ void dvz_marker_edge_width(DvzVisual* visual, float value)
 
 
 
+void dvz_marker_scale(DvzVisual* visual, float value)
+{
+    dvz_visual_push_data(visual, 0, sizeof(float), &value);
+}
+
+
+
 void dvz_marker_tex(DvzVisual* visual, DvzId tex, DvzId sampler)
 {
     dvz_visual_tex(visual, 3, tex, sampler, DVZ_ZERO_OFFSET);
@@ -71,6 +71,9 @@ DvzVisual* dvz_path(DvzBatch* batch, int flags)
     dvz_visual_slot(visual, 1, DVZ_SLOT_DAT);
     dvz_visual_slot(visual, 2, DVZ_SLOT_DAT);
 
+    // Push constants.
+    dvz_visual_push(visual, DVZ_SHADER_VERTEX | DVZ_SHADER_FRAGMENT, sizeof(float));
+
     // Visual draw callback.
     dvz_visual_callback(visual, _visual_callback);
 
@@ -86,6 +89,7 @@ DvzVisual* dvz_path(DvzBatch* batch, int flags)
     dvz_visual_param(visual, 2, 1, (float[]){4.0});
     dvz_visual_param(visual, 2, 2, (int32_t[]){DVZ_CAP_ROUND});
     dvz_visual_param(visual, 2, 3, (int32_t[]){DVZ_JOIN_ROUND});
+    dvz_path_linewidth(visual, 10.0);
 
     return visual;
 }
@@ -188,6 +192,5 @@ void dvz_path_color(DvzVisual* visual, uint32_t first, uint32_t count, cvec4* va
 void dvz_path_linewidth(DvzVisual* visual, float value)
 {
     ANN(visual);
-    // NOTE: this is safe because a copy is made immediately.
-    dvz_visual_param(visual, 2, 0, &value);
+    dvz_visual_push_data(visual, 0, sizeof(float), &value);
 }
@@ -11,6 +11,7 @@
 #include "scene/visuals/volume.h"
 #include "fileio.h"
 #include "request.h"
+#include "scene/bricks.h"
 #include "scene/graphics.h"
 #include "scene/shape.h"
 #include "scene/viewset.h"
@@ -64,6 +65,7 @@ DvzVisual* dvz_volume(DvzBatch* batch, int flags)
     dvz_visual_slot(visual, 1, DVZ_SLOT_DAT);
     dvz_visual_slot(visual, 2, DVZ_SLOT_DAT);
     dvz_visual_slot(visual, 3, DVZ_SLOT_TEX);
+    dvz_visual_slot(visual, 4, DVZ_SLOT_TEX); // indirection table of bricked volumes
 
     // Params.
     DvzParams* params = dvz_visual_params(visual, 2, sizeof(DvzVolumeParams));
@@ -72,11 +74,15 @@ DvzVisual* dvz_volume(DvzBatch* batch, int flags)
     dvz_params_attr(params, 1, FIELD(DvzVolumeParams, uvw0));
     dvz_params_attr(params, 2, FIELD(DvzVolumeParams, uvw1));
     dvz_params_attr(params, 3, FIELD(DvzVolumeParams, transfer));
+    dvz_params_attr(params, 4, FIELD(DvzVolumeParams, shape));
+    dvz_params_attr(params, 5, FIELD(DvzVolumeParams, atlas));
 
     dvz_visual_param(visual, 2, 0, (vec4){1, 1, 1, 0}); // box_size
     dvz_visual_param(visual, 2, 1, (vec4){0, 0, 0, 0}); // uvw0
     dvz_visual_param(visual, 2, 2, (vec4){1, 1, 1, 0}); // uvw1
     dvz_visual_param(visual, 2, 3, (vec4){1, 0, 0, 0}); // transfer
+    dvz_visual_param(visual, 2, 4, (vec4){1, 1, 1, 0}); // shape
+    dvz_visual_param(visual, 2, 5, (vec4){1, 1, 1, 0}); // atlas
 
     // Visual draw callback.
     dvz_visual_callback(visual, _visual_callback);
@@ -172,6 +178,40 @@ void dvz_volume_texture(
 
     // Bind the texture to the visual.
     dvz_visual_tex(visual, 3, tex, sampler, DVZ_ZERO_OFFSET);
+
+    // NOTE: the indirection slot is unused by non-bricked volumes, but it must be bound.
+    if ((visual->flags & DVZ_VOLUME_FLAGS_BRICKED) == 0)
+        dvz_visual_tex(visual, 4, tex, sampler, DVZ_ZERO_OFFSET);
+}
+
+
+
+void dvz_volume_bricks(DvzVisual* visual, DvzBricks* bricks, DvzFilter filter)
+{
+    ANN(visual);
+    ANN(bricks);
+    if ((visual->flags & DVZ_VOLUME_FLAGS_BRICKED) == 0)
+    {
+        log_error("the volume visual must be created with DVZ_VOLUME_FLAGS_BRICKED");
+        return;
+    }
+
+    DvzBatch* batch = visual->batch;
+    ANN(batch);
+
+    // NOTE: the brick borders make linear filtering seamless between bricks, as long as the
+    // atlas sampler clamps to the edge.
+    DvzId sampler = dvz_create_sampler(batch, filter, DVZ_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE).id;
+    DvzId sampler_table =
+        dvz_create_sampler(batch, DVZ_FILTER_NEAREST, DVZ_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE).id;
+
+    dvz_visual_tex(visual, 3, bricks->atlas, sampler, DVZ_ZERO_OFFSET);
+    dvz_visual_tex(visual, 4, bricks->indirection, sampler_table, DVZ_ZERO_OFFSET);
+
+    uint32_t* s = bricks->shape;
+    uint32_t* a = bricks->atlas_shape;
+    dvz_visual_param(visual, 2, 4, (vec4){s[0], s[1], s[2], 0});
+    dvz_visual_param(visual, 2, 5, (vec4){a[0], a[1], a[2], 0});
 }
 
 
@@ -0,0 +1,450 @@
+/*************************************************************************************************/
+/*  Shm: named shared-memory arenas for upload payloads                                          */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "shm.h"
+#include "_map.h"
+#include "_mutex.h"
+#include "_prng.h"
+#include "alloc.h"
+
+#if !OS_WIN32
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+
+#if !OS_WIN32
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+// Beginning of the shared-memory segment, the blocks follow.
+struct DvzShmHeader
+{
+    uint32_t magic;
+    _Atomic uint32_t closed; // set when the owner destroys the arena
+    uint64_t capacity;       // size of the segment, header included
+    uint64_t end;            // end of the last block, only used by the owner
+    _Atomic uint64_t refs;   // sum of the reference counts of all blocks
+    uint8_t _padding[DVZ_SHM_ALIGNMENT - 4 * sizeof(uint64_t)];
+};
+
+
+
+// Header preceding each block.
+typedef struct
+{
+    _Atomic uint32_t refcount;
+    uint32_t _reserved;
+    uint64_t size; // size of the block, header excluded
+    uint8_t _padding[DVZ_SHM_ALIGNMENT - 2 * sizeof(uint64_t)];
+} DvzShmBlock;
+
+
+
+/*************************************************************************************************/
+/*  Registry                                                                                     */
+/*************************************************************************************************/
+
+// Arenas created or mapped by this process, by id.
+static DvzMap* REGISTRY;
+static DvzMutex REGISTRY_LOCK = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+static void _register(DvzShm* shm)
+{
+    ANN(shm);
+    dvz_mutex_lock(&REGISTRY_LOCK);
+    if (REGISTRY == NULL)
+        REGISTRY = dvz_map();
+    dvz_map_add(REGISTRY, shm->id, 0, shm);
+    dvz_mutex_unlock(&REGISTRY_LOCK);
+}
+
+
+
+// NOTE: the registry lock must be held.
+static void _unregister(DvzShm* shm)
+{
+    ANN(shm);
+    if (REGISTRY != NULL && dvz_map_exists(REGISTRY, shm->id))
+        dvz_map_remove(REGISTRY, shm->id);
+}
+
+
+
+/*************************************************************************************************/
+/*  Utils                                                                                        */
+/*************************************************************************************************/
+
+static void _name(char* name, DvzId id)
+{
+    ANN(name);
+    snprintf(name, 32, "/dvz-%016" PRIx64, id);
+}
+
+
+
+// Return the header of a live block, or NULL if the offset does not point to one.
+// NOTE: the offsets come from other processes, they are checked against the mapping and the
+// block header instead of being trusted.
+static DvzShmBlock* _block(DvzShm* shm, DvzSize offset)
+{
+    ANN(shm);
+    if (offset % DVZ_SHM_ALIGNMENT != 0 ||
+        offset < sizeof(DvzShmHeader) + sizeof(DvzShmBlock) || offset >= shm->size)
+        return NULL;
+    DvzShmBlock* block = (DvzShmBlock*)(shm->map + offset - sizeof(DvzShmBlock));
+    if (atomic_load(&block->refcount) == 0 || block->size > shm->size - offset)
+        return NULL;
+    return block;
+}
+
+
+
+// Map an existing segment.
+static DvzShm* _open(DvzId id)
+{
+    DvzShm* shm = (DvzShm*)calloc(1, sizeof(DvzShm));
+    ANN(shm);
+    shm->id = id;
+    _name(shm->name, id);
+
+    int fd = shm_open(shm->name, O_RDWR, 0);
+    struct stat st = {0};
+    if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(DvzShmHeader))
+    {
+        log_error("unable to open the shared-memory arena `%s`", shm->name);
+        if (fd >= 0)
+            close(fd);
+        FREE(shm);
+        return NULL;
+    }
+    shm->size = (DvzSize)st.st_size;
+    shm->map = (uint8_t*)mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm->map == MAP_FAILED)
+    {
+        log_error("unable to map the shared-memory arena `%s`", shm->name);
+        FREE(shm);
+        return NULL;
+    }
+
+    shm->header = (DvzShmHeader*)shm->map;
+    if (shm->header->magic != DVZ_SHM_MAGIC)
+    {
+        log_error("invalid shared-memory arena `%s`", shm->name);
+        munmap(shm->map, shm->size);
+        FREE(shm);
+        return NULL;
+    }
+    return shm;
+}
+
+
+
+static void _close(DvzShm* shm)
+{
+    ANN(shm);
+    if (shm->is_owner)
+    {
+        atomic_store(&shm->header->closed, 1);
+        shm_unlink(shm->name);
+    }
+    munmap(shm->map, shm->size);
+    FREE(shm);
+}
+
+
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+DvzShm* dvz_shm(DvzSize size)
+{
+    ASSERT(size > 0);
+
+    DvzShm* shm = (DvzShm*)calloc(1, sizeof(DvzShm));
+    ANN(shm);
+    shm->is_owner = true;
+    shm->size = sizeof(DvzShmHeader) + _align(size, DVZ_SHM_ALIGNMENT) + sizeof(DvzShmBlock);
+
+    // NOTE: the id is random so that arenas of concurrent processes do not collide.
+    DvzPrng* prng = dvz_prng();
+    shm->id = dvz_prng_uuid(prng);
+    dvz_prng_destroy(prng);
+    _name(shm->name, shm->id);
+
+    int fd = shm_open(shm->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+    {
+        log_error("unable to create the shared-memory arena `%s`", shm->name);
+        FREE(shm);
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)shm->size) != 0)
+    {
+        log_error("unable to allocate %s of shared memory", pretty_size(shm->size));
+        close(fd);
+        shm_unlink(shm->name);
+        FREE(shm);
+        return NULL;
+    }
+    shm->map = (uint8_t*)mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm->map == MAP_FAILED)
+    {
+        log_error("unable to map the shared-memory arena `%s`", shm->name);
+        shm_unlink(shm->name);
+        FREE(shm);
+        return NULL;
+    }
+
+    shm->header = (DvzShmHeader*)shm->map;
+    shm->header->capacity = shm->size;
+    shm->header->end = sizeof(DvzShmHeader);
+    atomic_init(&shm->header->closed, 0);
+    atomic_init(&shm->header->refs, 0);
+    shm->header->magic = DVZ_SHM_MAGIC;
+
+    log_trace("created shared-memory arena `%s` (%s)", shm->name, pretty_size(size));
+    _register(shm);
+    return shm;
+}
+
+
+
+DvzShm* dvz_shm_get(DvzId id)
+{
+    ASSERT(id != 0);
+
+    dvz_mutex_lock(&REGISTRY_LOCK);
+    if (REGISTRY == NULL)
+        REGISTRY = dvz_map();
+    DvzShm* shm = NULL;
+    if (dvz_map_exists(REGISTRY, id))
+    {
+        shm = (DvzShm*)dvz_map_get(REGISTRY, id);
+    }
+    else if ((shm = _open(id)) != NULL)
+    {
+        log_trace("mapped shared-memory arena `%s`", shm->name);
+        dvz_map_add(REGISTRY, id, 0, shm);
+    }
+    dvz_mutex_unlock(&REGISTRY_LOCK);
+    return shm;
+}
+
+
+
+void* dvz_shm_alloc(DvzShm* shm, DvzSize size, DvzSize* offset)
+{
+    ANN(shm);
+    ANN(offset);
+    ASSERT(size > 0);
+    if (!shm->is_owner)
+    {
+        log_error("only the process that created a shared-memory arena can allocate blocks");
+        return NULL;
+    }
+
+    DvzShmHeader* header = shm->header;
+    size = _align(size, DVZ_SHM_ALIGNMENT);
+    const DvzSize hs = sizeof(DvzShmBlock);
+
+    // First fit among the released blocks, merged with the released blocks that follow them.
+    DvzShmBlock* block = NULL;
+    DvzShmBlock* next = NULL;
+    DvzSize pos = sizeof(DvzShmHeader);
+    while (pos < header->end)
+    {
+        block = (DvzShmBlock*)(shm->map + pos);
+        if (atomic_load(&block->refcount) == 0)
+        {
+            while (pos + hs + block->size < header->end)
+            {
+                next = (DvzShmBlock*)(shm->map + pos + hs + block->size);
+                if (atomic_load(&next->refcount) != 0)
+                    break;
+                block->size += hs + next->size;
+            }
+
+            // The free blocks extend to the end: allocate from there.
+            if (pos + hs + block->size >= header->end)
+            {
+                header->end = pos;
+                break;
+            }
+
+            if (block->size >= size)
+            {
+                // Split the block if the remainder can hold another one.
+                if (block->size >= size + hs + DVZ_SHM_ALIGNMENT)
+                {
+                    next = (DvzShmBlock*)(shm->map + pos + hs + size);
+                    atomic_init(&next->refcount, 0);
+                    next->size = block->size - size - hs;
+                    block->size = size;
+                }
+                atomic_store(&block->refcount, 1);
+                atomic_fetch_add(&header->refs, 1);
+                *offset = pos + hs;
+                return shm->map + *offset;
+            }
+        }
+        pos += hs + block->size;
+    }
+
+    // Append a new block.
+    pos = header->end;
+    if (pos + hs + size > shm->size)
+    {
+        log_error(
+            "shared-memory arena `%s` is full, unable to allocate %s", shm->name,
+            pretty_size(size));
+        return NULL;
+    }
+    block = (DvzShmBlock*)(shm->map + pos);
+    block->size = size;
+    atomic_store(&block->refcount, 1);
+    atomic_fetch_add(&header->refs, 1);
+    header->end = pos + hs + size;
+    *offset = pos + hs;
+    return shm->map + *offset;
+}
+
+
+
+void* dvz_shm_pointer(DvzShm* shm, DvzSize offset, DvzSize size)
+{
+    ANN(shm);
+    DvzShmBlock* block = _block(shm, offset);
+    if (block == NULL || size > block->size)
+    {
+        log_error(
+            "invalid block of %s at offset %" PRIu64 " in the shared-memory arena `%s`",
+            pretty_size(size), offset, shm->name);
+        return NULL;
+    }
+    return shm->map + offset;
+}
+
+
+
+void dvz_shm_ref(DvzShm* shm, DvzSize offset)
+{
+    ANN(shm);
+    DvzShmBlock* block = _block(shm, offset);
+    if (block == NULL)
+    {
+        log_error(
+            "invalid block at offset %" PRIu64 " in the shared-memory arena `%s`", offset,
+            shm->name);
+        return;
+    }
+    atomic_fetch_add(&block->refcount, 1);
+    atomic_fetch_add(&shm->header->refs, 1);
+}
+
+
+
+void dvz_shm_unref(DvzShm* shm, DvzSize offset)
+{
+    ANN(shm);
+    DvzShmBlock* block = _block(shm, offset);
+    if (block == NULL)
+    {
+        log_error(
+            "invalid block at offset %" PRIu64 " in the shared-memory arena `%s`", offset,
+            shm->name);
+        return;
+    }
+    atomic_fetch_sub(&block->refcount, 1);
+    if (shm->is_owner)
+    {
+        atomic_fetch_sub(&shm->header->refs, 1);
+        return;
+    }
+
+    // Unmap the arenas of other processes once they are destroyed and no longer used.
+    // NOTE: the last release holds the registry lock so that dvz_shm_get() cannot return the
+    // arena while it is being unmapped.
+    dvz_mutex_lock(&REGISTRY_LOCK);
+    uint64_t refs = atomic_fetch_sub(&shm->header->refs, 1) - 1;
+    if (refs == 0 && atomic_load(&shm->header->closed) != 0)
+    {
+        log_trace("unmapping closed shared-memory arena `%s`", shm->name);
+        _unregister(shm);
+        _close(shm);
+    }
+    dvz_mutex_unlock(&REGISTRY_LOCK);
+}
+
+
+
+uint64_t dvz_shm_refs(DvzShm* shm)
+{
+    ANN(shm);
+    return atomic_load(&shm->header->refs);
+}
+
+
+
+void dvz_shm_destroy(DvzShm* shm)
+{
+    ANN(shm);
+    if (shm->is_owner && dvz_shm_refs(shm) > 0)
+        log_debug(
+            "destroying shared-memory arena `%s` with %" PRIu64 " blocks still referenced",
+            shm->name, dvz_shm_refs(shm));
+    dvz_mutex_lock(&REGISTRY_LOCK);
+    _unregister(shm);
+    dvz_mutex_unlock(&REGISTRY_LOCK);
+    _close(shm);
+}
+
+
+
+#else
+
+/*************************************************************************************************/
+/*  Windows                                                                                      */
+/*************************************************************************************************/
+
+// NOTE: the arenas rely on POSIX shared memory.
+
+DvzShm* dvz_shm(DvzSize size)
+{
+    log_error("shared-memory arenas are not supported on Windows");
+    return NULL;
+}
+
+DvzShm* dvz_shm_get(DvzId id) { return NULL; }
+
+void* dvz_shm_alloc(DvzShm* shm, DvzSize size, DvzSize* offset) { return NULL; }
+
+void* dvz_shm_pointer(DvzShm* shm, DvzSize offset, DvzSize size) { return NULL; }
+
+void dvz_shm_ref(DvzShm* shm, DvzSize offset) {}
+
+void dvz_shm_unref(DvzShm* shm, DvzSize offset) {}
+
+uint64_t dvz_shm_refs(DvzShm* shm) { return 0; }
+
+void dvz_shm_destroy(DvzShm* shm) {}
+
+#endif
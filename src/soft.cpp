@@ -0,0 +1,1646 @@
+/*************************************************************************************************/
+/*  Soft: CPU-only software renderer                                                             */
+/*************************************************************************************************/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "soft.h"
+#include "_map.h"
+#include "recorder.h"
+#include "scene/graphics.h"
+#include "scene/mvp.h"
+#include "scene/viewport.h"
+
+
+
+/*************************************************************************************************/
+/*  Macros                                                                                       */
+/*************************************************************************************************/
+
+#define GET_ID(t, n, i)                                                                           \
+    t* n = (t*)dvz_map_get(soft->map, i);                                                         \
+    if (n == NULL)                                                                                \
+    {                                                                                             \
+        log_error("%s Ox%" PRIx64 " doesn't exist", #n, i);                                       \
+        return;                                                                                   \
+    }                                                                                             \
+    ANN(n);
+
+
+
+/*************************************************************************************************/
+/*  Typedefs                                                                                     */
+/*************************************************************************************************/
+
+typedef struct DvzSoftPrim DvzSoftPrim;
+
+
+
+/*************************************************************************************************/
+/*  Enums                                                                                        */
+/*************************************************************************************************/
+
+typedef enum
+{
+    DVZ_SOFT_PRIM_POINT,
+    DVZ_SOFT_PRIM_LINE,
+    DVZ_SOFT_PRIM_TRIANGLE,
+} DvzSoftPrimType;
+
+
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+// Primitive in window coordinates (x, y in pixels, z depth in [0, 1]), ready to be rasterized.
+struct DvzSoftPrim
+{
+    DvzSoftPrimType type;
+    vec3 pos[3];
+    vec4 color[3];
+    vec2 uv[3];
+    float size; // point diameter or line width, in pixels
+    DvzSoftTex* tex;
+    bool depth_test;
+    bool blend;
+    int32_t scissor[4]; // x0, y0, x1, y1 (exclusive) of the current viewport
+};
+
+
+
+extern "C" struct DvzSoftFrame
+{
+    std::vector<DvzSoftPrim> prims;
+    std::vector<std::vector<uint32_t>> bins; // indices of the primitives overlapping each tile
+};
+
+
+
+// State of a draw command, used when assembling the primitives.
+typedef struct
+{
+    DvzSoft* soft;
+    DvzSoftBoard* board;
+    DvzSoftGraphics* graphics;
+    DvzSoftKind kind;
+    mat4 mvp;
+    bool has_margins;
+    vec4 margins;
+    vec2 fb_size;
+    vec4 viewport; // x, y, w, h of the current viewport, in pixels
+    uint32_t instance;
+} DvzSoftDraw;
+
+
+
+/*************************************************************************************************/
+/*  Utils                                                                                        */
+/*************************************************************************************************/
+
+static DvzSize _texel_size(DvzFormat format)
+{
+    // NOTE: R32G32_SFLOAT is used by some visuals but is not handled by _format_size().
+    if (format == DVZ_FORMAT_R32G32_SFLOAT)
+        return 2 * sizeof(float);
+    return _format_size(format);
+}
+
+
+
+// Read the components of an item with a given format, as floats (missing components are 0 except
+// alpha which is 1).
+static void _read_format(DvzFormat format, const uint8_t* src, vec4 out)
+{
+    ANN(src);
+    out[0] = out[1] = out[2] = 0;
+    out[3] = 1;
+    const float* f = (const float*)src;
+    switch (format)
+    {
+    case DVZ_FORMAT_R32_SFLOAT:
+        out[0] = f[0];
+        break;
+    case DVZ_FORMAT_R32G32_SFLOAT:
+        out[0] = f[0];
+        out[1] = f[1];
+        break;
+    case DVZ_FORMAT_R32G32B32_SFLOAT:
+        out[0] = f[0];
+        out[1] = f[1];
+        out[2] = f[2];
+        break;
+    case DVZ_FORMAT_R32G32B32A32_SFLOAT:
+        glm_vec4_copy((float*)f, out);
+        break;
+    case DVZ_FORMAT_R32_SINT:
+        out[0] = (float)(*(const int32_t*)src);
+        break;
+    case DVZ_FORMAT_R32_UINT:
+        out[0] = (float)(*(const uint32_t*)src);
+        break;
+    case DVZ_FORMAT_R8_UNORM:
+        out[0] = out[1] = out[2] = src[0] / 255.0f;
+        break;
+    case DVZ_FORMAT_R8G8B8_UNORM:
+        for (uint32_t i = 0; i < 3; i++)
+            out[i] = src[i] / 255.0f;
+        break;
+    case DVZ_FORMAT_R8G8B8A8_UNORM:
+    case DVZ_FORMAT_R8G8B8A8_UINT:
+        for (uint32_t i = 0; i < 4; i++)
+            out[i] = src[i] / 255.0f;
+        break;
+    case DVZ_FORMAT_B8G8R8A8_UNORM:
+        out[0] = src[2] / 255.0f;
+        out[1] = src[1] / 255.0f;
+        out[2] = src[0] / 255.0f;
+        out[3] = src[3] / 255.0f;
+        break;
+    default:
+        break;
+    }
+}
+
+
+
+static inline DvzFormat _attr_format(DvzSoftGraphics* graphics, uint32_t location)
+{
+    ANN(graphics);
+    return location < graphics->attr_count ? graphics->attrs[location].format : DVZ_FORMAT_NONE;
+}
+
+
+
+// Recognize the builtin visuals from the formats of their vertex attributes.
+static DvzSoftKind _classify(DvzSoftGraphics* graphics)
+{
+    ANN(graphics);
+
+    const DvzFormat F = DVZ_FORMAT_R32_SFLOAT;
+    const DvzFormat F2 = DVZ_FORMAT_R32G32_SFLOAT;
+    const DvzFormat F3 = DVZ_FORMAT_R32G32B32_SFLOAT;
+    const DvzFormat F4 = DVZ_FORMAT_R32G32B32A32_SFLOAT;
+    const DvzFormat C = DVZ_FORMAT_R8G8B8A8_UNORM;
+
+    DvzFormat f[8] = {DVZ_FORMAT_NONE};
+    for (uint32_t i = 0; i < 8; i++)
+        f[i] = _attr_format(graphics, i);
+    uint32_t n = graphics->attr_count;
+
+    if (n == 3 && f[0] == F3 && f[1] == C && f[2] == F)
+        return DVZ_SOFT_KIND_POINT;
+    if (n == 4 && f[0] == F3 && f[1] == F && f[2] == F && f[3] == C)
+        return DVZ_SOFT_KIND_MARKER;
+    if (n == 7 && f[0] == F3 && f[1] == F3 && f[2] == F4 && f[3] == C && f[4] == F)
+        return DVZ_SOFT_KIND_SEGMENT;
+    if (n == 5 && f[0] == F3 && f[1] == F3 && f[2] == F3 && f[3] == F3 && f[4] == C)
+        return DVZ_SOFT_KIND_PATH;
+    if (n == 2 && f[0] == F2 && f[1] == F2)
+        return DVZ_SOFT_KIND_IMAGE;
+    if (n == 3 && f[0] == F3 && f[1] == F3 && (f[2] == C || f[2] == F4))
+        return DVZ_SOFT_KIND_MESH;
+    return DVZ_SOFT_KIND_GENERIC;
+}
+
+
+
+static void _board_alloc(DvzSoftBoard* board, uint32_t width, uint32_t height)
+{
+    ANN(board);
+    ASSERT(width > 0);
+    ASSERT(height > 0);
+
+    board->width = width;
+    board->height = height;
+    board->size = width * height * 3;
+
+    FREE(board->rgb);
+    FREE(board->rgba);
+    FREE(board->depth);
+    board->rgb = (uint8_t*)calloc(board->size, 1);
+    board->rgba = (uint8_t*)calloc(width * height, 4);
+    board->depth = (float*)calloc(width * height, sizeof(float));
+}
+
+
+
+// Return the object with a given id, or NULL if the id is unset or unknown.
+static inline void* _get(DvzSoft* soft, DvzId id)
+{
+    ANN(soft);
+    return id != DVZ_ID_NONE ? dvz_map_get(soft->map, id) : NULL;
+}
+
+
+
+static void _register(DvzSoft* soft, DvzRequest req, void* obj)
+{
+    ANN(soft);
+    ANN(obj);
+    ASSERT(req.id != DVZ_ID_NONE);
+
+    if (dvz_map_exists(soft->map, req.id))
+    {
+        log_error("error while creating the object, id Ox%" PRIx64 " already exists", req.id);
+        return;
+    }
+    dvz_map_add(soft->map, req.id, req.type, obj);
+}
+
+
+
+/*************************************************************************************************/
+/*  Object requests                                                                              */
+/*************************************************************************************************/
+
+static void _board_create(DvzSoft* soft, DvzRequest req)
+{
+    ANN(soft);
+
+    DvzSoftBoard* board = (DvzSoftBoard*)calloc(1, sizeof(DvzSoftBoard));
+    board->obj.id = req.id;
+
+    // NOTE: canvases are rendered offscreen like boards.
+    if (req.type == DVZ_REQUEST_OBJECT_CANVAS)
+    {
+        _board_alloc(
+            board, req.content.canvas.framebuffer_width, req.content.canvas.framebuffer_height);
+        memcpy(board->background, req.content.canvas.background, sizeof(cvec4));
+    }
+    else
+    {
+        _board_alloc(board, req.content.board.width, req.content.board.height);
+        memcpy(board->background, req.content.board.background, sizeof(cvec4));
+    }
+    board->recorder = dvz_recorder(0);
+    dvz_obj_created(&board->obj);
+    _register(soft, req, board);
+}
+
+
+
+static void _board_destroy(DvzSoftBoard* board)
+{
+    ANN(board);
+    dvz_recorder_destroy(board->recorder);
+    FREE(board->rgb);
+    FREE(board->rgba);
+    FREE(board->depth);
+    FREE(board);
+}
+
+
+
+// Shaders and samplers are not used, but their ids are registered.
+static void _object_create(DvzSoft* soft, DvzRequest req)
+{
+    ANN(soft);
+
+    // NOTE: the shader code copied by the requester is owned by the renderer.
+    if (req.type == DVZ_REQUEST_OBJECT_SHADER)
+    {
+        FREE(req.content.shader.code);
+        FREE(req.content.shader.buffer);
+    }
+
+    DvzObject* obj = (DvzObject*)calloc(1, sizeof(DvzObject));
+    obj->id = req.id;
+    dvz_obj_created(obj);
+    _register(soft, req, obj);
+}
+
+
+
+static void _dat_create(DvzSoft* soft, DvzRequest req)
+{
+    ANN(soft);
+
+    DvzSoftDat* dat = (DvzSoftDat*)calloc(1, sizeof(DvzSoftDat));
+    dat->obj.id = req.id;
+    dat->type = req.content.dat.type;
+    dat->size = req.content.dat.size;
+    dat->data = (uint8_t*)calloc(MAX(dat->size, 1), 1);
+    dvz_obj_created(&dat->obj);
+    _register(soft, req, dat);
+}
+
+
+
+static void _dat_resize(DvzSoftDat* dat, DvzSize size)
+{
+    ANN(dat);
+    if (size <= dat->size)
+        return;
+    uint8_t* data = (uint8_t*)realloc(dat->data, size);
+    ANN(data);
+    dat->data = data;
+    memset(&dat->data[dat->size], 0, size - dat->size);
+    dat->size = size;
+}
+
+
+
+static void _dat_upload(DvzSoft* soft, DvzRequest req)
+{
+    ANN(soft);
+
+    GET_ID(DvzSoftDat, dat, req.id)
+    const void* data = dvz_upload_source(&req);
+    if (data == NULL)
+    {
+        log_error("unable to access the data to upload to dat 0x%" PRIx64, req.id);
+        dvz_upload_consume(&req);
+        return;
+    }
+
+    DvzSize offset = req.content.dat_upload.offset;
+    DvzSize size = req.content.dat_upload.size;
+    _dat_resize(dat, offset + size);
+
+    uint32_t item_size = req.content.dat_upload.item_size;
+    uint32_t stride = req.content.dat_upload.stride;
+    if (item_size > 0 && stride != item_size)
+        dvz_gather(&dat->data[offset], data, (uint32_t)(size / item_size), item_size, stride);
+    else
+        memcpy(&dat->data[offset], data, size);
+
+    // Same ownership rules as the Vulkan renderer.
+    dvz_upload_consume(&req);
+}
+
+
+
+static void _tex_create(DvzSoft* soft, DvzRequest req)
+{
+    ANN(soft);
+
+    DvzSoftTex* tex = (DvzSoftTex*)calloc(1, sizeof(DvzSoftTex));
+    tex->obj.id = req.id;
+    tex->dims = req.content.tex.dims;
+    tex->format = req.content.tex.format;
+    tex->item_size = _texel_size(tex->format);
+    memcpy(tex->shape, req.content.tex.shape, sizeof(uvec3));
+    for (uint32_t i = 0; i < 3; i++)
+        tex->shape[i] = MAX(tex->shape[i], 1);
+    tex->data = (uint8_t*)calloc(tex->shape[0] * tex->shape[1] * tex->shape[2], tex->item_size);
+    dvz_obj_created(&tex->obj);
+    _register(soft, req, tex);
+}
+
+
+
+static void _tex_upload(DvzSoft* soft, DvzRequest req)
+{
+    ANN(soft);
+
+    GET_ID(DvzSoftTex, tex, req.id)
+    const uint8_t* src = (const uint8_t*)dvz_upload_source(&req);
+    if (src == NULL)
+    {
+        log_error("unable to access the data to upload to tex 0x%" PRIx64, req.id);
+        dvz_upload_consume(&req);
+        return;
+    }
+
+    // May use shape[i] = 0 to indicate the full shape along that axis, like the Vulkan renderer.
+    uint32_t* offset = req.content.tex_upload.offset;
+    uvec3 shape = {0};
+    for (uint32_t i = 0; i < 3; i++)
+        shape[i] = req.content.tex_upload.shape[i] > 0 ? req.content.tex_upload.shape[i]
+                                                        : tex->shape[i];
+    if ((offset[0] + shape[0] > tex->shape[0]) || (offset[1] + shape[1] > tex->shape[1]) ||
+        (offset[2] + shape[2] > tex->shape[2]))
+    {
+        log_error("tex to upload is larger than the tex shape");
+        dvz_upload_consume(&req);
+        return;
+    }
+    DvzSize row = shape[0] * tex->item_size;
+    if (row * shape[1] * shape[2] > req.content.tex_upload.size)
+    {
+        log_error("the tex upload is smaller than the uploaded shape");
+        dvz_upload_consume(&req);
+        return;
+    }
+
+    // Copy the uploaded box row by row.
+    for (uint32_t z = 0; z < shape[2]; z++)
+    {
+        for (uint32_t y = 0; y < shape[1]; y++)
+        {
+            DvzSize dst = ((offset[2] + z) * tex->shape[1] + offset[1] + y) * tex->shape[0] +
+                          offset[0];
+            memcpy(&tex->data[dst * tex->item_size], src, row);
+            src += row;
+        }
+    }
+
+    dvz_upload_consume(&req);
+}
+
+
+
+static void _tex_resize(DvzSoftTex* tex, uvec3 shape)
+{
+    ANN(tex);
+    for (uint32_t i = 0; i < 3; i++)
+        tex->shape[i] = MAX(shape[i], 1);
+    FREE(tex->data);
+    tex->data = (uint8_t*)calloc(tex->shape[0] * tex->shape[1] * tex->shape[2], tex->item_size);
+}
+
+
+
+static void _graphics_create(DvzSoft* soft, DvzRequest req)
+{
+    ANN(soft);
+
+    DvzSoftGraphics* graphics = (DvzSoftGraphics*)calloc(1, sizeof(DvzSoftGraphics));
+    graphics->obj.id = req.id;
+    graphics->type = req.content.graphics.type;
+    graphics->primitive = DVZ_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    graphics->blend = DVZ_BLEND_ENABLE;
+    if ((req.flags & DVZ_GRAPHICS_FLAGS_DEPTH_TEST) != 0)
+        graphics->depth_test = DVZ_DEPTH_TEST_ENABLE;
+
+    // NOTE: the builtin graphics declare their vertex layout themselves (see graphics.c).
+    if (graphics->type == DVZ_GRAPHICS_POINT)
+    {
+        typedef DvzGraphicsPointVertex V;
+        graphics->primitive = DVZ_PRIMITIVE_TOPOLOGY_POINT_LIST;
+        graphics->strides[0] = sizeof(V);
+        graphics->attr_count = 3;
+        graphics->attrs[0] = {0, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(V, pos)};
+        graphics->attrs[1] = {0, DVZ_FORMAT_R8G8B8A8_UNORM, offsetof(V, color)};
+        graphics->attrs[2] = {0, DVZ_FORMAT_R32_SFLOAT, offsetof(V, size)};
+    }
+    else if (graphics->type == DVZ_GRAPHICS_TRIANGLE)
+    {
+        graphics->primitive = DVZ_PRIMITIVE_TOPOLOGY_POINT_LIST;
+        graphics->strides[0] = sizeof(DvzVertex);
+        graphics->attr_count = 2;
+        graphics->attrs[0] = {0, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(DvzVertex, pos)};
+        graphics->attrs[1] = {0, DVZ_FORMAT_R8G8B8A8_UNORM, offsetof(DvzVertex, color)};
+    }
+
+    dvz_obj_created(&graphics->obj);
+    _register(soft, req, graphics);
+}
+
+
+
+static void _graphics_set(DvzSoft* soft, DvzRequest req)
+{
+    ANN(soft);
+
+    GET_ID(DvzSoftGraphics, graphics, req.id)
+
+    uint32_t idx = 0;
+    switch (req.type)
+    {
+    case DVZ_REQUEST_OBJECT_PRIMITIVE:
+        graphics->primitive = req.content.set_primitive.primitive;
+        break;
+
+    case DVZ_REQUEST_OBJECT_DEPTH:
+        graphics->depth_test = req.content.set_depth.depth;
+        break;
+
+    case DVZ_REQUEST_OBJECT_BLEND:
+        graphics->blend = req.content.set_blend.blend;
+        break;
+
+    case DVZ_REQUEST_OBJECT_VERTEX:
+        idx = req.content.set_vertex.binding_idx;
+        ASSERT(idx < DVZ_MAX_VERTEX_BINDINGS);
+        graphics->strides[idx] = req.content.set_vertex.stride;
+        graphics->rates[idx] = req.content.set_vertex.input_rate;
+        break;
+
+    case DVZ_REQUEST_OBJECT_VERTEX_ATTR:
+        idx = req.content.set_attr.location;
+        ASSERT(idx < DVZ_MAX_VERTEX_ATTRS);
+        graphics->attrs[idx].binding_idx = req.content.set_attr.binding_idx;
+        graphics->attrs[idx].format = req.content.set_attr.format;
+        graphics->attrs[idx].offset = req.content.set_attr.offset;
+        graphics->attr_count = MAX(graphics->attr_count, idx + 1);
+        break;
+
+    case DVZ_REQUEST_OBJECT_SPECIALIZATION:
+        // NOTE: the value copied by the requester is owned by the renderer.
+        FREE(req.content.set_specialization.value);
+        break;
+
+    // NOTE: the shaders, descriptor slots, push constant ranges, polygon, cull and front face
+    // modes are not used by the software renderer.
+    default:
+        break;
+    }
+}
+
+
+
+static void _graphics_bind(DvzSoft* soft, DvzRequest req)
+{
+    ANN(soft);
+
+    GET_ID(DvzSoftGraphics, graphics, req.id)
+
+    uint32_t idx = 0;
+    switch (req.type)
+    {
+    case DVZ_REQUEST_OBJECT_VERTEX:
+        idx = req.content.bind_vertex.binding_idx;
+        ASSERT(idx < DVZ_MAX_VERTEX_BINDINGS);
+        graphics->vertex_dats[idx] = req.content.bind_vertex.dat;
+        graphics->vertex_offsets[idx] = req.content.bind_vertex.offset;
+        break;
+
+    case DVZ_REQUEST_OBJECT_INDEX:
+        graphics->index_dat = req.content.bind_index.dat;
+        graphics->index_offset = req.content.bind_index.offset;
+        break;
+
+    case DVZ_REQUEST_OBJECT_DAT:
+        idx = req.content.bind_dat.slot_idx;
+        ASSERT(idx < DVZ_MAX_BINDINGS);
+        graphics->slot_dats[idx] = req.content.bind_dat.dat;
+        graphics->slot_offsets[idx] = req.content.bind_dat.offset;
+        break;
+
+    case DVZ_REQUEST_OBJECT_TEX:
+        idx = req.content.bind_tex.slot_idx;
+        ASSERT(idx < DVZ_MAX_BINDINGS);
+        graphics->slot_texs[idx] = req.content.bind_tex.tex;
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+
+static void _record(DvzSoft* soft, DvzRequest req)
+{
+    ANN(soft);
+    if (req.id == DVZ_ID_NONE)
+    {
+        log_error("invalid record command on unspecified canvas #0");
+        return;
+    }
+
+    GET_ID(DvzSoftBoard, board, req.id)
+
+    DvzRecorderCommand* cmd = &req.content.record.command;
+    cmd->object_type = (DvzRequestObject)dvz_map_type(soft->map, req.id);
+    cmd->canvas_or_board_id = req.id;
+
+    // Reset the commands when beginning a new record.
+    if (cmd->type == DVZ_RECORDER_BEGIN)
+        dvz_recorder_clear(board->recorder);
+    dvz_recorder_append(board->recorder, *cmd);
+}
+
+
+
+static void _delete(DvzSoft* soft, DvzRequest req)
+{
+    ANN(soft);
+
+    void* obj = dvz_map_get(soft->map, req.id);
+    if (obj == NULL)
+    {
+        log_error("error while deleting this object, this ID doesn't exist");
+        return;
+    }
+
+    switch (dvz_map_type(soft->map, req.id))
+    {
+    case DVZ_REQUEST_OBJECT_BOARD:
+    case DVZ_REQUEST_OBJECT_CANVAS:
+        _board_destroy((DvzSoftBoard*)obj);
+        break;
+
+    case DVZ_REQUEST_OBJECT_DAT:
+        FREE(((DvzSoftDat*)obj)->data);
+        FREE(obj);
+        break;
+
+    case DVZ_REQUEST_OBJECT_TEX:
+        FREE(((DvzSoftTex*)obj)->data);
+        FREE(obj);
+        break;
+
+    default:
+        FREE(obj);
+        break;
+    }
+    dvz_map_remove(soft->map, req.id);
+}
+
+
+
+/*************************************************************************************************/
+/*  Primitive assembly                                                                           */
+/*************************************************************************************************/
+
+// Fetch a vertex attribute of a given vertex, as a vec4.
+static bool _fetch(DvzSoftDraw* draw, uint32_t location, uint32_t vertex, vec4 out)
+{
+    ANN(draw);
+    DvzSoftGraphics* graphics = draw->graphics;
+    out[0] = out[1] = out[2] = 0;
+    out[3] = 1;
+    if (location >= graphics->attr_count || graphics->attrs[location].format == DVZ_FORMAT_NONE)
+        return false;
+
+    DvzSoftAttr* attr = &graphics->attrs[location];
+    uint32_t binding = attr->binding_idx;
+    DvzSoftDat* dat = (DvzSoftDat*)_get(draw->soft, graphics->vertex_dats[binding]);
+    if (dat == NULL)
+        return false;
+
+    uint32_t idx = graphics->rates[binding] == DVZ_VERTEX_INPUT_RATE_INSTANCE ? draw->instance
+                                                                              : vertex;
+    DvzSize offset =
+        graphics->vertex_offsets[binding] + idx * graphics->strides[binding] + attr->offset;
+    if (offset + _texel_size(attr->format) > dat->size)
+        return false;
+
+    _read_format(attr->format, &dat->data[offset], out);
+    return true;
+}
+
+
+
+// Find the first RGBA color attribute, used by the generic visuals.
+static int32_t _color_location(DvzSoftGraphics* graphics)
+{
+    ANN(graphics);
+    for (uint32_t i = 0; i < graphics->attr_count; i++)
+    {
+        if (graphics->attrs[i].format == DVZ_FORMAT_R8G8B8A8_UNORM)
+            return (int32_t)i;
+    }
+    return -1;
+}
+
+
+
+// Transform a position to window coordinates, like transform() in common.glsl.
+static bool _project(DvzSoftDraw* draw, vec4 pos, vec3 out)
+{
+    ANN(draw);
+
+    vec4 tr = {pos[0], pos[1], pos[2], 1};
+    glm_mat4_mulv(draw->mvp, tr, tr);
+
+    // Margins.
+    if (draw->has_margins)
+    {
+        float w = draw->fb_size[0], h = draw->fb_size[1];
+        float mt = draw->margins[0], mr = draw->margins[1];
+        float mb = draw->margins[2], ml = draw->margins[3];
+        if (w > 0)
+            tr[0] = (1 - (ml + mr) / w) * tr[0] + (ml - mr) / w;
+        if (h > 0)
+            tr[1] = (1 - (mb + mt) / h) * tr[1] + (mb - mt) / h;
+    }
+
+    // NOTE: no clipping, the primitives behind the camera are discarded.
+    if (tr[3] <= 0)
+        return false;
+
+    float* vp = draw->viewport;
+    out[0] = vp[0] + .5f * (tr[0] / tr[3] + 1) * vp[2];
+    out[1] = vp[1] + .5f * (1 - tr[1] / tr[3]) * vp[3]; // Vulkan swaps top and bottom
+    out[2] = .5f * (tr[2] / tr[3] + 1);
+    return true;
+}
+
+
+
+static DvzSoftPrim _prim(DvzSoftDraw* draw, DvzSoftPrimType type)
+{
+    ANN(draw);
+    DvzSoftPrim prim = {};
+    prim.type = type;
+    prim.size = 1;
+    prim.depth_test = draw->graphics->depth_test == DVZ_DEPTH_TEST_ENABLE;
+    prim.blend = draw->graphics->blend != DVZ_BLEND_DISABLE;
+
+    float* vp = draw->viewport;
+    prim.scissor[0] = (int32_t)MAX(vp[0], 0);
+    prim.scissor[1] = (int32_t)MAX(vp[1], 0);
+    prim.scissor[2] = (int32_t)MIN(vp[0] + vp[2], draw->board->width);
+    prim.scissor[3] = (int32_t)MIN(vp[1] + vp[3], draw->board->height);
+    return prim;
+}
+
+
+
+static DvzSoftTex* _slot_tex(DvzSoftDraw* draw, uint32_t slot_idx)
+{
+    ANN(draw);
+    return (DvzSoftTex*)_get(draw->soft, draw->graphics->slot_texs[slot_idx]);
+}
+
+
+
+// Return the float at the start of the push constants, or a default value if it was never pushed.
+static inline float _push_float(DvzSoftGraphics* graphics, float value)
+{
+    ANN(graphics);
+    if (graphics->push_size < sizeof(float))
+        return value;
+    float f = 0;
+    memcpy(&f, graphics->push, sizeof(float));
+    return f;
+}
+
+
+
+// Fetch a vertex for the triangles, lines and points of the generic, image and mesh visuals.
+static bool _vertex(DvzSoftDraw* draw, uint32_t vertex, vec3 pos, vec4 color, vec2 uv)
+{
+    ANN(draw);
+    DvzSoftGraphics* graphics = draw->graphics;
+
+    vec4 p = {0}, a = {0};
+    _fetch(draw, 0, vertex, p);
+    glm_vec4_one(color);
+    glm_vec2_zero(uv);
+
+    switch (draw->kind)
+    {
+    case DVZ_SOFT_KIND_IMAGE:
+        p[2] = 0;
+        _fetch(draw, 1, vertex, a);
+        glm_vec2_copy(a, uv);
+        break;
+
+    case DVZ_SOFT_KIND_MESH:
+        _fetch(draw, 2, vertex, a);
+        if (_attr_format(graphics, 2) == DVZ_FORMAT_R8G8B8A8_UNORM)
+            glm_vec4_copy(a, color);
+        else
+            glm_vec2_copy(a, uv);
+        break;
+
+    default:
+    {
+        int32_t loc = _color_location(graphics);
+        if (loc >= 0)
+            _fetch(draw, (uint32_t)loc, vertex, color);
+        break;
+    }
+    }
+
+    return _project(draw, p, pos);
+}
+
+
+
+static void _assemble_topology(DvzSoftDraw* draw, uint32_t count, uint32_t* vertices)
+{
+    ANN(draw);
+    ANN(vertices);
+
+    DvzSoftTex* tex = NULL;
+    if (draw->kind == DVZ_SOFT_KIND_IMAGE)
+        tex = _slot_tex(draw, 2);
+    else if (draw->kind == DVZ_SOFT_KIND_MESH &&
+             _attr_format(draw->graphics, 2) == DVZ_FORMAT_R32G32B32A32_SFLOAT)
+        tex = _slot_tex(draw, 3);
+
+    std::vector<DvzSoftPrim>& prims = draw->soft->frame->prims;
+    DvzPrimitiveTopology topology = draw->graphics->primitive;
+    DvzSoftPrim prim = {};
+    bool ok = true;
+
+    switch (topology)
+    {
+    case DVZ_PRIMITIVE_TOPOLOGY_POINT_LIST:
+        for (uint32_t i = 0; i < count; i++)
+        {
+            prim = _prim(draw, DVZ_SOFT_PRIM_POINT);
+            if (_vertex(draw, vertices[i], prim.pos[0], prim.color[0], prim.uv[0]))
+                prims.push_back(prim);
+        }
+        break;
+
+    case DVZ_PRIMITIVE_TOPOLOGY_LINE_LIST:
+    case DVZ_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+    {
+        uint32_t step = topology == DVZ_PRIMITIVE_TOPOLOGY_LINE_LIST ? 2 : 1;
+        for (uint32_t i = 0; i + 1 < count; i += step)
+        {
+            prim = _prim(draw, DVZ_SOFT_PRIM_LINE);
+            ok = true;
+            for (uint32_t k = 0; k < 2; k++)
+                ok &= _vertex(draw, vertices[i + k], prim.pos[k], prim.color[k], prim.uv[k]);
+            if (ok)
+                prims.push_back(prim);
+        }
+        break;
+    }
+
+    case DVZ_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST:
+    case DVZ_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP:
+    case DVZ_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN:
+    {
+        // A fan shares its first vertex: the triangles are (v0, v[i], v[i+1]) with i >= 1.
+        bool fan = topology == DVZ_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN;
+        uint32_t step = topology == DVZ_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST ? 3 : 1;
+        uint32_t idx[3] = {0};
+        for (uint32_t i = fan ? 1 : 0; i + (fan ? 1 : 2) < count; i += step)
+        {
+            idx[0] = fan ? vertices[0] : vertices[i];
+            idx[1] = fan ? vertices[i] : vertices[i + 1];
+            idx[2] = fan ? vertices[i + 1] : vertices[i + 2];
+
+            prim = _prim(draw, DVZ_SOFT_PRIM_TRIANGLE);
+            prim.tex = tex;
+            ok = true;
+            for (uint32_t k = 0; k < 3; k++)
+                ok &= _vertex(draw, idx[k], prim.pos[k], prim.color[k], prim.uv[k]);
+            if (ok)
+                prims.push_back(prim);
+        }
+        break;
+    }
+
+    default:
+        log_error("unsupported primitive topology %d", topology);
+        break;
+    }
+}
+
+
+
+// Points and markers: one disc per vertex.
+static void _assemble_points(DvzSoftDraw* draw, uint32_t count, uint32_t* vertices)
+{
+    ANN(draw);
+    ANN(vertices);
+
+    bool marker = draw->kind == DVZ_SOFT_KIND_MARKER;
+    uint32_t size_loc = marker ? 1 : 2;
+    uint32_t color_loc = marker ? 3 : 1;
+
+    // The marker visual scales its sizes with a push constant (see dvz_marker_scale()).
+    float scale = marker ? _push_float(draw->graphics, 1) : 1;
+
+    std::vector<DvzSoftPrim>& prims = draw->soft->frame->prims;
+    DvzSoftPrim prim = {};
+    vec4 pos = {0}, size = {0};
+    for (uint32_t i = 0; i < count; i++)
+    {
+        prim = _prim(draw, DVZ_SOFT_PRIM_POINT);
+        _fetch(draw, 0, vertices[i], pos);
+        _fetch(draw, color_loc, vertices[i], prim.color[0]);
+        _fetch(draw, size_loc, vertices[i], size);
+        prim.size = size[0] * scale;
+        if (_project(draw, pos, prim.pos[0]))
+            prims.push_back(prim);
+    }
+}
+
+
+
+// Segments and paths: one thick line per item, the items being quads of 4 vertices (6 indices
+// when indexed).
+static void _assemble_lines(DvzSoftDraw* draw, uint32_t count, uint32_t* vertices, bool indexed)
+{
+    ANN(draw);
+    ANN(vertices);
+
+    bool path = draw->kind == DVZ_SOFT_KIND_PATH;
+    uint32_t p0_loc = path ? 1 : 0;
+    uint32_t p1_loc = path ? 2 : 1;
+    uint32_t color_loc = path ? 4 : 3;
+
+    // The path visual passes its line width with a push constant (see dvz_path_linewidth()).
+    float path_width = _push_float(draw->graphics, 1);
+
+    std::vector<DvzSoftPrim>& prims = draw->soft->frame->prims;
+    DvzSoftPrim prim = {};
+    vec4 p0 = {0}, p1 = {0}, width = {0};
+    uint32_t step = indexed ? 6 : 4;
+    for (uint32_t i = 0; i < count; i += step)
+    {
+        prim = _prim(draw, DVZ_SOFT_PRIM_LINE);
+        _fetch(draw, p0_loc, vertices[i], p0);
+        _fetch(draw, p1_loc, vertices[i], p1);
+        _fetch(draw, color_loc, vertices[i], prim.color[0]);
+        glm_vec4_copy(prim.color[0], prim.color[1]);
+        if (path)
+            prim.size = path_width;
+        else if (_fetch(draw, 4, vertices[i], width))
+            prim.size = width[0];
+        if (_project(draw, p0, prim.pos[0]) && _project(draw, p1, prim.pos[1]))
+            prims.push_back(prim);
+    }
+}
+
+
+
+static void _draw(
+    DvzSoft* soft, DvzSoftBoard* board, vec4 viewport, DvzId graphics_id, bool indexed,
+    uint32_t first, uint32_t count, int32_t vertex_offset, uint32_t first_instance,
+    uint32_t instance_count)
+{
+    ANN(soft);
+    ANN(board);
+
+    DvzSoftGraphics* graphics = (DvzSoftGraphics*)_get(soft, graphics_id);
+    if (graphics == NULL)
+    {
+        log_error("graphics 0x%" PRIx64 " doesn't exist", graphics_id);
+        return;
+    }
+    if (count == 0)
+        return;
+
+    DvzSoftDraw draw = {};
+    draw.soft = soft;
+    draw.board = board;
+    draw.graphics = graphics;
+    draw.kind = _classify(graphics);
+    glm_vec4_copy(viewport, draw.viewport);
+
+    // MVP in slot #0.
+    DvzMVP mvp = dvz_mvp_default();
+    DvzSoftDat* dat = (DvzSoftDat*)_get(soft, graphics->slot_dats[0]);
+    if (dat != NULL && graphics->slot_offsets[0] + sizeof(DvzMVP) <= dat->size)
+        memcpy(&mvp, &dat->data[graphics->slot_offsets[0]], sizeof(DvzMVP));
+    glm_mat4_mul(mvp.proj, mvp.view, draw.mvp);
+    glm_mat4_mul(draw.mvp, mvp.model, draw.mvp);
+
+    // Viewport in slot #1, for the margins.
+    DvzViewport vp = {};
+    dat = (DvzSoftDat*)_get(soft, graphics->slot_dats[1]);
+    if (dat != NULL && graphics->slot_offsets[1] + sizeof(DvzViewport) <= dat->size)
+    {
+        memcpy(&vp, &dat->data[graphics->slot_offsets[1]], sizeof(DvzViewport));
+        draw.has_margins = true;
+        glm_vec4_copy(vp.margins, draw.margins);
+        draw.fb_size[0] = vp.size_framebuffer[0];
+        draw.fb_size[1] = vp.size_framebuffer[1];
+    }
+
+    // Vertex indices.
+    std::vector<uint32_t> vertices(count);
+    DvzSoftDat* index = NULL;
+    if (indexed)
+    {
+        index = (DvzSoftDat*)_get(soft, graphics->index_dat);
+        if (index == NULL)
+        {
+            log_error("indexed draw without index buffer");
+            return;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!indexed)
+        {
+            vertices[i] = first + i;
+            continue;
+        }
+        DvzSize offset = graphics->index_offset + (first + i) * sizeof(DvzIndex);
+        vertices[i] = 0;
+        if (offset + sizeof(DvzIndex) <= index->size)
+            vertices[i] = (uint32_t)((int32_t) * (DvzIndex*)&index->data[offset] + vertex_offset);
+    }
+
+    for (uint32_t i = 0; i < instance_count; i++)
+    {
+        draw.instance = first_instance + i;
+        switch (draw.kind)
+        {
+        case DVZ_SOFT_KIND_POINT:
+        case DVZ_SOFT_KIND_MARKER:
+            _assemble_points(&draw, count, vertices.data());
+            break;
+        case DVZ_SOFT_KIND_SEGMENT:
+        case DVZ_SOFT_KIND_PATH:
+            _assemble_lines(&draw, count, vertices.data(), indexed);
+            break;
+        default:
+            _assemble_topology(&draw, count, vertices.data());
+            break;
+        }
+    }
+}
+
+
+
+static void _draw_indirect(
+    DvzSoft* soft, DvzSoftBoard* board, vec4 viewport, DvzId graphics_id, DvzId indirect_id,
+    uint32_t draw_count, bool indexed)
+{
+    ANN(soft);
+
+    DvzSoftDat* indirect = (DvzSoftDat*)_get(soft, indirect_id);
+    if (indirect == NULL)
+    {
+        log_error("indirect dat 0x%" PRIx64 " doesn't exist", indirect_id);
+        return;
+    }
+
+    // NOTE: same layout as VkDrawIndirectCommand and VkDrawIndexedIndirectCommand.
+    DvzSize item_size = (indexed ? 5 : 4) * sizeof(uint32_t);
+    for (uint32_t i = 0; i < draw_count && (i + 1) * item_size <= indirect->size; i++)
+    {
+        uint32_t* c = (uint32_t*)&indirect->data[i * item_size];
+        if (indexed)
+            _draw(soft, board, viewport, graphics_id, true, c[2], c[0], (int32_t)c[3], c[4], c[1]);
+        else
+            _draw(soft, board, viewport, graphics_id, false, c[2], c[0], 0, c[3], c[1]);
+    }
+}
+
+
+
+/*************************************************************************************************/
+/*  Rasterization                                                                                */
+/*************************************************************************************************/
+
+static void _sample(DvzSoftTex* tex, vec2 uv, vec4 out)
+{
+    ANN(tex);
+    int32_t x = (int32_t)floorf(uv[0] * tex->shape[0]);
+    int32_t y = (int32_t)floorf(uv[1] * tex->shape[1]);
+    x = CLIP(x, 0, (int32_t)tex->shape[0] - 1);
+    y = CLIP(y, 0, (int32_t)tex->shape[1] - 1);
+    _read_format(
+        tex->format, &tex->data[((DvzSize)y * tex->shape[0] + (DvzSize)x) * tex->item_size], out);
+}
+
+
+
+static inline bool
+_fragment(DvzSoftBoard* board, DvzSoftPrim* prim, int32_t x, int32_t y, float depth, vec4 color)
+{
+    ANN(board);
+    uint32_t idx = (uint32_t)y * board->width + (uint32_t)x;
+
+    if (prim->depth_test)
+    {
+        if (depth > board->depth[idx] || depth < 0)
+            return false;
+        board->depth[idx] = depth;
+    }
+
+    uint8_t* dst = &board->rgba[4 * idx];
+    float a = prim->blend ? CLIP(color[3], 0, 1) : 1;
+    float c = 0;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        c = a * CLIP(color[i], 0, 1) + (1 - a) * dst[i] / 255.0f;
+        dst[i] = (uint8_t)roundf(255 * c);
+    }
+    dst[3] = (uint8_t)roundf(255 * (a + (1 - a) * dst[3] / 255.0f));
+    return true;
+}
+
+
+
+static uint64_t _raster_point(DvzSoftBoard* board, DvzSoftPrim* prim, int32_t* rect)
+{
+    ANN(board);
+    ANN(prim);
+
+    float cx = prim->pos[0][0], cy = prim->pos[0][1];
+    float r = .5f * MAX(prim->size, 1);
+    int32_t x0 = MAX(rect[0], (int32_t)floorf(cx - r));
+    int32_t y0 = MAX(rect[1], (int32_t)floorf(cy - r));
+    int32_t x1 = MIN(rect[2], (int32_t)ceilf(cx + r));
+    int32_t y1 = MIN(rect[3], (int32_t)ceilf(cy + r));
+
+    uint64_t count = 0;
+    int32_t ix = (int32_t)floorf(cx), iy = (int32_t)floorf(cy);
+    float dx = 0, dy = 0;
+    for (int32_t y = y0; y < y1; y++)
+    {
+        for (int32_t x = x0; x < x1; x++)
+        {
+            dx = x + .5f - cx;
+            dy = y + .5f - cy;
+            // NOTE: small points cover at least the pixel containing their center.
+            if (dx * dx + dy * dy > r * r && !(x == ix && y == iy))
+                continue;
+            count += _fragment(board, prim, x, y, prim->pos[0][2], prim->color[0]);
+        }
+    }
+    return count;
+}
+
+
+
+static uint64_t _raster_line(DvzSoftBoard* board, DvzSoftPrim* prim, int32_t* rect)
+{
+    ANN(board);
+    ANN(prim);
+
+    float* a = prim->pos[0];
+    float* b = prim->pos[1];
+    float hw = .5f * MAX(prim->size, 1);
+    int32_t x0 = MAX(rect[0], (int32_t)floorf(MIN(a[0], b[0]) - hw));
+    int32_t y0 = MAX(rect[1], (int32_t)floorf(MIN(a[1], b[1]) - hw));
+    int32_t x1 = MIN(rect[2], (int32_t)ceilf(MAX(a[0], b[0]) + hw));
+    int32_t y1 = MIN(rect[3], (int32_t)ceilf(MAX(a[1], b[1]) + hw));
+
+    float dx = b[0] - a[0], dy = b[1] - a[1];
+    float len2 = dx * dx + dy * dy;
+
+    uint64_t count = 0;
+    float t = 0, px = 0, py = 0;
+    vec4 color = {0};
+    for (int32_t y = y0; y < y1; y++)
+    {
+        for (int32_t x = x0; x < x1; x++)
+        {
+            // Distance to the segment, with round caps.
+            px = x + .5f - a[0];
+            py = y + .5f - a[1];
+            t = len2 > 0 ? CLIP((px * dx + py * dy) / len2, 0, 1) : 0;
+            px -= t * dx;
+            py -= t * dy;
+            if (px * px + py * py > hw * hw)
+                continue;
+            glm_vec4_lerp(prim->color[0], prim->color[1], t, color);
+            count += _fragment(board, prim, x, y, a[2] + t * (b[2] - a[2]), color);
+        }
+    }
+    return count;
+}
+
+
+
+static uint64_t _raster_triangle(DvzSoftBoard* board, DvzSoftPrim* prim, int32_t* rect)
+{
+    ANN(board);
+    ANN(prim);
+
+    float* p0 = prim->pos[0];
+    float* p1 = prim->pos[1];
+    float* p2 = prim->pos[2];
+    float area = (p1[0] - p0[0]) * (p2[1] - p0[1]) - (p1[1] - p0[1]) * (p2[0] - p0[0]);
+    if (fabsf(area) < 1e-8f)
+        return 0;
+
+    int32_t x0 = MAX(rect[0], (int32_t)floorf(MIN(MIN(p0[0], p1[0]), p2[0])));
+    int32_t y0 = MAX(rect[1], (int32_t)floorf(MIN(MIN(p0[1], p1[1]), p2[1])));
+    int32_t x1 = MIN(rect[2], (int32_t)ceilf(MAX(MAX(p0[0], p1[0]), p2[0])));
+    int32_t y1 = MIN(rect[3], (int32_t)ceilf(MAX(MAX(p0[1], p1[1]), p2[1])));
+
+    uint64_t count = 0;
+    float px = 0, py = 0, w0 = 0, w1 = 0, w2 = 0, depth = 0;
+    vec4 color = {0}, texel = {0};
+    vec2 uv = {0};
+    for (int32_t y = y0; y < y1; y++)
+    {
+        for (int32_t x = x0; x < x1; x++)
+        {
+            // Barycentric coordinates of the pixel center, both windings are accepted.
+            px = x + .5f;
+            py = y + .5f;
+            w0 = ((p1[0] - px) * (p2[1] - py) - (p1[1] - py) * (p2[0] - px)) / area;
+            w1 = ((p2[0] - px) * (p0[1] - py) - (p2[1] - py) * (p0[0] - px)) / area;
+            w2 = 1 - w0 - w1;
+            if (w0 < 0 || w1 < 0 || w2 < 0)
+                continue;
+
+            depth = w0 * p0[2] + w1 * p1[2] + w2 * p2[2];
+            for (uint32_t i = 0; i < 4; i++)
+                color[i] =
+                    w0 * prim->color[0][i] + w1 * prim->color[1][i] + w2 * prim->color[2][i];
+            if (prim->tex != NULL)
+            {
+                for (uint32_t i = 0; i < 2; i++)
+                    uv[i] = w0 * prim->uv[0][i] + w1 * prim->uv[1][i] + w2 * prim->uv[2][i];
+                _sample(prim->tex, uv, texel);
+                glm_vec4_mul(color, texel, color);
+            }
+            count += _fragment(board, prim, x, y, depth, color);
+        }
+    }
+    return count;
+}
+
+
+
+static void _prim_bounds(DvzSoftPrim* prim, int32_t* bounds)
+{
+    ANN(prim);
+    uint32_t n = prim->type == DVZ_SOFT_PRIM_POINT ? 1 : prim->type == DVZ_SOFT_PRIM_LINE ? 2 : 3;
+    float r = prim->type == DVZ_SOFT_PRIM_TRIANGLE ? 0 : .5f * MAX(prim->size, 1) + 1;
+    float xmin = prim->pos[0][0], xmax = xmin, ymin = prim->pos[0][1], ymax = ymin;
+    for (uint32_t i = 1; i < n; i++)
+    {
+        xmin = MIN(xmin, prim->pos[i][0]);
+        xmax = MAX(xmax, prim->pos[i][0]);
+        ymin = MIN(ymin, prim->pos[i][1]);
+        ymax = MAX(ymax, prim->pos[i][1]);
+    }
+    bounds[0] = MAX(prim->scissor[0], (int32_t)floorf(MAX(xmin - r, -1e6f)));
+    bounds[1] = MAX(prim->scissor[1], (int32_t)floorf(MAX(ymin - r, -1e6f)));
+    bounds[2] = MIN(prim->scissor[2], (int32_t)ceilf(MIN(xmax + r, 1e6f)));
+    bounds[3] = MIN(prim->scissor[3], (int32_t)ceilf(MIN(ymax + r, 1e6f)));
+}
+
+
+
+static uint64_t _raster_tile(DvzSoftBoard* board, DvzSoftFrame* frame, uint32_t tile)
+{
+    ANN(board);
+    ANN(frame);
+
+    uint32_t tiles_x = (board->width + DVZ_SOFT_TILE_SIZE - 1) / DVZ_SOFT_TILE_SIZE;
+    int32_t tx = (int32_t)((tile % tiles_x) * DVZ_SOFT_TILE_SIZE);
+    int32_t ty = (int32_t)((tile / tiles_x) * DVZ_SOFT_TILE_SIZE);
+
+    // NOTE: each pixel belongs to a single tile, and the primitives of a tile are rasterized in
+    // submission order, so that the image does not depend on the number of threads.
+    uint64_t count = 0;
+    int32_t rect[4] = {0};
+    DvzSoftPrim* prim = NULL;
+    for (uint32_t idx : frame->bins[tile])
+    {
+        prim = &frame->prims[idx];
+        rect[0] = MAX(tx, prim->scissor[0]);
+        rect[1] = MAX(ty, prim->scissor[1]);
+        rect[2] = MIN(tx + DVZ_SOFT_TILE_SIZE, prim->scissor[2]);
+        rect[3] = MIN(ty + DVZ_SOFT_TILE_SIZE, prim->scissor[3]);
+        if (rect[0] >= rect[2] || rect[1] >= rect[3])
+            continue;
+
+        switch (prim->type)
+        {
+        case DVZ_SOFT_PRIM_POINT:
+            count += _raster_point(board, prim, rect);
+            break;
+        case DVZ_SOFT_PRIM_LINE:
+            count += _raster_line(board, prim, rect);
+            break;
+        case DVZ_SOFT_PRIM_TRIANGLE:
+            count += _raster_triangle(board, prim, rect);
+            break;
+        }
+    }
+    return count;
+}
+
+
+
+static void _rasterize(DvzSoft* soft, DvzSoftBoard* board)
+{
+    ANN(soft);
+    ANN(board);
+    DvzSoftFrame* frame = soft->frame;
+    ANN(frame);
+
+    uint32_t tiles_x = (board->width + DVZ_SOFT_TILE_SIZE - 1) / DVZ_SOFT_TILE_SIZE;
+    uint32_t tiles_y = (board->height + DVZ_SOFT_TILE_SIZE - 1) / DVZ_SOFT_TILE_SIZE;
+    uint32_t tile_count = tiles_x * tiles_y;
+
+    // Bin the primitives in the tiles they overlap.
+    frame->bins.resize(tile_count);
+    for (std::vector<uint32_t>& bin : frame->bins)
+        bin.clear();
+    int32_t b[4] = {0};
+    for (uint32_t i = 0; i < frame->prims.size(); i++)
+    {
+        _prim_bounds(&frame->prims[i], b);
+        if (b[0] >= b[2] || b[1] >= b[3])
+            continue;
+        for (int32_t y = b[1] / DVZ_SOFT_TILE_SIZE; y <= (b[3] - 1) / DVZ_SOFT_TILE_SIZE; y++)
+            for (int32_t x = b[0] / DVZ_SOFT_TILE_SIZE; x <= (b[2] - 1) / DVZ_SOFT_TILE_SIZE; x++)
+                frame->bins[(uint32_t)y * tiles_x + (uint32_t)x].push_back(i);
+    }
+
+    // The tiles are distributed dynamically among the threads.
+    std::atomic<uint32_t> next(0);
+    std::atomic<uint64_t> fragments(0);
+    auto worker = [&]() {
+        uint64_t count = 0;
+        for (uint32_t tile = next++; tile < tile_count; tile = next++)
+            count += _raster_tile(board, frame, tile);
+        fragments += count;
+    };
+
+    uint32_t thread_count = MIN(soft->thread_count, tile_count);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < thread_count; i++)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    soft->stats.primitives += frame->prims.size();
+    soft->stats.fragments += fragments;
+}
+
+
+
+static void _render(DvzSoft* soft, DvzSoftBoard* board)
+{
+    ANN(soft);
+    ANN(board);
+    ANN(board->recorder);
+    log_trace("software rendering of board 0x%" PRIx64, board->obj.id);
+
+    // Clear the color and depth buffers.
+    uint32_t n = board->width * board->height;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        memcpy(&board->rgba[4 * i], board->background, sizeof(cvec4));
+        board->depth[i] = 1;
+    }
+
+    // Assemble the primitives of the recorded draw commands.
+    soft->frame->prims.clear();
+    vec4 viewport = {0, 0, (float)board->width, (float)board->height};
+    DvzRecorderCommand* cmd = NULL;
+    DvzSoftGraphics* graphics = NULL;
+    for (uint32_t i = 0; i < board->recorder->count; i++)
+    {
+        cmd = &board->recorder->commands[i];
+        switch (cmd->type)
+        {
+        case DVZ_RECORDER_VIEWPORT:
+            // NOTE: a zero shape means the whole board (DVZ_DEFAULT_VIEWPORT).
+            viewport[0] = cmd->contents.v.offset[0];
+            viewport[1] = cmd->contents.v.offset[1];
+            viewport[2] = cmd->contents.v.shape[0] > 0 ? cmd->contents.v.shape[0] : board->width;
+            viewport[3] = cmd->contents.v.shape[1] > 0 ? cmd->contents.v.shape[1] : board->height;
+            break;
+
+        case DVZ_RECORDER_DRAW:
+            _draw(
+                soft, board, viewport, cmd->contents.draw.pipe_id, false,
+                cmd->contents.draw.first_vertex, cmd->contents.draw.vertex_count, 0,
+                cmd->contents.draw.first_instance, cmd->contents.draw.instance_count);
+            break;
+
+        case DVZ_RECORDER_DRAW_INDEXED:
+            _draw(
+                soft, board, viewport, cmd->contents.draw_indexed.pipe_id, true,
+                cmd->contents.draw_indexed.first_index, cmd->contents.draw_indexed.index_count,
+                (int32_t)cmd->contents.draw_indexed.vertex_offset,
+                cmd->contents.draw_indexed.first_instance,
+                cmd->contents.draw_indexed.instance_count);
+            break;
+
+        case DVZ_RECORDER_DRAW_INDIRECT:
+        case DVZ_RECORDER_DRAW_INDEXED_INDIRECT:
+            _draw_indirect(
+                soft, board, viewport, cmd->contents.draw_indirect.pipe_id,
+                cmd->contents.draw_indirect.dat_indirect_id,
+                cmd->contents.draw_indirect.draw_count,
+                cmd->type == DVZ_RECORDER_DRAW_INDEXED_INDIRECT);
+            break;
+
+        case DVZ_RECORDER_PUSH:
+            graphics = (DvzSoftGraphics*)_get(soft, cmd->contents.push.pipe_id);
+            if (graphics != NULL &&
+                cmd->contents.push.offset + cmd->contents.push.size <= DVZ_RECORDER_PUSH_SIZE)
+            {
+                memcpy(
+                    &graphics->push[cmd->contents.push.offset], cmd->contents.push.data,
+                    cmd->contents.push.size);
+                graphics->push_size = MAX(
+                    graphics->push_size, cmd->contents.push.offset + cmd->contents.push.size);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    _rasterize(soft, board);
+
+    // Resolve the color buffer into the RGB image.
+    for (uint32_t i = 0; i < n; i++)
+        memcpy(&board->rgb[3 * i], &board->rgba[4 * i], 3);
+
+    board->obj.status = DVZ_OBJECT_STATUS_CREATED;
+    soft->stats.frames++;
+}
+
+
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+DvzSoft* dvz_soft(int flags)
+{
+    DvzSoft* soft = (DvzSoft*)calloc(1, sizeof(DvzSoft));
+    ANN(soft);
+    soft->flags = flags;
+    soft->map = dvz_map();
+    soft->frame = new DvzSoftFrame();
+    dvz_soft_threads(soft, 0);
+    dvz_obj_created(&soft->obj);
+    return soft;
+}
+
+
+
+void dvz_soft_threads(DvzSoft* soft, uint32_t thread_count)
+{
+    ANN(soft);
+    if (thread_count == 0)
+        thread_count = std::thread::hardware_concurrency();
+    soft->thread_count = CLIP(thread_count, 1u, (uint32_t)DVZ_SOFT_MAX_THREADS);
+    log_debug("software renderer with %d threads", soft->thread_count);
+}
+
+
+
+void dvz_soft_request(DvzSoft* soft, DvzRequest req)
+{
+    ANN(soft);
+    log_trace("processing software request action %d and type %d", req.action, req.type);
+
+    switch (req.action)
+    {
+    case DVZ_REQUEST_ACTION_CREATE:
+        switch (req.type)
+        {
+        case DVZ_REQUEST_OBJECT_BOARD:
+        case DVZ_REQUEST_OBJECT_CANVAS:
+            _board_create(soft, req);
+            break;
+        case DVZ_REQUEST_OBJECT_DAT:
+            _dat_create(soft, req);
+            break;
+        case DVZ_REQUEST_OBJECT_TEX:
+            _tex_create(soft, req);
+            break;
+        case DVZ_REQUEST_OBJECT_GRAPHICS:
+            _graphics_create(soft, req);
+            break;
+        default:
+            _object_create(soft, req);
+            break;
+        }
+        break;
+
+    case DVZ_REQUEST_ACTION_UPDATE:
+    {
+        GET_ID(DvzSoftBoard, board, req.id)
+        _render(soft, board);
+        break;
+    }
+
+    case DVZ_REQUEST_ACTION_RESIZE:
+        if (req.type == DVZ_REQUEST_OBJECT_BOARD)
+        {
+            GET_ID(DvzSoftBoard, board, req.id)
+            _board_alloc(board, req.content.board.width, req.content.board.height);
+        }
+        else if (req.type == DVZ_REQUEST_OBJECT_DAT)
+        {
+            GET_ID(DvzSoftDat, dat, req.id)
+            _dat_resize(dat, req.content.dat.size);
+        }
+        else if (req.type == DVZ_REQUEST_OBJECT_TEX)
+        {
+            GET_ID(DvzSoftTex, tex, req.id)
+            _tex_resize(tex, req.content.tex.shape);
+        }
+        break;
+
+    case DVZ_REQUEST_ACTION_UPLOAD:
+        if (req.type == DVZ_REQUEST_OBJECT_DAT)
+            _dat_upload(soft, req);
+        else if (req.type == DVZ_REQUEST_OBJECT_TEX)
+            _tex_upload(soft, req);
+        break;
+
+    case DVZ_REQUEST_ACTION_SET:
+        if (req.type == DVZ_REQUEST_OBJECT_BACKGROUND)
+        {
+            GET_ID(DvzSoftBoard, board, req.id)
+            memcpy(board->background, req.content.board.background, sizeof(cvec4));
+        }
+        else
+            _graphics_set(soft, req);
+        break;
+
+    case DVZ_REQUEST_ACTION_BIND:
+        _graphics_bind(soft, req);
+        break;
+
+    case DVZ_REQUEST_ACTION_RECORD:
+        _record(soft, req);
+        break;
+
+    case DVZ_REQUEST_ACTION_DELETE:
+        _delete(soft, req);
+        break;
+
+    default:
+        log_error("unsupported software request action %d and type %d", req.action, req.type);
+        break;
+    }
+}
+
+
+
+uint8_t* dvz_soft_image(DvzSoft* soft, DvzId board_id, DvzSize* size, uint8_t* rgb)
+{
+    ANN(soft);
+
+    DvzSoftBoard* board = (DvzSoftBoard*)_get(soft, board_id);
+    if (board == NULL)
+    {
+        log_error("board 0x%" PRIx64 " doesn't exist", board_id);
+        return NULL;
+    }
+
+    // NOTE: canvases are never updated explicitly, they are rendered when their image is needed.
+    if (dvz_map_type(soft->map, board_id) == DVZ_REQUEST_OBJECT_CANVAS)
+        _render(soft, board);
+
+    if (rgb != NULL)
+        memcpy(rgb, board->rgb, board->size);
+    ANN(size);
+    *size = board->size;
+    return rgb != NULL ? rgb : board->rgb;
+}
+
+
+
+DvzSoftStats dvz_soft_stats(DvzSoft* soft)
+{
+    ANN(soft);
+    return soft->stats;
+}
+
+
+
+void dvz_soft_destroy(DvzSoft* soft)
+{
+    ANN(soft);
+    log_trace("destroy the software renderer");
+
+    // Free the remaining objects.
+    DvzSoftBoard* board = NULL;
+    while ((board = (DvzSoftBoard*)dvz_map_first(soft->map, DVZ_REQUEST_OBJECT_BOARD)) != NULL)
+    {
+        dvz_map_remove(soft->map, board->obj.id);
+        _board_destroy(board);
+    }
+    while ((board = (DvzSoftBoard*)dvz_map_first(soft->map, DVZ_REQUEST_OBJECT_CANVAS)) != NULL)
+    {
+        dvz_map_remove(soft->map, board->obj.id);
+        _board_destroy(board);
+    }
+    DvzSoftDat* dat = NULL;
+    while ((dat = (DvzSoftDat*)dvz_map_first(soft->map, DVZ_REQUEST_OBJECT_DAT)) != NULL)
+    {
+        dvz_map_remove(soft->map, dat->obj.id);
+        FREE(dat->data);
+        FREE(dat);
+    }
+    DvzSoftTex* tex = NULL;
+    while ((tex = (DvzSoftTex*)dvz_map_first(soft->map, DVZ_REQUEST_OBJECT_TEX)) != NULL)
+    {
+        dvz_map_remove(soft->map, tex->obj.id);
+        FREE(tex->data);
+        FREE(tex);
+    }
+    DvzSoftGraphics* graphics = NULL;
+    while ((graphics = (DvzSoftGraphics*)dvz_map_first(soft->map, DVZ_REQUEST_OBJECT_GRAPHICS)) !=
+           NULL)
+    {
+        dvz_map_remove(soft->map, graphics->obj.id);
+        FREE(graphics);
+    }
+    DvzObject* obj = NULL;
+    while ((obj = (DvzObject*)dvz_map_first(soft->map, DVZ_REQUEST_OBJECT_SHADER)) != NULL)
+    {
+        dvz_map_remove(soft->map, obj->id);
+        FREE(obj);
+    }
+    while ((obj = (DvzObject*)dvz_map_first(soft->map, DVZ_REQUEST_OBJECT_SAMPLER)) != NULL)
+    {
+        dvz_map_remove(soft->map, obj->id);
+        FREE(obj);
+    }
+
+    dvz_map_destroy(soft->map);
+    delete soft->frame;
+    dvz_obj_destroyed(&soft->obj);
+    FREE(soft);
+}
@@ -0,0 +1,266 @@
+/*************************************************************************************************/
+/*  Frame timing                                                                                 */
+/*************************************************************************************************/
+
+#include "timing.h"
+#include "common.h"
+
+
+
+/*************************************************************************************************/
+/*  Utils                                                                                        */
+/*************************************************************************************************/
+
+static const char* _stage_names[] = {
+    "jit", "requests", "fence", "acquire", "transfers", "record", "submit", "present",
+};
+
+
+
+static void _record_reset(DvzFrameTiming* rec)
+{
+    ANN(rec);
+    memset(rec, 0, sizeof(DvzFrameTiming));
+    rec->frame_begin = -1;
+    rec->frame_end = -1;
+    rec->gpu = -1;
+    for (uint32_t i = 0; i < DVZ_TIMING_STAGE_COUNT; i++)
+    {
+        rec->begin[i] = -1;
+        rec->end[i] = -1;
+    }
+}
+
+
+
+static DvzFrameTiming* _target(DvzTiming* timing)
+{
+    ANN(timing);
+    return timing->current != NULL ? timing->current : &timing->pending;
+}
+
+
+
+// Write a complete ("X") trace event, with times in microseconds.
+static void _write_event(
+    FILE* fp, bool* first, const char* name, int tid, double begin, double duration,
+    DvzFrameTiming* rec)
+{
+    ANN(fp);
+    ANN(first);
+    ANN(rec);
+    fprintf(
+        fp,
+        "%s\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+        "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"seq\":%" PRIu64 ",\"frame\":%" PRIu64
+        ",\"window\":\"0x%" PRIx64 "\",\"frames_in_flight\":%d,\"present_mode\":%d,"
+        "\"jit\":%s}}",
+        *first ? "" : ",", name, tid, begin * 1e6, duration * 1e6, rec->seq, rec->frame_idx,
+        rec->window_id, rec->frames_in_flight, rec->present_mode, rec->jit ? "true" : "false");
+    *first = false;
+}
+
+
+
+/*************************************************************************************************/
+/*  Timing functions                                                                             */
+/*************************************************************************************************/
+
+DvzTiming dvz_timing(uint32_t capacity)
+{
+    ASSERT(capacity > 0);
+
+    DvzTiming timing = {0};
+    timing.clock = dvz_clock();
+    timing.capacity = capacity;
+    timing.records = (DvzFrameTiming*)calloc(capacity, sizeof(DvzFrameTiming));
+    ANN(timing.records);
+    _record_reset(&timing.pending);
+    return timing;
+}
+
+
+
+uint64_t dvz_timing_frame(DvzTiming* timing, uint64_t frame_idx, DvzId window_id)
+{
+    ANN(timing);
+    ANN(timing->records);
+
+    uint64_t seq = timing->count++;
+    DvzFrameTiming* rec = &timing->records[seq % timing->capacity];
+
+    // The stages measured since the last frame (request processing) belong to this frame.
+    *rec = timing->pending;
+    _record_reset(&timing->pending);
+
+    rec->seq = seq;
+    rec->frame_idx = frame_idx;
+    rec->window_id = window_id;
+    rec->frame_begin = dvz_clock_get(&timing->clock);
+    timing->current = rec;
+    return seq;
+}
+
+
+
+void dvz_timing_policy(
+    DvzTiming* timing, uint32_t frames_in_flight, uint32_t present_mode, bool jit)
+{
+    ANN(timing);
+    if (timing->current == NULL)
+        return;
+    timing->current->frames_in_flight = frames_in_flight;
+    timing->current->present_mode = present_mode;
+    timing->current->jit = jit;
+}
+
+
+
+void dvz_timing_begin(DvzTiming* timing, DvzTimingStage stage)
+{
+    ANN(timing);
+    ASSERT(stage < DVZ_TIMING_STAGE_COUNT);
+
+    DvzFrameTiming* rec = _target(timing);
+    // NOTE: if a stage occurs several times between two frames (e.g. several request batches),
+    // we keep the first begin time and the last end time.
+    if (rec->begin[stage] < 0)
+        rec->begin[stage] = dvz_clock_get(&timing->clock);
+}
+
+
+
+void dvz_timing_end(DvzTiming* timing, DvzTimingStage stage)
+{
+    ANN(timing);
+    ASSERT(stage < DVZ_TIMING_STAGE_COUNT);
+
+    DvzFrameTiming* rec = _target(timing);
+    rec->end[stage] = dvz_clock_get(&timing->clock);
+}
+
+
+
+void dvz_timing_frame_end(DvzTiming* timing)
+{
+    ANN(timing);
+    if (timing->current == NULL)
+        return;
+    timing->current->frame_end = dvz_clock_get(&timing->clock);
+    timing->current = NULL;
+}
+
+
+
+void dvz_timing_gpu(DvzTiming* timing, uint64_t seq, double duration)
+{
+    ANN(timing);
+    DvzFrameTiming* rec = dvz_timing_record(timing, seq);
+    if (rec != NULL)
+        rec->gpu = duration;
+}
+
+
+
+uint32_t dvz_timing_count(DvzTiming* timing)
+{
+    ANN(timing);
+    return (uint32_t)MIN(timing->count, (uint64_t)timing->capacity);
+}
+
+
+
+DvzFrameTiming* dvz_timing_get(DvzTiming* timing, uint32_t idx)
+{
+    ANN(timing);
+    ANN(timing->records);
+
+    uint32_t count = dvz_timing_count(timing);
+    if (idx >= count)
+    {
+        log_error("frame timing index %d out of bounds (%d records)", idx, count);
+        return NULL;
+    }
+    uint64_t seq = timing->count - count + idx;
+    return &timing->records[seq % timing->capacity];
+}
+
+
+
+DvzFrameTiming* dvz_timing_record(DvzTiming* timing, uint64_t seq)
+{
+    ANN(timing);
+    ANN(timing->records);
+
+    if (seq >= timing->count || seq + timing->capacity < timing->count)
+        return NULL;
+    DvzFrameTiming* rec = &timing->records[seq % timing->capacity];
+    ASSERT(rec->seq == seq);
+    return rec;
+}
+
+
+
+int dvz_timing_export(DvzTiming* timing, const char* path)
+{
+    ANN(timing);
+    ANN(path);
+
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL)
+    {
+        log_error("unable to open %s for writing", path);
+        return 1;
+    }
+
+    // Thread 1 holds the CPU stages, thread 2 the GPU render passes. The GPU clock is not
+    // calibrated with the CPU clock, so GPU events are placed at the time of the submission.
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    fprintf(
+        fp, "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+            "\"args\":{\"name\":\"CPU\"}},");
+    fprintf(
+        fp, "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,"
+            "\"args\":{\"name\":\"GPU\"}}");
+    bool first = false;
+
+    uint32_t count = dvz_timing_count(timing);
+    DvzFrameTiming* rec = NULL;
+    double begin = 0, end = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        rec = dvz_timing_get(timing, i);
+        ANN(rec);
+
+        begin = rec->frame_begin;
+        end = rec->frame_end;
+        if (begin >= 0 && end >= begin)
+            _write_event(fp, &first, "frame", 1, begin, end - begin, rec);
+
+        for (uint32_t j = 0; j < DVZ_TIMING_STAGE_COUNT; j++)
+        {
+            begin = rec->begin[j];
+            end = rec->end[j];
+            if (begin >= 0 && end >= begin)
+                _write_event(fp, &first, _stage_names[j], 1, begin, end - begin, rec);
+        }
+
+        begin = rec->begin[DVZ_TIMING_SUBMIT];
+        if (rec->gpu >= 0 && begin >= 0)
+            _write_event(fp, &first, "render pass", 2, begin, rec->gpu, rec);
+    }
+
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+    log_debug("exported %d frame timings to %s", count, path);
+    return 0;
+}
+
+
+
+void dvz_timing_destroy(DvzTiming* timing)
+{
+    ANN(timing);
+    FREE(timing->records);
+    timing->current = NULL;
+}
@@ -10,6 +10,7 @@
 
 // #include "../include/datoviz/canvas.h"
 #include "transfers.h"
+#include "_pointer.h"
 #include "fifo.h"
 #include "host.h"
 #include "resources_utils.h"
@@ -46,6 +47,373 @@ static DvzSize _transfer_item_size(void)
 
 
 
+static void _batch_release(DvzTransferBatch* batch, uint32_t slot)
+{
+    ANN(batch);
+    ASSERT(slot < DVZ_TRANSFER_BATCH_COUNT);
+
+    DvzList* releases = batch->releases[slot];
+    ANN(releases);
+
+    DvzTransferRelease* release = NULL;
+    uint64_t n = dvz_list_count(releases);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        release = (DvzTransferRelease*)dvz_list_get(releases, i).p;
+        ANN(release);
+        ANN(release->callback);
+        release->callback(release->user_data);
+        FREE(release);
+    }
+    dvz_list_clear(releases);
+}
+
+
+
+// Find the requested queue for a given type of work: preferably a queue requested with that exact
+// type, otherwise any queue supporting it.
+static uint32_t _scheduler_queue(DvzQueues* q, DvzQueueType type, uint32_t fallback)
+{
+    ANN(q);
+    for (uint32_t i = 0; i < q->queue_count; i++)
+        if (q->queue_types[i] == type)
+            return i;
+    for (uint32_t i = 0; i < q->queue_count; i++)
+        if ((q->queue_types[i] & type) == type)
+            return i;
+    return fallback;
+}
+
+
+
+static void _create_scheduler(DvzGpu* gpu, DvzQueueScheduler* sch)
+{
+    ANN(gpu);
+    ANN(sch);
+
+    DvzQueues* q = &gpu->queues;
+    ASSERT(q->queue_count > 0);
+
+    // NOTE: the device creation assigns each requested queue to the queue family with the fewest
+    // capabilities, so the transfer queue lands in a dedicated transfer family when one exists.
+    // On single-queue devices (e.g. lavapipe), all requested queues are the same VkQueue.
+    sch->render = _scheduler_queue(q, DVZ_QUEUE_RENDER, 0);
+    sch->transfer = _scheduler_queue(q, DVZ_QUEUE_TRANSFER, sch->render);
+    sch->compute = _scheduler_queue(q, DVZ_QUEUE_COMPUTE, sch->render);
+
+    uint32_t qf_transfer = q->queue_families[sch->transfer];
+    uint32_t qf_compute = q->queue_families[sch->compute];
+    uint32_t qf_render = q->queue_families[sch->render];
+    sch->dedicated_transfer = !q->support_graphics[qf_transfer];
+    sch->dedicated_compute = !q->support_graphics[qf_compute];
+    sch->shared = q->queues[sch->transfer] == q->queues[sch->render];
+
+    log_debug(
+        "transfer queue #%d (family #%d%s), compute queue #%d (family #%d%s), render queue #%d "
+        "(family #%d)%s",
+        sch->transfer, qf_transfer, sch->dedicated_transfer ? ", dedicated" : "", //
+        sch->compute, qf_compute, sch->dedicated_compute ? ", dedicated" : "",    //
+        sch->render, qf_render, sch->shared ? ", shared transfer/render queue" : "");
+
+    sch->timeline = gpu->support_timeline;
+    if (sch->timeline)
+    {
+        sch->transfer_timeline = dvz_timeline(gpu);
+        sch->render_timeline = dvz_timeline(gpu);
+    }
+}
+
+
+
+static void _destroy_scheduler(DvzQueueScheduler* sch)
+{
+    ANN(sch);
+    if (!sch->timeline)
+        return;
+    dvz_timeline_destroy(&sch->transfer_timeline);
+    dvz_timeline_destroy(&sch->render_timeline);
+}
+
+
+
+static void _create_batch(DvzGpu* gpu, DvzQueueScheduler* sch, DvzTransferBatch* batch)
+{
+    ANN(gpu);
+    ANN(sch);
+    ANN(batch);
+
+    uint32_t n = DVZ_TRANSFER_BATCH_COUNT;
+    batch->cmds = dvz_commands(gpu, sch->transfer, n);
+    batch->fences = dvz_fences(gpu, n, true);
+    batch->sem_done = dvz_semaphores(gpu, n);
+    batch->sem_render = dvz_semaphores(gpu, DVZ_TRANSFER_RENDER_SEMAPHORES);
+    for (uint32_t i = 0; i < n; i++)
+        batch->releases[i] = dvz_list();
+}
+
+
+
+// Wait until the batch submitted in a slot has completed, and release the resources it was using.
+static void _batch_wait(DvzTransfers* transfers, uint32_t slot)
+{
+    ANN(transfers);
+    DvzTransferBatch* batch = &transfers->batch;
+    ASSERT(slot < DVZ_TRANSFER_BATCH_COUNT);
+
+    if (batch->submitted[slot])
+    {
+        dvz_fences_wait(&batch->fences, slot);
+        batch->submitted[slot] = false;
+
+        // The staging ring regions written before this batch was submitted can now be reused.
+        DvzStagingRing* ring = &transfers->ring;
+        ring->tail = MAX(ring->tail, ring->slot_head[slot]);
+    }
+
+    _batch_release(batch, slot);
+}
+
+
+
+static void _destroy_batch(DvzTransfers* transfers)
+{
+    ANN(transfers);
+    DvzTransferBatch* batch = &transfers->batch;
+
+    for (uint32_t i = 0; i < DVZ_TRANSFER_BATCH_COUNT; i++)
+    {
+        _batch_wait(transfers, i);
+        dvz_list_destroy(batch->releases[i]);
+    }
+
+    log_debug(
+        "%" PRIu64 " transfer batch(es) submitted with %" PRIu64 " copies (%s)",
+        batch->batch_count, batch->copy_count, pretty_size(batch->copy_size));
+
+    dvz_fences_destroy(&batch->fences);
+    dvz_semaphores_destroy(&batch->sem_done);
+    dvz_semaphores_destroy(&batch->sem_render);
+    dvz_commands_destroy(&batch->cmds);
+}
+
+
+
+// Start recording the copies of the current frame in the command buffer of the next batch slot.
+static void _batch_begin(DvzTransfers* transfers)
+{
+    ANN(transfers);
+    DvzTransferBatch* batch = &transfers->batch;
+    ASSERT(!batch->recording);
+
+    batch->slot = (batch->slot + 1) % DVZ_TRANSFER_BATCH_COUNT;
+    uint32_t slot = batch->slot;
+
+    // The batch previously submitted in this slot was submitted DVZ_TRANSFER_BATCH_COUNT frames
+    // ago, so this wait should normally return immediately. Once the GPU is done with this slot,
+    // we can release the resources it was using.
+    _batch_wait(transfers, slot);
+
+    dvz_cmd_reset(&batch->cmds, slot);
+    dvz_cmd_begin(&batch->cmds, slot);
+    batch->count = 0;
+    batch->recording = true;
+}
+
+
+
+// Submit the copies recorded in the current frame to the transfer queue, in a single submission.
+static void _batch_end(DvzTransfers* transfers)
+{
+    ANN(transfers);
+    DvzTransferBatch* batch = &transfers->batch;
+    DvzQueueScheduler* sch = &transfers->scheduler;
+    ASSERT(batch->recording);
+    uint32_t slot = batch->slot;
+
+    batch->recording = false;
+    dvz_cmd_end(&batch->cmds, slot);
+
+    bool has_copies = batch->count > 0;
+
+    // A render submission could not signal a semaphore as there were too many of them since the
+    // last batch: wait until the renderer is idle instead.
+    if (batch->render_missed)
+    {
+        dvz_queue_wait(transfers->gpu, sch->render);
+        batch->render_missed = false;
+    }
+
+    // The binary semaphores signaled by the renderer must be waited upon by the next batch, even
+    // if the batch is empty, otherwise they could not be signaled again.
+    bool wait_render = batch->async && !sch->timeline && batch->render_count > 0;
+    if (!has_copies && !wait_render)
+    {
+        // Staged data whose copies were not recorded has been copied synchronously, so if no
+        // batch is in flight, the whole staging ring is free.
+        bool in_flight = false;
+        for (uint32_t i = 0; i < DVZ_TRANSFER_BATCH_COUNT; i++)
+            in_flight |= batch->submitted[i];
+        if (!in_flight)
+            transfers->ring.tail = transfers->ring.head;
+        return;
+    }
+
+    DvzSubmit submit = dvz_submit(transfers->gpu);
+    dvz_submit_commands(&submit, &batch->cmds);
+
+    if (sch->timeline)
+    {
+        // Do not overwrite data that may still be used by the last render submission. Waiting
+        // for a value that has already been reached is a no-op.
+        uint64_t render_value = sch->render_timeline.value;
+        if (batch->async && render_value > 0)
+            dvz_submit_wait_timeline(
+                &submit, VK_PIPELINE_STAGE_TRANSFER_BIT, &sch->render_timeline, render_value);
+
+        dvz_submit_signal_timeline(
+            &submit, &sch->transfer_timeline, dvz_timeline_next(&sch->transfer_timeline));
+    }
+
+    // Do not overwrite data that may still be used by the render submissions made since the last
+    // batch, one per canvas.
+    if (wait_render)
+    {
+        for (uint32_t i = 0; i < batch->render_count; i++)
+            dvz_submit_wait_semaphores(
+                &submit, VK_PIPELINE_STAGE_TRANSFER_BIT, &batch->sem_render,
+                (batch->render_first + i) % DVZ_TRANSFER_RENDER_SEMAPHORES);
+        batch->render_first =
+            (batch->render_first + batch->render_count) % DVZ_TRANSFER_RENDER_SEMAPHORES;
+        batch->render_count = 0;
+    }
+
+    if (batch->async && !sch->timeline && has_copies)
+    {
+        // If the renderer has not consumed the semaphore of the previous batch, we consume it
+        // here, the renderer will only have to wait for the last batch.
+        if (batch->done_pending)
+            dvz_submit_wait_semaphores(
+                &submit, VK_PIPELINE_STAGE_TRANSFER_BIT, &batch->sem_done, batch->done_slot);
+
+        dvz_submit_signal_semaphores(&submit, &batch->sem_done, slot);
+        batch->done_pending = true;
+        batch->done_slot = slot;
+    }
+
+    log_trace("submit transfer batch #%d with %d copies", slot, batch->count);
+    dvz_submit_send(&submit, slot, &batch->fences, slot);
+    batch->submitted[slot] = true;
+    transfers->ring.slot_head[slot] = transfers->ring.head;
+
+    if (has_copies)
+    {
+        batch->batch_count++;
+        batch->copy_count += batch->count;
+    }
+
+    // Without a renderer waiting on the semaphore, we wait for the batch here, once per frame
+    // rather than once per copy.
+    if (!batch->async)
+        _batch_wait(transfers, slot);
+}
+
+
+
+static void _create_ring(DvzGpu* gpu, DvzStagingRing* ring)
+{
+    ANN(gpu);
+    ANN(ring);
+    ASSERT(ring->size > 0);
+    ASSERT(ring->size % ring->alignment == 0);
+
+    log_debug("create staging ring of %s", pretty_size(ring->size));
+    ring->buffer = dvz_buffer(gpu);
+    dvz_buffer_queue_access(&ring->buffer, DVZ_DEFAULT_QUEUE_TRANSFER);
+    _make_staging_buffer(&ring->buffer, ring->size);
+
+    // The ring is mapped once and for all.
+    ring->buffer.mmap = dvz_buffer_map(&ring->buffer, 0, VK_WHOLE_SIZE);
+    ANN(ring->buffer.mmap);
+}
+
+
+
+static void _destroy_ring(DvzStagingRing* ring)
+{
+    ANN(ring);
+    if (!dvz_obj_is_created(&ring->buffer.obj))
+        return;
+
+    DvzStagingRingStats* stats = &ring->stats;
+    log_debug(
+        "staging ring: %" PRIu64 " allocation(s) (%s), peak %s, %" PRIu64 " wrap(s), %" PRIu64
+        " stall(s), %" PRIu64 " overflow(s)",
+        stats->alloc_count, pretty_size(stats->alloc_size), pretty_size(stats->peak),
+        stats->wrap_count, stats->stall_count, stats->overflow_count);
+
+    dvz_buffer_destroy(&ring->buffer);
+}
+
+
+
+// Reserve a region in the staging ring, waiting for the oldest in-flight batches if needed.
+static bool _ring_alloc(DvzTransfers* transfers, DvzSize size, DvzSize* offset)
+{
+    ANN(transfers);
+    ANN(offset);
+    ASSERT(size > 0);
+
+    DvzStagingRing* ring = &transfers->ring;
+    DvzTransferBatch* batch = &transfers->batch;
+    DvzStagingRingStats* stats = &ring->stats;
+
+    DvzSize req = aligned_size(size, ring->alignment);
+    if (req > ring->size)
+    {
+        stats->overflow_count++;
+        return false;
+    }
+
+    // An allocation is never split: if it does not fit before the end of the ring, we skip the
+    // remaining bytes and start again at the beginning.
+    DvzSize start = ring->head % ring->size;
+    DvzSize pad = start + req > ring->size ? ring->size - start : 0;
+
+    // Wait for the in-flight batches, oldest first, until there is enough room.
+    bool stalled = false;
+    for (uint32_t i = 1; i <= DVZ_TRANSFER_BATCH_COUNT; i++)
+    {
+        if (ring->head + pad + req - ring->tail <= ring->size)
+            break;
+        uint32_t slot = (batch->slot + i) % DVZ_TRANSFER_BATCH_COUNT;
+        if (!batch->submitted[slot])
+            continue;
+        _batch_wait(transfers, slot);
+        stalled = true;
+    }
+    if (stalled)
+        stats->stall_count++;
+
+    // The remaining regions are used by copies that have not been submitted yet.
+    if (ring->head + pad + req - ring->tail > ring->size)
+    {
+        stats->overflow_count++;
+        return false;
+    }
+
+    if (pad > 0)
+        stats->wrap_count++;
+    *offset = (ring->head + pad) % ring->size;
+    ring->head += pad + req;
+
+    stats->alloc_count++;
+    stats->alloc_size += size;
+    stats->peak = MAX(stats->peak, ring->head - ring->tail);
+    return true;
+}
+
+
+
 static void _create_transfers(DvzTransfers* transfers)
 {
     ANN(transfers);
@@ -122,6 +490,16 @@ static void _create_transfers(DvzTransfers* transfers)
         transfers->deq, DVZ_TRANSFER_DEQ_DUP, //
         DVZ_TRANSFER_DUP_COPY,                //
         _append_dup_item, transfers);
+
+    // Queue routing and synchronization with the renderer.
+    _create_scheduler(transfers->gpu, &transfers->scheduler);
+
+    // Per-frame transfer batches.
+    _create_batch(transfers->gpu, &transfers->scheduler, &transfers->batch);
+
+    // Staging ring, created on first use.
+    transfers->ring.size = DVZ_STAGING_RING_SIZE;
+    transfers->ring.alignment = DVZ_STAGING_RING_ALIGNMENT;
 }
 
 
@@ -165,12 +543,21 @@ _process_pending_dup(DvzTransfers* transfers, DvzTransferDupItem* item, uint32_t
         // region #img_idx of the target buffer.
         ASSERT(item->tr.stg.count == 1);
 
-        // Submit a copy for the img_idx part, from staging to target buffer, and wait.
-        dvz_buffer_regions_copy(
-            &item->tr.stg, 0, item->tr.stg_offset, br, img_idx, item->tr.offset, item->tr.size);
-
-        // NOTE: is the wait really necessary here? we could also use a fence, or not wait at all?
-        dvz_queue_wait(gpu, DVZ_DEFAULT_QUEUE_TRANSFER);
+        // Record a copy for the img_idx part, from staging to target buffer, in the frame batch.
+        if (transfers->batch.recording)
+        {
+            _batch_buffer_copy(
+                &transfers->batch, &item->tr.stg, 0, item->tr.stg_offset, br, img_idx,
+                item->tr.offset, item->tr.size);
+        }
+        // Otherwise, submit the copy and wait.
+        else
+        {
+            dvz_buffer_regions_copy(
+                &item->tr.stg, 0, item->tr.stg_offset, br, img_idx, item->tr.offset,
+                item->tr.size);
+            dvz_queue_wait(gpu, DVZ_DEFAULT_QUEUE_TRANSFER);
+        }
     }
     else
     {
@@ -221,18 +608,14 @@ void dvz_transfers_frame(DvzTransfers* transfers, uint32_t img_idx)
     ANN(transfers);
     log_trace("transfers frame #%d", img_idx);
 
-    DvzGpu* gpu = transfers->gpu;
-    ANN(gpu);
+    // All GPU copies dequeued below are recorded in a single command buffer, submitted once at
+    // the end of this function instead of being submitted and waited upon one by one.
+    _batch_begin(transfers);
 
     // Dequeue all pending copies (which are either buffer copies, or direct mappable).
     // This is NOT used for transfer dups, which are enqueued in a different queue/proc (DUP).
-    // NOTE: this call *blocks* the GPU until the copies are complete.
     dvz_deq_dequeue_batch(transfers->deq, DVZ_TRANSFER_PROC_CPY);
 
-    // Dequeue the pending EV items, mostly used for UPLOAD_DONE events (temporary staging dat
-    // deallocation).
-    dvz_deq_dequeue_batch(transfers->deq, DVZ_TRANSFER_PROC_EV);
-
     // Now, process dup transfers.
     dvz_deq_dequeue_batch(transfers->deq, DVZ_TRANSFER_PROC_DUP);
 
@@ -241,20 +624,230 @@ void dvz_transfers_frame(DvzTransfers* transfers, uint32_t img_idx)
     if (_dups_empty(dups))
     {
         log_trace("no ongoing dup transfer");
-        return;
     }
-    // HACK: should be wrapped in an interface instead.
-    // Process all ongoing dups.
-    DvzTransferDupItem* item = NULL;
-    for (uint32_t i = 0; i < DVZ_DUPS_MAX; i++)
+    else
     {
-        item = &dups->dups[i];
-        ANN(item);
-        if (item->is_set)
+        // HACK: should be wrapped in an interface instead.
+        // Process all ongoing dups.
+        DvzTransferDupItem* item = NULL;
+        for (uint32_t i = 0; i < DVZ_DUPS_MAX; i++)
         {
-            _process_pending_dup(transfers, item, img_idx);
+            item = &dups->dups[i];
+            ANN(item);
+            if (item->is_set)
+            {
+                _process_pending_dup(transfers, item, img_idx);
+            }
         }
     }
+
+    // Submit the batch. Unless async mode is enabled, this call waits until the copies are
+    // complete.
+    _batch_end(transfers);
+
+    // Dequeue the pending EV items, mostly used for UPLOAD_DONE events (temporary staging dat
+    // deallocation, deferred with dvz_transfers_release() until the batch has completed).
+    dvz_deq_dequeue_batch(transfers->deq, DVZ_TRANSFER_PROC_EV);
+}
+
+
+
+void dvz_transfers_async(DvzTransfers* transfers, bool async)
+{
+    ANN(transfers);
+    transfers->batch.async = async;
+}
+
+
+
+uint32_t dvz_transfers_queue(DvzTransfers* transfers, DvzQueueType type)
+{
+    ANN(transfers);
+    DvzQueueScheduler* sch = &transfers->scheduler;
+    switch (type)
+    {
+    case DVZ_QUEUE_TRANSFER:
+        return sch->transfer;
+    case DVZ_QUEUE_COMPUTE:
+        return sch->compute;
+    case DVZ_QUEUE_RENDER:
+        return sch->render;
+    default:
+        log_error("unsupported queue type %d", type);
+        break;
+    }
+    return sch->render;
+}
+
+
+
+void dvz_transfers_sync_render(DvzTransfers* transfers, DvzSubmit* submit)
+{
+    ANN(transfers);
+    ANN(submit);
+
+    DvzTransferBatch* batch = &transfers->batch;
+    DvzQueueScheduler* sch = &transfers->scheduler;
+    if (!batch->async)
+        return;
+
+    if (sch->timeline)
+    {
+        uint64_t transfer_value = sch->transfer_timeline.value;
+        if (transfer_value > 0)
+            dvz_submit_wait_timeline(
+                submit, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, &sch->transfer_timeline,
+                transfer_value);
+        dvz_submit_signal_timeline(
+            submit, &sch->render_timeline, dvz_timeline_next(&sch->render_timeline));
+        return;
+    }
+
+    // Fallback with binary semaphores.
+    uint32_t idx = 0;
+    DvzSemaphores* semaphores = dvz_transfers_wait_semaphore(transfers, &idx);
+    if (semaphores != NULL)
+        dvz_submit_wait_semaphores(submit, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, semaphores, idx);
+
+    // The semaphore of the last batch was already consumed by another render submission (another
+    // canvas in the same frame): this submission waits for the batch on the CPU instead.
+    else if (batch->submitted[batch->done_slot])
+        _batch_wait(transfers, batch->done_slot);
+
+    semaphores = dvz_transfers_signal_semaphore(transfers, &idx);
+    if (semaphores != NULL)
+        dvz_submit_signal_semaphores(submit, semaphores, idx);
+}
+
+
+
+DvzSemaphores* dvz_transfers_wait_semaphore(DvzTransfers* transfers, uint32_t* idx)
+{
+    ANN(transfers);
+    ANN(idx);
+
+    DvzTransferBatch* batch = &transfers->batch;
+    if (!batch->done_pending)
+        return NULL;
+
+    batch->done_pending = false;
+    *idx = batch->done_slot;
+    return &batch->sem_done;
+}
+
+
+
+DvzSemaphores* dvz_transfers_signal_semaphore(DvzTransfers* transfers, uint32_t* idx)
+{
+    ANN(transfers);
+    ANN(idx);
+
+    DvzTransferBatch* batch = &transfers->batch;
+    if (!batch->async || transfers->scheduler.timeline)
+        return NULL;
+
+    // Each render submission made since the last batch (one per canvas) signals its own
+    // semaphore, as the next batch must wait for all of them.
+    if (batch->render_count >= DVZ_TRANSFER_RENDER_SEMAPHORES)
+    {
+        batch->render_missed = true;
+        return NULL;
+    }
+
+    *idx = (batch->render_first + batch->render_count) % DVZ_TRANSFER_RENDER_SEMAPHORES;
+    batch->render_count++;
+    return &batch->sem_render;
+}
+
+
+
+void dvz_transfers_release(
+    DvzTransfers* transfers, DvzTransferReleaseCallback callback, void* user_data)
+{
+    ANN(transfers);
+    ANN(callback);
+
+    DvzTransferBatch* batch = &transfers->batch;
+    uint32_t slot = batch->slot;
+
+    // Release immediately if the GPU is not using the current batch.
+    if (!batch->recording && !batch->submitted[slot])
+    {
+        callback(user_data);
+        return;
+    }
+
+    DvzTransferRelease* release = (DvzTransferRelease*)calloc(1, sizeof(DvzTransferRelease));
+    ANN(release);
+    release->callback = callback;
+    release->user_data = user_data;
+    dvz_list_append(batch->releases[slot], (DvzListItem){.p = (void*)release});
+}
+
+
+
+void dvz_transfers_ring_size(DvzTransfers* transfers, DvzSize size)
+{
+    ANN(transfers);
+    ASSERT(size > 0);
+
+    DvzStagingRing* ring = &transfers->ring;
+    if (dvz_obj_is_created(&ring->buffer.obj))
+    {
+        log_error("the staging ring size cannot be changed after its creation");
+        return;
+    }
+    ring->size = aligned_size(size, ring->alignment);
+}
+
+
+
+bool dvz_transfers_stage(
+    DvzTransfers* transfers, DvzSize size, void* data, DvzBufferRegions* br, DvzSize* offset)
+{
+    return dvz_transfers_stage_strided(transfers, 1, size, size, data, br, offset);
+}
+
+
+
+bool dvz_transfers_stage_strided(
+    DvzTransfers* transfers, uint32_t count, DvzSize item_size, DvzSize stride, void* data,
+    DvzBufferRegions* br, DvzSize* offset)
+{
+    ANN(transfers);
+    ANN(data);
+    ANN(br);
+    ANN(offset);
+    ASSERT(count > 0);
+    ASSERT(item_size > 0);
+    DvzSize size = count * item_size;
+
+    DvzStagingRing* ring = &transfers->ring;
+    if (!dvz_obj_is_created(&ring->buffer.obj))
+        _create_ring(transfers->gpu, ring);
+
+    if (!_ring_alloc(transfers, size, offset))
+    {
+        log_debug("%s do not fit in the staging ring", pretty_size(size));
+        return false;
+    }
+
+    dvz_gather(
+        (void*)((uint64_t)ring->buffer.mmap + (uint64_t)*offset), data, count, item_size, stride);
+    *br = dvz_buffer_regions(&ring->buffer, 1, 0, ring->size, 0);
+    return true;
+}
+
+
+
+DvzStagingRingStats dvz_transfers_ring_stats(DvzTransfers* transfers)
+{
+    ANN(transfers);
+    DvzStagingRing* ring = &transfers->ring;
+    DvzStagingRingStats stats = ring->stats;
+    stats.size = ring->size;
+    stats.used = ring->head - ring->tail;
+    return stats;
 }
 
 
@@ -279,6 +872,11 @@ void dvz_transfers_destroy(DvzTransfers* transfers)
     log_trace("join threads");
     dvz_thread_join(transfers->thread);
 
+    // Wait for the in-flight transfer batches and destroy them.
+    _destroy_batch(transfers);
+    _destroy_ring(&transfers->ring);
+    _destroy_scheduler(&transfers->scheduler);
+
     // Destroy the deq.
     dvz_deq_destroy(transfers->deq);
 
@@ -208,7 +208,8 @@ static DvzDeqItem* _create_dup_copy(
 // WARNING: if there is NO staging buffer, the caller must dequeue the CPY proc manually on the
 // main thread to ensure the upload is done. This is to give a chance to the caller to synchronize
 // access to the mappable buffer.
-static void _enqueue_buffer_upload(
+// Return the task of the COPY queue whose processing completes the upload.
+static void* _enqueue_buffer_upload(
     DvzDeq* deq,                              //
     DvzBufferRegions br, DvzSize buf_offset,  // destination buffer
     DvzBufferRegions stg, DvzSize stg_offset, // optional staging buffer
@@ -256,7 +257,9 @@ static void _enqueue_buffer_upload(
         dvz_deq_enqueue_next(stg.buffer == NULL ? deq_item : next_item, done_item, false);
     }
 
+    void* task = stg.buffer == NULL ? deq_item->item : next_item->item;
     dvz_deq_enqueue_submit(deq, deq_item, false);
+    return task;
 }
 
 
@@ -392,7 +395,8 @@ static void _enqueue_dup_transfer(
 /*  Image transfer task enqueuing                                                              */
 /*************************************************************************************************/
 
-static void _enqueue_image_upload(
+// Return the task of the COPY queue whose processing completes the upload.
+static void* _enqueue_image_upload(
     DvzDeq* deq, DvzImages* img, uvec3 offset, uvec3 shape, //
     DvzBufferRegions stg, DvzSize stg_offset, DvzSize size, void* data)
 {
@@ -424,7 +428,9 @@ static void _enqueue_image_upload(
     // Dependency.
     dvz_deq_enqueue_next(deq_item, next_item, false);
 
+    void* task = next_item->item;
     dvz_deq_enqueue_submit(deq, deq_item, false);
+    return task;
 }
 
 
@@ -540,6 +546,84 @@ static void _enqueue_buffer_image(
 
 
 
+/*************************************************************************************************/
+/*  Transfer batch                                                                               */
+/*************************************************************************************************/
+
+// Record a copy between buffer regions in the current batch command buffer. Same semantics as
+// dvz_buffer_regions_copy(): an index of UINT32_MAX means all regions.
+static void _batch_buffer_copy(
+    DvzTransferBatch* batch,                                          //
+    DvzBufferRegions* src, uint32_t src_idx, VkDeviceSize src_offset, //
+    DvzBufferRegions* dst, uint32_t dst_idx, VkDeviceSize dst_offset, VkDeviceSize size)
+{
+    ANN(batch);
+    ANN(src);
+    ANN(dst);
+    ANN(src->buffer);
+    ANN(dst->buffer);
+    ASSERT(batch->recording);
+    ASSERT(size > 0);
+
+    uint32_t u = 0, v = 0;
+    for (uint32_t i = 0; i < MAX(src->count, dst->count); i++)
+    {
+        u = src_idx >= src->count ? i : src_idx;
+        v = dst_idx >= dst->count ? i : dst_idx;
+        if (u >= src->count || v >= dst->count)
+            break;
+        dvz_cmd_copy_buffer(
+            &batch->cmds, batch->slot,                 //
+            src->buffer, src->offsets[u] + src_offset, //
+            dst->buffer, dst->offsets[v] + dst_offset, size);
+        batch->count++;
+        batch->copy_size += size;
+
+        // NOTE: a single region to copy if neither src_idx nor dst_idx is UINT32_MAX
+        if (src_idx < src->count && dst_idx < dst->count)
+            break;
+    }
+}
+
+
+
+// Record a buffer to image copy in the current batch command buffer, with the image layout
+// transitions before and after the copy.
+static void _batch_buffer_image(DvzTransferBatch* batch, DvzTransferBufferImage* tr)
+{
+    ANN(batch);
+    ANN(tr);
+    ASSERT(batch->recording);
+
+    DvzImages* img = tr->img;
+    ANN(img);
+    DvzGpu* gpu = img->gpu;
+    ANN(gpu);
+    DvzCommands* cmds = &batch->cmds;
+    uint32_t idx = batch->slot;
+
+    DvzBarrier barrier = dvz_barrier(gpu);
+    dvz_barrier_stages(&barrier, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    dvz_barrier_images(&barrier, img);
+    dvz_barrier_images_layout(
+        &barrier, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    dvz_barrier_images_access(&barrier, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+    dvz_cmd_barrier(cmds, idx, &barrier);
+
+    dvz_cmd_copy_buffer_to_image(
+        cmds, idx, tr->br.buffer, tr->br.offsets[0] + tr->buf_offset, img, tr->img_offset,
+        tr->shape);
+
+    dvz_barrier_images_layout(&barrier, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, img->layout);
+    dvz_barrier_images_access(&barrier, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT);
+    dvz_cmd_barrier(cmds, idx, &barrier);
+
+    batch->count++;
+    batch->copy_size += tr->size;
+}
+
+
+
 /*************************************************************************************************/
 /*  Buffer transfer task processing                                                              */
 /*************************************************************************************************/
@@ -588,16 +672,28 @@ static void _process_buffer_copy(DvzDeq* deq, void* item, void* user_data)
 {
     ANN(user_data);
     DvzTransfers* transfers = (DvzTransfers*)user_data;
-    log_trace("process buffer copy (sync)");
 
     DvzTransferBufferCopy* tr = (DvzTransferBufferCopy*)item;
     ANN(tr);
 
-    // Make the GPU-GPU buffer copy (block the GPU and wait for the copy to finish).
+    // Copies to a staging buffer are downloads: the next task (DL) reads the staging buffer right
+    // after this callback, so these copies cannot be deferred to the end of the frame.
+    bool is_download = tr->dst.buffer->type == DVZ_BUFFER_TYPE_STAGING;
+
+    // Record the copy in the current frame batch, it will be submitted at the end of
+    // dvz_transfers_frame() together with the other copies of the frame.
+    if (transfers->batch.recording && !is_download)
+    {
+        log_trace("record buffer copy in the frame batch");
+        _batch_buffer_copy(
+            &transfers->batch, &tr->src, UINT32_MAX, tr->src_offset, &tr->dst, UINT32_MAX,
+            tr->dst_offset, tr->size);
+        return;
+    }
 
-    // TODO OPTIM: use a batch callback to wait only if there is >= 1 dequeued tasks, instead of
-    // waiting at every dequeued item in a given batch.
+    log_trace("process buffer copy (sync)");
 
+    // Make the GPU-GPU buffer copy (block the GPU and wait for the copy to finish).
     dvz_queue_wait(transfers->gpu, DVZ_DEFAULT_QUEUE_RENDER);
     dvz_buffer_regions_copy(
         &tr->src, UINT32_MAX, tr->src_offset, &tr->dst, UINT32_MAX, tr->dst_offset, tr->size);
@@ -639,7 +735,6 @@ static void _process_buffer_image(DvzDeq* deq, void* item, void* user_data)
 {
     DvzTransferBufferImage* tr = (DvzTransferBufferImage*)item;
     ANN(tr);
-    log_trace("process copy buffer to image (sync)");
 
     // Copy the data to the staging buffer.
     ANN(tr->img);
@@ -652,6 +747,16 @@ static void _process_buffer_image(DvzDeq* deq, void* item, void* user_data)
     ASSERT(tr->shape[1] > 0);
     ASSERT(tr->shape[2] > 0);
 
+    // Record the copy in the current frame batch.
+    if (transfers->batch.recording)
+    {
+        log_trace("record copy buffer to image in the frame batch");
+        _batch_buffer_image(&transfers->batch, tr);
+        return;
+    }
+
+    log_trace("process copy buffer to image (sync)");
+
     dvz_images_copy_from_buffer(
         tr->img, tr->img_offset, tr->shape, tr->br, tr->buf_offset, tr->size);
     // Wait for the copy to be finished.
@@ -0,0 +1,1143 @@
+/*************************************************************************************************/
+/*  Transport: request batches over a Unix domain socket                                         */
+/*************************************************************************************************/
+
+// NOTE: needed for memfd_create().
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "transport.h"
+#include "_mutex.h"
+#include "codec.h"
+
+#if !OS_WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+
+
+#if !OS_WIN32
+
+/*************************************************************************************************/
+/*  Structs                                                                                      */
+/*************************************************************************************************/
+
+// Beginning of the shared-memory segment, the ring data follows.
+typedef struct
+{
+    _Atomic uint64_t tail; // end of the last released region, written by the server
+    uint64_t capacity;
+    uint8_t _padding[DVZ_TRANSPORT_ALIGNMENT - 2 * sizeof(uint64_t)];
+} DvzTransportRingHeader;
+
+
+
+struct DvzTransportRing
+{
+    int fd;
+    DvzSize size; // size of the mapping, header included
+    uint8_t* map;
+    DvzTransportRingHeader* header;
+    uint8_t* data;
+    uint64_t head; // end of the last allocated region, only used by the client
+};
+
+
+
+// Region of a ring still in use by the server.
+typedef struct
+{
+    uint64_t end;
+    bool released;
+} DvzTransportRegion;
+
+
+
+struct DvzTransportPeer
+{
+    int fd;     // -1 once disconnected
+    bool ready; // whether the handshake has been received
+    DvzTransportRing ring;
+
+    // Regions in ring order, the tail advances when the oldest ones are released.
+    DvzMutex lock; // the renderer may release the regions from another thread
+    uint64_t first_region;
+    uint32_t region_count, region_capacity;
+    DvzTransportRegion* regions;
+};
+
+
+
+// Passed to the release callback of the uploads read in place in a ring.
+typedef struct
+{
+    DvzTransportPeer* peer;
+    uint64_t region;
+} DvzTransportRelease;
+
+
+
+/*************************************************************************************************/
+/*  Socket utils                                                                                 */
+/*************************************************************************************************/
+
+static int _send_all(int fd, const void* data, DvzSize size)
+{
+    const uint8_t* ptr = (const uint8_t*)data;
+    ssize_t n = 0;
+    int flags = 0;
+#ifdef MSG_NOSIGNAL
+    flags = MSG_NOSIGNAL;
+#endif
+    while (size > 0)
+    {
+        n = send(fd, ptr, size, flags);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return 1;
+        ptr += n;
+        size -= (DvzSize)n;
+    }
+    return 0;
+}
+
+
+
+static int _recv_all(int fd, void* data, DvzSize size)
+{
+    uint8_t* ptr = (uint8_t*)data;
+    ssize_t n = 0;
+    while (size > 0)
+    {
+        n = recv(fd, ptr, size, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return 1;
+        ptr += n;
+        size -= (DvzSize)n;
+    }
+    return 0;
+}
+
+
+
+static DvzTransportFrame _frame(DvzTransportFrameType type)
+{
+    DvzTransportFrame frame = {0};
+    frame.magic = DVZ_TRANSPORT_MAGIC;
+    frame.version = DVZ_TRANSPORT_VERSION;
+    frame.type = (uint16_t)type;
+    return frame;
+}
+
+
+
+static bool _frame_valid(DvzTransportFrame* frame)
+{
+    ANN(frame);
+    if (frame->magic != DVZ_TRANSPORT_MAGIC || frame->version != DVZ_TRANSPORT_VERSION)
+    {
+        log_error(
+            "invalid transport frame (magic 0x%x, version %d)", frame->magic, frame->version);
+        return false;
+    }
+    return true;
+}
+
+
+
+static bool _address(const char* path, struct sockaddr_un* addr)
+{
+    ANN(path);
+    ANN(addr);
+    if (strlen(path) >= sizeof(addr->sun_path))
+    {
+        log_error("socket path too long: `%s`", path);
+        return false;
+    }
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    strncpy(addr->sun_path, path, sizeof(addr->sun_path) - 1);
+    return true;
+}
+
+
+
+/*************************************************************************************************/
+/*  Ring utils                                                                                   */
+/*************************************************************************************************/
+
+static int _shm_fd(DvzSize size)
+{
+    int fd = -1;
+#if OS_LINUX
+    fd = memfd_create("datoviz-transport", MFD_CLOEXEC);
+#else
+    // Anonymous POSIX shared memory: the name is unlinked as soon as the segment is created.
+    static uint32_t counter = 0;
+    char name[64] = {0};
+    snprintf(name, sizeof(name), "/dvz-%d-%u", (int)getpid(), counter++);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0)
+        shm_unlink(name);
+#endif
+    if (fd < 0)
+    {
+        log_error("unable to create a shared-memory segment: %s", strerror(errno));
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        log_error("unable to resize the shared-memory segment: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+
+static bool _ring_map(DvzTransportRing* ring, int fd, DvzSize size)
+{
+    ANN(ring);
+    void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        log_error("unable to map the shared-memory segment: %s", strerror(errno));
+        return false;
+    }
+    ring->fd = fd;
+    ring->size = size;
+    ring->map = (uint8_t*)map;
+    ring->header = (DvzTransportRingHeader*)map;
+    ring->data = ring->map + sizeof(DvzTransportRingHeader);
+    return true;
+}
+
+
+
+static void _ring_unmap(DvzTransportRing* ring)
+{
+    ANN(ring);
+    if (ring->map != NULL)
+        munmap(ring->map, ring->size);
+    if (ring->fd >= 0)
+        close(ring->fd);
+    ring->map = NULL;
+    ring->fd = -1;
+}
+
+
+
+// Reserve a region in the ring, returns false if the server has not released enough space yet.
+static bool _ring_alloc(DvzTransportRing* ring, DvzSize size, uint64_t* pos)
+{
+    ANN(ring);
+    ANN(ring->header);
+    ANN(pos);
+
+    uint64_t capacity = ring->header->capacity;
+    const DvzSize align = DVZ_TRANSPORT_ALIGNMENT;
+    size = align * ((size + align - 1) / align);
+    if (size > capacity)
+        return false;
+
+    // Regions do not wrap around the end of the ring.
+    uint64_t start = ring->head;
+    if (start % capacity + size > capacity)
+        start += capacity - start % capacity;
+
+    uint64_t tail = atomic_load_explicit(&ring->header->tail, memory_order_acquire);
+    if (start + size - tail > capacity)
+        return false;
+
+    ring->head = start + size;
+    *pos = start;
+    return true;
+}
+
+
+
+// Track a region of the ring of a producer, returns its index.
+static uint64_t _region_push(DvzTransportPeer* peer, uint64_t end)
+{
+    ANN(peer);
+    dvz_mutex_lock(&peer->lock);
+    if (peer->region_count >= peer->region_capacity)
+    {
+        peer->region_capacity = MAX(2 * peer->region_capacity, 64);
+        REALLOC(peer->regions, peer->region_capacity * sizeof(DvzTransportRegion));
+    }
+    peer->regions[peer->region_count++] = (DvzTransportRegion){.end = end, .released = false};
+    uint64_t region = peer->first_region + peer->region_count - 1;
+    dvz_mutex_unlock(&peer->lock);
+    return region;
+}
+
+
+
+// Release a region, the producer can reuse the ring up to the oldest region still in use.
+static void _region_release(DvzTransportPeer* peer, uint64_t region)
+{
+    ANN(peer);
+    ANN(peer->ring.header);
+    dvz_mutex_lock(&peer->lock);
+    ASSERT(region >= peer->first_region);
+    ASSERT(region - peer->first_region < peer->region_count);
+    peer->regions[region - peer->first_region].released = true;
+
+    uint32_t k = 0;
+    while (k < peer->region_count && peer->regions[k].released)
+        k++;
+    if (k > 0)
+    {
+        atomic_store_explicit(
+            &peer->ring.header->tail, peer->regions[k - 1].end, memory_order_release);
+        memmove(
+            peer->regions, &peer->regions[k],
+            (peer->region_count - k) * sizeof(DvzTransportRegion));
+        peer->region_count -= k;
+        peer->first_region += k;
+    }
+    dvz_mutex_unlock(&peer->lock);
+}
+
+
+
+static void _ring_release(void* user_data)
+{
+    DvzTransportRelease* release = (DvzTransportRelease*)user_data;
+    ANN(release);
+    _region_release(release->peer, release->region);
+    FREE(release);
+}
+
+
+
+/*************************************************************************************************/
+/*  Payload utils                                                                                */
+/*************************************************************************************************/
+
+// Return the address of the pointer fields of a request that reference a payload.
+static void** _payload_field(DvzRequest* req, uint32_t field, DvzSize* size)
+{
+    ANN(req);
+    ANN(size);
+    DvzRequestContent* c = &req->content;
+
+    // NOTE: shared-memory uploads are already visible to the server, they are sent as they are.
+    if (req->action == DVZ_REQUEST_ACTION_UPLOAD && req->type == DVZ_REQUEST_OBJECT_DAT &&
+        c->dat_upload.upload_type == DVZ_UPLOAD_TYPE_SHM)
+        return NULL;
+    if (req->action == DVZ_REQUEST_ACTION_UPLOAD && req->type == DVZ_REQUEST_OBJECT_TEX &&
+        c->tex_upload.upload_type == DVZ_UPLOAD_TYPE_SHM)
+        return NULL;
+
+    if (req->action == DVZ_REQUEST_ACTION_UPLOAD && req->type == DVZ_REQUEST_OBJECT_DAT &&
+        field == 0)
+    {
+        *size = c->dat_upload.size;
+        return &c->dat_upload.data;
+    }
+    if (req->action == DVZ_REQUEST_ACTION_UPLOAD && req->type == DVZ_REQUEST_OBJECT_TEX &&
+        field == 0)
+    {
+        *size = c->tex_upload.size;
+        return &c->tex_upload.data;
+    }
+    if (req->action == DVZ_REQUEST_ACTION_CREATE && req->type == DVZ_REQUEST_OBJECT_SHADER)
+    {
+        *size = c->shader.size;
+        return field == 0 ? (void**)&c->shader.code : (void**)&c->shader.buffer;
+    }
+    if (req->action == DVZ_REQUEST_ACTION_SET &&
+        req->type == DVZ_REQUEST_OBJECT_SPECIALIZATION && field == 0)
+    {
+        *size = c->set_specialization.size;
+        return &c->set_specialization.value;
+    }
+    return NULL;
+}
+
+
+
+// Whether a payload is a strided dat upload source.
+static bool _payload_strided(DvzRequest* req)
+{
+    ANN(req);
+    if (req->action != DVZ_REQUEST_ACTION_UPLOAD || req->type != DVZ_REQUEST_OBJECT_DAT)
+        return false;
+    uint32_t item_size = req->content.dat_upload.item_size;
+    return item_size > 0 && req->content.dat_upload.stride != item_size;
+}
+
+
+
+// Copy a payload to a contiguous destination, gathering strided dat uploads.
+static void _payload_copy(DvzRequest* req, void* src, DvzSize size, void* dst)
+{
+    ANN(req);
+    ANN(src);
+    ANN(dst);
+
+    if (_payload_strided(req))
+    {
+        uint32_t item_size = req->content.dat_upload.item_size;
+        uint32_t stride = req->content.dat_upload.stride;
+        dvz_gather(dst, src, (uint32_t)(size / item_size), item_size, stride);
+        return;
+    }
+    memcpy(dst, src, size);
+}
+
+
+
+// Consume a sent payload, like the renderer does once it has processed the request.
+static void _payload_consume(DvzRequest* req, void** ptr)
+{
+    ANN(req);
+    ANN(ptr);
+
+    if (req->action == DVZ_REQUEST_ACTION_UPLOAD && req->type == DVZ_REQUEST_OBJECT_DAT)
+    {
+        if ((req->flags & DVZ_UPLOAD_FLAGS_NOCOPY) == 0)
+            FREE(*ptr);
+        if (req->content.dat_upload.release != NULL)
+            req->content.dat_upload.release(req->content.dat_upload.user_data);
+        req->content.dat_upload.release = NULL;
+        req->content.dat_upload.user_data = NULL;
+    }
+    else if (
+        req->action != DVZ_REQUEST_ACTION_UPLOAD || (req->flags & DVZ_UPLOAD_FLAGS_NOCOPY) == 0)
+    {
+        FREE(*ptr);
+    }
+    *ptr = NULL;
+}
+
+
+
+// Clear the fields of a request that are meaningless in another process, before sending it and
+// after receiving it: the pointers, restored from the payloads by the server, the description
+// string, and the ownership flags, strides and release callback of the uploads.
+static void _request_clear(DvzRequest* req)
+{
+    ANN(req);
+
+    DvzSize size = 0;
+    void** ptr = NULL;
+    for (uint32_t field = 0; field < 2; field++)
+        if ((ptr = _payload_field(req, field, &size)) != NULL)
+            *ptr = NULL;
+    req->desc = NULL; // set by dvz_batch_desc(), dereferenced by dvz_batch_print()
+
+    // The server owns the payloads it receives inline.
+    if (req->action == DVZ_REQUEST_ACTION_UPLOAD && req->type == DVZ_REQUEST_OBJECT_TEX &&
+        req->content.tex_upload.upload_type != DVZ_UPLOAD_TYPE_SHM)
+    {
+        req->flags &= ~DVZ_UPLOAD_FLAGS_NOCOPY;
+    }
+    if (req->action == DVZ_REQUEST_ACTION_UPLOAD && req->type == DVZ_REQUEST_OBJECT_DAT &&
+        req->content.dat_upload.upload_type != DVZ_UPLOAD_TYPE_SHM)
+    {
+        req->flags &= ~DVZ_UPLOAD_FLAGS_NOCOPY;
+        req->content.dat_upload.item_size = 0;
+        req->content.dat_upload.stride = 0;
+        req->content.dat_upload.release = NULL;
+        req->content.dat_upload.user_data = NULL;
+    }
+}
+
+
+
+/*************************************************************************************************/
+/*  Server utils                                                                                 */
+/*************************************************************************************************/
+
+static void _peer_close(DvzTransportPeer* peer)
+{
+    ANN(peer);
+    if (peer->fd < 0)
+        return;
+    log_debug("producer disconnected");
+    close(peer->fd);
+    peer->fd = -1;
+    // NOTE: the ring stays mapped until the transport is destroyed, as the renderer may still
+    // hold pending uploads pointing to it.
+}
+
+
+
+static void _peer_accept(DvzTransport* tr)
+{
+    ANN(tr);
+
+    int fd = accept(tr->fd, NULL, NULL);
+    if (fd < 0)
+    {
+        log_error("unable to accept a producer: %s", strerror(errno));
+        return;
+    }
+    if (tr->peer_count >= DVZ_TRANSPORT_MAX_PEERS)
+    {
+        log_error("maximum number of producers reached (%d)", DVZ_TRANSPORT_MAX_PEERS);
+        close(fd);
+        return;
+    }
+
+    // NOTE: the handshake is read once the socket is readable, see _peer_hello(), so that a
+    // producer that does not send it does not block the server.
+    DvzTransportPeer* peer = (DvzTransportPeer*)calloc(1, sizeof(DvzTransportPeer));
+    peer->fd = fd;
+    peer->ring.fd = -1;
+    dvz_mutex_init(&peer->lock);
+
+    tr->peers[tr->peer_count++] = peer;
+    log_debug("accepted producer #%d", tr->peer_count - 1);
+}
+
+
+
+// Read the handshake of a producer, sent right after connecting with its ring file descriptor.
+static void _peer_hello(DvzTransportPeer* peer)
+{
+    ANN(peer);
+
+    DvzTransportFrame frame = {0};
+    char control[CMSG_SPACE(sizeof(int))] = {0};
+    struct iovec iov = {.iov_base = &frame, .iov_len = sizeof(frame)};
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t n = recvmsg(peer->fd, &msg, MSG_DONTWAIT);
+
+    // NOTE: the descriptor is installed in this process even if the handshake is invalid.
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    int ring_fd = -1;
+    if (n > 0 && cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET &&
+        cmsg->cmsg_type == SCM_RIGHTS)
+        memcpy(&ring_fd, CMSG_DATA(cmsg), sizeof(int));
+
+    if (n != (ssize_t)sizeof(frame) || !_frame_valid(&frame) ||
+        frame.type != DVZ_TRANSPORT_FRAME_HELLO)
+    {
+        if (n != 0) // 0 if the producer disconnected before the handshake
+            log_error("invalid handshake from a producer");
+        if (ring_fd >= 0)
+            close(ring_fd);
+        _peer_close(peer);
+        return;
+    }
+    peer->ready = true;
+
+    // The ring must be at least as large as announced, the accesses beyond its end would fault.
+    struct stat st = {0};
+    if (ring_fd >= 0 &&
+        (frame.size < sizeof(DvzTransportRingHeader) || fstat(ring_fd, &st) != 0 ||
+         (uint64_t)st.st_size < frame.size || !_ring_map(&peer->ring, ring_fd, frame.size)))
+    {
+        log_error("invalid shared-memory ring from a producer, using inline payloads");
+        close(ring_fd);
+    }
+}
+
+
+
+// Read a batch frame from a producer.
+static DvzBatch* _peer_recv(DvzTransport* tr, DvzTransportPeer* peer)
+{
+    ANN(tr);
+    ANN(peer);
+
+    DvzTransportFrame frame = {0};
+    if (_recv_all(peer->fd, &frame, sizeof(frame)) != 0)
+    {
+        _peer_close(peer);
+        return NULL;
+    }
+    if (!_frame_valid(&frame) || frame.type != DVZ_TRANSPORT_FRAME_BATCH)
+    {
+        _peer_close(peer);
+        return NULL;
+    }
+
+    if (frame.size > DVZ_TRANSPORT_MAX_FRAME_SIZE)
+    {
+        log_error("transport frame too large (%s)", pretty_size(frame.size));
+        _peer_close(peer);
+        return NULL;
+    }
+    DvzSize header_size =
+        frame.count * sizeof(DvzRequest) + frame.payload_count * sizeof(DvzTransportPayload);
+    if (frame.size < header_size)
+    {
+        log_error("truncated transport frame");
+        _peer_close(peer);
+        return NULL;
+    }
+    uint8_t* body = (uint8_t*)malloc(MAX(frame.size, 1));
+    ANN(body);
+    if (_recv_all(peer->fd, body, frame.size) != 0)
+    {
+        FREE(body);
+        _peer_close(peer);
+        return NULL;
+    }
+
+    DvzRequest* requests = (DvzRequest*)body;
+    DvzTransportPayload* payloads =
+        (DvzTransportPayload*)(body + frame.count * sizeof(DvzRequest));
+    uint8_t* inline_data = body + header_size;
+    DvzSize inline_size = frame.size - header_size;
+
+    // NOTE: the producer is not trusted, the pointers without a payload must not reach the
+    // renderer.
+    for (uint32_t i = 0; i < frame.count; i++)
+        _request_clear(&requests[i]);
+
+    // Resolve the payloads. The requests whose payload is invalid are dropped.
+    DvzTransportPayload* payload = NULL;
+    DvzRequest* req = NULL;
+    void** ptr = NULL;
+    DvzSize size = 0;
+    bool* dropped = (bool*)calloc(MAX(frame.count, 1), sizeof(bool));
+    ANN(dropped);
+    // NOTE: the capacity is written by the producer, it must fit in the mapping.
+    uint64_t capacity = peer->ring.header != NULL ? peer->ring.header->capacity : 0;
+    if (capacity > peer->ring.size - sizeof(DvzTransportRingHeader))
+        capacity = 0;
+    for (uint32_t i = 0; i < frame.payload_count; i++)
+    {
+        payload = &payloads[i];
+        if (payload->request_idx >= frame.count)
+            continue;
+        req = &requests[payload->request_idx];
+        ptr = _payload_field(req, payload->field, &size);
+        if (ptr == NULL || *ptr != NULL) // no pointer field, or already resolved
+            continue;
+
+        if (payload->location == DVZ_TRANSPORT_PAYLOAD_SHM && capacity > 0 &&
+            payload->offset % capacity + payload->size <= capacity)
+        {
+            uint8_t* src = &peer->ring.data[payload->offset % capacity];
+            DvzTransportRelease* release =
+                (DvzTransportRelease*)calloc(1, sizeof(DvzTransportRelease));
+            release->peer = peer;
+            release->region = _region_push(peer, payload->offset + payload->size);
+
+            if (payload->size != size)
+            {
+                // The region is released right away so that the ring does not stall.
+                log_error("invalid payload size for request #%d", payload->request_idx);
+                _ring_release(release);
+                *ptr = NULL;
+                dropped[payload->request_idx] = true;
+                continue;
+            }
+            if (req->action == DVZ_REQUEST_ACTION_UPLOAD && req->type == DVZ_REQUEST_OBJECT_DAT)
+            {
+                // Zero-copy: the renderer uploads from the ring and then releases the region.
+                *ptr = src;
+                req->flags |= DVZ_UPLOAD_FLAGS_NOCOPY;
+                req->content.dat_upload.release = _ring_release;
+                req->content.dat_upload.user_data = release;
+            }
+            else
+            {
+                // The other payloads are owned and freed by the renderer.
+                *ptr = malloc(payload->size);
+                memcpy(*ptr, src, payload->size);
+                _ring_release(release);
+            }
+            tr->stats.shm_bytes += payload->size;
+        }
+        else if (
+            payload->location == DVZ_TRANSPORT_PAYLOAD_INLINE && payload->size == size &&
+            payload->offset + payload->size <= inline_size)
+        {
+            *ptr = malloc(MAX(payload->size, 1));
+            memcpy(*ptr, &inline_data[payload->offset], payload->size);
+            tr->stats.inline_bytes += payload->size;
+        }
+        else if (
+            payload->location == DVZ_TRANSPORT_PAYLOAD_COMPRESSED &&
+            payload->offset + payload->size <= inline_size &&
+            dvz_codec_size(&inline_data[payload->offset], payload->size) == size)
+        {
+            // Decompressed directly into the buffer passed to the renderer.
+            *ptr = malloc(MAX(size, 1));
+            if (dvz_codec_decompress(&inline_data[payload->offset], payload->size, *ptr, size))
+            {
+                log_error("unable to decompress the payload of request #%d", payload->request_idx);
+                FREE(*ptr);
+                dropped[payload->request_idx] = true;
+                continue;
+            }
+            tr->stats.inline_bytes += payload->size;
+            tr->stats.compressed_bytes += size;
+        }
+        else
+        {
+            log_error("invalid payload for request #%d", payload->request_idx);
+            *ptr = NULL;
+            dropped[payload->request_idx] = true;
+        }
+    }
+
+    DvzBatch* batch = dvz_batch();
+    for (uint32_t i = 0; i < frame.count; i++)
+        if (!dropped[i])
+            dvz_batch_add(batch, requests[i]);
+    FREE(dropped);
+    FREE(body);
+
+    tr->stats.frames++;
+    tr->stats.requests += frame.count;
+    return batch;
+}
+
+
+
+/*************************************************************************************************/
+/*  Functions                                                                                    */
+/*************************************************************************************************/
+
+DvzTransport* dvz_transport_listen(const char* path)
+{
+    ANN(path);
+
+    struct sockaddr_un addr = {0};
+    if (!_address(path, &addr))
+        return NULL;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        log_error("unable to create a socket: %s", strerror(errno));
+        return NULL;
+    }
+
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(fd, DVZ_TRANSPORT_MAX_PEERS) != 0)
+    {
+        log_error("unable to listen on `%s`: %s", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    DvzTransport* tr = (DvzTransport*)calloc(1, sizeof(DvzTransport));
+    tr->is_server = true;
+    tr->fd = fd;
+    strncpy(tr->path, path, sizeof(tr->path) - 1);
+    log_debug("render server listening on `%s`", path);
+    return tr;
+}
+
+
+
+DvzTransport* dvz_transport_connect(const char* path)
+{
+    ANN(path);
+
+    struct sockaddr_un addr = {0};
+    if (!_address(path, &addr))
+        return NULL;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        log_error("unable to create a socket: %s", strerror(errno));
+        return NULL;
+    }
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        log_error("unable to connect to `%s`: %s", path, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    DvzTransport* tr = (DvzTransport*)calloc(1, sizeof(DvzTransport));
+    tr->fd = fd;
+    strncpy(tr->path, path, sizeof(tr->path) - 1);
+
+    // Create the shared-memory ring, the transport falls back to inline payloads without it.
+    DvzSize size = sizeof(DvzTransportRingHeader) + DVZ_TRANSPORT_RING_SIZE;
+    int ring_fd = _shm_fd(size);
+    tr->ring = (DvzTransportRing*)calloc(1, sizeof(DvzTransportRing));
+    tr->ring->fd = -1;
+    if (ring_fd >= 0 && _ring_map(tr->ring, ring_fd, size))
+    {
+        tr->ring->header->capacity = DVZ_TRANSPORT_RING_SIZE;
+        atomic_store(&tr->ring->header->tail, 0);
+    }
+    else
+    {
+        if (ring_fd >= 0)
+            close(ring_fd);
+        FREE(tr->ring);
+    }
+
+    // Handshake: pass the ring file descriptor to the server.
+    DvzTransportFrame frame = _frame(DVZ_TRANSPORT_FRAME_HELLO);
+    frame.size = tr->ring != NULL ? tr->ring->size : 0;
+    char control[CMSG_SPACE(sizeof(int))] = {0};
+    struct iovec iov = {.iov_base = &frame, .iov_len = sizeof(frame)};
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (tr->ring != NULL)
+    {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &tr->ring->fd, sizeof(int));
+    }
+    if (sendmsg(fd, &msg, 0) != (ssize_t)sizeof(frame))
+    {
+        log_error("handshake with the render server failed: %s", strerror(errno));
+        dvz_transport_destroy(tr);
+        return NULL;
+    }
+
+    log_debug("connected to the render server `%s`", path);
+    return tr;
+}
+
+
+
+int dvz_transport_send(DvzTransport* tr, DvzBatch* batch)
+{
+    ANN(tr);
+    ANN(batch);
+    ASSERT(!tr->is_server);
+    if (tr->fd < 0)
+        return 1;
+
+    uint32_t count = batch->count;
+
+    // First pass: count the payloads and place the large ones in the ring.
+    uint32_t payload_count = 0;
+    DvzSize size = 0;
+    void** ptr = NULL;
+    for (uint32_t i = 0; i < count; i++)
+        for (uint32_t field = 0; field < 2; field++)
+            if ((ptr = _payload_field(&batch->requests[i], field, &size)) && *ptr)
+                payload_count++;
+
+    DvzTransportPayload* payloads =
+        (DvzTransportPayload*)calloc(MAX(payload_count, 1), sizeof(DvzTransportPayload));
+    DvzTransportPayload* payload = NULL;
+    DvzSize inline_size = 0;
+    uint32_t k = 0;
+    uint64_t pos = 0;
+    DvzRequest* req = NULL;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        req = &batch->requests[i];
+        for (uint32_t field = 0; field < 2; field++)
+        {
+            ptr = _payload_field(req, field, &size);
+            if (ptr == NULL || *ptr == NULL)
+                continue;
+
+            payload = &payloads[k++];
+            payload->request_idx = i;
+            payload->field = (uint16_t)field;
+            payload->size = size;
+            if (tr->ring != NULL && size >= DVZ_TRANSPORT_SHM_THRESHOLD &&
+                _ring_alloc(tr->ring, size, &pos))
+            {
+                payload->location = DVZ_TRANSPORT_PAYLOAD_SHM;
+                payload->offset = pos;
+                _payload_copy(req, *ptr, size, &tr->ring->data[pos % DVZ_TRANSPORT_RING_SIZE]);
+                tr->stats.shm_bytes += size;
+            }
+            else
+            {
+                payload->location = DVZ_TRANSPORT_PAYLOAD_INLINE;
+            }
+        }
+    }
+    ASSERT(k == payload_count);
+
+    // Compress the large inline payloads on worker threads.
+    DvzCodecJob* jobs = (DvzCodecJob*)calloc(MAX(payload_count, 1), sizeof(DvzCodecJob));
+    int32_t* job_idx = (int32_t*)calloc(MAX(payload_count, 1), sizeof(int32_t));
+    void** copies = (void**)calloc(MAX(payload_count, 1), sizeof(void*)); // gathered sources
+    uint32_t job_count = 0;
+    for (uint32_t i = 0; i < payload_count; i++)
+    {
+        payload = &payloads[i];
+        job_idx[i] = -1;
+        if (payload->location != DVZ_TRANSPORT_PAYLOAD_INLINE || tr->compression == 0 ||
+            payload->size < tr->compression)
+            continue;
+
+        req = &batch->requests[payload->request_idx];
+        ptr = _payload_field(req, payload->field, &size);
+        ANN(ptr);
+        void* src = *ptr;
+        if (_payload_strided(req))
+        {
+            src = copies[job_count] = malloc(size);
+            ANN(src);
+            _payload_copy(req, *ptr, size, src);
+        }
+
+        job_idx[i] = (int32_t)job_count;
+        jobs[job_count].src = src;
+        jobs[job_count].size = size;
+        jobs[job_count].item_size = DVZ_CODEC_ITEM_SIZE;
+        if (req->action == DVZ_REQUEST_ACTION_UPLOAD && req->type == DVZ_REQUEST_OBJECT_DAT &&
+            req->content.dat_upload.item_size > 0)
+            jobs[job_count].item_size = req->content.dat_upload.item_size;
+        jobs[job_count].filter = DVZ_CODEC_FILTER_SHUFFLE | DVZ_CODEC_FILTER_DELTA;
+        job_count++;
+    }
+    dvz_codec_jobs(job_count, jobs, 0);
+
+    DvzCodecJob* job = NULL;
+    for (uint32_t i = 0; i < payload_count; i++)
+    {
+        payload = &payloads[i];
+        if (payload->location == DVZ_TRANSPORT_PAYLOAD_SHM)
+            continue;
+        job = job_idx[i] >= 0 ? &jobs[job_idx[i]] : NULL;
+        if (job != NULL && job->dst != NULL)
+        {
+            payload->location = DVZ_TRANSPORT_PAYLOAD_COMPRESSED;
+            payload->size = job->dst_size;
+            tr->stats.compressed_bytes += job->size;
+        }
+        payload->offset = inline_size;
+        inline_size += payload->size;
+    }
+
+    // Second pass: serialize the frame body.
+    DvzSize header_size =
+        count * sizeof(DvzRequest) + payload_count * sizeof(DvzTransportPayload);
+    DvzSize body_size = header_size + inline_size;
+    uint8_t* body = (uint8_t*)malloc(MAX(body_size, 1));
+    ANN(body);
+    memcpy(body, batch->requests, count * sizeof(DvzRequest));
+    memcpy(
+        body + count * sizeof(DvzRequest), payloads, payload_count * sizeof(DvzTransportPayload));
+
+    DvzRequest* sent = (DvzRequest*)body;
+    for (uint32_t i = 0; i < payload_count; i++)
+    {
+        payload = &payloads[i];
+        req = &batch->requests[payload->request_idx];
+        ptr = _payload_field(req, payload->field, &size);
+        ANN(ptr);
+        if (payload->location == DVZ_TRANSPORT_PAYLOAD_INLINE)
+            _payload_copy(req, *ptr, size, body + header_size + payload->offset);
+        else if (payload->location == DVZ_TRANSPORT_PAYLOAD_COMPRESSED)
+            memcpy(body + header_size + payload->offset, jobs[job_idx[i]].dst, payload->size);
+    }
+    for (uint32_t i = 0; i < job_count; i++)
+    {
+        FREE(copies[i]);
+        FREE(jobs[i].dst);
+    }
+    FREE(jobs);
+    FREE(job_idx);
+    FREE(copies);
+
+    // The pointers are meaningless in the server process.
+    for (uint32_t i = 0; i < count; i++)
+        _request_clear(&sent[i]);
+
+    int res = 0;
+    if (body_size > DVZ_TRANSPORT_MAX_FRAME_SIZE)
+    {
+        log_error("batch too large to be sent to the render server (%s)", pretty_size(body_size));
+        res = 1;
+    }
+    else
+    {
+        DvzTransportFrame frame = _frame(DVZ_TRANSPORT_FRAME_BATCH);
+        frame.count = count;
+        frame.payload_count = payload_count;
+        frame.size = body_size;
+        res = _send_all(tr->fd, &frame, sizeof(frame));
+        if (res == 0)
+            res = _send_all(tr->fd, body, body_size);
+        if (res != 0)
+            log_error("lost connection to the render server");
+    }
+
+    // The payloads have been copied, consume them.
+    for (uint32_t i = 0; i < payload_count; i++)
+    {
+        req = &batch->requests[payloads[i].request_idx];
+        ptr = _payload_field(req, payloads[i].field, &size);
+        ANN(ptr);
+        _payload_consume(req, ptr);
+    }
+
+    tr->stats.frames++;
+    tr->stats.requests += count;
+    tr->stats.inline_bytes += inline_size;
+    FREE(body);
+    FREE(payloads);
+    return res;
+}
+
+
+
+void dvz_transport_compression(DvzTransport* tr, DvzSize threshold)
+{
+    ANN(tr);
+    ASSERT(!tr->is_server);
+    tr->compression = threshold;
+}
+
+
+
+DvzBatch* dvz_transport_recv(DvzTransport* tr, int timeout)
+{
+    ANN(tr);
+    ASSERT(tr->is_server);
+
+    struct pollfd fds[1 + DVZ_TRANSPORT_MAX_PEERS] = {0};
+    uint32_t n = 0;
+    DvzTransportPeer* peer = NULL;
+
+    while (true)
+    {
+        // Listening socket, then the connected producers.
+        fds[0].fd = tr->fd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        n = 1;
+        for (uint32_t i = 0; i < tr->peer_count; i++)
+        {
+            fds[n].fd = tr->peers[i]->fd; // negative descriptors are ignored by poll()
+            fds[n].events = POLLIN;
+            fds[n].revents = 0;
+            n++;
+        }
+
+        int res = poll(fds, n, timeout);
+        if (res < 0 && errno == EINTR)
+            continue;
+        if (res <= 0)
+            return NULL;
+
+        for (uint32_t i = 0; i < tr->peer_count; i++)
+        {
+            peer = tr->peers[i];
+            if (fds[1 + i].revents == 0 || peer->fd < 0)
+                continue;
+            if (!peer->ready)
+            {
+                _peer_hello(peer);
+                continue;
+            }
+            DvzBatch* batch = _peer_recv(tr, peer);
+            if (batch != NULL)
+                return batch;
+        }
+
+        if (fds[0].revents & POLLIN)
+            _peer_accept(tr);
+    }
+    return NULL;
+}
+
+
+
+DvzTransportStats dvz_transport_stats(DvzTransport* tr)
+{
+    ANN(tr);
+    return tr->stats;
+}
+
+
+
+void dvz_transport_destroy(DvzTransport* tr)
+{
+    ANN(tr);
+
+    for (uint32_t i = 0; i < tr->peer_count; i++)
+    {
+        _peer_close(tr->peers[i]);
+        _ring_unmap(&tr->peers[i]->ring);
+        dvz_mutex_destroy(&tr->peers[i]->lock);
+        FREE(tr->peers[i]->regions);
+        FREE(tr->peers[i]);
+    }
+    if (tr->ring != NULL)
+    {
+        _ring_unmap(tr->ring);
+        FREE(tr->ring);
+    }
+    if (tr->fd >= 0)
+        close(tr->fd);
+    if (tr->is_server)
+        unlink(tr->path);
+    FREE(tr);
+}
+
+
+
+#else
+
+/*************************************************************************************************/
+/*  Windows                                                                                      */
+/*************************************************************************************************/
+
+// NOTE: the transport relies on Unix domain sockets and file descriptor passing.
+
+DvzTransport* dvz_transport_listen(const char* path)
+{
+    log_error("the transport is not supported on Windows");
+    return NULL;
+}
+
+DvzTransport* dvz_transport_connect(const char* path)
+{
+    log_error("the transport is not supported on Windows");
+    return NULL;
+}
+
+int dvz_transport_send(DvzTransport* tr, DvzBatch* batch) { return 1; }
+
+void dvz_transport_compression(DvzTransport* tr, DvzSize threshold) {}
+
+DvzBatch* dvz_transport_recv(DvzTransport* tr, int timeout) { return NULL; }
+
+DvzTransportStats dvz_transport_stats(DvzTransport* tr) { return tr->stats; }
+
+void dvz_transport_destroy(DvzTransport* tr) { FREE(tr); }
+
+#endif
@@ -3007,6 +3007,97 @@ void dvz_semaphores_destroy(DvzSemaphores* semaphores)
 
 
 
+/*************************************************************************************************/
+/*  Timeline semaphores                                                                          */
+/*************************************************************************************************/
+
+DvzTimeline dvz_timeline(DvzGpu* gpu)
+{
+    ANN(gpu);
+    ASSERT(dvz_obj_is_created(&gpu->obj));
+    ASSERT(gpu->support_timeline);
+
+    log_trace("create timeline semaphore");
+
+    DvzTimeline timeline = {0};
+    timeline.gpu = gpu;
+
+    VkSemaphoreTypeCreateInfo type_info = {0};
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_info.initialValue = 0;
+
+    VkSemaphoreCreateInfo info = {0};
+    info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    info.pNext = &type_info;
+    VK_CHECK_RESULT(vkCreateSemaphore(gpu->device, &info, NULL, &timeline.semaphore));
+
+    dvz_obj_created(&timeline.obj);
+
+    return timeline;
+}
+
+
+
+uint64_t dvz_timeline_next(DvzTimeline* timeline)
+{
+    ANN(timeline);
+    // NOTE: the value is only recorded as scheduled by dvz_submit_send(), once the submission
+    // that signals it has been made.
+    return timeline->value + 1;
+}
+
+
+
+uint64_t dvz_timeline_value(DvzTimeline* timeline)
+{
+    ANN(timeline);
+    ANN(timeline->gpu);
+    ASSERT(timeline->semaphore != VK_NULL_HANDLE);
+
+    uint64_t value = 0;
+    VK_CHECK_RESULT(
+        vkGetSemaphoreCounterValue(timeline->gpu->device, timeline->semaphore, &value));
+    return value;
+}
+
+
+
+void dvz_timeline_wait(DvzTimeline* timeline, uint64_t value)
+{
+    ANN(timeline);
+    ANN(timeline->gpu);
+    ASSERT(timeline->semaphore != VK_NULL_HANDLE);
+
+    log_trace("wait for timeline value %" PRIu64, value);
+
+    VkSemaphoreWaitInfo info = {0};
+    info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    info.semaphoreCount = 1;
+    info.pSemaphores = &timeline->semaphore;
+    info.pValues = &value;
+    VK_CHECK_RESULT(vkWaitSemaphores(timeline->gpu->device, &info, UINT64_MAX));
+}
+
+
+
+void dvz_timeline_destroy(DvzTimeline* timeline)
+{
+    ANN(timeline);
+    if (!dvz_obj_is_created(&timeline->obj))
+    {
+        log_trace("skip destruction of already-destroyed timeline semaphore");
+        return;
+    }
+
+    log_trace("destroy timeline semaphore");
+    vkDestroySemaphore(timeline->gpu->device, timeline->semaphore, NULL);
+    timeline->semaphore = VK_NULL_HANDLE;
+    dvz_obj_destroyed(&timeline->obj);
+}
+
+
+
 /*************************************************************************************************/
 /*  Fences                                                                                       */
 /*************************************************************************************************/
@@ -3125,6 +3216,69 @@ void dvz_fences_destroy(DvzFences* fences)
 
 
 
+/*************************************************************************************************/
+/*  Queries                                                                                      */
+/*************************************************************************************************/
+
+DvzQueries dvz_queries(DvzGpu* gpu, VkQueryType type, uint32_t count)
+{
+    ANN(gpu);
+    ASSERT(dvz_obj_is_created(&gpu->obj));
+    ASSERT(count > 0);
+
+    DvzQueries queries = {0};
+    queries.gpu = gpu;
+    queries.count = count;
+    log_trace("create query pool with %d queries", count);
+
+    VkQueryPoolCreateInfo info = {0};
+    info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    info.queryType = type;
+    info.queryCount = count;
+    VK_CHECK_RESULT(vkCreateQueryPool(gpu->device, &info, NULL, &queries.pool));
+
+    dvz_obj_created(&queries.obj);
+    return queries;
+}
+
+
+
+bool dvz_queries_get(DvzQueries* queries, uint32_t first, uint32_t count, uint64_t* values)
+{
+    ANN(queries);
+    ANN(values);
+    ASSERT(dvz_obj_is_created(&queries->obj));
+    ASSERT(count > 0);
+    ASSERT(first + count <= queries->count);
+
+    // NOTE: no VK_QUERY_RESULT_WAIT_BIT, VK_NOT_READY is returned if a result is not available.
+    VkResult res = vkGetQueryPoolResults(
+        queries->gpu->device, queries->pool, first, count, count * sizeof(uint64_t), values,
+        sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    return res == VK_SUCCESS;
+}
+
+
+
+void dvz_queries_destroy(DvzQueries* queries)
+{
+    ANN(queries);
+    if (!dvz_obj_is_created(&queries->obj))
+    {
+        log_trace("skip destruction of already-destroyed queries");
+        return;
+    }
+    log_trace("destroy query pool");
+    if (queries->pool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(queries->gpu->device, queries->pool, NULL);
+        queries->pool = VK_NULL_HANDLE;
+    }
+    dvz_obj_destroyed(&queries->obj);
+}
+
+
+
 /*************************************************************************************************/
 /*  Renderpass                                                                                   */
 /*************************************************************************************************/
@@ -3542,6 +3696,43 @@ void dvz_submit_signal_semaphores(DvzSubmit* submit, DvzSemaphores* semaphores,
 
 
 
+void dvz_submit_wait_timeline(
+    DvzSubmit* submit, VkPipelineStageFlags stage, DvzTimeline* timeline, uint64_t value)
+{
+    ANN(submit);
+    ANN(timeline);
+    ASSERT(timeline->semaphore != VK_NULL_HANDLE);
+
+    // NOTE: timeline and binary semaphores share the same VkSubmitInfo arrays.
+    uint32_t n = submit->wait_timelines_count;
+    ASSERT(n + submit->wait_semaphores_count < DVZ_MAX_SEMAPHORES_PER_SUBMIT);
+
+    submit->wait_timelines[n] = timeline;
+    submit->wait_timelines_values[n] = value;
+    submit->wait_timelines_stages[n] = stage;
+
+    submit->wait_timelines_count++;
+}
+
+
+
+void dvz_submit_signal_timeline(DvzSubmit* submit, DvzTimeline* timeline, uint64_t value)
+{
+    ANN(submit);
+    ANN(timeline);
+    ASSERT(timeline->semaphore != VK_NULL_HANDLE);
+
+    uint32_t n = submit->signal_timelines_count;
+    ASSERT(n + submit->signal_semaphores_count < DVZ_MAX_SEMAPHORES_PER_SUBMIT);
+
+    submit->signal_timelines[n] = timeline;
+    submit->signal_timelines_values[n] = value;
+
+    submit->signal_timelines_count++;
+}
+
+
+
 void dvz_submit_send(DvzSubmit* submit, uint32_t cmd_idx, DvzFences* fences, uint32_t fence_idx)
 {
     ANN(submit);
@@ -3551,21 +3742,51 @@ void dvz_submit_send(DvzSubmit* submit, uint32_t cmd_idx, DvzFences* fences, uin
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
     VkSemaphore wait_semaphores[DVZ_MAX_SEMAPHORES_PER_SUBMIT] = {0};
+    VkPipelineStageFlags wait_stages[DVZ_MAX_SEMAPHORES_PER_SUBMIT] = {0};
+    uint64_t wait_values[DVZ_MAX_SEMAPHORES_PER_SUBMIT] = {0};
+    uint32_t wait_count = submit->wait_semaphores_count;
     for (uint32_t i = 0; i < submit->wait_semaphores_count; i++)
     {
         wait_semaphores[i] =
             submit->wait_semaphores[i]->semaphores[submit->wait_semaphores_idx[i]];
+        wait_stages[i] = submit->wait_stages[i];
         // log_trace("wait for semaphore %d", wait_semaphores[i]);
         ASSERT(submit->wait_stages[i] != 0);
     }
+    // Timeline semaphores come after the binary semaphores, whose values are ignored.
+    for (uint32_t i = 0; i < submit->wait_timelines_count; i++)
+    {
+        wait_semaphores[wait_count] = submit->wait_timelines[i]->semaphore;
+        wait_stages[wait_count] = submit->wait_timelines_stages[i];
+        wait_values[wait_count] = submit->wait_timelines_values[i];
+        ASSERT(wait_stages[wait_count] != 0);
+        wait_count++;
+    }
 
     VkSemaphore signal_semaphores[DVZ_MAX_SEMAPHORES_PER_SUBMIT] = {0};
+    uint64_t signal_values[DVZ_MAX_SEMAPHORES_PER_SUBMIT] = {0};
+    uint32_t signal_count = submit->signal_semaphores_count;
     for (uint32_t i = 0; i < submit->signal_semaphores_count; i++)
     {
         signal_semaphores[i] =
             submit->signal_semaphores[i]->semaphores[submit->signal_semaphores_idx[i]];
         // log_trace("signal semaphore %d", signal_semaphores[i]);
     }
+    for (uint32_t i = 0; i < submit->signal_timelines_count; i++)
+    {
+        signal_semaphores[signal_count] = submit->signal_timelines[i]->semaphore;
+        signal_values[signal_count] = submit->signal_timelines_values[i];
+        signal_count++;
+    }
+
+    VkTimelineSemaphoreSubmitInfo timeline_info = {0};
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.waitSemaphoreValueCount = wait_count;
+    timeline_info.pWaitSemaphoreValues = wait_values;
+    timeline_info.signalSemaphoreValueCount = signal_count;
+    timeline_info.pSignalSemaphoreValues = signal_values;
+    if (submit->wait_timelines_count > 0 || submit->signal_timelines_count > 0)
+        submit_info.pNext = &timeline_info;
 
     VkCommandBuffer cmd_bufs[DVZ_MAX_COMMANDS_PER_SUBMIT] = {0};
 
@@ -3584,12 +3805,12 @@ void dvz_submit_send(DvzSubmit* submit, uint32_t cmd_idx, DvzFences* fences, uin
     submit_info.commandBufferCount = submit->commands_count;
     submit_info.pCommandBuffers = cmd_bufs;
 
-    submit_info.waitSemaphoreCount = submit->wait_semaphores_count;
-    submit_info.pWaitSemaphores = submit->wait_semaphores_count > 0 ? wait_semaphores : NULL;
-    submit_info.pWaitDstStageMask = submit->wait_stages;
+    submit_info.waitSemaphoreCount = wait_count;
+    submit_info.pWaitSemaphores = wait_count > 0 ? wait_semaphores : NULL;
+    submit_info.pWaitDstStageMask = wait_stages;
 
-    submit_info.signalSemaphoreCount = submit->signal_semaphores_count;
-    submit_info.pSignalSemaphores = submit->signal_semaphores_count > 0 ? signal_semaphores : NULL;
+    submit_info.signalSemaphoreCount = signal_count;
+    submit_info.pSignalSemaphores = signal_count > 0 ? signal_semaphores : NULL;
 
     VkFence vfence = fences == NULL ? 0 : fences->fences[fence_idx];
 
@@ -3603,6 +3824,11 @@ void dvz_submit_send(DvzSubmit* submit, uint32_t cmd_idx, DvzFences* fences, uin
     //     cmd_idx, vfence);
     VK_CHECK_RESULT(vkQueueSubmit(submit->gpu->queues.queues[queue_idx], 1, &submit_info, vfence));
 
+    // The signaled timeline values are now scheduled: they can be waited upon.
+    for (uint32_t i = 0; i < submit->signal_timelines_count; i++)
+        submit->signal_timelines[i]->value =
+            MAX(submit->signal_timelines[i]->value, submit->signal_timelines_values[i]);
+
     // log_trace("submit done");
 }
 
@@ -3615,6 +3841,8 @@ void dvz_submit_reset(DvzSubmit* submit)
     submit->commands_count = 0;
     submit->wait_semaphores_count = 0;
     submit->signal_semaphores_count = 0;
+    submit->wait_timelines_count = 0;
+    submit->signal_timelines_count = 0;
 }
 
 
@@ -4071,3 +4299,28 @@ void dvz_cmd_push(
     vkCmdPushConstants(cb, slots->pipeline_layout, shaders, offset, size, data);
     CMD_END
 }
+
+
+
+void dvz_cmd_reset_queries(
+    DvzCommands* cmds, uint32_t idx, DvzQueries* queries, uint32_t first, uint32_t count)
+{
+    ANN(queries);
+    ASSERT(first + count <= queries->count);
+    CMD_START
+    vkCmdResetQueryPool(cb, queries->pool, first, count);
+    CMD_END
+}
+
+
+
+void dvz_cmd_timestamp(
+    DvzCommands* cmds, uint32_t idx, DvzQueries* queries, uint32_t query,
+    VkPipelineStageFlagBits stage)
+{
+    ANN(queries);
+    ASSERT(query < queries->count);
+    CMD_START
+    vkCmdWriteTimestamp(cb, stage, queries->pool, query);
+    CMD_END
+}
@@ -324,6 +324,22 @@ static void create_device(DvzGpu* gpu, VkSurfaceKHR surface)
         log_trace("- %s", extensions[i]);
     }
 
+    // Timeline semaphores (core in Vulkan 1.2) are used to express the dependencies between the
+    // transfer and render queues. They are optional: binary semaphores are used otherwise.
+    VkPhysicalDeviceTimelineSemaphoreFeatures timeline_features = {0};
+    timeline_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    if (gpu->device_properties.apiVersion >= VK_API_VERSION_1_2)
+    {
+        VkPhysicalDeviceFeatures2 features2 = {0};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &timeline_features;
+        vkGetPhysicalDeviceFeatures2(gpu->physical_device, &features2);
+    }
+    gpu->support_timeline = timeline_features.timelineSemaphore == VK_TRUE;
+    if (gpu->support_timeline)
+        device_info.pNext = &timeline_features;
+    log_trace("timeline semaphores %ssupported", gpu->support_timeline ? "" : "NOT ");
+
     // Create the device
     VK_CHECK_RESULT(vkCreateDevice(gpu->physical_device, &device_info, NULL, &gpu->device));
     FREE(queue_families_info);
@@ -0,0 +1,87 @@
+/*************************************************************************************************/
+/*  Testing arena                                                                                */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "scene/test_arena.h"
+#include "_map.h"
+#include "request.h"
+#include "scene/arena.h"
+#include "scene/array.h"
+#include "scene/dual.h"
+#include "scene/mvp.h"
+#include "test.h"
+#include "testing.h"
+
+
+
+/*************************************************************************************************/
+/*  Arena tests                                                                                  */
+/*************************************************************************************************/
+
+int test_arena_1(TstSuite* suite)
+{
+    DvzBatch* batch = dvz_batch();
+    DvzArena* arena = dvz_arena(batch);
+    dvz_arena_batch(arena, batch);
+
+    // The uniform duals are suballocated in the arena pages.
+    const uint32_t n = 100;
+    DvzDual duals[100] = {0};
+    for (uint32_t i = 0; i < n; i++)
+    {
+        duals[i] = dvz_dual_dat(batch, sizeof(DvzMVP), DVZ_DAT_FLAGS_MAPPABLE);
+        AT(duals[i].arena == arena);
+        AT(duals[i].offset % DVZ_ARENA_ALIGNMENT == 0);
+    }
+    uint32_t per_page = DVZ_ARENA_PAGE_SIZE / DVZ_ARENA_ALIGNMENT;
+    AT(arena->page_count == (n + per_page - 1) / per_page);
+    AT(duals[0].dat == duals[per_page - 1].dat);
+    AT(duals[0].dat != duals[per_page].dat);
+
+    // One dat creation request per page.
+    AT(dvz_batch_size(batch) == arena->page_count);
+    dvz_batch_clear(batch);
+
+    // The updates are written in place and do not emit any request.
+    DvzMVP mvp = dvz_mvp_default();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        mvp.time = i;
+        dvz_dual_data(&duals[i], 0, 1, &mvp);
+        dvz_dual_update(&duals[i]);
+    }
+    AT(dvz_batch_size(batch) == 0);
+    AT(((DvzMVP*)dvz_array_item(duals[42].array, 0))->time == 42);
+
+    // A single upload per modified page.
+    AT(dvz_arena_flush(arena) == arena->page_count);
+    AT(dvz_batch_size(batch) == arena->page_count);
+    AT(dvz_arena_flush(arena) == 0);
+    dvz_batch_clear(batch);
+
+    // Freed suballocations are reused.
+    DvzSize offset = duals[10].offset;
+    DvzId dat = duals[10].dat;
+    dvz_dual_destroy(&duals[10]);
+    dvz_dual_destroy(&duals[11]);
+    duals[10] = dvz_dual_dat(batch, 2 * DVZ_ARENA_ALIGNMENT, DVZ_DAT_FLAGS_MAPPABLE);
+    AT(duals[10].dat == dat);
+    AT(duals[10].offset == offset);
+    duals[11] = dvz_dual_dat(batch, sizeof(DvzMVP), DVZ_DAT_FLAGS_MAPPABLE);
+    AT(arena->allocations == n);
+
+    // The arena is freed with its last suballocation.
+    dvz_arena_batch(NULL, batch);
+    dvz_arena_destroy(arena);
+    for (uint32_t i = 0; i < n; i++)
+        dvz_dual_destroy(&duals[i]);
+
+    dvz_batch_destroy(batch);
+    return 0;
+}
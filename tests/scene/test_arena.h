@@ -0,0 +1,26 @@
+/*************************************************************************************************/
+/*  Tests                                                                                        */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_TEST_ARENA
+#define DVZ_HEADER_TEST_ARENA
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "testing.h"
+
+
+
+/*************************************************************************************************/
+/*  Arena tests                                                                                  */
+/*************************************************************************************************/
+
+int test_arena_1(TstSuite*);
+
+
+
+#endif
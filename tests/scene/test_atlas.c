@@ -9,7 +9,11 @@
 /*************************************************************************************************/
 
 #include "test_atlas.h"
+#include "renderer.h"
+#include "request.h"
 #include "scene/atlas.h"
+#include "scene/scene_testing_utils.h"
+#include "scene/sdf.h"
 #include "test.h"
 #include "testing.h"
 #include "testing_utils.h"
@@ -100,3 +104,191 @@ int test_atlas_1(TstSuite* suite)
     dvz_atlas_destroy(atlas);
     return 0;
 }
+
+
+
+int test_atlas_insert(TstSuite* suite)
+{
+    ANN(suite);
+    unsigned long ttf_size = 0;
+    unsigned char* ttf_bytes = dvz_resource_font("Roboto_Medium", &ttf_size);
+    ASSERT(ttf_size > 0);
+    ANN(ttf_bytes);
+
+    DvzAtlas* atlas = dvz_atlas(ttf_size, ttf_bytes);
+    dvz_atlas_threads(atlas, 2);
+
+    // Start from an empty atlas.
+    AT(!dvz_atlas_valid(atlas));
+    AT(dvz_atlas_insert(atlas, 3, (uint32_t[]){'A', 'B', 'A'}) == 2);
+    AT(dvz_atlas_valid(atlas));
+
+    vec4 a = {0}, b = {0}, c = {0};
+    AT(dvz_atlas_glyph(atlas, 'A', a) == 0);
+    AT(dvz_atlas_glyph(atlas, 'B', b) == 0);
+    AT(dvz_atlas_glyph(atlas, 'C', c) != 0);
+    AT(a[2] > 0 && a[3] > 0);
+
+    // The glyphs must not overlap.
+    AT(a[0] + a[2] <= b[0] || b[0] + b[2] <= a[0] || a[1] + a[3] <= b[1] || b[1] + b[3] <= a[1]);
+
+    // Codepoints already in the atlas, or absent from the font, are ignored.
+    AT(dvz_atlas_insert(atlas, 1, (uint32_t[]){'A'}) == 0);
+    AT(dvz_atlas_insert(atlas, 1, (uint32_t[]){0x10FFFE}) == 0);
+
+    // Insert enough glyphs to grow the atlas: the existing glyphs stay in place.
+    uvec3 shape = {0};
+    dvz_atlas_shape(atlas, shape);
+    uint32_t h = shape[1];
+
+    uint32_t codepoints[222] = {0};
+    for (uint32_t i = 0; i < 95; i++)
+        codepoints[i] = 32 + i; // ASCII
+    AT(dvz_atlas_insert(atlas, 95, codepoints) == 93);
+    for (uint32_t i = 0; i < 222; i++)
+        codepoints[i] = 0xA1 + i; // Latin-1 Supplement and Latin Extended-A
+    AT(dvz_atlas_insert(atlas, 222, codepoints) > 0);
+
+    dvz_atlas_shape(atlas, shape);
+    AT(shape[1] > h);
+    vec4 a2 = {0};
+    AT(dvz_atlas_glyph(atlas, 'A', a2) == 0);
+    AC(a2[0], a[0], EPS);
+    AC(a2[1], a[1], EPS);
+    AT(dvz_atlas_glyph(atlas, 'z', c) == 0);
+
+    char imgpath[1024];
+    snprintf(imgpath, sizeof(imgpath), "%s/atlas_insert.png", ARTIFACTS_DIR);
+    dvz_atlas_png(atlas, imgpath);
+
+    dvz_atlas_destroy(atlas);
+    return 0;
+}
+
+
+
+int test_atlas_bundle(TstSuite* suite)
+{
+    ANN(suite);
+    unsigned long ttf_size = 0;
+    unsigned char* ttf_bytes = dvz_resource_font("Roboto_Medium", &ttf_size);
+    ASSERT(ttf_size > 0);
+    ANN(ttf_bytes);
+
+    DvzAtlas* atlas = dvz_atlas(ttf_size, ttf_bytes);
+    dvz_atlas_string(atlas, "ABCabc");
+    dvz_atlas_generate(atlas);
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/atlas%s", ARTIFACTS_DIR, DVZ_ATLAS_BUNDLE_EXTENSION);
+    AT(dvz_atlas_bundle_export(atlas, path) == 0);
+
+    // Map the bundle: the glyphs and the bitmap must match the original atlas.
+    DvzAtlas* bundle = dvz_atlas_bundle_file(ttf_size, ttf_bytes, path);
+    ANN(bundle);
+    AT(dvz_atlas_valid(bundle));
+    AT(dvz_atlas_size(bundle) == dvz_atlas_size(atlas));
+    AT(memcmp(dvz_atlas_rgb(bundle), dvz_atlas_rgb(atlas), dvz_atlas_size(atlas)) == 0);
+
+    vec4 a = {0}, b = {0};
+    AT(dvz_atlas_glyph(atlas, 'b', a) == 0);
+    AT(dvz_atlas_glyph(bundle, 'b', b) == 0);
+    for (uint32_t i = 0; i < 4; i++)
+        AC(a[i], b[i], EPS);
+    AT(dvz_atlas_glyph(bundle, 'd', b) != 0);
+
+    // Glyphs missing from the bundle can still be inserted.
+    AT(dvz_atlas_insert(bundle, 1, (uint32_t[]){'d'}) == 1);
+    AT(dvz_atlas_glyph(bundle, 'd', b) == 0);
+    AT(dvz_atlas_glyph(bundle, 'b', b) == 0);
+    AC(a[0], b[0], EPS);
+    AC(a[1], b[1], EPS);
+
+    // Invalid bundle.
+    uint8_t invalid[64] = {0};
+    AT(dvz_atlas_bundle(ttf_size, ttf_bytes, sizeof(invalid), invalid) == NULL);
+
+    dvz_atlas_destroy(bundle);
+    dvz_atlas_destroy(atlas);
+    return 0;
+}
+
+
+
+int test_atlas_upload(TstSuite* suite)
+{
+    ANN(suite);
+    DvzGpu* gpu = get_gpu(suite);
+    ANN(gpu);
+
+    unsigned long ttf_size = 0;
+    unsigned char* ttf_bytes = dvz_resource_font("Roboto_Medium", &ttf_size);
+    ASSERT(ttf_size > 0);
+    ANN(ttf_bytes);
+
+    DvzAtlas* atlas = dvz_atlas(ttf_size, ttf_bytes);
+    AT(dvz_atlas_insert(atlas, 2, (uint32_t[]){'A', 'B'}) == 2);
+
+    // Full upload of the initial atlas.
+    DvzBatch* batch = dvz_batch();
+    DvzId tex_id = dvz_atlas_texture(atlas, batch);
+    AT(tex_id != DVZ_ID_NONE);
+
+    // Insert a glyph without growing the atlas: only the dirty rectangle is uploaded.
+    uvec3 shape = {0};
+    dvz_atlas_shape(atlas, shape);
+    AT(dvz_atlas_insert(atlas, 1, (uint32_t[]){'C'}) == 1);
+    uvec3 shape1 = {0};
+    dvz_atlas_shape(atlas, shape1);
+    AT(shape1[0] == shape[0] && shape1[1] == shape[1]);
+
+    DvzBatch* batch1 = dvz_batch();
+    AT(dvz_atlas_upload(atlas, batch1) == 0);
+    AT(dvz_batch_size(batch1) == 1);
+    DvzRequest* req = &dvz_batch_requests(batch1)[0];
+    AT(req->action == DVZ_REQUEST_ACTION_UPLOAD);
+    AT(req->type == DVZ_REQUEST_OBJECT_TEX);
+
+    uint32_t* offset = req->content.tex_upload.offset;
+    uint32_t* region = req->content.tex_upload.shape;
+    AT(region[0] > 0 && region[1] > 0 && region[2] == 1);
+    AT(region[0] * region[1] < shape[0] * shape[1]);
+    AT(offset[0] + region[0] <= shape[0] && offset[1] + region[1] <= shape[1]);
+    AT(req->content.tex_upload.size == region[0] * region[1] * 4);
+
+    // The region covers the new glyph, whose y coordinate starts from the top.
+    vec4 c = {0};
+    AT(dvz_atlas_glyph(atlas, 'C', c) == 0);
+    uint32_t cy = (uint32_t)c[1];
+    AT(offset[0] <= (uint32_t)c[0] && (uint32_t)(c[0] + c[2]) <= offset[0] + region[0]);
+    AT(offset[1] <= cy && cy + (uint32_t)c[3] <= offset[1] + region[1]);
+
+    // Process both batches with the Vulkan renderer.
+    DvzRenderer* rd = dvz_renderer(gpu, 0);
+    DvzBatch* batches[] = {batch, batch1};
+    for (uint32_t b = 0; b < 2; b++)
+    {
+        uint32_t count = dvz_batch_size(batches[b]);
+        DvzRequest* reqs = dvz_batch_requests(batches[b]);
+        for (uint32_t i = 0; i < count; i++)
+            dvz_renderer_request(rd, reqs[i]);
+    }
+
+    // The texture must match the whole atlas bitmap, including the new glyph.
+    uint32_t n = shape[0] * shape[1];
+    DvzSize size = n * 4;
+    uint8_t* rgba = (uint8_t*)calloc(size, 1);
+    DvzTex* tex = dvz_renderer_tex(rd, tex_id);
+    ANN(tex);
+    dvz_tex_download(tex, DVZ_ZERO_OFFSET, shape, size, rgba, true);
+    uint8_t* expected = dvz_rgb_to_rgba_char(n, dvz_atlas_rgb(atlas));
+    AT(memcmp(rgba, expected, size) == 0);
+
+    FREE(expected);
+    FREE(rgba);
+    dvz_renderer_destroy(rd);
+    dvz_batch_destroy(batch1);
+    dvz_batch_destroy(batch);
+    dvz_atlas_destroy(atlas);
+    return 0;
+}
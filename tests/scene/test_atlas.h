@@ -21,6 +21,12 @@
 
 int test_atlas_1(TstSuite*);
 
+int test_atlas_insert(TstSuite*);
+
+int test_atlas_bundle(TstSuite*);
+
+int test_atlas_upload(TstSuite*);
+
 
 
 #endif
@@ -9,11 +9,15 @@
 /*************************************************************************************************/
 
 #include "test_axes.h"
+#include "_list.h"
 #include "scene/axes.h"
+#include "scene/axis.h"
+#include "scene/baker.h"
 #include "scene/panzoom.h"
 #include "scene/ticks.h"
 #include "scene/transform.h"
 #include "scene/viewport.h"
+#include "scene/visual.h"
 #include "scene/visuals/glyph.h"
 #include "scene/visuals/marker.h"
 #include "scene/visuals/visual_test.h"
@@ -86,3 +90,98 @@ int test_axes_1(TstSuite* suite)
     dvz_axes_destroy(axes);
     return 0;
 }
+
+
+
+int test_axes_linked(TstSuite* suite)
+{
+    ANN(suite);
+
+    VisualTest vt = visual_test_start("axes_linked", VISUAL_TEST_PANZOOM, 0);
+
+    // Second panel, sharing the x axis of the first panel.
+    DvzPanel* panel = dvz_panel(vt.figure, 0, HEIGHT / 2, WIDTH, HEIGHT / 2);
+    DvzPanzoom* pz = dvz_panel_panzoom(vt.scene, panel);
+    ANN(pz);
+
+    DvzAxes* axes = dvz_axes(vt.panel, 0);
+    DvzAxes* linked = dvz_axes_linked(panel, axes, NULL, 0);
+    AT(dvz_list_count(axes->followers) == 1);
+    AT(linked->xticks == NULL);
+    AT(linked->yticks != NULL);
+
+    // The shared axis draws the vertex and index buffers of the source axis.
+    DvzVisual* src = axes->xaxis->glyph;
+    DvzVisual* dst = linked->xaxis->glyph;
+    AT(dst->baker->vertex_bindings[0].shared);
+    AT(dst->baker->vertex_bindings[0].dual.dat == src->baker->vertex_bindings[0].dual.dat);
+    AT(dst->baker->index.dat == src->baker->index.dat);
+    AT(dst->item_count == src->item_count);
+    AT(dst->texs[3] == src->texs[3]);
+
+    // Pan the linked panel: the ticks are computed by the source axes, whose panel follows the
+    // linked panel along x only.
+    uint64_t updates = dvz_axis_stats(axes->xaxis).updates;
+    dvz_panzoom_pan(pz, (vec2){.5, .25});
+    dvz_panel_update(panel);
+    dvz_axes_update(linked);
+    AT(dvz_axis_stats(axes->xaxis).updates == updates + 1);
+    AT(dvz_axis_stats(linked->xaxis).updates == 0);
+    AT(dst->item_count == src->item_count);
+
+    vec2 r0 = {0}, r1 = {0};
+    dvz_panzoom_xrange(vt.panel->panzoom, r0);
+    dvz_panzoom_xrange(pz, r1);
+    AC(r0[0], r1[0], EPS);
+    AC(r0[1], r1[1], EPS);
+
+    glm_vec2_zero(r0);
+    glm_vec2_zero(r1);
+    dvz_panzoom_yrange(vt.panel->panzoom, r0);
+    dvz_panzoom_yrange(pz, r1);
+    AT(fabs(r0[0] - r1[0]) > EPS);
+
+    // Pan the source panel: the linked panel follows.
+    dvz_panzoom_pan(vt.panel->panzoom, (vec2){-1, 0});
+    dvz_panel_update(vt.panel);
+    dvz_axes_update(axes);
+
+    glm_vec2_zero(r0);
+    glm_vec2_zero(r1);
+    dvz_panzoom_xrange(vt.panel->panzoom, r0);
+    dvz_panzoom_xrange(pz, r1);
+    AC(r0[0], r1[0], EPS);
+    AC(r0[1], r1[1], EPS);
+
+    // The panel that was panned is followed, whichever axes are updated first.
+    dvz_panzoom_pan(vt.panel->panzoom, (vec2){2, 0});
+    dvz_panel_update(vt.panel);
+    glm_vec2_zero(r0);
+    dvz_panzoom_xrange(vt.panel->panzoom, r0);
+    dvz_axes_update(linked);
+    dvz_axes_update(axes);
+
+    glm_vec2_zero(r1);
+    dvz_panzoom_xrange(pz, r1);
+    AC(r0[0], r1[0], EPS);
+    AC(r0[1], r1[1], EPS);
+    glm_vec2_zero(r1);
+    dvz_panzoom_xrange(vt.panel->panzoom, r1);
+    AC(r0[0], r1[0], EPS);
+
+    // Linked axes cannot be the source of other axes, which prevents cycles.
+    AT(dvz_axes_linked(vt.panel, linked, NULL, 0) == NULL);
+    AT(dvz_list_count(linked->followers) == 0);
+
+    dvz_app_destroy(vt.app);
+
+    dvz_panel_destroy(panel);
+    dvz_panel_destroy(vt.panel);
+    dvz_figure_destroy(vt.figure);
+    dvz_scene_destroy(vt.scene);
+
+    // NOTE: the linked axes must be destroyed first.
+    dvz_axes_destroy(linked);
+    dvz_axes_destroy(axes);
+    return 0;
+}
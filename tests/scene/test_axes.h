@@ -21,6 +21,8 @@
 
 int test_axes_1(TstSuite*);
 
+int test_axes_linked(TstSuite*);
+
 
 
 #endif
@@ -9,6 +9,7 @@
 /*************************************************************************************************/
 
 #include "test_axis.h"
+#include "request.h"
 #include "scene/axis.h"
 #include "scene/panzoom.h"
 #include "scene/viewport.h"
@@ -379,6 +380,71 @@ int test_axis_2(TstSuite* suite)
 
 
 
+int test_axis_pan(TstSuite* suite)
+{
+    ANN(suite);
+
+    DvzBatch* batch = dvz_batch();
+    DvzAxis* axis = dvz_axis(batch, 0);
+    _common_axis_params(axis);
+
+    vec3 p0 = {-1, -1, 0};
+    vec3 p1 = {+1, -1, 0};
+    vec3 vector = {0, 1, 0};
+
+    // Continuous panning over a range of width 10, with a tick at each integer.
+    uint32_t n_steps = 1000;
+    double width = 10;
+    double values[16] = {0};
+    uint32_t index[16] = {0};
+    uint32_t length[16] = {0};
+    char glyphs[16 * 8] = {0};
+
+    for (uint32_t step = 0; step < n_steps; step++)
+    {
+        double dmin = -100 + .05 * step;
+        double dmax = dmin + width;
+
+        uint32_t tick_count = 0;
+        uint32_t glyph_count = 0;
+        for (int32_t k = (int32_t)ceil(dmin); k <= (int32_t)floor(dmax); k++)
+        {
+            values[tick_count] = k;
+            index[tick_count] = glyph_count;
+            length[tick_count] = (uint32_t)snprintf(&glyphs[glyph_count], 8, "%d", k);
+            glyph_count += length[tick_count] + 1;
+            tick_count++;
+        }
+
+        DvzTickSpec spec = dvz_tick_spec(
+            p0, p1, vector, dmin, dmax, tick_count, values, glyph_count, glyphs, index, length);
+        dvz_axis_ticks(axis, &spec);
+
+        AT(axis->tick_count == tick_count);
+        dvz_batch_clear(batch);
+    }
+
+    // The visuals are allocated once, and the labels are only written when they appear.
+    DvzAxisStats stats = dvz_axis_stats(axis);
+    AT(stats.updates == n_steps);
+    AT(stats.reallocs == 1);
+    AT(stats.labels_created <= 2 * (width + 1) + 50);
+    AT(stats.labels_reused > 10 * stats.labels_created);
+
+    // A style change lays out all labels again, without reallocation.
+    dvz_axis_size(axis, 24);
+    DvzTickSpec spec = axis->tick_spec;
+    dvz_axis_ticks(axis, &spec);
+    AT(dvz_axis_stats(axis).reallocs == 1);
+    AT(dvz_axis_stats(axis).labels_created == stats.labels_created + axis->tick_count);
+
+    dvz_axis_destroy(axis);
+    dvz_batch_destroy(batch);
+    return 0;
+}
+
+
+
 static void _on_timer(DvzClient* client, DvzClientEvent ev)
 {
     ANN(client);
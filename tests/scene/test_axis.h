@@ -27,6 +27,8 @@ int test_axis_get(TstSuite* suite);
 
 int test_axis_update(TstSuite* suite);
 
+int test_axis_pan(TstSuite* suite);
+
 
 
 #endif
@@ -0,0 +1,207 @@
+/*************************************************************************************************/
+/*  Testing bricks                                                                               */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "test_bricks.h"
+#include "fileio.h"
+#include "request.h"
+#include "scene/bricks.h"
+#include "scene/camera.h"
+#include "test.h"
+#include "testing.h"
+#include "testing_utils.h"
+
+
+
+/*************************************************************************************************/
+/*  Bricks test utils                                                                            */
+/*************************************************************************************************/
+
+#define VOL_W 100
+#define VOL_H 80
+#define VOL_D 60
+
+// The region x < 40 is empty, so that the finest bricks with x < 30 (and their border) are empty.
+static uint8_t* _volume(void)
+{
+    uint8_t* data = (uint8_t*)calloc(VOL_W * VOL_H * VOL_D, sizeof(uint8_t));
+    for (uint32_t z = 0; z < VOL_D; z++)
+        for (uint32_t y = 0; y < VOL_H; y++)
+            for (uint32_t x = 40; x < VOL_W; x++)
+                data[(z * VOL_H + y) * VOL_W + x] = (uint8_t)(1 + (x + y + z) % 255);
+    return data;
+}
+
+
+
+/*************************************************************************************************/
+/*  Bricks tests                                                                                 */
+/*************************************************************************************************/
+
+int test_bricks_1(TstSuite* suite)
+{
+    ANN(suite);
+
+    DvzBatch* batch = dvz_batch();
+    uint8_t* data = _volume();
+
+    DvzBricks* bricks =
+        dvz_bricks(batch, DVZ_FORMAT_R8_UNORM, (uvec3){VOL_W, VOL_H, VOL_D}, (uvec3){4, 4, 4});
+    dvz_bricks_data(bricks, data);
+
+    // Pyramid: 4x3x2 bricks, then 2x2x1, then a single brick.
+    AT(bricks->level_count == 3);
+    AT(bricks->grid[0][0] == 4 && bricks->grid[0][1] == 3 && bricks->grid[0][2] == 2);
+    AT(bricks->grid[1][0] == 2 && bricks->grid[1][1] == 2 && bricks->grid[1][2] == 1);
+    AT(bricks->grid[2][0] == 1 && bricks->grid[2][1] == 1 && bricks->grid[2][2] == 1);
+    AT(bricks->brick_count == 24 + 4 + 1);
+    uint32_t top = bricks->level_offset[2];
+
+    DvzCamera* camera = dvz_camera(WIDTH, HEIGHT, 0);
+    mat4 model = GLM_MAT4_IDENTITY_INIT;
+    vec3 box = {1, 1, 1};
+
+    // Far away: only the coarsest brick is needed.
+    dvz_camera_position(camera, (vec3){0, 0, 100});
+    AT(dvz_bricks_update(bricks, camera, model, box) == 1);
+    AT(bricks->brick_slot[top] >= 0);
+    AT(dvz_bricks_stats(bricks).requested == 1);
+    AT(dvz_bricks_stats(bricks).table_uploads == 1);
+
+    // Cache hit.
+    AT(dvz_bricks_update(bricks, camera, model, box) == 0);
+    AT(dvz_bricks_stats(bricks).hits == 1);
+    AT(dvz_bricks_stats(bricks).table_uploads == 1);
+
+    // Close: all levels are needed, streamed over several updates.
+    dvz_camera_position(camera, (vec3){0, 0, 1.5});
+    uint32_t uploads = 0;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uploads = dvz_bricks_update(bricks, camera, model, box);
+        AT(uploads <= bricks->upload_limit);
+    }
+    DvzBricksStats stats = dvz_bricks_stats(bricks);
+    AT(stats.requested == bricks->brick_count);
+    AT(stats.missing == 0);
+    AT(stats.skipped == 6);
+    AT(stats.resident == bricks->brick_count - 6);
+    AT(stats.evictions == 0);
+
+    // The coarsest brick is still resident.
+    AT(bricks->brick_slot[top] >= 0);
+
+    // Every finest cell points to a resident finest brick, or is marked as empty.
+    for (uint32_t i = 0; i < 24; i++)
+    {
+        AT(bricks->table[4 * i + 3] == 1 || bricks->table[4 * i + 3] == 255);
+        AT((bricks->table[4 * i + 3] == 255) == (i % 4 == 0));
+    }
+
+    dvz_camera_destroy(camera);
+    dvz_bricks_destroy(bricks);
+    FREE(data);
+    dvz_batch_destroy(batch);
+    return 0;
+}
+
+
+
+int test_bricks_lru(TstSuite* suite)
+{
+    ANN(suite);
+
+    DvzBatch* batch = dvz_batch();
+    uint8_t* data = _volume();
+
+    // 13 slots, with a strong LOD bias so that the finest level is requested near the camera.
+    DvzBricks* bricks =
+        dvz_bricks(batch, DVZ_FORMAT_R8_UNORM, (uvec3){VOL_W, VOL_H, VOL_D}, (uvec3){13, 1, 1});
+    dvz_bricks_data(bricks, data);
+    bricks->lod_bias = 100;
+
+    DvzCamera* camera = dvz_camera(WIDTH, HEIGHT, 0);
+    mat4 model = GLM_MAT4_IDENTITY_INIT;
+    vec3 box = {1, 1, 1};
+
+    // Fill the atlas from two viewpoints.
+    dvz_camera_position(camera, (vec3){0.4, 0.6, 0.55});
+    AT(dvz_bricks_update(bricks, camera, model, box) == 9);
+    dvz_camera_position(camera, (vec3){-0.4, -0.4, 0.55});
+    AT(dvz_bricks_update(bricks, camera, model, box) == 4);
+    AT(dvz_bricks_stats(bricks).evictions == 0);
+    AT(dvz_bricks_stats(bricks).hits == 5);
+
+    // Bricks resident since the first update and requested again by the next one.
+    uint32_t kept[] = {10, 11, 22, 23};
+    int32_t slots[4] = {0};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        slots[i] = bricks->brick_slot[kept[i]];
+        AT(slots[i] >= 0);
+    }
+
+    // Only the 2 missing bricks are streamed, evicting bricks that are not requested anymore:
+    // the requested resident bricks keep their slots, and empty bricks are not counted as hits.
+    dvz_camera_position(camera, (vec3){0.1, 0.6, 0.52});
+    AT(dvz_bricks_update(bricks, camera, model, box) == 2);
+    DvzBricksStats stats = dvz_bricks_stats(bricks);
+    AT(stats.evictions == 2);
+    AT(stats.hits == 5 + 9);
+    for (uint32_t i = 0; i < 4; i++)
+        AT(bricks->brick_slot[kept[i]] == slots[i]);
+
+    dvz_camera_destroy(camera);
+    dvz_bricks_destroy(bricks);
+    FREE(data);
+    dvz_batch_destroy(batch);
+    return 0;
+}
+
+
+
+int test_bricks_file(TstSuite* suite)
+{
+    ANN(suite);
+
+    // Write a raw volume file, with a header.
+    const DvzSize header = 16;
+    DvzSize size = VOL_W * VOL_H * VOL_D;
+    uint8_t* data = _volume();
+    char path[1024] = {0};
+    snprintf(path, sizeof(path), "%s/volume.raw", ARTIFACTS_DIR);
+    uint8_t zeros[16] = {0};
+    dvz_write_bytes(path, "wb", header, zeros);
+    dvz_write_bytes(path, "ab", size, data);
+
+    DvzBatch* batch = dvz_batch();
+    DvzBricks* bricks =
+        dvz_bricks(batch, DVZ_FORMAT_R8_UNORM, (uvec3){VOL_W, VOL_H, VOL_D}, (uvec3){2, 2, 2});
+
+    // The file is too small with a wrong offset.
+    AT(dvz_bricks_file(bricks, path, header + 1) != 0);
+    AT(dvz_bricks_file(bricks, path, header) == 0);
+    AT(bricks->data_size == size);
+    AT(memcmp(bricks->data, data, size) == 0);
+
+    // With 8 slots, the finest level cannot be requested: only the 5 bricks of the coarsest two
+    // levels are streamed.
+    DvzCamera* camera = dvz_camera(WIDTH, HEIGHT, 0);
+    mat4 model = GLM_MAT4_IDENTITY_INIT;
+    dvz_camera_position(camera, (vec3){0, 0, 1.5});
+    AT(dvz_bricks_update(bricks, camera, model, (vec3){1, 1, 1}) == 5);
+    AT(dvz_bricks_stats(bricks).requested == 5);
+    AT(dvz_bricks_stats(bricks).resident == 5);
+
+    dvz_camera_destroy(camera);
+    dvz_bricks_destroy(bricks);
+    FREE(data);
+    dvz_batch_destroy(batch);
+    return 0;
+}
@@ -0,0 +1,30 @@
+/*************************************************************************************************/
+/*  Tests                                                                                        */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_TEST_BRICKS
+#define DVZ_HEADER_TEST_BRICKS
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "testing.h"
+
+
+
+/*************************************************************************************************/
+/*  Bricks tests                                                                                 */
+/*************************************************************************************************/
+
+int test_bricks_1(TstSuite*);
+
+int test_bricks_lru(TstSuite*);
+
+int test_bricks_file(TstSuite*);
+
+
+
+#endif
@@ -67,3 +67,68 @@ int test_font_1(TstSuite* suite)
     dvz_font_destroy(font);
     return 0;
 }
+
+
+
+int test_font_layout(TstSuite* suite)
+{
+    ANN(suite);
+
+    unsigned long ttf_size = 0;
+    unsigned char* ttf_bytes = dvz_resource_font("Roboto_Medium", &ttf_size);
+    ASSERT(ttf_size > 0);
+    ANN(ttf_bytes);
+
+    DvzFont* font = dvz_font(ttf_size, ttf_bytes);
+    dvz_font_size(font, 32);
+
+    // The second layout of the same string comes from the cache.
+    vec4* xywh = dvz_font_ascii(font, "Hello");
+    vec4* xywh2 = dvz_font_ascii(font, "Hello");
+    AT(memcmp(xywh, xywh2, 5 * sizeof(vec4)) == 0);
+    AC(xywh[0][0], 0, EPS);
+    AT(xywh[1][0] > xywh[0][0]);
+
+    DvzFontStats stats = dvz_font_stats(font);
+    AT(stats.layout_misses == 1);
+    AT(stats.layout_hits == 1);
+    AT(stats.glyph_loads == 4); // H, e, l, o
+    AT(stats.cached_glyphs == 4);
+
+    // Batch layout: each string is laid out independently.
+    uint32_t codepoints[] = {'e', 'l', 'l', 'H', 'e', 'l', 'l', 'o'};
+    uint32_t lengths[] = {3, 5};
+    vec4* batch = dvz_font_layouts(font, 2, lengths, codepoints);
+    AC(batch[0][0], 0, EPS);
+    AC(batch[3][0], 0, EPS);
+    AT(memcmp(&batch[3], xywh, 5 * sizeof(vec4)) == 0);
+
+    stats = dvz_font_stats(font);
+    AT(stats.layout_misses == 2);
+    AT(stats.layout_hits == 2);
+    AT(stats.glyph_loads == 4);
+
+    // Changing the size invalidates the layouts.
+    dvz_font_size(font, 64);
+    vec4* large = dvz_font_ascii(font, "Hello");
+    AT(large[4][0] > 1.5 * xywh[4][0]);
+    AT(dvz_font_stats(font).layout_misses == 3);
+
+    // Render the layout, computed without rendering the glyphs.
+    uvec2 out_size = {0};
+    uint8_t* bitmap = dvz_font_draw(font, 5, &codepoints[3], large, out_size);
+    AT(out_size[0] > 0);
+    AT(out_size[1] > 0);
+
+    char imgpath[1024];
+    snprintf(imgpath, sizeof(imgpath), "%s/font_layout.png", ARTIFACTS_DIR);
+    dvz_write_png(imgpath, out_size[0], out_size[1], bitmap);
+
+    FREE(bitmap);
+    FREE(large);
+    FREE(batch);
+    FREE(xywh);
+    FREE(xywh2);
+    dvz_font_destroy(font);
+    return 0;
+}
@@ -21,6 +21,8 @@
 
 int test_font_1(TstSuite*);
 
+int test_font_layout(TstSuite*);
+
 
 
 #endif
@@ -94,6 +94,26 @@ int test_panzoom_1(TstSuite* suite)
         AP(-1, -1);
     }
 
+    // Visible range.
+    RESET;
+    {
+        vec2 xrange = {0};
+        dvz_panzoom_xrange(pz, xrange);
+        AC(xrange[0], -1, EPS);
+        AC(xrange[1], +1, EPS);
+
+        dvz_panzoom_xrange(pz, (vec2){0, 1});
+        dvz_panzoom_yrange(pz, (vec2){-1, -.5});
+        AC(pz->zoom[0], 2, EPS);
+        AC(pz->zoom[1], 4, EPS);
+        AP(-.5, .75);
+
+        vec2 yrange = {0};
+        dvz_panzoom_yrange(pz, yrange);
+        AC(yrange[0], -1, EPS);
+        AC(yrange[1], -.5, EPS);
+    }
+
     dvz_panzoom_destroy(pz);
     return 0;
 }
@@ -252,3 +252,58 @@ int test_scene_3(TstSuite* suite)
     dvz_app_destroy(app);
     return 0;
 }
+
+
+
+int test_scene_flush(TstSuite* suite)
+{
+    ANN(suite);
+
+    DvzBatch* batch = dvz_batch();
+    DvzScene* scene = dvz_scene(batch);
+    DvzFigure* figure = dvz_figure(scene, WIDTH, HEIGHT, 0);
+    DvzPanel* panel = dvz_panel_default(figure);
+    DvzArcball* arcball = dvz_panel_arcball(scene, panel);
+    ANN(arcball);
+
+    // Mesh with params.
+    DvzShape cube = dvz_shape_cube((cvec4[]){
+        {255, 0, 0, 255},
+        {0, 255, 0, 255},
+        {0, 0, 255, 255},
+        {0, 255, 255, 255},
+        {255, 0, 255, 255},
+        {255, 255, 0, 255},
+    });
+    DvzVisual* mesh = dvz_mesh_shape(batch, &cube, DVZ_MESH_FLAGS_LIGHTING);
+    dvz_visual_update(mesh);
+    dvz_panel_visual(panel, mesh);
+
+    // Nothing to flush.
+    AT(dvz_scene_flush(scene) == 0);
+
+    // Several transform changes within a frame.
+    DvzTransform* tr = panel->transform;
+    ANN(tr);
+    AT(!dvz_transform_dirty(tr));
+    for (uint32_t i = 0; i < 9; i++)
+        AT(dvz_transform_dirty(tr));
+
+    // Several params changes within a frame.
+    dvz_mesh_light_pos(mesh, (vec4){-1, +1, +5, 0});
+    dvz_mesh_light_pos(mesh, (vec4){-1, +1, +10, 0});
+
+    // A single upload per transform and per params.
+    uint32_t count = dvz_batch_size(batch);
+    AT(dvz_scene_flush(scene) == 2);
+    AT(dvz_batch_size(batch) == count + 2);
+    AT(dvz_scene_flush(scene) == 0);
+
+    dvz_visual_destroy(mesh);
+    dvz_shape_destroy(&cube);
+    dvz_panel_destroy(panel);
+    dvz_figure_destroy(figure);
+    dvz_scene_destroy(scene);
+    dvz_batch_destroy(batch);
+    return 0;
+}
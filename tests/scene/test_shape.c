@@ -9,6 +9,7 @@
 /*************************************************************************************************/
 
 #include "test_shape.h"
+#include "fileio.h"
 #include "scene/meshobj.h"
 #include "scene/shape.h"
 #include "test.h"
@@ -50,3 +51,67 @@ int test_shape_obj(TstSuite* suite)
     dvz_shape_destroy(&shape);
     return 0;
 }
+
+
+
+int test_shape_mesh(TstSuite* suite)
+{
+    ANN(suite);
+
+    // A quad with a vertex color, and a triangle using relative indices.
+    const char* obj = "# test\n"
+                      "v 0 0 0 1 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+                      "vn 0 0 1\n"
+                      "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+                      "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+                      "f -4/-4/-1 -2/-2/-1 -1/-1/-1\n";
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/shape_mesh.obj", ARTIFACTS_DIR);
+    dvz_write_bytes(path, "w", strlen(obj), (const uint8_t*)obj);
+
+    // The corners with the same indices share the same vertex.
+    DvzShape shape = dvz_shape_obj(path);
+    AT(shape.vertex_count == 4);
+    AT(shape.index_count == 9);
+    DvzIndex expected[] = {0, 1, 2, 0, 2, 3, 0, 2, 3};
+    AT(memcmp(shape.index, expected, sizeof(expected)) == 0);
+    AT(shape.color[0][0] == 255 && shape.color[0][1] == 0);
+    AC(shape.normal[2][2], 1, EPS);
+    AC(shape.texcoords[2][0], 1, EPS);
+    AC(shape.pos[0][0], -1, EPS);
+
+    // Binary mesh round trip.
+    snprintf(path, sizeof(path), "%s/shape_mesh%s", ARTIFACTS_DIR, DVZ_MESH_EXTENSION);
+    AT(dvz_shape_export(&shape, path) == 0);
+    DvzShape mesh = dvz_shape_mesh(path);
+    AT(mesh.mapped != NULL);
+    AT(mesh.vertex_count == shape.vertex_count);
+    AT(mesh.index_count == shape.index_count);
+    AT(memcmp(mesh.pos, shape.pos, shape.vertex_count * sizeof(vec3)) == 0);
+    AT(memcmp(mesh.color, shape.color, shape.vertex_count * sizeof(cvec4)) == 0);
+    AT(memcmp(mesh.index, shape.index, shape.index_count * sizeof(DvzIndex)) == 0);
+
+    // The read-only mapping is copied before the shape is modified.
+    dvz_shape_normalize(&mesh);
+    AT(mesh.mapped == NULL);
+    for (uint32_t i = 0; i < shape.vertex_count; i++)
+        for (uint32_t k = 0; k < 3; k++)
+            AC(mesh.pos[i][k], shape.pos[i][k], EPS);
+    AT(memcmp(mesh.index, shape.index, shape.index_count * sizeof(DvzIndex)) == 0);
+    dvz_shape_destroy(&mesh);
+    AT(mesh.pos == NULL);
+
+    // Welding: the vertices only differ by their color and texture coordinates.
+    for (uint32_t i = 0; i < shape.vertex_count; i++)
+    {
+        memset(shape.color[i], 255, sizeof(cvec4));
+        glm_vec4_zero(shape.texcoords[i]);
+    }
+    AT(dvz_shape_weld(&shape, 0) == 4);
+    _vec3_copy(shape.pos[0], shape.pos[3]);
+    AT(dvz_shape_weld(&shape, 0) == 3);
+    AT(shape.index[5] == 0);
+
+    dvz_shape_destroy(&shape);
+    return 0;
+}
@@ -23,6 +23,8 @@ int test_shape_1(TstSuite*);
 
 int test_shape_obj(TstSuite*);
 
+int test_shape_mesh(TstSuite*);
+
 
 
 #endif
@@ -41,3 +41,49 @@ int test_ticks_1(TstSuite* suite)
     dvz_ticks_destroy(ticks);
     return 0;
 }
+
+
+
+int test_ticks_cache(TstSuite* suite)
+{
+    ANN(suite);
+    DvzTicks* ticks = dvz_ticks(0);
+    dvz_ticks_size(ticks, 800, 12);
+
+    // NOTE: the timings are measured by `datoviz bench --micro ticks`.
+    uint32_t n = 1000;
+    srand(0);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        double center = (dvz_rand_double() - .5) * pow(10, (int)(dvz_rand_double() * 12) - 4);
+        double width = pow(10, dvz_rand_double() * 10 - 4);
+        dvz_ticks_compute(ticks, center - width / 2, center + width / 2, 8);
+    }
+    DvzTicksStats stats = dvz_ticks_stats(ticks);
+    AT(stats.computes == n);
+
+    // Panning back and forth over the same ranges: warm starts, then cache hits.
+    for (uint32_t i = 0; i < n; i++)
+    {
+        double x = .05 * (i % 40 < 20 ? i % 20 : 20 - i % 20);
+        dvz_ticks_compute(ticks, x, x + 10, 8);
+        AT(ticks->lstep > 0);
+    }
+    DvzTicksStats pan = dvz_ticks_stats(ticks);
+    AT(pan.cache_hits - stats.cache_hits > n / 2);
+    AT(pan.warm_starts > stats.warm_starts);
+
+    // A cache hit gives the same solution as the search.
+    dvz_ticks_compute(ticks, 0.123, 0.456, 10);
+    double lmin = ticks->lmin, lmax = ticks->lmax, lstep = ticks->lstep;
+    dvz_ticks_compute(ticks, 1.23e6, 1.24e6, 10);
+    uint64_t hits = dvz_ticks_stats(ticks).cache_hits;
+    dvz_ticks_compute(ticks, 0.123, 0.456, 10);
+    AT(dvz_ticks_stats(ticks).cache_hits == hits + 1);
+    AC(ticks->lmin, lmin, 1e-12);
+    AC(ticks->lmax, lmax, 1e-12);
+    AC(ticks->lstep, lstep, 1e-12);
+
+    dvz_ticks_destroy(ticks);
+    return 0;
+}
@@ -21,6 +21,8 @@
 
 int test_ticks_1(TstSuite*);
 
+int test_ticks_cache(TstSuite*);
+
 
 
 #endif
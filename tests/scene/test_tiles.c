@@ -0,0 +1,240 @@
+/*************************************************************************************************/
+/*  Testing tiles                                                                                */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "test_tiles.h"
+#include "_time.h"
+#include "fileio.h"
+#include "renderer.h"
+#include "request.h"
+#include "scene/panzoom.h"
+#include "scene/scene_testing_utils.h"
+#include "scene/tiles.h"
+#include "test.h"
+#include "testing.h"
+#include "testing_utils.h"
+
+
+
+/*************************************************************************************************/
+/*  Tiles test utils                                                                             */
+/*************************************************************************************************/
+
+static uint8_t* _image(uint32_t width, uint32_t height)
+{
+    uint8_t* data = (uint8_t*)calloc(width * height, 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            data[4 * (y * width + x) + 0] = (uint8_t)(x % 256);
+            data[4 * (y * width + x) + 1] = (uint8_t)(y % 256);
+            data[4 * (y * width + x) + 2] = (uint8_t)((x + y) % 256);
+            data[4 * (y * width + x) + 3] = 255;
+        }
+    }
+    return data;
+}
+
+
+
+// Update the tiles until all requested tiles are resident.
+static DvzTilesStats _converge(DvzTiles* tiles, DvzPanzoom* pz)
+{
+    ANN(tiles);
+    ANN(pz);
+    DvzTilesStats stats = {0};
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        dvz_tiles_update(tiles, pz);
+        stats = dvz_tiles_stats(tiles);
+        if (stats.missing == 0 && stats.pending == 0)
+            break;
+        dvz_sleep(1);
+    }
+    return stats;
+}
+
+
+
+/*************************************************************************************************/
+/*  Tiles tests                                                                                  */
+/*************************************************************************************************/
+
+int test_tiles_1(TstSuite* suite)
+{
+    ANN(suite);
+
+    const uint32_t width = 2000;
+    const uint32_t height = 1000;
+    DvzBatch* batch = dvz_batch();
+    uint8_t* data = _image(width, height);
+
+    // Background loading with 2 threads.
+    DvzTiles* tiles = dvz_tiles(batch, DVZ_FORMAT_R8G8B8A8_UNORM, width, height, (uvec2){4, 3}, 2);
+    dvz_tiles_data(tiles, data);
+
+    // Pyramid: 8x4 tiles, then 4x2, 2x1, and a single tile.
+    AT(tiles->level_count == 4);
+    AT(tiles->grid[0][0] == 8 && tiles->grid[0][1] == 4);
+    AT(tiles->grid[1][0] == 4 && tiles->grid[1][1] == 2);
+    AT(tiles->grid[3][0] == 1 && tiles->grid[3][1] == 1);
+    AT(tiles->tile_count == 32 + 8 + 2 + 1);
+
+    // Whole image in a 800x600 viewport: 2.5 image pixels per screen pixel, level 1.
+    DvzPanzoom* pz = dvz_panzoom(WIDTH, HEIGHT, 0);
+    DvzTilesStats stats = _converge(tiles, pz);
+    AT(stats.level == 1);
+    AT(stats.requested == 1 + 8);
+    AT(stats.missing == 0);
+    AT(stats.resident == 9);
+
+    // The resident tiles are drawn, the other quads are degenerate.
+    AT(tiles->quad_pos[8][2] != tiles->quad_pos[8][0]);
+    AT(tiles->quad_pos[9][2] == tiles->quad_pos[9][0]);
+
+    // Cache hits.
+    AT(dvz_tiles_update(tiles, pz) == 0);
+    AT(dvz_tiles_stats(tiles).hits >= 9);
+
+    // Zoom on the center: finest level, 2x2 visible tiles.
+    dvz_panzoom_xrange(pz, (vec2){-.1, +.1});
+    dvz_panzoom_yrange(pz, (vec2){-.1, +.1});
+    stats = _converge(tiles, pz);
+    AT(stats.level == 0);
+    AT(stats.requested == 1 + 4);
+    AT(stats.missing == 0);
+
+    // With 12 slots, one tile of level 1 had to be evicted.
+    AT(stats.resident == 12);
+    AT(stats.evictions == 1);
+
+    dvz_panzoom_destroy(pz);
+    dvz_tiles_destroy(tiles);
+    FREE(data);
+    dvz_batch_destroy(batch);
+    return 0;
+}
+
+
+
+int test_tiles_npy(TstSuite* suite)
+{
+    ANN(suite);
+
+    const uint32_t width = 300;
+    const uint32_t height = 200;
+    uint8_t* data = _image(width, height);
+
+    // Write a .npy file (version 1.0), the header being padded to 128 bytes.
+    char header[128 - 10] = {0};
+    snprintf(
+        header, sizeof(header), "%s", "{'descr': '|u1', 'fortran_order': False, 'shape': (200, "
+                                      "300, 4), }");
+    size_t len = strlen(header);
+    memset(&header[len], ' ', sizeof(header) - len - 1);
+    header[sizeof(header) - 1] = '\n';
+    uint8_t preamble[10] = {0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0, sizeof(header), 0};
+    char path[1024] = {0};
+    snprintf(path, sizeof(path), "%s/tiles.npy", ARTIFACTS_DIR);
+    dvz_write_bytes(path, "wb", 10, preamble);
+    dvz_write_bytes(path, "ab", sizeof(header), (const uint8_t*)header);
+    dvz_write_bytes(path, "ab", width * height * 4, data);
+
+    DvzBatch* batch = dvz_batch();
+
+    // Mismatching shape.
+    DvzTiles* tiles =
+        dvz_tiles(batch, DVZ_FORMAT_R8G8B8A8_UNORM, width + 1, height, (uvec2){2, 2}, 0);
+    AT(dvz_tiles_npy(tiles, path) != 0);
+    dvz_tiles_destroy(tiles);
+
+    tiles = dvz_tiles(batch, DVZ_FORMAT_R8G8B8A8_UNORM, width, height, (uvec2){2, 2}, 0);
+    AT(dvz_tiles_npy(tiles, path) == 0);
+    AT(memcmp(tiles->data, data, width * height * 4) == 0);
+
+    // Synchronous loading: the coarsest tile and the 2 tiles of the finest level.
+    DvzPanzoom* pz = dvz_panzoom(WIDTH, HEIGHT, 0);
+    AT(dvz_tiles_update(tiles, pz) == 3);
+    AT(dvz_tiles_stats(tiles).level == 0);
+    AT(dvz_tiles_stats(tiles).missing == 0);
+
+    dvz_panzoom_destroy(pz);
+    dvz_tiles_destroy(tiles);
+    FREE(data);
+    dvz_batch_destroy(batch);
+    return 0;
+}
+
+
+
+int test_tiles_atlas(TstSuite* suite)
+{
+    ANN(suite);
+    DvzGpu* gpu = get_gpu(suite);
+    ANN(gpu);
+
+    const uint32_t width = 600;
+    const uint32_t height = 300;
+    const uint32_t T = DVZ_TILE_SIZE;
+    DvzBatch* batch = dvz_batch();
+    uint8_t* data = _image(width, height);
+
+    // Atlas of 4x2 tiles, larger than a single tile in both dimensions.
+    DvzTiles* tiles = dvz_tiles(batch, DVZ_FORMAT_R8G8B8A8_UNORM, width, height, (uvec2){4, 2}, 0);
+    dvz_tiles_data(tiles, data);
+    DvzPanzoom* pz = dvz_panzoom(WIDTH, HEIGHT, 0);
+    dvz_tiles_update(tiles, pz);
+    AT(dvz_tiles_stats(tiles).level == 0);
+    AT(dvz_tiles_stats(tiles).missing == 0);
+
+    // Upload the tiles with the Vulkan renderer, only the atlas requests are needed.
+    DvzRenderer* rd = dvz_renderer(gpu, 0);
+    uint32_t count = dvz_batch_size(batch);
+    DvzRequest* reqs = dvz_batch_requests(batch);
+    for (uint32_t i = 0; i < count; i++)
+        if (reqs[i].type == DVZ_REQUEST_OBJECT_TEX && reqs[i].id == tiles->atlas)
+            dvz_renderer_request(rd, reqs[i]);
+
+    // Download the atlas.
+    uint32_t aw = 4 * T, ah = 2 * T;
+    DvzSize size = aw * ah * 4;
+    uint8_t* atlas = (uint8_t*)calloc(size, 1);
+    DvzTex* tex = dvz_renderer_tex(rd, tiles->atlas);
+    ANN(tex);
+    dvz_tex_download(tex, DVZ_ZERO_OFFSET, (uvec3){aw, ah, 1}, size, atlas, true);
+
+    // Every resident tile of the finest level is in its own slot.
+    uint32_t checked = 0;
+    for (uint32_t ty = 0; ty < tiles->grid[0][1]; ty++)
+    {
+        for (uint32_t tx = 0; tx < tiles->grid[0][0]; tx++)
+        {
+            int32_t slot = tiles->tile_slot[ty * tiles->grid[0][0] + tx];
+            if (slot < 0)
+                continue;
+            uint32_t sx = ((uint32_t)slot % 4) * T, sy = ((uint32_t)slot / 4) * T;
+            uint32_t w = MIN(T, width - tx * T), h = MIN(T, height - ty * T);
+            for (uint32_t y = 0; y < h; y++)
+                AT(memcmp(
+                       &atlas[4 * ((sy + y) * aw + sx)],
+                       &data[4 * ((ty * T + y) * width + tx * T)], 4 * w) == 0);
+            checked++;
+        }
+    }
+    AT(checked == tiles->grid[0][0] * tiles->grid[0][1]);
+
+    FREE(atlas);
+    dvz_renderer_destroy(rd);
+    dvz_panzoom_destroy(pz);
+    dvz_tiles_destroy(tiles);
+    FREE(data);
+    dvz_batch_destroy(batch);
+    return 0;
+}
@@ -0,0 +1,30 @@
+/*************************************************************************************************/
+/*  Tests                                                                                        */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_TEST_TILES
+#define DVZ_HEADER_TEST_TILES
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "testing.h"
+
+
+
+/*************************************************************************************************/
+/*  Tiles tests                                                                                  */
+/*************************************************************************************************/
+
+int test_tiles_1(TstSuite*);
+
+int test_tiles_npy(TstSuite*);
+
+int test_tiles_atlas(TstSuite*);
+
+
+
+#endif
@@ -109,3 +109,184 @@ int test_visual_1(TstSuite* suite)
     FREE(color);
     return 0;
 }
+
+
+
+int test_visual_dump(TstSuite* suite)
+{
+    ANN(suite);
+    DvzGpu* gpu = get_gpu(suite);
+    ANN(gpu);
+    DvzBatch* batch = dvz_batch();
+
+    uint32_t n = 1000;
+
+    // A visual with shaders and a specialization constant.
+    DvzVisual* visual = dvz_visual(batch, DVZ_PRIMITIVE_TOPOLOGY_POINT_LIST, 0);
+    dvz_visual_shader(visual, "graphics_basic");
+    dvz_visual_attr(visual, 0, 0, sizeof(vec3), DVZ_FORMAT_R32G32B32_SFLOAT, 0);
+    dvz_visual_attr(visual, 1, sizeof(vec3), sizeof(cvec4), DVZ_FORMAT_R8G8B8A8_UNORM, 0);
+    dvz_visual_slot(visual, 0, DVZ_SLOT_DAT);
+    dvz_visual_slot(visual, 1, DVZ_SLOT_DAT);
+    dvz_visual_clip(visual, DVZ_VIEWPORT_CLIP_OUTER);
+    DvzMVP mvp = dvz_mvp_default();
+    dvz_visual_mvp(visual, &mvp);
+    DvzViewport viewport = dvz_viewport_default(WIDTH, HEIGHT);
+    dvz_visual_viewport(visual, &viewport);
+    dvz_visual_alloc(visual, n, n, 0);
+
+    vec3* pos = (vec3*)calloc(n, sizeof(vec3));
+    cvec4* color = (cvec4*)calloc(n, sizeof(cvec4));
+    for (uint32_t i = 0; i < n; i++)
+    {
+        pos[i][0] = .25 * dvz_rand_normal();
+        pos[i][1] = .25 * dvz_rand_normal();
+        dvz_colormap(DVZ_CMAP_HSV, i % n, color[i]);
+    }
+    dvz_visual_data(visual, 0, 0, n, pos);
+    dvz_visual_data(visual, 1, 0, n, color);
+    dvz_visual_update(visual);
+
+    DvzId board_id = dvz_create_board(batch, WIDTH, HEIGHT, DVZ_DEFAULT_CLEAR_COLOR, 0).id;
+    dvz_record_begin(batch, board_id);
+    dvz_record_viewport(batch, board_id, DVZ_DEFAULT_VIEWPORT, DVZ_DEFAULT_VIEWPORT);
+    dvz_visual_instance(visual, board_id, 0, 0, n, 0, 1);
+    dvz_record_end(batch, board_id);
+    dvz_update_board(batch, board_id);
+
+    // Dump the batch and load it back.
+    char path[1024] = {0};
+    snprintf(path, sizeof(path), "%s/visual_dump.dvz", ARTIFACTS_DIR);
+    AT(dvz_batch_dump(batch, path) == 0);
+    DvzBatch* loaded = dvz_batch();
+    dvz_batch_load(loaded, path);
+    uint32_t count = dvz_batch_size(batch);
+    AT(dvz_batch_size(loaded) == count);
+
+    // The shader code and the specialization constants are restored in new buffers.
+    DvzRequest* reqs = dvz_batch_requests(batch);
+    DvzRequest* reqs1 = dvz_batch_requests(loaded);
+    uint32_t shaders = 0, constants = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        DvzRequestContent* c = &reqs[i].content;
+        DvzRequestContent* c1 = &reqs1[i].content;
+        if (reqs[i].type == DVZ_REQUEST_OBJECT_SHADER &&
+            reqs[i].action == DVZ_REQUEST_ACTION_CREATE)
+        {
+            AT(c1->shader.size == c->shader.size);
+            AT(c1->shader.buffer != NULL && c1->shader.buffer != c->shader.buffer);
+            AT(memcmp(c1->shader.buffer, c->shader.buffer, c->shader.size) == 0);
+            shaders++;
+        }
+        else if (reqs[i].type == DVZ_REQUEST_OBJECT_SPECIALIZATION)
+        {
+            AT(c1->set_specialization.size == c->set_specialization.size);
+            AT(c1->set_specialization.value != c->set_specialization.value);
+            AT(memcmp(
+                   c1->set_specialization.value, c->set_specialization.value,
+                   c->set_specialization.size) == 0);
+            constants++;
+        }
+    }
+    AT(shaders == 2);
+    AT(constants == 1);
+
+    // Replay both batches: the images must be identical.
+    DvzSize size = WIDTH * HEIGHT * 3;
+    uint8_t* rgb = (uint8_t*)calloc(size, 1);
+    uint8_t* rgb1 = (uint8_t*)calloc(size, 1);
+    DvzBatch* batches[] = {batch, loaded};
+    uint8_t* images[] = {rgb, rgb1};
+    for (uint32_t b = 0; b < 2; b++)
+    {
+        DvzRenderer* rd = dvz_renderer(gpu, 0);
+        dvz_renderer_requests(rd, count, dvz_batch_requests(batches[b]));
+        dvz_renderer_image(rd, board_id, &size, images[b]);
+        dvz_renderer_destroy(rd);
+    }
+    AT(!dvz_is_empty(size, rgb1));
+    AT(memcmp(rgb, rgb1, size) == 0);
+
+    char imgpath[1024];
+    snprintf(imgpath, sizeof(imgpath), "%s/visual_dump.png", ARTIFACTS_DIR);
+    dvz_write_png(imgpath, WIDTH, HEIGHT, rgb1);
+
+    // Cleanup
+    FREE(rgb);
+    FREE(rgb1);
+    FREE(pos);
+    FREE(color);
+    dvz_visual_destroy(visual);
+    dvz_batch_destroy(loaded);
+    dvz_batch_destroy(batch);
+    return 0;
+}
+
+
+
+int test_visual_updates(TstSuite* suite)
+{
+    ANN(suite);
+    DvzBatch* batch = dvz_batch();
+
+    // Several small visuals, each with a position and a color attribute.
+    // NOTE: the timings are measured by `datoviz bench --micro visual_updates`.
+    const uint32_t visual_count = 8;
+    const uint32_t n = 256;
+    DvzVisual* visuals[8] = {0};
+    for (uint32_t i = 0; i < visual_count; i++)
+    {
+        visuals[i] = dvz_visual(batch, DVZ_PRIMITIVE_TOPOLOGY_POINT_LIST, 0);
+        dvz_visual_shader(visuals[i], "graphics_basic");
+        dvz_visual_attr(visuals[i], 0, 0, sizeof(vec3), DVZ_FORMAT_R32G32B32_SFLOAT, 0);
+        dvz_visual_attr(
+            visuals[i], 1, sizeof(vec3), sizeof(cvec4), DVZ_FORMAT_R8G8B8A8_UNORM, 0);
+        dvz_visual_alloc(visuals[i], n, n, 0);
+    }
+
+    vec3* pos = (vec3*)calloc(n, sizeof(vec3));
+    cvec4* color = (cvec4*)calloc(n, sizeof(cvec4));
+    for (uint32_t i = 0; i < n; i++)
+    {
+        pos[i][0] = .25 * dvz_rand_normal();
+        pos[i][1] = .25 * dvz_rand_normal();
+        color[i][0] = color[i][3] = 255;
+    }
+
+    // One update per attribute and visual.
+    uint32_t update_count = 2 * visual_count;
+    DvzVisualUpdate* updates = (DvzVisualUpdate*)calloc(update_count, sizeof(DvzVisualUpdate));
+    for (uint32_t i = 0; i < visual_count; i++)
+    {
+        updates[2 * i + 0] = (DvzVisualUpdate){visuals[i], 0, 0, n, pos};
+        updates[2 * i + 1] = (DvzVisualUpdate){visuals[i], 1, 0, n, color};
+    }
+    dvz_batch_clear(batch);
+
+    // Per-attribute calls.
+    for (uint32_t i = 0; i < update_count; i++)
+        dvz_visual_data(
+            updates[i].visual, updates[i].attr_idx, updates[i].first, updates[i].count,
+            updates[i].data);
+    for (uint32_t i = 0; i < visual_count; i++)
+        dvz_visual_update(visuals[i]);
+    uint32_t request_count = dvz_batch_size(batch);
+    AT(request_count > 0);
+    dvz_batch_clear(batch);
+
+    // Single call.
+    dvz_visual_updates(update_count, updates);
+
+    // The same requests are emitted in both cases.
+    AT(dvz_batch_size(batch) == request_count);
+
+    // Cleanup
+    for (uint32_t i = 0; i < visual_count; i++)
+        dvz_visual_destroy(visuals[i]);
+    dvz_batch_destroy(batch);
+    FREE(updates);
+    FREE(pos);
+    FREE(color);
+    return 0;
+}
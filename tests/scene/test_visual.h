@@ -21,6 +21,10 @@
 
 int test_visual_1(TstSuite*);
 
+int test_visual_dump(TstSuite*);
+
+int test_visual_updates(TstSuite*);
+
 
 
 #endif
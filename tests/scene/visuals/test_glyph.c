@@ -11,7 +11,10 @@
 #include "scene/visuals/test_glyph.h"
 #include "renderer.h"
 #include "request.h"
+#include "scene/array.h"
 #include "scene/atlas.h"
+#include "scene/baker.h"
+#include "scene/dual.h"
 #include "scene/font.h"
 #include "scene/scene_testing_utils.h"
 #include "scene/viewport.h"
@@ -47,6 +50,76 @@ static void _on_timer(DvzClient* client, DvzClientEvent ev)
     dvz_visual_update(visual);
 }
 
+int test_glyph_atlas(TstSuite* suite)
+{
+    ANN(suite);
+
+    unsigned long ttf_size = 0;
+    unsigned char* ttf_bytes = dvz_resource_font("Roboto_Medium", &ttf_size);
+    ASSERT(ttf_size > 0);
+    ANN(ttf_bytes);
+
+    DvzBatch* batch = dvz_batch();
+    DvzVisual* visual = dvz_glyph(batch, 0);
+    const uint32_t n = 95 + 222;
+    dvz_glyph_alloc(visual, n);
+
+    // Start from a small atlas, and its texture.
+    DvzAtlas* atlas = dvz_atlas(ttf_size, ttf_bytes);
+    AT(dvz_atlas_insert(atlas, 1, (uint32_t[]){'A'}) == 1);
+    dvz_glyph_atlas(visual, atlas);
+    DvzId tex = visual->texs[3];
+    AT(tex != DVZ_ID_NONE);
+
+    uint32_t codepoints[95 + 222] = {0};
+    for (uint32_t i = 0; i < n; i++)
+        codepoints[i] = i < 95 ? 32 + i : 0xA1 + (i - 95); // ASCII, Latin-1 and Latin Extended-A
+    dvz_glyph_codepoints(visual, 0, 95, codepoints, 0);
+    uvec3 shape = {0};
+    dvz_atlas_shape(atlas, shape);
+    uint32_t h = shape[1];
+
+    // The texcoords are in pixels: upper-left corner of the 'A' glyph.
+    DvzGlyphVertex* vertices = (DvzGlyphVertex*)visual->baker->vertex_bindings[0].dual.array->data;
+    uint32_t a = 4 * ('A' - 32) + 3;
+    vec2 uv = {0};
+    glm_vec2_copy(vertices[a].uv, uv);
+    vec4 coords = {0};
+    AT(dvz_atlas_glyph(atlas, 'A', coords) == 0);
+    AT(uv[0] > coords[0] && uv[0] < coords[0] + coords[2]);
+    AT(uv[1] > coords[1] && uv[1] < coords[1] + coords[3]);
+
+    // Force the atlas to grow: the texture is resized and entirely uploaded.
+    uint32_t count = dvz_batch_size(batch);
+    dvz_glyph_codepoints(visual, 95, 222, &codepoints[95], 0);
+    dvz_atlas_shape(atlas, shape);
+    AT(shape[1] > h);
+
+    DvzRequest* reqs = dvz_batch_requests(batch);
+    bool resized = false;
+    for (uint32_t i = count; i < dvz_batch_size(batch); i++)
+    {
+        if (reqs[i].action == DVZ_REQUEST_ACTION_RESIZE && reqs[i].id == tex)
+        {
+            AT(reqs[i].content.tex.shape[1] == shape[1]);
+            resized = true;
+        }
+    }
+    AT(resized);
+
+    // The texcoords of the existing glyphs do not depend on the atlas size.
+    vertices = (DvzGlyphVertex*)visual->baker->vertex_bindings[0].dual.array->data;
+    AC(vertices[a].uv[0], uv[0], EPS);
+    AC(vertices[a].uv[1], uv[1], EPS);
+
+    dvz_visual_destroy(visual);
+    dvz_atlas_destroy(atlas);
+    dvz_batch_destroy(batch);
+    return 0;
+}
+
+
+
 int test_glyph_1(TstSuite* suite)
 {
     VisualTest vt = visual_test_start("glyph", VISUAL_TEST_PANZOOM, DVZ_CANVAS_FLAGS_VSYNC);
@@ -19,6 +19,8 @@
 /*  Path tests                                                                                */
 /*************************************************************************************************/
 
+int test_glyph_atlas(TstSuite*);
+
 int test_glyph_1(TstSuite*);
 
 
@@ -15,11 +15,13 @@
 #include "scene/test_animation.h"
 #include "scene/test_app.h"
 #include "scene/test_arcball.h"
+#include "scene/test_arena.h"
 #include "scene/test_array.h"
 #include "scene/test_atlas.h"
 #include "scene/test_axes.h"
 #include "scene/test_axis.h"
 #include "scene/test_baker.h"
+#include "scene/test_bricks.h"
 #include "scene/test_camera.h"
 #include "scene/test_colormaps.h"
 #include "scene/test_dual.h"
@@ -33,6 +35,7 @@
 #include "scene/test_sdf.h"
 #include "scene/test_shape.h"
 #include "scene/test_ticks.h"
+#include "scene/test_tiles.h"
 #include "scene/test_viewset.h"
 #include "scene/test_visual.h"
 #include "scene/visuals/test_basic.h"
@@ -53,6 +56,7 @@
 #include "test_canvas.h"
 #include "test_client.h"
 #include "test_client_input.h"
+#include "test_codec.h"
 #include "test_datalloc.h"
 #include "test_fifo.h"
 #include "test_fileio.h"
@@ -71,9 +75,13 @@
 #include "test_renderer.h"
 #include "test_request.h"
 #include "test_resources.h"
+#include "test_shm.h"
+#include "test_soft.h"
 #include "test_thread.h"
 #include "test_timer.h"
+#include "test_timing.h"
 #include "test_transfers.h"
+#include "test_transport.h"
 #include "test_vklite.h"
 #include "test_window.h"
 #include "test_workspace.h"
@@ -149,6 +157,9 @@ int dvz_run_tests(const char* match)
     TEST(test_timer_1)
     TEST(test_timer_2)
 
+    // Testing frame timing.
+    TEST(test_timing_1)
+
     // Testing input.
     TEST(test_input_mouse)
     TEST(test_input_keyboard)
@@ -161,6 +172,16 @@ int dvz_run_tests(const char* match)
     /*  Renderer                                                                                 */
     /*********************************************************************************************/
 
+    // Software renderer, no GPU needed.
+    TEST(test_soft_graphics)
+    TEST(test_soft_fan)
+    TEST(test_soft_marker)
+    TEST(test_soft_segment)
+    TEST(test_soft_path)
+    TEST(test_soft_image)
+    TEST(test_soft_mesh)
+    TEST(test_soft_threads)
+
     TEST(test_vklite_host)
 
     // Setup the host fixture.
@@ -177,6 +198,7 @@ int dvz_run_tests(const char* match)
     TEST(test_vklite_barrier_buffer)
     TEST(test_vklite_barrier_image)
     TEST(test_vklite_submit)
+    TEST(test_vklite_timeline)
     TEST(test_vklite_offscreen)
     TEST(test_vklite_shader)
     TEST(test_vklite_swapchain)
@@ -239,12 +261,19 @@ int dvz_run_tests(const char* match)
     TEST(test_transfers_dups_util)
     TEST(test_transfers_dups_upload)
     TEST(test_transfers_dups_copy)
+    TEST(test_transfers_batch)
+    TEST(test_transfers_ring)
+    TEST(test_transfers_scheduler)
+    TEST(test_transfers_canvases)
 
     // Testing resources transfers.
     TEST(test_resources_dat_transfers)
+    TEST(test_resources_dat_wait)
+    TEST(test_resources_dat_strided)
     TEST(test_resources_dat_resize)
     TEST(test_resources_tex_transfers)
     TEST(test_resources_tex_resize)
+    TEST(test_resources_tex_region)
 
     // Testing board.
     TEST(test_board_1)
@@ -265,9 +294,14 @@ int dvz_run_tests(const char* match)
 
     // Test visuals.
     TEST(test_visual_1)
+    TEST(test_visual_dump)
     TEST(test_viewset_1)
     TEST(test_viewset_mouse)
 
+    // Testing atlas uploads.
+    TEST(test_tiles_atlas)
+    TEST(test_atlas_upload)
+
     // Teardown the gpu fixture.
     TEARDOWN(teardown_gpu)
 
@@ -284,11 +318,27 @@ int dvz_run_tests(const char* match)
     TEST(test_client_1)
     TEST(test_client_2)
     TEST(test_client_thread)
+    TEST(test_client_async)
+
+    // Testing codec.
+    TEST(test_codec_1)
+    TEST(test_codec_dump)
 
     // Testing request.
     TEST(test_request_1)
+    TEST(test_request_push)
+    TEST(test_request_strided)
     TEST(test_requester_1)
 
+    // Testing shm.
+    TEST(test_shm_1)
+    TEST(test_shm_upload)
+    TEST(test_shm_invalid)
+
+    // Testing transport.
+    TEST(test_transport_1)
+    TEST(test_transport_compression)
+
 
 
     /*********************************************************************************************/
@@ -311,6 +361,9 @@ int dvz_run_tests(const char* match)
     TEST(test_dual_1)
     TEST(test_dual_2)
 
+    // Testing arena.
+    TEST(test_arena_1)
+
     // Testing params.
     TEST(test_params_1)
 
@@ -319,6 +372,9 @@ int dvz_run_tests(const char* match)
     TEST(test_baker_2)
     // TEST(test_baker_3)
 
+    // Testing visual updates.
+    TEST(test_visual_updates)
+
     // Testing colormaps.
     TEST(test_colormaps_idx)
     TEST(test_colormaps_uv)
@@ -336,14 +392,28 @@ int dvz_run_tests(const char* match)
     TEST(test_animation_1)
     TEST(test_shape_1)
     TEST(test_shape_obj)
+    TEST(test_shape_mesh)
+
+    // Testing bricked volumes.
+    TEST(test_bricks_1)
+    TEST(test_bricks_lru)
+    TEST(test_bricks_file)
+
+    // Testing tiled images.
+    TEST(test_tiles_1)
+    TEST(test_tiles_npy)
 
     // Ticks and axes.
     TEST(test_ticks_1)
+    TEST(test_ticks_cache)
     TEST(test_labels_1)
     TEST(test_labels_factored)
 
     // Testing atlas.
     TEST(test_atlas_1)
+    TEST(test_atlas_insert)
+    TEST(test_atlas_bundle)
+    TEST(test_glyph_atlas)
 
     // Testing sdf.
     TEST(test_sdf_single)
@@ -351,6 +421,7 @@ int dvz_run_tests(const char* match)
 
     // Testing font.
     TEST(test_font_1)
+    TEST(test_font_layout)
 
     // Testing app.
     TEST(test_app_scatter)
@@ -363,6 +434,7 @@ int dvz_run_tests(const char* match)
     TEST(test_scene_1)
     TEST(test_scene_2)
     TEST(test_scene_3)
+    TEST(test_scene_flush)
 
     // Visual tests.
     TEST(test_basic_1)
@@ -388,7 +460,9 @@ int dvz_run_tests(const char* match)
     TEST(test_axis_2)
     TEST(test_axis_get)
     TEST(test_axis_update)
+    TEST(test_axis_pan)
     TEST(test_axes_1)
+    TEST(test_axes_linked)
 
 
     tst_suite_run(&suite, match);
@@ -58,6 +58,38 @@ static void _delete_window(DvzClient* client, DvzId id)
 
 
 
+typedef struct
+{
+    uint32_t count;
+    uint32_t presses;
+    float last_x;
+    bool ordered;
+} _AsyncState;
+
+static void _async_callback(DvzClient* client, DvzClientEvent ev)
+{
+    ANN(client);
+
+    _AsyncState* state = (_AsyncState*)ev.user_data;
+    ANN(state);
+
+    // Slow callback, so that the following events pile up.
+    if (ev.content.m.type == DVZ_MOUSE_EVENT_PRESS)
+    {
+        state->presses++;
+        dvz_sleep(20);
+    }
+    else
+    {
+        // The events of a callback must be processed in order.
+        state->ordered &= ev.content.m.pos[0] > state->last_x;
+        state->last_x = ev.content.m.pos[0];
+    }
+    state->count++;
+}
+
+
+
 /*************************************************************************************************/
 /*  Client tests                                                                                 */
 /*************************************************************************************************/
@@ -123,3 +155,42 @@ int test_client_thread(TstSuite* suite)
     dvz_client_destroy(client);
     return 0;
 }
+
+
+
+int test_client_async(TstSuite* suite)
+{
+    DvzClient* client = dvz_client(BACKEND);
+
+    _AsyncState state = {.ordered = true, .last_x = -1};
+    dvz_client_callback(
+        client, DVZ_CLIENT_EVENT_MOUSE, DVZ_CLIENT_CALLBACK_ASYNC, _async_callback, &state);
+    AT(client->worker_count > 0);
+
+    // A press event followed by many move events, while the callback is busy with the press.
+    DvzClientEvent ev = {.type = DVZ_CLIENT_EVENT_MOUSE};
+    ev.content.m.type = DVZ_MOUSE_EVENT_PRESS;
+    dvz_client_event(client, ev);
+    ev.content.m.type = DVZ_MOUSE_EVENT_MOVE;
+    uint32_t n = 100;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        ev.content.m.pos[0] = i;
+        dvz_client_event(client, ev);
+    }
+
+    // The event loop does not wait for the callbacks.
+    dvz_client_process(client);
+    dvz_client_wait(client);
+
+    // The move events were coalesced, the latest one was kept.
+    AT(state.presses == 1);
+    AT(state.count >= 2);
+    AT(state.count < n + 1);
+    AT(state.ordered);
+    AC(state.last_x, n - 1, EPS);
+    AT(client->async_coalesced == n + 1 - state.count);
+
+    dvz_client_destroy(client);
+    return 0;
+}
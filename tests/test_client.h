@@ -26,6 +26,8 @@ int test_client_2(TstSuite*);
 
 int test_client_thread(TstSuite*);
 
+int test_client_async(TstSuite*);
+
 
 
 #endif
@@ -0,0 +1,166 @@
+/*************************************************************************************************/
+/*  Testing codec                                                                                */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "test_codec.h"
+#include "_prng.h"
+#include "codec.h"
+#include "fileio.h"
+#include "request.h"
+#include "test.h"
+#include "testing.h"
+
+
+
+/*************************************************************************************************/
+/*  Util functions                                                                               */
+/*************************************************************************************************/
+
+#define N_ITEMS (256 * 1024)
+
+
+
+// Compress and decompress a payload, return the compressed size, or 0 if it is incompressible.
+static DvzSize _roundtrip(const void* data, DvzSize size, uint32_t item_size, int filter)
+{
+    void* compressed = malloc(dvz_codec_bound(size));
+    DvzSize compressed_size = dvz_codec_compress(data, size, item_size, filter, compressed);
+    if (compressed_size > 0)
+    {
+        ASSERT(dvz_codec_size(compressed, compressed_size) == size);
+        void* decompressed = malloc(size);
+        int res = dvz_codec_decompress(compressed, compressed_size, decompressed, size);
+        if (res != 0 || memcmp(data, decompressed, size) != 0)
+            compressed_size = (DvzSize)-1;
+        FREE(decompressed);
+    }
+    FREE(compressed);
+    return compressed_size;
+}
+
+
+
+/*************************************************************************************************/
+/*  Codec tests                                                                                  */
+/*************************************************************************************************/
+
+int test_codec_1(TstSuite* suite)
+{
+    const int filter = DVZ_CODEC_FILTER_SHUFFLE | DVZ_CODEC_FILTER_DELTA;
+    const DvzSize size = N_ITEMS * sizeof(double);
+
+    // Sorted timestamps.
+    double* times = (double*)malloc(size);
+    for (uint32_t i = 0; i < N_ITEMS; i++)
+        times[i] = 1e9 + i * 0.001;
+    DvzSize raw = _roundtrip(times, size, 0, DVZ_CODEC_FILTER_NONE);
+    DvzSize filtered = _roundtrip(times, size, sizeof(double), filter);
+    AT(filtered > 0 && filtered != (DvzSize)-1);
+    AT(raw == 0 || (raw != (DvzSize)-1 && filtered < raw));
+
+    // Repeated colors.
+    cvec4* colors = (cvec4*)malloc(N_ITEMS * sizeof(cvec4));
+    for (uint32_t i = 0; i < N_ITEMS; i++)
+        memcpy(colors[i], (cvec4){(uint8_t)(i / 1000), 128, 64, 255}, sizeof(cvec4));
+    DvzSize compressed = _roundtrip(colors, N_ITEMS * sizeof(cvec4), sizeof(cvec4), filter);
+    AT(compressed > 0 && compressed < N_ITEMS * sizeof(cvec4) / 50);
+
+    // Random bytes are incompressible.
+    DvzPrng* prng = dvz_prng();
+    uint8_t* noise = (uint8_t*)colors;
+    for (uint32_t i = 0; i < N_ITEMS * sizeof(cvec4); i++)
+        noise[i] = (uint8_t)dvz_prng_uuid(prng);
+    AT(_roundtrip(noise, N_ITEMS * sizeof(cvec4), 1, DVZ_CODEC_FILTER_NONE) == 0);
+    dvz_prng_destroy(prng);
+
+    // Small and odd-sized payloads.
+    for (DvzSize n = 1; n < 100; n += 7)
+        AT(_roundtrip(times, n, 3, filter) != (DvzSize)-1);
+
+    // Invalid payloads are rejected.
+    AT(dvz_codec_size(times, 8) == 0);
+    AT(dvz_codec_decompress(times, 64, colors, 64) != 0);
+
+    // Several payloads on worker threads.
+    // NOTE: the compression ratios and rates are measured by `datoviz bench --micro codec`.
+    DvzCodecJob jobs[4] = {0};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        jobs[i].src = times;
+        jobs[i].size = size / (i + 1);
+        jobs[i].item_size = sizeof(double);
+        jobs[i].filter = filter;
+    }
+    dvz_codec_jobs(4, jobs, 0);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        AT(jobs[i].dst != NULL);
+        AT(dvz_codec_size(jobs[i].dst, jobs[i].dst_size) == jobs[i].size);
+        FREE(jobs[i].dst);
+    }
+
+    FREE(times);
+    FREE(colors);
+    return 0;
+}
+
+
+
+int test_codec_dump(TstSuite* suite)
+{
+    DvzBatch* batch = dvz_batch();
+    DvzRequest req = dvz_create_dat(batch, DVZ_BUFFER_TYPE_VERTEX, N_ITEMS * sizeof(float), 0);
+    float* values = (float*)malloc(N_ITEMS * sizeof(float));
+    for (uint32_t i = 0; i < N_ITEMS; i++)
+        values[i] = (float)i;
+    dvz_upload_dat(batch, req.id, 0, N_ITEMS * sizeof(float), values, 0);
+
+    // Small payloads are not compressed.
+    uint8_t small[16] = {1, 2, 3};
+    dvz_upload_dat(batch, req.id, 0, sizeof(small), small, 0);
+
+    char path[1024] = {0};
+    snprintf(path, sizeof(path), "%s/compressed.dvz", ARTIFACTS_DIR);
+    AT(dvz_batch_dump_compressed(batch, path, DVZ_CODEC_THRESHOLD) == 0);
+
+    char path_bin[1024] = {0};
+    DvzSize size = 0;
+    snprintf(path_bin, sizeof(path_bin), "%s.001", path);
+    void* buf = dvz_read_file(path_bin, &size);
+    AT(size < N_ITEMS * sizeof(float) / 2);
+    AT(dvz_codec_size(buf, size) == N_ITEMS * sizeof(float));
+    FREE(buf);
+    snprintf(path_bin, sizeof(path_bin), "%s.002", path);
+    buf = dvz_read_file(path_bin, &size);
+    AT(size == sizeof(small));
+    FREE(buf);
+
+    // The payloads are decompressed on load.
+    DvzBatch* loaded = dvz_batch();
+    dvz_batch_load(loaded, path);
+    AT(dvz_batch_size(loaded) == 3);
+    DvzRequest* reqs = dvz_batch_requests(loaded);
+    AT(reqs[1].content.dat_upload.size == N_ITEMS * sizeof(float));
+    AT(memcmp(reqs[1].content.dat_upload.data, values, N_ITEMS * sizeof(float)) == 0);
+    AT(reqs[2].content.dat_upload.size == sizeof(small));
+    AT(memcmp(reqs[2].content.dat_upload.data, small, sizeof(small)) == 0);
+
+    // The loaded payloads are owned by the batch, so that the requests can be replayed.
+    AT((reqs[1].flags & DVZ_UPLOAD_FLAGS_NOCOPY) != 0);
+
+    // Release the copies of the payloads, which would otherwise be consumed by the renderer.
+    reqs = dvz_batch_requests(batch);
+    dvz_upload_consume(&reqs[1]);
+    dvz_upload_consume(&reqs[2]);
+
+    FREE(values);
+    dvz_batch_destroy(loaded);
+    dvz_batch_destroy(batch);
+    return 0;
+}
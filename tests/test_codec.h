@@ -0,0 +1,28 @@
+/*************************************************************************************************/
+/*  Tests                                                                                        */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_TEST_CODEC
+#define DVZ_HEADER_TEST_CODEC
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "testing.h"
+
+
+
+/*************************************************************************************************/
+/*  Codec tests                                                                                  */
+/*************************************************************************************************/
+
+int test_codec_1(TstSuite*);
+
+int test_codec_dump(TstSuite*);
+
+
+
+#endif
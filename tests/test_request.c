@@ -52,6 +52,86 @@ int test_request_1(TstSuite* suite)
 
 
 
+int test_request_push(TstSuite* suite)
+{
+    DvzBatch* batch = dvz_batch();
+    DvzId canvas = 1, graphics = 2;
+    vec2 values = {1.5, -2.5};
+
+    dvz_set_push(batch, graphics, DVZ_SHADER_VERTEX | DVZ_SHADER_FRAGMENT, 0, sizeof(vec2));
+    dvz_record_push(
+        batch, canvas, graphics, DVZ_SHADER_VERTEX, sizeof(float), sizeof(float), &values[1]);
+    AT(dvz_batch_size(batch) == 2);
+
+    DvzRequest* reqs = dvz_batch_requests(batch);
+    AT(reqs[0].type == DVZ_REQUEST_OBJECT_PUSH);
+    AT(reqs[0].id == graphics);
+    AT(reqs[0].content.set_push.shader_stages == (DVZ_SHADER_VERTEX | DVZ_SHADER_FRAGMENT));
+    AT(reqs[0].content.set_push.size == sizeof(vec2));
+
+    // The push constant values are stored inline in the recorder command.
+    DvzRecorderCommand* cmd = &reqs[1].content.record.command;
+    AT(reqs[1].id == canvas);
+    AT(cmd->type == DVZ_RECORDER_PUSH);
+    AT(cmd->contents.push.pipe_id == graphics);
+    AT(cmd->contents.push.offset == sizeof(float));
+    AT(cmd->contents.push.size == sizeof(float));
+    AT(memcmp(cmd->contents.push.data, &values[1], sizeof(float)) == 0);
+
+    dvz_batch_print(batch);
+    dvz_batch_destroy(batch);
+    return 0;
+}
+
+
+
+static void _release_upload(void* user_data)
+{
+    ANN(user_data);
+    (*(int*)user_data)++;
+}
+
+int test_request_strided(TstSuite* suite)
+{
+    DvzBatch* batch = dvz_batch();
+
+    // Every other item of an array of 2-byte items.
+    uint8_t data[12] = {1, 2, 0, 0, 3, 4, 0, 0, 5, 6, 0, 0};
+    int released = 0;
+    DvzRequest req =
+        dvz_upload_dat_strided(batch, 1, 0, 3, 2, 4, data, _release_upload, &released);
+
+    // The data is not copied, and only released by the renderer.
+    AT(req.content.dat_upload.data == data);
+    AT(req.content.dat_upload.size == 6);
+    AT(req.content.dat_upload.item_size == 2);
+    AT(req.content.dat_upload.stride == 4);
+    AT((req.flags & DVZ_UPLOAD_FLAGS_NOCOPY) != 0);
+    AT(released == 0);
+
+    // Strided sources are dumped contiguously.
+    char path[1024] = {0};
+    snprintf(path, sizeof(path), "%s/strided.dvz", ARTIFACTS_DIR);
+    AT(dvz_batch_dump(batch, path) == 0);
+
+    DvzBatch* loaded = dvz_batch();
+    dvz_batch_load(loaded, path);
+    AT(dvz_batch_size(loaded) == 1);
+    DvzRequest* reqs = dvz_batch_requests(loaded);
+    AT(reqs[0].content.dat_upload.size == 6);
+    AT(reqs[0].content.dat_upload.stride == 0);
+    AT(reqs[0].content.dat_upload.release == NULL);
+    uint8_t* loaded_data = (uint8_t*)reqs[0].content.dat_upload.data;
+    for (uint32_t i = 0; i < 6; i++)
+        AT(loaded_data[i] == i + 1);
+
+    dvz_batch_destroy(loaded);
+    dvz_batch_destroy(batch);
+    return 0;
+}
+
+
+
 int test_requester_1(TstSuite* suite)
 {
     // Create a requester.
@@ -21,6 +21,10 @@
 
 int test_request_1(TstSuite*);
 
+int test_request_push(TstSuite*);
+
+int test_request_strided(TstSuite*);
+
 int test_requester_1(TstSuite*);
 
 
@@ -10,6 +10,7 @@
 
 #include "test_resources.h"
 #include "context.h"
+#include "fifo.h"
 #include "host.h"
 #include "test.h"
 #include "testing.h"
@@ -148,6 +149,88 @@ int test_resources_dat_transfers(TstSuite* suite)
 
 
 
+int test_resources_dat_wait(TstSuite* suite)
+{
+    ANN(suite);
+    DvzGpu* gpu = get_gpu(suite);
+    ANN(gpu);
+
+    DvzContext* ctx = dvz_context(gpu);
+    ANN(ctx);
+    DvzDeq* deq = ctx->transfers.deq;
+    ANN(deq);
+
+    uint8_t data[64] = {0};
+    uint8_t data1[64] = {0};
+    for (uint32_t i = 0; i < 64; i++)
+        data[i] = (uint8_t)i;
+
+    DvzDat* dat = dvz_dat(ctx, DVZ_BUFFER_TYPE_VERTEX, 64, DVZ_DAT_FLAGS_NONE);
+    ANN(dat);
+
+    // The copies of the asynchronous uploads from the staging ring are queued first.
+    dvz_dat_upload(dat, 0, 64, data1, false);
+    dvz_dat_upload(dat, 0, 64, data1, false);
+    AT(dvz_fifo_size(deq->queues[DVZ_TRANSFER_DEQ_COPY]) == 2);
+
+    // A blocking upload only returns once its own copy has been processed.
+    dvz_dat_upload(dat, 0, 64, data, true);
+    AT(dvz_fifo_size(deq->queues[DVZ_TRANSFER_DEQ_COPY]) == 0);
+    AT(dvz_fifo_size(deq->queues[DVZ_TRANSFER_DEQ_EV]) == 0);
+
+    dvz_dat_download(dat, 0, 64, data1, true);
+    AT(memcmp(data1, data, 64) == 0);
+
+    dvz_dat_destroy(dat);
+    dvz_context_destroy(ctx);
+    return 0;
+}
+
+
+
+int test_resources_dat_strided(TstSuite* suite)
+{
+    ANN(suite);
+    DvzGpu* gpu = get_gpu(suite);
+    ANN(gpu);
+
+    DvzContext* ctx = dvz_context(gpu);
+    ANN(ctx);
+    ctx->res.img_count = 3;
+
+    // Every other item of an array of 2-byte items.
+    uint8_t data[12] = {1, 2, 0, 0, 3, 4, 0, 0, 5, 6, 0, 0};
+    uint8_t data1[6] = {0};
+    DvzDat* dat = NULL;
+
+    int flags_tests[] = {
+        DVZ_DAT_FLAGS_NONE,     //
+        DVZ_DAT_FLAGS_MAPPABLE, //
+        DVZ_DAT_FLAGS_DUP,
+    };
+
+    for (uint32_t i = 0; i < sizeof(flags_tests) / sizeof(int); i++)
+    {
+        dat = dvz_dat(ctx, DVZ_BUFFER_TYPE_VERTEX, 128, flags_tests[i]);
+        ANN(dat);
+
+        // Upload the strided items, they are written contiguously in the dat.
+        dvz_dat_upload_strided(dat, 0, 3, 2, 4, data, true);
+
+        // Download back the data.
+        dvz_dat_download(dat, 0, sizeof(data1), data1, true);
+        for (uint32_t j = 0; j < 6; j++)
+            AT(data1[j] == j + 1);
+
+        dvz_dat_destroy(dat);
+    }
+
+    dvz_context_destroy(ctx);
+    return 0;
+}
+
+
+
 int test_resources_dat_resize(TstSuite* suite)
 {
     ANN(suite);
@@ -275,3 +358,59 @@ int test_resources_tex_resize(TstSuite* suite)
     dvz_context_destroy(ctx);
     return 0;
 }
+
+
+
+int test_resources_tex_region(TstSuite* suite)
+{
+    ANN(suite);
+    DvzGpu* gpu = get_gpu(suite);
+    ANN(gpu);
+
+    DvzContext* ctx = dvz_context(gpu);
+    ANN(ctx);
+
+    uvec3 shape = {16, 8, 1};
+    DvzFormat format = DVZ_FORMAT_R8G8B8A8_UNORM;
+    DvzSize size = 4 * shape[0] * shape[1] * shape[2];
+
+    // Allocate a tex and clear it.
+    DvzTex* tex = dvz_tex(ctx, DVZ_TEX_2D, shape, format, 0);
+    ANN(tex);
+    uint8_t* zeros = (uint8_t*)calloc(size, 1);
+    dvz_tex_upload(tex, DVZ_ZERO_OFFSET, (uvec3){0, 0, 0}, size, zeros, true);
+
+    // Upload a 4x2 sub-region at a non-zero offset.
+    uvec3 offset = {8, 4, 0};
+    uvec3 region = {4, 2, 1};
+    uint8_t data[4 * 4 * 2] = {0};
+    for (uint32_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i + 1);
+    dvz_tex_upload(tex, offset, region, sizeof(data), data, true);
+
+    // The shape of the region is not modified.
+    AT(region[0] == 4 && region[1] == 2 && region[2] == 1);
+
+    // Download back the whole tex: only the region has been overwritten.
+    uint8_t* data1 = (uint8_t*)calloc(size, 1);
+    dvz_tex_download(tex, DVZ_ZERO_OFFSET, shape, size, data1, true);
+    uint32_t k = 0;
+    for (uint32_t y = 0; y < shape[1]; y++)
+    {
+        for (uint32_t x = 0; x < shape[0]; x++)
+        {
+            bool inside = x >= offset[0] && x < offset[0] + region[0] && //
+                          y >= offset[1] && y < offset[1] + region[1];
+            for (uint32_t c = 0; c < 4; c++)
+                AT(data1[4 * (y * shape[0] + x) + c] == (inside ? data[k++] : 0));
+        }
+    }
+    AT(k == sizeof(data));
+
+    FREE(zeros);
+    FREE(data1);
+    dvz_tex_destroy(tex);
+
+    dvz_context_destroy(ctx);
+    return 0;
+}
@@ -95,12 +95,18 @@ int test_resources_tex_1(TstSuite*);
 
 int test_resources_dat_transfers(TstSuite* suite);
 
+int test_resources_dat_wait(TstSuite* suite);
+
+int test_resources_dat_strided(TstSuite* suite);
+
 int test_resources_dat_resize(TstSuite* suite);
 
 int test_resources_tex_transfers(TstSuite* suite);
 
 int test_resources_tex_resize(TstSuite* suite);
 
+int test_resources_tex_region(TstSuite* suite);
+
 
 
 #endif
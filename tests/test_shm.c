@@ -0,0 +1,170 @@
+/*************************************************************************************************/
+/*  Testing shared-memory arenas                                                                 */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "test_shm.h"
+#include "_map.h"
+#include "request.h"
+#include "shm.h"
+#include "soft.h"
+#include "test.h"
+#include "testing.h"
+
+
+
+/*************************************************************************************************/
+/*  Util functions                                                                               */
+/*************************************************************************************************/
+
+#define UPLOAD_SIZE  (1024 * 1024)
+#define UPLOAD_COUNT 4
+
+
+
+/*************************************************************************************************/
+/*  Shm tests                                                                                    */
+/*************************************************************************************************/
+
+int test_shm_1(TstSuite* suite)
+{
+    DvzShm* shm = dvz_shm(1024 * 1024);
+    AT(shm != NULL);
+    AT(dvz_shm_get(shm->id) == shm);
+
+    // Allocate two blocks.
+    DvzSize offset_a = 0, offset_b = 0;
+    uint8_t* a = (uint8_t*)dvz_shm_alloc(shm, 1000, &offset_a);
+    uint8_t* b = (uint8_t*)dvz_shm_alloc(shm, 1000, &offset_b);
+    AT(a != NULL);
+    AT(b != NULL);
+    AT(offset_a % DVZ_SHM_ALIGNMENT == 0);
+    AT(offset_b > offset_a);
+    AT(dvz_shm_pointer(shm, offset_b, 1000) == b);
+    AT(dvz_shm_refs(shm) == 2);
+
+    // The arena is full.
+    DvzSize offset = 0;
+    AT(dvz_shm_alloc(shm, 2 * 1024 * 1024, &offset) == NULL);
+
+    // A block is only reused once all of its references have been released.
+    dvz_shm_ref(shm, offset_a);
+    dvz_shm_unref(shm, offset_a);
+    AT(dvz_shm_refs(shm) == 2);
+    AT(dvz_shm_alloc(shm, 1000, &offset) != NULL);
+    AT(offset > offset_b);
+    dvz_shm_unref(shm, offset);
+
+    dvz_shm_unref(shm, offset_a);
+    AT(dvz_shm_alloc(shm, 500, &offset) == a);
+    AT(offset == offset_a);
+    dvz_shm_unref(shm, offset);
+
+    // Released neighbor blocks are merged.
+    dvz_shm_unref(shm, offset_b);
+    AT(dvz_shm_refs(shm) == 0);
+    AT(dvz_shm_alloc(shm, 3000, &offset) == a);
+    dvz_shm_unref(shm, offset);
+
+    dvz_shm_destroy(shm);
+    return 0;
+}
+
+
+
+int test_shm_upload(TstSuite* suite)
+{
+    DvzSoft* soft = dvz_soft(0);
+    DvzBatch* batch = dvz_batch();
+    DvzRequest req = dvz_create_dat(batch, DVZ_BUFFER_TYPE_STORAGE, UPLOAD_SIZE, 0);
+    DvzId dat_id = req.id;
+    dvz_soft_request(soft, req);
+    DvzSoftDat* dat = (DvzSoftDat*)dvz_map_get(soft->map, dat_id);
+    ANN(dat);
+
+    DvzShm* shm = dvz_shm(UPLOAD_SIZE);
+    AT(shm != NULL);
+    DvzSize shm_offset = 0;
+    uint8_t* data = (uint8_t*)dvz_shm_alloc(shm, UPLOAD_SIZE, &shm_offset);
+    AT(data != NULL);
+    for (uint32_t i = 0; i < UPLOAD_SIZE; i++)
+        data[i] = (uint8_t)(i % 251);
+
+    // The request holds a reference on the block until the renderer has uploaded it.
+    req = dvz_upload_dat_shm(batch, dat_id, 0, shm, shm_offset, UPLOAD_SIZE);
+    AT(req.content.dat_upload.upload_type == DVZ_UPLOAD_TYPE_SHM);
+    AT(dvz_shm_refs(shm) == 2);
+    AT(dvz_upload_source(&req) == data);
+    dvz_soft_request(soft, req);
+    AT(dvz_shm_refs(shm) == 1);
+    AT(memcmp(dat->data, data, UPLOAD_SIZE) == 0);
+
+    // Every upload releases its reference on the block.
+    // NOTE: the upload rates are measured by `datoviz bench --micro shm_upload`.
+    memset(dat->data, 0, UPLOAD_SIZE);
+    for (uint32_t i = 0; i < UPLOAD_COUNT; i++)
+        dvz_soft_request(
+            soft, dvz_upload_dat_shm(batch, dat_id, 0, shm, shm_offset, UPLOAD_SIZE));
+    AT(dvz_shm_refs(shm) == 1);
+    AT(memcmp(dat->data, data, UPLOAD_SIZE) == 0);
+
+    dvz_shm_unref(shm, shm_offset);
+    dvz_shm_destroy(shm);
+    dvz_batch_destroy(batch);
+    dvz_soft_destroy(soft);
+    return 0;
+}
+
+
+
+int test_shm_invalid(TstSuite* suite)
+{
+    DvzSoft* soft = dvz_soft(0);
+    DvzBatch* batch = dvz_batch();
+    DvzRequest req = dvz_create_dat(batch, DVZ_BUFFER_TYPE_STORAGE, 1024, 0);
+    DvzId dat_id = req.id;
+    dvz_soft_request(soft, req);
+    DvzSoftDat* dat = (DvzSoftDat*)dvz_map_get(soft->map, dat_id);
+    ANN(dat);
+
+    DvzShm* shm = dvz_shm(UPLOAD_SIZE);
+    AT(shm != NULL);
+    DvzSize offset_a = 0, offset_b = 0;
+    uint8_t* a = (uint8_t*)dvz_shm_alloc(shm, 1000, &offset_a);
+    AT(a != NULL);
+    AT(dvz_shm_alloc(shm, 1000, &offset_b) != NULL);
+    memset(a, 1, 1000);
+    dvz_shm_unref(shm, offset_b);
+
+    // Offsets and sizes that do not match a live block are rejected.
+    AT(dvz_shm_pointer(shm, offset_a, 1000) == a);
+    AT(dvz_shm_pointer(shm, offset_a, 4096) == NULL);
+    AT(dvz_shm_pointer(shm, offset_a + 1, 1) == NULL);
+    AT(dvz_shm_pointer(shm, 0, 1) == NULL);
+    AT(dvz_shm_pointer(shm, offset_b, 1) == NULL);
+    AT(dvz_shm_pointer(shm, 2 * UPLOAD_SIZE, 1) == NULL);
+    dvz_shm_ref(shm, offset_b);
+    dvz_shm_unref(shm, offset_b);
+    dvz_shm_unref(shm, 2 * UPLOAD_SIZE);
+    AT(dvz_shm_refs(shm) == 1);
+
+    // An upload larger than its block is dropped, and its reference is released.
+    req = dvz_upload_dat_shm(batch, dat_id, 0, shm, offset_a, 1000);
+    AT(dvz_shm_refs(shm) == 2);
+    req.content.dat_upload.size = 4096;
+    AT(dvz_upload_source(&req) == NULL);
+    dvz_soft_request(soft, req);
+    AT(dvz_shm_refs(shm) == 1);
+    AT(((uint8_t*)dat->data)[0] == 0);
+
+    dvz_shm_unref(shm, offset_a);
+    dvz_shm_destroy(shm);
+    dvz_batch_destroy(batch);
+    dvz_soft_destroy(soft);
+    return 0;
+}
@@ -0,0 +1,30 @@
+/*************************************************************************************************/
+/*  Tests                                                                                        */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_TEST_SHM
+#define DVZ_HEADER_TEST_SHM
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "testing.h"
+
+
+
+/*************************************************************************************************/
+/*  Shm tests                                                                                    */
+/*************************************************************************************************/
+
+int test_shm_1(TstSuite*);
+
+int test_shm_upload(TstSuite*);
+
+int test_shm_invalid(TstSuite*);
+
+
+
+#endif
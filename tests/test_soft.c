@@ -0,0 +1,484 @@
+/*************************************************************************************************/
+/*  Testing software renderer                                                                    */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "test_soft.h"
+#include "fileio.h"
+#include "renderer.h"
+#include "scene/graphics.h"
+#include "scene/mvp.h"
+#include "scene/viewport.h"
+#include "scene/visuals/image.h"
+#include "scene/visuals/marker.h"
+#include "scene/visuals/mesh.h"
+#include "scene/visuals/path.h"
+#include "scene/visuals/segment.h"
+#include "soft.h"
+#include "test.h"
+#include "testing.h"
+#include "testing_utils.h"
+
+
+
+/*************************************************************************************************/
+/*  Util functions                                                                               */
+/*************************************************************************************************/
+
+static cvec4 SOFT_BACKGROUND = {32, 64, 128, 255};
+
+
+
+static inline bool _is_color(uint8_t* rgb, uint32_t x, uint32_t y, cvec4 color)
+{
+    uint8_t* pixel = &rgb[3 * (y * WIDTH + x)];
+    return pixel[0] == color[0] && pixel[1] == color[1] && pixel[2] == color[2];
+}
+
+
+
+static inline bool _is_background(uint8_t* rgb, uint32_t x, uint32_t y)
+{
+    return _is_color(rgb, x, y, SOFT_BACKGROUND);
+}
+
+
+
+/*************************************************************************************************/
+/*  Fixture                                                                                      */
+/*************************************************************************************************/
+
+typedef struct SoftFixture SoftFixture;
+struct SoftFixture
+{
+    DvzRenderer* rd;
+    DvzBatch* batch;
+    DvzId board_id;
+    DvzId graphics_id;
+};
+
+
+
+// Software renderer with a board and a custom graphics with a single vertex binding, the MVP and
+// viewport being bound to slots #0 and #1 like in the builtin visuals. The shaders are not needed
+// by the software renderer.
+static SoftFixture _fixture(DvzPrimitiveTopology topology, DvzSize stride)
+{
+    SoftFixture fx = {0};
+
+    // NOTE: no GPU needed.
+    fx.rd = dvz_renderer(NULL, DVZ_RENDERER_FLAGS_SOFTWARE);
+    fx.batch = dvz_batch();
+    DvzBatch* batch = fx.batch;
+
+    fx.board_id = dvz_create_board(batch, WIDTH, HEIGHT, DVZ_DEFAULT_CLEAR_COLOR, 0).id;
+    dvz_set_background(batch, fx.board_id, SOFT_BACKGROUND);
+
+    fx.graphics_id =
+        dvz_create_graphics(batch, DVZ_GRAPHICS_CUSTOM, DVZ_REQUEST_FLAGS_OFFSCREEN).id;
+    dvz_set_primitive(batch, fx.graphics_id, topology);
+    dvz_set_vertex(batch, fx.graphics_id, 0, stride, DVZ_VERTEX_INPUT_RATE_VERTEX);
+
+    // Binding #0: MVP.
+    DvzId mvp_id = dvz_create_dat(batch, DVZ_BUFFER_TYPE_UNIFORM, sizeof(DvzMVP), 0).id;
+    dvz_bind_dat(batch, fx.graphics_id, 0, mvp_id, 0);
+    DvzMVP mvp = dvz_mvp_default();
+    dvz_upload_dat(batch, mvp_id, 0, sizeof(DvzMVP), &mvp, 0);
+
+    // Binding #1: viewport.
+    DvzId viewport_id = dvz_create_dat(batch, DVZ_BUFFER_TYPE_UNIFORM, sizeof(DvzViewport), 0).id;
+    dvz_bind_dat(batch, fx.graphics_id, 1, viewport_id, 0);
+    DvzViewport viewport = dvz_viewport_default(WIDTH, HEIGHT);
+    dvz_upload_dat(batch, viewport_id, 0, sizeof(DvzViewport), &viewport, 0);
+
+    return fx;
+}
+
+
+
+static void _fixture_attr(SoftFixture* fx, uint32_t location, DvzFormat format, DvzSize offset)
+{
+    ANN(fx);
+    dvz_set_attr(fx->batch, fx->graphics_id, 0, location, format, offset);
+}
+
+
+
+static void _fixture_vertices(SoftFixture* fx, DvzSize size, void* data)
+{
+    ANN(fx);
+    DvzId dat_id = dvz_create_dat(fx->batch, DVZ_BUFFER_TYPE_VERTEX, size, 0).id;
+    dvz_bind_vertex(fx->batch, fx->graphics_id, 0, dat_id, 0);
+    dvz_upload_dat(fx->batch, dat_id, 0, size, data, 0);
+}
+
+
+
+// Record a draw of the graphics, preceded by a float push constant if not NULL, render the board
+// and return its image, which is also saved in the artifacts directory.
+static uint8_t*
+_fixture_render(SoftFixture* fx, uint32_t vertex_count, float* push, const char* name)
+{
+    ANN(fx);
+    DvzBatch* batch = fx->batch;
+
+    dvz_record_begin(batch, fx->board_id);
+    dvz_record_viewport(batch, fx->board_id, DVZ_DEFAULT_VIEWPORT, DVZ_DEFAULT_VIEWPORT);
+    if (push != NULL)
+        dvz_record_push(
+            batch, fx->board_id, fx->graphics_id, DVZ_SHADER_VERTEX, 0, sizeof(float), push);
+    dvz_record_draw(batch, fx->board_id, fx->graphics_id, 0, vertex_count, 0, 1);
+    dvz_record_end(batch, fx->board_id);
+
+    dvz_update_board(batch, fx->board_id);
+    dvz_renderer_requests(fx->rd, dvz_batch_size(batch), dvz_batch_requests(batch));
+    dvz_batch_clear(batch);
+
+    DvzSize size = 0;
+    uint8_t* rgb = dvz_renderer_image(fx->rd, fx->board_id, &size, NULL);
+    ANN(rgb);
+    ASSERT(size == WIDTH * HEIGHT * 3);
+
+    char imgpath[1024];
+    snprintf(imgpath, sizeof(imgpath), "%s/%s.png", ARTIFACTS_DIR, name);
+    dvz_write_png(imgpath, WIDTH, HEIGHT, rgb);
+    return rgb;
+}
+
+
+
+static void _fixture_destroy(SoftFixture* fx)
+{
+    ANN(fx);
+    dvz_batch_destroy(fx->batch);
+    dvz_renderer_destroy(fx->rd);
+}
+
+
+
+/*************************************************************************************************/
+/*  Soft tests                                                                                   */
+/*************************************************************************************************/
+
+int test_soft_graphics(TstSuite* suite)
+{
+    SoftFixture fx = _fixture(DVZ_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, sizeof(DvzVertex));
+    _fixture_attr(&fx, 0, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(DvzVertex, pos));
+    _fixture_attr(&fx, 1, DVZ_FORMAT_R8G8B8A8_UNORM, offsetof(DvzVertex, color));
+    DvzVertex data[] = {
+        {{-1, -1, 0}, {255, 0, 0, 255}},
+        {{+1, -1, 0}, {0, 255, 0, 255}},
+        {{+0, +1, 0}, {0, 0, 255, 255}},
+    };
+    _fixture_vertices(&fx, sizeof(data), data);
+
+    uint8_t* rgb = _fixture_render(&fx, 3, NULL, "soft_graphics");
+
+    // The triangle covers the center but not the top corners.
+    AT(!_is_background(rgb, WIDTH / 2, HEIGHT / 2));
+    AT(_is_background(rgb, 2, 2));
+    AT(_is_background(rgb, WIDTH - 2, 2));
+
+    _fixture_destroy(&fx);
+    return 0;
+}
+
+
+
+int test_soft_fan(TstSuite* suite)
+{
+    SoftFixture fx = _fixture(DVZ_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN, sizeof(DvzVertex));
+    _fixture_attr(&fx, 0, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(DvzVertex, pos));
+    _fixture_attr(&fx, 1, DVZ_FORMAT_R8G8B8A8_UNORM, offsetof(DvzVertex, color));
+
+    // A fan of two triangles covering the whole square, around its bottom left corner.
+    DvzVertex data[] = {
+        {{-1, -1, 0}, {255, 0, 0, 255}},
+        {{+1, -1, 0}, {0, 255, 0, 255}},
+        {{+1, +1, 0}, {0, 0, 255, 255}},
+        {{-1, +1, 0}, {255, 255, 0, 255}},
+    };
+    _fixture_vertices(&fx, sizeof(data), data);
+
+    uint8_t* rgb = _fixture_render(&fx, 4, NULL, "soft_fan");
+
+    // Two triangles (v0, v1, v2) and (v0, v2, v3): every corner is covered.
+    AT(dvz_soft_stats(fx.rd->soft).primitives == 2);
+    AT(!_is_background(rgb, 2, 2));
+    AT(!_is_background(rgb, WIDTH - 2, 2));
+    AT(!_is_background(rgb, 2, HEIGHT - 2));
+    AT(!_is_background(rgb, WIDTH - 2, HEIGHT - 2));
+
+    _fixture_destroy(&fx);
+    return 0;
+}
+
+
+
+int test_soft_marker(TstSuite* suite)
+{
+    typedef DvzMarkerVertex V;
+    SoftFixture fx = _fixture(DVZ_PRIMITIVE_TOPOLOGY_POINT_LIST, sizeof(V));
+    _fixture_attr(&fx, 0, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(V, pos));
+    _fixture_attr(&fx, 1, DVZ_FORMAT_R32_SFLOAT, offsetof(V, size));
+    _fixture_attr(&fx, 2, DVZ_FORMAT_R32_SFLOAT, offsetof(V, angle));
+    _fixture_attr(&fx, 3, DVZ_FORMAT_R8G8B8A8_UNORM, offsetof(V, color));
+
+    // A marker with a diameter of 40 pixels at the center of the board.
+    cvec4 red = {255, 0, 0, 255};
+    V data = {{0, 0, 0}, 40, 0, {255, 0, 0, 255}};
+    _fixture_vertices(&fx, sizeof(data), &data);
+    uint32_t cx = WIDTH / 2, cy = HEIGHT / 2;
+
+    // Without scale push constant.
+    uint8_t* rgb = _fixture_render(&fx, 1, NULL, "soft_marker");
+    AT(_is_color(rgb, cx, cy, red));
+    AT(_is_color(rgb, cx + 15, cy, red));
+    AT(_is_background(rgb, cx + 30, cy));
+
+    // The scale push constant doubles the size.
+    float scale = 2;
+    rgb = _fixture_render(&fx, 1, &scale, "soft_marker_scaled");
+    AT(_is_color(rgb, cx + 30, cy, red));
+    AT(_is_background(rgb, cx + 50, cy));
+
+    // A zero scale is not ignored, only the pixel containing the center is drawn.
+    scale = 0;
+    rgb = _fixture_render(&fx, 1, &scale, "soft_marker_hidden");
+    AT(_is_background(rgb, cx + 5, cy));
+
+    _fixture_destroy(&fx);
+    return 0;
+}
+
+
+
+int test_soft_segment(TstSuite* suite)
+{
+    typedef DvzSegmentVertex V;
+    SoftFixture fx = _fixture(DVZ_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, sizeof(V));
+    _fixture_attr(&fx, 0, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(V, P0));
+    _fixture_attr(&fx, 1, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(V, P1));
+    _fixture_attr(&fx, 2, DVZ_FORMAT_R32G32B32A32_SFLOAT, offsetof(V, shift));
+    _fixture_attr(&fx, 3, DVZ_FORMAT_R8G8B8A8_UNORM, offsetof(V, color));
+    _fixture_attr(&fx, 4, DVZ_FORMAT_R32_SFLOAT, offsetof(V, linewidth));
+    _fixture_attr(&fx, 5, DVZ_FORMAT_R32_SINT, offsetof(V, cap0));
+    _fixture_attr(&fx, 6, DVZ_FORMAT_R32_SINT, offsetof(V, cap1));
+
+    // A horizontal segment with a width of 10 pixels, the 4 vertices of its quad are identical.
+    cvec4 green = {0, 255, 0, 255};
+    V data[4] = {0};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        data[i].P0[0] = -.5;
+        data[i].P1[0] = +.5;
+        memcpy(data[i].color, green, sizeof(cvec4));
+        data[i].linewidth = 10;
+    }
+    _fixture_vertices(&fx, sizeof(data), data);
+
+    uint8_t* rgb = _fixture_render(&fx, 4, NULL, "soft_segment");
+    uint32_t cx = WIDTH / 2, cy = HEIGHT / 2;
+    AT(_is_color(rgb, cx, cy, green));
+    AT(_is_color(rgb, cx, cy + 3, green));
+    AT(_is_color(rgb, WIDTH / 4 + 2, cy, green));
+    AT(_is_background(rgb, cx, cy + 10));
+    AT(_is_background(rgb, cx, cy - 10));
+    AT(_is_background(rgb, WIDTH / 4 - 10, cy));
+    AT(_is_background(rgb, 3 * WIDTH / 4 + 10, cy));
+
+    _fixture_destroy(&fx);
+    return 0;
+}
+
+
+
+int test_soft_path(TstSuite* suite)
+{
+    typedef DvzPathVertex V;
+    SoftFixture fx = _fixture(DVZ_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, sizeof(V));
+    _fixture_attr(&fx, 0, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(V, p0));
+    _fixture_attr(&fx, 1, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(V, p1));
+    _fixture_attr(&fx, 2, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(V, p2));
+    _fixture_attr(&fx, 3, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(V, p3));
+    _fixture_attr(&fx, 4, DVZ_FORMAT_R8G8B8A8_UNORM, offsetof(V, color));
+
+    // A vertical path segment between p1 and p2.
+    cvec4 yellow = {255, 255, 0, 255};
+    V data[4] = {0};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        data[i].p1[1] = -.5;
+        data[i].p2[1] = +.5;
+        memcpy(data[i].color, yellow, sizeof(cvec4));
+    }
+    _fixture_vertices(&fx, sizeof(data), data);
+
+    // The line width is passed with a push constant.
+    float linewidth = 20;
+    uint8_t* rgb = _fixture_render(&fx, 4, &linewidth, "soft_path");
+    uint32_t cx = WIDTH / 2, cy = HEIGHT / 2;
+    AT(_is_color(rgb, cx, cy, yellow));
+    AT(_is_color(rgb, cx + 8, cy, yellow));
+    AT(_is_color(rgb, cx, HEIGHT / 4 + 2, yellow));
+    AT(_is_background(rgb, cx + 15, cy));
+    AT(_is_background(rgb, cx, HEIGHT / 4 - 15));
+
+    _fixture_destroy(&fx);
+    return 0;
+}
+
+
+
+int test_soft_image(TstSuite* suite)
+{
+    typedef DvzImageVertex V;
+    SoftFixture fx = _fixture(DVZ_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, sizeof(V));
+    _fixture_attr(&fx, 0, DVZ_FORMAT_R32G32_SFLOAT, offsetof(V, pos));
+    _fixture_attr(&fx, 1, DVZ_FORMAT_R32G32_SFLOAT, offsetof(V, uv));
+
+    // A square in the middle of the board, as two triangles, with the first texture row on top.
+    V data[] = {
+        {{-.5, +.5}, {0, 0}}, {{+.5, +.5}, {1, 0}}, {{+.5, -.5}, {1, 1}},
+        {{-.5, +.5}, {0, 0}}, {{+.5, -.5}, {1, 1}}, {{-.5, -.5}, {0, 1}},
+    };
+    _fixture_vertices(&fx, sizeof(data), data);
+
+    // A 2x2 texture in slot #2, uploaded with a zero shape meaning the full texture.
+    cvec4 texels[4] = {
+        {255, 0, 0, 255},
+        {0, 255, 0, 255},
+        {0, 0, 255, 255},
+        {255, 255, 255, 255},
+    };
+    uvec3 shape = {2, 2, 1};
+    uvec3 offset = {0};
+    uvec3 full = {0};
+    DvzId tex_id = dvz_create_tex(fx.batch, DVZ_TEX_2D, DVZ_FORMAT_R8G8B8A8_UNORM, shape, 0).id;
+    dvz_upload_tex(fx.batch, tex_id, offset, full, sizeof(texels), texels, 0);
+    DvzId sampler_id =
+        dvz_create_sampler(fx.batch, DVZ_FILTER_NEAREST, DVZ_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE)
+            .id;
+    dvz_bind_tex(fx.batch, fx.graphics_id, 2, tex_id, sampler_id, offset);
+
+    uint8_t* rgb = _fixture_render(&fx, 6, NULL, "soft_image");
+    AT(_is_color(rgb, 3 * WIDTH / 8, 3 * HEIGHT / 8, texels[0]));
+    AT(_is_color(rgb, 5 * WIDTH / 8, 3 * HEIGHT / 8, texels[1]));
+    AT(_is_color(rgb, 3 * WIDTH / 8, 5 * HEIGHT / 8, texels[2]));
+    AT(_is_color(rgb, 5 * WIDTH / 8, 5 * HEIGHT / 8, texels[3]));
+    AT(_is_background(rgb, WIDTH / 8, HEIGHT / 8));
+    AT(_is_background(rgb, 7 * WIDTH / 8, 7 * HEIGHT / 8));
+
+    _fixture_destroy(&fx);
+    return 0;
+}
+
+
+
+int test_soft_mesh(TstSuite* suite)
+{
+    typedef DvzMeshColorVertex V;
+    SoftFixture fx = _fixture(DVZ_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, sizeof(V));
+    _fixture_attr(&fx, 0, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(V, pos));
+    _fixture_attr(&fx, 1, DVZ_FORMAT_R32G32B32_SFLOAT, offsetof(V, normal));
+    _fixture_attr(&fx, 2, DVZ_FORMAT_R8G8B8A8_UNORM, offsetof(V, color));
+
+    // A single blue triangle pointing upwards.
+    cvec4 blue = {0, 0, 255, 255};
+    V data[] = {
+        {{-.5, -.5, 0}, {0, 0, 1}, {0, 0, 255, 255}},
+        {{+.5, -.5, 0}, {0, 0, 1}, {0, 0, 255, 255}},
+        {{+0, +.5, 0}, {0, 0, 1}, {0, 0, 255, 255}},
+    };
+    _fixture_vertices(&fx, sizeof(data), data);
+
+    uint8_t* rgb = _fixture_render(&fx, 3, NULL, "soft_mesh");
+    AT(_is_color(rgb, WIDTH / 2, HEIGHT / 2, blue));
+    AT(_is_color(rgb, WIDTH / 2, 5 * HEIGHT / 8, blue));
+    AT(_is_color(rgb, 5 * WIDTH / 16, 23 * HEIGHT / 32, blue));
+    AT(_is_background(rgb, 5 * WIDTH / 16, 3 * HEIGHT / 8));
+    AT(_is_background(rgb, WIDTH / 2, 7 * HEIGHT / 8));
+
+    _fixture_destroy(&fx);
+    return 0;
+}
+
+
+
+int test_soft_threads(TstSuite* suite)
+{
+    DvzSoft* soft = dvz_soft(0);
+    DvzBatch* batch = dvz_batch();
+    DvzRequest req = {0};
+
+    req = dvz_create_board(batch, WIDTH, HEIGHT, DVZ_DEFAULT_CLEAR_COLOR, 0);
+    DvzId board_id = req.id;
+
+    // Builtin point graphics, with overlapping semi-transparent points.
+    req = dvz_create_graphics(batch, DVZ_GRAPHICS_POINT, 0);
+    DvzId graphics_id = req.id;
+
+    const uint32_t n = 10000;
+    req = dvz_create_dat(batch, DVZ_BUFFER_TYPE_VERTEX, n * sizeof(DvzGraphicsPointVertex), 0);
+    DvzId dat_id = req.id;
+    dvz_bind_vertex(batch, graphics_id, 0, dat_id, 0);
+
+    DvzGraphicsPointVertex* data =
+        (DvzGraphicsPointVertex*)calloc(n, sizeof(DvzGraphicsPointVertex));
+    for (uint32_t i = 0; i < n; i++)
+    {
+        data[i].pos[0] = 2 * dvz_rand_float() - 1;
+        data[i].pos[1] = 2 * dvz_rand_float() - 1;
+        data[i].size = 5 + 40 * dvz_rand_float();
+        data[i].color[0] = dvz_rand_byte();
+        data[i].color[1] = dvz_rand_byte();
+        data[i].color[2] = 128;
+        data[i].color[3] = 64;
+    }
+    dvz_upload_dat(batch, dat_id, 0, n * sizeof(DvzGraphicsPointVertex), data, 0);
+    FREE(data);
+
+    dvz_record_begin(batch, board_id);
+    dvz_record_viewport(batch, board_id, DVZ_DEFAULT_VIEWPORT, DVZ_DEFAULT_VIEWPORT);
+    dvz_record_draw(batch, board_id, graphics_id, 0, n, 0, 1);
+    dvz_record_end(batch, board_id);
+
+    uint32_t count = dvz_batch_size(batch);
+    DvzRequest* reqs = dvz_batch_requests(batch);
+    for (uint32_t i = 0; i < count; i++)
+        dvz_soft_request(soft, reqs[i]);
+
+    // Render with a single thread, then with several threads: the images should be identical.
+    DvzSize size = 0;
+    uint8_t* rgb = (uint8_t*)calloc(WIDTH * HEIGHT, 3);
+
+    dvz_soft_threads(soft, 1);
+    dvz_soft_request(soft, dvz_update_board(batch, board_id));
+    dvz_soft_image(soft, board_id, &size, rgb);
+    AT(size == WIDTH * HEIGHT * 3);
+    AT(!dvz_is_empty(size, rgb));
+
+    dvz_soft_threads(soft, 4);
+    dvz_soft_request(soft, dvz_update_board(batch, board_id));
+    uint8_t* rgb_mt = dvz_soft_image(soft, board_id, &size, NULL);
+    AT(memcmp(rgb, rgb_mt, size) == 0);
+
+    char imgpath[1024];
+    snprintf(imgpath, sizeof(imgpath), "%s/soft_threads.png", ARTIFACTS_DIR);
+    dvz_write_png(imgpath, WIDTH, HEIGHT, rgb_mt);
+
+    DvzSoftStats stats = dvz_soft_stats(soft);
+    AT(stats.frames == 2);
+    AT(stats.primitives == 2 * n);
+    AT(stats.fragments > 0);
+
+    FREE(rgb);
+    dvz_batch_destroy(batch);
+    dvz_soft_destroy(soft);
+    return 0;
+}
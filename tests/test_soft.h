@@ -0,0 +1,40 @@
+/*************************************************************************************************/
+/*  Tests                                                                                        */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_TEST_SOFT
+#define DVZ_HEADER_TEST_SOFT
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "testing.h"
+
+
+
+/*************************************************************************************************/
+/*  Soft tests                                                                                   */
+/*************************************************************************************************/
+
+int test_soft_graphics(TstSuite*);
+
+int test_soft_fan(TstSuite*);
+
+int test_soft_marker(TstSuite*);
+
+int test_soft_segment(TstSuite*);
+
+int test_soft_path(TstSuite*);
+
+int test_soft_image(TstSuite*);
+
+int test_soft_mesh(TstSuite*);
+
+int test_soft_threads(TstSuite*);
+
+
+
+#endif
@@ -0,0 +1,116 @@
+/*************************************************************************************************/
+/*  Testing frame timing                                                                         */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "test_timing.h"
+#include "fileio.h"
+#include "test.h"
+#include "testing.h"
+#include "timing.h"
+
+
+
+/*************************************************************************************************/
+/*  Frame timing tests                                                                           */
+/*************************************************************************************************/
+
+int test_timing_1(TstSuite* suite)
+{
+    uint32_t capacity = 4;
+    DvzTiming timing = dvz_timing(capacity);
+    AT(dvz_timing_count(&timing) == 0);
+    AT(dvz_timing_record(&timing, 0) == NULL);
+
+    // Requests processed before the first frame are attributed to that frame.
+    dvz_timing_begin(&timing, DVZ_TIMING_REQUESTS);
+    dvz_timing_end(&timing, DVZ_TIMING_REQUESTS);
+
+    uint64_t seq = 0;
+    DvzFrameTiming* rec = NULL;
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        seq = dvz_timing_frame(&timing, 10 + i, 1);
+        AT(seq == i);
+        dvz_timing_policy(&timing, 2, 0, i % 2 == 0);
+
+        dvz_timing_begin(&timing, DVZ_TIMING_FENCE);
+        dvz_timing_end(&timing, DVZ_TIMING_FENCE);
+        dvz_timing_begin(&timing, DVZ_TIMING_SUBMIT);
+        dvz_sleep(1);
+        dvz_timing_end(&timing, DVZ_TIMING_SUBMIT);
+        dvz_timing_frame_end(&timing);
+
+        // The GPU time of the previous frame is known one frame later.
+        if (i > 0)
+            dvz_timing_gpu(&timing, seq - 1, 1e-3);
+    }
+
+    // Only the last records are kept.
+    AT(dvz_timing_count(&timing) == capacity);
+    AT(dvz_timing_record(&timing, 1) == NULL);
+    AT(dvz_timing_record(&timing, 6) == NULL);
+
+    // Oldest record.
+    rec = dvz_timing_get(&timing, 0);
+    AT(rec != NULL);
+    AT(rec->seq == 2);
+    AT(rec->frame_idx == 12);
+    AT(rec->window_id == 1);
+    AT(rec->gpu == 1e-3);
+    AT(rec->frames_in_flight == 2);
+    AT(rec->jit);
+    AT(rec->begin[DVZ_TIMING_REQUESTS] < 0);
+    AT(rec->begin[DVZ_TIMING_ACQUIRE] < 0);
+    AT(rec->frame_begin <= rec->begin[DVZ_TIMING_FENCE]);
+    AT(rec->begin[DVZ_TIMING_FENCE] <= rec->end[DVZ_TIMING_FENCE]);
+    AT(rec->end[DVZ_TIMING_SUBMIT] - rec->begin[DVZ_TIMING_SUBMIT] > 0);
+    AT(rec->end[DVZ_TIMING_SUBMIT] <= rec->frame_end);
+
+    // Most recent record, the GPU time is not known yet.
+    rec = dvz_timing_get(&timing, capacity - 1);
+    AT(rec != NULL);
+    AT(rec->seq == 5);
+    AT(rec->gpu < 0);
+    AT(dvz_timing_record(&timing, 5) == rec);
+
+    // Just-in-time wait and requests processed between two frames.
+    dvz_timing_begin(&timing, DVZ_TIMING_JIT);
+    dvz_timing_end(&timing, DVZ_TIMING_JIT);
+    dvz_timing_begin(&timing, DVZ_TIMING_REQUESTS);
+    dvz_timing_end(&timing, DVZ_TIMING_REQUESTS);
+    seq = dvz_timing_frame(&timing, 16, 1);
+    dvz_timing_frame_end(&timing);
+    rec = dvz_timing_record(&timing, seq);
+    AT(rec != NULL);
+    AT(rec->begin[DVZ_TIMING_REQUESTS] >= 0);
+    AT(rec->end[DVZ_TIMING_JIT] <= rec->begin[DVZ_TIMING_REQUESTS]);
+    AT(rec->end[DVZ_TIMING_REQUESTS] <= rec->frame_begin);
+
+    // Chrome trace export.
+    char path[1024] = {0};
+    snprintf(path, sizeof(path), "%s/timing.json", ARTIFACTS_DIR);
+    AT(dvz_timing_export(&timing, path) == 0);
+
+    DvzSize size = 0;
+    char* contents = (char*)dvz_read_file(path, &size);
+    AT(contents != NULL);
+    AT(size > 0);
+
+    // NOTE: the file contents are not null-terminated.
+    char* json = (char*)calloc(size + 1, 1);
+    memcpy(json, contents, size);
+    FREE(contents);
+    AT(strstr(json, "\"traceEvents\"") != NULL);
+    AT(strstr(json, "\"name\":\"submit\"") != NULL);
+    AT(strstr(json, "\"name\":\"render pass\"") != NULL);
+    FREE(json);
+
+    dvz_timing_destroy(&timing);
+    return 0;
+}
@@ -0,0 +1,27 @@
+/*************************************************************************************************/
+/*  Tests                                                                                        */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_TEST_TIMING
+#define DVZ_HEADER_TEST_TIMING
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "test.h"
+#include "testing.h"
+
+
+
+/*************************************************************************************************/
+/*  Frame timing tests                                                                           */
+/*************************************************************************************************/
+
+int test_timing_1(TstSuite*);
+
+
+
+#endif
@@ -597,3 +597,342 @@ int test_transfers_dups_copy(TstSuite* suite)
     destroy_transfers(transfers);
     return 0;
 }
+
+
+
+static void _release_done(void* user_data)
+{
+    ANN(user_data);
+    *((int*)user_data) = 1;
+}
+
+
+
+// Consume the last async transfer batch as the renderer would do, without a render submission.
+// Return whether there was a batch to consume.
+static bool _consume_batch(DvzTransfers* transfers)
+{
+    ANN(transfers);
+    DvzQueueScheduler* sch = &transfers->scheduler;
+    bool pending = false;
+    if (sch->timeline)
+    {
+        pending = sch->transfer_timeline.value > 0;
+        dvz_timeline_wait(&sch->transfer_timeline, sch->transfer_timeline.value);
+    }
+    else
+    {
+        uint32_t idx = 0;
+        pending = dvz_transfers_wait_semaphore(transfers, &idx) != NULL;
+        pending &= dvz_transfers_wait_semaphore(transfers, &idx) == NULL;
+    }
+    dvz_queue_wait(transfers->gpu, sch->transfer);
+    return pending;
+}
+
+int test_transfers_batch(TstSuite* suite)
+{
+    ANN(suite);
+
+    DvzTransfers* transfers = get_transfers(suite);
+    ANN(transfers);
+
+    DvzGpu* gpu = transfers->gpu;
+    ANN(gpu);
+
+    uint8_t data[128] = {0};
+    for (uint32_t i = 0; i < 128; i++)
+        data[i] = i;
+
+    DvzBufferRegions stg = _standalone_buffer_regions(gpu, DVZ_BUFFER_TYPE_STAGING, 1, 1024);
+    DvzBufferRegions br = _standalone_buffer_regions(gpu, DVZ_BUFFER_TYPE_VERTEX, 1, 1024);
+
+    // Enqueue two uploads with staging, the copies will be recorded in the same frame batch.
+    _enqueue_buffer_upload(transfers->deq, br, 0, stg, 0, 64, data, NULL);
+    _enqueue_buffer_upload(transfers->deq, br, 64, stg, 64, 64, &data[64], NULL);
+
+    // HACK: we need to wait for the uploads to staging to occur in the background thread.
+    dvz_deq_wait(transfers->deq, DVZ_TRANSFER_PROC_UD);
+
+    // Without async mode, the batch is submitted and waited upon.
+    dvz_transfers_frame(transfers, 0);
+    AT(transfers->batch.batch_count == 1);
+    AT(transfers->batch.copy_count == 2);
+
+    uint8_t data2[128] = {0};
+    dvz_download_buffer(transfers, br, 0, 128, data2);
+    AT(memcmp(data2, data, 128) == 0);
+
+    // An empty frame does not submit anything.
+    dvz_transfers_frame(transfers, 0);
+    AT(transfers->batch.batch_count == 1);
+
+    // In async mode, releases are deferred until the batch slot is reused.
+    dvz_transfers_async(transfers, true);
+    _enqueue_buffer_upload(transfers->deq, br, 0, stg, 0, 128, data, NULL);
+    dvz_deq_wait(transfers->deq, DVZ_TRANSFER_PROC_UD);
+    dvz_transfers_frame(transfers, 0);
+    AT(transfers->batch.batch_count == 2);
+
+    int released = 0;
+    dvz_transfers_release(transfers, _release_done, &released);
+    AT(released == 0);
+
+    // Consume the semaphore as the renderer would do, without a render submission.
+    AT(_consume_batch(transfers));
+    dvz_transfers_async(transfers, false);
+
+    // Going through all batch slots releases the pending resources.
+    for (uint32_t i = 0; i < DVZ_TRANSFER_BATCH_COUNT; i++)
+        dvz_transfers_frame(transfers, 0);
+    AT(released == 1);
+
+    _destroy_buffer_regions(br);
+    _destroy_buffer_regions(stg);
+    destroy_transfers(transfers);
+    return 0;
+}
+
+
+
+int test_transfers_ring(TstSuite* suite)
+{
+    ANN(suite);
+
+    DvzTransfers* transfers = get_transfers(suite);
+    ANN(transfers);
+
+    DvzGpu* gpu = transfers->gpu;
+    ANN(gpu);
+
+    uint8_t data[1024] = {0};
+    for (uint32_t i = 0; i < 1024; i++)
+        data[i] = i % 251;
+
+    DvzBufferRegions br = _standalone_buffer_regions(gpu, DVZ_BUFFER_TYPE_VERTEX, 1, 1024);
+    DvzBufferRegions ring_br = {0};
+    DvzSize offset = 0;
+
+    // Use a small ring to test wrapping and stalls.
+    dvz_transfers_ring_size(transfers, 1024);
+
+    // Stage three uploads, each allocation is aligned on DVZ_STAGING_RING_ALIGNMENT bytes.
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        AT(dvz_transfers_stage(transfers, 200, &data[256 * i], &ring_br, &offset));
+        AT(offset == 256 * i);
+        dvz_deq_enqueue_submit(
+            transfers->deq, _create_buffer_copy(ring_br, offset, br, 256 * i, 200), false);
+    }
+    DvzStagingRingStats stats = dvz_transfers_ring_stats(transfers);
+    AT(stats.size == 1024);
+    AT(stats.used == 768);
+    AT(stats.alloc_count == 3);
+
+    // The copies are recorded in a single batch, after which the ring is free again.
+    dvz_transfers_frame(transfers, 0);
+    AT(transfers->batch.copy_count == 3);
+    stats = dvz_transfers_ring_stats(transfers);
+    AT(stats.used == 0);
+    AT(stats.peak == 768);
+
+    uint8_t data2[1024] = {0};
+    dvz_download_buffer(transfers, br, 0, 1024, data2);
+    for (uint32_t i = 0; i < 3; i++)
+        AT(memcmp(&data2[256 * i], &data[256 * i], 200) == 0);
+
+    // An allocation that does not fit before the end of the ring wraps around.
+    dvz_transfers_async(transfers, true);
+    AT(dvz_transfers_stage(transfers, 512, data, &ring_br, &offset));
+    AT(offset == 0);
+    dvz_deq_enqueue_submit(
+        transfers->deq, _create_buffer_copy(ring_br, offset, br, 0, 512), false);
+    dvz_transfers_frame(transfers, 0);
+    stats = dvz_transfers_ring_stats(transfers);
+    AT(stats.wrap_count == 1);
+    AT(stats.used == 768);
+
+    // There is no room left until the in-flight batch has completed, so the allocation stalls.
+    AT(dvz_transfers_stage(transfers, 512, &data[512], &ring_br, &offset));
+    AT(offset == 512);
+    dvz_deq_enqueue_submit(
+        transfers->deq, _create_buffer_copy(ring_br, offset, br, 512, 512), false);
+    stats = dvz_transfers_ring_stats(transfers);
+    AT(stats.stall_count == 1);
+    AT(stats.used == 512);
+
+    // Data larger than the ring cannot be staged.
+    AT(!dvz_transfers_stage(transfers, 2048, data, &ring_br, &offset));
+    AT(dvz_transfers_ring_stats(transfers).overflow_count == 1);
+
+    // Submit the last copy and consume the semaphore as the renderer would do.
+    dvz_transfers_frame(transfers, 0);
+    AT(_consume_batch(transfers));
+    dvz_transfers_async(transfers, false);
+    for (uint32_t i = 0; i < DVZ_TRANSFER_BATCH_COUNT; i++)
+        dvz_transfers_frame(transfers, 0);
+    AT(dvz_transfers_ring_stats(transfers).used == 0);
+
+    dvz_download_buffer(transfers, br, 0, 1024, data2);
+    AT(memcmp(data2, data, 1024) == 0);
+
+    _destroy_buffer_regions(br);
+    destroy_transfers(transfers);
+    return 0;
+}
+
+
+
+int test_transfers_scheduler(TstSuite* suite)
+{
+    ANN(suite);
+
+    DvzTransfers* transfers = get_transfers(suite);
+    ANN(transfers);
+
+    DvzGpu* gpu = transfers->gpu;
+    ANN(gpu);
+
+    DvzQueueScheduler* sch = &transfers->scheduler;
+    DvzQueues* q = &gpu->queues;
+
+    // The queues are routed to requested queues supporting the corresponding type of work.
+    uint32_t queue_transfer = dvz_transfers_queue(transfers, DVZ_QUEUE_TRANSFER);
+    uint32_t queue_compute = dvz_transfers_queue(transfers, DVZ_QUEUE_COMPUTE);
+    uint32_t queue_render = dvz_transfers_queue(transfers, DVZ_QUEUE_RENDER);
+    AT(queue_transfer < q->queue_count);
+    AT(queue_compute < q->queue_count);
+    AT(queue_render < q->queue_count);
+    AT(q->queue_types[queue_transfer] & DVZ_QUEUE_TRANSFER);
+    AT(q->queue_types[queue_compute] & DVZ_QUEUE_COMPUTE);
+    AT(transfers->batch.cmds.queue_idx == queue_transfer);
+    AT(sch->timeline == gpu->support_timeline);
+
+    // Each batch signals the next value of the transfer timeline.
+    uint8_t data[64] = {0};
+    for (uint32_t i = 0; i < 64; i++)
+        data[i] = i;
+    DvzBufferRegions br = _standalone_buffer_regions(gpu, DVZ_BUFFER_TYPE_VERTEX, 1, 64);
+    DvzBufferRegions ring_br = {0};
+    DvzSize offset = 0;
+
+    dvz_transfers_async(transfers, true);
+    AT(dvz_transfers_stage(transfers, 64, data, &ring_br, &offset));
+    dvz_deq_enqueue_submit(
+        transfers->deq, _create_buffer_copy(ring_br, offset, br, 0, 64), false);
+    dvz_transfers_frame(transfers, 0);
+    if (sch->timeline)
+        AT(sch->transfer_timeline.value == 1);
+
+    // A render submission waits for the batch and signals the render timeline.
+    DvzSubmit submit = dvz_submit(gpu);
+    dvz_transfers_sync_render(transfers, &submit);
+    if (sch->timeline)
+    {
+        AT(submit.wait_timelines_count == 1);
+        AT(submit.signal_timelines_count == 1);
+
+        // The submission is not sent, so the next batch does not wait for its value.
+        AT(sch->render_timeline.value == 0);
+    }
+    else
+    {
+        AT(submit.wait_semaphores_count == 1);
+        AT(submit.signal_semaphores_count == 1);
+
+        // Cancel the binary semaphore signal since the submission is not sent.
+        transfers->batch.render_count = 0;
+    }
+    dvz_queue_wait(gpu, sch->transfer);
+    dvz_transfers_async(transfers, false);
+
+    uint8_t data2[64] = {0};
+    dvz_download_buffer(transfers, br, 0, 64, data2);
+    AT(memcmp(data2, data, 64) == 0);
+
+    _destroy_buffer_regions(br);
+    destroy_transfers(transfers);
+    return 0;
+}
+
+
+
+int test_transfers_canvases(TstSuite* suite)
+{
+    ANN(suite);
+
+    DvzTransfers* transfers = get_transfers(suite);
+    ANN(transfers);
+
+    DvzGpu* gpu = transfers->gpu;
+    ANN(gpu);
+
+    DvzQueueScheduler* sch = &transfers->scheduler;
+    DvzTransferBatch* batch = &transfers->batch;
+
+    // One empty command buffer per canvas, on the render queue.
+    const uint32_t n = 2;
+    DvzCommands cmds = dvz_commands(gpu, sch->render, n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        dvz_cmd_begin(&cmds, i);
+        dvz_cmd_end(&cmds, i);
+    }
+
+    uint8_t data[64] = {0};
+    DvzBufferRegions br = _standalone_buffer_regions(gpu, DVZ_BUFFER_TYPE_VERTEX, 1, 64);
+    DvzBufferRegions ring_br = {0};
+    DvzSize offset = 0;
+
+    dvz_transfers_async(transfers, true);
+    for (uint32_t frame = 0; frame < 2 * DVZ_TRANSFER_BATCH_COUNT; frame++)
+    {
+        for (uint32_t i = 0; i < 64; i++)
+            data[i] = (uint8_t)(frame + i);
+        AT(dvz_transfers_stage(transfers, 64, data, &ring_br, &offset));
+        dvz_deq_enqueue_submit(
+            transfers->deq, _create_buffer_copy(ring_br, offset, br, 0, 64), false);
+        dvz_transfers_frame(transfers, 0);
+
+        // Each canvas renders the frame after the copies of the batch.
+        for (uint32_t i = 0; i < n; i++)
+        {
+            DvzSubmit submit = dvz_submit(gpu);
+            dvz_submit_commands(&submit, &cmds);
+            dvz_transfers_sync_render(transfers, &submit);
+            if (sch->timeline)
+            {
+                AT(submit.wait_timelines_count == 1);
+            }
+            else
+            {
+                // The semaphore of the batch can only be waited upon by the first canvas, the
+                // other ones wait for the batch on the CPU.
+                AT(submit.wait_semaphores_count == (i == 0 ? 1 : 0));
+                AT(submit.signal_semaphores_count == 1);
+                AT(!batch->submitted[batch->done_slot] || i == 0);
+            }
+            dvz_submit_send(&submit, i, NULL, 0);
+        }
+
+        // The next batch waits for the render submissions of all canvases.
+        if (!sch->timeline)
+            AT(batch->render_count == n);
+    }
+
+    // An empty batch consumes the last render semaphores.
+    dvz_transfers_frame(transfers, 0);
+    AT(batch->render_count == 0);
+    dvz_queue_wait(gpu, sch->render);
+    dvz_queue_wait(gpu, sch->transfer);
+    dvz_transfers_async(transfers, false);
+
+    uint8_t data2[64] = {0};
+    dvz_download_buffer(transfers, br, 0, 64, data2);
+    AT(memcmp(data2, data, 64) == 0);
+
+    dvz_commands_destroy(&cmds);
+    _destroy_buffer_regions(br);
+    destroy_transfers(transfers);
+    return 0;
+}
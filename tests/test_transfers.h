@@ -38,6 +38,11 @@ int test_transfers_dups_upload(TstSuite*);
 
 int test_transfers_dups_copy(TstSuite*);
 
+int test_transfers_batch(TstSuite*);
+int test_transfers_ring(TstSuite*);
+int test_transfers_scheduler(TstSuite*);
+int test_transfers_canvases(TstSuite*);
+
 
 
 #endif
@@ -0,0 +1,255 @@
+/*************************************************************************************************/
+/*  Testing transport                                                                            */
+/*************************************************************************************************/
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "test_transport.h"
+#include "_thread.h"
+#include "request.h"
+#include "test.h"
+#include "testing.h"
+#include "transport.h"
+
+#if !OS_WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+
+
+/*************************************************************************************************/
+/*  Util functions                                                                               */
+/*************************************************************************************************/
+
+#define SMALL_SIZE  256
+#define LARGE_SIZE  (4 * 1024 * 1024)
+#define MEDIUM_SIZE (32 * 1024) // sent inline, below the shared-memory threshold
+
+typedef struct
+{
+    char path[256];
+    int released;
+    int res;
+} TransportProducer;
+
+
+
+static void _release_upload(void* user_data)
+{
+    ANN(user_data);
+    (*(int*)user_data)++;
+}
+
+
+
+// Connect to a server without sending the handshake.
+static int _silent_client(const char* path)
+{
+    ANN(path);
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+
+
+static void* _producer(void* user_data)
+{
+    TransportProducer* producer = (TransportProducer*)user_data;
+    ANN(producer);
+
+    DvzTransport* tr = dvz_transport_connect(producer->path);
+    if (tr == NULL)
+    {
+        producer->res = 1;
+        return NULL;
+    }
+
+    // First batch: small payloads, copied through the socket.
+    DvzBatch* batch = dvz_batch();
+    uint8_t small[SMALL_SIZE] = {0};
+    for (uint32_t i = 0; i < SMALL_SIZE; i++)
+        small[i] = (uint8_t)i;
+    DvzRequest req = dvz_create_dat(batch, DVZ_BUFFER_TYPE_VERTEX, SMALL_SIZE, 0);
+    dvz_upload_dat(batch, req.id, 0, SMALL_SIZE, small, 0);
+    const char* code = "void main() {}";
+    dvz_create_glsl(batch, DVZ_SHADER_VERTEX, strlen(code) + 1, code);
+    dvz_batch_desc(batch, "vertex shader");
+    producer->res |= dvz_transport_send(tr, batch);
+    dvz_batch_destroy(batch);
+
+    // Second batch: a large strided upload, passed through the shared-memory ring.
+    batch = dvz_batch();
+    uint32_t* large = (uint32_t*)malloc(2 * LARGE_SIZE);
+    for (uint32_t i = 0; i < 2 * LARGE_SIZE / sizeof(uint32_t); i++)
+        large[i] = i;
+    req = dvz_create_dat(batch, DVZ_BUFFER_TYPE_VERTEX, LARGE_SIZE, 0);
+    dvz_upload_dat_strided(
+        batch, req.id, 0, LARGE_SIZE / sizeof(uint32_t), sizeof(uint32_t), 2 * sizeof(uint32_t),
+        large, _release_upload, &producer->released);
+    producer->res |= dvz_transport_send(tr, batch);
+    dvz_batch_destroy(batch);
+    FREE(large);
+
+    DvzTransportStats stats = dvz_transport_stats(tr);
+    if (stats.frames != 2 || stats.shm_bytes != LARGE_SIZE)
+        producer->res = 1;
+
+    dvz_transport_destroy(tr);
+    return NULL;
+}
+
+
+
+static void* _producer_compressed(void* user_data)
+{
+    TransportProducer* producer = (TransportProducer*)user_data;
+    ANN(producer);
+
+    DvzTransport* tr = dvz_transport_connect(producer->path);
+    if (tr == NULL)
+    {
+        producer->res = 1;
+        return NULL;
+    }
+    dvz_transport_compression(tr, 1024);
+
+    // Sorted timestamps, compressed before being copied through the socket.
+    DvzBatch* batch = dvz_batch();
+    uint32_t* times = (uint32_t*)malloc(MEDIUM_SIZE);
+    for (uint32_t i = 0; i < MEDIUM_SIZE / sizeof(uint32_t); i++)
+        times[i] = 1000000 + 3 * i;
+    DvzRequest req = dvz_create_dat(batch, DVZ_BUFFER_TYPE_VERTEX, MEDIUM_SIZE, 0);
+    dvz_upload_dat(batch, req.id, 0, MEDIUM_SIZE, times, 0);
+    producer->res |= dvz_transport_send(tr, batch);
+    dvz_batch_destroy(batch);
+    FREE(times);
+
+    DvzTransportStats stats = dvz_transport_stats(tr);
+    if (stats.compressed_bytes != MEDIUM_SIZE || stats.inline_bytes >= MEDIUM_SIZE / 4)
+        producer->res = 1;
+
+    dvz_transport_destroy(tr);
+    return NULL;
+}
+
+
+
+/*************************************************************************************************/
+/*  Transport tests                                                                              */
+/*************************************************************************************************/
+
+int test_transport_1(TstSuite* suite)
+{
+    TransportProducer producer = {0};
+    snprintf(producer.path, sizeof(producer.path), "%s/transport.sock", ARTIFACTS_DIR);
+
+    DvzTransport* server = dvz_transport_listen(producer.path);
+    AT(server != NULL);
+
+    // A client that never sends its handshake does not block the server.
+    int silent = _silent_client(producer.path);
+    AT(silent >= 0);
+    DvzThread* thread = dvz_thread(_producer, &producer);
+
+    // First batch.
+    DvzBatch* batch = dvz_transport_recv(server, 5000);
+    AT(batch != NULL);
+    AT(dvz_batch_size(batch) == 3);
+    DvzRequest* reqs = dvz_batch_requests(batch);
+    AT(reqs[2].desc == NULL); // the description pointer is meaningless in the server
+    AT(reqs[1].action == DVZ_REQUEST_ACTION_UPLOAD);
+    AT(reqs[1].content.dat_upload.size == SMALL_SIZE);
+    AT((reqs[1].flags & DVZ_UPLOAD_FLAGS_NOCOPY) == 0);
+    uint8_t* small = (uint8_t*)reqs[1].content.dat_upload.data;
+    AT(small != NULL);
+    for (uint32_t i = 0; i < SMALL_SIZE; i++)
+        AT(small[i] == (uint8_t)i);
+    AT(strcmp(reqs[2].content.shader.code, "void main() {}") == 0);
+
+    // Like the renderer, free the payloads it owns.
+    FREE(reqs[1].content.dat_upload.data);
+    FREE(reqs[2].content.shader.code);
+    dvz_batch_destroy(batch);
+
+    // Second batch, the strided source has been gathered in the ring of the producer.
+    batch = dvz_transport_recv(server, 5000);
+    AT(batch != NULL);
+    AT(dvz_batch_size(batch) == 2);
+    reqs = dvz_batch_requests(batch);
+    AT(reqs[1].content.dat_upload.size == LARGE_SIZE);
+    AT(reqs[1].content.dat_upload.stride == 0);
+    AT((reqs[1].flags & DVZ_UPLOAD_FLAGS_NOCOPY) != 0);
+    AT(reqs[1].content.dat_upload.release != NULL);
+    uint32_t* large = (uint32_t*)reqs[1].content.dat_upload.data;
+    for (uint32_t i = 0; i < LARGE_SIZE / sizeof(uint32_t); i++)
+        AT(large[i] == 2 * i);
+
+    // Like the renderer, release the region of the ring once uploaded.
+    reqs[1].content.dat_upload.release(reqs[1].content.dat_upload.user_data);
+    dvz_batch_destroy(batch);
+
+    DvzTransportStats stats = dvz_transport_stats(server);
+    AT(stats.frames == 2);
+    AT(stats.requests == 5);
+    AT(stats.shm_bytes == LARGE_SIZE);
+
+    dvz_thread_join(thread);
+    AT(producer.res == 0);
+    AT(producer.released == 1);
+    close(silent);
+
+    // The producer is gone.
+    AT(dvz_transport_recv(server, 100) == NULL);
+
+    dvz_transport_destroy(server);
+    return 0;
+}
+
+
+
+int test_transport_compression(TstSuite* suite)
+{
+    TransportProducer producer = {0};
+    snprintf(producer.path, sizeof(producer.path), "%s/transport_compressed.sock", ARTIFACTS_DIR);
+
+    DvzTransport* server = dvz_transport_listen(producer.path);
+    AT(server != NULL);
+    DvzThread* thread = dvz_thread(_producer_compressed, &producer);
+
+    // The payload is decompressed on receive.
+    DvzBatch* batch = dvz_transport_recv(server, 5000);
+    AT(batch != NULL);
+    AT(dvz_batch_size(batch) == 2);
+    DvzRequest* reqs = dvz_batch_requests(batch);
+    AT(reqs[1].content.dat_upload.size == MEDIUM_SIZE);
+    uint32_t* times = (uint32_t*)reqs[1].content.dat_upload.data;
+    AT(times != NULL);
+    for (uint32_t i = 0; i < MEDIUM_SIZE / sizeof(uint32_t); i++)
+        AT(times[i] == 1000000 + 3 * i);
+    FREE(reqs[1].content.dat_upload.data);
+    dvz_batch_destroy(batch);
+
+    DvzTransportStats stats = dvz_transport_stats(server);
+    AT(stats.compressed_bytes == MEDIUM_SIZE);
+    AT(stats.inline_bytes < MEDIUM_SIZE / 4);
+
+    dvz_thread_join(thread);
+    AT(producer.res == 0);
+
+    dvz_transport_destroy(server);
+    return 0;
+}
@@ -0,0 +1,28 @@
+/*************************************************************************************************/
+/*  Tests                                                                                        */
+/*************************************************************************************************/
+
+#ifndef DVZ_HEADER_TEST_TRANSPORT
+#define DVZ_HEADER_TEST_TRANSPORT
+
+
+
+/*************************************************************************************************/
+/*  Includes                                                                                     */
+/*************************************************************************************************/
+
+#include "testing.h"
+
+
+
+/*************************************************************************************************/
+/*  Transport tests                                                                              */
+/*************************************************************************************************/
+
+int test_transport_1(TstSuite*);
+
+int test_transport_compression(TstSuite*);
+
+
+
+#endif
@@ -722,6 +722,126 @@ int test_vklite_submit(TstSuite* suite)
 
 
 
+int test_vklite_timeline(TstSuite* suite)
+{
+    ANN(suite);
+    DvzHost* host = get_host(suite);
+    DvzGpu* gpu = dvz_gpu_best(host);
+    dvz_gpu_queue(gpu, 0, DVZ_QUEUE_COMPUTE);
+    dvz_gpu_queue(gpu, 1, DVZ_QUEUE_COMPUTE);
+    dvz_gpu_create(gpu, 0);
+
+    if (!gpu->support_timeline)
+    {
+        log_warn("timeline semaphores not supported, skipping test");
+        dvz_gpu_destroy(gpu);
+        return 0;
+    }
+
+    // Create the compute pipelines.
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/test_double.comp.spv", SPIRV_DIR);
+    DvzCompute compute1 = dvz_compute(gpu, path);
+
+    snprintf(path, sizeof(path), "%s/test_sum.comp.spv", SPIRV_DIR);
+    DvzCompute compute2 = dvz_compute(gpu, path);
+
+    // Create the buffer
+    DvzBuffer buffer = dvz_buffer(gpu);
+    const uint32_t n = 20;
+    const VkDeviceSize size = n * sizeof(float);
+    dvz_buffer_size(&buffer, size);
+    dvz_buffer_usage(
+        &buffer, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    dvz_buffer_vma_usage(&buffer, VMA_MEMORY_USAGE_CPU_ONLY);
+    dvz_buffer_queue_access(&buffer, 0);
+    dvz_buffer_queue_access(&buffer, 1);
+    dvz_buffer_create(&buffer);
+
+    float* data = calloc(n, sizeof(float));
+    for (uint32_t i = 0; i < n; i++)
+        data[i] = (float)i;
+    dvz_buffer_upload(&buffer, 0, size, data);
+    dvz_queue_wait(gpu, 0);
+
+    // Descriptors.
+    dvz_compute_slot(&compute1, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    dvz_compute_slot(&compute2, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    DvzBufferRegions br = {.buffer = &buffer, .size = size, .count = 1};
+
+    DvzDescriptors descriptors1 = dvz_descriptors(&compute1.slots, 1);
+    dvz_descriptors_buffer(&descriptors1, 0, br);
+    dvz_descriptors_update(&descriptors1);
+    dvz_compute_descriptors(&compute1, &descriptors1);
+    dvz_compute_create(&compute1);
+
+    DvzDescriptors descriptors2 = dvz_descriptors(&compute2.slots, 1);
+    dvz_descriptors_buffer(&descriptors2, 0, br);
+    dvz_descriptors_update(&descriptors2);
+    dvz_compute_descriptors(&compute2, &descriptors2);
+    dvz_compute_create(&compute2);
+
+    // Command buffers on two different queues.
+    DvzCommands cmds1 = dvz_commands(gpu, 0, 1);
+    dvz_cmd_begin(&cmds1, 0);
+    dvz_cmd_compute(&cmds1, 0, &compute1, (uvec3){20, 1, 1});
+    dvz_cmd_end(&cmds1, 0);
+
+    DvzCommands cmds2 = dvz_commands(gpu, 1, 1);
+    dvz_cmd_begin(&cmds2, 0);
+    dvz_cmd_compute(&cmds2, 0, &compute2, (uvec3){20, 1, 1});
+    dvz_cmd_end(&cmds2, 0);
+
+    // The second submission waits for the value signaled by the first one.
+    DvzTimeline timeline = dvz_timeline(gpu);
+    uint64_t value1 = dvz_timeline_next(&timeline);
+    AT(value1 == 1);
+
+    DvzSubmit submit1 = dvz_submit(gpu);
+    dvz_submit_commands(&submit1, &cmds1);
+    dvz_submit_signal_timeline(&submit1, &timeline, value1);
+
+    // The value is only scheduled once the submission signaling it has been sent.
+    AT(timeline.value == 0);
+    AT(dvz_timeline_next(&timeline) == value1);
+    dvz_submit_send(&submit1, 0, NULL, 0);
+    AT(timeline.value == value1);
+
+    uint64_t value2 = dvz_timeline_next(&timeline);
+    AT(value2 == 2);
+
+    DvzSubmit submit2 = dvz_submit(gpu);
+    dvz_submit_commands(&submit2, &cmds2);
+    dvz_submit_wait_timeline(&submit2, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, &timeline, value1);
+    dvz_submit_signal_timeline(&submit2, &timeline, value2);
+    dvz_submit_send(&submit2, 0, NULL, 0);
+
+    // Wait on the CPU for the last value.
+    dvz_timeline_wait(&timeline, value2);
+    AT(dvz_timeline_value(&timeline) == value2);
+
+    float* data2 = calloc(n, sizeof(float));
+    dvz_buffer_download(&buffer, 0, size, data2);
+    for (uint32_t i = 0; i < n; i++)
+        AT(data2[i] == 2 * i + 1);
+
+    dvz_timeline_destroy(&timeline);
+    dvz_descriptors_destroy(&descriptors1);
+    dvz_descriptors_destroy(&descriptors2);
+    dvz_buffer_destroy(&buffer);
+    dvz_compute_destroy(&compute1);
+    dvz_compute_destroy(&compute2);
+
+    FREE(data);
+    FREE(data2);
+
+    dvz_gpu_destroy(gpu);
+    return 0;
+}
+
+
+
 int test_vklite_offscreen(TstSuite* suite)
 {
     ANN(suite);
@@ -1501,7 +1621,7 @@ int test_vklite_sync_full(TstSuite* suite)
         dvz_submit_signal_semaphores(&submit, &sem_render_finished, cur_frame);
         dvz_submit_send(&submit, swapchain.img_idx, fences, cur_frame);
         dvz_swapchain_present(&swapchain, 0, &sem_render_finished, cur_frame);
-        cur_frame = (cur_frame + 1) % DVZ_MAX_FRAMES_IN_FLIGHT;
+        cur_frame = (cur_frame + 1) % frames_in_flight;
     }
 
     dvz_queue_wait(gpu, 0);
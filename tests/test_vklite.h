@@ -31,6 +31,7 @@ int test_vklite_sampler(TstSuite*);
 int test_vklite_barrier_buffer(TstSuite*);
 int test_vklite_barrier_image(TstSuite*);
 int test_vklite_submit(TstSuite*);
+int test_vklite_timeline(TstSuite*);
 int test_vklite_offscreen(TstSuite*);
 int test_vklite_shader(TstSuite*);
 int test_vklite_surface(TstSuite*);
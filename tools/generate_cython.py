@@ -59,12 +59,16 @@ ENUMS = (
     'DvzShader',
     'DvzSlotType',
     'DvzTexDims',
+    'DvzUpload',
     'DvzView',
     'DvzVisual',
 )
 
 REQUEST_FUNCTIONS = (
     'dvz_request',
+    'dvz_batch_clear',
+    'dvz_batch_requests',
+    'dvz_batch_size',
     'dvz_create',
     'dvz_update',
     'dvz_upload_dat',
@@ -102,6 +106,7 @@ VIEWSET_FUNCTIONS = (
 SCENE_STRUCTS = (
     # 'DvzScene',
     # 'DvzVisual',
+    'DvzVisualUpdate',
 )
 
 SCENE_FUNCTIONS = (